@@ -0,0 +1,265 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "ns3/antenna-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/flow-monitor-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include "ns3/nr-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include <iostream>
+#include <map>
+
+/**
+ * \file cttc-nr-bwp-load-balancing.cc
+ * \ingroup examples
+ * \brief Balance of the DL traffic among component carriers
+ *
+ * A gNB operates a band split in "numCc" contiguous component carriers, with
+ * a BWP each, and serves "ueNum" UEs with a DL UDP flow each, on the default
+ * bearer. With the static BWP manager, all the flows of the default bearer go
+ * to the BWP 0, and the other carriers stay idle. With "--loadAware=1", the
+ * gNB uses BwpManagerAlgorithmLoadAware, that splits the buffer of each flow
+ * among the BWPs following their PRB occupancy and the CQI of the UE. The
+ * program prints the mean DL PRB occupancy of each BWP, from the
+ * "PrbOccupancy" trace of the BWP manager, and the DL throughput:
+ *
+ * \code{.unparsed}
+$ for la in 0 1; do ./ns3 run "cttc-nr-bwp-load-balancing --loadAware=$la"; done
+    \endcode
+ */
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("CttcNrBwpLoadBalancing");
+
+/**
+ * \brief Sum and number of the PRB occupancy samples of each BWP
+ */
+static std::map<uint8_t, std::pair<double, uint64_t>> g_occupancy;
+
+/**
+ * \brief Accumulate a PRB occupancy sample of a BWP
+ * \param bwpId the BWP index
+ * \param prbOccupancy the DL PRB occupancy of a slot
+ */
+static void
+PrbOccupancy(uint8_t bwpId, double prbOccupancy)
+{
+    g_occupancy[bwpId].first += prbOccupancy;
+    g_occupancy[bwpId].second++;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint16_t ueNum = 6;
+    uint16_t numCc = 2;
+    bool loadAware = false;
+    bool splitBearers = true;
+    uint16_t numerology = 1;
+    double centralFrequency = 3.5e9;
+    double bandwidth = 40e6;
+    double txPower = 35;
+    double minDistance = 30.0;
+    double maxDistance = 150.0;
+    uint32_t packetSize = 1000;
+    DataRate ueRate("20Mb/s");
+    Time simTime = MilliSeconds(1500);
+    Time appStartTime = MilliSeconds(400);
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("ueNum", "The number of UEs of the cell", ueNum);
+    cmd.AddValue("numCc", "The number of component carriers of the band", numCc);
+    cmd.AddValue("loadAware", "Steer the flows among the BWPs by load and CQI", loadAware);
+    cmd.AddValue("splitBearers", "Split the buffer of a flow among the BWPs", splitBearers);
+    cmd.AddValue("numerology", "The numerology of the BWPs", numerology);
+    cmd.AddValue("centralFrequency", "The central frequency of the band", centralFrequency);
+    cmd.AddValue("bandwidth", "The bandwidth of the band", bandwidth);
+    cmd.AddValue("txPower", "The tx power (dBm) of the gNB", txPower);
+    cmd.AddValue("minDistance", "The distance (m) of the closest UE", minDistance);
+    cmd.AddValue("maxDistance", "The distance (m) of the farthest UE", maxDistance);
+    cmd.AddValue("packetSize", "The size of the UDP packets", packetSize);
+    cmd.AddValue("ueRate", "The DL rate of the flow of each UE", ueRate);
+    cmd.AddValue("simTime", "Simulation time", simTime);
+    cmd.Parse(argc, argv);
+
+    NS_ABORT_MSG_IF(ueNum == 0, "At least one UE is needed");
+    NS_ABORT_MSG_IF(numCc == 0, "At least one component carrier is needed");
+
+    NodeContainer gnbNodes;
+    gnbNodes.Create(1);
+    NodeContainer ueNodes;
+    ueNodes.Create(ueNum);
+
+    Ptr<ListPositionAllocator> gnbPositions = CreateObject<ListPositionAllocator>();
+    gnbPositions->Add(Vector(0.0, 0.0, 10.0));
+    Ptr<ListPositionAllocator> uePositions = CreateObject<ListPositionAllocator>();
+    for (uint16_t i = 0; i < ueNum; ++i)
+    {
+        const double distance =
+            ueNum > 1 ? minDistance + (maxDistance - minDistance) * i / (ueNum - 1) : minDistance;
+        const double angle = 2 * M_PI * i / ueNum;
+        uePositions->Add(Vector(distance * std::cos(angle), distance * std::sin(angle), 1.5));
+    }
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.SetPositionAllocator(gnbPositions);
+    mobility.Install(gnbNodes);
+    mobility.SetPositionAllocator(uePositions);
+    mobility.Install(ueNodes);
+
+    Ptr<NrPointToPointEpcHelper> epcHelper = CreateObject<NrPointToPointEpcHelper>();
+    Ptr<IdealBeamformingHelper> beamformingHelper = CreateObject<IdealBeamformingHelper>();
+    Ptr<NrHelper> nrHelper = CreateObject<NrHelper>();
+    nrHelper->SetBeamformingHelper(beamformingHelper);
+    nrHelper->SetEpcHelper(epcHelper);
+
+    beamformingHelper->SetAttribute("BeamformingMethod",
+                                    TypeIdValue(DirectPathBeamforming::GetTypeId()));
+
+    nrHelper->SetSchedulerTypeId(NrMacSchedulerOfdmaRR::GetTypeId());
+
+    if (loadAware)
+    {
+        nrHelper->SetGnbBwpManagerAlgorithmTypeId(BwpManagerAlgorithmLoadAware::GetTypeId());
+        nrHelper->SetGnbBwpManagerAlgorithmAttribute("SplitBearers", BooleanValue(splitBearers));
+    }
+
+    BandwidthPartInfoPtrVector allBwps;
+    CcBwpCreator ccBwpCreator;
+    CcBwpCreator::SimpleOperationBandConf bandConf(centralFrequency,
+                                                   bandwidth,
+                                                   static_cast<uint8_t>(numCc),
+                                                   BandwidthPartInfo::UMi_StreetCanyon_LoS);
+    bandConf.m_numBwp = 1; // 1 BWP per CC
+    OperationBandInfo band = ccBwpCreator.CreateOperationBandContiguousCc(bandConf);
+
+    Config::SetDefault("ns3::ThreeGppChannelModel::UpdatePeriod", TimeValue(MilliSeconds(0)));
+    nrHelper->SetChannelConditionModelAttribute("UpdatePeriod", TimeValue(MilliSeconds(0)));
+    nrHelper->SetPathlossAttribute("ShadowingEnabled", BooleanValue(false));
+    nrHelper->InitializeOperationBand(&band);
+    allBwps = CcBwpCreator::GetAllBwps({band});
+
+    epcHelper->SetAttribute("S1uLinkDelay", TimeValue(MilliSeconds(0)));
+
+    nrHelper->SetUeAntennaAttribute("NumRows", UintegerValue(1));
+    nrHelper->SetUeAntennaAttribute("NumColumns", UintegerValue(1));
+    nrHelper->SetUeAntennaAttribute("AntennaElement",
+                                    PointerValue(CreateObject<IsotropicAntennaModel>()));
+    nrHelper->SetGnbAntennaAttribute("NumRows", UintegerValue(4));
+    nrHelper->SetGnbAntennaAttribute("NumColumns", UintegerValue(4));
+    nrHelper->SetGnbAntennaAttribute("AntennaElement",
+                                     PointerValue(CreateObject<IsotropicAntennaModel>()));
+
+    nrHelper->SetGnbPhyAttribute("Numerology", UintegerValue(numerology));
+    nrHelper->SetGnbPhyAttribute("TxPower", DoubleValue(txPower));
+
+    NetDeviceContainer gnbNetDev = nrHelper->InstallGnbDevice(gnbNodes, allBwps);
+    NetDeviceContainer ueNetDev = nrHelper->InstallUeDevice(ueNodes, allBwps);
+
+    int64_t randomStream = 1;
+    randomStream += nrHelper->AssignStreams(gnbNetDev, randomStream);
+    randomStream += nrHelper->AssignStreams(ueNetDev, randomStream);
+
+    for (auto it = gnbNetDev.Begin(); it != gnbNetDev.End(); ++it)
+    {
+        DynamicCast<NrGnbNetDevice>(*it)->UpdateConfig();
+    }
+    for (auto it = ueNetDev.Begin(); it != ueNetDev.End(); ++it)
+    {
+        DynamicCast<NrUeNetDevice>(*it)->UpdateConfig();
+    }
+
+    NrHelper::GetBwpManagerGnb(gnbNetDev.Get(0))
+        ->TraceConnectWithoutContext("PrbOccupancy", MakeCallback(&PrbOccupancy));
+
+    Ptr<Node> pgw = epcHelper->GetPgwNode();
+    NodeContainer remoteHostContainer;
+    remoteHostContainer.Create(1);
+    Ptr<Node> remoteHost = remoteHostContainer.Get(0);
+    InternetStackHelper internet;
+    internet.Install(remoteHostContainer);
+
+    PointToPointHelper p2ph;
+    p2ph.SetDeviceAttribute("DataRate", DataRateValue(DataRate("100Gb/s")));
+    p2ph.SetDeviceAttribute("Mtu", UintegerValue(2500));
+    p2ph.SetChannelAttribute("Delay", TimeValue(Seconds(0.000)));
+    NetDeviceContainer internetDevices = p2ph.Install(pgw, remoteHost);
+    Ipv4AddressHelper ipv4h;
+    Ipv4StaticRoutingHelper ipv4RoutingHelper;
+    ipv4h.SetBase("1.0.0.0", "255.0.0.0");
+    ipv4h.Assign(internetDevices);
+    Ptr<Ipv4StaticRouting> remoteHostStaticRouting =
+        ipv4RoutingHelper.GetStaticRouting(remoteHost->GetObject<Ipv4>());
+    remoteHostStaticRouting->AddNetworkRouteTo(Ipv4Address("7.0.0.0"), Ipv4Mask("255.0.0.0"), 1);
+    internet.Install(ueNodes);
+
+    Ipv4InterfaceContainer ueIpIface = epcHelper->AssignUeIpv4Address(ueNetDev);
+    for (uint32_t j = 0; j < ueNodes.GetN(); ++j)
+    {
+        Ptr<Ipv4StaticRouting> ueStaticRouting =
+            ipv4RoutingHelper.GetStaticRouting(ueNodes.Get(j)->GetObject<Ipv4>());
+        ueStaticRouting->SetDefaultRoute(epcHelper->GetUeDefaultGatewayAddress(), 1);
+    }
+
+    nrHelper->AttachToClosestEnb(ueNetDev, gnbNetDev);
+
+    // A DL flow per UE, on the default bearer
+    const uint16_t dlPort = 1234;
+    ApplicationContainer serverApps;
+    ApplicationContainer clientApps;
+    UdpServerHelper dlPacketSink(dlPort);
+    serverApps.Add(dlPacketSink.Install(ueNodes));
+
+    UdpClientHelper client;
+    client.SetAttribute("MaxPackets", UintegerValue(0xFFFFFFFF));
+    client.SetAttribute("PacketSize", UintegerValue(packetSize));
+    client.SetAttribute("Interval", TimeValue(ueRate.CalculateBytesTxTime(packetSize)));
+    client.SetAttribute("RemotePort", UintegerValue(dlPort));
+    for (uint32_t j = 0; j < ueNodes.GetN(); ++j)
+    {
+        client.SetAttribute("RemoteAddress", AddressValue(ueIpIface.GetAddress(j)));
+        clientApps.Add(client.Install(remoteHost));
+    }
+
+    serverApps.Start(appStartTime);
+    clientApps.Start(appStartTime);
+    serverApps.Stop(simTime);
+    clientApps.Stop(simTime);
+
+    FlowMonitorHelper flowmonHelper;
+    NodeContainer endpointNodes;
+    endpointNodes.Add(remoteHost);
+    endpointNodes.Add(ueNodes);
+    Ptr<FlowMonitor> monitor = flowmonHelper.Install(endpointNodes);
+
+    Simulator::Stop(simTime);
+    Simulator::Run();
+
+    monitor->CheckForLostPackets();
+    uint64_t rxBytes = 0;
+    for (const auto& flow : monitor->GetFlowStats())
+    {
+        rxBytes += flow.second.rxBytes;
+    }
+    const double duration = (simTime - appStartTime).GetSeconds();
+
+    std::cout << "UEs: " << ueNum << " BWP manager: " << (loadAware ? "load-aware" : "static");
+    for (const auto& bwp : g_occupancy)
+    {
+        std::cout << " BWP " << +bwp.first << " mean occupancy: "
+                  << (bwp.second.second > 0 ? bwp.second.first / bwp.second.second : 0.0);
+    }
+    std::cout << " DL throughput: " << rxBytes * 8.0 / duration / 1e6 << " Mbps" << std::endl;
+
+    Simulator::Destroy();
+    return 0;
+}
@@ -0,0 +1,272 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "ns3/antenna-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/flow-monitor-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include "ns3/nr-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include <iostream>
+
+/**
+ * \file cttc-nr-configured-grant-benchmark.cc
+ * \ingroup examples
+ * \brief Delay of small periodic packets, with dynamic or configured grants
+ *
+ * A gNB serves "ueNum" UEs, and each of them receives and sends a small UDP
+ * packet every "interval". With the dynamic scheduling, every UL packet needs
+ * a SR, a UL grant for the BSR, and a UL grant for the data; every DL packet
+ * needs a DCI. With "--configuredGrant=1", each UE has a DL SPS and a UL
+ * configured grant, whose periodicity is the interval of the packets: after
+ * the activation, the occasions need no DCI, SR or BSR. The program prints the
+ * mean delay of each direction, and the number of events of the simulation,
+ * which shows the signalling saved by the configured grants:
+ *
+ * \code{.unparsed}
+$ for cg in 0 1; do ./ns3 run "cttc-nr-configured-grant-benchmark --configuredGrant=$cg"; done
+    \endcode
+ */
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("CttcNrConfiguredGrantBenchmark");
+
+int
+main(int argc, char* argv[])
+{
+    uint16_t ueNum = 10;
+    bool configuredGrant = false;
+    uint16_t cgMcs = 10;
+    uint16_t numerology = 1;
+    double centralFrequency = 3.5e9;
+    double bandwidth = 20e6;
+    double txPower = 30;
+    double distance = 50.0;
+    uint32_t packetSize = 32;
+    Time interval = MilliSeconds(5);
+    Time simTime = MilliSeconds(2000);
+    Time appStartTime = MilliSeconds(400);
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("ueNum", "The number of UEs of the cell", ueNum);
+    cmd.AddValue("configuredGrant", "Serve the UEs with configured grants", configuredGrant);
+    cmd.AddValue("cgMcs", "The MCS of the configured grants", cgMcs);
+    cmd.AddValue("numerology", "The numerology of the BWP", numerology);
+    cmd.AddValue("centralFrequency", "The central frequency of the band", centralFrequency);
+    cmd.AddValue("bandwidth", "The bandwidth of the band", bandwidth);
+    cmd.AddValue("txPower", "The tx power (dBm) of the gNB", txPower);
+    cmd.AddValue("distance", "The distance (m) between the gNB and the UEs", distance);
+    cmd.AddValue("packetSize", "The size of the UDP packets", packetSize);
+    cmd.AddValue("interval", "The interval between the packets of a UE", interval);
+    cmd.AddValue("simTime", "Simulation time", simTime);
+    cmd.Parse(argc, argv);
+
+    NS_ABORT_MSG_IF(ueNum == 0, "At least one UE is needed");
+
+    NodeContainer gnbNodes;
+    gnbNodes.Create(1);
+    NodeContainer ueNodes;
+    ueNodes.Create(ueNum);
+
+    Ptr<ListPositionAllocator> gnbPositions = CreateObject<ListPositionAllocator>();
+    gnbPositions->Add(Vector(0.0, 0.0, 10.0));
+    Ptr<ListPositionAllocator> uePositions = CreateObject<ListPositionAllocator>();
+    for (uint16_t i = 0; i < ueNum; ++i)
+    {
+        const double angle = 2 * M_PI * i / ueNum;
+        uePositions->Add(Vector(distance * std::cos(angle), distance * std::sin(angle), 1.5));
+    }
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.SetPositionAllocator(gnbPositions);
+    mobility.Install(gnbNodes);
+    mobility.SetPositionAllocator(uePositions);
+    mobility.Install(ueNodes);
+
+    Ptr<NrPointToPointEpcHelper> epcHelper = CreateObject<NrPointToPointEpcHelper>();
+    Ptr<IdealBeamformingHelper> beamformingHelper = CreateObject<IdealBeamformingHelper>();
+    Ptr<NrHelper> nrHelper = CreateObject<NrHelper>();
+    nrHelper->SetBeamformingHelper(beamformingHelper);
+    nrHelper->SetEpcHelper(epcHelper);
+
+    beamformingHelper->SetAttribute("BeamformingMethod",
+                                    TypeIdValue(DirectPathBeamforming::GetTypeId()));
+
+    nrHelper->SetSchedulerTypeId(NrMacSchedulerTdmaRR::GetTypeId());
+
+    BandwidthPartInfoPtrVector allBwps;
+    CcBwpCreator ccBwpCreator;
+    CcBwpCreator::SimpleOperationBandConf bandConf(centralFrequency,
+                                                   bandwidth,
+                                                   1,
+                                                   BandwidthPartInfo::UMi_StreetCanyon_LoS);
+    OperationBandInfo band = ccBwpCreator.CreateOperationBandContiguousCc(bandConf);
+
+    Config::SetDefault("ns3::ThreeGppChannelModel::UpdatePeriod", TimeValue(MilliSeconds(0)));
+    nrHelper->SetChannelConditionModelAttribute("UpdatePeriod", TimeValue(MilliSeconds(0)));
+    nrHelper->SetPathlossAttribute("ShadowingEnabled", BooleanValue(false));
+    nrHelper->InitializeOperationBand(&band);
+    allBwps = CcBwpCreator::GetAllBwps({band});
+
+    epcHelper->SetAttribute("S1uLinkDelay", TimeValue(MilliSeconds(0)));
+
+    nrHelper->SetUeAntennaAttribute("NumRows", UintegerValue(1));
+    nrHelper->SetUeAntennaAttribute("NumColumns", UintegerValue(1));
+    nrHelper->SetUeAntennaAttribute("AntennaElement",
+                                    PointerValue(CreateObject<IsotropicAntennaModel>()));
+    nrHelper->SetGnbAntennaAttribute("NumRows", UintegerValue(4));
+    nrHelper->SetGnbAntennaAttribute("NumColumns", UintegerValue(4));
+    nrHelper->SetGnbAntennaAttribute("AntennaElement",
+                                     PointerValue(CreateObject<IsotropicAntennaModel>()));
+
+    nrHelper->SetGnbPhyAttribute("Numerology", UintegerValue(numerology));
+    nrHelper->SetGnbPhyAttribute("TxPower", DoubleValue(txPower));
+
+    NetDeviceContainer gnbNetDev = nrHelper->InstallGnbDevice(gnbNodes, allBwps);
+    NetDeviceContainer ueNetDev = nrHelper->InstallUeDevice(ueNodes, allBwps);
+
+    int64_t randomStream = 1;
+    randomStream += nrHelper->AssignStreams(gnbNetDev, randomStream);
+    randomStream += nrHelper->AssignStreams(ueNetDev, randomStream);
+
+    for (auto it = gnbNetDev.Begin(); it != gnbNetDev.End(); ++it)
+    {
+        DynamicCast<NrGnbNetDevice>(*it)->UpdateConfig();
+    }
+    for (auto it = ueNetDev.Begin(); it != ueNetDev.End(); ++it)
+    {
+        DynamicCast<NrUeNetDevice>(*it)->UpdateConfig();
+    }
+
+    Ptr<Node> pgw = epcHelper->GetPgwNode();
+    NodeContainer remoteHostContainer;
+    remoteHostContainer.Create(1);
+    Ptr<Node> remoteHost = remoteHostContainer.Get(0);
+    InternetStackHelper internet;
+    internet.Install(remoteHostContainer);
+
+    PointToPointHelper p2ph;
+    p2ph.SetDeviceAttribute("DataRate", DataRateValue(DataRate("100Gb/s")));
+    p2ph.SetDeviceAttribute("Mtu", UintegerValue(2500));
+    p2ph.SetChannelAttribute("Delay", TimeValue(Seconds(0.000)));
+    NetDeviceContainer internetDevices = p2ph.Install(pgw, remoteHost);
+    Ipv4AddressHelper ipv4h;
+    Ipv4StaticRoutingHelper ipv4RoutingHelper;
+    ipv4h.SetBase("1.0.0.0", "255.0.0.0");
+    Ipv4InterfaceContainer internetIpIfaces = ipv4h.Assign(internetDevices);
+    Ipv4Address remoteHostAddr = internetIpIfaces.GetAddress(1);
+    Ptr<Ipv4StaticRouting> remoteHostStaticRouting =
+        ipv4RoutingHelper.GetStaticRouting(remoteHost->GetObject<Ipv4>());
+    remoteHostStaticRouting->AddNetworkRouteTo(Ipv4Address("7.0.0.0"), Ipv4Mask("255.0.0.0"), 1);
+    internet.Install(ueNodes);
+
+    Ipv4InterfaceContainer ueIpIface = epcHelper->AssignUeIpv4Address(ueNetDev);
+    for (uint32_t j = 0; j < ueNodes.GetN(); ++j)
+    {
+        Ptr<Ipv4StaticRouting> ueStaticRouting =
+            ipv4RoutingHelper.GetStaticRouting(ueNodes.Get(j)->GetObject<Ipv4>());
+        ueStaticRouting->SetDefaultRoute(epcHelper->GetUeDefaultGatewayAddress(), 1);
+    }
+
+    nrHelper->AttachToClosestEnb(ueNetDev, gnbNetDev);
+
+    if (configuredGrant)
+    {
+        // One occasion per packet. The DL grant starts after the DL CTRL
+        // (symbol 0), the UL grant ends before the SRS (symbol 12) and the UL
+        // CTRL (symbol 13): the symbols in between are left to the dynamic
+        // scheduling. The UEs of the cell share the slots of a period.
+        const int64_t slotPeriodUs = 1000 >> numerology;
+        const auto periodicity = static_cast<uint16_t>(interval.GetMicroSeconds() / slotPeriodUs);
+        NS_ABORT_MSG_IF(periodicity == 0, "The interval must be at least a slot");
+        for (uint32_t j = 0; j < ueNetDev.GetN(); ++j)
+        {
+            NrConfiguredGrant grant;
+            grant.m_periodicity = periodicity;
+            grant.m_offset = j % periodicity;
+            grant.m_numSym = 2;
+            grant.m_mcs = static_cast<uint8_t>(cgMcs);
+
+            grant.m_format = DciInfoElementTdma::DL;
+            grant.m_symStart = 1;
+            nrHelper->AddConfiguredGrant(ueNetDev.Get(j), grant);
+
+            grant.m_format = DciInfoElementTdma::UL;
+            grant.m_symStart = 10;
+            nrHelper->AddConfiguredGrant(ueNetDev.Get(j), grant);
+        }
+    }
+
+    // A DL and a UL flow per UE, on the default bearer
+    const uint16_t dlPort = 1234;
+    const uint16_t ulPort = 2000;
+    ApplicationContainer serverApps;
+    ApplicationContainer clientApps;
+    UdpServerHelper dlPacketSink(dlPort);
+    serverApps.Add(dlPacketSink.Install(ueNodes));
+
+    UdpClientHelper client;
+    client.SetAttribute("MaxPackets", UintegerValue(0xFFFFFFFF));
+    client.SetAttribute("PacketSize", UintegerValue(packetSize));
+    client.SetAttribute("Interval", TimeValue(interval));
+    for (uint32_t j = 0; j < ueNodes.GetN(); ++j)
+    {
+        client.SetAttribute("RemotePort", UintegerValue(dlPort));
+        client.SetAttribute("RemoteAddress", AddressValue(ueIpIface.GetAddress(j)));
+        clientApps.Add(client.Install(remoteHost));
+
+        UdpServerHelper ulPacketSink(ulPort + j);
+        serverApps.Add(ulPacketSink.Install(remoteHost));
+        client.SetAttribute("RemotePort", UintegerValue(ulPort + j));
+        client.SetAttribute("RemoteAddress", AddressValue(remoteHostAddr));
+        clientApps.Add(client.Install(ueNodes.Get(j)));
+    }
+
+    serverApps.Start(appStartTime);
+    clientApps.Start(appStartTime);
+    serverApps.Stop(simTime);
+    clientApps.Stop(simTime);
+
+    FlowMonitorHelper flowmonHelper;
+    NodeContainer endpointNodes;
+    endpointNodes.Add(remoteHost);
+    endpointNodes.Add(ueNodes);
+    Ptr<FlowMonitor> monitor = flowmonHelper.Install(endpointNodes);
+
+    Simulator::Stop(simTime);
+    Simulator::Run();
+
+    monitor->CheckForLostPackets();
+    Ptr<Ipv4FlowClassifier> classifier =
+        DynamicCast<Ipv4FlowClassifier>(flowmonHelper.GetClassifier());
+    Time delaySum[2];
+    uint64_t rxPackets[2] = {0, 0};
+    for (const auto& flow : monitor->GetFlowStats())
+    {
+        const Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(flow.first);
+        const uint8_t dir = t.destinationPort == dlPort ? 0 : 1;
+        delaySum[dir] += flow.second.delaySum;
+        rxPackets[dir] += flow.second.rxPackets;
+    }
+
+    std::cout << "UEs: " << ueNum << " Grants: " << (configuredGrant ? "configured" : "dynamic");
+    const std::string dirName[2] = {"DL", "UL"};
+    for (uint8_t dir = 0; dir < 2; ++dir)
+    {
+        std::cout << " " << dirName[dir] << " mean delay: "
+                  << (rxPackets[dir] > 0 ? delaySum[dir].GetMicroSeconds() / rxPackets[dir] : 0)
+                  << " us";
+    }
+    std::cout << " Events: " << Simulator::GetEventCount() << std::endl;
+
+    Simulator::Destroy();
+    return 0;
+}
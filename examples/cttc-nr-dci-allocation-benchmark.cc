@@ -0,0 +1,297 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "ns3/core-module.h"
+#include "ns3/nr-module.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+
+/**
+ * \file cttc-nr-dci-allocation-benchmark.cc
+ * \ingroup examples
+ * \brief Heap allocations of the DCIs of the HARQ retransmissions
+ *
+ * The program replaces the global operator new with one that counts the
+ * calls, and then creates "numRetx" DL and UL retransmission DCIs of a first
+ * transmission with "streams" streams and "numRbg" RBGs, in two ways:
+ *
+ * - "before": as NrMacSchedulerHarqRr did before the DCI pool was used for
+ *   the retransmissions: std::make_shared, with each vector copied into the
+ *   parameter and then into the member of the DCI;
+ * - "after": as NrMacSchedulerHarqRr does now: NrMacSchedulerDciPool, with
+ *   the vectors moved into the DCI (DL) or copied from the first transmission
+ *   by the copy-except constructor (UL).
+ *
+ * As in the HARQ process, each retransmission replaces the previous one, so
+ * that the DCIs of the pool are recycled. The program prints the heap
+ * allocations and the time per retransmission of each way:
+ *
+ * \code{.unparsed}
+$ ./ns3 run "cttc-nr-dci-allocation-benchmark --streams=2"
+    \endcode
+ */
+
+using namespace ns3;
+
+static uint64_t g_numAllocations = 0; //!< Calls to the global operator new
+
+void*
+operator new(std::size_t size)
+{
+    ++g_numAllocations;
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete(void* p, std::size_t /* size */) noexcept
+{
+    std::free(p);
+}
+
+/**
+ * \brief The DL retransmission of a DCI, as it was created before the pool
+ * \param o the DCI of the previous transmission
+ * \return the DCI of the retransmission
+ */
+static std::shared_ptr<DciInfoElementTdma>
+DlRetxBefore(const DciInfoElementTdma& o)
+{
+    std::vector<uint32_t> tbSize(o.m_tbSize);
+    std::vector<uint8_t> ndi(o.m_ndi.size(), 0);
+    std::vector<uint8_t> rv(o.m_rv);
+    std::vector<uint8_t> mcs(o.m_mcs);
+    for (auto& r : rv)
+    {
+        r = (r + 1) % 4;
+    }
+    // The vectors were passed by copy, and the constructor copied them again
+    // into the members
+    std::vector<uint8_t> mcsArg(mcs);
+    std::vector<uint32_t> tbSizeArg(tbSize);
+    std::vector<uint8_t> ndiArg(ndi);
+    std::vector<uint8_t> rvArg(rv);
+    auto dci = std::make_shared<DciInfoElementTdma>(o.m_rnti,
+                                                    o.m_format,
+                                                    o.m_symStart,
+                                                    o.m_numSym,
+                                                    std::vector<uint8_t>(mcsArg),
+                                                    std::vector<uint32_t>(tbSizeArg),
+                                                    std::vector<uint8_t>(ndiArg),
+                                                    std::vector<uint8_t>(rvArg),
+                                                    DciInfoElementTdma::DATA,
+                                                    o.m_bwpIndex,
+                                                    o.m_tpc);
+    dci->m_rbgBitmask = o.m_rbgBitmask;
+    dci->m_harqProcess = o.m_harqProcess;
+    return dci;
+}
+
+/**
+ * \brief The DL retransmission of a DCI, as it is created by NrMacSchedulerHarqRr
+ * \param pool the DCI pool
+ * \param o the DCI of the previous transmission
+ * \return the DCI of the retransmission
+ */
+static std::shared_ptr<DciInfoElementTdma>
+DlRetxAfter(const NrMacSchedulerDciPool& pool, const DciInfoElementTdma& o)
+{
+    std::vector<uint32_t> tbSize(o.m_tbSize);
+    std::vector<uint8_t> ndi(o.m_ndi.size(), 0);
+    std::vector<uint8_t> rv(o.m_rv);
+    std::vector<uint8_t> mcs(o.m_mcs);
+    for (auto& r : rv)
+    {
+        r = (r + 1) % 4;
+    }
+    auto dci = pool.Create(o.m_rnti,
+                           o.m_format,
+                           o.m_symStart,
+                           o.m_numSym,
+                           std::move(mcs),
+                           std::move(tbSize),
+                           std::move(ndi),
+                           std::move(rv),
+                           DciInfoElementTdma::DATA,
+                           o.m_bwpIndex,
+                           o.m_tpc);
+    dci->m_rbgBitmask = o.m_rbgBitmask;
+    dci->m_harqProcess = o.m_harqProcess;
+    return dci;
+}
+
+/**
+ * \brief The UL retransmission of a DCI, as it was created before the pool
+ * \param o the DCI of the previous transmission
+ * \return the DCI of the retransmission
+ */
+static std::shared_ptr<DciInfoElementTdma>
+UlRetxBefore(const DciInfoElementTdma& o)
+{
+    uint8_t rvIndex = (o.m_rv.at(0) + 1) % 4;
+    std::vector<uint8_t> rv{rvIndex};
+    std::vector<uint8_t> ndi{0};
+    // As in DlRetxBefore, each vector was copied twice
+    std::vector<uint8_t> mcsArg(o.m_mcs);
+    std::vector<uint32_t> tbSizeArg(o.m_tbSize);
+    std::vector<uint8_t> ndiArg(ndi);
+    std::vector<uint8_t> rvArg(rv);
+    auto dci = std::make_shared<DciInfoElementTdma>(o.m_rnti,
+                                                    o.m_format,
+                                                    o.m_symStart,
+                                                    o.m_numSym,
+                                                    std::vector<uint8_t>(mcsArg),
+                                                    std::vector<uint32_t>(tbSizeArg),
+                                                    std::vector<uint8_t>(ndiArg),
+                                                    std::vector<uint8_t>(rvArg),
+                                                    DciInfoElementTdma::DATA,
+                                                    o.m_bwpIndex,
+                                                    o.m_tpc);
+    dci->m_rbgBitmask = o.m_rbgBitmask;
+    dci->m_harqProcess = o.m_harqProcess;
+    return dci;
+}
+
+/**
+ * \brief The UL retransmission of a DCI, as it is created by NrMacSchedulerHarqRr
+ * \param pool the DCI pool
+ * \param o the DCI of the previous transmission
+ * \return the DCI of the retransmission
+ */
+static std::shared_ptr<DciInfoElementTdma>
+UlRetxAfter(const NrMacSchedulerDciPool& pool, const DciInfoElementTdma& o)
+{
+    uint8_t rvIndex = (o.m_rv.at(0) + 1) % 4;
+    auto dci = pool.Create(o.m_symStart,
+                           o.m_numSym,
+                           std::vector<uint8_t>{0},
+                           std::vector<uint8_t>{rvIndex},
+                           o);
+    dci->m_harqProcess = o.m_harqProcess;
+    return dci;
+}
+
+/**
+ * \brief Result of a run
+ */
+struct Result
+{
+    double m_allocationsPerRetx{0.0}; //!< Heap allocations per retransmission
+    double m_nsPerRetx{0.0};          //!< Wall time per retransmission, in ns
+};
+
+/**
+ * \brief Create a chain of retransmissions, each one from the previous one
+ * \param first the first transmission
+ * \param numRetx the number of retransmissions
+ * \param retx the function that creates a retransmission
+ * \return the allocations and the time per retransmission
+ */
+template <typename Fn>
+static Result
+Run(const std::shared_ptr<DciInfoElementTdma>& first, uint32_t numRetx, Fn retx)
+{
+    std::shared_ptr<DciInfoElementTdma> dci = first;
+    const uint64_t allocations = g_numAllocations;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < numRetx; ++i)
+    {
+        dci = retx(*dci);
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    Result result;
+    result.m_allocationsPerRetx =
+        static_cast<double>(g_numAllocations - allocations) / static_cast<double>(numRetx);
+    result.m_nsPerRetx =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() /
+        static_cast<double>(numRetx);
+    return result;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t numRetx = 1000000;
+    uint16_t streams = 1;
+    uint16_t numRbg = 51;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("numRetx", "The number of retransmissions of each run", numRetx);
+    cmd.AddValue("streams", "The number of streams of the DL DCIs", streams);
+    cmd.AddValue("numRbg", "The number of RBGs of the bandwidth", numRbg);
+    cmd.Parse(argc, argv);
+
+    NS_ABORT_MSG_IF(numRetx == 0, "At least one retransmission is needed");
+    NS_ABORT_MSG_IF(streams == 0 || streams > 2, "The DL DCIs can have one or two streams");
+
+    NrMacSchedulerDciPool pool;
+    auto dlFirst = pool.Create(1,
+                               DciInfoElementTdma::DL,
+                               1,
+                               4,
+                               std::vector<uint8_t>(streams, 10),
+                               std::vector<uint32_t>(streams, 1500),
+                               std::vector<uint8_t>(streams, 1),
+                               std::vector<uint8_t>(streams, 0),
+                               DciInfoElementTdma::DATA,
+                               0,
+                               1);
+    dlFirst->m_rbgBitmask = std::vector<uint8_t>(numRbg, 1);
+    auto ulFirst = pool.Create(1,
+                               DciInfoElementTdma::UL,
+                               9,
+                               4,
+                               std::vector<uint8_t>{10},
+                               std::vector<uint32_t>{1500},
+                               std::vector<uint8_t>{1},
+                               std::vector<uint8_t>{0},
+                               DciInfoElementTdma::DATA,
+                               0,
+                               1);
+    ulFirst->m_rbgBitmask = std::vector<uint8_t>(numRbg, 1);
+
+    const Result dlBefore = Run(dlFirst, numRetx, &DlRetxBefore);
+    const Result dlAfter = Run(dlFirst, numRetx, [&pool](const DciInfoElementTdma& o) {
+        return DlRetxAfter(pool, o);
+    });
+    const Result ulBefore = Run(ulFirst, numRetx, &UlRetxBefore);
+    const Result ulAfter = Run(ulFirst, numRetx, [&pool](const DciInfoElementTdma& o) {
+        return UlRetxAfter(pool, o);
+    });
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Retransmissions per run: " << numRetx << ", DL streams: " << streams
+              << ", RBGs: " << numRbg << std::endl;
+    std::cout << "        allocations/retx   ns/retx" << std::endl;
+    std::cout << "DL before  " << std::setw(14) << dlBefore.m_allocationsPerRetx << std::setw(10)
+              << dlBefore.m_nsPerRetx << std::endl;
+    std::cout << "DL after   " << std::setw(14) << dlAfter.m_allocationsPerRetx << std::setw(10)
+              << dlAfter.m_nsPerRetx << std::endl;
+    std::cout << "UL before  " << std::setw(14) << ulBefore.m_allocationsPerRetx << std::setw(10)
+              << ulBefore.m_nsPerRetx << std::endl;
+    std::cout << "UL after   " << std::setw(14) << ulAfter.m_allocationsPerRetx << std::setw(10)
+              << ulAfter.m_nsPerRetx << std::endl;
+    std::cout << "DCIs created by the pool: " << pool.GetNumCreated()
+              << ", system allocations of the pool: " << pool.GetNumSystemAllocations()
+              << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,356 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "ns3/antenna-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/flow-monitor-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include "ns3/nr-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include <iostream>
+
+/**
+ * \file cttc-nr-mini-slot-preemption.cc
+ * \ingroup examples
+ * \brief Latency of URLLC packets, with or without mini-slots
+ *
+ * A gNB serves "embbUeNum" eMBB UEs, which receive a saturating DL UDP flow on
+ * the default bearer, and "urllcUeNum" URLLC UEs, which receive a small DL UDP
+ * packet every "urllcInterval" on a delay-critical GBR bearer. Without
+ * mini-slots, a URLLC packet waits for the next slot. With
+ * "--miniSlotSymbols=2" (or 4, 7), the gNB checks the scheduler every
+ * mini-slot, and the URLLC packets that arrived in the meantime preempt the
+ * symbols of the eMBB allocations that did not start yet. The program prints
+ * the percentiles of the URLLC delay, the eMBB throughput, and the eMBB TBs and
+ * bytes preempted by the mini-slots:
+ *
+ * \code{.unparsed}
+$ for m in 0 2 4 7; do ./ns3 run "cttc-nr-mini-slot-preemption --miniSlotSymbols=$m"; done
+    \endcode
+ */
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("CttcNrMiniSlotPreemption");
+
+static uint32_t g_preemptedTbs = 0;   //!< Number of eMBB TBs preempted by a mini-slot
+static uint64_t g_preemptedBytes = 0; //!< Bytes of the eMBB TBs preempted by a mini-slot
+static uint32_t g_miniSlotTbs = 0;    //!< Number of TBs sent in a mini-slot
+
+static void
+DlPreemption(const SfnSf& sfn,
+             uint16_t rnti,
+             uint8_t symStart,
+             uint8_t numSym,
+             uint32_t tbSize,
+             uint16_t bwpId,
+             uint16_t cellId)
+{
+    ++g_preemptedTbs;
+    g_preemptedBytes += tbSize;
+}
+
+static void
+DlMiniSlot(const SfnSf& sfn,
+           uint16_t rnti,
+           uint8_t symStart,
+           uint8_t numSym,
+           uint32_t tbSize,
+           uint16_t bwpId,
+           uint16_t cellId)
+{
+    ++g_miniSlotTbs;
+}
+
+/**
+ * \brief Delay below which a ratio of the packets of a histogram is received
+ * \param histogram the delay histogram
+ * \param ratio the ratio of the packets, between 0 and 1
+ * \return the end of the bin that contains the percentile, in seconds
+ */
+static double
+Percentile(const Histogram& histogram, double ratio)
+{
+    uint64_t total = 0;
+    for (uint32_t bin = 0; bin < histogram.GetNBins(); ++bin)
+    {
+        total += histogram.GetBinCount(bin);
+    }
+    uint64_t count = 0;
+    for (uint32_t bin = 0; bin < histogram.GetNBins(); ++bin)
+    {
+        count += histogram.GetBinCount(bin);
+        if (count >= ratio * total)
+        {
+            return histogram.GetBinEnd(bin);
+        }
+    }
+    return 0.0;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint16_t embbUeNum = 2;
+    uint16_t urllcUeNum = 2;
+    uint16_t miniSlotSymbols = 0;
+    uint16_t numerology = 1;
+    double centralFrequency = 3.5e9;
+    double bandwidth = 20e6;
+    double txPower = 30;
+    double distance = 50.0;
+    uint32_t urllcPacketSize = 32;
+    Time urllcInterval = MicroSeconds(1100);
+    DataRate embbRate("60Mb/s");
+    uint32_t embbPacketSize = 1400;
+    Time simTime = MilliSeconds(1400);
+    Time appStartTime = MilliSeconds(400);
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("embbUeNum", "The number of eMBB UEs", embbUeNum);
+    cmd.AddValue("urllcUeNum", "The number of URLLC UEs", urllcUeNum);
+    cmd.AddValue("miniSlotSymbols",
+                 "The symbols of the DL mini-slots (2, 4, 7), or 0 to disable them",
+                 miniSlotSymbols);
+    cmd.AddValue("numerology", "The numerology of the BWP", numerology);
+    cmd.AddValue("centralFrequency", "The central frequency of the band", centralFrequency);
+    cmd.AddValue("bandwidth", "The bandwidth of the band", bandwidth);
+    cmd.AddValue("txPower", "The tx power (dBm) of the gNB", txPower);
+    cmd.AddValue("distance", "The distance (m) between the gNB and the UEs", distance);
+    cmd.AddValue("urllcPacketSize", "The size of the URLLC packets", urllcPacketSize);
+    cmd.AddValue("urllcInterval", "The interval between the URLLC packets", urllcInterval);
+    cmd.AddValue("embbRate", "The offered DL rate of each eMBB UE", embbRate);
+    cmd.AddValue("simTime", "Simulation time", simTime);
+    cmd.Parse(argc, argv);
+
+    NS_ABORT_MSG_IF(embbUeNum + urllcUeNum == 0, "At least one UE is needed");
+
+    NodeContainer gnbNodes;
+    gnbNodes.Create(1);
+    NodeContainer embbUeNodes;
+    embbUeNodes.Create(embbUeNum);
+    NodeContainer urllcUeNodes;
+    urllcUeNodes.Create(urllcUeNum);
+    NodeContainer ueNodes;
+    ueNodes.Add(embbUeNodes);
+    ueNodes.Add(urllcUeNodes);
+
+    Ptr<ListPositionAllocator> gnbPositions = CreateObject<ListPositionAllocator>();
+    gnbPositions->Add(Vector(0.0, 0.0, 10.0));
+    Ptr<ListPositionAllocator> uePositions = CreateObject<ListPositionAllocator>();
+    for (uint32_t i = 0; i < ueNodes.GetN(); ++i)
+    {
+        const double angle = 2 * M_PI * i / ueNodes.GetN();
+        uePositions->Add(Vector(distance * std::cos(angle), distance * std::sin(angle), 1.5));
+    }
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.SetPositionAllocator(gnbPositions);
+    mobility.Install(gnbNodes);
+    mobility.SetPositionAllocator(uePositions);
+    mobility.Install(ueNodes);
+
+    Ptr<NrPointToPointEpcHelper> epcHelper = CreateObject<NrPointToPointEpcHelper>();
+    Ptr<IdealBeamformingHelper> beamformingHelper = CreateObject<IdealBeamformingHelper>();
+    Ptr<NrHelper> nrHelper = CreateObject<NrHelper>();
+    nrHelper->SetBeamformingHelper(beamformingHelper);
+    nrHelper->SetEpcHelper(epcHelper);
+
+    beamformingHelper->SetAttribute("BeamformingMethod",
+                                    TypeIdValue(DirectPathBeamforming::GetTypeId()));
+
+    nrHelper->SetSchedulerTypeId(NrMacSchedulerTdmaRR::GetTypeId());
+
+    BandwidthPartInfoPtrVector allBwps;
+    CcBwpCreator ccBwpCreator;
+    CcBwpCreator::SimpleOperationBandConf bandConf(centralFrequency,
+                                                   bandwidth,
+                                                   1,
+                                                   BandwidthPartInfo::UMi_StreetCanyon_LoS);
+    OperationBandInfo band = ccBwpCreator.CreateOperationBandContiguousCc(bandConf);
+
+    Config::SetDefault("ns3::ThreeGppChannelModel::UpdatePeriod", TimeValue(MilliSeconds(0)));
+    nrHelper->SetChannelConditionModelAttribute("UpdatePeriod", TimeValue(MilliSeconds(0)));
+    nrHelper->SetPathlossAttribute("ShadowingEnabled", BooleanValue(false));
+    nrHelper->InitializeOperationBand(&band);
+    allBwps = CcBwpCreator::GetAllBwps({band});
+
+    epcHelper->SetAttribute("S1uLinkDelay", TimeValue(MilliSeconds(0)));
+
+    nrHelper->SetUeAntennaAttribute("NumRows", UintegerValue(1));
+    nrHelper->SetUeAntennaAttribute("NumColumns", UintegerValue(1));
+    nrHelper->SetUeAntennaAttribute("AntennaElement",
+                                    PointerValue(CreateObject<IsotropicAntennaModel>()));
+    nrHelper->SetGnbAntennaAttribute("NumRows", UintegerValue(4));
+    nrHelper->SetGnbAntennaAttribute("NumColumns", UintegerValue(4));
+    nrHelper->SetGnbAntennaAttribute("AntennaElement",
+                                     PointerValue(CreateObject<IsotropicAntennaModel>()));
+
+    nrHelper->SetGnbPhyAttribute("Numerology", UintegerValue(numerology));
+    nrHelper->SetGnbPhyAttribute("TxPower", DoubleValue(txPower));
+    nrHelper->SetGnbPhyAttribute("MiniSlotSymbols", UintegerValue(miniSlotSymbols));
+
+    NetDeviceContainer gnbNetDev = nrHelper->InstallGnbDevice(gnbNodes, allBwps);
+    NetDeviceContainer embbUeNetDev = nrHelper->InstallUeDevice(embbUeNodes, allBwps);
+    NetDeviceContainer urllcUeNetDev = nrHelper->InstallUeDevice(urllcUeNodes, allBwps);
+
+    int64_t randomStream = 1;
+    randomStream += nrHelper->AssignStreams(gnbNetDev, randomStream);
+    randomStream += nrHelper->AssignStreams(embbUeNetDev, randomStream);
+    randomStream += nrHelper->AssignStreams(urllcUeNetDev, randomStream);
+
+    for (auto it = gnbNetDev.Begin(); it != gnbNetDev.End(); ++it)
+    {
+        DynamicCast<NrGnbNetDevice>(*it)->UpdateConfig();
+    }
+    NetDeviceContainer ueNetDev;
+    ueNetDev.Add(embbUeNetDev);
+    ueNetDev.Add(urllcUeNetDev);
+    for (auto it = ueNetDev.Begin(); it != ueNetDev.End(); ++it)
+    {
+        DynamicCast<NrUeNetDevice>(*it)->UpdateConfig();
+    }
+
+    Ptr<NrGnbPhy> gnbPhy = NrHelper::GetGnbPhy(gnbNetDev.Get(0), 0);
+    gnbPhy->TraceConnectWithoutContext("DlPreemption", MakeCallback(&DlPreemption));
+    gnbPhy->TraceConnectWithoutContext("DlMiniSlot", MakeCallback(&DlMiniSlot));
+
+    Ptr<Node> pgw = epcHelper->GetPgwNode();
+    NodeContainer remoteHostContainer;
+    remoteHostContainer.Create(1);
+    Ptr<Node> remoteHost = remoteHostContainer.Get(0);
+    InternetStackHelper internet;
+    internet.Install(remoteHostContainer);
+
+    PointToPointHelper p2ph;
+    p2ph.SetDeviceAttribute("DataRate", DataRateValue(DataRate("100Gb/s")));
+    p2ph.SetDeviceAttribute("Mtu", UintegerValue(2500));
+    p2ph.SetChannelAttribute("Delay", TimeValue(Seconds(0.000)));
+    NetDeviceContainer internetDevices = p2ph.Install(pgw, remoteHost);
+    Ipv4AddressHelper ipv4h;
+    Ipv4StaticRoutingHelper ipv4RoutingHelper;
+    ipv4h.SetBase("1.0.0.0", "255.0.0.0");
+    ipv4h.Assign(internetDevices);
+    Ptr<Ipv4StaticRouting> remoteHostStaticRouting =
+        ipv4RoutingHelper.GetStaticRouting(remoteHost->GetObject<Ipv4>());
+    remoteHostStaticRouting->AddNetworkRouteTo(Ipv4Address("7.0.0.0"), Ipv4Mask("255.0.0.0"), 1);
+    internet.Install(ueNodes);
+
+    Ipv4InterfaceContainer ueIpIface = epcHelper->AssignUeIpv4Address(ueNetDev);
+    for (uint32_t j = 0; j < ueNodes.GetN(); ++j)
+    {
+        Ptr<Ipv4StaticRouting> ueStaticRouting =
+            ipv4RoutingHelper.GetStaticRouting(ueNodes.Get(j)->GetObject<Ipv4>());
+        ueStaticRouting->SetDefaultRoute(epcHelper->GetUeDefaultGatewayAddress(), 1);
+    }
+
+    nrHelper->AttachToClosestEnb(ueNetDev, gnbNetDev);
+
+    // The eMBB flows use the default bearer, the URLLC flows a delay-critical
+    // GBR bearer: the scheduler serves the latter in the mini-slots
+    const uint16_t embbPort = 1234;
+    const uint16_t urllcPort = 1235;
+    ApplicationContainer serverApps;
+    ApplicationContainer clientApps;
+    UdpServerHelper embbPacketSink(embbPort);
+    serverApps.Add(embbPacketSink.Install(embbUeNodes));
+    UdpServerHelper urllcPacketSink(urllcPort);
+    serverApps.Add(urllcPacketSink.Install(urllcUeNodes));
+
+    UdpClientHelper embbClient;
+    embbClient.SetAttribute("MaxPackets", UintegerValue(0xFFFFFFFF));
+    embbClient.SetAttribute("PacketSize", UintegerValue(embbPacketSize));
+    embbClient.SetAttribute("Interval", TimeValue(embbRate.CalculateBytesTxTime(embbPacketSize)));
+    embbClient.SetAttribute("RemotePort", UintegerValue(embbPort));
+    for (uint32_t j = 0; j < embbUeNodes.GetN(); ++j)
+    {
+        embbClient.SetAttribute("RemoteAddress", AddressValue(ueIpIface.GetAddress(j)));
+        clientApps.Add(embbClient.Install(remoteHost));
+    }
+
+    UdpClientHelper urllcClient;
+    urllcClient.SetAttribute("MaxPackets", UintegerValue(0xFFFFFFFF));
+    urllcClient.SetAttribute("PacketSize", UintegerValue(urllcPacketSize));
+    urllcClient.SetAttribute("Interval", TimeValue(urllcInterval));
+    urllcClient.SetAttribute("RemotePort", UintegerValue(urllcPort));
+
+    EpsBearer urllcBearer(EpsBearer::DGBR_DISCRETE_AUT_SMALL);
+    Ptr<EpcTft> urllcTft = Create<EpcTft>();
+    EpcTft::PacketFilter urllcPf;
+    urllcPf.localPortStart = urllcPort;
+    urllcPf.localPortEnd = urllcPort;
+    urllcTft->Add(urllcPf);
+    for (uint32_t j = 0; j < urllcUeNodes.GetN(); ++j)
+    {
+        urllcClient.SetAttribute("RemoteAddress",
+                                 AddressValue(ueIpIface.GetAddress(embbUeNodes.GetN() + j)));
+        clientApps.Add(urllcClient.Install(remoteHost));
+        nrHelper->ActivateDedicatedEpsBearer(urllcUeNetDev.Get(j), urllcBearer, urllcTft);
+    }
+
+    serverApps.Start(appStartTime);
+    clientApps.Start(appStartTime);
+    serverApps.Stop(simTime);
+    clientApps.Stop(simTime);
+
+    FlowMonitorHelper flowmonHelper;
+    flowmonHelper.SetMonitorAttribute("DelayBinWidth", DoubleValue(0.0001));
+    NodeContainer endpointNodes;
+    endpointNodes.Add(remoteHost);
+    endpointNodes.Add(ueNodes);
+    Ptr<FlowMonitor> monitor = flowmonHelper.Install(endpointNodes);
+
+    Simulator::Stop(simTime);
+    Simulator::Run();
+
+    monitor->CheckForLostPackets();
+    Ptr<Ipv4FlowClassifier> classifier =
+        DynamicCast<Ipv4FlowClassifier>(flowmonHelper.GetClassifier());
+    Histogram urllcDelay(0.0001);
+    uint64_t urllcRxPackets = 0;
+    uint64_t urllcTxPackets = 0;
+    uint64_t embbRxBytes = 0;
+    for (const auto& flow : monitor->GetFlowStats())
+    {
+        const Ipv4FlowClassifier::FiveTuple t = classifier->FindFlow(flow.first);
+        if (t.destinationPort == urllcPort)
+        {
+            const Histogram& h = flow.second.delayHistogram;
+            for (uint32_t bin = 0; bin < h.GetNBins(); ++bin)
+            {
+                const double binCenter = (h.GetBinStart(bin) + h.GetBinEnd(bin)) / 2;
+                for (uint32_t k = 0; k < h.GetBinCount(bin); ++k)
+                {
+                    urllcDelay.AddValue(binCenter);
+                }
+            }
+            urllcRxPackets += flow.second.rxPackets;
+            urllcTxPackets += flow.second.txPackets;
+        }
+        else if (t.destinationPort == embbPort)
+        {
+            embbRxBytes += flow.second.rxBytes;
+        }
+    }
+
+    const double appDuration = (simTime - appStartTime).GetSeconds();
+    std::cout << "Mini-slot symbols: " << miniSlotSymbols << std::endl;
+    std::cout << "URLLC packets received: " << urllcRxPackets << "/" << urllcTxPackets
+              << ", delay (us) p50: " << Percentile(urllcDelay, 0.5) * 1e6
+              << " p99: " << Percentile(urllcDelay, 0.99) * 1e6
+              << " p99.9: " << Percentile(urllcDelay, 0.999) * 1e6 << std::endl;
+    std::cout << "eMBB throughput: " << embbRxBytes * 8.0 / appDuration / 1e6 << " Mbps"
+              << std::endl;
+    std::cout << "Mini-slot TBs: " << g_miniSlotTbs << ", eMBB TBs preempted: " << g_preemptedTbs
+              << " (" << g_preemptedBytes << " bytes)" << std::endl;
+
+    Simulator::Destroy();
+    return 0;
+}
@@ -0,0 +1,241 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "ns3/antenna-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/flow-monitor-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include "ns3/nr-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include <iostream>
+
+/**
+ * \file cttc-nr-mu-mimo-benchmark.cc
+ * \ingroup examples
+ * \brief DL cell throughput of the OFDMA schedulers, with and without MU-MIMO
+ *
+ * A gNB serves "ueNum" UEs, placed on an arc in front of its antenna, at the
+ * same distance, so that they are reached through beams of different sectors.
+ * Each UE receives a saturating DL UDP flow, and the program prints the number
+ * of UEs, whether MU-MIMO is enabled (attribute EnableMuMimo of
+ * NrMacSchedulerOfdma), and the cell throughput in Mbps. Without MU-MIMO, the
+ * beams take turns on the symbols of the slot; with MU-MIMO, the beams that
+ * are far enough share the symbols, as different layers. Running the program
+ * for increasing loads gives the throughput-versus-load curves of both modes:
+ *
+ * \code{.unparsed}
+$ for ues in 2 4 8 16; do for mu in 0 1; do
+    ./ns3 run "cttc-nr-mu-mimo-benchmark --ueNum=$ues --enableMuMimo=$mu"; done; done
+    \endcode
+ *
+ * The grouping of the beams is set with "--ns3::NrMacSchedulerOfdma::MuMimo...".
+ */
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("CttcNrMuMimoBenchmark");
+
+int
+main(int argc, char* argv[])
+{
+    uint16_t ueNum = 8;
+    bool enableMuMimo = true;
+    std::string scheduler = "ns3::NrMacSchedulerOfdmaRR";
+    double distance = 50.0;
+    double arc = 150.0;
+    uint16_t numerology = 1;
+    double centralFrequency = 28e9;
+    double bandwidth = 50e6;
+    double txPower = 30;
+    uint32_t packetSize = 1000;
+    DataRate ueRate("200Mb/s");
+    Time simTime = MilliSeconds(1000);
+    Time appStartTime = MilliSeconds(400);
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("ueNum", "The number of UEs of the cell", ueNum);
+    cmd.AddValue("enableMuMimo", "Co-schedule the separated beams (MU-MIMO)", enableMuMimo);
+    cmd.AddValue("scheduler", "The TypeId of the OFDMA scheduler", scheduler);
+    cmd.AddValue("distance", "The distance (m) between the gNB and the UEs", distance);
+    cmd.AddValue("arc", "The angle (degrees) of the arc on which the UEs are spread", arc);
+    cmd.AddValue("numerology", "The numerology of the BWP", numerology);
+    cmd.AddValue("centralFrequency", "The central frequency of the band", centralFrequency);
+    cmd.AddValue("bandwidth", "The bandwidth of the band", bandwidth);
+    cmd.AddValue("txPower", "The tx power (dBm) of the gNB", txPower);
+    cmd.AddValue("packetSize", "The size of the UDP packets", packetSize);
+    cmd.AddValue("ueRate", "The DL rate offered to each UE", ueRate);
+    cmd.AddValue("simTime", "Simulation time", simTime);
+    cmd.Parse(argc, argv);
+
+    NS_ABORT_MSG_IF(ueNum == 0, "At least one UE is needed");
+    NS_ABORT_MSG_IF(!TypeId::LookupByName(scheduler).IsChildOf(NrMacSchedulerOfdma::GetTypeId()),
+                    scheduler << " is not an OFDMA scheduler");
+
+    Config::SetDefault("ns3::LteRlcUm::MaxTxBufferSize", UintegerValue(999999999));
+
+    NodeContainer gnbNodes;
+    gnbNodes.Create(1);
+    NodeContainer ueNodes;
+    ueNodes.Create(ueNum);
+
+    // The gNB antenna points to the positive x axis: the UEs are spread on an
+    // arc, centered on that direction
+    Ptr<ListPositionAllocator> gnbPositions = CreateObject<ListPositionAllocator>();
+    gnbPositions->Add(Vector(0.0, 0.0, 10.0));
+    Ptr<ListPositionAllocator> uePositions = CreateObject<ListPositionAllocator>();
+    for (uint16_t i = 0; i < ueNum; ++i)
+    {
+        const double degrees = ueNum > 1 ? -arc / 2 + i * arc / (ueNum - 1) : 0.0;
+        const double angle = degrees * M_PI / 180;
+        uePositions->Add(Vector(distance * std::cos(angle), distance * std::sin(angle), 1.5));
+    }
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.SetPositionAllocator(gnbPositions);
+    mobility.Install(gnbNodes);
+    mobility.SetPositionAllocator(uePositions);
+    mobility.Install(ueNodes);
+
+    Ptr<NrPointToPointEpcHelper> epcHelper = CreateObject<NrPointToPointEpcHelper>();
+    Ptr<IdealBeamformingHelper> beamformingHelper = CreateObject<IdealBeamformingHelper>();
+    Ptr<NrHelper> nrHelper = CreateObject<NrHelper>();
+    nrHelper->SetBeamformingHelper(beamformingHelper);
+    nrHelper->SetEpcHelper(epcHelper);
+
+    // The beams are identified by their sector, which the MU-MIMO grouping uses
+    beamformingHelper->SetAttribute("BeamformingMethod",
+                                    TypeIdValue(CellScanBeamforming::GetTypeId()));
+
+    nrHelper->SetSchedulerTypeId(TypeId::LookupByName(scheduler));
+    nrHelper->SetSchedulerAttribute("EnableMuMimo", BooleanValue(enableMuMimo));
+
+    BandwidthPartInfoPtrVector allBwps;
+    CcBwpCreator ccBwpCreator;
+    CcBwpCreator::SimpleOperationBandConf bandConf(centralFrequency,
+                                                   bandwidth,
+                                                   1,
+                                                   BandwidthPartInfo::UMa_LoS);
+    OperationBandInfo band = ccBwpCreator.CreateOperationBandContiguousCc(bandConf);
+
+    Config::SetDefault("ns3::ThreeGppChannelModel::UpdatePeriod", TimeValue(MilliSeconds(0)));
+    nrHelper->SetChannelConditionModelAttribute("UpdatePeriod", TimeValue(MilliSeconds(0)));
+    nrHelper->SetPathlossAttribute("ShadowingEnabled", BooleanValue(false));
+    nrHelper->InitializeOperationBand(&band);
+    allBwps = CcBwpCreator::GetAllBwps({band});
+
+    epcHelper->SetAttribute("S1uLinkDelay", TimeValue(MilliSeconds(0)));
+
+    nrHelper->SetUeAntennaAttribute("NumRows", UintegerValue(2));
+    nrHelper->SetUeAntennaAttribute("NumColumns", UintegerValue(2));
+    nrHelper->SetUeAntennaAttribute("AntennaElement",
+                                    PointerValue(CreateObject<IsotropicAntennaModel>()));
+    nrHelper->SetGnbAntennaAttribute("NumRows", UintegerValue(8));
+    nrHelper->SetGnbAntennaAttribute("NumColumns", UintegerValue(8));
+    nrHelper->SetGnbAntennaAttribute("AntennaElement",
+                                     PointerValue(CreateObject<ThreeGppAntennaModel>()));
+
+    nrHelper->SetGnbPhyAttribute("Numerology", UintegerValue(numerology));
+    nrHelper->SetGnbPhyAttribute("TxPower", DoubleValue(txPower));
+
+    NetDeviceContainer gnbNetDev = nrHelper->InstallGnbDevice(gnbNodes, allBwps);
+    NetDeviceContainer ueNetDev = nrHelper->InstallUeDevice(ueNodes, allBwps);
+
+    int64_t randomStream = 1;
+    randomStream += nrHelper->AssignStreams(gnbNetDev, randomStream);
+    randomStream += nrHelper->AssignStreams(ueNetDev, randomStream);
+
+    for (auto it = gnbNetDev.Begin(); it != gnbNetDev.End(); ++it)
+    {
+        DynamicCast<NrGnbNetDevice>(*it)->UpdateConfig();
+    }
+    for (auto it = ueNetDev.Begin(); it != ueNetDev.End(); ++it)
+    {
+        DynamicCast<NrUeNetDevice>(*it)->UpdateConfig();
+    }
+
+    Ptr<Node> pgw = epcHelper->GetPgwNode();
+    NodeContainer remoteHostContainer;
+    remoteHostContainer.Create(1);
+    Ptr<Node> remoteHost = remoteHostContainer.Get(0);
+    InternetStackHelper internet;
+    internet.Install(remoteHostContainer);
+
+    PointToPointHelper p2ph;
+    p2ph.SetDeviceAttribute("DataRate", DataRateValue(DataRate("100Gb/s")));
+    p2ph.SetDeviceAttribute("Mtu", UintegerValue(2500));
+    p2ph.SetChannelAttribute("Delay", TimeValue(Seconds(0.000)));
+    NetDeviceContainer internetDevices = p2ph.Install(pgw, remoteHost);
+    Ipv4AddressHelper ipv4h;
+    Ipv4StaticRoutingHelper ipv4RoutingHelper;
+    ipv4h.SetBase("1.0.0.0", "255.0.0.0");
+    ipv4h.Assign(internetDevices);
+    Ptr<Ipv4StaticRouting> remoteHostStaticRouting =
+        ipv4RoutingHelper.GetStaticRouting(remoteHost->GetObject<Ipv4>());
+    remoteHostStaticRouting->AddNetworkRouteTo(Ipv4Address("7.0.0.0"), Ipv4Mask("255.0.0.0"), 1);
+    internet.Install(ueNodes);
+
+    Ipv4InterfaceContainer ueIpIface = epcHelper->AssignUeIpv4Address(ueNetDev);
+    for (uint32_t j = 0; j < ueNodes.GetN(); ++j)
+    {
+        Ptr<Ipv4StaticRouting> ueStaticRouting =
+            ipv4RoutingHelper.GetStaticRouting(ueNodes.Get(j)->GetObject<Ipv4>());
+        ueStaticRouting->SetDefaultRoute(epcHelper->GetUeDefaultGatewayAddress(), 1);
+    }
+
+    nrHelper->AttachToClosestEnb(ueNetDev, gnbNetDev);
+
+    // A saturating DL flow per UE, on the default bearer
+    const uint16_t dlPort = 1234;
+    ApplicationContainer serverApps;
+    ApplicationContainer clientApps;
+    UdpServerHelper dlPacketSink(dlPort);
+    serverApps.Add(dlPacketSink.Install(ueNodes));
+
+    UdpClientHelper dlClient;
+    dlClient.SetAttribute("RemotePort", UintegerValue(dlPort));
+    dlClient.SetAttribute("MaxPackets", UintegerValue(0xFFFFFFFF));
+    dlClient.SetAttribute("PacketSize", UintegerValue(packetSize));
+    dlClient.SetAttribute("Interval",
+                          TimeValue(Seconds(packetSize * 8.0 / ueRate.GetBitRate())));
+    for (uint32_t j = 0; j < ueNodes.GetN(); ++j)
+    {
+        dlClient.SetAttribute("RemoteAddress", AddressValue(ueIpIface.GetAddress(j)));
+        clientApps.Add(dlClient.Install(remoteHost));
+    }
+
+    serverApps.Start(appStartTime);
+    clientApps.Start(appStartTime);
+    serverApps.Stop(simTime);
+    clientApps.Stop(simTime);
+
+    FlowMonitorHelper flowmonHelper;
+    NodeContainer endpointNodes;
+    endpointNodes.Add(remoteHost);
+    endpointNodes.Add(ueNodes);
+    Ptr<FlowMonitor> monitor = flowmonHelper.Install(endpointNodes);
+
+    Simulator::Stop(simTime);
+    Simulator::Run();
+
+    monitor->CheckForLostPackets();
+    uint64_t rxBytes = 0;
+    for (const auto& flow : monitor->GetFlowStats())
+    {
+        rxBytes += flow.second.rxBytes;
+    }
+    const double flowDuration = (simTime - appStartTime).GetSeconds();
+
+    std::cout << "UEs: " << ueNum << " MU-MIMO: " << (enableMuMimo ? "on" : "off")
+              << " Cell throughput: " << rxBytes * 8.0 / flowDuration / 1e6 << " Mbps"
+              << std::endl;
+
+    Simulator::Destroy();
+    return 0;
+}
@@ -0,0 +1,439 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "ns3/core-module.h"
+#include "ns3/nr-module.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+
+/**
+ * \file cttc-nr-scheduler-class-benchmark.cc
+ * \ingroup examples
+ * \brief Slots per second and memory per UE of the schedulers with a large
+ * number of low-rate UEs
+ *
+ * For each number of UEs in "ueNums", the program writes a synthetic
+ * scheduler trace (see NrMacSchedulerTrace) of a cell whose UEs are spread
+ * over "beamNum" beams, and whose WB CQI takes one of a few values. Each UE
+ * reports a CQI every "cqiPeriod", and receives "packetsPerUe" DL packets of
+ * "packetSize" bytes, one every "interval"; the arrivals of the UEs are spread
+ * over the interval. The trace is then replayed (see NrMacSchedulerReplay) on
+ * each scheduler in "schedulers", and the program prints a table with the
+ * slots scheduled per second of wall time spent inside the scheduler, the
+ * heap memory held by the scheduler at the end of the replay, per UE, and the
+ * number of UEs with a full representation (see
+ * NrMacSchedulerNs3::GetNumUeRepresentations). By default, the OFDMA RR
+ * scheduler and NrMacSchedulerOfdmaClass are compared at 10k and 50k UEs:
+ *
+ * \code{.unparsed}
+$ ./ns3 run cttc-nr-scheduler-class-benchmark
+    \endcode
+ *
+ * With its default attribute "CompactIdleUes", NrMacSchedulerOfdmaClass keeps
+ * only a compact record of the UEs that have nothing to transmit, so its
+ * memory per UE is a fraction of the one of the OFDMA RR scheduler, which
+ * keeps the full NrMacSchedulerUeInfo of every UE.
+ *
+ * The memory is counted by replacing the global operator new and delete of
+ * the program. The trace has no HARQ feedback: "packetsPerUe" should not be
+ * larger than the number of HARQ processes.
+ */
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("CttcNrSchedulerClassBenchmark");
+
+static std::atomic<int64_t> g_heapBytes{0}; //!< Bytes allocated and not yet freed
+
+/**
+ * \brief Room before each block, where its size is kept
+ */
+static constexpr std::size_t HEAP_HEADER = alignof(std::max_align_t);
+
+/**
+ * \brief Allocate a block, and count its bytes
+ * \param size the size of the block
+ * \return the block, or nullptr if out of memory
+ */
+static void*
+CountedAlloc(std::size_t size)
+{
+    void* block = std::malloc(size + HEAP_HEADER);
+    if (block == nullptr)
+    {
+        return nullptr;
+    }
+    *static_cast<std::size_t*>(block) = size;
+    g_heapBytes += static_cast<int64_t>(size);
+    return static_cast<char*>(block) + HEAP_HEADER;
+}
+
+/**
+ * \brief Free a block allocated with CountedAlloc
+ * \param ptr the block
+ */
+static void
+CountedFree(void* ptr)
+{
+    if (ptr == nullptr)
+    {
+        return;
+    }
+    void* block = static_cast<char*>(ptr) - HEAP_HEADER;
+    g_heapBytes -= static_cast<int64_t>(*static_cast<std::size_t*>(block));
+    std::free(block);
+}
+
+void*
+operator new(std::size_t size)
+{
+    void* ptr = CountedAlloc(size);
+    if (ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void*
+operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void*
+operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return CountedAlloc(size);
+}
+
+void*
+operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return CountedAlloc(size);
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+    CountedFree(ptr);
+}
+
+void
+operator delete[](void* ptr) noexcept
+{
+    CountedFree(ptr);
+}
+
+void
+operator delete(void* ptr, std::size_t) noexcept
+{
+    CountedFree(ptr);
+}
+
+void
+operator delete[](void* ptr, std::size_t) noexcept
+{
+    CountedFree(ptr);
+}
+
+void
+operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    CountedFree(ptr);
+}
+
+void
+operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    CountedFree(ptr);
+}
+
+/**
+ * \param slot the slot
+ * \return the SfnSf of the slot, with numerology 0
+ */
+static SfnSf
+GetSfnSf(uint32_t slot)
+{
+    return SfnSf(slot / 10, slot % 10, 0, 0);
+}
+
+/**
+ * \brief Parameters of the synthetic trace
+ */
+struct TraceParams
+{
+    uint32_t m_ueNum{0};            //!< UEs of the cell
+    uint16_t m_beamNum{0};          //!< Beams of the UEs
+    uint32_t m_numRb{0};            //!< RBs of the bandwidth
+    uint32_t m_numRbPerRbg{0};      //!< RBs per RBG
+    uint32_t m_packetSize{0};       //!< Size of the DL packets
+    uint32_t m_packetsPerUe{0};     //!< DL packets of each UE
+    uint32_t m_slotsPerInterval{0}; //!< Slots between the DL packets of a UE
+    uint32_t m_slotsPerCqi{0};      //!< Slots between the CQI reports of a UE
+};
+
+/**
+ * \brief Write the synthetic trace of a cell, with numerology 0
+ * \param file the file of the trace
+ * \param params the parameters of the trace
+ */
+static void
+WriteTrace(const std::string& file, const TraceParams& params)
+{
+    NrMacSchedulerTrace::Writer writer;
+    writer.Open(file);
+
+    NrMacSchedulerTrace::Config config;
+    config.m_symbolsPerSlot = 14;
+    config.m_slotPeriodNs = MilliSeconds(1).GetNanoSeconds();
+    config.m_numRbPerRbg = params.m_numRbPerRbg;
+    config.m_numHarqProcess = 16;
+    config.m_bwpId = 0;
+    config.m_cellId = 1;
+    for (uint32_t rb = 0; rb < params.m_numRb; ++rb)
+    {
+        BandInfo band;
+        band.fc = 3.5e9 + rb * 180e3;
+        band.fl = band.fc - 90e3;
+        band.fh = band.fc + 90e3;
+        config.m_bands.push_back(band);
+    }
+    writer.Write({0, config});
+
+    NrMacCschedSapProvider::CschedCellConfigReqParameters cellConfig;
+    cellConfig.m_ulBandwidth = params.m_numRb;
+    cellConfig.m_dlBandwidth = params.m_numRb;
+    writer.Write({0, cellConfig});
+
+    for (uint32_t rnti = 1; rnti <= params.m_ueNum; ++rnti)
+    {
+        NrMacCschedSapProvider::CschedUeConfigReqParameters ueConfig;
+        ueConfig.m_rnti = rnti;
+        ueConfig.m_beamConfId =
+            BeamConfId(BeamId(rnti % params.m_beamNum, 90.0), BeamId::GetEmptyBeamId());
+        ueConfig.m_transmissionMode = 0;
+        writer.Write({0, ueConfig});
+
+        NrMacCschedSapProvider::CschedLcConfigReqParameters lcConfig;
+        lcConfig.m_rnti = rnti;
+        lcConfig.m_reconfigureFlag = false;
+        LogicalChannelConfigListElement_s lc;
+        lc.m_logicalChannelIdentity = 3;
+        lc.m_logicalChannelGroup = 1;
+        lc.m_direction = LogicalChannelConfigListElement_s::DIR_BOTH;
+        lc.m_qosBearerType = LogicalChannelConfigListElement_s::QBT_NON_GBR;
+        lc.m_qci = 9;
+        lc.m_eRabMaximulBitrateUl = 0;
+        lc.m_eRabMaximulBitrateDl = 0;
+        lc.m_eRabGuaranteedBitrateUl = 0;
+        lc.m_eRabGuaranteedBitrateDl = 0;
+        lcConfig.m_logicalChannelConfigList.emplace_back(lc);
+        writer.Write({0, lcConfig});
+    }
+
+    // The CQIs take a few values, as the UEs are at a few distances
+    const std::vector<uint8_t> cqiValues = {4, 7, 10, 13};
+    const uint32_t numSlots = params.m_slotsPerInterval * params.m_packetsPerUe;
+    for (uint32_t slot = 1; slot <= numSlots; ++slot)
+    {
+        const int64_t timeNs = MilliSeconds(slot).GetNanoSeconds();
+
+        NrMacSchedSapProvider::SchedDlCqiInfoReqParameters dlCqi;
+        dlCqi.m_sfnsf = GetSfnSf(slot);
+        for (uint32_t rnti = 1 + slot % params.m_slotsPerCqi; rnti <= params.m_ueNum;
+             rnti += params.m_slotsPerCqi)
+        {
+            DlCqiInfo cqi;
+            cqi.m_rnti = rnti;
+            cqi.m_ri = 1;
+            cqi.m_cqiType = DlCqiInfo::WB;
+            cqi.m_wbCqi = {cqiValues.at((rnti / params.m_beamNum) % cqiValues.size())};
+            dlCqi.m_cqiList.push_back(cqi);
+        }
+        if (!dlCqi.m_cqiList.empty())
+        {
+            writer.Write({timeNs, dlCqi});
+        }
+
+        for (uint32_t rnti = 1 + slot % params.m_slotsPerInterval; rnti <= params.m_ueNum;
+             rnti += params.m_slotsPerInterval)
+        {
+            NrMacSchedSapProvider::SchedDlRlcBufferReqParameters rlc;
+            rlc.m_rnti = rnti;
+            rlc.m_logicalChannelIdentity = 3;
+            rlc.m_rlcTransmissionQueueSize = params.m_packetSize;
+            rlc.m_rlcTransmissionQueueHolDelay = 0;
+            rlc.m_rlcRetransmissionQueueSize = 0;
+            rlc.m_rlcRetransmissionHolDelay = 0;
+            rlc.m_rlcStatusPduSize = 0;
+            writer.Write({timeNs, rlc});
+        }
+
+        NrMacSchedSapProvider::SchedUlTriggerReqParameters ulTrigger;
+        ulTrigger.m_snfSf = GetSfnSf(slot + 2);
+        ulTrigger.m_slotType = LteNrTddSlotType::F;
+        writer.Write({timeNs, ulTrigger});
+
+        NrMacSchedSapProvider::SchedDlTriggerReqParameters dlTrigger;
+        dlTrigger.m_snfSf = GetSfnSf(slot);
+        dlTrigger.m_slotType = LteNrTddSlotType::F;
+        writer.Write({timeNs, dlTrigger});
+    }
+    writer.Close();
+}
+
+/**
+ * \brief Result of the replay of a trace on a scheduler
+ */
+struct Result
+{
+    std::string m_scheduler;               //!< TypeId of the scheduler
+    uint32_t m_ueNum{0};                   //!< UEs of the cell
+    NrMacSchedulerReplay::Report m_report; //!< Report of the replay
+    int64_t m_schedulerBytes{0};           //!< Heap held by the scheduler after the replay
+    std::size_t m_numUeRepresentations{0}; //!< UEs with a full representation after the replay
+};
+
+/**
+ * \brief Replay a trace on a scheduler
+ * \param trace the file of the trace
+ * \param scheduler the TypeId of the scheduler
+ * \param incrementalActiveUe the attribute "IncrementalActiveUe" of the scheduler
+ * \param ueNum the UEs of the trace
+ * \return the result of the replay
+ */
+static Result
+RunScheduler(const std::string& trace,
+             const std::string& scheduler,
+             bool incrementalActiveUe,
+             uint32_t ueNum)
+{
+    ObjectFactory schedFactory;
+    schedFactory.SetTypeId(scheduler);
+    schedFactory.Set("IncrementalActiveUe", BooleanValue(incrementalActiveUe));
+    Ptr<NrMacSchedulerNs3> sched = schedFactory.Create<NrMacSchedulerNs3>();
+    NS_ABORT_MSG_IF(sched == nullptr, scheduler << " is not a NrMacSchedulerNs3");
+
+    Result result;
+    result.m_scheduler = scheduler;
+    result.m_ueNum = ueNum;
+    {
+        NrMacSchedulerReplay replay(trace);
+        result.m_report = replay.Run(sched);
+    }
+    Simulator::Destroy();
+    result.m_numUeRepresentations = sched->GetNumUeRepresentations();
+
+    // Only the scheduler is left: its memory is what is freed with it
+    const int64_t withScheduler = g_heapBytes;
+    sched = nullptr;
+    result.m_schedulerBytes = withScheduler - g_heapBytes;
+    return result;
+}
+
+/**
+ * \brief Split a comma-separated list
+ * \param list the list
+ * \return the elements of the list
+ */
+static std::vector<std::string>
+SplitList(const std::string& list)
+{
+    std::vector<std::string> elements;
+    std::stringstream ss(list);
+    std::string element;
+    while (std::getline(ss, element, ','))
+    {
+        if (!element.empty())
+        {
+            elements.push_back(element);
+        }
+    }
+    return elements;
+}
+
+int
+main(int argc, char* argv[])
+{
+    std::string ueNums = "10000,50000";
+    std::string schedulers = "ns3::NrMacSchedulerOfdmaRR,ns3::NrMacSchedulerOfdmaClass";
+    uint16_t beamNum = 4;
+    uint32_t numRb = 106;
+    uint32_t numRbPerRbg = 2;
+    uint32_t packetSize = 40;
+    uint32_t packetsPerUe = 2;
+    Time interval = Seconds(1);
+    Time cqiPeriod = MilliSeconds(80);
+    bool incrementalActiveUe = true;
+    std::string trace = "cttc-nr-scheduler-class-benchmark.bin";
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("ueNums", "The numbers of UEs of the cell, comma-separated", ueNums);
+    cmd.AddValue("schedulers", "The TypeIds of the schedulers, comma-separated", schedulers);
+    cmd.AddValue("beamNum", "The number of beams of the UEs", beamNum);
+    cmd.AddValue("numRb", "The number of RBs of the bandwidth", numRb);
+    cmd.AddValue("numRbPerRbg", "The number of RBs per RBG", numRbPerRbg);
+    cmd.AddValue("packetSize", "The size of the DL packets", packetSize);
+    cmd.AddValue("packetsPerUe", "The number of DL packets of each UE", packetsPerUe);
+    cmd.AddValue("interval", "The interval between the DL packets of a UE", interval);
+    cmd.AddValue("cqiPeriod", "The period of the CQI reports of a UE", cqiPeriod);
+    cmd.AddValue("incrementalActiveUe",
+                 "Search the active UEs only among the UEs that received data",
+                 incrementalActiveUe);
+    cmd.AddValue("trace", "The file where the synthetic traces are written", trace);
+    cmd.Parse(argc, argv);
+
+    NS_ABORT_MSG_IF(beamNum == 0, "At least one beam is needed");
+    NS_ABORT_MSG_IF(packetsPerUe > 16, "The trace has no HARQ feedback: too many packets");
+
+    TraceParams params;
+    params.m_beamNum = beamNum;
+    params.m_numRb = numRb;
+    params.m_numRbPerRbg = numRbPerRbg;
+    params.m_packetSize = packetSize;
+    params.m_packetsPerUe = packetsPerUe;
+    params.m_slotsPerInterval = interval.GetMilliSeconds();
+    params.m_slotsPerCqi = cqiPeriod.GetMilliSeconds();
+    NS_ABORT_MSG_IF(params.m_slotsPerInterval == 0 || params.m_slotsPerCqi == 0,
+                    "The periods must be >= 1 ms");
+
+    std::vector<Result> results;
+    for (const auto& ueNum : SplitList(ueNums))
+    {
+        params.m_ueNum = std::stoul(ueNum);
+        NS_ABORT_MSG_IF(params.m_ueNum == 0 || params.m_ueNum >= UINT16_MAX,
+                        "The UEs must have a valid RNTI");
+        WriteTrace(trace, params);
+        for (const auto& scheduler : SplitList(schedulers))
+        {
+            results.push_back(RunScheduler(trace, scheduler, incrementalActiveUe, params.m_ueNum));
+        }
+    }
+
+    std::cout << std::left << std::setw(36) << "Scheduler" << std::right << std::setw(8)
+              << "UEs" << std::setw(12) << "Slots/s" << std::setw(10) << "DL DCIs"
+              << std::setw(12) << "Bytes/UE" << std::setw(10) << "Full UEs" << std::endl;
+    for (const auto& result : results)
+    {
+        std::cout << std::left << std::setw(36) << result.m_scheduler << std::right
+                  << std::setw(8) << result.m_ueNum << std::setw(12) << std::fixed
+                  << std::setprecision(0) << result.m_report.m_slotsPerSecond << std::setw(10)
+                  << result.m_report.m_numDlDci << std::setw(12) << std::setprecision(1)
+                  << static_cast<double>(result.m_schedulerBytes) / result.m_ueNum
+                  << std::setw(10) << result.m_numUeRepresentations << std::endl;
+    }
+    std::cout << "Class record: " << NrMacSchedulerUeClasses::GetRecordSize()
+              << " bytes per UE and direction (NrMacSchedulerOfdmaClass)" << std::endl;
+    return 0;
+}
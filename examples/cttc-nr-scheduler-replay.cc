@@ -0,0 +1,70 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "ns3/core-module.h"
+#include "ns3/nr-module.h"
+
+#include <iostream>
+
+/**
+ * \file cttc-nr-scheduler-replay.cc
+ * \ingroup examples
+ * \brief Replay a recorded scheduler trace on a scheduler, without PHY or channel
+ *
+ * A trace is recorded by calling NrHelper::EnableSchedulerRecording() before
+ * installing the gNBs of any scenario, e.g.:
+ *
+ * \code{.cpp}
+ *   nrHelper->EnableSchedulerRecording("sched");
+ *   NetDeviceContainer gnbNetDev = nrHelper->InstallGnbDevice(gridScenario.GetBaseStations(),
+ *                                                             allBwps);
+ * \endcode
+ *
+ * which writes one file per gNB and BWP, named sched-cellId-bwpId.bin. This
+ * program feeds one of these files to the scheduler selected with
+ * "--scheduler", and prints the number of slots scheduled per second of
+ * wall time spent inside the scheduler, and a summary of the decisions. The
+ * digest of the decisions allows to check that a change of the scheduler
+ * does not change its decisions:
+ *
+ * ./ns3 run "cttc-nr-scheduler-replay --trace=sched-2-0.bin --scheduler=ns3::NrMacSchedulerOfdmaPF"
+ *
+ * The attributes of the scheduler can be set with "--ns3::NrMacSchedulerNs3::...".
+ * Replaying the same trace on a scheduler and on its static counterpart (e.g.,
+ * ns3::NrMacSchedulerOfdmaPFStatic, see NrMacSchedulerStatic) must give the same
+ * digest, and shows the cost of the virtual dispatch of the policy.
+ */
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("CttcNrSchedulerReplay");
+
+int
+main(int argc, char* argv[])
+{
+    std::string trace;
+    std::string scheduler = "ns3::NrMacSchedulerTdmaRR";
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("trace", "The scheduler trace to replay", trace);
+    cmd.AddValue("scheduler", "The TypeId of the scheduler", scheduler);
+    cmd.Parse(argc, argv);
+
+    NS_ABORT_MSG_IF(trace.empty(), "Please specify the trace to replay with --trace");
+
+    ObjectFactory schedFactory;
+    schedFactory.SetTypeId(scheduler);
+    Ptr<NrMacSchedulerNs3> sched = schedFactory.Create<NrMacSchedulerNs3>();
+    NS_ABORT_MSG_IF(sched == nullptr, scheduler << " is not a NrMacSchedulerNs3");
+
+    NrMacSchedulerReplay replay(trace);
+    NrMacSchedulerReplay::Report report = replay.Run(sched);
+    Simulator::Destroy();
+
+    std::cout << "Scheduler:         " << scheduler << std::endl;
+    NrMacSchedulerReplay::Print(std::cout, report);
+    return 0;
+}
@@ -0,0 +1,243 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "ns3/antenna-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/flow-monitor-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include "ns3/nr-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include <iostream>
+
+/**
+ * \file cttc-nr-subband-cqi.cc
+ * \ingroup examples
+ * \brief DL cell throughput of an OFDMA scheduler, with wideband or subband CQI
+ *
+ * A gNB serves "ueNum" UEs in NLoS, through the 3GPP channel model with fast
+ * fading (UMi street canyon), whose multipath makes the channel frequency
+ * selective. Each UE receives a saturating DL UDP flow. With "--subbandSize=0"
+ * the UEs report only the wideband CQI, and the scheduler gives the same MCS
+ * to all the RBG; otherwise, the UEs report the CQI of each subband of the
+ * given number of RB (attribute DlCqiSubbandSize of NrUePhy), and the
+ * scheduler gives each UE the RBG where its channel is best. The program
+ * prints the cell throughput in Mbps, so that the gain of the frequency
+ * selective scheduling is the ratio between two runs:
+ *
+ * \code{.unparsed}
+$ for sb in 0 4 8 16; do ./ns3 run "cttc-nr-subband-cqi --subbandSize=$sb"; done
+    \endcode
+ */
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("CttcNrSubbandCqi");
+
+int
+main(int argc, char* argv[])
+{
+    uint16_t ueNum = 6;
+    uint16_t subbandSize = 0;
+    Time subbandPeriod = MilliSeconds(0);
+    std::string scheduler = "ns3::NrMacSchedulerOfdmaPF";
+    double distance = 80.0;
+    uint16_t numerology = 1;
+    double centralFrequency = 3.5e9;
+    double bandwidth = 40e6;
+    double txPower = 40;
+    uint32_t packetSize = 1000;
+    DataRate ueRate("100Mb/s");
+    Time simTime = MilliSeconds(1000);
+    Time appStartTime = MilliSeconds(400);
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("ueNum", "The number of UEs of the cell", ueNum);
+    cmd.AddValue("subbandSize", "The RB of a CQI subband (0: wideband CQI only)", subbandSize);
+    cmd.AddValue("subbandPeriod",
+                 "The period of the subband CQI (0: in every CQI report)",
+                 subbandPeriod);
+    cmd.AddValue("scheduler", "The TypeId of the OFDMA scheduler", scheduler);
+    cmd.AddValue("distance", "The maximum distance (m) between the gNB and the UEs", distance);
+    cmd.AddValue("numerology", "The numerology of the BWP", numerology);
+    cmd.AddValue("centralFrequency", "The central frequency of the band", centralFrequency);
+    cmd.AddValue("bandwidth", "The bandwidth of the band", bandwidth);
+    cmd.AddValue("txPower", "The tx power (dBm) of the gNB", txPower);
+    cmd.AddValue("packetSize", "The size of the UDP packets", packetSize);
+    cmd.AddValue("ueRate", "The DL rate offered to each UE", ueRate);
+    cmd.AddValue("simTime", "Simulation time", simTime);
+    cmd.Parse(argc, argv);
+
+    NS_ABORT_MSG_IF(ueNum == 0, "At least one UE is needed");
+    NS_ABORT_MSG_IF(!TypeId::LookupByName(scheduler).IsChildOf(NrMacSchedulerOfdma::GetTypeId()),
+                    scheduler << " is not an OFDMA scheduler");
+
+    Config::SetDefault("ns3::LteRlcUm::MaxTxBufferSize", UintegerValue(999999999));
+
+    NodeContainer gnbNodes;
+    gnbNodes.Create(1);
+    NodeContainer ueNodes;
+    ueNodes.Create(ueNum);
+
+    // The gNB antenna points to the positive x axis: the UEs are placed in
+    // front of it, at increasing distances, so that their channels differ
+    Ptr<ListPositionAllocator> gnbPositions = CreateObject<ListPositionAllocator>();
+    gnbPositions->Add(Vector(0.0, 0.0, 10.0));
+    Ptr<ListPositionAllocator> uePositions = CreateObject<ListPositionAllocator>();
+    for (uint16_t i = 0; i < ueNum; ++i)
+    {
+        const double ueDistance = distance * (i + 1) / ueNum;
+        uePositions->Add(Vector(ueDistance, (i % 2 ? 1.0 : -1.0) * ueDistance / 4, 1.5));
+    }
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.SetPositionAllocator(gnbPositions);
+    mobility.Install(gnbNodes);
+    mobility.SetPositionAllocator(uePositions);
+    mobility.Install(ueNodes);
+
+    Ptr<NrPointToPointEpcHelper> epcHelper = CreateObject<NrPointToPointEpcHelper>();
+    Ptr<IdealBeamformingHelper> beamformingHelper = CreateObject<IdealBeamformingHelper>();
+    Ptr<NrHelper> nrHelper = CreateObject<NrHelper>();
+    nrHelper->SetBeamformingHelper(beamformingHelper);
+    nrHelper->SetEpcHelper(epcHelper);
+
+    beamformingHelper->SetAttribute("BeamformingMethod",
+                                    TypeIdValue(DirectPathBeamforming::GetTypeId()));
+
+    nrHelper->SetSchedulerTypeId(TypeId::LookupByName(scheduler));
+    nrHelper->SetUePhyAttribute("DlCqiSubbandSize", UintegerValue(subbandSize));
+    nrHelper->SetUePhyAttribute("DlCqiSubbandPeriod", TimeValue(subbandPeriod));
+
+    BandwidthPartInfoPtrVector allBwps;
+    CcBwpCreator ccBwpCreator;
+    CcBwpCreator::SimpleOperationBandConf bandConf(centralFrequency,
+                                                   bandwidth,
+                                                   1,
+                                                   BandwidthPartInfo::UMi_StreetCanyon_nLoS);
+    OperationBandInfo band = ccBwpCreator.CreateOperationBandContiguousCc(bandConf);
+
+    Config::SetDefault("ns3::ThreeGppChannelModel::UpdatePeriod", TimeValue(MilliSeconds(0)));
+    nrHelper->SetChannelConditionModelAttribute("UpdatePeriod", TimeValue(MilliSeconds(0)));
+    nrHelper->SetPathlossAttribute("ShadowingEnabled", BooleanValue(false));
+    // The fast fading (enabled by default) gives the frequency selectivity
+    nrHelper->InitializeOperationBand(&band);
+    allBwps = CcBwpCreator::GetAllBwps({band});
+
+    epcHelper->SetAttribute("S1uLinkDelay", TimeValue(MilliSeconds(0)));
+
+    nrHelper->SetUeAntennaAttribute("NumRows", UintegerValue(2));
+    nrHelper->SetUeAntennaAttribute("NumColumns", UintegerValue(2));
+    nrHelper->SetUeAntennaAttribute("AntennaElement",
+                                    PointerValue(CreateObject<IsotropicAntennaModel>()));
+    nrHelper->SetGnbAntennaAttribute("NumRows", UintegerValue(4));
+    nrHelper->SetGnbAntennaAttribute("NumColumns", UintegerValue(4));
+    nrHelper->SetGnbAntennaAttribute("AntennaElement",
+                                     PointerValue(CreateObject<ThreeGppAntennaModel>()));
+
+    nrHelper->SetGnbPhyAttribute("Numerology", UintegerValue(numerology));
+    nrHelper->SetGnbPhyAttribute("TxPower", DoubleValue(txPower));
+
+    NetDeviceContainer gnbNetDev = nrHelper->InstallGnbDevice(gnbNodes, allBwps);
+    NetDeviceContainer ueNetDev = nrHelper->InstallUeDevice(ueNodes, allBwps);
+
+    int64_t randomStream = 1;
+    randomStream += nrHelper->AssignStreams(gnbNetDev, randomStream);
+    randomStream += nrHelper->AssignStreams(ueNetDev, randomStream);
+
+    for (auto it = gnbNetDev.Begin(); it != gnbNetDev.End(); ++it)
+    {
+        DynamicCast<NrGnbNetDevice>(*it)->UpdateConfig();
+    }
+    for (auto it = ueNetDev.Begin(); it != ueNetDev.End(); ++it)
+    {
+        DynamicCast<NrUeNetDevice>(*it)->UpdateConfig();
+    }
+
+    Ptr<Node> pgw = epcHelper->GetPgwNode();
+    NodeContainer remoteHostContainer;
+    remoteHostContainer.Create(1);
+    Ptr<Node> remoteHost = remoteHostContainer.Get(0);
+    InternetStackHelper internet;
+    internet.Install(remoteHostContainer);
+
+    PointToPointHelper p2ph;
+    p2ph.SetDeviceAttribute("DataRate", DataRateValue(DataRate("100Gb/s")));
+    p2ph.SetDeviceAttribute("Mtu", UintegerValue(2500));
+    p2ph.SetChannelAttribute("Delay", TimeValue(Seconds(0.000)));
+    NetDeviceContainer internetDevices = p2ph.Install(pgw, remoteHost);
+    Ipv4AddressHelper ipv4h;
+    Ipv4StaticRoutingHelper ipv4RoutingHelper;
+    ipv4h.SetBase("1.0.0.0", "255.0.0.0");
+    ipv4h.Assign(internetDevices);
+    Ptr<Ipv4StaticRouting> remoteHostStaticRouting =
+        ipv4RoutingHelper.GetStaticRouting(remoteHost->GetObject<Ipv4>());
+    remoteHostStaticRouting->AddNetworkRouteTo(Ipv4Address("7.0.0.0"), Ipv4Mask("255.0.0.0"), 1);
+    internet.Install(ueNodes);
+
+    Ipv4InterfaceContainer ueIpIface = epcHelper->AssignUeIpv4Address(ueNetDev);
+    for (uint32_t j = 0; j < ueNodes.GetN(); ++j)
+    {
+        Ptr<Ipv4StaticRouting> ueStaticRouting =
+            ipv4RoutingHelper.GetStaticRouting(ueNodes.Get(j)->GetObject<Ipv4>());
+        ueStaticRouting->SetDefaultRoute(epcHelper->GetUeDefaultGatewayAddress(), 1);
+    }
+
+    nrHelper->AttachToClosestEnb(ueNetDev, gnbNetDev);
+
+    // A saturating DL flow per UE, on the default bearer
+    const uint16_t dlPort = 1234;
+    ApplicationContainer serverApps;
+    ApplicationContainer clientApps;
+    UdpServerHelper dlPacketSink(dlPort);
+    serverApps.Add(dlPacketSink.Install(ueNodes));
+
+    UdpClientHelper dlClient;
+    dlClient.SetAttribute("RemotePort", UintegerValue(dlPort));
+    dlClient.SetAttribute("MaxPackets", UintegerValue(0xFFFFFFFF));
+    dlClient.SetAttribute("PacketSize", UintegerValue(packetSize));
+    dlClient.SetAttribute("Interval",
+                          TimeValue(Seconds(packetSize * 8.0 / ueRate.GetBitRate())));
+    for (uint32_t j = 0; j < ueNodes.GetN(); ++j)
+    {
+        dlClient.SetAttribute("RemoteAddress", AddressValue(ueIpIface.GetAddress(j)));
+        clientApps.Add(dlClient.Install(remoteHost));
+    }
+
+    serverApps.Start(appStartTime);
+    clientApps.Start(appStartTime);
+    serverApps.Stop(simTime);
+    clientApps.Stop(simTime);
+
+    FlowMonitorHelper flowmonHelper;
+    NodeContainer endpointNodes;
+    endpointNodes.Add(remoteHost);
+    endpointNodes.Add(ueNodes);
+    Ptr<FlowMonitor> monitor = flowmonHelper.Install(endpointNodes);
+
+    Simulator::Stop(simTime);
+    Simulator::Run();
+
+    monitor->CheckForLostPackets();
+    uint64_t rxBytes = 0;
+    for (const auto& flow : monitor->GetFlowStats())
+    {
+        rxBytes += flow.second.rxBytes;
+    }
+    const double flowDuration = (simTime - appStartTime).GetSeconds();
+
+    std::cout << "UEs: " << ueNum << " CQI: "
+              << (subbandSize > 0 ? "subband of " + std::to_string(subbandSize) + " RB"
+                                  : std::string("wideband"))
+              << " Cell throughput: " << rxBytes * 8.0 / flowDuration / 1e6 << " Mbps"
+              << std::endl;
+
+    Simulator::Destroy();
+    return 0;
+}
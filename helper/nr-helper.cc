@@ -30,6 +30,7 @@
 #include <ns3/nr-gnb-net-device.h>
 #include <ns3/nr-gnb-phy.h>
 #include <ns3/nr-mac-rx-trace.h>
+#include <ns3/nr-mac-scheduler-recorder.h>
 #include <ns3/nr-mac-scheduler-tdma-rr.h>
 #include <ns3/nr-phy-rx-trace.h>
 #include <ns3/nr-rrc-protocol-ideal.h>
@@ -105,6 +106,12 @@ NrHelper::GetTypeId()
                                           "Enable Hybrid ARQ",
                                           BooleanValue(true),
                                           MakeBooleanAccessor(&NrHelper::m_harqEnabled),
+                                          MakeBooleanChecker())
+                            .AddAttribute("FastAttach",
+                                          "Attach the UEs without random access: the gNB "
+                                          "gives them a RNTI as soon as they start it",
+                                          BooleanValue(false),
+                                          MakeBooleanAccessor(&NrHelper::m_fastAttach),
                                           MakeBooleanChecker());
     return tid;
 }
@@ -734,6 +741,12 @@ NrHelper::InstallSingleUeDevice(
 
     n->AddDevice(dev);
 
+    Ptr<nrUeRrcProtocolIdeal> rrcProtocolIdeal = rrc->GetObject<nrUeRrcProtocolIdeal>();
+    if (rrcProtocolIdeal != nullptr)
+    {
+        rrcProtocolIdeal->SetUeNetDevice(dev);
+    }
+
     if (m_epcHelper != nullptr)
     {
         m_epcHelper->AddUe(dev, dev->GetImsi());
@@ -997,10 +1010,38 @@ NrHelper::InstallSingleGnbDevice(
         // PHY <--> MAC SAP END
 
         // Scheduler SAP
-        it->second->GetMac()->SetNrMacSchedSapProvider(
-            it->second->GetScheduler()->GetMacSchedSapProvider());
-        it->second->GetMac()->SetNrMacCschedSapProvider(
-            it->second->GetScheduler()->GetMacCschedSapProvider());
+        if (m_schedulerRecordingPrefix.empty())
+        {
+            it->second->GetMac()->SetNrMacSchedSapProvider(
+                it->second->GetScheduler()->GetMacSchedSapProvider());
+            it->second->GetMac()->SetNrMacCschedSapProvider(
+                it->second->GetScheduler()->GetMacCschedSapProvider());
+        }
+        else
+        {
+            // The recorder lives as long as the scheduler, to which it is aggregated
+            auto recorder = CreateObject<NrMacSchedulerRecorder>();
+            std::ostringstream filename;
+            filename << m_schedulerRecordingPrefix << "-" << it->second->GetCellId() << "-"
+                     << +it->first << ".bin";
+            recorder->Open(filename.str());
+            recorder->SetMacSchedSapProvider(it->second->GetScheduler()->GetMacSchedSapProvider());
+            recorder->SetMacCschedSapProvider(
+                it->second->GetScheduler()->GetMacCschedSapProvider());
+            recorder->SetMacSchedSapUser(it->second->GetMac()->GetNrMacSchedSapUser());
+            it->second->GetScheduler()->AggregateObject(recorder);
+            // The configured grants do not pass through the SAPs; the other
+            // schedulers have no such trace sources
+            it->second->GetScheduler()->TraceConnectWithoutContext(
+                "ConfiguredGrantAdded",
+                MakeCallback(&NrMacSchedulerRecorder::RecordConfiguredGrantAdded, recorder));
+            it->second->GetScheduler()->TraceConnectWithoutContext(
+                "ConfiguredGrantRemoved",
+                MakeCallback(&NrMacSchedulerRecorder::RecordConfiguredGrantRemoved, recorder));
+
+            it->second->GetMac()->SetNrMacSchedSapProvider(recorder->GetMacSchedSapProvider());
+            it->second->GetMac()->SetNrMacCschedSapProvider(recorder->GetMacCschedSapProvider());
+        }
 
         it->second->GetScheduler()->SetMacSchedSapUser(
             it->second->GetMac()->GetNrMacSchedSapUser());
@@ -1024,6 +1065,12 @@ NrHelper::InstallSingleGnbDevice(
 
     n->AddDevice(dev);
 
+    Ptr<NrGnbRrcProtocolIdeal> rrcProtocolIdeal = rrc->GetObject<NrGnbRrcProtocolIdeal>();
+    if (rrcProtocolIdeal != nullptr)
+    {
+        rrcProtocolIdeal->SetGnbNetDevice(dev);
+    }
+
     if (m_epcHelper != nullptr)
     {
         NS_LOG_INFO("adding this eNB to the EPC");
@@ -1099,6 +1146,11 @@ NrHelper::AttachToEnb(const Ptr<NetDevice>& ueDevice, const Ptr<NetDevice>& gnbD
         ueNetDev->GetPhy(i)->SetSymbolsPerSlot(enbNetDev->GetPhy(i)->GetSymbolsPerSlot());
         ueNetDev->GetPhy(i)->SetNumerology(enbNetDev->GetPhy(i)->GetNumerology());
         ueNetDev->GetPhy(i)->SetPattern(enbNetDev->GetPhy(i)->GetPattern());
+        if (m_fastAttach)
+        {
+            ueNetDev->GetMac(i)->SetFastAttachCallback(
+                MakeCallback(&NrGnbMac::AllocateFastAttachRnti, enbNetDev->GetMac(i)));
+        }
         Ptr<EpcUeNas> ueNas = ueNetDev->GetNas();
         ueNas->Connect(enbNetDev->GetBwpId(i), enbNetDev->GetEarfcn(i));
     }
@@ -1587,6 +1639,102 @@ NrHelper::ActivateDataRadioBearer(Ptr<NetDevice> ueDevice, EpsBearer bearer)
     Config::Connect(path.str(), MakeBoundCallback(&NrDrbActivator::ActivateCallback, arg));
 }
 
+class NrConfiguredGrantActivator : public SimpleRefCount<NrConfiguredGrantActivator>
+{
+  public:
+    NrConfiguredGrantActivator(Ptr<NetDevice> ueDevice,
+                               const NrConfiguredGrant& grant,
+                               uint8_t bwpIndex);
+    static void ActivateCallback(Ptr<NrConfiguredGrantActivator> a,
+                                 std::string context,
+                                 uint64_t imsi,
+                                 uint16_t cellId,
+                                 uint16_t rnti);
+    void AddGrant(uint64_t imsi, uint16_t cellId, uint16_t rnti);
+
+  private:
+    bool m_added;
+    Ptr<NetDevice> m_ueDevice;
+    NrConfiguredGrant m_grant;
+    uint8_t m_bwpIndex;
+    uint64_t m_imsi;
+};
+
+NrConfiguredGrantActivator::NrConfiguredGrantActivator(Ptr<NetDevice> ueDevice,
+                                                       const NrConfiguredGrant& grant,
+                                                       uint8_t bwpIndex)
+    : m_added(false),
+      m_ueDevice(ueDevice),
+      m_grant(grant),
+      m_bwpIndex(bwpIndex),
+      m_imsi(m_ueDevice->GetObject<NrUeNetDevice>()->GetImsi())
+{
+}
+
+void
+NrConfiguredGrantActivator::ActivateCallback(Ptr<NrConfiguredGrantActivator> a,
+                                             std::string context,
+                                             uint64_t imsi,
+                                             uint16_t cellId,
+                                             uint16_t rnti)
+{
+    NS_LOG_FUNCTION(a << context << imsi << cellId << rnti);
+    a->AddGrant(imsi, cellId, rnti);
+}
+
+void
+NrConfiguredGrantActivator::AddGrant(uint64_t imsi, uint16_t cellId, uint16_t rnti)
+{
+    NS_LOG_FUNCTION(this << imsi << cellId << rnti << m_added);
+    if ((!m_added) && (imsi == m_imsi))
+    {
+        Ptr<const NrGnbNetDevice> gnbDevice =
+            m_ueDevice->GetObject<NrUeNetDevice>()->GetTargetEnb();
+        Ptr<NrMacSchedulerNs3> scheduler =
+            DynamicCast<NrMacSchedulerNs3>(gnbDevice->GetScheduler(m_bwpIndex));
+        NS_ABORT_MSG_IF(scheduler == nullptr, "The configured grants need a NrMacSchedulerNs3");
+        scheduler->AddConfiguredGrant(rnti, m_grant);
+        m_added = true;
+    }
+}
+
+void
+NrHelper::AddConfiguredGrant(const Ptr<NetDevice>& ueDevice,
+                             const NrConfiguredGrant& grant,
+                             uint8_t bwpIndex)
+{
+    NS_LOG_FUNCTION(this << ueDevice);
+
+    // As for the DRB activation, wait for the connection of the UE, which
+    // gives it a RNTI in the scheduler
+    Ptr<const NrGnbNetDevice> gnbDevice = ueDevice->GetObject<NrUeNetDevice>()->GetTargetEnb();
+    NS_ABORT_MSG_IF(gnbDevice == nullptr, "The UE must be attached to a gNB");
+
+    std::ostringstream path;
+    path << "/NodeList/" << gnbDevice->GetNode()->GetId() << "/DeviceList/"
+         << gnbDevice->GetIfIndex() << "/LteEnbRrc/ConnectionEstablished";
+    Ptr<NrConfiguredGrantActivator> arg =
+        Create<NrConfiguredGrantActivator>(ueDevice, grant, bwpIndex);
+    Config::Connect(path.str(),
+                    MakeBoundCallback(&NrConfiguredGrantActivator::ActivateCallback, arg));
+}
+
+void
+NrHelper::RemoveConfiguredGrant(const Ptr<NetDevice>& ueDevice,
+                                DciInfoElementTdma::DciFormat format,
+                                uint8_t bwpIndex)
+{
+    NS_LOG_FUNCTION(this << ueDevice);
+
+    Ptr<NrUeNetDevice> ueNetDevice = ueDevice->GetObject<NrUeNetDevice>();
+    Ptr<const NrGnbNetDevice> gnbDevice = ueNetDevice->GetTargetEnb();
+    NS_ABORT_MSG_IF(gnbDevice == nullptr, "The UE must be attached to a gNB");
+    Ptr<NrMacSchedulerNs3> scheduler =
+        DynamicCast<NrMacSchedulerNs3>(gnbDevice->GetScheduler(bwpIndex));
+    NS_ABORT_MSG_IF(scheduler == nullptr, "The configured grants need a NrMacSchedulerNs3");
+    scheduler->RemoveConfiguredGrant(ueNetDevice->GetRrc()->GetRnti(), format);
+}
+
 void
 NrHelper::EnableTraces()
 {
@@ -1776,6 +1924,14 @@ NrHelper::EnableUlMacSchedTraces()
         MakeBoundCallback(&NrMacSchedulingStats::UlSchedulingCallback, m_macSchedStats));
 }
 
+void
+NrHelper::EnableSchedulerRecording(const std::string& prefix)
+{
+    NS_LOG_FUNCTION(this << prefix);
+    NS_ABORT_MSG_IF(prefix.empty(), "The prefix of the scheduler traces can't be empty");
+    m_schedulerRecordingPrefix = prefix;
+}
+
 void
 NrHelper::EnablePathlossTraces()
 {
@@ -190,6 +190,15 @@ class BwpManagerUe;
  * and AttachToEnb(). Through these function, you will manually attach one or
  * more UEs to a specified GNB.
  *
+ * With the attribute "FastAttach", the UEs attach without random access: when
+ * the RRC of the UE starts the random access, after the first system
+ * information of its cell, the gNB MAC gives it a RNTI at once, with no
+ * preamble, RAR, or collision among UEs. The RRC connection, the bearers and
+ * the contexts in the scheduler are then set up by the usual (ideal) RRC
+ * procedure, in the same instant for all the UEs of the cell, and are the
+ * same as with the random access. It is meant for studies of the steady
+ * state with many UEs, in which the attach is not of interest.
+ *
  * \section helper_Traces Traces
  *
  * We provide a method that enables the generation of files that include among
@@ -335,6 +344,38 @@ class NrHelper : public Object
      * \param bearer the characteristics of the bearer to be activated
      */
     void ActivateDataRadioBearer(Ptr<NetDevice> ueDevice, EpsBearer bearer);
+
+    /**
+     * \brief Add a configured grant (DL SPS or UL configured grant) to a UE
+     *
+     * The grant is given to the scheduler of the BWP once the UE is connected
+     * to its gNB; the UE learns it from the activation DCI. The UE must be
+     * attached to a gNB before calling this method.
+     *
+     * \param ueDevice the UE device
+     * \param grant periodicity, symbols and MCS of the grant
+     * \param bwpIndex the index of the BWP of the grant
+     * \see NrMacSchedulerNs3::AddConfiguredGrant
+     */
+    void AddConfiguredGrant(const Ptr<NetDevice>& ueDevice,
+                            const NrConfiguredGrant& grant,
+                            uint8_t bwpIndex = 0);
+
+    /**
+     * \brief Remove the configured grants of a connected UE in a direction
+     *
+     * The scheduler sends the release DCI in the next occasion of each active
+     * grant.
+     *
+     * \param ueDevice the UE device
+     * \param format DL (SPS) or UL
+     * \param bwpIndex the index of the BWP of the grants
+     * \see NrMacSchedulerNs3::RemoveConfiguredGrant
+     */
+    void RemoveConfiguredGrant(const Ptr<NetDevice>& ueDevice,
+                               DciInfoElementTdma::DciFormat format,
+                               uint8_t bwpIndex = 0);
+
     /**
      * Set the EpcHelper to be used to setup the EPC network in
      * conjunction with the setup of the LTE radio access network.
@@ -818,6 +859,17 @@ class NrHelper : public Object
      */
     void EnableUlMacSchedTraces();
 
+    /**
+     * \brief Record the calls from the MAC to the scheduler of the gNBs installed
+     * afterwards, in one file per BWP named prefix-cellId-bwpId.bin
+     *
+     * The traces can be replayed on any scheduler, without PHY or channel, with
+     * NrMacSchedulerReplay. Must be called before InstallGnbDevice().
+     *
+     * \param prefix prefix of the file names
+     */
+    void EnableSchedulerRecording(const std::string& prefix);
+
     /**
      * \brief Enable trace sinks for DL and UL pathloss
      */
@@ -943,6 +995,8 @@ class NrHelper : public Object
 
     bool m_harqEnabled{false};
     bool m_snrTest{false};
+    bool m_fastAttach{false};               //!< Attach the UEs without random access
+    std::string m_schedulerRecordingPrefix; //!< Prefix of the scheduler traces (empty: disabled)
 
     Ptr<NrPhyRxTrace> m_phyStats; //!< Pointer to the PhyRx stats
     Ptr<NrMacRxTrace> m_macStats; //!< Pointer to the MacRx stats
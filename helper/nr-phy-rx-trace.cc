@@ -410,6 +410,14 @@ NrPhyRxTrace::TxedGnbPhyCtrlMsgsCallback(Ptr<NrPhyRxTrace> phyStats,
     {
         m_txedGnbPhyCtrlMsgsFile << "UL_UCI";
     }
+    else if (msg->GetMessageType() == NrControlMessage::DL_PREEMPTION)
+    {
+        m_txedGnbPhyCtrlMsgsFile << "DL_PREEMPTION";
+    }
+    else if (msg->GetMessageType() == NrControlMessage::TDD_PATTERN)
+    {
+        m_txedGnbPhyCtrlMsgsFile << "TDD_PATTERN";
+    }
     else
     {
         m_txedGnbPhyCtrlMsgsFile << "Other";
@@ -484,6 +492,14 @@ NrPhyRxTrace::RxedUePhyCtrlMsgsCallback(Ptr<NrPhyRxTrace> phyStats,
     {
         m_rxedUePhyCtrlMsgsFile << "RAR";
     }
+    else if (msg->GetMessageType() == NrControlMessage::DL_PREEMPTION)
+    {
+        m_rxedUePhyCtrlMsgsFile << "DL_PREEMPTION";
+    }
+    else if (msg->GetMessageType() == NrControlMessage::TDD_PATTERN)
+    {
+        m_rxedUePhyCtrlMsgsFile << "TDD_PATTERN";
+    }
     else
     {
         m_rxedUePhyCtrlMsgsFile << "Other";
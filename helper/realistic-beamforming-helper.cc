@@ -7,6 +7,7 @@
 #include "realistic-beamforming-helper.h"
 
 #include <ns3/beam-manager.h>
+#include <ns3/boolean.h>
 #include <ns3/log.h>
 #include <ns3/lte-ue-rrc.h>
 #include <ns3/nr-gnb-net-device.h>
@@ -16,6 +17,7 @@
 #include <ns3/nr-spectrum-phy.h>
 #include <ns3/nr-ue-net-device.h>
 #include <ns3/nr-ue-phy.h>
+#include <ns3/simulator.h>
 #include <ns3/uinteger.h>
 #include <ns3/vector.h>
 
@@ -28,12 +30,33 @@ NS_OBJECT_ENSURE_REGISTERED(RealisticBeamformingHelper);
 TypeId
 RealisticBeamformingHelper::GetTypeId()
 {
-    static TypeId tid = TypeId("ns3::RealisticBeamformingHelper")
-                            .SetParent<BeamformingHelperBase>()
-                            .AddConstructor<RealisticBeamformingHelper>();
+    static TypeId tid =
+        TypeId("ns3::RealisticBeamformingHelper")
+            .SetParent<BeamformingHelperBase>()
+            .AddConstructor<RealisticBeamformingHelper>()
+            .AddAttribute("BatchPerSlot",
+                          "If true, the beamforming updates triggered by the SRS count are "
+                          "collected during the slot, merged per pair of devices, and executed "
+                          "together at the end of the slot",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RealisticBeamformingHelper::SetBatchPerSlot,
+                                              &RealisticBeamformingHelper::GetBatchPerSlot),
+                          MakeBooleanChecker());
     return tid;
 }
 
+void
+RealisticBeamformingHelper::SetBatchPerSlot(bool batchPerSlot)
+{
+    m_batchPerSlot = batchPerSlot;
+}
+
+bool
+RealisticBeamformingHelper::GetBatchPerSlot() const
+{
+    return m_batchPerSlot;
+}
+
 void
 RealisticBeamformingHelper::AddBeamformingTask(const Ptr<NrGnbNetDevice>& gNbDev,
                                                const Ptr<NrUeNetDevice>& ueDev)
@@ -69,6 +92,8 @@ RealisticBeamformingHelper::AddBeamformingTask(const Ptr<NrGnbNetDevice>& gNbDev
 
             m_antennaPairToAlgorithm[std::make_pair(gnbSpectrumPhy, ueSpectrumPhy)] =
                 beamformingAlgorithm;
+            m_antennaPairToGnbPhy[std::make_pair(gnbSpectrumPhy, ueSpectrumPhy)] =
+                gNbDev->GetPhy(ccId);
             // connect trace of the corresponding gNB PHY to the RealisticBeamformingAlgorithm
             // funcition
             gnbSpectrumPhy->AddSrsSinrReportCallback(
@@ -78,7 +103,7 @@ RealisticBeamformingHelper::AddBeamformingTask(const Ptr<NrGnbNetDevice>& gNbDev
                 MakeCallback(&RealisticBeamformingAlgorithm::NotifySrsSnrReport,
                              beamformingAlgorithm));
             beamformingAlgorithm->SetTriggerCallback(
-                MakeCallback(&RealisticBeamformingHelper::RunTask, this));
+                MakeCallback(&RealisticBeamformingHelper::NotifyTask, this));
         }
     }
 }
@@ -93,6 +118,67 @@ RealisticBeamformingHelper::GetBeamformingVectors(const Ptr<NrSpectrumPhy>& gnbS
     return itAlgo->second->GetBeamformingVectors();
 }
 
+void
+RealisticBeamformingHelper::NotifyTask(const Ptr<NrGnbNetDevice>& gNbDev,
+                                       const Ptr<NrUeNetDevice>& ueDev,
+                                       const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
+                                       const Ptr<NrSpectrumPhy>& ueSpectrumPhy)
+{
+    NS_LOG_FUNCTION(this);
+
+    BfAntennaPair antennas = std::make_pair(gnbSpectrumPhy, ueSpectrumPhy);
+    auto itAlgo = m_antennaPairToAlgorithm.find(antennas);
+    NS_ABORT_MSG_IF(itAlgo == m_antennaPairToAlgorithm.end(),
+                    "There is no created task/algorithm for the specified pair of antenna arrays.");
+
+    if (!m_batchPerSlot ||
+        itAlgo->second->GetTriggerEventConf().event != RealisticBfManager::SRS_COUNT)
+    {
+        RunTask(gNbDev, ueDev, gnbSpectrumPhy, ueSpectrumPhy);
+        return;
+    }
+
+    Time batchTime = Simulator::Now() + m_antennaPairToGnbPhy.at(antennas)->GetTimeToNextSlot();
+    auto itBatch = m_slotBatches.find(batchTime);
+    if (itBatch == m_slotBatches.end())
+    {
+        itBatch = m_slotBatches.emplace(batchTime, SlotBatch()).first;
+        Simulator::Schedule(batchTime - Simulator::Now(),
+                            &RealisticBeamformingHelper::RunBatch,
+                            this,
+                            batchTime);
+    }
+
+    if (!itBatch->second.antennas.insert(antennas).second)
+    {
+        NS_LOG_INFO("Beamforming task for gNB:" << gNbDev->GetNode()->GetId()
+                                                << " and UE:" << ueDev->GetNode()->GetId()
+                                                << " already in the batch of the slot");
+        return;
+    }
+    itBatch->second.tasks.push_back({gNbDev, ueDev, gnbSpectrumPhy, ueSpectrumPhy});
+}
+
+void
+RealisticBeamformingHelper::RunBatch(Time batchTime)
+{
+    NS_LOG_FUNCTION(this << batchTime);
+
+    auto itBatch = m_slotBatches.find(batchTime);
+    NS_ASSERT(itBatch != m_slotBatches.end());
+    SlotBatch batch = std::move(itBatch->second);
+    m_slotBatches.erase(itBatch);
+
+    NS_LOG_INFO("Running " << batch.tasks.size() << " beamforming tasks of the slot");
+
+    // The beam search drives the antenna of the gNB, which is shared by all
+    // its UEs, so the tasks of the batch are executed one after the other
+    for (const auto& task : batch.tasks)
+    {
+        RunTask(task.gnbDev, task.ueDev, task.gnbSpectrumPhy, task.ueSpectrumPhy);
+    }
+}
+
 void
 RealisticBeamformingHelper::SetBeamformingMethod(const TypeId& beamformingMethod)
 {
@@ -11,6 +11,10 @@
 #include <ns3/object-factory.h>
 #include <ns3/realistic-beamforming-algorithm.h>
 
+#include <map>
+#include <set>
+#include <vector>
+
 #ifndef SRC_NR_HELPER_REALISTIC_BEAMFORMING_HELPER_H_
 #define SRC_NR_HELPER_REALISTIC_BEAMFORMING_HELPER_H_
 
@@ -22,6 +26,7 @@ class NrUeNetDevice;
 class NrGnbPhy;
 class NrUePhy;
 class NrSpectrumPhy;
+class NrRealisticBeamformingBatchTestCase;
 
 /**
  * \ingroup helper
@@ -43,6 +48,14 @@ class NrSpectrumPhy;
  * This helper saves all SRS reports for each gNB and all of its users, and it is saved per
  * component carrier identified by cellId.
  *
+ * When the attribute BatchPerSlot is enabled, the updates triggered by the SRS
+ * count are not executed immediately in the SRS reception event. Instead, they
+ * are collected per slot, repeated triggers for the same pair of antenna arrays
+ * are merged, and all the beam searches are executed one after the other at the
+ * end of the slot of the gNB. The updates triggered with delay are always
+ * executed at their exact time, because the algorithm expects to find the
+ * SRS report and channel saved for that time instant.
+ *
  */
 
 /**
@@ -59,6 +72,8 @@ Cantor(uint32_t x1, uint32_t x2)
 
 class RealisticBeamformingHelper : public BeamformingHelperBase
 {
+    friend NrRealisticBeamformingBatchTestCase;
+
   public:
     /**
      * \brief Get the Type ID
@@ -94,15 +109,69 @@ class RealisticBeamformingHelper : public BeamformingHelperBase
      */
     void SetBeamformingMethod(const TypeId& beamformingMethod) override;
 
+    /**
+     * \brief Set whether the SRS-triggered updates are executed in batch at the end of the slot
+     * \param batchPerSlot true to enable the batch execution
+     */
+    void SetBatchPerSlot(bool batchPerSlot);
+
+    /**
+     * \return true if the SRS-triggered updates are executed in batch at the end of the slot
+     */
+    bool GetBatchPerSlot() const;
+
   private:
     BeamformingVectorPair GetBeamformingVectors(
         const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
         const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const override;
 
+    /**
+     * \brief Callback of the algorithms: runs the beamforming task immediately, or
+     * adds it to the batch of the current slot
+     * \param gNbDev a pointer to a gNB device
+     * \param ueDev a pointer to a UE device
+     * \param gnbSpectrumPhy the spectrum phy of the gNB
+     * \param ueSpectrumPhy the spectrum phy of the UE
+     */
+    void NotifyTask(const Ptr<NrGnbNetDevice>& gNbDev,
+                    const Ptr<NrUeNetDevice>& ueDev,
+                    const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
+                    const Ptr<NrSpectrumPhy>& ueSpectrumPhy);
+
+    /**
+     * \brief Run all the beamforming tasks collected for the slot ending at the specified time
+     * \param batchTime the end of the slot
+     */
+    void RunBatch(Time batchTime);
+
     typedef std::pair<Ptr<NrSpectrumPhy>, Ptr<NrSpectrumPhy>> BfAntennaPair;
     typedef std::map<BfAntennaPair, Ptr<RealisticBeamformingAlgorithm>> AntennaPairToAlgorithm;
+    typedef std::map<BfAntennaPair, Ptr<NrGnbPhy>> AntennaPairToGnbPhy;
+
+    /**
+     * \brief A beamforming task waiting for the end of the slot
+     */
+    struct PendingTask
+    {
+        Ptr<NrGnbNetDevice> gnbDev;        //!< gNB device
+        Ptr<NrUeNetDevice> ueDev;          //!< UE device
+        Ptr<NrSpectrumPhy> gnbSpectrumPhy; //!< gNB spectrum phy
+        Ptr<NrSpectrumPhy> ueSpectrumPhy;  //!< UE spectrum phy
+    };
+
+    /**
+     * \brief The tasks of a slot, in order of arrival, and the set of their antenna pairs
+     */
+    struct SlotBatch
+    {
+        std::vector<PendingTask> tasks;   //!< tasks in order of arrival
+        std::set<BfAntennaPair> antennas; //!< antenna pairs already in the batch
+    };
 
     AntennaPairToAlgorithm m_antennaPairToAlgorithm;
+    AntennaPairToGnbPhy m_antennaPairToGnbPhy; //!< gNB PHY of each pair, to know the slot end
+    bool m_batchPerSlot{false};                //!< Batch the SRS-triggered updates (attribute)
+    std::map<Time, SlotBatch> m_slotBatches;   //!< Pending batches, by end of slot
 };
 
 }; // namespace ns3
@@ -31,6 +31,7 @@ void
 BeamManager::Configure(const Ptr<UniformPlanarArray>& antennaArray)
 {
     m_antennaArray = antennaArray;
+    m_activeSlot = NO_ACTIVE_SLOT;
     ChangeToQuasiOmniBeamformingVector();
 }
 
@@ -61,7 +62,18 @@ TypeId
 BeamManager::GetTypeId()
 {
     static TypeId tid =
-        TypeId("ns3::BeamManager").SetParent<Object>().AddConstructor<BeamManager>();
+        TypeId("ns3::BeamManager")
+            .SetParent<Object>()
+            .AddConstructor<BeamManager>()
+            .AddAttribute("DenseStorage",
+                          "Keep the beamforming vectors in a vector indexed by the dense device "
+                          "index assigned at attach time, and skip rewriting the antenna weights "
+                          "when the requested beam is already active. Requires that the antenna "
+                          "weights are changed only through this BeamManager.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&BeamManager::SetDenseStorage,
+                                              &BeamManager::GetDenseStorage),
+                          MakeBooleanChecker());
     return tid;
 }
 
@@ -107,9 +119,112 @@ BeamManager::SaveBeamformingVector(const BeamformingVector& bfv, const Ptr<const
         {
             m_beamformingVectorMap.insert(std::make_pair(device, bfv));
         }
+        UpdateDenseSlot(bfv, device);
     }
 }
 
+void
+BeamManager::UpdateDenseSlot(const BeamformingVector& bfv, const Ptr<const NetDevice>& device)
+{
+    auto it = m_deviceIndexMap.find(device);
+    if (it == m_deviceIndexMap.end())
+    {
+        return;
+    }
+
+    uint32_t index = it->second;
+    m_denseSlots[index] = bfv;
+    m_denseSlotValid[index] = true;
+    if (m_activeSlot == index)
+    {
+        // The weights in the antenna are no longer the ones in the slot
+        m_activeSlot = NO_ACTIVE_SLOT;
+    }
+}
+
+void
+BeamManager::SetDeviceIndex(const Ptr<const NetDevice>& device, uint32_t index)
+{
+    NS_LOG_FUNCTION(this << index);
+    NS_ASSERT(device != nullptr);
+
+    if (index >= m_denseSlots.size())
+    {
+        m_indexToDevice.resize(index + 1);
+        m_denseSlots.resize(index + 1);
+        m_denseSlotValid.resize(index + 1, false);
+    }
+
+    m_deviceIndexMap[device] = index;
+    m_indexToDevice[index] = device;
+    m_denseSlotValid[index] = false;
+    if (m_activeSlot == index)
+    {
+        m_activeSlot = NO_ACTIVE_SLOT;
+    }
+
+    auto it = m_beamformingVectorMap.find(device);
+    if (it != m_beamformingVectorMap.end())
+    {
+        UpdateDenseSlot(it->second, device);
+    }
+}
+
+void
+BeamManager::ChangeBeamformingVector(uint32_t deviceIndex)
+{
+    NS_LOG_FUNCTION(this << deviceIndex);
+    NS_ASSERT_MSG(deviceIndex < m_indexToDevice.size(), "Device index not assigned");
+
+    if (!m_denseStorage)
+    {
+        ChangeBeamformingVector(m_indexToDevice[deviceIndex]);
+        return;
+    }
+
+    if (!m_denseSlotValid[deviceIndex])
+    {
+        NS_LOG_INFO("Could not find the beamforming vector for the provided device index");
+        ChangeToFallbackBeamformingVector();
+        return;
+    }
+
+    if (m_activeSlot != deviceIndex)
+    {
+        m_antennaArray->SetBeamformingVector(m_denseSlots[deviceIndex].first);
+        m_activeSlot = deviceIndex;
+    }
+}
+
+void
+BeamManager::ChangeToFallbackBeamformingVector()
+{
+    // if there is no beam defined for this specific device then use a
+    // predefined beam if specified and if not, then use quasi omni
+    if (m_predefinedDirTxRxW.first.GetSize() != 0)
+    {
+        m_antennaArray->SetBeamformingVector(m_predefinedDirTxRxW.first);
+        m_activeSlot = NO_ACTIVE_SLOT;
+    }
+    else
+    {
+        ChangeToQuasiOmniBeamformingVector();
+    }
+}
+
+void
+BeamManager::SetDenseStorage(bool denseStorage)
+{
+    m_denseStorage = denseStorage;
+    m_activeSlot = NO_ACTIVE_SLOT;
+}
+
+bool
+BeamManager::GetDenseStorage() const
+{
+    return m_denseStorage;
+}
+
 void
 BeamManager::ChangeBeamformingVector(const Ptr<const NetDevice>& device)
 {
@@ -119,22 +234,13 @@ BeamManager::ChangeBeamformingVector(const Ptr<const NetDevice>& device)
     if (it == m_beamformingVectorMap.end())
     {
         NS_LOG_INFO("Could not find the beamforming vector for the provided device");
-
-        // if there is no beam defined for this specific device then use a
-        // predefined beam if specified and if not, then use quasi omni
-        if (m_predefinedDirTxRxW.first.GetSize() != 0)
-        {
-            m_antennaArray->SetBeamformingVector(m_predefinedDirTxRxW.first);
-        }
-        else
-        {
-            ChangeToQuasiOmniBeamformingVector();
-        }
+        ChangeToFallbackBeamformingVector();
     }
     else
     {
         NS_LOG_INFO("Beamforming vector found");
         m_antennaArray->SetBeamformingVector(it->second.first);
+        m_activeSlot = NO_ACTIVE_SLOT;
     }
 }
 
@@ -167,8 +273,13 @@ BeamManager::ChangeToQuasiOmniBeamformingVector()
         m_numColumns = numColumns.Get();
         m_omniTxRxW = std::make_pair(CreateQuasiOmniBfv(m_numRows, m_numColumns), OMNI_BEAM_ID);
     }
+    else if (m_activeSlot == OMNI_ACTIVE_SLOT)
+    {
+        return; // The weights in the antenna are already the quasi-omni ones
+    }
 
     m_antennaArray->SetBeamformingVector(m_omniTxRxW.first);
+    m_activeSlot = OMNI_ACTIVE_SLOT;
 }
 
 PhasedArrayModel::ComplexVector
@@ -227,6 +338,7 @@ BeamManager::SetSector(uint16_t sector, double elevation) const
 {
     NS_LOG_INFO("Set sector to : " << (unsigned)sector << ", and elevation to: " << elevation);
     m_antennaArray->SetBeamformingVector(CreateDirectionalBfv(m_antennaArray, sector, elevation));
+    m_activeSlot = NO_ACTIVE_SLOT;
 }
 
 void
@@ -234,6 +346,7 @@ BeamManager::SetSectorAz(double azimuth, double zenith) const
 {
     NS_LOG_INFO("Set azimuth to : " << (unsigned)azimuth << ", and zenith to:" << zenith);
     m_antennaArray->SetBeamformingVector(CreateDirectionalBfvAz(m_antennaArray, azimuth, zenith));
+    m_activeSlot = NO_ACTIVE_SLOT;
 }
 
 } /* namespace ns3 */
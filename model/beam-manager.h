@@ -13,6 +13,9 @@
 #include <ns3/net-device.h>
 #include <ns3/nstime.h>
 
+#include <map>
+#include <vector>
+
 namespace ns3
 {
 
@@ -108,8 +111,37 @@ class BeamManager : public Object
      */
     virtual void ChangeBeamformingVector(const Ptr<const NetDevice>& device);
 
+    /**
+     * \brief Assign a dense index to a device
+     *
+     * The index is a small integer assigned by the owner of the BeamManager
+     * (e.g., the gNB PHY at UE attach time) that identifies the device in
+     * the dense beam storage. If a beamforming vector was already saved for
+     * the device, it is copied into the dense slot.
+     *
+     * \param device the device
+     * \param index the dense index of the device
+     */
+    void SetDeviceIndex(const Ptr<const NetDevice>& device, uint32_t index);
+
+    /**
+     * \brief Change the beamforming vector for tx/rx to/from the device
+     * registered with the specified dense index
+     *
+     * When the dense storage is enabled (attribute DenseStorage), the lookup
+     * is a direct indexing in the slot vector, and the antenna weights are not
+     * written again if the beam of the requested slot is already the active
+     * one. Otherwise, it behaves as ChangeBeamformingVector (device).
+     *
+     * \param deviceIndex the dense index of the device, see SetDeviceIndex
+     */
+    virtual void ChangeBeamformingVector(uint32_t deviceIndex);
+
     /**
      * \brief Change current beamforming vector to quasi-omni beamforming vector
+     *
+     * The antenna weights are not written again if the quasi-omni vector is
+     * already the active one.
      */
     virtual void ChangeToQuasiOmniBeamformingVector();
 
@@ -149,7 +181,36 @@ class BeamManager : public Object
      */
     void SetSectorAz(double azimuth, double zenith) const;
 
+    /**
+     * \brief Enable or disable the dense beam storage
+     * \param denseStorage true to enable the dense storage
+     */
+    void SetDenseStorage(bool denseStorage);
+
+    /**
+     * \brief Get the dense beam storage status
+     * \return true if the dense storage is enabled
+     */
+    bool GetDenseStorage() const;
+
   private:
+    /**
+     * \brief Copy a beamforming vector into the dense slot of a device, if any
+     * \param bfv the beamforming vector
+     * \param device the device
+     */
+    void UpdateDenseSlot(const BeamformingVector& bfv, const Ptr<const NetDevice>& device);
+
+    /**
+     * \brief Apply the fallback beam (predefined or quasi-omni) to the antenna
+     */
+    void ChangeToFallbackBeamformingVector();
+
+    static constexpr uint32_t NO_ACTIVE_SLOT =
+        UINT32_MAX; //!< Value of m_activeSlot when no dense slot is set in the antenna
+    static constexpr uint32_t OMNI_ACTIVE_SLOT =
+        UINT32_MAX - 1; //!< Value of m_activeSlot when the quasi-omni vector is set in the antenna
+
     Ptr<UniformPlanarArray>
         m_antennaArray;    //!< the antenna array instance for which is responsible this BeamManager
     uint32_t m_numRows{0}; //!< Number of rows of antenna array for which is calculated current
@@ -161,6 +222,15 @@ class BeamManager : public Object
     BeamformingStorage m_beamformingVectorMap; //!< device to beamforming vector mapping
     BeamformingVector m_predefinedDirTxRxW;    //!< A predefined vector that is used for directional
                                                //!< transmission and reception to any device
+
+    bool m_denseStorage{false}; //!< Use the dense, index-based beam storage
+    std::map<Ptr<const NetDevice>, uint32_t>
+        m_deviceIndexMap; //!< device to dense index mapping (used only when saving vectors)
+    std::vector<Ptr<const NetDevice>> m_indexToDevice; //!< dense index to device mapping
+    std::vector<BeamformingVector> m_denseSlots;       //!< beamforming vectors, by dense index
+    std::vector<bool> m_denseSlotValid; //!< true if a vector was saved in the dense slot
+    mutable uint32_t m_activeSlot{
+        NO_ACTIVE_SLOT}; //!< Dense slot whose weights are currently set in the antenna
 };
 
 } /* namespace ns3 */
@@ -6,7 +6,13 @@
 
 #include "bwp-manager-algorithm.h"
 
+#include <ns3/boolean.h>
+#include <ns3/double.h>
 #include <ns3/log.h>
+#include <ns3/uinteger.h>
+
+#include <algorithm>
+#include <cmath>
 
 namespace ns3
 {
@@ -22,6 +28,33 @@ BwpManagerAlgorithm::GetTypeId()
     return tid;
 }
 
+std::map<uint8_t, double>
+BwpManagerAlgorithm::GetBwpSharesForFlow([[maybe_unused]] uint16_t rnti,
+                                         [[maybe_unused]] uint8_t lcid,
+                                         const EpsBearer::Qci& v)
+{
+    return {{GetBwpForEpsBearer(v), 1.0}};
+}
+
+void
+BwpManagerAlgorithm::NotifyBwpBandwidth([[maybe_unused]] uint8_t bwpId,
+                                        [[maybe_unused]] uint16_t bandwidth)
+{
+}
+
+void
+BwpManagerAlgorithm::NotifyBwpLoad([[maybe_unused]] uint8_t bwpId,
+                                   [[maybe_unused]] double prbOccupancy)
+{
+}
+
+void
+BwpManagerAlgorithm::NotifyDlCqi([[maybe_unused]] uint16_t rnti,
+                                 [[maybe_unused]] uint8_t bwpId,
+                                 [[maybe_unused]] const std::vector<uint8_t>& wbCqi)
+{
+}
+
 NS_OBJECT_ENSURE_REGISTERED(BwpManagerAlgorithmStatic);
 
 #define DECLARE_ATTR(NAME, DESC, GETTER, SETTER)                                                   \
@@ -244,4 +277,175 @@ BwpManagerAlgorithmStatic::GetBwpForEpsBearer(const EpsBearer::Qci& v) const
     return m_qciToBwpMap.at(v);
 }
 
+NS_OBJECT_ENSURE_REGISTERED(BwpManagerAlgorithmLoadAware);
+
+TypeId
+BwpManagerAlgorithmLoadAware::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::BwpManagerAlgorithmLoadAware")
+            .SetParent<BwpManagerAlgorithmStatic>()
+            .SetGroupName("nr")
+            .AddConstructor<BwpManagerAlgorithmLoadAware>()
+            .AddAttribute("SplitBearers",
+                          "Split the buffer of a data flow among the BWPs, instead of "
+                          "moving the whole flow to the best BWP",
+                          BooleanValue(true),
+                          MakeBooleanAccessor(&BwpManagerAlgorithmLoadAware::m_splitBearers),
+                          MakeBooleanChecker())
+            .AddAttribute("Hysteresis",
+                          "Minimum change of the share of a BWP to update the shares of a "
+                          "flow; without splitting, minimum relative gain of weight to move "
+                          "a flow",
+                          DoubleValue(0.1),
+                          MakeDoubleAccessor(&BwpManagerAlgorithmLoadAware::m_hysteresis),
+                          MakeDoubleChecker<double>(0.0, 1.0))
+            .AddAttribute("MinFreeShare",
+                          "Minimum free share of the resources of a BWP in its weight",
+                          DoubleValue(0.1),
+                          MakeDoubleAccessor(&BwpManagerAlgorithmLoadAware::m_minFreeShare),
+                          MakeDoubleChecker<double>(0.0, 1.0))
+            .AddAttribute("Smoothing",
+                          "Weight of a new PRB occupancy in the smoothed load of a BWP",
+                          DoubleValue(0.1),
+                          MakeDoubleAccessor(&BwpManagerAlgorithmLoadAware::m_smoothing),
+                          MakeDoubleChecker<double>(0.0, 1.0))
+            .AddAttribute("InitialCqi",
+                          "CQI of a BWP in which the UE did not report a CQI yet",
+                          UintegerValue(7),
+                          MakeUintegerAccessor(&BwpManagerAlgorithmLoadAware::m_initialCqi),
+                          MakeUintegerChecker<uint8_t>(1, 15));
+    return tid;
+}
+
+std::map<uint8_t, double>
+BwpManagerAlgorithmLoadAware::GetBwpSharesForFlow(uint16_t rnti,
+                                                  uint8_t lcid,
+                                                  const EpsBearer::Qci& v)
+{
+    NS_LOG_FUNCTION(this << rnti << +lcid);
+
+    std::map<uint8_t, double> weights;
+    double sum = 0.0;
+    for (const auto& bwp : m_bandwidth)
+    {
+        if (bwp.second == 0)
+        {
+            continue; // No DL data in this BWP
+        }
+        auto cqi = m_dlCqi.find(std::make_pair(rnti, bwp.first));
+        const double quality = cqi != m_dlCqi.end() ? cqi->second : m_initialCqi;
+        const double weight =
+            bwp.second * quality * std::max(1.0 - GetBwpLoad(bwp.first), m_minFreeShare);
+        weights.emplace(bwp.first, weight);
+        sum += weight;
+    }
+
+    auto& shares = m_shares[std::make_pair(rnti, lcid)];
+
+    std::map<uint8_t, double> target;
+    if (weights.size() < 2 || sum <= 0.0)
+    {
+        target.emplace(GetBwpForEpsBearer(v), 1.0);
+    }
+    else if (m_splitBearers)
+    {
+        for (const auto& w : weights)
+        {
+            target.emplace(w.first, w.second / sum);
+        }
+    }
+    else
+    {
+        auto best = std::max_element(
+            weights.begin(),
+            weights.end(),
+            [](const auto& a, const auto& b) { return a.second < b.second; });
+        auto current = std::max_element(
+            shares.begin(),
+            shares.end(),
+            [](const auto& a, const auto& b) { return a.second < b.second; });
+        if (current != shares.end() && weights.count(current->first) > 0 &&
+            weights.at(current->first) * (1.0 + m_hysteresis) >= best->second)
+        {
+            target.emplace(current->first, 1.0);
+        }
+        else
+        {
+            target.emplace(best->first, 1.0);
+        }
+    }
+
+    // Update the shares only if one of them moves enough, or if the flow
+    // moves as a whole to another BWP
+    bool update = shares.empty();
+    for (const auto& t : target)
+    {
+        auto it = shares.find(t.first);
+        const double share = it != shares.end() ? it->second : 0.0;
+        update = update || std::abs(t.second - share) > m_hysteresis ||
+                 (t.second == 1.0 && share != 1.0);
+    }
+    for (const auto& share : shares)
+    {
+        update = update || (share.second > 0.0 && target.count(share.first) == 0);
+    }
+
+    if (update)
+    {
+        for (auto& share : shares)
+        {
+            share.second = 0.0;
+        }
+        for (const auto& t : target)
+        {
+            shares[t.first] = t.second;
+            NS_LOG_INFO("UE " << rnti << " LCID " << +lcid << " share of BWP " << +t.first
+                              << ": " << t.second);
+        }
+    }
+    return shares;
+}
+
+void
+BwpManagerAlgorithmLoadAware::NotifyBwpBandwidth(uint8_t bwpId, uint16_t bandwidth)
+{
+    NS_LOG_FUNCTION(this << +bwpId << bandwidth);
+    m_bandwidth[bwpId] = bandwidth;
+}
+
+void
+BwpManagerAlgorithmLoadAware::NotifyBwpLoad(uint8_t bwpId, double prbOccupancy)
+{
+    NS_LOG_FUNCTION(this << +bwpId << prbOccupancy);
+    auto it = m_load.find(bwpId);
+    if (it == m_load.end())
+    {
+        m_load.emplace(bwpId, prbOccupancy);
+        return;
+    }
+    it->second = m_smoothing * prbOccupancy + (1.0 - m_smoothing) * it->second;
+}
+
+void
+BwpManagerAlgorithmLoadAware::NotifyDlCqi(uint16_t rnti,
+                                          uint8_t bwpId,
+                                          const std::vector<uint8_t>& wbCqi)
+{
+    NS_LOG_FUNCTION(this << rnti << +bwpId);
+    uint32_t cqi = 0;
+    for (const auto& streamCqi : wbCqi)
+    {
+        cqi += streamCqi;
+    }
+    m_dlCqi[std::make_pair(rnti, bwpId)] = cqi;
+}
+
+double
+BwpManagerAlgorithmLoadAware::GetBwpLoad(uint8_t bwpId) const
+{
+    auto it = m_load.find(bwpId);
+    return it != m_load.end() ? it->second : 0.0;
+}
+
 } // namespace ns3
@@ -10,6 +10,10 @@
 #include <ns3/eps-bearer.h>
 #include <ns3/object.h>
 
+#include <map>
+#include <unordered_map>
+#include <vector>
+
 namespace ns3
 {
 
@@ -18,8 +22,10 @@ namespace ns3
  * \brief Interface for a Bwp selection algorithm based on the bearer
  *
  *
- * At the moment, we provide only a static algorithm that has to be configured
- * before the simulation starts (BwpManagerAlgorithmStatic).
+ * We provide a static algorithm that has to be configured before the
+ * simulation starts (BwpManagerAlgorithmStatic), and an algorithm that spreads
+ * the data flows among the BWPs following their load and the channel quality
+ * of the UE (BwpManagerAlgorithmLoadAware).
  *
  *
  * \section bwp_manager_conf Configuration
@@ -58,6 +64,45 @@ class BwpManagerAlgorithm : public Object
      * \return the bwp id that the algorithm selects for the qci specified
      */
     virtual uint8_t GetBwpForEpsBearer(const EpsBearer::Qci& v) const = 0;
+
+    /**
+     * \brief Get the share of the buffer of a data flow that each BWP has to serve
+     * \param rnti the RNTI of the UE
+     * \param lcid the LCID of the flow
+     * \param v the qci of the flow
+     * \return the share, between 0 and 1, of each BWP; the shares sum to 1
+     *
+     * The gNB BWP manager reports to each BWP the share of the buffer status
+     * of the flow. A BWP that has served the flow before must stay in the map,
+     * with a share of 0 when it does not serve the flow anymore. The default
+     * implementation gives the whole buffer to the BWP of GetBwpForEpsBearer().
+     */
+    virtual std::map<uint8_t, double> GetBwpSharesForFlow(uint16_t rnti,
+                                                          uint8_t lcid,
+                                                          const EpsBearer::Qci& v);
+
+    /**
+     * \brief Notify the DL bandwidth of a BWP
+     * \param bwpId the BWP index
+     * \param bandwidth the DL bandwidth, in the same unit for all the BWPs, or
+     * 0 if the BWP cannot carry DL data
+     */
+    virtual void NotifyBwpBandwidth(uint8_t bwpId, uint16_t bandwidth);
+
+    /**
+     * \brief Notify the DL PRB occupancy of a BWP, computed by its MAC in a slot
+     * \param bwpId the BWP index
+     * \param prbOccupancy the share of the DL resources used by data, between 0 and 1
+     */
+    virtual void NotifyBwpLoad(uint8_t bwpId, double prbOccupancy);
+
+    /**
+     * \brief Notify the DL wideband CQI reported by a UE in a BWP
+     * \param rnti the RNTI of the UE
+     * \param bwpId the BWP index
+     * \param wbCqi the wideband CQI of each stream
+     */
+    virtual void NotifyDlCqi(uint16_t rnti, uint8_t bwpId, const std::vector<uint8_t>& wbCqi);
 };
 
 /**
@@ -634,5 +679,76 @@ class BwpManagerAlgorithmStatic : public BwpManagerAlgorithm
     std::unordered_map<uint8_t, uint8_t> m_qciToBwpMap;
 };
 
+/**
+ * \ingroup bwp
+ * \brief Steering of the DL data flows among the BWPs by load and channel quality
+ *
+ * The BWP of each QCI is configured as in BwpManagerAlgorithmStatic, and it is
+ * used for the flows of a UE until the algorithm knows more than one BWP able
+ * to carry DL data. Then, the buffer of a data flow is split among the BWPs
+ * proportionally to the rate that the UE can expect from each of them:
+ *
+ * \f$ w_b = B_b \cdot \mathrm{CQI}_{u,b} \cdot \max(1 - o_b, f_{min}) \f$
+ *
+ * where \f$ B_b \f$ is the DL bandwidth of the BWP, \f$ \mathrm{CQI}_{u,b} \f$
+ * the last wideband CQI reported by the UE in the BWP (summed over the
+ * streams; "InitialCqi" if the UE did not report a CQI in the BWP yet),
+ * \f$ o_b \f$ the smoothed PRB occupancy of the BWP, and \f$ f_{min} \f$ the
+ * "MinFreeShare" attribute, which keeps a fully loaded BWP in use.
+ *
+ * With the attribute "SplitBearers" set to false, the whole flow goes to the
+ * BWP with the highest weight. In both cases, the shares of a flow change only
+ * when one of them moves by more than the "Hysteresis" attribute, to avoid
+ * moving the traffic back and forth at every buffer report.
+ *
+ * The signalling radio bearers, and the UL, always use the configured BWP of
+ * their QCI.
+ */
+class BwpManagerAlgorithmLoadAware : public BwpManagerAlgorithmStatic
+{
+  public:
+    /**
+     * \brief GetTypeId
+     * \return The TypeId of the object
+     */
+    static TypeId GetTypeId();
+
+    /**
+     * \brief constructor
+     */
+    BwpManagerAlgorithmLoadAware() = default;
+    /**
+     * \brief deconstructor
+     */
+    ~BwpManagerAlgorithmLoadAware() override = default;
+
+    // inherited
+    std::map<uint8_t, double> GetBwpSharesForFlow(uint16_t rnti,
+                                                  uint8_t lcid,
+                                                  const EpsBearer::Qci& v) override;
+    void NotifyBwpBandwidth(uint8_t bwpId, uint16_t bandwidth) override;
+    void NotifyBwpLoad(uint8_t bwpId, double prbOccupancy) override;
+    void NotifyDlCqi(uint16_t rnti, uint8_t bwpId, const std::vector<uint8_t>& wbCqi) override;
+
+    /**
+     * \param bwpId the BWP index
+     * \return the smoothed PRB occupancy of the BWP
+     */
+    double GetBwpLoad(uint8_t bwpId) const;
+
+  private:
+    std::map<uint8_t, uint16_t> m_bandwidth;                  //!< DL bandwidth of each BWP
+    std::map<uint8_t, double> m_load;                         //!< Smoothed occupancy of each BWP
+    std::map<std::pair<uint16_t, uint8_t>, uint32_t> m_dlCqi; //!< CQI of each UE and BWP
+    std::map<std::pair<uint16_t, uint8_t>, std::map<uint8_t, double>>
+        m_shares; //!< Current shares of each flow (RNTI, LCID)
+
+    bool m_splitBearers{true};  //!< Split the buffer of a flow among the BWPs
+    double m_hysteresis{0.1};   //!< Minimum change of a share to update the shares
+    double m_minFreeShare{0.1}; //!< Minimum free share of a BWP in its weight
+    double m_smoothing{0.1};    //!< Weight of a new occupancy in the smoothed load
+    uint8_t m_initialCqi{7};    //!< CQI of a BWP in which the UE did not report yet
+};
+
 } // namespace ns3
 #endif // BWPMANAGERALGORITHM_H
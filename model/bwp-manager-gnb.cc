@@ -14,6 +14,8 @@
 #include <ns3/pointer.h>
 #include <ns3/uinteger.h>
 
+#include <algorithm>
+
 namespace ns3
 {
 
@@ -42,7 +44,12 @@ BwpManagerGnb::GetTypeId()
                                           "The algorithm pointer",
                                           PointerValue(),
                                           MakePointerAccessor(&BwpManagerGnb::m_algorithm),
-                                          MakePointerChecker<BwpManagerAlgorithm>());
+                                          MakePointerChecker<BwpManagerAlgorithm>())
+                            .AddTraceSource("PrbOccupancy",
+                                            "DL PRB occupancy reported by the MAC of a BWP",
+                                            MakeTraceSourceAccessor(
+                                                &BwpManagerGnb::m_prbOccupancyTrace),
+                                            "ns3::BwpManagerGnb::PrbOccupancyTracedCallback");
     return tid;
 }
 
@@ -120,10 +127,17 @@ BwpManagerGnb::PeekBwpIndex(uint16_t rnti, uint8_t lcid) const
 }
 
 uint8_t
-BwpManagerGnb::RouteIngoingCtrlMsgs(const Ptr<NrControlMessage>& msg, uint8_t sourceBwpId) const
+BwpManagerGnb::RouteIngoingCtrlMsgs(const Ptr<NrControlMessage>& msg, uint8_t sourceBwpId)
 {
     NS_LOG_FUNCTION(this);
 
+    if (msg->GetMessageType() == NrControlMessage::DL_CQI && m_algorithm != nullptr)
+    {
+        Ptr<NrDlCqiMessage> cqiMsg = DynamicCast<NrDlCqiMessage>(msg);
+        const DlCqiInfo cqi = cqiMsg->GetDlCqi();
+        m_algorithm->NotifyDlCqi(cqi.m_rnti, msg->GetSourceBwp(), cqi.m_wbCqi);
+    }
+
     NS_LOG_INFO("Msg type " << msg->GetMessageType() << " from bwp " << +sourceBwpId
                             << " that wants to go in the gnb, goes in BWP " << msg->GetSourceBwp());
     return msg->GetSourceBwp();
@@ -161,12 +175,79 @@ BwpManagerGnb::SetOutputLink(uint32_t sourceBwp, uint32_t outputBwp)
     m_outputLinks.insert(std::make_pair(sourceBwp, outputBwp));
 }
 
+void
+BwpManagerGnb::SetBwpBandwidth(uint8_t bwpId, uint16_t bandwidth)
+{
+    NS_LOG_FUNCTION(this << +bwpId << bandwidth);
+    NS_ASSERT(m_algorithm != nullptr);
+    m_algorithm->NotifyBwpBandwidth(bwpId, bandwidth);
+}
+
 void
 BwpManagerGnb::DoReportBufferStatus(LteMacSapProvider::ReportBufferStatusParameters params)
 {
     NS_LOG_FUNCTION(this);
 
-    uint8_t bwpIndex = GetBwpIndex(params.rnti, params.lcid);
+    std::map<uint8_t, double> shares;
+    if (params.lcid < 3)
+    {
+        // Signalling radio bearers
+        shares.emplace(GetBwpIndex(params.rnti, params.lcid), 1.0);
+    }
+    else
+    {
+        NS_ASSERT(m_algorithm != nullptr);
+        uint8_t qci = m_ueInfo.at(params.rnti).m_rlcLcInstantiated.at(params.lcid).qci;
+        shares = m_algorithm->GetBwpSharesForFlow(params.rnti,
+                                                  params.lcid,
+                                                  static_cast<EpsBearer::Qci>(qci));
+    }
+    NS_ASSERT(!shares.empty());
+
+    // The BWP with the largest share takes the status PDU, and what is left
+    // by the rounding of the other shares
+    auto main = std::max_element(shares.begin(), shares.end(), [](const auto& a, const auto& b) {
+        return a.second < b.second;
+    });
+    uint32_t txQueueSize = params.txQueueSize;
+    uint32_t retxQueueSize = params.retxQueueSize;
+
+    for (const auto& share : shares)
+    {
+        if (share.first == main->first)
+        {
+            continue;
+        }
+        LteMacSapProvider::ReportBufferStatusParameters bwpParams = params;
+        bwpParams.txQueueSize = static_cast<uint32_t>(params.txQueueSize * share.second);
+        bwpParams.retxQueueSize = static_cast<uint32_t>(params.retxQueueSize * share.second);
+        bwpParams.statusPduSize = 0;
+        if (bwpParams.txQueueSize == 0)
+        {
+            bwpParams.txQueueHolDelay = 0;
+        }
+        if (bwpParams.retxQueueSize == 0)
+        {
+            bwpParams.retxQueueHolDelay = 0;
+        }
+        txQueueSize -= bwpParams.txQueueSize;
+        retxQueueSize -= bwpParams.retxQueueSize;
+        ReportBufferStatusToBwp(share.first, bwpParams);
+    }
+
+    params.txQueueSize = txQueueSize;
+    params.retxQueueSize = retxQueueSize;
+    ReportBufferStatusToBwp(main->first, params);
+}
+
+void
+BwpManagerGnb::ReportBufferStatusToBwp(
+    uint8_t bwpIndex,
+    const LteMacSapProvider::ReportBufferStatusParameters& params)
+{
+    NS_LOG_FUNCTION(this);
+    NS_LOG_DEBUG("Buffer of UE " << params.rnti << " LCID " << +params.lcid << " to BWP "
+                                 << +bwpIndex << ": " << params.txQueueSize << " bytes");
 
     if (m_macSapProvidersMap.find(bwpIndex) != m_macSapProvidersMap.end())
     {
@@ -231,4 +312,14 @@ BwpManagerGnb::DoUlReceiveSr(uint16_t rnti, uint8_t componentCarrierId)
     m_ccmMacSapProviderMap.find(componentCarrierId)->second->ReportSrToScheduler(rnti);
 }
 
+void
+BwpManagerGnb::DoNotifyPrbOccupancy(double prbOccupancy, uint8_t componentCarrierId)
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(m_algorithm != nullptr);
+
+    m_prbOccupancyTrace(componentCarrierId, prbOccupancy);
+    m_algorithm->NotifyBwpLoad(componentCarrierId, prbOccupancy);
+}
+
 } // end of namespace ns3
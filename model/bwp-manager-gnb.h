@@ -12,6 +12,7 @@
 #include <ns3/lte-rlc.h>
 #include <ns3/lte-rrc-sap.h>
 #include <ns3/no-op-component-carrier-manager.h>
+#include <ns3/traced-callback.h>
 
 #include <unordered_map>
 
@@ -25,6 +26,14 @@ class NrControlMessage;
 /**
  * \ingroup gnb-bwp
  * \brief Bandwidth part manager that coordinates traffic over different bandwidth parts.
+ *
+ * The buffer status of a data flow is reported to the BWPs following the
+ * shares given by the algorithm (BwpManagerAlgorithm::GetBwpSharesForFlow):
+ * when more than one BWP serves the flow, each one receives its share of the
+ * buffer, as the carrier aggregation does in the LTE component carrier
+ * managers. To take its decisions, the algorithm is notified of the DL
+ * bandwidth of the BWPs (SetBwpBandwidth()), of the PRB occupancy reported by
+ * their MAC, and of the DL CQI reported by the UEs.
  */
 class BwpManagerGnb : public RrComponentCarrierManager
 {
@@ -64,10 +73,11 @@ class BwpManagerGnb : public RrComponentCarrierManager
      * \param sourceBwpId BWP Id from which this message come from.
      *
      * The routing is made following the bandwidth part reported in the message.
+     * The DL CQI messages are also notified to the algorithm.
      *
      * \return the BWP Id to which this message should be routed to.
      */
-    uint8_t RouteIngoingCtrlMsgs(const Ptr<NrControlMessage>& msg, uint8_t sourceBwpId) const;
+    uint8_t RouteIngoingCtrlMsgs(const Ptr<NrControlMessage>& msg, uint8_t sourceBwpId);
 
     /**
      * \brief Route the outgoing messages to the right BWP
@@ -94,6 +104,20 @@ class BwpManagerGnb : public RrComponentCarrierManager
      */
     void SetOutputLink(uint32_t sourceBwp, uint32_t outputBwp);
 
+    /**
+     * \brief Set the DL bandwidth of a BWP, for the algorithm
+     * \param bwpId the BWP index
+     * \param bandwidth the DL bandwidth, or 0 if the BWP cannot carry DL data
+     */
+    void SetBwpBandwidth(uint8_t bwpId, uint16_t bandwidth);
+
+    /**
+     * \brief TracedCallback signature for the PRB occupancy of a BWP
+     * \param [in] bwpId the BWP index
+     * \param [in] prbOccupancy the share of the DL resources used by data in a slot
+     */
+    typedef void (*PrbOccupancyTracedCallback)(uint8_t bwpId, double prbOccupancy);
+
   protected:
     /*
      * \brief This function contains most of the BwpManager logic.
@@ -121,6 +145,14 @@ class BwpManagerGnb : public RrComponentCarrierManager
      */
     void DoUlReceiveSr(uint16_t rnti, uint8_t componentCarrierId) override;
 
+    /**
+     * \brief Notify the PRB occupancy of a BWP to the algorithm, called by MAC
+     * through CCM SAP interface.
+     * \param prbOccupancy the PRB occupancy
+     * \param componentCarrierId the component carrier ID
+     */
+    void DoNotifyPrbOccupancy(double prbOccupancy, uint8_t componentCarrierId) override;
+
     /**
      * \brief Overload DoSetupBadaRadioBearer to connect directly to Rlc retransmission buffer size.
      */
@@ -139,9 +171,19 @@ class BwpManagerGnb : public RrComponentCarrierManager
      */
     uint8_t GetResourceType(LteMacSapProvider::ReportBufferStatusParameters params);
 
+    /**
+     * \brief Report a buffer status to the MAC of a BWP
+     * \param bwpIndex the BWP index
+     * \param params the buffer status
+     */
+    void ReportBufferStatusToBwp(uint8_t bwpIndex,
+                                 const LteMacSapProvider::ReportBufferStatusParameters& params);
+
     Ptr<BwpManagerAlgorithm> m_algorithm; //!< The BWP selection algorithm.
 
     std::unordered_map<uint32_t, uint32_t> m_outputLinks; //!< Mapping between BWP.
+
+    TracedCallback<uint8_t, double> m_prbOccupancyTrace; //!< PRB occupancy of the BWPs
 };
 
 } // end of namespace ns3
@@ -71,6 +71,36 @@ NrSRMessage::GetRNTI() const
     return m_rnti;
 }
 
+NrDlPreemptionMessage::NrDlPreemptionMessage()
+{
+    NS_LOG_INFO(this);
+    SetMessageType(NrControlMessage::DL_PREEMPTION);
+}
+
+NrDlPreemptionMessage::~NrDlPreemptionMessage()
+{
+    NS_LOG_INFO(this);
+}
+
+void
+NrDlPreemptionMessage::SetPreemptedSymbols(uint8_t symStart, uint8_t numSym)
+{
+    m_symStart = symStart;
+    m_numSym = numSym;
+}
+
+uint8_t
+NrDlPreemptionMessage::GetSymStart() const
+{
+    return m_symStart;
+}
+
+uint8_t
+NrDlPreemptionMessage::GetNumSym() const
+{
+    return m_numSym;
+}
+
 NrDlDciMessage::NrDlDciMessage(const std::shared_ptr<DciInfoElementTdma>& dci)
     : m_dciInfoElement(dci)
 {
@@ -229,6 +259,38 @@ NrSib1Message::GetSib1() const
 
 // ----------------------------------------------------------------------------------------------------------
 
+NrTddPatternMessage::NrTddPatternMessage()
+{
+    NS_LOG_INFO(this);
+    SetMessageType(NrControlMessage::TDD_PATTERN);
+}
+
+NrTddPatternMessage::~NrTddPatternMessage()
+{
+    NS_LOG_INFO(this);
+}
+
+void
+NrTddPatternMessage::SetPattern(const std::vector<LteNrTddSlotType>& pattern, uint32_t frame)
+{
+    m_pattern = pattern;
+    m_frame = frame;
+}
+
+const std::vector<LteNrTddSlotType>&
+NrTddPatternMessage::GetPattern() const
+{
+    return m_pattern;
+}
+
+uint32_t
+NrTddPatternMessage::GetFrame() const
+{
+    return m_frame;
+}
+
+// ----------------------------------------------------------------------------------------------------------
+
 NrRachPreambleMessage::NrRachPreambleMessage()
 {
     SetMessageType(NrControlMessage::RACH_PREAMBLE);
@@ -57,6 +57,8 @@ class NrControlMessage : public SimpleRefCount<NrControlMessage>
         DL_HARQ,       //!< DL HARQ feedback
         SR,            //!< Scheduling Request: asking for space
         SRS,           //!< SRS
+        DL_PREEMPTION, //!< Preemption indication of DL symbols (DCI format 2_1)
+        TDD_PATTERN,   //!< TDD pattern to use from a frame
     };
 
     /**
@@ -134,6 +136,51 @@ class NrSRMessage : public NrControlMessage
     uint16_t m_rnti{0}; //!< RNTI
 };
 
+/**
+ * \ingroup utils
+ * \brief Preemption indication message
+ *
+ * Group-common message that the gNB sends in the PDCCH of a mini-slot, to
+ * indicate that the DL symbols of the mini-slot, in the current slot, have
+ * been taken from the allocations that overlap them. A UE with a TB in these
+ * symbols discards it.
+ */
+class NrDlPreemptionMessage : public NrControlMessage
+{
+  public:
+    /**
+     * \brief NrDlPreemptionMessage constructor
+     */
+    NrDlPreemptionMessage();
+    /**
+     * \brief ~NrDlPreemptionMessage
+     */
+    ~NrDlPreemptionMessage() override;
+
+    /**
+     * \brief Set the preempted symbols of the current slot
+     * \param symStart first preempted symbol
+     * \param numSym number of preempted symbols
+     */
+    void SetPreemptedSymbols(uint8_t symStart, uint8_t numSym);
+
+    /**
+     * \brief Get the first preempted symbol
+     * \return the first preempted symbol
+     */
+    uint8_t GetSymStart() const;
+
+    /**
+     * \brief Get the number of preempted symbols
+     * \return the number of preempted symbols
+     */
+    uint8_t GetNumSym() const;
+
+  private:
+    uint8_t m_symStart{0}; //!< First preempted symbol
+    uint8_t m_numSym{0};   //!< Number of preempted symbols
+};
+
 /**
  * \brief The message that represents a DL DCI message
  * \ingroup utils
@@ -371,6 +418,51 @@ class NrSib1Message : public NrControlMessage
 
 // ---------------------------------------------------------------------------
 
+/**
+ * \ingroup utils
+ * \brief Broadcast of a new TDD pattern
+ *
+ * The gNB sends it in the frame before the switch, so that its UEs place the
+ * DL and UL CTRL of the slots with the same pattern as the gNB.
+ */
+class NrTddPatternMessage : public NrControlMessage
+{
+  public:
+    /**
+     * \brief NrTddPatternMessage constructor
+     */
+    NrTddPatternMessage();
+    /**
+     * \brief ~NrTddPatternMessage
+     */
+    ~NrTddPatternMessage() override;
+
+    /**
+     * \brief Set the pattern, and the frame from which it is used
+     * \param pattern the TDD pattern
+     * \param frame the frame of the switch
+     */
+    void SetPattern(const std::vector<LteNrTddSlotType>& pattern, uint32_t frame);
+
+    /**
+     * \brief Get the TDD pattern
+     * \return the TDD pattern
+     */
+    const std::vector<LteNrTddSlotType>& GetPattern() const;
+
+    /**
+     * \brief Get the frame from which the pattern is used
+     * \return the frame of the switch
+     */
+    uint32_t GetFrame() const;
+
+  private:
+    std::vector<LteNrTddSlotType> m_pattern; //!< The TDD pattern
+    uint32_t m_frame{0};                     //!< Frame of the switch
+};
+
+// ---------------------------------------------------------------------------
+
 /**
  * \ingroup utils
  *
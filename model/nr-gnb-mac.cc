@@ -135,6 +135,8 @@ class NrMacEnbMemberPhySapUser : public NrGnbPhySapUser
 
     void SlotUlIndication(const SfnSf&, LteNrTddSlotType) override;
 
+    void MiniSlotDlIndication(const SfnSf& sfn, uint8_t symStart, uint8_t numSym) override;
+
     void SetCurrentSfn(const SfnSf&) override;
 
     void UlCqiReport(NrMacSchedSapProvider::SchedUlCqiInfoReqParameters cqi) override;
@@ -152,6 +154,9 @@ class NrMacEnbMemberPhySapUser : public NrGnbPhySapUser
 
     uint8_t GetDlCtrlSymbols() const override;
 
+    uint64_t GetDlBufferSize() const override;
+    uint64_t GetUlBufferSize() const override;
+
   private:
     NrGnbMac* m_mac;
 };
@@ -185,6 +190,12 @@ NrMacEnbMemberPhySapUser::SlotUlIndication(const SfnSf& sfn, LteNrTddSlotType ty
     m_mac->DoSlotUlIndication(sfn, type);
 }
 
+void
+NrMacEnbMemberPhySapUser::MiniSlotDlIndication(const SfnSf& sfn, uint8_t symStart, uint8_t numSym)
+{
+    m_mac->DoMiniSlotDlIndication(sfn, symStart, numSym);
+}
+
 void
 NrMacEnbMemberPhySapUser::SetCurrentSfn(const SfnSf& sfn)
 {
@@ -239,13 +250,25 @@ NrMacEnbMemberPhySapUser::GetDlCtrlSymbols() const
     return m_mac->GetDlCtrlSyms();
 }
 
+uint64_t
+NrMacEnbMemberPhySapUser::GetDlBufferSize() const
+{
+    return m_mac->GetDlBufferSize();
+}
+
+uint64_t
+NrMacEnbMemberPhySapUser::GetUlBufferSize() const
+{
+    return m_mac->GetUlBufferSize();
+}
+
 // MAC Sched
 
 class NrMacMemberMacSchedSapUser : public NrMacSchedSapUser
 {
   public:
     NrMacMemberMacSchedSapUser(NrGnbMac* mac);
-    void SchedConfigInd(const struct SchedConfigIndParameters& params) override;
+    void SchedConfigInd(struct SchedConfigIndParameters params) override;
     Ptr<const SpectrumModel> GetSpectrumModel() const override;
     uint32_t GetNumRbPerRbg() const override;
     uint8_t GetNumHarqProcess() const override;
@@ -265,9 +288,9 @@ NrMacMemberMacSchedSapUser::NrMacMemberMacSchedSapUser(NrGnbMac* mac)
 }
 
 void
-NrMacMemberMacSchedSapUser::SchedConfigInd(const struct SchedConfigIndParameters& params)
+NrMacMemberMacSchedSapUser::SchedConfigInd(struct SchedConfigIndParameters params)
 {
-    m_mac->DoSchedConfigIndication(params);
+    m_mac->DoSchedConfigIndication(std::move(params));
 }
 
 Ptr<const SpectrumModel>
@@ -506,6 +529,27 @@ NrGnbMac::GetUlCtrlSyms() const
     return m_macSchedSapProvider->GetUlCtrlSyms();
 }
 
+uint64_t
+NrGnbMac::GetDlBufferSize() const
+{
+    return m_macSchedSapProvider->GetDlBufferSize();
+}
+
+uint64_t
+NrGnbMac::GetUlBufferSize() const
+{
+    return m_macSchedSapProvider->GetUlBufferSize();
+}
+
+uint16_t
+NrGnbMac::AllocateFastAttachRnti()
+{
+    NS_LOG_FUNCTION(this);
+    const uint16_t rnti = m_cmacSapUser->AllocateTemporaryCellRnti();
+    NS_LOG_INFO("In slot " << m_currentSlot << " fast attach of RNTI " << rnti);
+    return rnti;
+}
+
 void
 NrGnbMac::ReceiveRachPreamble(uint32_t raId)
 {
@@ -639,6 +683,20 @@ NrGnbMac::DoSlotDlIndication(const SfnSf& sfnSf, LteNrTddSlotType type)
     m_macSchedSapProvider->SchedDlTriggerReq(dlParams);
 }
 
+void
+NrGnbMac::DoMiniSlotDlIndication(const SfnSf& sfnSf, uint8_t symStart, uint8_t numSym)
+{
+    NS_LOG_FUNCTION(this);
+    NS_LOG_INFO("DL mini-slot of " << +numSym << " symbols at symbol " << +symStart
+                                   << ", slot on the air: " << sfnSf);
+
+    NrMacSchedSapProvider::SchedDlMiniSlotReqParameters params;
+    params.m_snfSf = sfnSf;
+    params.m_symStart = symStart;
+    params.m_numSym = numSym;
+    m_macSchedSapProvider->SchedDlMiniSlotReq(params);
+}
+
 void
 NrGnbMac::DoSlotUlIndication(const SfnSf& sfnSf, LteNrTddSlotType type)
 {
@@ -1069,6 +1127,52 @@ NrGnbMac::SendRar(const std::vector<BuildRarListElement_s>& rarList)
     }
 }
 
+void
+NrGnbMac::NotifyDlPrbOccupancy(const SlotAllocInfo& slotAllocInfo) const
+{
+    NS_LOG_FUNCTION(this);
+
+    if (m_ccmMacSapUser == nullptr)
+    {
+        return;
+    }
+
+    bool dlSlot = false;
+    std::size_t numRbg = 0;
+    uint32_t usedRbgSym = 0;
+    for (const auto& varTti : slotAllocInfo.m_varTtiAllocInfo)
+    {
+        const auto& dci = varTti.m_dci;
+        // The mini-slots are in the DL data region of a slot already notified:
+        // scoring them as slots of their own would bias the load downwards
+        if (dci->m_format != DciInfoElementTdma::DL || dci->m_miniSlot)
+        {
+            continue;
+        }
+        dlSlot = true;
+        if (dci->m_type == DciInfoElementTdma::DATA)
+        {
+            numRbg = dci->m_rbgBitmask.size();
+            const auto usedRbg =
+                std::count(dci->m_rbgBitmask.begin(), dci->m_rbgBitmask.end(), 1);
+            usedRbgSym += dci->m_numSym * static_cast<uint32_t>(usedRbg);
+        }
+    }
+
+    if (!dlSlot)
+    {
+        return;
+    }
+
+    double occupancy = 0.0;
+    const uint32_t dataSym = m_phySapProvider->GetSymbolsPerSlot() - GetDlCtrlSyms();
+    if (numRbg > 0 && dataSym > 0)
+    {
+        occupancy = std::min(1.0, static_cast<double>(usedRbgSym) / (numRbg * dataSym));
+    }
+    m_ccmMacSapUser->NotifyPrbOccupancy(occupancy, GetBwpId());
+}
+
 void
 NrGnbMac::DoSchedConfigIndication(NrMacSchedSapUser::SchedConfigIndParameters ind)
 {
@@ -1082,6 +1186,8 @@ NrGnbMac::DoSchedConfigIndication(NrMacSchedSapUser::SchedConfigIndParameters in
 
     SendRar(ind.m_buildRarList);
 
+    NotifyDlPrbOccupancy(ind.m_slotAllocInfo);
+
     for (unsigned islot = 0; islot < ind.m_slotAllocInfo.m_varTtiAllocInfo.size(); islot++)
     {
         VarTtiAllocInfo& varTtiAllocInfo = ind.m_slotAllocInfo.m_varTtiAllocInfo[islot];
@@ -112,6 +112,18 @@ class NrGnbMac : public Object
      */
     virtual uint8_t GetUlCtrlSyms() const;
 
+    /**
+     * \brief Retrieve the bytes waiting in the DL buffers known by the scheduler
+     * \return the bytes of the DL buffers
+     */
+    uint64_t GetDlBufferSize() const;
+
+    /**
+     * \brief Retrieve the bytes waiting in the UL buffers known by the scheduler
+     * \return the bytes of the UL buffers
+     */
+    uint64_t GetUlBufferSize() const;
+
     /**
      * \brief Perform DL scheduling decision for the indicated slot
      * \param sfnSf the slot to fill with scheduling decisions
@@ -134,6 +146,18 @@ class NrGnbMac : public Object
      */
     virtual void DoSlotUlIndication(const SfnSf& sfnSf, LteNrTddSlotType type);
 
+    /**
+     * \brief Offer a DL mini-slot of the current slot to the scheduler
+     * \param sfnSf the current slot
+     * \param symStart first symbol of the mini-slot
+     * \param numSym number of symbols of the mini-slot
+     *
+     * Unlike the slot indications, the decision is for the slot on the air:
+     * if the scheduler uses the mini-slot, its allocation and PDUs are sent to
+     * the PHY before this method returns.
+     */
+    virtual void DoMiniSlotDlIndication(const SfnSf& sfnSf, uint8_t symStart, uint8_t numSym);
+
     /**
      * \brief Set the current sfn
      * \param sfn Current sfn
@@ -175,6 +199,16 @@ class NrGnbMac : public Object
      */
     void BeamChangeReport(BeamConfId beamConfId, uint8_t rnti);
 
+    /**
+     * \brief Give a RNTI to a UE that attaches without random access
+     * \return the RNTI
+     *
+     * Used by the fast attach of NrHelper: the RNTI is allocated by the RRC
+     * as for a received RACH preamble, which creates the context of the UE in
+     * the RRC and in the scheduler, but without preamble, RAR, or collisions.
+     */
+    uint16_t AllocateFastAttachRnti();
+
     /**
      * TracedCallback signature for DL and UL data scheduling events.
      *
@@ -330,6 +364,18 @@ class NrGnbMac : public Object
      */
     void SendRar(const std::vector<BuildRarListElement_s>& rarList);
 
+    /**
+     * \brief Notify the component carrier manager of the DL PRB occupancy
+     * of a slot
+     * \param slotAllocInfo the allocation of the slot
+     *
+     * The occupancy is the share of the RBG-symbols of the DL data region used
+     * by DL data; nothing is notified for a slot without DL, nor for the
+     * allocation of a DL mini-slot, whose symbols belong to a slot already
+     * notified.
+     */
+    void NotifyDlPrbOccupancy(const SlotAllocInfo& slotAllocInfo) const;
+
   private:
     struct HarqProcessInfoSingleStream
     {
@@ -359,7 +405,7 @@ class NrGnbMac : public Object
 
     // Sap For ComponentCarrierManager 'Uplink case'
     LteCcmMacSapProvider* m_ccmMacSapProvider; ///< CCM MAC SAP provider
-    LteCcmMacSapUser* m_ccmMacSapUser;         ///< CCM MAC SAP user
+    LteCcmMacSapUser* m_ccmMacSapUser{nullptr}; ///< CCM MAC SAP user
 
     int32_t m_numRbPerRbg{-1}; //!< number of resource blocks within the channel bandwidth
 
@@ -237,6 +237,11 @@ NrGnbNetDevice::UpdateConfig()
     {
         Ptr<ComponentCarrierBaseStation> c = i.second;
         ccPhyConfMap.insert(std::pair<uint8_t, Ptr<ComponentCarrierBaseStation>>(i.first, c));
+
+        // A BWP without DL slots cannot carry the DL data flows
+        GetBwpManager()->SetBwpBandwidth(
+            i.first,
+            i.second->GetPhy()->HasDlSlot() ? i.second->GetDlBandwidth() : 0);
     }
 
     m_rrc->ConfigureCell(ccPhyConfMap);
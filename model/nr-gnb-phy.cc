@@ -17,6 +17,7 @@
 #include "nr-gnb-net-device.h"
 #include "nr-net-device.h"
 #include "nr-radio-bearer-tag.h"
+#include "nr-tdd-adaptation.h"
 #include "nr-ue-net-device.h"
 #include "nr-ue-phy.h"
 
@@ -32,6 +33,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <numeric>
 #include <string>
 #include <unordered_set>
 
@@ -132,6 +134,21 @@ NrGnbPhy::GetTypeId()
                           UintegerValue(2),
                           MakeUintegerAccessor(&NrGnbPhy::SetN2Delay, &NrGnbPhy::GetN2Delay),
                           MakeUintegerChecker<uint32_t>(0, 4))
+            .AddAttribute("MiniSlotSymbols",
+                          "Number of symbols of the DL mini-slots, in which the delay-critical "
+                          "data can preempt the DL data of the current slot: 2, 4, 7, or 0 to "
+                          "disable the mini-slots",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&NrGnbPhy::SetMiniSlotSymbols,
+                                               &NrGnbPhy::GetMiniSlotSymbols),
+                          MakeUintegerChecker<uint8_t>(0, 7))
+            .AddAttribute("TddAdaptation",
+                          "Entity that selects the TDD pattern from the buffer load at the start "
+                          "of each frame; if null, the pattern does not change",
+                          PointerValue(),
+                          MakePointerAccessor(&NrGnbPhy::SetTddAdaptation,
+                                              &NrGnbPhy::GetTddAdaptation),
+                          MakePointerChecker<NrTddAdaptation>())
             .AddAttribute("TbDecodeLatency",
                           "Transport block decode latency",
                           TimeValue(MicroSeconds(100)),
@@ -172,7 +189,22 @@ NrGnbPhy::GetTypeId()
                 "RBDataStats",
                 "Resource Block used for data: SfnSf, symbol, RB PHY map, bwp ID, cell ID",
                 MakeTraceSourceAccessor(&NrGnbPhy::m_rbStatistics),
-                "ns3::NrGnbPhy::RBStatsTracedCallback");
+                "ns3::NrGnbPhy::RBStatsTracedCallback")
+            .AddTraceSource("DlMiniSlot",
+                            "DL allocation of a mini-slot: SfnSf, RNTI, first symbol, symbols, "
+                            "TB size, bwp ID, cell ID",
+                            MakeTraceSourceAccessor(&NrGnbPhy::m_dlMiniSlotTrace),
+                            "ns3::NrGnbPhy::DlMiniSlotTracedCallback")
+            .AddTraceSource("DlPreemption",
+                            "DL allocation preempted by a mini-slot: SfnSf, RNTI, first symbol, "
+                            "symbols, TB size, bwp ID, cell ID",
+                            MakeTraceSourceAccessor(&NrGnbPhy::m_dlPreemptionTrace),
+                            "ns3::NrGnbPhy::DlMiniSlotTracedCallback")
+            .AddTraceSource("TddPattern",
+                            "Switch of the TDD pattern: first SfnSf with the new pattern, pattern, "
+                            "bwp ID, cell ID",
+                            MakeTraceSourceAccessor(&NrGnbPhy::m_tddPatternTrace),
+                            "ns3::NrGnbPhy::TddPatternTracedCallback");
     return tid;
 }
 
@@ -188,6 +220,12 @@ NrGnbPhy::GetCurrentSfnSf() const
     return m_currentSlot;
 }
 
+Time
+NrGnbPhy::GetTimeToNextSlot() const
+{
+    return m_lastSlotStart + GetSlotPeriod() - Simulator::Now();
+}
+
 /**
  * \brief An intelligent way to calculate the modulo
  * \param n Number
@@ -463,6 +501,51 @@ NrGnbPhy::SetTddPattern(const std::vector<LteNrTddSlotType>& pattern)
                                   GetL1L2CtrlLatency());
 }
 
+void
+NrGnbPhy::AdaptTddPattern()
+{
+    NS_LOG_FUNCTION(this);
+    const uint32_t frame = m_currentSlot.GetFrame();
+
+    if (!m_nextTddPattern.empty() && frame == m_nextTddPatternFrame)
+    {
+        SetTddPattern(m_nextTddPattern);
+        m_nextTddPattern.clear();
+        m_tddPatternTrace(m_currentSlot, GetPattern(), GetBwpId(), GetCellId());
+    }
+
+    m_tddAdaptation->ReportLoad(GetCellId(),
+                                m_phySapUser->GetDlBufferSize(),
+                                m_phySapUser->GetUlBufferSize());
+    if (!m_nextTddPattern.empty())
+    {
+        return; // A switch is already ongoing
+    }
+
+    const auto& pattern = m_tddAdaptation->SelectPattern(frame);
+    if (pattern == m_tddPattern)
+    {
+        return;
+    }
+
+    m_nextTddPatternFrame = frame + NrTddAdaptation::SWITCH_DELAY;
+    NS_LOG_INFO("Frame " << frame << ", the pattern is " << NrPhy::GetPattern(pattern)
+                         << " from frame " << m_nextTddPatternFrame);
+
+    const uint32_t slotsPerFrame =
+        SfnSf::GetSubframesPerFrame() * m_currentSlot.GetSlotPerSubframe();
+    SetTddPattern(NrTddAdaptation::GetTransitionPattern(m_tddPattern,
+                                                        pattern,
+                                                        slotsPerFrame,
+                                                        m_nextTddPatternFrame));
+    m_nextTddPattern = pattern;
+
+    Ptr<NrTddPatternMessage> msg = Create<NrTddPatternMessage>();
+    msg->SetPattern(pattern, m_nextTddPatternFrame);
+    msg->SetSourceBwp(GetBwpId());
+    EnqueueCtrlMsgNow(msg);
+}
+
 void
 NrGnbPhy::ScheduleStartEventLoop(uint32_t nodeId, uint16_t frame, uint8_t subframe, uint16_t slot)
 {
@@ -554,6 +637,33 @@ NrGnbPhy::SetN2Delay(uint32_t delay)
     SetTddPattern(m_tddPattern); // Update the generate/send structures
 }
 
+void
+NrGnbPhy::SetMiniSlotSymbols(uint8_t numSym)
+{
+    NS_ABORT_MSG_UNLESS(numSym == 0 || numSym == 2 || numSym == 4 || numSym == 7,
+                        "A mini-slot has 2, 4 or 7 symbols, not " << +numSym);
+    m_miniSlotSymbols = numSym;
+}
+
+uint8_t
+NrGnbPhy::GetMiniSlotSymbols() const
+{
+    return m_miniSlotSymbols;
+}
+
+void
+NrGnbPhy::SetTddAdaptation(const Ptr<NrTddAdaptation>& tddAdaptation)
+{
+    NS_LOG_FUNCTION(this);
+    m_tddAdaptation = tddAdaptation;
+}
+
+Ptr<NrTddAdaptation>
+NrGnbPhy::GetTddAdaptation() const
+{
+    return m_tddAdaptation;
+}
+
 BeamConfId
 NrGnbPhy::GetBeamConfId(uint16_t rnti) const
 {
@@ -711,6 +821,12 @@ NrGnbPhy::StartSlot(const SfnSf& startSlot)
         m_currSlotAllocInfo = SlotAllocInfo(m_currentSlot);
     }
 
+    if (m_tddAdaptation != nullptr && m_currentSlot.GetSubframe() == 0 &&
+        m_currentSlot.GetSlot() == 0)
+    {
+        AdaptTddPattern();
+    }
+
     if (m_isPrimary)
     {
         if (m_currentSlot.GetSlot() == 0)
@@ -983,6 +1099,8 @@ NrGnbPhy::DoStartSlot()
 
     GenerateAllocationStatistics(m_currSlotAllocInfo);
 
+    m_preemptedDcis.clear();
+
     if (m_currSlotAllocInfo.m_varTtiAllocInfo.size() == 0)
     {
         return;
@@ -996,6 +1114,13 @@ NrGnbPhy::DoStartSlot()
 
     PrepareRbgAllocationMap(m_currSlotAllocInfo.m_varTtiAllocInfo);
 
+    // Scheduled before the allocations, so that a mini-slot is decided before
+    // the start of an allocation in the same symbol
+    if (m_miniSlotSymbols > 0 && m_tddPattern[currentSlotN] != LteNrTddSlotType::UL)
+    {
+        ScheduleMiniSlots();
+    }
+
     FillTheEvent();
 }
 
@@ -1072,7 +1197,163 @@ NrGnbPhy::FillTheEvent()
         NS_LOG_INFO("Scheduled allocation " << *(allocation.m_dci) << " at " << varTtiStart);
     }
 
-    m_currSlotAllocInfo.m_varTtiAllocInfo.clear();
+    // The allocations are kept until the next slot: DlData looks for the
+    // DCIs that share its symbols (MU-MIMO layers)
+}
+
+void
+NrGnbPhy::ScheduleMiniSlots()
+{
+    NS_LOG_FUNCTION(this);
+
+    // The DL part of the slot goes from the end of the DL CTRL to the first UL symbol
+    uint8_t dlStart = 0;
+    uint8_t dlEnd = static_cast<uint8_t>(GetSymbolsPerSlot());
+    for (const auto& allocation : m_currSlotAllocInfo.m_varTtiAllocInfo)
+    {
+        const auto& dci = allocation.m_dci;
+        if (dci->m_format == DciInfoElementTdma::UL)
+        {
+            dlEnd = std::min(dlEnd, dci->m_symStart);
+        }
+        else if (dci->m_type == DciInfoElementTdma::CTRL)
+        {
+            dlStart = std::max<uint8_t>(dlStart, dci->m_symStart + dci->m_numSym);
+        }
+    }
+
+    for (uint8_t sym = dlStart; sym + m_miniSlotSymbols <= dlEnd; sym += m_miniSlotSymbols)
+    {
+        Simulator::Schedule(GetSymbolPeriod() * sym, &NrGnbPhy::StartMiniSlot, this, sym);
+    }
+}
+
+void
+NrGnbPhy::StartMiniSlot(uint8_t symStart)
+{
+    NS_LOG_FUNCTION(this << +symStart);
+
+    const uint8_t symEnd = symStart + m_miniSlotSymbols;
+    std::set<std::shared_ptr<DciInfoElementTdma>> overlapping;
+    for (const auto& allocation : m_currSlotAllocInfo.m_varTtiAllocInfo)
+    {
+        const auto& dci = allocation.m_dci;
+        if (dci->m_format != DciInfoElementTdma::DL || dci->m_type != DciInfoElementTdma::DATA)
+        {
+            continue;
+        }
+        if (dci->m_symStart < symStart && dci->m_symStart + dci->m_numSym > symStart)
+        {
+            NS_LOG_INFO("No mini-slot at symbol " << +symStart << ", DL data on the air");
+            return;
+        }
+        if (dci->m_symStart >= symStart && dci->m_symStart < symEnd)
+        {
+            overlapping.insert(dci);
+        }
+    }
+
+    // The PDUs of the mini-slot may go in the symbol of an overlapping
+    // allocation: its bursts are set aside, and restored if the MAC does not
+    // use the mini-slot
+    std::unordered_map<uint64_t, Ptr<PacketBurst>> overlappingBursts;
+    for (const auto& dci : overlapping)
+    {
+        for (std::size_t stream = 0; stream < m_spectrumPhys.size(); ++stream)
+        {
+            auto it = m_packetBurstMap.find(
+                m_currentSlot.GetEncForStreamWithSymStart(static_cast<uint8_t>(stream),
+                                                          dci->m_symStart));
+            if (it != m_packetBurstMap.end())
+            {
+                overlappingBursts.insert(*it);
+                m_packetBurstMap.erase(it);
+            }
+        }
+    }
+
+    m_phySapUser->MiniSlotDlIndication(m_currentSlot, symStart, m_miniSlotSymbols);
+
+    if (!SlotAllocInfoExists(m_currentSlot))
+    {
+        NS_LOG_INFO("Mini-slot at symbol " << +symStart << " not used");
+        m_packetBurstMap.insert(overlappingBursts.begin(), overlappingBursts.end());
+        return;
+    }
+
+    SlotAllocInfo miniSlot = RetrieveSlotAllocInfo(m_currentSlot);
+    NS_ASSERT(!miniSlot.m_varTtiAllocInfo.empty());
+
+    for (const auto& dci : overlapping)
+    {
+        NS_LOG_INFO("Allocation " << *dci << " preempted by the mini-slot at symbol "
+                                  << +symStart);
+        m_preemptedDcis.insert(dci);
+        m_rbgAllocationPerSym.erase(dci->m_symStart);
+        m_dlPreemptionTrace(m_currentSlot,
+                            dci->m_rnti,
+                            dci->m_symStart,
+                            dci->m_numSym,
+                            std::accumulate(dci->m_tbSize.begin(), dci->m_tbSize.end(), 0U),
+                            GetBwpId(),
+                            GetCellId());
+    }
+
+    auto& allocations = m_currSlotAllocInfo.m_varTtiAllocInfo;
+    allocations.erase(std::remove_if(allocations.begin(),
+                                     allocations.end(),
+                                     [&overlapping](const VarTtiAllocInfo& allocation) {
+                                         return overlapping.count(allocation.m_dci) > 0;
+                                     }),
+                      allocations.end());
+
+    for (const auto& allocation : miniSlot.m_varTtiAllocInfo)
+    {
+        const auto& dci = allocation.m_dci;
+        NS_ASSERT(dci->m_miniSlot && dci->m_format == DciInfoElementTdma::DL);
+        NS_ASSERT(dci->m_symStart > symStart && dci->m_symStart + dci->m_numSym <= symEnd);
+        StoreRBGAllocation(&m_rbgAllocationPerSym, dci);
+        allocations.push_back(allocation);
+        m_dlMiniSlotTrace(m_currentSlot,
+                          dci->m_rnti,
+                          dci->m_symStart,
+                          dci->m_numSym,
+                          std::accumulate(dci->m_tbSize.begin(), dci->m_tbSize.end(), 0U),
+                          GetBwpId(),
+                          GetCellId());
+    }
+    std::sort(allocations.begin(), allocations.end());
+
+    // The first symbol of the mini-slot carries the DCI and, if some
+    // allocations were preempted, the (group-common) preemption indication
+    NS_ASSERT(m_ctrlMsgs.empty());
+    uint64_t currentSlotN = m_currentSlot.Normalize() % m_tddPattern.size();
+    m_ctrlMsgs = RetrieveDciFromAllocation(miniSlot,
+                                           DciInfoElementTdma::DL,
+                                           0,
+                                           m_dlHarqfbPosition[currentSlotN]);
+    if (!overlapping.empty())
+    {
+        Ptr<NrDlPreemptionMessage> preemption = Create<NrDlPreemptionMessage>();
+        preemption->SetSourceBwp(GetBwpId());
+        preemption->SetPreemptedSymbols(symStart, m_miniSlotSymbols);
+        m_ctrlMsgs.push_back(preemption);
+    }
+    for (const auto& msg : m_ctrlMsgs)
+    {
+        m_phyTxedCtrlMsgsTrace(m_currentSlot, GetCellId(), 0, GetBwpId(), msg);
+    }
+
+    ChangeToQuasiOmniBeamformingVector();
+    m_currSymStart = symStart;
+    SendCtrlChannels(GetSymbolPeriod() - NanoSeconds(1.0));
+
+    // OFDMA DL trick: StartVarTti takes all the DCIs of the same symbols
+    const auto& firstDci = miniSlot.m_varTtiAllocInfo.front().m_dci;
+    Simulator::Schedule(GetSymbolPeriod() * (firstDci->m_symStart - symStart),
+                        &NrGnbPhy::StartVarTti,
+                        this,
+                        firstDci);
 }
 
 void
@@ -1111,6 +1392,11 @@ NrGnbPhy::RetrieveDciFromAllocation(const SlotAllocInfo& alloc,
         if (dlAlloc.m_dci->m_type != DciInfoElementTdma::CTRL && dlAlloc.m_dci->m_format == format)
         {
             auto& dciElem = dlAlloc.m_dci;
+            if (dciElem->m_cgOccasion)
+            {
+                NS_LOG_INFO("No DCI to " << dciElem->m_rnti << " for its configured grant");
+                continue;
+            }
             NS_ASSERT(dciElem->m_format == format);
             NS_ASSERT_MSG(dciElem->m_symStart + dciElem->m_numSym <= GetSymbolsPerSlot(),
                           "symStart: " << static_cast<uint32_t>(dciElem->m_symStart)
@@ -1284,6 +1570,19 @@ NrGnbPhy::DlData(const std::shared_ptr<DciInfoElementTdma>& dci)
 
     Time varTtiPeriod = GetSymbolPeriod() * dci->m_numSym;
 
+    // The DCIs of the same symbols are more than a layer if the scheduler
+    // co-scheduled the UEs of different beams (MU-MIMO)
+    DlLayers layers;
+    for (const auto& allocation : m_currSlotAllocInfo.m_varTtiAllocInfo)
+    {
+        if (allocation.m_dci->m_type == DciInfoElementTdma::DATA &&
+            allocation.m_dci->m_format == DciInfoElementTdma::DL &&
+            allocation.m_dci->m_symStart == dci->m_symStart)
+        {
+            layers[allocation.m_dci->m_layer].push_back(allocation.m_dci);
+        }
+    }
+
     uint8_t streams = static_cast<uint8_t>(m_spectrumPhys.size());
     for (uint8_t streamIndex = 0; streamIndex < streams; streamIndex++)
     {
@@ -1302,6 +1601,18 @@ NrGnbPhy::DlData(const std::shared_ptr<DciInfoElementTdma>& dci)
                     << Simulator::Now() + NanoSeconds(1) << " end "
                     << Simulator::Now() + varTtiPeriod - NanoSeconds(2.0));
 
+        if (layers.size() > 1)
+        {
+            Simulator::Schedule(NanoSeconds(1.0),
+                                &NrGnbPhy::SendMuMimoDataChannels,
+                                this,
+                                pktBurst,
+                                varTtiPeriod - NanoSeconds(2.0),
+                                layers,
+                                streamIndex);
+            continue;
+        }
+
         Simulator::Schedule(NanoSeconds(1.0),
                             &NrGnbPhy::SendDataChannels,
                             this,
@@ -1354,7 +1665,7 @@ NrGnbPhy::UlData(const std::shared_ptr<DciInfoElementTdma>& dci)
             // Even if we change the beamforming vector, we hope that the scheduler
             // has scheduled UEs within the same beam (and, therefore, have the same
             // beamforming vector)
-            ChangeBeamformingVector(m_deviceMap.at(i)); // assume the control signal is omni
+            ChangeBeamformingVector(static_cast<uint32_t>(i)); // assume the control signal is omni
             found = true;
             break;
         }
@@ -1377,6 +1688,15 @@ NrGnbPhy::ChangeBeamformingVector(Ptr<NetDevice> dev)
     }
 }
 
+void
+NrGnbPhy::ChangeBeamformingVector(uint32_t deviceIndex)
+{
+    for (std::size_t streamIndex = 0; streamIndex < m_spectrumPhys.size(); streamIndex++)
+    {
+        m_spectrumPhys.at(streamIndex)->GetBeamManager()->ChangeBeamformingVector(deviceIndex);
+    }
+}
+
 void
 NrGnbPhy::ChangeToQuasiOmniBeamformingVector()
 {
@@ -1419,7 +1739,7 @@ NrGnbPhy::UlSrs(const std::shared_ptr<DciInfoElementTdma>& dci)
             // Even if we change the beamforming vector, we hope that the scheduler
             // has scheduled UEs within the same beam (and, therefore, have the same
             // beamforming vector)
-            ChangeBeamformingVector(m_deviceMap.at(i)); // assume the control signal is omni
+            ChangeBeamformingVector(static_cast<uint32_t>(i)); // assume the control signal is omni
             found = true;
             break;
         }
@@ -1433,6 +1753,7 @@ NrGnbPhy::UlSrs(const std::shared_ptr<DciInfoElementTdma>& dci)
     {
         NS_LOG_WARN("The UE for which is scheduled this SRS does not have yet initialized RNTI. "
                     "RAR message was not received yet.");
+        ChangeToQuasiOmniBeamformingVector();
     }
 
     NS_LOG_INFO("GNB RXing UL SRS frame "
@@ -1446,13 +1767,23 @@ void
 NrGnbPhy::StartVarTti(const std::shared_ptr<DciInfoElementTdma>& dci)
 {
     NS_LOG_FUNCTION(this);
-    ChangeToQuasiOmniBeamformingVector(); // assume the control signal is omni
+
+    if (m_preemptedDcis.count(dci) > 0)
+    {
+        NS_LOG_INFO("Allocation " << *dci << " preempted, nothing to do");
+        return;
+    }
+
     m_currSymStart = dci->m_symStart;
 
     Time varTtiPeriod;
 
     if (dci->m_type == DciInfoElementTdma::CTRL)
     {
+        // The data and SRS var-TTIs set the beam of their UE: switching to
+        // quasi-omni also before them would rewrite the antenna weights at
+        // every var-TTI of the same UE
+        ChangeToQuasiOmniBeamformingVector(); // assume the control signal is omni
         if (dci->m_format == DciInfoElementTdma::DL)
         {
             varTtiPeriod = DlCtrl(dci);
@@ -1497,7 +1828,7 @@ NrGnbPhy::EndSlot()
 {
     NS_LOG_FUNCTION(this);
 
-    Time slotStart = m_lastSlotStart + GetSlotPeriod() - Simulator::Now();
+    Time slotStart = GetTimeToNextSlot();
 
     if (m_channelStatus == TO_LOSE)
     {
@@ -1527,7 +1858,7 @@ NrGnbPhy::SendDataChannels(const Ptr<PacketBurst>& pb,
         // NS_LOG_INFO ("Scheduled rnti:"<<rnti <<" ue rnti:"<< ueRnti);
         if (dci->m_rnti == ueRnti)
         {
-            ChangeBeamformingVector(m_deviceMap.at(i));
+            ChangeBeamformingVector(static_cast<uint32_t>(i));
             found = true;
             break;
         }
@@ -1555,6 +1886,73 @@ NrGnbPhy::SendDataChannels(const Ptr<PacketBurst>& pb,
     m_spectrumPhys.at(streamId)->StartTxDataFrames(pb, ctrlMsgs, varTtiPeriod);
 }
 
+void
+NrGnbPhy::SendMuMimoDataChannels(const Ptr<PacketBurst>& pb,
+                                 const Time& varTtiPeriod,
+                                 const DlLayers& layers,
+                                 uint8_t streamId)
+{
+    NS_LOG_FUNCTION(this);
+
+    for (const auto& layer : layers)
+    {
+        std::unordered_set<uint16_t> rntis;
+        std::vector<uint8_t> rbgBitmask;
+        uint8_t activeStreams = 0;
+        for (const auto& dci : layer.second)
+        {
+            rntis.insert(dci->m_rnti);
+            rbgBitmask.resize(std::max(rbgBitmask.size(), dci->m_rbgBitmask.size()), 0);
+            for (std::size_t rbg = 0; rbg < dci->m_rbgBitmask.size(); ++rbg)
+            {
+                rbgBitmask.at(rbg) |= dci->m_rbgBitmask.at(rbg);
+            }
+            activeStreams = std::max(
+                activeStreams,
+                static_cast<uint8_t>(
+                    std::count_if(dci->m_tbSize.begin(), dci->m_tbSize.end(), [](uint32_t tbs) {
+                        return tbs > 0;
+                    })));
+        }
+
+        Ptr<PacketBurst> layerBurst = CreateObject<PacketBurst>();
+        for (const auto& packet : pb->GetPackets())
+        {
+            LteRadioBearerTag bearerTag;
+            if (packet->PeekPacketTag(bearerTag) && rntis.count(bearerTag.GetRnti()) > 0)
+            {
+                layerBurst->AddPacket(packet);
+            }
+        }
+        if (layerBurst->GetNPackets() == 0 || activeStreams == 0)
+        {
+            continue;
+        }
+
+        bool found = false;
+        for (std::size_t i = 0; i < m_deviceMap.size() && !found; i++)
+        {
+            Ptr<NrUeNetDevice> ueDev = DynamicCast<NrUeNetDevice>(m_deviceMap.at(i));
+            uint64_t ueRnti = (DynamicCast<NrUePhy>(ueDev->GetPhy(GetBwpId())))->GetRnti();
+            if (layer.second.front()->m_rnti == ueRnti)
+            {
+                ChangeBeamformingVector(static_cast<uint32_t>(i));
+                found = true;
+            }
+        }
+        NS_ABORT_IF(!found);
+
+        // The power is shared among the layers, as among the streams
+        NS_LOG_INFO("MU-MIMO layer " << +layer.first << " of " << layers.size() << " for "
+                                     << rntis.size() << " UEs");
+        SetSubChannels(FromRBGBitmaskToRBAssignment(rbgBitmask),
+                       static_cast<uint8_t>(activeStreams * layers.size()));
+
+        std::list<Ptr<NrControlMessage>> ctrlMsgs;
+        m_spectrumPhys.at(streamId)->StartTxDataFrames(layerBurst, ctrlMsgs, varTtiPeriod, true);
+    }
+}
+
 void
 NrGnbPhy::SendCtrlChannels(const Time& varTtiPeriod)
 {
@@ -1586,6 +1984,14 @@ NrGnbPhy::RegisterUe(uint64_t imsi, const Ptr<NrUeNetDevice>& ueDevice)
     {
         m_ueAttached.insert(imsi);
         m_deviceMap.push_back(ueDevice);
+        // The position in m_deviceMap is the dense index used by the beam managers
+        for (const auto& spectrumPhy : m_spectrumPhys)
+        {
+            if (spectrumPhy->GetBeamManager() != nullptr)
+            {
+                spectrumPhy->GetBeamManager()->SetDeviceIndex(ueDevice, m_deviceMap.size() - 1);
+            }
+        }
         return (true);
     }
     else
@@ -1842,7 +2248,7 @@ NrGnbPhy::ChannelAccessGranted(const Time& time)
 
     m_channelStatus = GRANTED;
 
-    Time toNextSlot = m_lastSlotStart + GetSlotPeriod() - Simulator::Now();
+    Time toNextSlot = GetTimeToNextSlot();
     Time grant = time - toNextSlot;
     int64_t slotGranted = grant.GetNanoSeconds() / GetSlotPeriod().GetNanoSeconds();
 
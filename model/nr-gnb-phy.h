@@ -17,6 +17,7 @@
 #include <ns3/nr-harq-phy.h>
 
 #include <functional>
+#include <map>
 
 namespace ns3
 {
@@ -28,6 +29,7 @@ class NrUePhy;
 class NrGnbMac;
 class NrChAccessManager;
 class BeamManager;
+class NrTddAdaptation;
 
 /**
  *
@@ -176,6 +178,48 @@ class NrGnbPhy : public NrPhy
      */
     uint32_t GetN2Delay() const;
 
+    /**
+     * \brief Set the number of symbols of the DL mini-slots
+     * \param numSym 2, 4 or 7 symbols, or 0 to disable the mini-slots
+     *
+     * The DL part of each DL or F slot, after the DL CTRL, is divided in
+     * mini-slots of numSym symbols. At the start of each mini-slot, the MAC
+     * can schedule, for the current slot, the delay-critical data that arrived
+     * after the slot was scheduled: the first symbol carries the DCI, and the
+     * data takes the other symbols, preempting the DL data allocations that
+     * start in the mini-slot. The affected UEs are informed by a preemption
+     * indication. A mini-slot is skipped when a DL transmission is ongoing at
+     * its start, because a signal on the air cannot be interrupted.
+     */
+    void SetMiniSlotSymbols(uint8_t numSym);
+
+    /**
+     * \brief Get the number of symbols of the DL mini-slots
+     * \return the number of symbols, 0 if the mini-slots are disabled
+     */
+    uint8_t GetMiniSlotSymbols() const;
+
+    /**
+     * \brief Set the entity that selects the TDD pattern from the load
+     * \param tddAdaptation the TDD adaptation entity, or nullptr to keep the pattern
+     *
+     * At the start of each frame, the PHY reports the DL and UL buffer sizes
+     * known by the scheduler to the entity, and asks it for a pattern. If the
+     * pattern changes, it is announced to the UEs in the current frame, and
+     * used two frames later (NrTddAdaptation::SWITCH_DELAY). The pattern sizes
+     * must divide the number of slots in a frame.
+     *
+     * The same entity can be installed in neighbouring gNBs, to make them
+     * switch together (see NrTddAdaptation).
+     */
+    void SetTddAdaptation(const Ptr<NrTddAdaptation>& tddAdaptation);
+
+    /**
+     * \brief Get the entity that selects the TDD pattern from the load
+     * \return the TDD adaptation entity, or nullptr
+     */
+    Ptr<NrTddAdaptation> GetTddAdaptation() const;
+
     /**
      * \brief Get the BeamConfId for the selected user
      * \param rnti the selected UE
@@ -392,6 +436,39 @@ class NrGnbPhy : public NrPhy
                                           uint16_t bwpId,
                                           uint16_t cellId);
 
+    /**
+     * \brief TracedCallback signature for the DL allocations of the mini-slots
+     * and for the DL allocations that they preempt
+     *
+     * \param [in] sfnSf Slot number
+     * \param [in] rnti RNTI of the UE
+     * \param [in] symStart First symbol of the allocation
+     * \param [in] numSym Number of symbols of the allocation
+     * \param [in] tbSize TB size of the allocation, summed over the streams
+     * \param [in] bwpId BWP ID
+     * \param [in] cellId Cell ID
+     */
+    typedef void (*DlMiniSlotTracedCallback)(const SfnSf& sfnSf,
+                                             uint16_t rnti,
+                                             uint8_t symStart,
+                                             uint8_t numSym,
+                                             uint32_t tbSize,
+                                             uint16_t bwpId,
+                                             uint16_t cellId);
+
+    /**
+     * \brief TracedCallback signature for the switches of the TDD pattern
+     *
+     * \param [in] sfnSf First slot with the new pattern
+     * \param [in] pattern The new pattern
+     * \param [in] bwpId BWP ID
+     * \param [in] cellId Cell ID
+     */
+    typedef void (*TddPatternTracedCallback)(const SfnSf& sfnSf,
+                                             const std::string& pattern,
+                                             uint16_t bwpId,
+                                             uint16_t cellId);
+
     /**
      * \brief Retrieve the number of RB per RBG
      * \return the number of RB per RBG
@@ -402,6 +479,12 @@ class NrGnbPhy : public NrPhy
 
     const SfnSf& GetCurrentSfnSf() const override;
 
+    /**
+     * \brief Get the time left until the start of the next slot
+     * \return the time until the next slot begins
+     */
+    Time GetTimeToNextSlot() const;
+
     /**
      * TODO change to private and add documentation
      */
@@ -422,10 +505,24 @@ class NrGnbPhy : public NrPhy
      * \brief Set the current slot pattern (better to call it only once..)
      * \param pattern the pattern
      *
-     * It does not support dynamic change of pattern during the simulation
+     * It does not support dynamic change of pattern during the simulation:
+     * the changes at run time are done by AdaptTddPattern()
      */
     void SetTddPattern(const std::vector<LteNrTddSlotType>& pattern);
 
+    /**
+     * \brief At the start of a frame, switch to the pattern announced two
+     * frames before, or ask the TDD adaptation entity for the pattern to use
+     *
+     * When the pattern changes, the change is announced to the UEs, and takes
+     * place NrTddAdaptation::SWITCH_DELAY frames later. Until then, the slots
+     * are scheduled with a transition pattern
+     * (NrTddAdaptation::GetTransitionPattern), so that the slots after the
+     * switch are indicated to the MAC, and their HARQ feedback is placed,
+     * with the new pattern.
+     */
+    void AdaptTddPattern();
+
     /**
      * \brief Start the slot processing.
      * \param startSlot slot number
@@ -493,6 +590,29 @@ class NrGnbPhy : public NrPhy
                           const std::shared_ptr<DciInfoElementTdma>& dci,
                           const uint8_t& streamId);
 
+    /**
+     * \brief DL DCIs of a MU-MIMO transmission, by layer (DciInfoElementTdma::m_layer)
+     */
+    using DlLayers = std::map<uint8_t, std::vector<std::shared_ptr<DciInfoElementTdma>>>;
+
+    /**
+     * \brief Transmit to the spectrum phy the layers of a MU-MIMO transmission
+     *
+     * \param pb Data to transmit, for the UEs of all the layers
+     * \param varTtiPeriod period of transmission
+     * \param layers the DCIs of each layer
+     * \param streamId The id of the stream, which identifies the instance of the
+     *        NrSpecturmPhy to be used to transmit the packet burst
+     *
+     * Each layer is transmitted at the same time, with the beam of its UEs,
+     * on the RBG of their DCIs, and with a share of the power: the UEs of the
+     * other layers receive it as interference.
+     */
+    void SendMuMimoDataChannels(const Ptr<PacketBurst>& pb,
+                                const Time& varTtiPeriod,
+                                const DlLayers& layers,
+                                uint8_t streamId);
+
     /**
      * \brief Transmit the control channel
      *
@@ -717,6 +837,19 @@ class NrGnbPhy : public NrPhy
      */
     void FillTheEvent();
 
+    /**
+     * \brief Schedule a call to StartMiniSlot at the start of each mini-slot
+     * of the DL part of the current slot
+     */
+    void ScheduleMiniSlots();
+
+    /**
+     * \brief Offer a mini-slot to the MAC and, if the MAC uses it, preempt the
+     * overlapping DL data allocations and transmit the DCI of the mini-slot
+     * \param symStart first symbol of the mini-slot
+     */
+    void StartMiniSlot(uint8_t symStart);
+
   private:
     NrGnbPhySapUser* m_phySapUser{nullptr}; //!< MAC SAP user pointer, MAC is user of services of
                                             //!< PHY, implements e.g. ReceiveRachPreamble
@@ -786,6 +919,21 @@ class NrGnbPhy : public NrPhy
     TracedCallback<const SfnSf&, uint8_t, const std::vector<int>&, uint16_t, uint16_t>
         m_rbStatistics;
 
+    uint8_t m_miniSlotSymbols{0}; //!< Symbols of a DL mini-slot, 0 if disabled (attribute)
+    std::set<std::shared_ptr<DciInfoElementTdma>>
+        m_preemptedDcis; //!< DL allocations of the current slot preempted by a mini-slot
+
+    TracedCallback<const SfnSf&, uint16_t, uint8_t, uint8_t, uint32_t, uint16_t, uint16_t>
+        m_dlMiniSlotTrace; //!< DL allocations of the mini-slots
+    TracedCallback<const SfnSf&, uint16_t, uint8_t, uint8_t, uint32_t, uint16_t, uint16_t>
+        m_dlPreemptionTrace; //!< DL allocations preempted by a mini-slot
+
+    Ptr<NrTddAdaptation> m_tddAdaptation;          //!< Selection of the TDD pattern, if any
+    std::vector<LteNrTddSlotType> m_nextTddPattern; //!< Pattern announced to the UEs, if any
+    uint32_t m_nextTddPatternFrame{0};              //!< Frame of the switch to m_nextTddPattern
+    TracedCallback<const SfnSf&, const std::string&, uint16_t, uint16_t>
+        m_tddPatternTrace; //!< Switches of the TDD pattern
+
     std::map<uint32_t, std::vector<uint32_t>>
         m_toSendDl; //!< Map that indicates, for each slot, what DL DCI we have to send
     std::map<uint32_t, std::vector<uint32_t>>
@@ -815,6 +963,7 @@ class NrGnbPhy : public NrPhy
     Ptr<NrChAccessManager> m_cam; //!< Channel Access Manager
 
     friend class LtePatternTestCase;
+    friend class TestTddAdaptationTransition;
 
     uint32_t m_n0Delay{0}; //!< minimum processing delay (in slots) needed to decode DL DCI and
                            //!< decode DL data (UE side)
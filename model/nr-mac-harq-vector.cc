@@ -6,6 +6,8 @@
 
 #include "nr-mac-harq-vector.h"
 
+#include <bitset>
+
 namespace ns3
 {
 
@@ -14,23 +16,28 @@ NrMacHarqVector::Erase(uint8_t id)
 {
     at(id).Erase();
     --m_usedSize;
+    if (m_reserved.at(id))
+    {
+        ++m_reservedIdle;
+    }
+    else
+    {
+        SetFree(id, true);
+    }
 
-    uint32_t count = 0;
-    for (const auto& v : *this)
+    uint32_t numFree = 0;
+    for (const auto& word : m_freeMask)
     {
-        if (v.second.m_active)
-        {
-            ++count;
-        }
+        numFree += static_cast<uint32_t>(std::bitset<64>(word).count());
     }
-    NS_ASSERT(count == m_usedSize);
+    NS_ASSERT(numFree + m_usedSize + m_reservedIdle == m_maxSize);
     return true;
 }
 
 bool
 NrMacHarqVector::Insert(uint8_t* id, const HarqProcess& element)
 {
-    if (m_usedSize >= m_maxSize)
+    if (m_usedSize + m_reservedIdle >= m_maxSize)
     {
         return false;
     }
@@ -45,6 +52,7 @@ NrMacHarqVector::Insert(uint8_t* id, const HarqProcess& element)
 
     NS_ABORT_IF(at(*id).m_active == true);
     at(*id) = element;
+    SetFree(*id, false);
 
     NS_ABORT_IF(at(*id).m_active == false);
     NS_ABORT_IF(this->FirstAvailableId() == *id);
@@ -53,6 +61,47 @@ NrMacHarqVector::Insert(uint8_t* id, const HarqProcess& element)
     return true;
 }
 
+uint8_t
+NrMacHarqVector::Reserve()
+{
+    uint8_t id = FirstAvailableId();
+    if (id == 255)
+    {
+        return id;
+    }
+
+    m_reserved.at(id) = true;
+    SetFree(id, false);
+    ++m_reservedIdle;
+    return id;
+}
+
+void
+NrMacHarqVector::Release(uint8_t id)
+{
+    NS_ABORT_IF(!m_reserved.at(id));
+    m_reserved.at(id) = false;
+    if (!at(id).m_active)
+    {
+        --m_reservedIdle;
+        SetFree(id, true);
+    }
+}
+
+void
+NrMacHarqVector::InsertReserved(uint8_t id, const HarqProcess& element)
+{
+    NS_ABORT_IF(!m_reserved.at(id));
+    NS_ABORT_IF(element.m_active == false);
+
+    if (!at(id).m_active)
+    {
+        --m_reservedIdle;
+        ++m_usedSize;
+    }
+    at(id) = element;
+}
+
 std::ostream&
 operator<<(std::ostream& os, const NrMacHarqVector& item)
 {
@@ -9,6 +9,7 @@
 #include "nr-mac-harq-process.h"
 
 #include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -26,6 +27,15 @@ namespace ns3
  * The class does not support going "out of space", or in other words, if all
  * the spots are filled with active processes, the next insert will fail.
  *
+ * The inactive processes are tracked in a bitmap, so that finding a free ID
+ * does not require to visit the processes. The bits follow the order in which
+ * the map is traversed, which is the order in which the IDs were searched
+ * before the introduction of the bitmap, so the selected ID does not change.
+ *
+ * A process can be reserved for a configured grant (Reserve()): it is used only
+ * through InsertReserved(), and it is never returned by FirstAvailableId(), even
+ * when it is inactive, until it is released (Release()).
+ *
  * \see HarqProcess
  */
 class NrMacHarqVector : private std::unordered_map<uint8_t, HarqProcess>
@@ -60,6 +70,19 @@ class NrMacHarqVector : private std::unordered_map<uint8_t, HarqProcess>
         {
             emplace(i, HarqProcess());
         }
+
+        // The map will not be rehashed anymore: fix the search order
+        m_searchOrder.clear();
+        m_searchPos.assign(size, 0);
+        m_freeMask.assign((size + 63) / 64, 0);
+        m_reserved.assign(size, false);
+        m_reservedIdle = 0;
+        for (const auto& it : *this)
+        {
+            m_searchPos.at(it.first) = static_cast<uint8_t>(m_searchOrder.size());
+            SetFree(it.first, !it.second.m_active);
+            m_searchOrder.push_back(it.first);
+        }
     }
 
     /**
@@ -77,6 +100,38 @@ class NrMacHarqVector : private std::unordered_map<uint8_t, HarqProcess>
      */
     bool Insert(uint8_t* id, const HarqProcess& element);
 
+    /**
+     * \brief Reserve the first available process for a configured grant
+     * \return the ID of the reserved process, or 255 in case no ID are available
+     */
+    uint8_t Reserve();
+
+    /**
+     * \brief Release a reserved process, which becomes available for Insert
+     * \param id ID of the reserved process
+     */
+    void Release(uint8_t id);
+
+    /**
+     * \brief Store a process in a reserved ID
+     * \param id ID of the reserved process
+     * \param element process to store
+     *
+     * If the process with the same ID is active, it is overwritten: a new
+     * occasion of a configured grant flushes the previous transmission.
+     */
+    void InsertReserved(uint8_t id, const HarqProcess& element);
+
+    /**
+     * \brief Check if an ID is reserved for a configured grant
+     * \param id ID to check
+     * \return true if the ID is reserved
+     */
+    bool IsReserved(uint8_t id) const
+    {
+        return m_reserved.at(id);
+    }
+
     /**
      * \brief Find a process
      * \param key ID of the process to find
@@ -163,11 +218,11 @@ class NrMacHarqVector : private std::unordered_map<uint8_t, HarqProcess>
      */
     uint8_t FirstAvailableId() const
     {
-        for (const auto& it : *this)
+        for (std::size_t word = 0; word < m_freeMask.size(); ++word)
         {
-            if (!it.second.m_active)
+            if (m_freeMask[word] != 0)
             {
-                return it.first;
+                return m_searchOrder.at(word * 64 + LowestSetBit(m_freeMask[word]));
             }
         }
         return 255;
@@ -179,7 +234,7 @@ class NrMacHarqVector : private std::unordered_map<uint8_t, HarqProcess>
      */
     bool CanInsert() const
     {
-        return Size() < m_maxSize;
+        return Size() + m_reservedIdle < m_maxSize;
     }
 
     /**
@@ -192,8 +247,52 @@ class NrMacHarqVector : private std::unordered_map<uint8_t, HarqProcess>
     }
 
   private:
-    uint8_t m_maxSize{0};  //!< Maximum size (or the number of processes stored)
-    uint8_t m_usedSize{0}; //!< Number of ACTIVE processes
+    /**
+     * \brief Mark a process as free or used in the bitmap
+     * \param id ID of the process
+     * \param isFree true if the process is inactive
+     */
+    void SetFree(uint8_t id, bool isFree)
+    {
+        uint8_t pos = m_searchPos.at(id);
+        uint64_t bit = uint64_t(1) << (pos % 64);
+        if (isFree)
+        {
+            m_freeMask.at(pos / 64) |= bit;
+        }
+        else
+        {
+            m_freeMask.at(pos / 64) &= ~bit;
+        }
+    }
+
+    /**
+     * \brief Get the index of the lowest bit set
+     * \param word a word with at least one bit set
+     * \return the index of the lowest bit set in word
+     */
+    static uint8_t LowestSetBit(uint64_t word)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<uint8_t>(__builtin_ctzll(word));
+#else
+        uint8_t bit = 0;
+        while ((word & 1) == 0)
+        {
+            word >>= 1;
+            ++bit;
+        }
+        return bit;
+#endif
+    }
+
+    uint8_t m_maxSize{0};               //!< Maximum size (or the number of processes stored)
+    uint8_t m_usedSize{0};              //!< Number of ACTIVE processes
+    std::vector<uint8_t> m_searchOrder; //!< IDs in the order in which they are searched
+    std::vector<uint8_t> m_searchPos;   //!< Position of each ID in m_searchOrder
+    std::vector<uint64_t> m_freeMask;   //!< Bit i is set if m_searchOrder[i] is inactive
+    std::vector<bool> m_reserved;       //!< Reserved IDs, for the configured grants
+    uint8_t m_reservedIdle{0};          //!< Number of reserved IDs with an INACTIVE process
 };
 
 /**
@@ -127,6 +127,16 @@ class NrMacSchedSapProvider
             m_vendorSpecificList; ///< vendor specific list
     };
 
+    /**
+     * \brief DL mini-slot opportunity inside the current slot
+     */
+    struct SchedDlMiniSlotReqParameters
+    {
+        SfnSf m_snfSf;         //!< SfnSf of the current slot
+        uint8_t m_symStart{0}; //!< First symbol of the mini-slot (PDCCH)
+        uint8_t m_numSym{0};   //!< Number of symbols of the mini-slot
+    };
+
     virtual void SchedDlRlcBufferReq(const struct SchedDlRlcBufferReqParameters& params) = 0;
 
     virtual void SchedDlCqiInfoReq(const SchedDlCqiInfoReqParameters& params) = 0;
@@ -162,6 +172,16 @@ class NrMacSchedSapProvider
      */
     virtual void SchedDlRachInfoReq(const SchedDlRachInfoReqParameters& params) = 0;
 
+    /**
+     * \brief Offer a DL mini-slot of the current slot to the scheduler
+     *
+     * If the scheduler uses the mini-slot, it answers immediately with a
+     * SchedConfigInd for the current slot.
+     *
+     * \param params the mini-slot opportunity
+     */
+    virtual void SchedDlMiniSlotReq(const SchedDlMiniSlotReqParameters& params) = 0;
+
     /**
      * \brief Retrieve the number of DL ctrl symbols configured in the scheduler
      * \return the number of DL ctrl symbols
@@ -174,6 +194,18 @@ class NrMacSchedSapProvider
      */
     virtual uint8_t GetUlCtrlSyms() const = 0;
 
+    /**
+     * \brief Retrieve the bytes waiting in the DL RLC buffers of the UEs
+     * \return the bytes of the DL buffers known by the scheduler
+     */
+    virtual uint64_t GetDlBufferSize() const = 0;
+
+    /**
+     * \brief Retrieve the bytes waiting in the UL buffers of the UEs
+     * \return the bytes of the UL buffers reported by the BSR and not yet scheduled
+     */
+    virtual uint64_t GetUlBufferSize() const = 0;
+
   private:
 };
 
@@ -212,8 +244,11 @@ class NrMacSchedSapUser
     /**
      * \brief Install a scheduling decision
      * \param params the scheduling decision
+     *
+     * The decision is passed by value: the scheduler moves it, so the
+     * allocations are handed over without being copied.
      */
-    virtual void SchedConfigInd(const struct SchedConfigIndParameters& params) = 0;
+    virtual void SchedConfigInd(struct SchedConfigIndParameters params) = 0;
 
     /**
      * \brief Get the SpectrumModel
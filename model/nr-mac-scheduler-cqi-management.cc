@@ -22,12 +22,43 @@ namespace ns3
 NS_LOG_COMPONENT_DEFINE("NrMacSchedulerCQIManagement");
 
 void
-NrMacSchedulerCQIManagement::DlSBCQIReported(
-    [[maybe_unused]] const DlCqiInfo& info,
-    [[maybe_unused]] const std::shared_ptr<NrMacSchedulerUeInfo>& ueInfo) const
+NrMacSchedulerCQIManagement::DlSBCQIReported(const DlCqiInfo& info,
+                                             const std::shared_ptr<NrMacSchedulerUeInfo>& ueInfo,
+                                             uint32_t expirationTime,
+                                             int8_t maxDlMcs,
+                                             uint32_t numRbPerRbg,
+                                             uint32_t numRbg)
 {
     NS_LOG_INFO(this);
-    // TODO
+    NS_ABORT_MSG_IF(info.m_sbSize == 0, "SB CQI without the size of the subbands");
+
+    // The WB CQI, reported along with the SB one, updates the RI, the MCS
+    // of each stream, and the validity of the values
+    DlWBCQIReported(info, ueInfo, expirationTime, maxDlMcs);
+    ueInfo->m_dlCqi.m_cqiType = NrMacSchedulerUeInfo::DlCqiInfo::SB;
+
+    ueInfo->m_dlRbgMcs.resize(info.m_sbCqi.size());
+    for (std::size_t stream = 0; stream < info.m_sbCqi.size(); ++stream)
+    {
+        const std::vector<uint8_t>& sbCqi = info.m_sbCqi.at(stream);
+        NS_ABORT_MSG_IF(sbCqi.empty(), "SB CQI without subbands for stream " << stream);
+        std::vector<uint8_t>& rbgMcs = ueInfo->m_dlRbgMcs.at(stream);
+        rbgMcs.resize(numRbg);
+        for (uint32_t rbg = 0; rbg < numRbg; ++rbg)
+        {
+            // A RBG takes the CQI of the subband of its first RB; as with the
+            // WB CQI, a CQI 0 gives MCS 0
+            const std::size_t subband =
+                std::min<std::size_t>(rbg * numRbPerRbg / info.m_sbSize, sbCqi.size() - 1);
+            const uint8_t cqi = sbCqi.at(subband);
+            rbgMcs.at(rbg) = cqi > 0 ? std::min(GetAmcDl()->GetMcsFromCqi(cqi),
+                                                static_cast<uint8_t>(maxDlMcs))
+                                     : 0;
+        }
+        NS_LOG_INFO("Updated SB CQI of UE " << ueInfo->m_rnti << " stream index " << stream
+                                            << " over " << sbCqi.size() << " subbands of "
+                                            << info.m_sbSize << " RB");
+    }
 }
 
 void
@@ -38,7 +69,7 @@ NrMacSchedulerCQIManagement::UlSBCQIReported(
     const std::shared_ptr<NrMacSchedulerUeInfo>& ueInfo,
     const std::vector<uint8_t>& rbgMask,
     uint32_t numRbPerRbg,
-    const Ptr<const SpectrumModel>& model) const
+    const Ptr<const SpectrumModel>& model)
 {
     NS_LOG_INFO(this);
     NS_ASSERT(rbgMask.size() > 0);
@@ -48,6 +79,7 @@ NrMacSchedulerCQIManagement::UlSBCQIReported(
     ueInfo->m_ulCqi.m_sinr = params.m_ulCqi.m_sinr;
     ueInfo->m_ulCqi.m_cqiType = NrMacSchedulerUeInfo::CqiInfo::SB;
     ueInfo->m_ulCqi.m_timer = expirationTime;
+    m_ulCqiTimers.Schedule(ueInfo->m_rnti, static_cast<uint64_t>(expirationTime) + 1);
 
     std::vector<int> rbAssignment(params.m_ulCqi.m_sinr.size(), 0);
 
@@ -87,8 +119,11 @@ NrMacSchedulerCQIManagement::UlSBCQIReported(
     NS_LOG_INFO("Values of SINR to pass to the AMC: " << out.str());
 
     // MCS updated inside the function; crappy API... but we can't fix everything
-    ueInfo->m_ulCqi.m_cqi = GetAmcUl()->CreateCqiFeedbackWbTdma(specVals, ueInfo->m_ulMcs);
-    NS_LOG_DEBUG("Calculated MCS for RNTI " << ueInfo->m_rnti << " is " << ueInfo->m_ulMcs);
+    ueInfo->m_ulCqi.m_cqi = GetAmcUl()->CreateCqiFeedbackWbTdma(specVals, ueInfo->m_ulCqiMcs);
+    NS_LOG_DEBUG("Calculated MCS for RNTI " << ueInfo->m_rnti << " is " << ueInfo->m_ulCqiMcs);
+
+    ueInfo->m_ulOlla.SetMaxMcs(static_cast<uint8_t>(GetAmcUl()->GetMaxMcs()));
+    ueInfo->m_ulMcs = ueInfo->m_ulOlla.Adjust(ueInfo->m_ulCqiMcs);
 }
 
 void
@@ -133,19 +168,33 @@ NrMacSchedulerCQIManagement::InstallGetNrAmcUlFn(const std::function<Ptr<const N
     m_getAmcUl = fn;
 }
 
+void
+NrMacSchedulerCQIManagement::InstallGetOllaConfigFn(
+    const std::function<NrMacSchedulerOlla::Config()>& fn)
+{
+    NS_LOG_FUNCTION(this);
+    m_getOllaConfig = fn;
+}
+
 void
 NrMacSchedulerCQIManagement::DlWBCQIReported(const DlCqiInfo& info,
                                              const std::shared_ptr<NrMacSchedulerUeInfo>& ueInfo,
                                              uint32_t expirationTime,
-                                             int8_t maxDlMcs) const
+                                             int8_t maxDlMcs)
 {
     NS_LOG_INFO(this);
 
     ueInfo->m_dlCqi.m_cqiType = NrMacSchedulerUeInfo::DlCqiInfo::WB;
     ueInfo->m_dlCqi.m_timer = expirationTime;
+    // A WB-only report replaces the SB one: the MCS of the RBG of the last SB
+    // report is not valid anymore (DlSBCQIReported fills it again)
+    ueInfo->m_dlRbgMcs.clear();
+    ueInfo->m_dlSbMcs.clear();
+    m_dlCqiTimers.Schedule(ueInfo->m_rnti, static_cast<uint64_t>(expirationTime) + 1);
     ueInfo->m_dlCqi.m_ri = info.m_ri;
     ueInfo->m_dlCqi.m_wbCqi.resize(info.m_wbCqi.size());
     ueInfo->m_dlMcs.resize(info.m_wbCqi.size());
+    ueInfo->m_dlCqiMcs.resize(info.m_wbCqi.size());
     // TODO following code limits the number of streams
     // 2. In future, we should try to lift this
     // limit.
@@ -165,10 +214,10 @@ NrMacSchedulerCQIManagement::DlWBCQIReported(const DlCqiInfo& info,
             uint8_t mcs =
                 std::min(static_cast<uint8_t>(GetAmcDl()->GetMcsFromCqi(info.m_wbCqi.at(stream))),
                          static_cast<uint8_t>(maxDlMcs));
-            ueInfo->m_dlMcs.at(stream) = mcs;
+            ueInfo->m_dlCqiMcs.at(stream) = mcs;
             NS_LOG_INFO("Calculated MCS for UE "
                         << ueInfo->m_rnti << " stream index " << stream << " MCS "
-                        << static_cast<uint32_t>(ueInfo->m_dlMcs.at(stream)));
+                        << static_cast<uint32_t>(ueInfo->m_dlCqiMcs.at(stream)));
 
             NS_LOG_INFO("Updated WB CQI of UE "
                         << ueInfo->m_rnti << " stream index " << stream << " CQI "
@@ -186,63 +235,172 @@ NrMacSchedulerCQIManagement::DlWBCQIReported(const DlCqiInfo& info,
             // I need to adapt at the old way so all the old test written
             // based on this assumption could pass. I would like to update those
             // tests one day but today is not that day.
+            ueInfo->m_dlCqiMcs.at(stream) = 0;
             ueInfo->m_dlMcs.at(stream) = 0;
             NS_LOG_INFO("Not updated WB CQI of UE "
                         << ueInfo->m_rnti << " stream index " << stream << " CQI "
                         << static_cast<uint16_t>(ueInfo->m_dlCqi.m_wbCqi.at(stream)));
         }
     }
+
+    ApplyDlOlla(ueInfo, maxDlMcs);
 }
 
 void
-NrMacSchedulerCQIManagement::RefreshDlCqiMaps(
-    const std::unordered_map<uint16_t, std::shared_ptr<NrMacSchedulerUeInfo>>& ueMap) const
+NrMacSchedulerCQIManagement::ApplyDlOlla(const std::shared_ptr<NrMacSchedulerUeInfo>& ueInfo,
+                                         int8_t maxDlMcs) const
 {
-    NS_LOG_FUNCTION(this);
+    // A MaxDlMcs of -1 means no limit other than the one of the AMC
+    const uint32_t maxMcs = GetAmcDl()->GetMaxMcs();
+    ueInfo->m_dlOlla.SetMaxMcs(
+        static_cast<uint8_t>(maxDlMcs < 0 ? maxMcs : std::min<uint32_t>(maxMcs, maxDlMcs)));
 
-    for (const auto& itUe : ueMap)
+    // The streams with a CQI 0 keep the MCS 0 (see DlWBCQIReported)
+    for (std::size_t stream = 0; stream < ueInfo->m_dlCqiMcs.size(); ++stream)
     {
-        const std::shared_ptr<NrMacSchedulerUeInfo>& ue = itUe.second;
-
-        if (ue->m_dlCqi.m_timer == 0)
+        if (ueInfo->m_dlCqi.m_wbCqi.at(stream) > 0)
         {
-            ue->m_dlCqi.m_cqiType = NrMacSchedulerUeInfo::DlCqiInfo::WB;
-            for (std::size_t stream = 0; stream < ue->m_dlCqi.m_wbCqi.size(); stream++)
-            {
-                ue->m_dlCqi.m_wbCqi.at(stream) = 1; // lowest value for trying a transmission
-                ue->m_dlMcs.at(stream) = GetStartMcsDl();
-            }
+            ueInfo->m_dlMcs.at(stream) = ueInfo->m_dlOlla.Adjust(ueInfo->m_dlCqiMcs.at(stream));
         }
-        else
+    }
+}
+
+void
+NrMacSchedulerCQIManagement::DlHarqFeedbackReceived(
+    const std::shared_ptr<NrMacSchedulerUeInfo>& ueInfo,
+    bool ok,
+    int8_t maxDlMcs) const
+{
+    NS_LOG_FUNCTION(this << ueInfo->m_rnti << ok);
+    const NrMacSchedulerOlla::Config config = GetOllaConfig();
+    if (!config.m_enabled)
+    {
+        return;
+    }
+
+    ueInfo->m_dlOlla.Feedback(ok, config);
+    NS_LOG_INFO("DL OLLA offset of UE " << ueInfo->m_rnti << " is "
+                                        << ueInfo->m_dlOlla.GetOffset() << ", BLER "
+                                        << ueInfo->m_dlOlla.GetBler());
+
+    // Once the CQI is expired, the starting MCS is not corrected
+    if (ueInfo->m_dlCqi.m_timer > 0)
+    {
+        ApplyDlOlla(ueInfo, maxDlMcs);
+    }
+}
+
+void
+NrMacSchedulerCQIManagement::UlHarqFeedbackReceived(
+    const std::shared_ptr<NrMacSchedulerUeInfo>& ueInfo,
+    bool ok) const
+{
+    NS_LOG_FUNCTION(this << ueInfo->m_rnti << ok);
+    const NrMacSchedulerOlla::Config config = GetOllaConfig();
+    if (!config.m_enabled)
+    {
+        return;
+    }
+
+    ueInfo->m_ulOlla.Feedback(ok, config);
+    NS_LOG_INFO("UL OLLA offset of UE " << ueInfo->m_rnti << " is "
+                                        << ueInfo->m_ulOlla.GetOffset() << ", BLER "
+                                        << ueInfo->m_ulOlla.GetBler());
+
+    // Once the CQI is expired, the starting MCS is not corrected
+    if (ueInfo->m_ulCqi.m_timer > 0)
+    {
+        ueInfo->m_ulMcs = ueInfo->m_ulOlla.Adjust(ueInfo->m_ulCqiMcs);
+    }
+}
+
+void
+NrMacSchedulerCQIManagement::AddUe(uint16_t rnti)
+{
+    NS_LOG_FUNCTION(this << rnti);
+    // A new UE behaves as a UE whose CQI has just expired
+    m_dlCqiTimers.Schedule(rnti, 1);
+    m_ulCqiTimers.Schedule(rnti, 1);
+}
+
+void
+NrMacSchedulerCQIManagement::RemoveUe(uint16_t rnti)
+{
+    NS_LOG_FUNCTION(this << rnti);
+    m_dlCqiTimers.Cancel(rnti);
+    m_ulCqiTimers.Cancel(rnti);
+}
+
+void
+NrMacSchedulerCQIManagement::RefreshDlCqiMaps(
+    const std::unordered_map<uint16_t, std::shared_ptr<NrMacSchedulerUeInfo>>& ueMap,
+    std::vector<uint16_t>* notInMap)
+{
+    NS_LOG_FUNCTION(this);
+
+    // A CQI reported with a validity of N slots is still valid during the
+    // next N refreshes, and it expires at the (N+1)-th one. Once expired, the
+    // values are not changed by anyone until the next report, so they are
+    // reset only once.
+    m_dlCqiTimers.Advance(&m_expired);
+    for (const auto& rnti : m_expired)
+    {
+        auto itUe = ueMap.find(rnti);
+        if (itUe == ueMap.end())
         {
-            ue->m_dlCqi.m_timer -= 1;
+            NS_ASSERT(notInMap != nullptr);
+            notInMap->push_back(rnti);
+            continue;
         }
+        DlCqiExpired(itUe->second);
     }
 }
 
 void
 NrMacSchedulerCQIManagement::RefreshUlCqiMaps(
-    const std::unordered_map<uint16_t, std::shared_ptr<NrMacSchedulerUeInfo>>& ueMap) const
+    const std::unordered_map<uint16_t, std::shared_ptr<NrMacSchedulerUeInfo>>& ueMap,
+    std::vector<uint16_t>* notInMap)
 {
     NS_LOG_FUNCTION(this);
 
-    for (const auto& itUe : ueMap)
+    m_ulCqiTimers.Advance(&m_expired);
+    for (const auto& rnti : m_expired)
     {
-        const std::shared_ptr<NrMacSchedulerUeInfo>& ue = itUe.second;
-
-        if (ue->m_ulCqi.m_timer == 0)
-        {
-            ue->m_ulCqi.m_cqi = 1; // lowest value for trying a transmission
-            ue->m_ulCqi.m_cqiType = NrMacSchedulerUeInfo::CqiInfo::WB;
-            ue->m_ulMcs = GetStartMcsUl();
-        }
-        else
+        auto itUe = ueMap.find(rnti);
+        if (itUe == ueMap.end())
         {
-            ue->m_ulCqi.m_timer -= 1;
+            NS_ASSERT(notInMap != nullptr);
+            notInMap->push_back(rnti);
+            continue;
         }
+        UlCqiExpired(itUe->second);
     }
 }
 
+void
+NrMacSchedulerCQIManagement::DlCqiExpired(const std::shared_ptr<NrMacSchedulerUeInfo>& ue) const
+{
+    NS_LOG_INFO("DL CQI of UE " << ue->m_rnti << " expired");
+    ue->m_dlCqi.m_timer = 0;
+    ue->m_dlCqi.m_cqiType = NrMacSchedulerUeInfo::DlCqiInfo::WB;
+    ue->m_dlRbgMcs.clear();
+    for (std::size_t stream = 0; stream < ue->m_dlCqi.m_wbCqi.size(); stream++)
+    {
+        ue->m_dlCqi.m_wbCqi.at(stream) = 1; // lowest value for trying a transmission
+        ue->m_dlMcs.at(stream) = GetStartMcsDl();
+    }
+}
+
+void
+NrMacSchedulerCQIManagement::UlCqiExpired(const std::shared_ptr<NrMacSchedulerUeInfo>& ue) const
+{
+    NS_LOG_INFO("UL CQI of UE " << ue->m_rnti << " expired");
+    ue->m_ulCqi.m_timer = 0;
+    ue->m_ulCqi.m_cqi = 1; // lowest value for trying a transmission
+    ue->m_ulCqi.m_cqiType = NrMacSchedulerUeInfo::CqiInfo::WB;
+    ue->m_ulMcs = GetStartMcsUl();
+}
+
 uint16_t
 NrMacSchedulerCQIManagement::GetBwpId() const
 {
@@ -279,4 +437,11 @@ NrMacSchedulerCQIManagement::GetAmcUl() const
     return m_getAmcUl();
 }
 
+NrMacSchedulerOlla::Config
+NrMacSchedulerCQIManagement::GetOllaConfig() const
+{
+    // Without a function, the OLLA is disabled
+    return m_getOllaConfig ? m_getOllaConfig() : NrMacSchedulerOlla::Config();
+}
+
 } // namespace ns3
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include "nr-mac-scheduler-olla.h"
+#include "nr-mac-scheduler-timer-wheel.h"
 #include "nr-mac-scheduler-ue-info.h"
 #include "nr-phy-mac-common.h"
 
@@ -25,6 +27,17 @@ class NrAmc;
  * and it is a bit more complicated. For any detail, check the respective
  * documentation.
  *
+ * The validity of the CQI values is tracked with a timer wheel for each
+ * direction (see NrMacSchedulerTimerWheel): a report restarts the timer of
+ * the UE, and the refresh of each slot visits only the UEs whose CQI expires
+ * in that slot, instead of all the UEs of the cell.
+ *
+ * The MCS obtained from the CQI can be corrected with an outer-loop link
+ * adaptation (OLLA, see NrMacSchedulerOlla), which follows the HARQ feedback
+ * of each UE and direction (DlHarqFeedbackReceived, UlHarqFeedbackReceived).
+ * The offset is applied when a CQI is reported, and again after each
+ * feedback, so that the next DCI of the UE uses the updated offset.
+ *
  * \see UlSBCQIReported
  * \see DlWBCQIReported
  */
@@ -66,6 +79,27 @@ class NrMacSchedulerCQIManagement
 
     void InstallGetNrAmcUlFn(const std::function<Ptr<const NrAmc>()>& fn);
 
+    /**
+     * \brief Install a function to retrieve the parameters of the OLLA
+     * \param fn the function
+     */
+    void InstallGetOllaConfigFn(const std::function<NrMacSchedulerOlla::Config()>& fn);
+
+    /**
+     * \brief A UE has been added to the scheduler
+     * \param rnti RNTI of the UE
+     *
+     * The UE has no valid CQI yet: its values will be reset to the default
+     * at the next refresh, unless a CQI is reported before.
+     */
+    void AddUe(uint16_t rnti);
+
+    /**
+     * \brief A UE has been removed from the scheduler
+     * \param rnti RNTI of the UE
+     */
+    void RemoveUe(uint16_t rnti);
+
     /**
      * \brief A wideband CQI has been reported for the specified UE
      * \param info WB CQI
@@ -76,21 +110,34 @@ class NrMacSchedulerCQIManagement
      * Store the CQI information inside the m_dlCqi value of the UE, and then
      * calculate the corresponding MCS through NrAmc. The information is
      * contained in the structure DlCqiInfo, so no need to make calculation
-     * here.
+     * here. The MCS is stored in m_dlCqiMcs, and m_dlMcs is the same value
+     * corrected by the OLLA offset of the UE. The MCS of the RBG of a previous
+     * SB CQI are dropped, so that the UE is scheduled with the WB MCS.
      */
     void DlWBCQIReported(const DlCqiInfo& info,
                          const std::shared_ptr<NrMacSchedulerUeInfo>& ueInfo,
                          uint32_t expirationTime,
-                         int8_t maxDlMcs) const;
+                         int8_t maxDlMcs);
     /**
-     * \brief SB CQI reported
-     * \param info SB CQI
+     * \brief A subband CQI has been reported for the specified UE
+     * \param info SB CQI, which includes the WB CQI
      * \param ueInfo UE
+     * \param expirationTime expiration time of the CQI in number of slot
+     * \param maxDlMcs maximum DL MCS index
+     * \param numRbPerRbg number of RB per RBG
+     * \param numRbg number of RBG of the bandwidth
      *
-     * NOT IMPLEMENTED
+     * The WB CQI of the report is processed as in DlWBCQIReported. Then, the
+     * CQI of each subband is converted in the MCS of the RBG of the subband,
+     * which are stored in m_dlRbgMcs of the UE, until the CQI expires or a
+     * WB-only CQI is reported.
      */
     void DlSBCQIReported(const DlCqiInfo& info,
-                         const std::shared_ptr<NrMacSchedulerUeInfo>& ueInfo) const;
+                         const std::shared_ptr<NrMacSchedulerUeInfo>& ueInfo,
+                         uint32_t expirationTime,
+                         int8_t maxDlMcs,
+                         uint32_t numRbPerRbg,
+                         uint32_t numRbg);
 
     /**
      * \brief An UL SB CQI has been reported for the specified UE
@@ -110,7 +157,8 @@ class NrMacSchedulerCQIManagement
      * From a vector of SINR (along the entire band) a SpectrumValue is calculated
      * and then passed as input to NrAmc::CreateCqiFeedbackWbTdma. From this
      * function, we have as a result an updated value of CQI, as well as an updated
-     * version of MCS for the UL.
+     * version of MCS for the UL, which is then corrected by the OLLA offset of
+     * the UE.
      */
     void UlSBCQIReported(uint32_t expirationTime,
                          uint32_t tbs,
@@ -118,31 +166,77 @@ class NrMacSchedulerCQIManagement
                          const std::shared_ptr<NrMacSchedulerUeInfo>& ueInfo,
                          const std::vector<uint8_t>& rbgMask,
                          uint32_t numRbPerRbg,
-                         const Ptr<const SpectrumModel>& model) const;
+                         const Ptr<const SpectrumModel>& model);
+
+    /**
+     * \brief The HARQ feedback of a DL first transmission has been received
+     * \param ueInfo UE
+     * \param ok true if all the streams of the TB have been received
+     * \param maxDlMcs maximum DL MCS index
+     *
+     * If the OLLA is enabled, update the DL offset of the UE, and apply it to
+     * the MCS of its current CQI. Nothing is done otherwise.
+     */
+    void DlHarqFeedbackReceived(const std::shared_ptr<NrMacSchedulerUeInfo>& ueInfo,
+                                bool ok,
+                                int8_t maxDlMcs) const;
+
+    /**
+     * \brief The HARQ feedback of a UL first transmission has been received
+     * \param ueInfo UE
+     * \param ok true if the TB has been received
+     *
+     * If the OLLA is enabled, update the UL offset of the UE, and apply it to
+     * the MCS of its current CQI. Nothing is done otherwise.
+     */
+    void UlHarqFeedbackReceived(const std::shared_ptr<NrMacSchedulerUeInfo>& ueInfo,
+                                bool ok) const;
 
     /**
      * \brief Refresh the DL CQI for all the UE
      *
      * This method should be called every slot.
-     * Decrement the validity counter DL CQI, and if a CQI expires, reset its
-     * value to the default (MCS 0)
+     * Advance the validity timers of the DL CQI, and reset to the default
+     * (MCS 0) the value of the UEs whose CQI expires in this slot. Only those
+     * UEs are visited.
      *
      * \param m_ueMap UE map
+     * \param notInMap if not nullptr, it is filled with the UEs whose CQI
+     * expires in this slot but that are not in the UE map; the caller resets
+     * their values with DlCqiExpired()
      */
     void RefreshDlCqiMaps(
-        const std::unordered_map<uint16_t, std::shared_ptr<NrMacSchedulerUeInfo>>& m_ueMap) const;
+        const std::unordered_map<uint16_t, std::shared_ptr<NrMacSchedulerUeInfo>>& m_ueMap,
+        std::vector<uint16_t>* notInMap = nullptr);
 
     /**
      * \brief Refresh the UL CQI for all the UE
      *
      * This method should be called every slot.
-     * Decrement the validity counter UL CQI, and if a CQI expires, reset its
-     * value to the default (MCS 0)
+     * Advance the validity timers of the UL CQI, and reset to the default
+     * (MCS 0) the value of the UEs whose CQI expires in this slot. Only those
+     * UEs are visited.
      *
      * \param m_ueMap UE map
+     * \param notInMap if not nullptr, it is filled with the UEs whose CQI
+     * expires in this slot but that are not in the UE map; the caller resets
+     * their values with UlCqiExpired()
      */
     void RefreshUlCqiMaps(
-        const std::unordered_map<uint16_t, std::shared_ptr<NrMacSchedulerUeInfo>>& m_ueMap) const;
+        const std::unordered_map<uint16_t, std::shared_ptr<NrMacSchedulerUeInfo>>& m_ueMap,
+        std::vector<uint16_t>* notInMap = nullptr);
+
+    /**
+     * \brief Reset the DL CQI of a UE to the default, once it is expired
+     * \param ue the UE
+     */
+    void DlCqiExpired(const std::shared_ptr<NrMacSchedulerUeInfo>& ue) const;
+
+    /**
+     * \brief Reset the UL CQI of a UE to the default, once it is expired
+     * \param ue the UE
+     */
+    void UlCqiExpired(const std::shared_ptr<NrMacSchedulerUeInfo>& ue) const;
 
   private:
     /**
@@ -177,12 +271,30 @@ class NrMacSchedulerCQIManagement
      */
     Ptr<const NrAmc> GetAmcUl() const;
 
+    /**
+     * \return the parameters of the OLLA
+     */
+    NrMacSchedulerOlla::Config GetOllaConfig() const;
+
+    /**
+     * \brief Apply the OLLA offset to the DL MCS of the WB CQI of a UE
+     * \param ueInfo UE
+     * \param maxDlMcs maximum DL MCS index
+     */
+    void ApplyDlOlla(const std::shared_ptr<NrMacSchedulerUeInfo>& ueInfo, int8_t maxDlMcs) const;
+
     std::function<uint16_t()> m_getBwpId;         //!< Function to retrieve bwp id
     std::function<uint16_t()> m_getCellId;        //!< Function to retrieve cell id
     std::function<uint8_t()> m_getStartMcsDl;     //!< Function to retrieve the starting MCS for DL
     std::function<uint8_t()> m_getStartMcsUl;     //!< Function to retrieve the starting MCS for UL
     std::function<Ptr<const NrAmc>()> m_getAmcDl; //!< Function to retrieve the AMC for DL
     std::function<Ptr<const NrAmc>()> m_getAmcUl; //!< Function to retrieve the AMC for UL
+    std::function<NrMacSchedulerOlla::Config()> m_getOllaConfig; //!< Function to retrieve the
+                                                                  //!< parameters of the OLLA
+
+    NrMacSchedulerTimerWheel m_dlCqiTimers; //!< Expiration of the DL CQI, in refreshes
+    NrMacSchedulerTimerWheel m_ulCqiTimers; //!< Expiration of the UL CQI, in refreshes
+    std::vector<uint16_t> m_expired;        //!< UEs whose CQI expires in the current refresh
 };
 
 } // namespace ns3
@@ -0,0 +1,233 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include "nr-phy-mac-common.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief Pool of the DCIs created by a scheduler
+ *
+ * Each allocation of the scheduler is described by a DciInfoElementTdma,
+ * shared between the scheduler, the MAC and the PHY through a std::shared_ptr.
+ * Instead of requesting the memory for each of them (and for their control
+ * block) to the system allocator, the pool carves them out of blocks of
+ * equally-sized chunks. When the last owner of a DCI releases it (usually the
+ * PHY, after the slot has been transmitted) its chunk goes back to the pool,
+ * and it is reused by the next DCI.
+ *
+ * The memory of the pool is released when the pool and all the DCIs that
+ * it created are destroyed, so a DCI can safely outlive the scheduler.
+ *
+ * The vectors inside the DCI (MCS, TBS, RBG bitmask, etc.) are still
+ * allocated by their own allocator.
+ */
+class NrMacSchedulerDciPool
+{
+  public:
+    /**
+     * \brief NrMacSchedulerDciPool constructor
+     */
+    NrMacSchedulerDciPool()
+        : m_slab(std::make_shared<Slab>())
+    {
+    }
+
+    /**
+     * \brief Create a DCI, forwarding the arguments to its constructor
+     * \param args the arguments of one of the DciInfoElementTdma constructors
+     * \return a pointer to the DCI
+     */
+    template <typename... Args>
+    std::shared_ptr<DciInfoElementTdma> Create(Args&&... args) const
+    {
+        return std::allocate_shared<DciInfoElementTdma>(SlabAllocator<DciInfoElementTdma>(m_slab),
+                                                        std::forward<Args>(args)...);
+    }
+
+    /**
+     * \return the number of DCIs created by the pool
+     */
+    uint64_t GetNumCreated() const
+    {
+        return m_slab->m_numAllocations;
+    }
+
+    /**
+     * \return the number of requests made by the pool to the system allocator
+     */
+    uint64_t GetNumSystemAllocations() const
+    {
+        return m_slab->m_numSystemAllocations;
+    }
+
+  private:
+    /**
+     * \brief The storage of the pool: blocks of chunks, and the list of the free chunks
+     */
+    struct Slab
+    {
+        static constexpr std::size_t CHUNKS_PER_BLOCK = 64; //!< Chunks in each block
+
+        Slab() = default;
+        Slab(const Slab&) = delete;
+        Slab& operator=(const Slab&) = delete;
+
+        ~Slab()
+        {
+            for (const auto& block : m_blocks)
+            {
+                ::operator delete(block);
+            }
+        }
+
+        /**
+         * \brief Get memory for an object
+         * \param size the size of the object
+         * \return a pointer to the memory
+         *
+         * The first requested size fixes the size of the chunks; a request
+         * of a different size is forwarded to the system allocator.
+         */
+        void* Allocate(std::size_t size)
+        {
+            ++m_numAllocations;
+            if (m_chunkSize == 0)
+            {
+                m_chunkSize = size;
+            }
+            if (size != m_chunkSize)
+            {
+                ++m_numSystemAllocations;
+                return ::operator new(size);
+            }
+            if (m_free.empty())
+            {
+                Grow();
+            }
+            void* chunk = m_free.back();
+            m_free.pop_back();
+            return chunk;
+        }
+
+        /**
+         * \brief Give back the memory of an object
+         * \param p the pointer returned by Allocate()
+         * \param size the size of the object
+         */
+        void Deallocate(void* p, std::size_t size)
+        {
+            if (size != m_chunkSize)
+            {
+                ::operator delete(p);
+                return;
+            }
+            m_free.push_back(p);
+        }
+
+        /**
+         * \brief Add a block of chunks to the free list
+         */
+        void Grow()
+        {
+            const std::size_t align = alignof(std::max_align_t);
+            const std::size_t stride = (m_chunkSize + align - 1) / align * align;
+            char* block = static_cast<char*>(::operator new(stride * CHUNKS_PER_BLOCK));
+            ++m_numSystemAllocations;
+            m_blocks.push_back(block);
+            for (std::size_t i = CHUNKS_PER_BLOCK; i > 0; --i)
+            {
+                m_free.push_back(block + (i - 1) * stride);
+            }
+        }
+
+        std::size_t m_chunkSize{0};         //!< Size of each chunk
+        std::vector<void*> m_blocks;        //!< Blocks obtained from the system
+        std::vector<void*> m_free;          //!< Free chunks
+        uint64_t m_numAllocations{0};       //!< Number of calls to Allocate()
+        uint64_t m_numSystemAllocations{0}; //!< Number of requests to the system
+    };
+
+    /**
+     * \brief Allocator, in the sense of the standard library, that uses a Slab
+     */
+    template <typename T>
+    struct SlabAllocator
+    {
+        typedef T value_type; //!< Type of the allocated objects
+
+        /**
+         * \brief SlabAllocator constructor
+         * \param slab the slab from which the memory is taken
+         */
+        explicit SlabAllocator(std::shared_ptr<Slab> slab)
+            : m_slab(std::move(slab))
+        {
+        }
+
+        /**
+         * \brief Copy constructor from an allocator of a different type
+         * \param o the other allocator
+         */
+        template <typename U>
+        SlabAllocator(const SlabAllocator<U>& o)
+            : m_slab(o.m_slab)
+        {
+        }
+
+        /**
+         * \param n number of objects
+         * \return memory for n objects
+         */
+        T* allocate(std::size_t n)
+        {
+            return static_cast<T*>(m_slab->Allocate(n * sizeof(T)));
+        }
+
+        /**
+         * \param p memory returned by allocate()
+         * \param n number of objects
+         */
+        void deallocate(T* p, std::size_t n)
+        {
+            m_slab->Deallocate(p, n * sizeof(T));
+        }
+
+        /**
+         * \param o the other allocator
+         * \return true if the two allocators share the same slab
+         */
+        template <typename U>
+        bool operator==(const SlabAllocator<U>& o) const
+        {
+            return m_slab == o.m_slab;
+        }
+
+        /**
+         * \param o the other allocator
+         * \return true if the two allocators do not share the same slab
+         */
+        template <typename U>
+        bool operator!=(const SlabAllocator<U>& o) const
+        {
+            return m_slab != o.m_slab;
+        }
+
+        std::shared_ptr<Slab> m_slab; //!< The slab; kept alive by every allocated object
+    };
+
+    std::shared_ptr<Slab> m_slab; //!< The storage of the pool
+};
+
+} // namespace ns3
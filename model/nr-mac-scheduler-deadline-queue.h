@@ -0,0 +1,324 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include <ns3/assert.h>
+#include <ns3/nstime.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <set>
+#include <tuple>
+#include <utility>
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief Ordered head-of-line deadlines of the DL LCs
+ *
+ * Each LC with data, identified by the RNTI of its UE and its LC ID, has at
+ * most one deadline: the time at which its head-of-line (HOL) packet exceeds
+ * the packet delay budget of the 5QI of the LC. The deadlines are kept in
+ * two ordered sets: one with the deadlines of all the LCs of each UE, whose
+ * first element gives the deadline of the UE (GetUeDeadline()), and one with
+ * the deadlines that are not missed yet, whose first elements are the ones
+ * that Expire() flags as missed. All the operations cost O(log n) in the
+ * number of LCs with data, plus O(1) for each flagged deadline.
+ *
+ * The deadline of an HOL packet is resolved, and reported to the callback set
+ * with SetResolvedCallback(), exactly once: as missed when Expire() finds it
+ * in the past, or when it is replaced by the deadline of the next packet
+ * (Update()) or the LC runs out of data (Remove()); the packet is considered
+ * served in time if this happens before its deadline. Since the HOL delay is
+ * reported by the RLC in ms, two deadlines that differ by less than the
+ * resolution given to the constructor belong to the same packet.
+ *
+ * A missed deadline stays in the LC until the packet is served: by default it
+ * keeps ordering the UE before the ones with a later deadline, as in a plain
+ * EDF. With SetDeprioritizeMissed(), a UE is instead ordered by its earliest
+ * deadline that is not missed, and after all the other UEs if all its
+ * deadlines are missed, so that late packets do not delay the ones that can
+ * still be served in time.
+ */
+class NrMacSchedulerDeadlineQueue
+{
+  public:
+    /**
+     * \brief Function called when the deadline of an HOL packet is resolved
+     *
+     * The arguments are the RNTI, the LC ID, the 5QI of the LC, and true if
+     * the deadline has been missed.
+     */
+    typedef std::function<void(uint16_t rnti, uint8_t lcId, uint8_t qci, bool missed)>
+        ResolvedCallback;
+
+    /**
+     * \brief NrMacSchedulerDeadlineQueue constructor
+     * \param resolution deadlines closer than this value belong to the same packet
+     */
+    NrMacSchedulerDeadlineQueue(const Time& resolution = MilliSeconds(1))
+        : m_resolution(resolution)
+    {
+    }
+
+    /**
+     * \brief Set the function called when a deadline is resolved
+     * \param cb the callback
+     */
+    void SetResolvedCallback(const ResolvedCallback& cb)
+    {
+        m_resolvedCb = cb;
+    }
+
+    /**
+     * \brief Order the UEs by their deadlines that are not missed
+     * \param v true to order the UEs after the missed deadlines; to be set
+     * before the first deadline is inserted
+     */
+    void SetDeprioritizeMissed(bool v)
+    {
+        NS_ASSERT(m_lcs.empty());
+        m_deprioritizeMissed = v;
+    }
+
+    /**
+     * \brief Set the deadline of the HOL packet of an LC
+     * \param rnti the UE
+     * \param lcId the LC
+     * \param qci the 5QI of the LC
+     * \param deadline the deadline of the HOL packet
+     * \param now the current time
+     *
+     * If the LC had the deadline of another packet, that deadline is resolved.
+     */
+    void Update(uint16_t rnti, uint8_t lcId, uint8_t qci, const Time& deadline, const Time& now)
+    {
+        auto it = m_lcs.find({rnti, lcId});
+        if (it != m_lcs.end())
+        {
+            if (Abs(it->second.m_deadline - deadline) < m_resolution)
+            {
+                return;
+            }
+            Resolve(it, now);
+        }
+        it = m_lcs.emplace(std::make_pair(rnti, lcId), Lc{deadline, qci, false}).first;
+        m_ueDeadlines[rnti].insert(GetUeKey(it));
+        m_pending.emplace(deadline, rnti, lcId);
+        if (deadline < now)
+        {
+            Flag(it);
+        }
+    }
+
+    /**
+     * \brief Remove the deadline of an LC that has no more data
+     * \param rnti the UE
+     * \param lcId the LC
+     * \param now the current time
+     *
+     * The deadline of the HOL packet, if any, is resolved.
+     */
+    void Remove(uint16_t rnti, uint8_t lcId, const Time& now)
+    {
+        auto it = m_lcs.find({rnti, lcId});
+        if (it != m_lcs.end())
+        {
+            Resolve(it, now);
+        }
+    }
+
+    /**
+     * \brief Remove the deadlines of all the LCs of a UE, without resolving them
+     * \param rnti the UE
+     */
+    void RemoveUe(uint16_t rnti)
+    {
+        auto it = m_lcs.lower_bound({rnti, 0});
+        while (it != m_lcs.end() && it->first.first == rnti)
+        {
+            if (!it->second.m_missed)
+            {
+                m_pending.erase({it->second.m_deadline, rnti, it->first.second});
+            }
+            it = m_lcs.erase(it);
+        }
+        m_ueDeadlines.erase(rnti);
+    }
+
+    /**
+     * \brief Flag as missed the deadlines that are before the current time
+     * \param now the current time
+     */
+    void Expire(const Time& now)
+    {
+        while (!m_pending.empty() && std::get<0>(*m_pending.begin()) < now)
+        {
+            const auto& first = *m_pending.begin();
+            Flag(m_lcs.find({std::get<1>(first), std::get<2>(first)}));
+        }
+    }
+
+    /**
+     * \param rnti the UE
+     * \return the deadline that orders the UE, or Time::Max() if there is none
+     */
+    Time GetUeDeadline(uint16_t rnti) const
+    {
+        auto it = m_ueDeadlines.find(rnti);
+        if (it == m_ueDeadlines.end() || it->second.empty())
+        {
+            return Time::Max();
+        }
+        const auto& first = *it->second.begin();
+        return std::get<0>(first) ? Time::Max() : std::get<1>(first);
+    }
+
+    /**
+     * \param rnti the UE
+     * \param lcId the LC
+     * \return true if the deadline of the HOL packet of the LC has been missed
+     */
+    bool IsMissed(uint16_t rnti, uint8_t lcId) const
+    {
+        auto it = m_lcs.find({rnti, lcId});
+        return it != m_lcs.end() && it->second.m_missed;
+    }
+
+    /**
+     * \return the number of LCs with a deadline
+     */
+    std::size_t GetNumLcs() const
+    {
+        return m_lcs.size();
+    }
+
+    /**
+     * \param qci the 5QI
+     * \return the number of resolved deadlines of the LCs of the 5QI
+     */
+    uint64_t GetNumResolved(uint8_t qci) const
+    {
+        auto it = m_stats.find(qci);
+        return it == m_stats.end() ? 0 : it->second.first;
+    }
+
+    /**
+     * \param qci the 5QI
+     * \return the number of missed deadlines of the LCs of the 5QI
+     */
+    uint64_t GetNumMissed(uint8_t qci) const
+    {
+        auto it = m_stats.find(qci);
+        return it == m_stats.end() ? 0 : it->second.second;
+    }
+
+    /**
+     * \param qci the 5QI
+     * \return the share of the resolved deadlines of the 5QI that have been missed
+     */
+    double GetMissRate(uint8_t qci) const
+    {
+        const uint64_t resolved = GetNumResolved(qci);
+        return resolved == 0 ? 0.0 : static_cast<double>(GetNumMissed(qci)) / resolved;
+    }
+
+  private:
+    /**
+     * \brief The deadline of the HOL packet of an LC
+     */
+    struct Lc
+    {
+        Time m_deadline;      //!< Deadline of the HOL packet
+        uint8_t m_qci{0};     //!< 5QI of the LC
+        bool m_missed{false}; //!< True if the deadline has been missed
+    };
+
+    typedef std::map<std::pair<uint16_t, uint8_t>, Lc> LcMap; //!< LCs, by RNTI and LC ID
+    typedef std::tuple<bool, Time, uint8_t> UeKey;            //!< Order of the LCs inside a UE
+
+    /**
+     * \param it the LC
+     * \return the key of the LC in the deadlines of its UE
+     */
+    UeKey GetUeKey(LcMap::const_iterator it) const
+    {
+        return UeKey(m_deprioritizeMissed && it->second.m_missed,
+                     it->second.m_deadline,
+                     it->first.second);
+    }
+
+    /**
+     * \brief Flag as missed the deadline of an LC
+     * \param it the LC, whose deadline is not missed yet
+     */
+    void Flag(LcMap::iterator it)
+    {
+        NS_ASSERT(it != m_lcs.end() && !it->second.m_missed);
+        const auto [rnti, lcId] = it->first;
+        m_pending.erase({it->second.m_deadline, rnti, lcId});
+        auto& ueDeadlines = m_ueDeadlines.at(rnti);
+        ueDeadlines.erase(GetUeKey(it));
+        it->second.m_missed = true;
+        ueDeadlines.insert(GetUeKey(it));
+        Count(rnti, lcId, it->second.m_qci, true);
+    }
+
+    /**
+     * \brief Resolve the deadline of an LC, and remove it
+     * \param it the LC
+     * \param now the current time
+     */
+    void Resolve(LcMap::iterator it, const Time& now)
+    {
+        const auto [rnti, lcId] = it->first;
+        if (!it->second.m_missed)
+        {
+            m_pending.erase({it->second.m_deadline, rnti, lcId});
+            Count(rnti, lcId, it->second.m_qci, it->second.m_deadline < now);
+        }
+        auto ueIt = m_ueDeadlines.find(rnti);
+        ueIt->second.erase(GetUeKey(it));
+        if (ueIt->second.empty())
+        {
+            m_ueDeadlines.erase(ueIt);
+        }
+        m_lcs.erase(it);
+    }
+
+    /**
+     * \brief Count a resolved deadline, and report it
+     * \param rnti the UE
+     * \param lcId the LC
+     * \param qci the 5QI of the LC
+     * \param missed true if the deadline has been missed
+     */
+    void Count(uint16_t rnti, uint8_t lcId, uint8_t qci, bool missed)
+    {
+        auto& stats = m_stats[qci];
+        ++stats.first;
+        stats.second += missed ? 1 : 0;
+        if (m_resolvedCb)
+        {
+            m_resolvedCb(rnti, lcId, qci, missed);
+        }
+    }
+
+    Time m_resolution;                //!< Deadlines closer than it belong to the same packet
+    bool m_deprioritizeMissed{false}; //!< Order the UEs after their missed deadlines
+    ResolvedCallback m_resolvedCb;    //!< Called when a deadline is resolved
+
+    LcMap m_lcs;                                              //!< Deadline of each LC
+    std::map<uint16_t, std::set<UeKey>> m_ueDeadlines;        //!< Deadlines of the LCs of each UE
+    std::set<std::tuple<Time, uint16_t, uint8_t>> m_pending;  //!< Deadlines not missed yet
+    std::map<uint8_t, std::pair<uint64_t, uint64_t>> m_stats; //!< Resolved and missed, by 5QI
+};
+
+} // namespace ns3
@@ -44,6 +44,12 @@ NrMacSchedulerHarqRr::InstallGetBwInRBG(const std::function<uint16_t()>& fn)
     m_getBwInRbg = fn;
 }
 
+void
+NrMacSchedulerHarqRr::InstallGetDciPoolFn(const std::function<const NrMacSchedulerDciPool&()>& fn)
+{
+    m_getDciPool = fn;
+}
+
 /**
  * \brief Schedule DL HARQ in RR fashion
  * \param startingPoint starting point of the first retransmission.
@@ -168,17 +174,17 @@ NrMacSchedulerHarqRr::ScheduleDlHarq(
                 }
             }
 
-            auto dci = std::make_shared<DciInfoElementTdma>(dciInfoReTx->m_rnti,
-                                                            dciInfoReTx->m_format,
-                                                            startingPoint->m_sym,
-                                                            symPerBeam,
-                                                            mcs,
-                                                            tbSize,
-                                                            ndi,
-                                                            rv,
-                                                            DciInfoElementTdma::DATA,
-                                                            dciInfoReTx->m_bwpIndex,
-                                                            dciInfoReTx->m_tpc);
+            auto dci = GetDciPool().Create(dciInfoReTx->m_rnti,
+                                           dciInfoReTx->m_format,
+                                           startingPoint->m_sym,
+                                           symPerBeam,
+                                           std::move(mcs),
+                                           std::move(tbSize),
+                                           std::move(ndi),
+                                           std::move(rv),
+                                           DciInfoElementTdma::DATA,
+                                           dciInfoReTx->m_bwpIndex,
+                                           dciInfoReTx->m_tpc);
 
             dci->m_rbgBitmask = harqProcess.m_dciElement->m_rbgBitmask;
             dci->m_harqProcess = dciInfoReTx->m_harqProcess;
@@ -323,22 +329,14 @@ NrMacSchedulerHarqRr::ScheduleUlHarq(
                           "MIMO is not supported for UL yet");
 
             uint8_t rvIndex = dciInfoReTx->m_rv.at(0) + 1;
-            std::vector<uint8_t> rv{rvIndex};
-            std::vector<uint8_t> ndi{0};
-
-            auto dci =
-                std::make_shared<DciInfoElementTdma>(dciInfoReTx->m_rnti,
-                                                     dciInfoReTx->m_format,
-                                                     startingPoint->m_sym - dciInfoReTx->m_numSym,
-                                                     dciInfoReTx->m_numSym,
-                                                     dciInfoReTx->m_mcs,
-                                                     dciInfoReTx->m_tbSize,
-                                                     ndi,
-                                                     rv,
-                                                     DciInfoElementTdma::DATA,
-                                                     dciInfoReTx->m_bwpIndex,
-                                                     dciInfoReTx->m_tpc);
-            dci->m_rbgBitmask = harqProcess.m_dciElement->m_rbgBitmask;
+
+            // The retransmission copies MCS, TBS and RBG bitmask of the first
+            // transmission
+            auto dci = GetDciPool().Create(startingPoint->m_sym - dciInfoReTx->m_numSym,
+                                           dciInfoReTx->m_numSym,
+                                           std::vector<uint8_t>{0},
+                                           std::vector<uint8_t>{rvIndex},
+                                           *dciInfoReTx);
             dci->m_harqProcess = harqId;
             harqProcess.m_dciElement = dci;
             dciInfoReTx = harqProcess.m_dciElement;
@@ -460,4 +458,10 @@ NrMacSchedulerHarqRr::GetBandwidthInRbg() const
     return m_getBwInRbg();
 }
 
+const NrMacSchedulerDciPool&
+NrMacSchedulerHarqRr::GetDciPool() const
+{
+    return m_getDciPool();
+}
+
 } // namespace ns3
@@ -56,6 +56,12 @@ class NrMacSchedulerHarqRr
      */
     void InstallGetBwInRBG(const std::function<uint16_t()>& fn);
 
+    /**
+     * \brief Install a function to retrieve the pool of the DCIs of the scheduler
+     * \param fn the function
+     */
+    void InstallGetDciPoolFn(const std::function<const NrMacSchedulerDciPool&()>& fn);
+
     virtual uint8_t ScheduleDlHarq(
         NrMacSchedulerNs3::PointInFTPlane* startingPoint,
         uint8_t symAvail,
@@ -97,10 +103,18 @@ class NrMacSchedulerHarqRr
      */
     uint16_t GetBandwidthInRbg() const;
 
+    /**
+     * \brief Get the pool of the DCIs of the scheduler
+     * \return the DCI pool
+     */
+    const NrMacSchedulerDciPool& GetDciPool() const;
+
   private:
     std::function<uint16_t()> m_getBwpId;   //!< Function to retrieve bwp id
     std::function<uint16_t()> m_getCellId;  //!< Function to retrieve cell id
     std::function<uint16_t()> m_getBwInRbg; //!< Function to retrieve bw in rbg
+    std::function<const NrMacSchedulerDciPool&()>
+        m_getDciPool; //!< Function to retrieve the DCI pool
 };
 
 } // namespace ns3
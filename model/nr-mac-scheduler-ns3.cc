@@ -18,6 +18,7 @@
 #include "nr-mac-short-bsr-ce.h"
 
 #include <ns3/boolean.h>
+#include <ns3/double.h>
 #include <ns3/eps-bearer.h>
 #include <ns3/integer.h>
 #include <ns3/log.h>
@@ -26,6 +27,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <tuple>
 #include <unordered_set>
 
 namespace ns3
@@ -44,6 +46,7 @@ NrMacSchedulerNs3::NrMacSchedulerNs3()
     m_schedHarq->InstallGetBwInRBG(std::bind(&NrMacSchedulerNs3::GetBandwidthInRbg, this));
     m_schedHarq->InstallGetBwpIdFn(std::bind(&NrMacSchedulerNs3::GetBwpId, this));
     m_schedHarq->InstallGetCellIdFn(std::bind(&NrMacSchedulerNs3::GetCellId, this));
+    m_schedHarq->InstallGetDciPoolFn(std::bind(&NrMacSchedulerNs3::GetDciPool, this));
 
     m_cqiManagement.InstallGetBwpIdFn(std::bind(&NrMacSchedulerNs3::GetBwpId, this));
     m_cqiManagement.InstallGetCellIdFn(std::bind(&NrMacSchedulerNs3::GetCellId, this));
@@ -51,6 +54,13 @@ NrMacSchedulerNs3::NrMacSchedulerNs3()
     m_cqiManagement.InstallGetNrAmcUlFn(std::bind([this]() { return m_ulAmc; }));
     m_cqiManagement.InstallGetStartMcsDlFn(std::bind([this]() { return m_startMcsDl; }));
     m_cqiManagement.InstallGetStartMcsUlFn(std::bind([this]() { return m_startMcsUl; }));
+    m_cqiManagement.InstallGetOllaConfigFn([this]() {
+        return NrMacSchedulerOlla::Config{m_ollaEnabled,
+                                          m_ollaTargetBler,
+                                          m_ollaStep,
+                                          m_ollaMinOffset,
+                                          m_ollaMaxOffset};
+    });
 
     // If more Srs allocators will be created, then we will add an attribute
     m_schedulerSrs = CreateObject<NrMacSchedulerSrsDefault>();
@@ -195,7 +205,68 @@ NrMacSchedulerNs3::GetTypeId()
                 TypeIdValue(NrMacSchedulerLcRR::GetTypeId()),
                 MakeTypeIdAccessor(&NrMacSchedulerNs3::SetLcSched),
                 //&NrMacSchedulerNs3::GetLcSched),
-                MakeTypeIdChecker());
+                MakeTypeIdChecker())
+            .AddAttribute("IncrementalActiveUe",
+                          "If true, the active UEs of each slot are searched only among the UEs "
+                          "that received data (RLC buffer status, BSR or SR) since they were "
+                          "last found without data, in RNTI order, instead of among all the "
+                          "attached UEs",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&NrMacSchedulerNs3::m_incrementalActiveUe),
+                          MakeBooleanChecker())
+            .AddAttribute("EnableOlla",
+                          "If true, the MCS obtained from the CQI of each UE is corrected by an "
+                          "outer-loop link adaptation (OLLA) offset, which follows the HARQ "
+                          "feedback of the first transmissions, in DL and UL",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&NrMacSchedulerNs3::m_ollaEnabled),
+                          MakeBooleanChecker())
+            .AddAttribute("OllaTargetBler",
+                          "The BLER of the first transmissions targeted by the OLLA",
+                          DoubleValue(0.1),
+                          MakeDoubleAccessor(&NrMacSchedulerNs3::m_ollaTargetBler),
+                          MakeDoubleChecker<double>(0.001, 0.999))
+            .AddAttribute("OllaStep",
+                          "The decrease of the OLLA offset, in MCS indexes, after a NACK; after "
+                          "an ACK, the offset increases by OllaStep * BLER / (1 - BLER)",
+                          DoubleValue(0.5),
+                          MakeDoubleAccessor(&NrMacSchedulerNs3::m_ollaStep),
+                          MakeDoubleChecker<double>(0.0))
+            .AddAttribute("OllaMinOffset",
+                          "The minimum OLLA offset, in MCS indexes",
+                          DoubleValue(-10.0),
+                          MakeDoubleAccessor(&NrMacSchedulerNs3::m_ollaMinOffset),
+                          MakeDoubleChecker<double>())
+            .AddAttribute("OllaMaxOffset",
+                          "The maximum OLLA offset, in MCS indexes",
+                          DoubleValue(5.0),
+                          MakeDoubleAccessor(&NrMacSchedulerNs3::m_ollaMaxOffset),
+                          MakeDoubleChecker<double>())
+            .AddTraceSource("SlotProfile",
+                            "Wall time of each phase of the scheduling of a slot. Fired only "
+                            "if the module is built with the CMake option NR_SCHEDULER_PROFILING",
+                            MakeTraceSourceAccessor(&NrMacSchedulerNs3::m_slotProfileTrace),
+                            "ns3::NrMacSchedulerProfiler::SlotProfileTracedCallback")
+            .AddTraceSource("WastedResources",
+                            "Resources assigned to a UE that were not enough for a TB with "
+                            "data, and that stayed unused in the slot",
+                            MakeTraceSourceAccessor(&NrMacSchedulerNs3::m_wastedResourcesTrace),
+                            "ns3::NrMacSchedulerNs3::WastedResourcesTracedCallback")
+            .AddTraceSource("OllaUpdate",
+                            "Offset of the OLLA of a UE, and BLER of its first transmissions, "
+                            "after each HARQ feedback of a first transmission",
+                            MakeTraceSourceAccessor(&NrMacSchedulerNs3::m_ollaTrace),
+                            "ns3::NrMacSchedulerNs3::OllaTracedCallback")
+            .AddTraceSource(
+                "ConfiguredGrantAdded",
+                "A configured grant added to a UE",
+                MakeTraceSourceAccessor(&NrMacSchedulerNs3::m_configuredGrantAddedTrace),
+                "ns3::NrMacSchedulerNs3::ConfiguredGrantAddedTracedCallback")
+            .AddTraceSource(
+                "ConfiguredGrantRemoved",
+                "The configured grants of a UE removed in a direction",
+                MakeTraceSourceAccessor(&NrMacSchedulerNs3::m_configuredGrantRemovedTrace),
+                "ns3::NrMacSchedulerNs3::ConfiguredGrantRemovedTracedCallback");
 
     return tid;
 }
@@ -226,6 +297,109 @@ NrMacSchedulerNs3::DoSchedDlRachInfoReq(
     m_rachList = params.m_rachList;
 }
 
+/**
+ * \brief Schedule a DL mini-slot of the current slot
+ * \param params the mini-slot opportunity
+ *
+ * The mini-slot serves the delay-critical GBR LC whose head of line delay is
+ * the highest, among the UEs with a free DL HARQ process. The first symbol of
+ * the mini-slot carries the DCI, and the data fills the other symbols over
+ * the entire band (except the notched RBGs), with the MCS of the UE. The
+ * allocation is sent to the MAC immediately; the PHY preempts the allocations
+ * that overlap the mini-slot. Nothing is sent if no UE needs the mini-slot.
+ */
+void
+NrMacSchedulerNs3::DoSchedDlMiniSlotReq(
+    const NrMacSchedSapProvider::SchedDlMiniSlotReqParameters& params)
+{
+    NS_LOG_FUNCTION(this << params.m_snfSf << +params.m_symStart << +params.m_numSym);
+    NS_ASSERT(params.m_numSym >= 2);
+
+    std::shared_ptr<NrMacSchedulerUeInfo> ue;
+    uint8_t lcgId = 0;
+    uint8_t lcId = 0;
+    uint16_t maxHolDelay = 0;
+    for (const auto& rnti : m_miniSlotUes)
+    {
+        const auto& candidate = m_ueMap.at(rnti);
+        if (!candidate->m_dlHarq.CanInsert())
+        {
+            continue;
+        }
+        for (const auto& lcg : candidate->m_dlLCG)
+        {
+            for (const auto& id : lcg.second->GetActiveLCIds())
+            {
+                const auto& lc = lcg.second->GetLC(id);
+                if (lc->m_resourceType == LogicalChannelConfigListElement_s::QBT_DGBR &&
+                    (ue == nullptr || lc->m_rlcTransmissionQueueHolDelay > maxHolDelay))
+                {
+                    ue = candidate;
+                    lcgId = lcg.first;
+                    lcId = id;
+                    maxHolDelay = lc->m_rlcTransmissionQueueHolDelay;
+                }
+            }
+        }
+    }
+    if (ue == nullptr)
+    {
+        NS_LOG_INFO("No delay-critical data for the mini-slot at symbol " << +params.m_symStart);
+        return;
+    }
+
+    std::vector<uint8_t> rbgBitmask = m_dlNotchedRbgsMask.empty()
+                                          ? std::vector<uint8_t>(GetBandwidthInRbg(), 1)
+                                          : m_dlNotchedRbgsMask;
+    const uint32_t numRbg = std::count(rbgBitmask.begin(), rbgBitmask.end(), 1);
+    const uint8_t numSym = params.m_numSym - 1;
+    const uint8_t mcs = ue->m_dlMcs.at(0);
+    const uint32_t tbs = m_dlAmc->CalculateTbSize(mcs, numRbg * numSym * GetNumRbPerRbg());
+    if (tbs < 7)
+    {
+        NS_LOG_INFO("The mini-slot at symbol " << +params.m_symStart << " is too small for UE "
+                                               << ue->m_rnti << ", tbs " << tbs);
+        return;
+    }
+
+    auto dci = m_dciPool.Create(ue->m_rnti,
+                                DciInfoElementTdma::DL,
+                                params.m_symStart + 1,
+                                numSym,
+                                std::vector<uint8_t>{mcs},
+                                std::vector<uint32_t>{tbs},
+                                std::vector<uint8_t>{1},
+                                std::vector<uint8_t>{0},
+                                DciInfoElementTdma::DATA,
+                                GetBwpId(),
+                                GetTpc());
+    dci->m_rbgBitmask = std::move(rbgBitmask);
+    dci->m_miniSlot = true;
+
+    // Consider the subPdu overhead
+    std::vector<RlcPduInfo> rlcPduInfo{RlcPduInfo(lcId, tbs - 3)};
+    ue->m_dlLCG.at(lcgId)->AssignedData(lcId, tbs - 3, "DL");
+
+    uint8_t harqId = 0;
+    HarqProcess process(true, HarqProcess::WAITING_FEEDBACK, 0, dci);
+    process.m_rlcPduInfo.push_back(rlcPduInfo);
+    ue->m_dlHarq.Insert(&harqId, process);
+    dci->m_harqProcess = harqId;
+    m_dlHarqActiveUes.insert(ue->m_rnti);
+
+    NS_LOG_INFO("UE " << ue->m_rnti << " gets the mini-slot at symbol " << +params.m_symStart
+                      << " for LC " << +lcId << ", head of line delay " << maxHolDelay
+                      << " ms, tbs " << tbs << " harqId " << +harqId);
+
+    NrMacSchedSapUser::SchedConfigIndParameters miniSlot(params.m_snfSf);
+    miniSlot.m_slotAllocInfo.m_type = SlotAllocInfo::DL;
+    miniSlot.m_slotAllocInfo.m_numSymAlloc = numSym;
+    VarTtiAllocInfo slotInfo(dci);
+    slotInfo.m_rlcPduInfo.push_back(rlcPduInfo);
+    miniSlot.m_slotAllocInfo.m_varTtiAllocInfo.emplace_back(slotInfo);
+    m_macSchedSapUser->SchedConfigInd(std::move(miniSlot));
+}
+
 void
 NrMacSchedulerNs3::SetCqiTimerThreshold(const Time& v)
 {
@@ -486,6 +660,34 @@ NrMacSchedulerNs3::GetUlCtrlSyms() const
     return m_ulCtrlSymbols;
 }
 
+uint64_t
+NrMacSchedulerNs3::GetDlBufferSize() const
+{
+    uint64_t bytes = 0;
+    for (const auto& ue : m_ueMap)
+    {
+        for (const auto& lcg : ue.second->m_dlLCG)
+        {
+            bytes += lcg.second->GetTotalSize();
+        }
+    }
+    return bytes;
+}
+
+uint64_t
+NrMacSchedulerNs3::GetUlBufferSize() const
+{
+    uint64_t bytes = 0;
+    for (const auto& ue : m_ueMap)
+    {
+        for (const auto& lcg : ue.second->m_ulLCG)
+        {
+            bytes += lcg.second->GetTotalSize();
+        }
+    }
+    return bytes;
+}
+
 /**
  * \brief Cell configuration
  * \param params unused.
@@ -513,7 +715,8 @@ NrMacSchedulerNs3::DoCschedCellConfigReq(
  * If the UE is not registered, then create its representation with a call to
  * CreateUeRepresentation, and then save its pointer in the m_ueMap map.
  *
- * If the UE is registered, update its corresponding beam.
+ * If the UE is registered, update its corresponding beam (in its compact
+ * record, if it has only that).
  */
 void
 NrMacSchedulerNs3::DoCschedUeConfigReq(
@@ -522,28 +725,54 @@ NrMacSchedulerNs3::DoCschedUeConfigReq(
     NS_LOG_FUNCTION(this << " RNTI " << params.m_rnti << " txMode "
                          << static_cast<uint32_t>(params.m_transmissionMode));
 
+    if (IsParked(params.m_rnti))
+    {
+        NS_LOG_LOGIC("Updating Beam for idle UE " << params.m_rnti << " beam "
+                                                  << params.m_beamConfId);
+        m_compactUes.at(params.m_rnti).m_beam = GetCompactBeamIndex(params.m_beamConfId);
+        return;
+    }
+
     auto itUe = m_ueMap.find(params.m_rnti);
     GetSecond UeInfoOf;
     if (itUe == m_ueMap.end())
     {
-        itUe = m_ueMap.insert(std::make_pair(params.m_rnti, CreateUeRepresentation(params))).first;
+        itUe = m_ueMap.insert(std::make_pair(params.m_rnti, NewUeRepresentation(params))).first;
+        m_cqiManagement.AddUe(params.m_rnti);
 
-        UeInfoOf(*itUe)->m_dlHarq.SetMaxSize(
-            static_cast<uint8_t>(m_macSchedSapUser->GetNumHarqProcess()));
-        UeInfoOf(*itUe)->m_ulHarq.SetMaxSize(
-            static_cast<uint8_t>(m_macSchedSapUser->GetNumHarqProcess()));
-        UeInfoOf(*itUe)->m_dlMcs.push_back(m_startMcsDl);
-        UeInfoOf(*itUe)->m_startMcsDlUe = m_startMcsDl;
-        UeInfoOf(*itUe)->m_dlCqi.m_ri = 1;
-        UeInfoOf(*itUe)->m_ulMcs = m_startMcsUl;
+        if (m_compactIdleUes)
+        {
+            if (m_compactUes.size() <= params.m_rnti)
+            {
+                m_compactUes.resize(params.m_rnti + 1);
+            }
+            m_compactUes.at(params.m_rnti) = CompactUe();
+        }
 
         NrMacSchedulerSrs::SrsPeriodicityAndOffset srs = m_schedulerSrs->AddUe();
 
         if (!srs.m_isValid)
         {
-            bool ret = m_schedulerSrs->IncreasePeriodicity(
-                &m_ueMap); // The new UE will get the SRS offset/periodicity here
-            NS_ASSERT(ret);
+            // The new UE will get the SRS offset/periodicity here
+            if (m_schedulerSrs->IncreasePeriodicity(&m_ueMap))
+            {
+                // The UEs with only their record get their new offset as well
+                for (auto& record : m_compactUes)
+                {
+                    if ((record.m_flags & CompactUe::PARKED) != 0)
+                    {
+                        srs = m_schedulerSrs->AddUe();
+                        NS_ASSERT(srs.m_isValid);
+                        record.m_srsPeriodicity = static_cast<uint16_t>(srs.m_periodicity);
+                        record.m_srsOffset = static_cast<uint16_t>(srs.m_offset);
+                    }
+                }
+            }
+            else
+            {
+                NS_LOG_WARN("No SRS offset left for UE " << params.m_rnti
+                                                         << ": it will not transmit SRS");
+            }
         }
         else
         {
@@ -576,11 +805,26 @@ NrMacSchedulerNs3::DoCschedUeReleaseReq(
 {
     NS_LOG_FUNCTION(this << " Release RNTI " << params.m_rnti);
 
+    UnparkUe(params.m_rnti);
     auto itUe = m_ueMap.find(params.m_rnti);
     NS_ABORT_IF(itUe == m_ueMap.end());
 
-    m_schedulerSrs->RemoveUe(itUe->second->m_srsOffset);
+    if (itUe->second->m_srsPeriodicity > 0)
+    {
+        m_schedulerSrs->RemoveUe(itUe->second->m_srsOffset);
+    }
     m_ueMap.erase(itUe);
+    m_dlActiveUeCandidates.erase(params.m_rnti);
+    m_ulActiveUeCandidates.erase(params.m_rnti);
+    m_dlHarqActiveUes.erase(params.m_rnti);
+    m_ulHarqActiveUes.erase(params.m_rnti);
+    m_configuredGrantUes.erase(params.m_rnti);
+    m_miniSlotUes.erase(params.m_rnti);
+    m_cqiManagement.RemoveUe(params.m_rnti);
+    if (m_compactIdleUes)
+    {
+        m_compactUes.at(params.m_rnti) = CompactUe();
+    }
 
     // When it will be the case of reducing the periodicity? Question for the
     // future...
@@ -588,6 +832,439 @@ NrMacSchedulerNs3::DoCschedUeReleaseReq(
     NS_LOG_INFO("Release RNTI " << params.m_rnti);
 }
 
+/**
+ * \brief Create and initialize the representation of a UE
+ * \param params the configuration of the UE
+ * \return the representation, created by CreateUeRepresentation(), with the
+ * HARQ processes and the starting MCS
+ */
+UePtr
+NrMacSchedulerNs3::NewUeRepresentation(
+    const NrMacCschedSapProvider::CschedUeConfigReqParameters& params) const
+{
+    UePtr ue = CreateUeRepresentation(params);
+    ue->m_dlHarq.SetMaxSize(static_cast<uint8_t>(m_macSchedSapUser->GetNumHarqProcess()));
+    ue->m_ulHarq.SetMaxSize(static_cast<uint8_t>(m_macSchedSapUser->GetNumHarqProcess()));
+    ue->m_dlMcs.push_back(m_startMcsDl);
+    ue->m_startMcsDlUe = m_startMcsDl;
+    ue->m_dlCqi.m_ri = 1;
+    ue->m_ulMcs = m_startMcsUl;
+    return ue;
+}
+
+bool
+NrMacSchedulerNs3::IsParked(uint16_t rnti) const
+{
+    return rnti < m_compactUes.size() && (m_compactUes[rnti].m_flags & CompactUe::PARKED) != 0;
+}
+
+/**
+ * \brief Check if the representation of a UE can be replaced by its record
+ * \param ue the UE
+ * \return true if the UE is idle
+ *
+ * The UE must not have anything to transmit or to retransmit, nor anything
+ * that the scheduler looks up by RNTI at every slot (configured grants,
+ * mini-slots, SR). Its CQI must be representable by the record: WB, of a
+ * single stream.
+ */
+bool
+NrMacSchedulerNs3::IsIdle(const UePtr& ue) const
+{
+    if (ue->m_dlHarq.Size() > 0 || ue->m_ulHarq.Size() > 0 ||
+        m_configuredGrantUes.count(ue->m_rnti) > 0 || m_miniSlotUes.count(ue->m_rnti) > 0 ||
+        std::find(m_srList.begin(), m_srList.end(), ue->m_rnti) != m_srList.end())
+    {
+        return false;
+    }
+    for (const auto& lcgs : {&ue->m_dlLCG, &ue->m_ulLCG})
+    {
+        for (const auto& lcg : *lcgs)
+        {
+            if (lcg.second->GetTotalSize() > 0)
+            {
+                return false;
+            }
+        }
+    }
+    return ue->m_dlCqi.m_cqiType == NrMacSchedulerUeInfo::DlCqiInfo::WB &&
+           ue->m_dlCqi.m_ri <= 1 && ue->m_dlCqi.m_wbCqi.size() <= 1 &&
+           ue->m_dlMcs.size() == 1 && ue->m_dlTbSize.size() == 1;
+}
+
+/**
+ * \brief Replace the representation of the idle UEs with their compact record
+ *
+ * Called at the end of each DL slot: only the UEs with a representation are
+ * visited, so the cost depends on the UEs that were recently active.
+ */
+void
+NrMacSchedulerNs3::ParkIdleUes()
+{
+    if (!m_compactIdleUes || m_ollaEnabled)
+    {
+        return;
+    }
+    NS_LOG_FUNCTION(this);
+
+    for (auto it = m_ueMap.begin(); it != m_ueMap.end(); /* no incr */)
+    {
+        const UePtr& ue = it->second;
+        if (!IsIdle(ue))
+        {
+            ++it;
+            continue;
+        }
+
+        CompactUe& record = m_compactUes.at(ue->m_rnti);
+        record.m_beam = GetCompactBeamIndex(ue->m_beamConfId);
+        record.m_srsPeriodicity = static_cast<uint16_t>(ue->m_srsPeriodicity);
+        record.m_srsOffset = static_cast<uint16_t>(ue->m_srsOffset);
+        StoreCompactUe(ue, &record);
+        record.m_flags |= CompactUe::PARKED;
+
+        m_dlActiveUeCandidates.erase(ue->m_rnti);
+        m_ulActiveUeCandidates.erase(ue->m_rnti);
+        m_dlHarqActiveUes.erase(ue->m_rnti);
+        m_ulHarqActiveUes.erase(ue->m_rnti);
+        NS_LOG_INFO("UE " << ue->m_rnti << " is idle, only its record is kept");
+        it = m_ueMap.erase(it);
+    }
+}
+
+/**
+ * \brief Create again the representation of a UE from its compact record
+ * \param rnti the UE
+ *
+ * The UE gets a new representation, with its LCs (empty) and its HARQ
+ * processes (inactive), and the beam, SRS, CQI and MCS of its record. Nothing
+ * is done if the UE has already a representation.
+ */
+void
+NrMacSchedulerNs3::UnparkUe(uint16_t rnti)
+{
+    if (!IsParked(rnti))
+    {
+        return;
+    }
+    NS_LOG_FUNCTION(this << rnti);
+
+    CompactUe& record = m_compactUes.at(rnti);
+    NrMacCschedSapProvider::CschedUeConfigReqParameters params{};
+    params.m_rnti = rnti;
+    params.m_beamConfId = m_compactBeams.at(record.m_beam);
+
+    UePtr ue = NewUeRepresentation(params);
+    ue->m_srsPeriodicity = record.m_srsPeriodicity;
+    ue->m_srsOffset = record.m_srsOffset;
+    AddLcs(ue, m_compactLcConfigs.at(record.m_lcConfig));
+    LoadCompactUe(record, ue);
+    record.m_flags &= ~CompactUe::PARKED;
+
+    NS_LOG_INFO("UE " << rnti << " is not idle anymore, its representation is created again");
+    m_ueMap.emplace(rnti, std::move(ue));
+}
+
+void
+NrMacSchedulerNs3::LoadCompactUe(const CompactUe& record, const UePtr& ue) const
+{
+    const bool hasWbCqi = (record.m_flags & CompactUe::DL_WB_CQI) != 0;
+    ue->m_dlCqi.m_cqiType = NrMacSchedulerUeInfo::DlCqiInfo::WB;
+    ue->m_dlCqi.m_ri = record.m_dlRi;
+    ue->m_dlCqi.m_wbCqi.assign(hasWbCqi ? 1 : 0, record.m_dlWbCqi);
+    ue->m_dlCqi.m_timer =
+        (record.m_flags & CompactUe::DL_CQI_VALID) != 0 ? GetCqiExpirationTime() : 0;
+    ue->m_dlCqiMcs.assign(hasWbCqi ? 1 : 0, record.m_dlCqiMcs);
+    ue->m_dlMcs.assign(1, record.m_dlMcs);
+    ue->m_dlRbgMcs.clear();
+    ue->m_dlSbMcs.clear();
+
+    ue->m_ulCqi.m_cqiType = (record.m_flags & CompactUe::UL_CQI_SB) != 0
+                                ? NrMacSchedulerUeInfo::CqiInfo::SB
+                                : NrMacSchedulerUeInfo::CqiInfo::WB;
+    ue->m_ulCqi.m_cqi = record.m_ulCqi;
+    ue->m_ulCqi.m_timer =
+        (record.m_flags & CompactUe::UL_CQI_VALID) != 0 ? GetCqiExpirationTime() : 0;
+    ue->m_ulCqi.m_sinr.clear();
+    ue->m_ulCqiMcs = record.m_ulCqiMcs;
+    ue->m_ulMcs = record.m_ulMcs;
+}
+
+void
+NrMacSchedulerNs3::StoreCompactUe(const UePtr& ue, CompactUe* record)
+{
+    NS_ASSERT(ue->m_dlMcs.size() == 1 && ue->m_dlCqi.m_wbCqi.size() <= 1);
+    const bool hasWbCqi = !ue->m_dlCqi.m_wbCqi.empty();
+    record->m_dlRi = ue->m_dlCqi.m_ri;
+    record->m_dlWbCqi = hasWbCqi ? ue->m_dlCqi.m_wbCqi.front() : 0;
+    record->m_dlCqiMcs = hasWbCqi ? ue->m_dlCqiMcs.front() : 0;
+    record->m_dlMcs = ue->m_dlMcs.front();
+    record->m_ulCqi = ue->m_ulCqi.m_cqi;
+    record->m_ulCqiMcs = ue->m_ulCqiMcs;
+    record->m_ulMcs = ue->m_ulMcs;
+
+    record->m_flags &= CompactUe::PARKED;
+    if (hasWbCqi)
+    {
+        record->m_flags |= CompactUe::DL_WB_CQI;
+    }
+    if (ue->m_dlCqi.m_timer > 0)
+    {
+        record->m_flags |= CompactUe::DL_CQI_VALID;
+    }
+    if (ue->m_ulCqi.m_timer > 0)
+    {
+        record->m_flags |= CompactUe::UL_CQI_VALID;
+    }
+    if (ue->m_ulCqi.m_cqiType == NrMacSchedulerUeInfo::CqiInfo::SB)
+    {
+        record->m_flags |= CompactUe::UL_CQI_SB;
+    }
+}
+
+const UePtr&
+NrMacSchedulerNs3::LoadCompactScratch(uint16_t rnti)
+{
+    NS_ASSERT(IsParked(rnti));
+    if (m_compactScratch == nullptr)
+    {
+        NrMacCschedSapProvider::CschedUeConfigReqParameters params{};
+        params.m_rnti = rnti;
+        m_compactScratch = NewUeRepresentation(params);
+    }
+    m_compactScratch->m_rnti = rnti;
+    LoadCompactUe(m_compactUes.at(rnti), m_compactScratch);
+    return m_compactScratch;
+}
+
+uint16_t
+NrMacSchedulerNs3::GetCompactBeamIndex(const BeamConfId& beamConfId)
+{
+    auto it = m_compactBeamIndex.find(beamConfId);
+    if (it == m_compactBeamIndex.end())
+    {
+        NS_ABORT_MSG_IF(m_compactBeams.size() > UINT16_MAX, "Too many beams for the records");
+        it = m_compactBeamIndex.emplace(beamConfId, static_cast<uint16_t>(m_compactBeams.size()))
+                 .first;
+        m_compactBeams.push_back(beamConfId);
+    }
+    return it->second;
+}
+
+uint16_t
+NrMacSchedulerNs3::GetCompactLcConfigIndex(
+    const std::vector<LogicalChannelConfigListElement_s>& configs)
+{
+    auto fields = [](const LogicalChannelConfigListElement_s& lc) {
+        return std::tie(lc.m_logicalChannelIdentity,
+                        lc.m_logicalChannelGroup,
+                        lc.m_direction,
+                        lc.m_qosBearerType,
+                        lc.m_qci,
+                        lc.m_eRabMaximulBitrateUl,
+                        lc.m_eRabMaximulBitrateDl,
+                        lc.m_eRabGuaranteedBitrateUl,
+                        lc.m_eRabGuaranteedBitrateDl);
+    };
+    auto equal = [&fields](const LogicalChannelConfigListElement_s& a,
+                           const LogicalChannelConfigListElement_s& b) {
+        return fields(a) == fields(b);
+    };
+
+    // The UEs of a scenario share a handful of LC configurations
+    for (std::size_t i = 0; i < m_compactLcConfigs.size(); ++i)
+    {
+        const auto& known = m_compactLcConfigs.at(i);
+        if (known.size() == configs.size() &&
+            std::equal(known.begin(), known.end(), configs.begin(), equal))
+        {
+            return static_cast<uint16_t>(i);
+        }
+    }
+    NS_ABORT_MSG_IF(m_compactLcConfigs.size() > UINT16_MAX,
+                    "Too many LC configurations for the records");
+    m_compactLcConfigs.push_back(configs);
+    return static_cast<uint16_t>(m_compactLcConfigs.size() - 1);
+}
+
+uint32_t
+NrMacSchedulerNs3::GetCqiExpirationTime() const
+{
+    return static_cast<uint32_t>(m_cqiTimersThreshold.GetNanoSeconds() /
+                                 m_macSchedSapUser->GetSlotPeriod().GetNanoSeconds());
+}
+
+const NrMacSchedulerDciPool&
+NrMacSchedulerNs3::GetDciPool() const
+{
+    return m_dciPool;
+}
+
+const NrMacSchedulerProfiler&
+NrMacSchedulerNs3::GetProfiler() const
+{
+    return m_profiler;
+}
+
+std::size_t
+NrMacSchedulerNs3::GetNumUeRepresentations() const
+{
+    return m_ueMap.size();
+}
+
+void
+NrMacSchedulerNs3::SetCompactIdleUes(bool compact)
+{
+    NS_LOG_FUNCTION(this << compact);
+    NS_ABORT_MSG_IF(!m_ueMap.empty(), "The UEs are already configured");
+    m_compactIdleUes = compact;
+    // The index 0 is the configuration of a UE without LC
+    m_compactLcConfigs.assign(1, {});
+}
+
+bool
+NrMacSchedulerNs3::IsCompactIdleUes() const
+{
+    return m_compactIdleUes;
+}
+
+void
+NrMacSchedulerNs3::AddConfiguredGrant(uint16_t rnti, const NrConfiguredGrant& grant)
+{
+    NS_LOG_FUNCTION(this << rnti);
+
+    UnparkUe(rnti);
+    auto itUe = m_ueMap.find(rnti);
+    NS_ABORT_MSG_IF(itUe == m_ueMap.end(), "UE " << rnti << " not found");
+    NS_ABORT_MSG_IF(grant.m_periodicity == 0 || grant.m_offset >= grant.m_periodicity,
+                    "Configured grant with periodicity " << grant.m_periodicity << " and offset "
+                                                         << grant.m_offset);
+    NS_ABORT_MSG_IF(grant.m_numSym == 0 ||
+                        grant.m_symStart + grant.m_numSym > m_macSchedSapUser->GetSymbolsPerSlot(),
+                    "Configured grant from symbol " << +grant.m_symStart << " for "
+                                                    << +grant.m_numSym << " symbols");
+
+    NrMacSchedulerUeInfo::ConfiguredGrant configuredGrant;
+    configuredGrant.m_config = grant;
+    itUe->second->m_configuredGrants.push_back(configuredGrant);
+    m_configuredGrantUes.insert(rnti);
+    m_configuredGrantAddedTrace(rnti, grant);
+
+    NS_LOG_INFO("UE " << rnti << " has a "
+                      << (grant.m_format == DciInfoElementTdma::DL ? "DL" : "UL")
+                      << " configured grant every " << grant.m_periodicity << " slots");
+}
+
+void
+NrMacSchedulerNs3::RemoveConfiguredGrant(uint16_t rnti, DciInfoElementTdma::DciFormat format)
+{
+    NS_LOG_FUNCTION(this << rnti);
+
+    UnparkUe(rnti);
+    auto itUe = m_ueMap.find(rnti);
+    NS_ABORT_MSG_IF(itUe == m_ueMap.end(), "UE " << rnti << " not found");
+    auto& ue = itUe->second;
+
+    for (auto& grant : ue->m_configuredGrants)
+    {
+        if (grant.m_config.m_format != format)
+        {
+            continue;
+        }
+        grant.m_release = true;
+        if (!grant.m_active && grant.m_harqId != 255)
+        {
+            // Never signalled to the UE: the process is released at once
+            auto& harq = format == DciInfoElementTdma::DL ? ue->m_dlHarq : ue->m_ulHarq;
+            harq.Release(grant.m_harqId);
+            grant.m_harqId = 255;
+        }
+    }
+    EraseReleasedConfiguredGrants({rnti});
+    m_configuredGrantRemovedTrace(rnti, format);
+
+    NS_LOG_INFO("UE " << rnti << " removes its "
+                      << (format == DciInfoElementTdma::DL ? "DL" : "UL") << " configured grants");
+}
+
+/**
+ * \brief Erase the removed configured grants that are no more active
+ * \param rntis the UEs to check
+ *
+ * A UE without configured grants left is removed from m_configuredGrantUes.
+ */
+void
+NrMacSchedulerNs3::EraseReleasedConfiguredGrants(const std::set<uint16_t>& rntis)
+{
+    NS_LOG_FUNCTION(this);
+
+    for (const auto& rnti : rntis)
+    {
+        auto& grants = m_ueMap.at(rnti)->m_configuredGrants;
+        grants.erase(std::remove_if(grants.begin(),
+                                    grants.end(),
+                                    [](const NrMacSchedulerUeInfo::ConfiguredGrant& grant) {
+                                        return grant.m_release && !grant.m_active;
+                                    }),
+                     grants.end());
+        if (grants.empty())
+        {
+            m_configuredGrantUes.erase(rnti);
+        }
+    }
+}
+
+/**
+ * \brief Create the DCI that releases an active configured grant
+ * \param rnti the RNTI of the UE
+ * \param grant the grant
+ * \return the DCI, in the symbols of the grant, without data and without HARQ process
+ * to wait for
+ */
+std::shared_ptr<DciInfoElementTdma>
+NrMacSchedulerNs3::CreateConfiguredGrantRelease(
+    uint16_t rnti,
+    const NrMacSchedulerUeInfo::ConfiguredGrant& grant) const
+{
+    const auto& config = grant.m_config;
+    auto dci = m_dciPool.Create(rnti,
+                                config.m_format,
+                                config.m_symStart,
+                                config.m_numSym,
+                                std::vector<uint8_t>{config.m_mcs},
+                                std::vector<uint32_t>{0},
+                                std::vector<uint8_t>{0},
+                                std::vector<uint8_t>{0},
+                                DciInfoElementTdma::DATA,
+                                GetBwpId(),
+                                GetTpc());
+    dci->m_rbgBitmask = std::vector<uint8_t>(GetBandwidthInRbg(), 1);
+    dci->m_harqProcess = grant.m_harqId;
+    dci->m_cgPeriodicity = config.m_periodicity;
+    dci->m_cgRelease = true;
+
+    NS_LOG_INFO("UE " << rnti << " gets the release DCI of its "
+                      << (config.m_format == DciInfoElementTdma::DL ? "DL" : "UL")
+                      << " configured grant, harqId " << +grant.m_harqId);
+    return dci;
+}
+
+void
+NrMacSchedulerNs3::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+#ifdef NR_SCHEDULER_PROFILING
+    if (m_profiler.GetNumSlots(NrMacSchedulerProfiler::DL) +
+            m_profiler.GetNumSlots(NrMacSchedulerProfiler::UL) >
+        0)
+    {
+        std::clog << "Cell " << GetCellId() << " BWP " << GetBwpId() << ", ";
+        m_profiler.Print(std::clog);
+    }
+#endif
+    NrMacScheduler::DoDispose();
+}
+
 uint64_t
 NrMacSchedulerNs3::GetNumRbPerRbg() const
 {
@@ -646,50 +1323,77 @@ NrMacSchedulerNs3::DoCschedLcConfigReq(
     const NrMacCschedSapProvider::CschedLcConfigReqParameters& params)
 {
     NS_LOG_FUNCTION(this << static_cast<uint32_t>(params.m_rnti));
+    UnparkUe(params.m_rnti);
     auto itUe = m_ueMap.find(params.m_rnti);
-    GetSecond UeInfoOf;
     NS_ABORT_IF(itUe == m_ueMap.end());
 
-    for (const auto& lcConfig : params.m_logicalChannelConfigList)
+    AddLcs(itUe->second, params.m_logicalChannelConfigList);
+
+    if (m_compactIdleUes)
+    {
+        // The record keeps all the LCs configured so far, to create them again
+        CompactUe& record = m_compactUes.at(params.m_rnti);
+        std::vector<LogicalChannelConfigListElement_s> configs =
+            m_compactLcConfigs.at(record.m_lcConfig);
+        configs.insert(configs.end(),
+                       params.m_logicalChannelConfigList.begin(),
+                       params.m_logicalChannelConfigList.end());
+        record.m_lcConfig = GetCompactLcConfigIndex(configs);
+    }
+}
+
+/**
+ * \brief Create the LCs of a UE
+ * \param ue the UE
+ * \param configs the configuration of the LCs
+ *
+ * See DoCschedLcConfigReq(); it is also used to create again the LCs of a UE
+ * that had only its compact record.
+ */
+void
+NrMacSchedulerNs3::AddLcs(const UePtr& ue,
+                          const std::vector<LogicalChannelConfigListElement_s>& configs)
+{
+    for (const auto& lcConfig : configs)
     {
         if (lcConfig.m_direction == LogicalChannelConfigListElement_s::DIR_DL ||
             lcConfig.m_direction == LogicalChannelConfigListElement_s::DIR_BOTH)
         {
-            auto itDl = UeInfoOf(*itUe)->m_dlLCG.find(lcConfig.m_logicalChannelGroup);
-            auto itDlEnd = UeInfoOf(*itUe)->m_dlLCG.end();
+            auto itDl = ue->m_dlLCG.find(lcConfig.m_logicalChannelGroup);
+            auto itDlEnd = ue->m_dlLCG.end();
             if (itDl == itDlEnd)
             {
                 NS_LOG_DEBUG("Created DL LCG for UE "
-                             << UeInfoOf(*itUe)->m_rnti
+                             << ue->m_rnti
                              << " ID=" << static_cast<uint32_t>(lcConfig.m_logicalChannelGroup));
                 std::unique_ptr<NrMacSchedulerLCG> lcg = CreateLCG(lcConfig);
-                itDl = UeInfoOf(*itUe)
-                           ->m_dlLCG
-                           .emplace(std::make_pair(lcConfig.m_logicalChannelGroup, std::move(lcg)))
-                           .first;
+                itDl = ue->m_dlLCG.emplace(lcConfig.m_logicalChannelGroup, std::move(lcg)).first;
             }
 
             itDl->second->Insert(CreateLC(lcConfig));
             NS_LOG_DEBUG("Created DL LC for UE "
-                         << UeInfoOf(*itUe)->m_rnti
+                         << ue->m_rnti
                          << " ID=" << static_cast<uint32_t>(lcConfig.m_logicalChannelIdentity)
                          << " in LCG " << static_cast<uint32_t>(lcConfig.m_logicalChannelGroup));
+
+            if (itDl->second->GetLC(lcConfig.m_logicalChannelIdentity)->m_resourceType ==
+                LogicalChannelConfigListElement_s::QBT_DGBR)
+            {
+                m_miniSlotUes.insert(ue->m_rnti);
+            }
         }
         if (lcConfig.m_direction == LogicalChannelConfigListElement_s::DIR_UL ||
             lcConfig.m_direction == LogicalChannelConfigListElement_s::DIR_BOTH)
         {
-            auto itUl = UeInfoOf(*itUe)->m_ulLCG.find(lcConfig.m_logicalChannelGroup);
-            auto itUlEnd = UeInfoOf(*itUe)->m_ulLCG.end();
+            auto itUl = ue->m_ulLCG.find(lcConfig.m_logicalChannelGroup);
+            auto itUlEnd = ue->m_ulLCG.end();
             if (itUl == itUlEnd)
             {
                 NS_LOG_DEBUG("Created UL LCG for UE "
-                             << UeInfoOf(*itUe)->m_rnti
+                             << ue->m_rnti
                              << " ID=" << static_cast<uint32_t>(lcConfig.m_logicalChannelGroup));
                 std::unique_ptr<NrMacSchedulerLCG> lcg = CreateLCG(lcConfig);
-                itUl = UeInfoOf(*itUe)
-                           ->m_ulLCG
-                           .emplace(std::make_pair(lcConfig.m_logicalChannelGroup, std::move(lcg)))
-                           .first;
+                itUl = ue->m_ulLCG.emplace(lcConfig.m_logicalChannelGroup, std::move(lcg)).first;
             }
 
             // Create a LC ID only if it is the first. For detail, see documentation
@@ -698,7 +1402,7 @@ NrMacSchedulerNs3::DoCschedLcConfigReq(
             {
                 itUl->second->Insert(CreateLC(lcConfig));
                 NS_LOG_DEBUG("Created UL LC for UE "
-                             << UeInfoOf(*itUe)->m_rnti
+                             << ue->m_rnti
                              << " ID=" << static_cast<uint32_t>(lcConfig.m_logicalChannelIdentity)
                              << " in LCG "
                              << static_cast<uint32_t>(lcConfig.m_logicalChannelGroup));
@@ -719,6 +1423,7 @@ NrMacSchedulerNs3::DoCschedLcReleaseReq(
 {
     NS_LOG_FUNCTION(this);
 
+    UnparkUe(params.m_rnti);
     for ([[maybe_unused]] const auto& lcId : params.m_logicalChannelIdentity)
     {
         auto itUe = m_ueMap.find(params.m_rnti);
@@ -745,6 +1450,7 @@ NrMacSchedulerNs3::DoSchedDlRlcBufferReq(
                          << static_cast<uint32_t>(params.m_logicalChannelIdentity));
 
     GetSecond UeInfoOf;
+    UnparkUe(params.m_rnti);
     auto itUe = m_ueMap.find(params.m_rnti);
     NS_ABORT_IF(itUe == m_ueMap.end());
 
@@ -755,6 +1461,7 @@ NrMacSchedulerNs3::DoSchedDlRlcBufferReq(
             NS_LOG_INFO("Updating DL LC Info: " << params
                                                 << " in LCG: " << static_cast<uint32_t>(lcg.first));
             lcg.second->UpdateInfo(params);
+            m_dlActiveUeCandidates.insert(params.m_rnti);
             return;
         }
     }
@@ -776,7 +1483,19 @@ NrMacSchedulerNs3::BSRReceivedFromUe(const MacCeElement& bsr)
 {
     NS_LOG_FUNCTION(this);
     NS_ASSERT(bsr.m_macCeType == MacCeElement::BSR);
+
+    // An empty BSR does not change an idle UE
+    if (IsParked(bsr.m_rnti) &&
+        std::all_of(bsr.m_macCeValue.m_bufferStatus.begin(),
+                    bsr.m_macCeValue.m_bufferStatus.end(),
+                    [](uint8_t bsrId) { return NrMacShortBsrCe::FromLevelToBytes(bsrId) == 0; }))
+    {
+        NS_LOG_INFO("Empty BSR of idle UE " << bsr.m_rnti);
+        return;
+    }
+
     GetSecond UeInfoOf;
+    UnparkUe(bsr.m_rnti);
     auto itUe = m_ueMap.find(bsr.m_rnti);
     NS_ABORT_IF(itUe == m_ueMap.end());
 
@@ -804,6 +1523,7 @@ NrMacSchedulerNs3::BSRReceivedFromUe(const MacCeElement& bsr)
 
         itLcg->second->UpdateInfo(bufSize);
     }
+    m_ulActiveUeCandidates.insert(bsr.m_rnti);
 }
 
 /**
@@ -839,8 +1559,8 @@ NrMacSchedulerNs3::DoSchedUlMacCtrlInfoReq(
  * For each message in the list, calculate the expiration time in number of slots,
  * and then pass all the information to the NrMacSchedulerCQIManagement class.
  *
- * If the CQI is sub-band, the method NrMacSchedulerCQIManagement::SBCQIReported
- * will be called, otherwise NrMacSchedulerCQIManagement::WBCQIReported.
+ * If the CQI is sub-band, the method NrMacSchedulerCQIManagement::DlSBCQIReported
+ * will be called, otherwise NrMacSchedulerCQIManagement::DlWBCQIReported.
  */
 void
 NrMacSchedulerNs3::DoSchedDlCqiInfoReq(
@@ -855,12 +1575,21 @@ NrMacSchedulerNs3::DoSchedDlCqiInfoReq(
 
     NS_ASSERT(m_cqiTimersThreshold >= m_macSchedSapUser->GetSlotPeriod());
 
-    uint32_t expirationTime =
-        static_cast<uint32_t>(m_cqiTimersThreshold.GetNanoSeconds() /
-                              m_macSchedSapUser->GetSlotPeriod().GetNanoSeconds());
+    uint32_t expirationTime = GetCqiExpirationTime();
 
     for (const auto& cqi : params.m_cqiList)
     {
+        if (IsParked(cqi.m_rnti) && cqi.m_cqiType == DlCqiInfo::WB && cqi.m_ri <= 1 &&
+            cqi.m_wbCqi.size() == 1)
+        {
+            // The WB CQI of a single stream fits in the record of an idle UE
+            const UePtr& scratch = LoadCompactScratch(cqi.m_rnti);
+            m_cqiManagement.DlWBCQIReported(cqi, scratch, expirationTime, m_maxDlMcs);
+            StoreCompactUe(scratch, &m_compactUes.at(cqi.m_rnti));
+            continue;
+        }
+
+        UnparkUe(cqi.m_rnti);
         NS_ASSERT(m_ueMap.find(cqi.m_rnti) != m_ueMap.end());
         const std::shared_ptr<NrMacSchedulerUeInfo>& ue = m_ueMap.find(cqi.m_rnti)->second;
 
@@ -870,7 +1599,12 @@ NrMacSchedulerNs3::DoSchedDlCqiInfoReq(
         }
         else
         {
-            m_cqiManagement.DlSBCQIReported(cqi, ue);
+            m_cqiManagement.DlSBCQIReported(cqi,
+                                            ue,
+                                            expirationTime,
+                                            m_maxDlMcs,
+                                            GetNumRbPerRbg(),
+                                            GetBandwidthInRbg());
         }
     }
 }
@@ -901,9 +1635,7 @@ NrMacSchedulerNs3::DoSchedUlCqiInfoReq(
 
     GetSecond UeInfoOf;
 
-    uint32_t expirationTime =
-        static_cast<uint32_t>(m_cqiTimersThreshold.GetNanoSeconds() /
-                              m_macSchedSapUser->GetSlotPeriod().GetNanoSeconds());
+    uint32_t expirationTime = GetCqiExpirationTime();
 
     switch (params.m_ulCqi.m_type)
     {
@@ -916,15 +1648,16 @@ NrMacSchedulerNs3::DoSchedUlCqiInfoReq(
                                            << " modified allocation " << ulSfnSf << " sym Start "
                                            << static_cast<uint32_t>(symStart));
 
-        auto itAlloc = m_ulAllocationMap.find(ulSfnSf.GetEncoding());
-        NS_ASSERT_MSG(itAlloc != m_ulAllocationMap.end(), "Can't find allocation for " << ulSfnSf);
-        std::vector<AllocElem>& ulAllocations = itAlloc->second.m_ulAllocations;
+        SlotElem* slotAlloc = m_ulAllocationMap.Find(ulSfnSf);
+        NS_ASSERT_MSG(slotAlloc != nullptr, "Can't find allocation for " << ulSfnSf);
+        std::vector<AllocElem>& ulAllocations = slotAlloc->m_ulAllocations;
 
         for (auto it = ulAllocations.cbegin(); it != ulAllocations.cend(); /* NO INC */)
         {
             const AllocElem& allocation = *(it);
             if (allocation.m_symStart == symStart)
             {
+                UnparkUe(allocation.m_rnti);
                 auto itUe = m_ueMap.find(allocation.m_rnti);
                 NS_ASSERT(itUe != m_ueMap.end());
                 NS_ASSERT(allocation.m_numSym > 0);
@@ -951,7 +1684,7 @@ NrMacSchedulerNs3::DoSchedUlCqiInfoReq(
         {
             // remove obsolete info on allocation; we already processed all the CQI
             NS_LOG_INFO("Removing allocation for " << ulSfnSf);
-            m_ulAllocationMap.erase(itAlloc);
+            m_ulAllocationMap.Erase(ulSfnSf);
         }
     }
     break;
@@ -1068,6 +1801,65 @@ NrMacSchedulerNs3::ProcessHARQFeedbacks(
     NS_ASSERT(harqInfo->size() == nackReceived);
 }
 
+/**
+ * \brief Update the OLLA of the UEs with the HARQ feedbacks
+ * \param harqInfo the HARQ feedbacks of the slot (UL or DL), before ProcessHARQFeedbacks
+ * \param GetHarqVectorFn Function to retrieve the correct Harq Vector
+ * \param format DL or UL
+ * \param sfnSf the current slot, for the trace
+ *
+ * Only the feedbacks of the first transmissions are considered, since the
+ * target BLER refers to them. A feedback that could not be retransmitted in
+ * a previous slot is merged again with the new ones: its process has already
+ * left the WAITING_FEEDBACK status, so it is not counted twice.
+ */
+template <typename T>
+void
+NrMacSchedulerNs3::ProcessOllaFeedbacks(
+    const std::vector<T>& harqInfo,
+    const NrMacSchedulerUeInfo::GetHarqVectorFn& GetHarqVectorFn,
+    DciInfoElementTdma::DciFormat format,
+    const SfnSf& sfnSf)
+{
+    NS_LOG_FUNCTION(this);
+    if (!m_ollaEnabled)
+    {
+        return;
+    }
+
+    for (const auto& feedback : harqInfo)
+    {
+        const std::shared_ptr<NrMacSchedulerUeInfo>& ue = m_ueMap.find(feedback.m_rnti)->second;
+        const HarqProcess& process = GetHarqVectorFn(ue).Get(feedback.m_harqProcessId);
+        if (process.m_status != HarqProcess::WAITING_FEEDBACK || process.m_dciElement == nullptr ||
+            *std::max_element(process.m_dciElement->m_rv.begin(),
+                              process.m_dciElement->m_rv.end()) > 0)
+        {
+            continue;
+        }
+
+        const bool ok = feedback.IsReceivedOk();
+        if (format == DciInfoElementTdma::DL)
+        {
+            m_cqiManagement.DlHarqFeedbackReceived(ue, ok, m_maxDlMcs);
+            m_ollaTrace(sfnSf,
+                        ue->m_rnti,
+                        format,
+                        ue->m_dlOlla.GetOffset(),
+                        ue->m_dlOlla.GetBler());
+        }
+        else
+        {
+            m_cqiManagement.UlHarqFeedbackReceived(ue, ok);
+            m_ollaTrace(sfnSf,
+                        ue->m_rnti,
+                        format,
+                        ue->m_ulOlla.GetOffset(),
+                        ue->m_ulOlla.GetBler());
+        }
+    }
+}
+
 /**
  * \brief Reset expired HARQ
  * \param rnti RNTI of the user
@@ -1138,11 +1930,7 @@ NrMacSchedulerNs3::PrependCtrlSym(uint8_t symStart,
     for (uint8_t sym = symStart; sym < symStart + numSymToAllocate; ++sym)
     {
         allocations->emplace_front(
-            VarTtiAllocInfo(std::make_shared<DciInfoElementTdma>(sym,
-                                                                 1,
-                                                                 mode,
-                                                                 DciInfoElementTdma::CTRL,
-                                                                 rbgBitmask)));
+            VarTtiAllocInfo(m_dciPool.Create(sym, 1, mode, DciInfoElementTdma::CTRL, rbgBitmask)));
         NS_LOG_INFO("Allocating CTRL symbol, type"
                     << mode << " in TDMA. numSym=1, symStart=" << static_cast<uint32_t>(sym)
                     << " Remaining CTRL sym to allocate: " << sym - symStart);
@@ -1176,11 +1964,7 @@ NrMacSchedulerNs3::AppendCtrlSym(uint8_t symStart,
     for (uint8_t sym = symStart; sym < symStart + numSymToAllocate; ++sym)
     {
         allocations->emplace_back(
-            VarTtiAllocInfo(std::make_shared<DciInfoElementTdma>(sym,
-                                                                 1,
-                                                                 mode,
-                                                                 DciInfoElementTdma::CTRL,
-                                                                 rbgBitmask)));
+            VarTtiAllocInfo(m_dciPool.Create(sym, 1, mode, DciInfoElementTdma::CTRL, rbgBitmask)));
         NS_LOG_INFO("Allocating CTRL symbol, type"
                     << mode << " in TDMA. numSym=1, symStart=" << static_cast<uint32_t>(sym)
                     << " Remaining CTRL sym to allocate: " << sym - symStart);
@@ -1277,24 +2061,30 @@ NrMacSchedulerNs3::ComputeActiveHarq(ActiveHarqMap* activeUlHarq,
  * \param activeDlUe map of active DL UE to be filled
  * \param GetLCGFn Function to retrieve the LCG of a UE
  * \param mode UL or DL (to be printed in debug messages)
+ * \param candidates RNTIs of the UEs that may have data, or nullptr to check all the UEs
  *
  * The function loops all available UEs and checks their LC. If one (or more)
  * LC contains bytes, they are marked active and inserted in one of the
  * list passed as input parameters. Every UE is marked as active if it has
  * data to transmit; it is a duty for someone else to not assign two DCI for
  * the same RNTI.
+ *
+ * When the candidates are given, only these UEs are checked, and the ones
+ * without data are removed from the candidates: they will be inserted again
+ * when new data for them is notified to the scheduler.
  */
 void
 NrMacSchedulerNs3::ComputeActiveUe(ActiveUeMap* activeUe,
                                    const NrMacSchedulerUeInfo::GetLCGFn& GetLCGFn,
                                    const NrMacSchedulerUeInfo::GetHarqVectorFn& GetHarqVector,
-                                   const std::string& mode) const
+                                   const std::string& mode,
+                                   std::set<uint16_t>* candidates) const
 {
     NS_LOG_FUNCTION(this);
-    for (const auto& ueInfo : m_ueMap)
-    {
+
+    // Insert the UE in the active map if it has data; return its buffered bytes
+    auto computeUe = [&](const UePtr& ue) {
         uint32_t totBuffer = 0;
-        const auto& ue = ueInfo.second;
 
         // compute total DL and UL bytes buffered
         for (const auto& lcgInfo : GetLCGFn(ue))
@@ -1309,7 +2099,7 @@ NrMacSchedulerNs3::ComputeActiveUe(ActiveUeMap* activeUe,
             totBuffer += lcg->GetTotalSize();
         }
 
-        auto harqV = GetHarqVector(ue);
+        const auto& harqV = GetHarqVector(ue);
 
         if (totBuffer > 0 && harqV.CanInsert())
         {
@@ -1325,7 +2115,43 @@ NrMacSchedulerNs3::ComputeActiveUe(ActiveUeMap* activeUe,
                 it->second.emplace_back(ue, totBuffer);
             }
         }
+        return totBuffer;
+    };
+
+    if (candidates == nullptr)
+    {
+        for (const auto& ueInfo : m_ueMap)
+        {
+            computeUe(ueInfo.second);
+        }
+        return;
+    }
+
+    for (auto it = candidates->begin(); it != candidates->end(); /* no incr */)
+    {
+        auto itUe = m_ueMap.find(*it);
+        if (itUe == m_ueMap.end() || computeUe(itUe->second) == 0)
+        {
+            it = candidates->erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+NrMacSchedulerNs3::BeamGroups
+NrMacSchedulerNs3::GetDlBeamGroups(const ActiveUeMap& activeDl) const
+{
+    NS_LOG_FUNCTION(this);
+    BeamGroups groups;
+    groups.reserve(activeDl.size());
+    for (const auto& beam : activeDl)
+    {
+        groups.push_back({beam.first});
     }
+    return groups;
 }
 
 /**
@@ -1357,7 +2183,10 @@ NrMacSchedulerNs3::ComputeActiveUe(ActiveUeMap* activeUe,
  * of RlcPduInfo.
  *
  * Before looping and changing the beam, the starting point should be advanced.
- * How that is done is a matter for the subclasses (method ChangeDlBeam).
+ * How that is done is a matter for the subclasses (method ChangeDlBeam). The
+ * beams are visited in the groups returned by GetDlBeamGroups(): the beams of
+ * a group are co-scheduled (MU-MIMO) and start from the same point, which is
+ * advanced once per group.
  */
 uint8_t
 NrMacSchedulerNs3::DoScheduleDlData(PointInFTPlane* spoint,
@@ -1367,192 +2196,228 @@ NrMacSchedulerNs3::DoScheduleDlData(PointInFTPlane* spoint,
 {
     NS_LOG_FUNCTION(this << symAvail);
     NS_ASSERT(spoint->m_rbg == 0);
-    BeamSymbolMap symPerBeam = AssignDLRBG(symAvail, activeDl);
-    GetFirst GetBeam;
-    uint8_t usedSym = 0;
-
-    for (const auto& beam : activeDl)
+    BeamSymbolMap symPerBeam;
     {
-        uint32_t availableRBG =
-            (GetBandwidthInRbg() - spoint->m_rbg) * symPerBeam.at(GetBeam(beam));
-        bool assigned = false;
-        std::unordered_set<uint8_t> symbStartDci;
-        // allocSym is used to count the number of allocated symbols to the UEs of the beam
-        // we are iterating over
-        uint32_t allocSym = 0;
-
-        NS_LOG_DEBUG(activeDl.size()
-                     << " active DL beam, this beam has " << symPerBeam.at(GetBeam(beam))
-                     << " SYM, starts from RB " << spoint->m_rbg << " and symbol "
-                     << static_cast<uint32_t>(spoint->m_sym) << " for a total of " << availableRBG
-                     << " RBG. In one symbol we have " << GetBandwidthInRbg() << " RBG.");
-
-        if (symPerBeam.at(GetBeam(beam)) == 0)
-        {
-            NS_LOG_INFO("No available symbols for this beam, continue");
-            continue;
-        }
-
-        for (const auto& ue : beam.second)
-        {
-            if (ue.first->m_dlRBG == 0)
-            {
-                NS_LOG_INFO("UE " << ue.first->m_rnti << " does not have RBG assigned");
-                continue;
-            }
-
-            std::shared_ptr<DciInfoElementTdma> dci =
-                CreateDlDci(spoint, ue.first, symPerBeam.at(GetBeam(beam)));
-            if (dci == nullptr)
-            {
-                // By continuing to the next UE means that we are
-                // wasting a resource assign to this UE. For a TDMA
-                // scheduler this resource would be one or more
-                // symbols, and for OFDMA scheduler it would be a
-                // chunk of time + freq, i.e., one or more
-                // symbols in time and one ore more RBG in freq.
-                // TODO To avoid this, a more accurate solution
-                // is needed to assign resources. That is, a solution
-                // that would not assign resources to a UE if the assigned resources
-                // result a TB size of less than 7 bytes (3 mac header, 2 rlc header, 2 data).
-                // Because if this happens CreateDlDci will not create DCI.
-                NS_LOG_DEBUG("No DCI has been created, ignoring");
-                ue.first->ResetDlMetric();
-                continue;
-            }
+        NR_SCHEDULER_PROFILE_PHASE(RBG);
+        symPerBeam = AssignDLRBG(symAvail, activeDl);
+    }
+    GetFirst GetBeam;
+    uint8_t usedSym = 0;
 
-            assigned = true;
+    for (const auto& group : GetDlBeamGroups(activeDl))
+    {
+        // The beams of a group are the layers of a MU-MIMO transmission: their
+        // DCIs start from the same point, which advances once for the group
+        const PointInFTPlane groupStart = *spoint;
+        bool groupAssigned = false;
+        uint32_t groupSym = 0;
 
-            if (symbStartDci.insert(dci->m_symStart).second)
+        for (uint8_t layer = 0; layer < group.size(); ++layer)
+        {
+            const auto& beam = *activeDl.find(group.at(layer));
+            *spoint = groupStart;
+
+            uint32_t availableRBG =
+                (GetBandwidthInRbg() - spoint->m_rbg) * symPerBeam.at(GetBeam(beam));
+            bool assigned = false;
+            std::unordered_set<uint8_t> symbStartDci;
+            // allocSym is used to count the number of allocated symbols to the UEs of the beam
+            // we are iterating over
+            uint32_t allocSym = 0;
+
+            NS_LOG_DEBUG(activeDl.size()
+                         << " active DL beam, this beam has " << symPerBeam.at(GetBeam(beam))
+                         << " SYM, starts from RB " << spoint->m_rbg << " and symbol "
+                         << static_cast<uint32_t>(spoint->m_sym) << " for a total of "
+                         << availableRBG << " RBG. In one symbol we have " << GetBandwidthInRbg()
+                         << " RBG.");
+
+            if (symPerBeam.at(GetBeam(beam)) == 0)
             {
-                allocSym += dci->m_numSym;
+                NS_LOG_INFO("No available symbols for this beam, continue");
+                continue;
             }
 
-            NS_LOG_INFO("UE " << ue.first->m_rnti << " has " << ue.first->m_dlRBG
-                              << " RBG assigned");
-            NS_ASSERT_MSG(dci->m_symStart + dci->m_numSym <= m_macSchedSapUser->GetSymbolsPerSlot(),
-                          "symStart: "
-                              << static_cast<uint32_t>(dci->m_symStart)
-                              << " symEnd: " << static_cast<uint32_t>(dci->m_numSym) << " symbols: "
-                              << static_cast<uint32_t>(m_macSchedSapUser->GetSymbolsPerSlot()));
-
-            HarqProcess harqProcess(true, HarqProcess::WAITING_FEEDBACK, 0, dci);
-            uint8_t id;
-
-            if (!ue.first->m_dlHarq.CanInsert())
+            for (const auto& ue : beam.second)
             {
-                NS_LOG_INFO("Harq Vector condition for UE " << ue.first->m_rnti << std::endl
-                                                            << ue.first->m_dlHarq);
-                NS_FATAL_ERROR("UE " << ue.first->m_rnti << " does not have DL HARQ space");
-            }
+                if (ue.first->m_dlRBG == 0)
+                {
+                    NS_LOG_INFO("UE " << ue.first->m_rnti << " does not have RBG assigned");
+                    continue;
+                }
 
-            ue.first->m_dlHarq.Insert(&id, harqProcess);
-            ue.first->m_dlHarq.Get(id).m_dciElement->m_harqProcess = id;
+                std::shared_ptr<DciInfoElementTdma> dci;
+                {
+                    NR_SCHEDULER_PROFILE_PHASE(DCI);
+                    dci = CreateDlDci(spoint, ue.first, symPerBeam.at(GetBeam(beam)));
+                }
+                if (dci == nullptr)
+                {
+                    // By continuing to the next UE means that we are
+                    // wasting a resource assign to this UE. For a TDMA
+                    // scheduler this resource would be one or more
+                    // symbols, and for OFDMA scheduler it would be a
+                    // chunk of time + freq, i.e., one or more
+                    // symbols in time and one ore more RBG in freq.
+                    // The assignment avoids it if the attribute
+                    // WasteFreeAssignment of NrMacSchedulerTdma is set: it
+                    // does not assign resources to a UE if the assigned resources
+                    // result a TB size of less than 7 bytes (3 mac header, 2 rlc header, 2 data).
+                    // Because if this happens CreateDlDci will not create DCI.
+                    NS_LOG_DEBUG("No DCI has been created, ignoring");
+                    m_wastedResourcesTrace(slotAlloc->m_sfnSf,
+                                           ue.first->m_rnti,
+                                           DciInfoElementTdma::DL,
+                                           ue.first->m_dlRBG);
+                    ue.first->ResetDlMetric();
+                    continue;
+                }
 
-            std::vector<std::vector<NrMacSchedulerLcAlgorithm::Assignation>> bytesPerLcPerStream;
+                assigned = true;
+                dci->m_layer = layer;
 
-            for (const auto& it : dci->m_tbSize)
-            {
-                // distribute tbsize of each stream among the LCs of the UE
-                // distributedBytes size is equal to the number of LCs
-                auto distributedBytes =
-                    m_schedLc->AssignBytesToDlLC(ue.first->m_dlLCG,
-                                                 it,
-                                                 m_macSchedSapUser->GetSlotPeriod());
-                if (bytesPerLcPerStream.size() == 0)
+                if (symbStartDci.insert(dci->m_symStart).second)
                 {
-                    bytesPerLcPerStream.resize(distributedBytes.size());
+                    allocSym += dci->m_numSym;
                 }
-                for (std::size_t numLc = 0; numLc < distributedBytes.size(); numLc++)
+
+                NS_LOG_INFO("UE " << ue.first->m_rnti << " has " << ue.first->m_dlRBG
+                                  << " RBG assigned");
+                NS_ASSERT_MSG(
+                    dci->m_symStart + dci->m_numSym <= m_macSchedSapUser->GetSymbolsPerSlot(),
+                    "symStart: " << static_cast<uint32_t>(dci->m_symStart)
+                                 << " symEnd: " << static_cast<uint32_t>(dci->m_numSym)
+                                 << " symbols: "
+                                 << static_cast<uint32_t>(m_macSchedSapUser->GetSymbolsPerSlot()));
+
+                HarqProcess harqProcess(true, HarqProcess::WAITING_FEEDBACK, 0, dci);
+                uint8_t id;
+
+                if (!ue.first->m_dlHarq.CanInsert())
                 {
-                    bytesPerLcPerStream.at(numLc).emplace_back(
-                        NrMacSchedulerLcAlgorithm::Assignation(distributedBytes.at(numLc).m_lcg,
-                                                               distributedBytes.at(numLc).m_lcId,
-                                                               distributedBytes.at(numLc).m_bytes));
+                    NS_LOG_INFO("Harq Vector condition for UE " << ue.first->m_rnti << std::endl
+                                                                << ue.first->m_dlHarq);
+                    NS_FATAL_ERROR("UE " << ue.first->m_rnti << " does not have DL HARQ space");
                 }
-            }
-
-            //      auto distributedBytes = AssignBytesToLC (ue.first->m_dlLCG, dci->m_tbSize);
 
-            VarTtiAllocInfo slotInfo(dci);
+                ue.first->m_dlHarq.Insert(&id, harqProcess);
+                m_dlHarqActiveUes.insert(ue.first->m_rnti);
+                ue.first->m_dlHarq.Get(id).m_dciElement->m_harqProcess = id;
 
-            NS_LOG_INFO("Assigned process ID " << static_cast<uint32_t>(dci->m_harqProcess)
-                                               << " to UE " << ue.first->m_rnti);
-            for (std::size_t stream = 0; stream < dci->m_tbSize.size(); stream++)
-            {
-                NS_LOG_DEBUG(" UE" << dci->m_rnti << " stream " << stream << " gets DL symbols "
-                                   << static_cast<uint32_t>(dci->m_symStart) << "-"
-                                   << static_cast<uint32_t>(dci->m_symStart + dci->m_numSym)
-                                   << " tbs " << dci->m_tbSize.at(stream) << " mcs "
-                                   << static_cast<uint32_t>(dci->m_mcs.at(stream)) << " harqId "
-                                   << static_cast<uint32_t>(id) << " rv "
-                                   << static_cast<uint32_t>(dci->m_rv.at(stream)));
-            }
+                std::vector<std::vector<NrMacSchedulerLcAlgorithm::Assignation>>
+                    bytesPerLcPerStream;
 
-            for (const auto& bytesPerLc : bytesPerLcPerStream)
-            {
-                // bytesPerLc is a vector
-                std::vector<RlcPduInfo> rlcPdusInfoPerStream;
-                for (const auto& bytesPerStream : bytesPerLc)
+                for (const auto& it : dci->m_tbSize)
                 {
-                    if (bytesPerStream.m_bytes != 0)
+                    NR_SCHEDULER_PROFILE_PHASE(LC_BYTES);
+                    // distribute tbsize of each stream among the LCs of the UE
+                    // distributedBytes size is equal to the number of LCs
+                    auto distributedBytes =
+                        m_schedLc->AssignBytesToDlLC(ue.first->m_dlLCG,
+                                                     it,
+                                                     m_macSchedSapUser->GetSlotPeriod());
+                    if (bytesPerLcPerStream.size() == 0)
                     {
-                        NS_ASSERT(bytesPerStream.m_bytes >= 3);
-                        uint8_t lcId = bytesPerStream.m_lcId;
-                        uint8_t lcgId = bytesPerStream.m_lcg;
-                        uint32_t bytes = bytesPerStream.m_bytes - 3; // Consider the subPdu overhead
-                        RlcPduInfo newRlcPdu(lcId, bytes);
-                        rlcPdusInfoPerStream.push_back(newRlcPdu);
-                        ue.first->m_dlLCG.at(lcgId)->AssignedData(lcId, bytes, "DL");
-
-                        NS_LOG_DEBUG("DL LCG " << static_cast<uint32_t>(lcgId) << " LCID "
-                                               << static_cast<uint32_t>(lcId) << " got bytes "
-                                               << newRlcPdu.m_size);
+                        bytesPerLcPerStream.resize(distributedBytes.size());
                     }
-                    else
+                    for (std::size_t numLc = 0; numLc < distributedBytes.size(); numLc++)
                     {
-                        uint8_t lcId = bytesPerStream.m_lcId;
-                        RlcPduInfo newRlcPdu(lcId, 0);
-                        rlcPdusInfoPerStream.push_back(newRlcPdu);
+                        bytesPerLcPerStream.at(numLc).emplace_back(
+                            NrMacSchedulerLcAlgorithm::Assignation(
+                                distributedBytes.at(numLc).m_lcg,
+                                distributedBytes.at(numLc).m_lcId,
+                                distributedBytes.at(numLc).m_bytes));
                     }
                 }
-                // insert rlcPduInforPerStream of a LC
-                slotInfo.m_rlcPduInfo.push_back(rlcPdusInfoPerStream);
-                HarqProcess& process = ue.first->m_dlHarq.Get(dci->m_harqProcess);
-                process.m_rlcPduInfo.push_back(rlcPdusInfoPerStream);
-            }
 
-            /*
-                      for (const auto & byteDistribution : distributedBytes)
+                //      auto distributedBytes = AssignBytesToLC (ue.first->m_dlLCG, dci->m_tbSize);
+
+                VarTtiAllocInfo slotInfo(dci);
+
+                NS_LOG_INFO("Assigned process ID " << static_cast<uint32_t>(dci->m_harqProcess)
+                                                   << " to UE " << ue.first->m_rnti);
+                for (std::size_t stream = 0; stream < dci->m_tbSize.size(); stream++)
+                {
+                    NS_LOG_DEBUG(" UE" << dci->m_rnti << " stream " << stream << " gets DL symbols "
+                                       << static_cast<uint32_t>(dci->m_symStart) << "-"
+                                       << static_cast<uint32_t>(dci->m_symStart + dci->m_numSym)
+                                       << " tbs " << dci->m_tbSize.at(stream) << " mcs "
+                                       << static_cast<uint32_t>(dci->m_mcs.at(stream)) << " harqId "
+                                       << static_cast<uint32_t>(id) << " rv "
+                                       << static_cast<uint32_t>(dci->m_rv.at(stream)));
+                }
+
+                for (const auto& bytesPerLc : bytesPerLcPerStream)
+                {
+                    // bytesPerLc is a vector
+                    std::vector<RlcPduInfo> rlcPdusInfoPerStream;
+                    for (const auto& bytesPerStream : bytesPerLc)
+                    {
+                        if (bytesPerStream.m_bytes != 0)
+                        {
+                            NS_ASSERT(bytesPerStream.m_bytes >= 3);
+                            uint8_t lcId = bytesPerStream.m_lcId;
+                            uint8_t lcgId = bytesPerStream.m_lcg;
+                            // Consider the subPdu overhead
+                            uint32_t bytes = bytesPerStream.m_bytes - 3;
+                            RlcPduInfo newRlcPdu(lcId, bytes);
+                            rlcPdusInfoPerStream.push_back(newRlcPdu);
+                            ue.first->m_dlLCG.at(lcgId)->AssignedData(lcId, bytes, "DL");
+
+                            NS_LOG_DEBUG("DL LCG " << static_cast<uint32_t>(lcgId) << " LCID "
+                                                   << static_cast<uint32_t>(lcId) << " got bytes "
+                                                   << newRlcPdu.m_size);
+                        }
+                        else
                         {
-                          NS_ASSERT (byteDistribution.m_bytes >= 3);
-                          uint8_t lcId = byteDistribution.m_lcId;
-                          uint8_t lcgId = byteDistribution.m_lcg;
-                          uint32_t bytes = byteDistribution.m_bytes - 3; // Consider the subPdu
-               overhead
+                            uint8_t lcId = bytesPerStream.m_lcId;
+                            RlcPduInfo newRlcPdu(lcId, 0);
+                            rlcPdusInfoPerStream.push_back(newRlcPdu);
+                        }
+                    }
+                    // insert rlcPduInforPerStream of a LC
+                    slotInfo.m_rlcPduInfo.push_back(rlcPdusInfoPerStream);
+                    HarqProcess& process = ue.first->m_dlHarq.Get(dci->m_harqProcess);
+                    process.m_rlcPduInfo.push_back(rlcPdusInfoPerStream);
+                }
 
-                          RlcPduInfo newRlcPdu (lcId, bytes);
-                          HarqProcess & process = ue.first->m_dlHarq.Get (dci->m_harqProcess);
+                /*
+                          for (const auto & byteDistribution : distributedBytes)
+                            {
+                              NS_ASSERT (byteDistribution.m_bytes >= 3);
+                              uint8_t lcId = byteDistribution.m_lcId;
+                              uint8_t lcgId = byteDistribution.m_lcg;
+                              uint32_t bytes = byteDistribution.m_bytes - 3; // Consider the subPdu
+                   overhead
 
-                          slotInfo.m_rlcPduInfo.push_back (newRlcPdu);
-                          process.m_rlcPduInfo.push_back (newRlcPdu);
+                              RlcPduInfo newRlcPdu (lcId, bytes);
+                              HarqProcess & process = ue.first->m_dlHarq.Get (dci->m_harqProcess);
 
-                          ue.first->m_dlLCG.at (lcgId)->AssignedData (lcId, bytes);
+                              slotInfo.m_rlcPduInfo.push_back (newRlcPdu);
+                              process.m_rlcPduInfo.push_back (newRlcPdu);
 
-                          NS_LOG_DEBUG ("DL LCG " << static_cast<uint32_t> (lcgId) <<
-                                        " LCID " << static_cast<uint32_t> (lcId) <<
-                                        " got bytes " << newRlcPdu.m_size);
-                        }*/
+                              ue.first->m_dlLCG.at (lcgId)->AssignedData (lcId, bytes);
 
-            NS_ABORT_IF(slotInfo.m_rlcPduInfo.size() == 0);
+                              NS_LOG_DEBUG ("DL LCG " << static_cast<uint32_t> (lcgId) <<
+                                            " LCID " << static_cast<uint32_t> (lcId) <<
+                                            " got bytes " << newRlcPdu.m_size);
+                            }*/
 
-            slotAlloc->m_varTtiAllocInfo.emplace_back(slotInfo);
+                NS_ABORT_IF(slotInfo.m_rlcPduInfo.size() == 0);
+
+                slotAlloc->m_varTtiAllocInfo.emplace_back(slotInfo);
+            }
+            if (assigned)
+            {
+                groupAssigned = true;
+                groupSym = std::max(groupSym, allocSym);
+            }
         }
-        if (assigned)
+        if (groupAssigned)
         {
-            ChangeDlBeam(spoint, symPerBeam.at(GetBeam(beam)));
-            usedSym += allocSym;
-            slotAlloc->m_numSymAlloc += allocSym;
+            ChangeDlBeam(spoint, symPerBeam.at(group.front()));
+            usedSym += groupSym;
+            slotAlloc->m_numSymAlloc += groupSym;
         }
     }
 
@@ -1614,7 +2479,11 @@ NrMacSchedulerNs3::DoScheduleUlData(PointInFTPlane* spoint,
     NS_ASSERT(symAvail > 0 && activeUl.size() > 0);
     NS_ASSERT(spoint->m_rbg == 0);
 
-    BeamSymbolMap symPerBeam = AssignULRBG(symAvail, activeUl);
+    BeamSymbolMap symPerBeam;
+    {
+        NR_SCHEDULER_PROFILE_PHASE(RBG);
+        symPerBeam = AssignULRBG(symAvail, activeUl);
+    }
     uint8_t usedSym = 0;
     GetFirst GetBeam;
 
@@ -1649,8 +2518,11 @@ NrMacSchedulerNs3::DoScheduleUlData(PointInFTPlane* spoint,
                 continue;
             }
 
-            std::shared_ptr<DciInfoElementTdma> dci =
-                CreateUlDci(spoint, ue.first, symPerBeam.at(GetBeam(beam)));
+            std::shared_ptr<DciInfoElementTdma> dci;
+            {
+                NR_SCHEDULER_PROFILE_PHASE(DCI);
+                dci = CreateUlDci(spoint, ue.first, symPerBeam.at(GetBeam(beam)));
+            }
 
             if (dci == nullptr)
             {
@@ -1660,12 +2532,16 @@ NrMacSchedulerNs3::DoScheduleUlData(PointInFTPlane* spoint,
                 // symbols, and for OFDMA scheduler it would be a
                 // chunk of time + freq, i.e., one or more
                 // symbols in time and one ore more RBG in freq.
-                // TODO To avoid this, a more accurate solution
-                // is needed to assign resources. That is, a solution
-                // that would not assign resources to a UE if the assigned resources
+                // The assignment avoids it if the attribute
+                // WasteFreeAssignment of NrMacSchedulerTdma is set: it
+                // does not assign resources to a UE if the assigned resources
                 // result a TB size of less than 7 bytes (3 mac header, 2 rlc header, 2 data).
                 // Because if this happens CreateUlDci will not create DCI.
                 NS_LOG_DEBUG("No DCI has been created, ignoring");
+                m_wastedResourcesTrace(slotAlloc->m_sfnSf,
+                                       ue.first->m_rnti,
+                                       DciInfoElementTdma::UL,
+                                       ue.first->m_ulRBG);
                 ue.first->ResetUlMetric();
                 continue;
             }
@@ -1687,6 +2563,7 @@ NrMacSchedulerNs3::DoScheduleUlData(PointInFTPlane* spoint,
             HarqProcess harqProcess(true, HarqProcess::WAITING_FEEDBACK, 0, dci);
             uint8_t id;
             ue.first->m_ulHarq.Insert(&id, harqProcess);
+            m_ulHarqActiveUes.insert(ue.first->m_rnti);
 
             ue.first->m_ulHarq.Get(id).m_dciElement->m_harqProcess = id;
 
@@ -1705,8 +2582,12 @@ NrMacSchedulerNs3::DoScheduleUlData(PointInFTPlane* spoint,
                                    << static_cast<uint32_t>(dci->m_rv.at(stream)));
             }
 
-            auto distributedBytes =
-                m_schedLc->AssignBytesToUlLC(ue.first->m_ulLCG, dci->m_tbSize.at(0));
+            std::vector<NrMacSchedulerLcAlgorithm::Assignation> distributedBytes;
+            {
+                NR_SCHEDULER_PROFILE_PHASE(LC_BYTES);
+                distributedBytes =
+                    m_schedLc->AssignBytesToUlLC(ue.first->m_ulLCG, dci->m_tbSize.at(0));
+            }
             bool assignedToLC = false;
             for (const auto& byteDistribution : distributedBytes)
             {
@@ -1814,19 +2695,15 @@ NrMacSchedulerNs3::ScheduleDl(const NrMacSchedSapProvider::SchedDlTriggerReqPara
     NS_LOG_FUNCTION(this);
     NS_LOG_INFO("Scheduling invoked for slot " << params.m_snfSf << " of type "
                                                << params.m_slotType);
+#ifdef NR_SCHEDULER_PROFILING
+    m_profiler.BeginSlot(NrMacSchedulerProfiler::DL, params.m_snfSf);
+#endif
 
     NrMacSchedSapUser::SchedConfigIndParameters dlSlot(params.m_snfSf);
     dlSlot.m_slotAllocInfo.m_sfnSf = params.m_snfSf;
     dlSlot.m_slotAllocInfo.m_type = SlotAllocInfo::DL;
-    auto ulAllocationIt =
-        m_ulAllocationMap.find(params.m_snfSf.GetEncoding()); // UL allocations for this slot
-    if (ulAllocationIt == m_ulAllocationMap.end())
-    {
-        ulAllocationIt =
-            m_ulAllocationMap.insert(std::make_pair(params.m_snfSf.GetEncoding(), SlotElem(0)))
-                .first;
-    }
-    auto& ulAllocations = ulAllocationIt->second;
+    // UL allocations for this slot
+    auto& ulAllocations = m_ulAllocationMap.Emplace(params.m_snfSf);
 
     // add slot for DL control, at symbol 0
     PrependCtrlSym(0,
@@ -1859,13 +2736,24 @@ NrMacSchedulerNs3::ScheduleDl(const NrMacSchedSapProvider::SchedDlTriggerReqPara
 
     // compute active ue in the current subframe, group them by BeamConfId
     ActiveHarqMap activeDlHarq;
-    ComputeActiveHarq(&activeDlHarq, dlHarqFeedback);
-
     ActiveUeMap activeDlUe;
-    ComputeActiveUe(&activeDlUe,
-                    &NrMacSchedulerUeInfo::GetDlLCG,
-                    &NrMacSchedulerUeInfo::GetDlHarqVector,
-                    "DL");
+    {
+        NR_SCHEDULER_PROFILE_PHASE(ACTIVE_UE);
+        ComputeActiveHarq(&activeDlHarq, dlHarqFeedback);
+        ComputeActiveUe(&activeDlUe,
+                        &NrMacSchedulerUeInfo::GetDlLCG,
+                        &NrMacSchedulerUeInfo::GetDlHarqVector,
+                        "DL",
+                        m_incrementalActiveUe ? &m_dlActiveUeCandidates : nullptr);
+    }
+#ifdef NR_SCHEDULER_PROFILING
+    uint32_t numActiveUes = 0;
+    for (const auto& beam : activeDlUe)
+    {
+        numActiveUes += beam.second.size();
+    }
+    m_profiler.SetNumUes(numActiveUes);
+#endif
 
     DoScheduleDl(dlHarqFeedback,
                  activeDlHarq,
@@ -1880,13 +2768,16 @@ NrMacSchedulerNs3::ScheduleDl(const NrMacSchedSapProvider::SchedDlTriggerReqPara
     if (ulAllocations.m_totUlSym <= GetUlCtrlSyms())
     {
         NS_LOG_INFO("Removing UL allocation for slot " << params.m_snfSf << " size "
-                                                       << m_ulAllocationMap.size());
-        m_ulAllocationMap.erase(ulAllocationIt);
+                                                       << m_ulAllocationMap.GetSize());
+        m_ulAllocationMap.Erase(params.m_snfSf);
     }
 
     NS_LOG_INFO("Total DCI for DL : " << dlSlot.m_slotAllocInfo.m_varTtiAllocInfo.size()
                                       << " including DL CTRL");
-    m_macSchedSapUser->SchedConfigInd(dlSlot);
+#ifdef NR_SCHEDULER_PROFILING
+    m_slotProfileTrace(m_profiler.EndSlot(GetBandwidthInRbg()));
+#endif
+    m_macSchedSapUser->SchedConfigInd(std::move(dlSlot));
 }
 
 /**
@@ -1931,6 +2822,9 @@ NrMacSchedulerNs3::ScheduleUl(const NrMacSchedSapProvider::SchedUlTriggerReqPara
 {
     NS_LOG_FUNCTION(this);
     NS_LOG_INFO("Scheduling invoked for slot " << params.m_snfSf);
+#ifdef NR_SCHEDULER_PROFILING
+    m_profiler.BeginSlot(NrMacSchedulerProfiler::UL, params.m_snfSf);
+#endif
 
     NrMacSchedSapUser::SchedConfigIndParameters ulSlot(params.m_snfSf);
     ulSlot.m_slotAllocInfo.m_sfnSf = params.m_snfSf;
@@ -1948,7 +2842,10 @@ NrMacSchedulerNs3::ScheduleUl(const NrMacSchedSapProvider::SchedUlTriggerReqPara
 
     NS_LOG_INFO("Total DCI for UL : " << ulSlot.m_slotAllocInfo.m_varTtiAllocInfo.size()
                                       << " including UL CTRL");
-    m_macSchedSapUser->SchedConfigInd(ulSlot);
+#ifdef NR_SCHEDULER_PROFILING
+    m_slotProfileTrace(m_profiler.EndSlot(GetBandwidthInRbg()));
+#endif
+    m_macSchedSapUser->SchedConfigInd(std::move(ulSlot));
 }
 
 /**
@@ -2002,11 +2899,16 @@ NrMacSchedulerNs3::DoScheduleUl(const std::vector<UlHarqInfo>& ulHarqFeedback,
     if (type == LteNrTddSlotType::F)
     { // if it's a type F, we have to consider DL CTRL symbols, otherwise, don't
         dataSymPerSlot -= m_dlCtrlSymbols;
+        // and the symbols of the DL configured grants, which follow the DL CTRL
+        if (!m_configuredGrantUes.empty())
+        {
+            uint8_t dlCgSym = GetDlConfiguredGrantSym(ulSfn);
+            NS_ABORT_MSG_IF(dlCgSym > dataSymPerSlot,
+                            "The DL configured grants of slot " << ulSfn << " do not fit");
+            dataSymPerSlot -= dlCgSym;
+        }
     }
 
-    ActiveHarqMap activeUlHarq;
-    ComputeActiveHarq(&activeUlHarq, ulHarqFeedback);
-
     // Start the assignation from the last available data symbol, and like a shrimp
     // go backward.
     uint8_t lastSym = m_macSchedSapUser->GetSymbolsPerSlot() - m_ulCtrlSymbols;
@@ -2014,7 +2916,7 @@ NrMacSchedulerNs3::DoScheduleUl(const std::vector<UlHarqInfo>& ulHarqFeedback,
     uint8_t ulSymAvail = dataSymPerSlot;
 
     // Create the UL allocation map entry
-    m_ulAllocationMap.emplace(ulSfn.GetEncoding(), SlotElem(0));
+    auto& ulAllocations = m_ulAllocationMap.Emplace(ulSfn);
 
     if ((m_enableSrsInFSlots == true && type == LteNrTddSlotType::F) ||
         (m_enableSrsInUlSlots == true && type == LteNrTddSlotType::UL))
@@ -2025,18 +2927,62 @@ NrMacSchedulerNs3::DoScheduleUl(const std::vector<UlHarqInfo>& ulHarqFeedback,
         ulSymAvail -= srsSym;
     }
 
-    NS_LOG_DEBUG("Scheduling UL " << ulSfn << " UL HARQ to retransmit: " << ulHarqFeedback.size()
+    // A new occasion of a configured grant flushes the retransmission of the
+    // previous one, if it is still pending
+    std::set<std::pair<uint16_t, uint8_t>> flushedHarq;
+    uint8_t cgIdleSym = 0;
+    if (!m_configuredGrantUes.empty())
+    {
+        uint8_t cgSym = ScheduleUlConfiguredGrants(ulSfn,
+                                                   &ulAssignationStartPoint,
+                                                   lastSym - dataSymPerSlot,
+                                                   &flushedHarq,
+                                                   allocInfo);
+        ulSymAvail -= cgSym;
+
+        // The reserved symbols without an allocation count as used by the UL
+        cgIdleSym = cgSym;
+        for (const auto& alloc : allocInfo->m_varTtiAllocInfo)
+        {
+            if (alloc.m_dci->m_cgPeriodicity > 0)
+            {
+                cgIdleSym -= alloc.m_dci->m_numSym;
+            }
+        }
+    }
+
+    std::vector<UlHarqInfo> ulHarqNotFlushed;
+    if (!flushedHarq.empty())
+    {
+        for (const auto& feedback : ulHarqFeedback)
+        {
+            if (flushedHarq.count({feedback.m_rnti, feedback.m_harqProcessId}) == 0)
+            {
+                ulHarqNotFlushed.push_back(feedback);
+            }
+        }
+    }
+    const auto& ulHarqToSchedule = flushedHarq.empty() ? ulHarqFeedback : ulHarqNotFlushed;
+
+    ActiveHarqMap activeUlHarq;
+    {
+        NR_SCHEDULER_PROFILE_PHASE(ACTIVE_UE);
+        ComputeActiveHarq(&activeUlHarq, ulHarqToSchedule);
+    }
+
+    NS_LOG_DEBUG("Scheduling UL " << ulSfn << " UL HARQ to retransmit: " << ulHarqToSchedule.size()
                                   << " Active Beams UL HARQ: " << activeUlHarq.size()
                                   << " starting from (" << +ulAssignationStartPoint.m_rbg << ", "
                                   << +ulAssignationStartPoint.m_sym << ")");
 
     if (activeUlHarq.size() > 0)
     {
+        NR_SCHEDULER_PROFILE_PHASE(HARQ);
         uint8_t usedHarq = ScheduleUlHarq(&ulAssignationStartPoint,
                                           ulSymAvail,
                                           m_ueMap,
                                           &m_ulHarqToRetransmit,
-                                          ulHarqFeedback,
+                                          ulHarqToSchedule,
                                           allocInfo);
         NS_ASSERT_MSG(ulSymAvail >= usedHarq,
                       "Available: " << +ulSymAvail << " used by HARQ: " << +usedHarq);
@@ -2050,14 +2996,27 @@ NrMacSchedulerNs3::DoScheduleUl(const std::vector<UlHarqInfo>& ulHarqFeedback,
     if (ulSymAvail > 0 && m_srList.size() > 0)
     {
         DoScheduleUlSr(&ulAssignationStartPoint, m_srList);
+        m_ulActiveUeCandidates.insert(m_srList.begin(), m_srList.end());
         m_srList.clear();
     }
 
     ActiveUeMap activeUlUe;
-    ComputeActiveUe(&activeUlUe,
-                    &NrMacSchedulerUeInfo::GetUlLCG,
-                    &NrMacSchedulerUeInfo::GetUlHarqVector,
-                    "UL");
+    {
+        NR_SCHEDULER_PROFILE_PHASE(ACTIVE_UE);
+        ComputeActiveUe(&activeUlUe,
+                        &NrMacSchedulerUeInfo::GetUlLCG,
+                        &NrMacSchedulerUeInfo::GetUlHarqVector,
+                        "UL",
+                        m_incrementalActiveUe ? &m_ulActiveUeCandidates : nullptr);
+    }
+#ifdef NR_SCHEDULER_PROFILING
+    uint32_t numActiveUes = 0;
+    for (const auto& beam : activeUlUe)
+    {
+        numActiveUes += beam.second.size();
+    }
+    m_profiler.SetNumUes(numActiveUes);
+#endif
 
     GetSecond GetUeInfoList;
     for (const auto& alloc : allocInfo->m_varTtiAllocInfo)
@@ -2105,8 +3064,8 @@ NrMacSchedulerNs3::DoScheduleUl(const std::vector<UlHarqInfo>& ulHarqFeedback,
     std::vector<uint32_t> symToAl;
     symToAl.resize(15, 0);
 
-    auto& totUlSym = m_ulAllocationMap.at(ulSfn.GetEncoding()).m_totUlSym;
-    auto& allocations = m_ulAllocationMap.at(ulSfn.GetEncoding()).m_ulAllocations;
+    auto& totUlSym = ulAllocations.m_totUlSym;
+    auto& allocations = ulAllocations.m_ulAllocations;
     for (const auto& alloc : allocInfo->m_varTtiAllocInfo)
     {
         if (alloc.m_dci->m_format == DciInfoElementTdma::UL)
@@ -2119,7 +3078,7 @@ NrMacSchedulerNs3::DoScheduleUl(const std::vector<UlHarqInfo>& ulHarqFeedback,
                                                << static_cast<uint32_t>(alloc.m_dci->m_symStart)
                                                << " numSym " << +alloc.m_dci->m_numSym);
 
-            if (alloc.m_dci->m_type == DciInfoElementTdma::DATA)
+            if (alloc.m_dci->m_type == DciInfoElementTdma::DATA && !alloc.m_dci->m_cgRelease)
             {
                 NS_LOG_INFO("Placed the above allocation in the CQI map");
                 allocations.emplace_back(AllocElem(alloc.m_dci->m_rnti,
@@ -2136,6 +3095,7 @@ NrMacSchedulerNs3::DoScheduleUl(const std::vector<UlHarqInfo>& ulHarqFeedback,
     {
         totUlSym += v;
     }
+    totUlSym += cgIdleSym;
 
     NS_ASSERT_MSG((dataSymPerSlot + m_ulCtrlSymbols) - ulSymAvail == totUlSym,
                   "UL symbols available: "
@@ -2149,7 +3109,7 @@ NrMacSchedulerNs3::DoScheduleUl(const std::vector<UlHarqInfo>& ulHarqFeedback,
                                 << static_cast<uint32_t>(totUlSym) << " symbols and "
                                 << allocations.size() << " data allocations, with a total of "
                                 << allocInfo->m_varTtiAllocInfo.size());
-    NS_ASSERT(m_ulAllocationMap.at(ulSfn.GetEncoding()).m_totUlSym == totUlSym);
+    NS_ASSERT(m_ulAllocationMap.Find(ulSfn)->m_totUlSym == totUlSym);
 
     return dataSymPerSlot - ulSymAvail;
 }
@@ -2161,26 +3121,29 @@ NrMacSchedulerNs3::DoScheduleSrs(PointInFTPlane* spoint, SlotAllocInfo* allocInf
 
     uint8_t used = 0;
 
-    // Without UE, don't schedule any SRS
-    if (m_ueMap.size() == 0)
-    {
-        return used;
-    }
-
     // Find the UE for which this is true:
     // absolute_slot_number % periodicity = offset_UEx
-    // Assuming that all UEs share the same periodicity.
-
-    uint32_t offset_UEx = m_srsSlotCounter % m_ueMap.begin()->second->m_srsPeriodicity;
+    // The UEs without SRS (periodicity 0) are skipped, and so are the UEs that
+    // have only their compact record, which are looked up afterwards.
     uint16_t rnti = 0;
 
     for (const auto& ue : m_ueMap)
     {
-        if (ue.second->m_srsOffset == offset_UEx)
+        if (ue.second->m_srsPeriodicity > 0 &&
+            ue.second->m_srsOffset == m_srsSlotCounter % ue.second->m_srsPeriodicity)
         {
             rnti = ue.second->m_rnti;
         }
     }
+    for (std::size_t i = 0; rnti == 0 && i < m_compactUes.size(); ++i)
+    {
+        const CompactUe& record = m_compactUes[i];
+        if ((record.m_flags & CompactUe::PARKED) != 0 && record.m_srsPeriodicity > 0 &&
+            record.m_srsOffset == m_srsSlotCounter % record.m_srsPeriodicity)
+        {
+            rnti = static_cast<uint16_t>(i);
+        }
+    }
 
     if (rnti == 0)
     {
@@ -2205,17 +3168,17 @@ NrMacSchedulerNs3::DoScheduleSrs(PointInFTPlane* spoint, SlotAllocInfo* allocInf
         std::vector<uint8_t> ndi = {1};
         std::vector<uint8_t> rv = {0};
 
-        auto dci = std::make_shared<DciInfoElementTdma>(rnti,
-                                                        DciInfoElementTdma::UL,
-                                                        spoint->m_sym,
-                                                        1,
-                                                        mcs,
-                                                        tbs,
-                                                        ndi,
-                                                        rv,
-                                                        DciInfoElementTdma::SRS,
-                                                        GetBwpId(),
-                                                        GetTpc());
+        auto dci = m_dciPool.Create(rnti,
+                                    DciInfoElementTdma::UL,
+                                    spoint->m_sym,
+                                    1,
+                                    mcs,
+                                    tbs,
+                                    ndi,
+                                    rv,
+                                    DciInfoElementTdma::SRS,
+                                    GetBwpId(),
+                                    GetTpc());
         dci->m_rbgBitmask = rbgBitmask;
 
         allocInfo->m_numSymAlloc += 1;
@@ -2227,6 +3190,295 @@ NrMacSchedulerNs3::DoScheduleSrs(PointInFTPlane* spoint, SlotAllocInfo* allocInf
     return used;
 }
 
+/**
+ * \brief Get the symbols reserved by the DL configured grants in a slot
+ * \param sfnSf the slot
+ * \return the number of symbols, after the DL CTRL, up to the last symbol of
+ * the DL configured grants with an occasion in the slot
+ */
+uint8_t
+NrMacSchedulerNs3::GetDlConfiguredGrantSym(const SfnSf& sfnSf) const
+{
+    uint8_t lastSym = m_dlCtrlSymbols;
+    for (const auto& rnti : m_configuredGrantUes)
+    {
+        for (const auto& grant : m_ueMap.at(rnti)->m_configuredGrants)
+        {
+            const auto& config = grant.m_config;
+            if (config.m_format == DciInfoElementTdma::DL && config.IsOccasion(sfnSf))
+            {
+                NS_ABORT_MSG_IF(config.m_symStart < m_dlCtrlSymbols,
+                                "The DL configured grant of UE " << rnti
+                                                                 << " overlaps the DL CTRL");
+                lastSym = std::max<uint8_t>(lastSym, config.m_symStart + config.m_numSym);
+            }
+        }
+    }
+    return lastSym - m_dlCtrlSymbols;
+}
+
+/**
+ * \brief Schedule the occasions of the DL configured grants (SPS) in a slot
+ * \param dlSfnSf the slot
+ * \param dlSymAvail the DL data symbols available in the slot
+ * \param allocInfo Allocation info pointer (where to save the allocations)
+ * \return the number of symbols, after the DL CTRL, reserved for the grants
+ *
+ * The symbols of an occasion are reserved even when the gNB does not transmit
+ * in it, because an activated UE listens there. An occasion is used when the LC
+ * of the grant has data and the HARQ process of the grant is not waiting for a
+ * feedback or a retransmission; the TB fills the entire band. The first
+ * occasion used is signalled with a DCI, which activates the grant at the UE.
+ * The next occasion of a removed grant has the release DCI instead.
+ */
+uint8_t
+NrMacSchedulerNs3::ScheduleDlConfiguredGrants(const SfnSf& dlSfnSf,
+                                              uint8_t dlSymAvail,
+                                              SlotAllocInfo* allocInfo)
+{
+    NS_LOG_FUNCTION(this);
+
+    uint8_t reservedSym = GetDlConfiguredGrantSym(dlSfnSf);
+    NS_ABORT_MSG_IF(reservedSym > dlSymAvail,
+                    "The DL configured grants of slot " << dlSfnSf << " need " << +reservedSym
+                                                        << " symbols, available: " << +dlSymAvail);
+
+    uint32_t usedSymMask = 0;
+    std::set<uint16_t> releasedUes;
+    for (const auto& rnti : m_configuredGrantUes)
+    {
+        auto& ue = m_ueMap.at(rnti);
+        for (auto& grant : ue->m_configuredGrants)
+        {
+            const auto& config = grant.m_config;
+            if (config.m_format != DciInfoElementTdma::DL || !config.IsOccasion(dlSfnSf))
+            {
+                continue;
+            }
+
+            uint32_t symMask = ((1U << config.m_numSym) - 1) << config.m_symStart;
+            NS_ABORT_MSG_IF((usedSymMask & symMask) != 0,
+                            "The DL configured grants of slot " << dlSfnSf << " overlap");
+            usedSymMask |= symMask;
+
+            if (grant.m_release)
+            {
+                auto dci = CreateConfiguredGrantRelease(rnti, grant);
+                ue->m_dlHarq.Release(grant.m_harqId);
+                grant.m_active = false;
+                releasedUes.insert(rnti);
+                allocInfo->m_varTtiAllocInfo.emplace_back(VarTtiAllocInfo(dci));
+                allocInfo->m_numSymAlloc += config.m_numSym;
+                continue;
+            }
+
+            uint8_t lcgId = 0;
+            uint32_t bytes = 0;
+            for (const auto& lcg : ue->m_dlLCG)
+            {
+                if (lcg.second->Contains(config.m_lcId))
+                {
+                    lcgId = lcg.first;
+                    bytes = lcg.second->GetTotalSizeOfLC(config.m_lcId);
+                    break;
+                }
+            }
+            if (bytes == 0)
+            {
+                NS_LOG_INFO("UE " << rnti << " has no data for the DL configured grant");
+                continue;
+            }
+
+            if (grant.m_harqId == 255)
+            {
+                grant.m_harqId = ue->m_dlHarq.Reserve();
+                if (grant.m_harqId == 255)
+                {
+                    NS_LOG_INFO("UE " << rnti
+                                      << " has no DL HARQ process for the configured grant");
+                    continue;
+                }
+            }
+            if (ue->m_dlHarq.Get(grant.m_harqId).m_active)
+            {
+                NS_LOG_INFO("The DL configured grant of UE " << rnti << " is not used, process "
+                                                             << +grant.m_harqId << " is busy");
+                continue;
+            }
+
+            uint32_t tbs =
+                m_dlAmc->CalculateTbSize(config.m_mcs,
+                                         GetBandwidthInRbg() * config.m_numSym * GetNumRbPerRbg());
+            NS_ABORT_MSG_IF(tbs < 7, "The DL configured grant of UE " << rnti << " is too small");
+
+            auto dci = m_dciPool.Create(rnti,
+                                        DciInfoElementTdma::DL,
+                                        config.m_symStart,
+                                        config.m_numSym,
+                                        std::vector<uint8_t>{config.m_mcs},
+                                        std::vector<uint32_t>{tbs},
+                                        std::vector<uint8_t>{1},
+                                        std::vector<uint8_t>{0},
+                                        DciInfoElementTdma::DATA,
+                                        GetBwpId(),
+                                        GetTpc());
+            dci->m_rbgBitmask = std::vector<uint8_t>(GetBandwidthInRbg(), 1);
+            dci->m_harqProcess = grant.m_harqId;
+            dci->m_cgPeriodicity = config.m_periodicity;
+            dci->m_cgOccasion = grant.m_active;
+            grant.m_active = true;
+
+            // Consider the subPdu overhead
+            std::vector<RlcPduInfo> rlcPduInfo{RlcPduInfo(config.m_lcId, tbs - 3)};
+            ue->m_dlLCG.at(lcgId)->AssignedData(config.m_lcId, tbs - 3, "DL");
+
+            HarqProcess process(true, HarqProcess::WAITING_FEEDBACK, 0, dci);
+            process.m_rlcPduInfo.push_back(rlcPduInfo);
+            ue->m_dlHarq.InsertReserved(grant.m_harqId, process);
+            m_dlHarqActiveUes.insert(rnti);
+
+            NS_LOG_INFO("UE " << rnti << " gets DL symbols " << +config.m_symStart << "-"
+                              << config.m_symStart + config.m_numSym << " of its configured grant,"
+                              << " tbs " << tbs << " harqId " << +grant.m_harqId
+                              << (dci->m_cgOccasion ? "" : " (activation)"));
+
+            VarTtiAllocInfo slotInfo(dci);
+            slotInfo.m_rlcPduInfo.push_back(rlcPduInfo);
+            allocInfo->m_varTtiAllocInfo.emplace_back(slotInfo);
+            allocInfo->m_numSymAlloc += config.m_numSym;
+        }
+    }
+    EraseReleasedConfiguredGrants(releasedUes);
+
+    return reservedSym;
+}
+
+/**
+ * \brief Schedule the occasions of the UL configured grants in a slot
+ * \param ulSfn the slot
+ * \param spoint Starting point of the UL assignation, moved before the grants
+ * \param lowestSym the first symbol that the UL data can use in the slot
+ * \param flushedHarq the HARQ processes (RNTI, ID) overwritten by an occasion
+ * \param allocInfo Allocation info pointer (where to save the allocations)
+ * \return the number of symbols reserved for the grants, up to the starting point
+ *
+ * After the activation, the UE transmits in every occasion, with padding if
+ * it has no data, so each occasion is allocated over the entire band. The
+ * occasion overwrites the HARQ process of the grant: if the previous TB was
+ * still waiting for a feedback or a retransmission, it is abandoned. The next
+ * occasion of a removed grant has the release DCI instead, and the UE does not
+ * transmit in it.
+ */
+uint8_t
+NrMacSchedulerNs3::ScheduleUlConfiguredGrants(const SfnSf& ulSfn,
+                                              PointInFTPlane* spoint,
+                                              uint8_t lowestSym,
+                                              std::set<std::pair<uint16_t, uint8_t>>* flushedHarq,
+                                              SlotAllocInfo* allocInfo)
+{
+    NS_LOG_FUNCTION(this);
+
+    uint8_t firstSym = spoint->m_sym;
+    uint32_t usedSymMask = 0;
+    std::set<uint16_t> releasedUes;
+    for (const auto& rnti : m_configuredGrantUes)
+    {
+        auto& ue = m_ueMap.at(rnti);
+        for (auto& grant : ue->m_configuredGrants)
+        {
+            const auto& config = grant.m_config;
+            if (config.m_format != DciInfoElementTdma::UL || !config.IsOccasion(ulSfn))
+            {
+                continue;
+            }
+
+            NS_ABORT_MSG_IF(config.m_symStart < lowestSym ||
+                                config.m_symStart + config.m_numSym > spoint->m_sym,
+                            "The UL configured grant of UE "
+                                << rnti << " does not fit in the UL data symbols of slot "
+                                << ulSfn);
+            uint32_t symMask = ((1U << config.m_numSym) - 1) << config.m_symStart;
+            NS_ABORT_MSG_IF((usedSymMask & symMask) != 0,
+                            "The UL configured grants of slot " << ulSfn << " overlap");
+            usedSymMask |= symMask;
+            firstSym = std::min(firstSym, config.m_symStart);
+
+            if (grant.m_release)
+            {
+                // The UE does not transmit: the process keeps its last TB
+                auto dci = CreateConfiguredGrantRelease(rnti, grant);
+                ue->m_ulHarq.Release(grant.m_harqId);
+                grant.m_active = false;
+                releasedUes.insert(rnti);
+                allocInfo->m_varTtiAllocInfo.emplace_front(VarTtiAllocInfo(dci));
+                allocInfo->m_numSymAlloc += config.m_numSym;
+                continue;
+            }
+
+            if (grant.m_harqId == 255)
+            {
+                grant.m_harqId = ue->m_ulHarq.Reserve();
+                if (grant.m_harqId == 255)
+                {
+                    NS_LOG_INFO("UE " << rnti
+                                      << " has no UL HARQ process for the configured grant");
+                    continue;
+                }
+            }
+            if (ue->m_ulHarq.Get(grant.m_harqId).m_active)
+            {
+                NS_LOG_INFO("The UL configured grant of UE " << rnti << " overwrites process "
+                                                             << +grant.m_harqId);
+                flushedHarq->emplace(rnti, grant.m_harqId);
+            }
+
+            uint32_t tbs =
+                m_ulAmc->CalculateTbSize(config.m_mcs,
+                                         GetBandwidthInRbg() * config.m_numSym * GetNumRbPerRbg());
+
+            auto dci = m_dciPool.Create(rnti,
+                                        DciInfoElementTdma::UL,
+                                        config.m_symStart,
+                                        config.m_numSym,
+                                        std::vector<uint8_t>{config.m_mcs},
+                                        std::vector<uint32_t>{tbs},
+                                        std::vector<uint8_t>{1},
+                                        std::vector<uint8_t>{0},
+                                        DciInfoElementTdma::DATA,
+                                        GetBwpId(),
+                                        GetTpc());
+            dci->m_rbgBitmask = std::vector<uint8_t>(GetBandwidthInRbg(), 1);
+            dci->m_harqProcess = grant.m_harqId;
+            dci->m_cgPeriodicity = config.m_periodicity;
+            dci->m_cgOccasion = grant.m_active;
+            grant.m_active = true;
+
+            ue->m_ulHarq.InsertReserved(grant.m_harqId,
+                                        HarqProcess(true, HarqProcess::WAITING_FEEDBACK, 0, dci));
+            m_ulHarqActiveUes.insert(rnti);
+
+            for (const auto& byteDistribution : m_schedLc->AssignBytesToUlLC(ue->m_ulLCG, tbs))
+            {
+                ue->m_ulLCG.at(byteDistribution.m_lcg)
+                    ->AssignedData(byteDistribution.m_lcId, byteDistribution.m_bytes, "UL");
+            }
+
+            NS_LOG_INFO("UE " << rnti << " gets UL symbols " << +config.m_symStart << "-"
+                              << config.m_symStart + config.m_numSym << " of its configured grant,"
+                              << " tbs " << tbs << " harqId " << +grant.m_harqId
+                              << (dci->m_cgOccasion ? "" : " (activation)"));
+
+            allocInfo->m_varTtiAllocInfo.emplace_front(VarTtiAllocInfo(dci));
+            allocInfo->m_numSymAlloc += config.m_numSym;
+        }
+    }
+    EraseReleasedConfiguredGrants(releasedUes);
+
+    uint8_t reservedSym = spoint->m_sym - firstSym;
+    spoint->m_sym = firstSym;
+    return reservedSym;
+}
+
 uint16_t
 NrMacSchedulerNs3::GetBwpId() const
 {
@@ -2300,8 +3552,16 @@ NrMacSchedulerNs3::DoScheduleDl(const std::vector<DlHarqInfo>& dlHarqFeedback,
                  << " sym available: " << static_cast<uint32_t>(dlSymAvail) << " starting from sym "
                  << static_cast<uint32_t>(m_dlCtrlSymbols));
 
+    if (!m_configuredGrantUes.empty())
+    {
+        uint8_t cgSym = ScheduleDlConfiguredGrants(dlSfnSf, dlSymAvail, allocInfo);
+        dlAssignationStartPoint.m_sym += cgSym;
+        dlSymAvail -= cgSym;
+    }
+
     if (activeDlHarq.size() > 0)
     {
+        NR_SCHEDULER_PROFILE_PHASE(HARQ);
         uint8_t usedHarq = ScheduleDlHarq(&dlAssignationStartPoint,
                                           dlSymAvail,
                                           activeDlHarq,
@@ -2367,7 +3627,9 @@ NrMacSchedulerNs3::DoScheduleDl(const std::vector<DlHarqInfo>& dlHarqFeedback,
  *
  * The function starts by refreshing the CQI received, and eventually resetting
  * the expired values. Then, the HARQ feedback are processed (ProcessHARQFeedbacks),
- * and finally the expired HARQs are canceled (ResetExpiredHARQ).
+ * and finally the expired HARQs are canceled (ResetExpiredHARQ). After the
+ * scheduling, the idle UEs are replaced by their compact record, if requested
+ * (see SetCompactIdleUes()).
  *
  * \see ScheduleDl
  */
@@ -2378,12 +3640,28 @@ NrMacSchedulerNs3::DoSchedDlTriggerReq(
     NS_LOG_FUNCTION(this);
 
     // process received CQIs
-    m_cqiManagement.RefreshDlCqiMaps(m_ueMap);
+    m_cqiManagement.RefreshDlCqiMaps(m_ueMap, &m_expired);
+    for (const auto& rnti : m_expired)
+    {
+        const UePtr& scratch = LoadCompactScratch(rnti);
+        m_cqiManagement.DlCqiExpired(scratch);
+        StoreCompactUe(scratch, &m_compactUes.at(rnti));
+    }
+    m_expired.clear();
 
-    // reset expired HARQ
-    for (const auto& itUe : m_ueMap)
+    // reset expired HARQ, only for the UEs that have active processes
+    for (auto it = m_dlHarqActiveUes.begin(); it != m_dlHarqActiveUes.end(); /* no incr */)
     {
-        ResetExpiredHARQ(itUe.second->m_rnti, &itUe.second->m_dlHarq);
+        auto& ue = m_ueMap.at(*it);
+        ResetExpiredHARQ(ue->m_rnti, &ue->m_dlHarq);
+        if (ue->m_dlHarq.Size() == 0)
+        {
+            it = m_dlHarqActiveUes.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
     }
 
     // Merge not-retransmitted and received feedback
@@ -2411,6 +3689,12 @@ NrMacSchedulerNs3::DoSchedDlTriggerReq(
         //    these are generated.. but anyway..
         for (auto it = dlHarqFeedback.begin(); it != dlHarqFeedback.end(); /* no inc */)
         {
+            if (IsParked(it->m_rnti))
+            {
+                NS_LOG_INFO("Feedback for idle UE " << it->m_rnti << " ignored");
+                it = dlHarqFeedback.erase(it); /* INC */
+                continue;
+            }
             auto& ueInfo = m_ueMap.find(it->m_rnti)->second;
             auto& process = ueInfo->m_dlHarq.Find(it->m_harqProcessId)->second;
             NS_LOG_INFO("Analyzing feedback for UE " << it->m_rnti << " process "
@@ -2451,10 +3735,16 @@ NrMacSchedulerNs3::DoSchedDlTriggerReq(
             }
         }
 
+        ProcessOllaFeedbacks(dlHarqFeedback,
+                             NrMacSchedulerUeInfo::GetDlHarqVector,
+                             DciInfoElementTdma::DL,
+                             params.m_snfSf);
         ProcessHARQFeedbacks(&dlHarqFeedback, NrMacSchedulerUeInfo::GetDlHarqVector, "DL");
     }
 
     ScheduleDl(params, dlHarqFeedback);
+
+    ParkIdleUes();
 }
 
 /**
@@ -2474,12 +3764,28 @@ NrMacSchedulerNs3::DoSchedUlTriggerReq(
     NS_LOG_FUNCTION(this);
 
     // process received CQIs
-    m_cqiManagement.RefreshUlCqiMaps(m_ueMap);
+    m_cqiManagement.RefreshUlCqiMaps(m_ueMap, &m_expired);
+    for (const auto& rnti : m_expired)
+    {
+        const UePtr& scratch = LoadCompactScratch(rnti);
+        m_cqiManagement.UlCqiExpired(scratch);
+        StoreCompactUe(scratch, &m_compactUes.at(rnti));
+    }
+    m_expired.clear();
 
-    // reset expired HARQ
-    for (const auto& itUe : m_ueMap)
+    // reset expired HARQ, only for the UEs that have active processes
+    for (auto it = m_ulHarqActiveUes.begin(); it != m_ulHarqActiveUes.end(); /* no incr */)
     {
-        ResetExpiredHARQ(itUe.second->m_rnti, &itUe.second->m_ulHarq);
+        auto& ue = m_ueMap.at(*it);
+        ResetExpiredHARQ(ue->m_rnti, &ue->m_ulHarq);
+        if (ue->m_ulHarq.Size() == 0)
+        {
+            it = m_ulHarqActiveUes.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
     }
 
     // Merge not-retransmitted and received feedback
@@ -2500,6 +3806,12 @@ NrMacSchedulerNs3::DoSchedUlTriggerReq(
         // if there are feedbacks for expired process, remove them
         for (auto it = ulHarqFeedback.begin(); it != ulHarqFeedback.end(); /* no inc */)
         {
+            if (IsParked(it->m_rnti))
+            {
+                NS_LOG_INFO("Feedback for idle UE " << it->m_rnti << " ignored");
+                it = ulHarqFeedback.erase(it);
+                continue;
+            }
             auto& ueInfo = m_ueMap.find(it->m_rnti)->second;
             auto& process = ueInfo->m_ulHarq.Find(it->m_harqProcessId)->second;
             if (!process.m_active)
@@ -2515,6 +3827,10 @@ NrMacSchedulerNs3::DoSchedUlTriggerReq(
             }
         }
 
+        ProcessOllaFeedbacks(ulHarqFeedback,
+                             NrMacSchedulerUeInfo::GetUlHarqVector,
+                             DciInfoElementTdma::UL,
+                             params.m_snfSf);
         ProcessHARQFeedbacks(&ulHarqFeedback, NrMacSchedulerUeInfo::GetUlHarqVector, "UL");
     }
 
@@ -2537,6 +3853,7 @@ NrMacSchedulerNs3::DoSchedUlSrInfoReq(
     for (const auto& ue : params.m_srList)
     {
         NS_LOG_INFO("UE " << ue << " asked for a SR ");
+        UnparkUe(ue);
 
         auto it = std::find(m_srList.begin(), m_srList.end(), ue);
         if (it == m_srList.end())
@@ -2547,4 +3864,93 @@ NrMacSchedulerNs3::DoSchedUlSrInfoReq(
     NS_ASSERT(m_srList.size() >= params.m_srList.size());
 }
 
+NrMacSchedulerNs3::SlotElemRing::SlotElemRing()
+    : m_entries(INITIAL_SLOTS)
+{
+}
+
+NrMacSchedulerNs3::SlotElem*
+NrMacSchedulerNs3::SlotElemRing::Find(const SfnSf& sfn)
+{
+    const uint64_t slot = sfn.Normalize();
+    Entry& entry = m_entries[slot % m_entries.size()];
+    if (entry.m_used && entry.m_slot == slot)
+    {
+        return &entry.m_elem;
+    }
+    return nullptr;
+}
+
+NrMacSchedulerNs3::SlotElem&
+NrMacSchedulerNs3::SlotElemRing::Emplace(const SfnSf& sfn)
+{
+    const uint64_t slot = sfn.Normalize();
+    while (true)
+    {
+        Entry& entry = m_entries[slot % m_entries.size()];
+        if (!entry.m_used)
+        {
+            // Reuse the entry, keeping the capacity of its vector
+            entry.m_used = true;
+            entry.m_slot = slot;
+            entry.m_elem.m_totUlSym = 0;
+            entry.m_elem.m_ulAllocations.clear();
+            ++m_size;
+            return entry.m_elem;
+        }
+        if (entry.m_slot == slot)
+        {
+            return entry.m_elem;
+        }
+        if (m_entries.size() >= MAX_SLOTS)
+        {
+            NS_ASSERT(entry.m_slot < slot);
+            NS_LOG_WARN("Discarding the UL allocations of the stale slot " << entry.m_slot);
+            entry.m_used = false;
+            --m_size;
+            continue;
+        }
+        Grow();
+    }
+}
+
+void
+NrMacSchedulerNs3::SlotElemRing::Erase(const SfnSf& sfn)
+{
+    const uint64_t slot = sfn.Normalize();
+    Entry& entry = m_entries[slot % m_entries.size()];
+    NS_ASSERT_MSG(entry.m_used && entry.m_slot == slot, "Can't find allocation for " << sfn);
+    entry.m_used = false;
+    --m_size;
+}
+
+std::size_t
+NrMacSchedulerNs3::SlotElemRing::GetSize() const
+{
+    return m_size;
+}
+
+void
+NrMacSchedulerNs3::SlotElemRing::Grow()
+{
+    std::vector<Entry> old(m_entries.size() * 2);
+    old.swap(m_entries);
+    for (auto& entry : old)
+    {
+        if (!entry.m_used)
+        {
+            continue;
+        }
+        // The slots were different modulo the old size, so they are different
+        // modulo the new size as well
+        Entry& moved = m_entries[entry.m_slot % m_entries.size()];
+        NS_ASSERT(!moved.m_used);
+        moved.m_used = true;
+        moved.m_slot = entry.m_slot;
+        moved.m_elem.m_totUlSym = entry.m_elem.m_totUlSym;
+        moved.m_elem.m_ulAllocations.swap(entry.m_elem.m_ulAllocations);
+    }
+    NS_LOG_DEBUG("UL allocation ring grown to " << m_entries.size() << " slots");
+}
+
 } // namespace ns3
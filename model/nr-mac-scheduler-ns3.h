@@ -9,19 +9,26 @@
 #include "nr-amc.h"
 #include "nr-mac-harq-vector.h"
 #include "nr-mac-scheduler-cqi-management.h"
+#include "nr-mac-scheduler-dci-pool.h"
 #include "nr-mac-scheduler-lcg.h"
+#include "nr-mac-scheduler-profiler.h"
 #include "nr-mac-scheduler-ue-info.h"
 #include "nr-mac-scheduler.h"
 #include "nr-phy-mac-common.h"
 
+#include <ns3/traced-callback.h>
+
 #include <functional>
 #include <list>
 #include <memory>
+#include <set>
 
 namespace ns3
 {
 
 class NrSchedGeneralTestCase;
+class TestSchedulerActiveUe;
+class TestSchedulerConfiguredGrant;
 class NrMacSchedulerHarqRr;
 class NrMacSchedulerSrsDefault;
 class NrMacSchedulerLcAlgorithm;
@@ -65,6 +72,14 @@ class NrMacSchedulerLcAlgorithm;
  * information such as Logical Channels, CQI, and other things. Please refer
  * to its documentation for a broader overview of its possibilities.
  *
+ * A subclass can ask (SetCompactIdleUes()) to keep only a compact record of
+ * the idle UEs: at the end of each DL slot, the UEs without data, HARQ
+ * processes, configured grants or pending SR lose their representation, and
+ * their beam, SRS, LC configuration and WB CQI are kept in a few bytes. The
+ * representation is created again, through CreateUeRepresentation(), as soon
+ * as the UE is referred by a message other than a WB CQI of a single stream
+ * (which is stored in the record) or an empty BSR.
+ *
  * \section scheduler_cell_conf Cell configuration
  *
  * The cell configuration, done with a call to DoCschedCellConfigReq, is ignored.
@@ -332,8 +347,12 @@ class NrMacSchedulerNs3 : public NrMacScheduler
     void DoSchedSetMcs(uint32_t mcs) override;
     void DoSchedDlRachInfoReq(
         const NrMacSchedSapProvider::SchedDlRachInfoReqParameters& params) override;
+    void DoSchedDlMiniSlotReq(
+        const NrMacSchedSapProvider::SchedDlMiniSlotReqParameters& params) override;
     uint8_t GetDlCtrlSyms() const override;
     uint8_t GetUlCtrlSyms() const override;
+    uint64_t GetDlBufferSize() const override;
+    uint64_t GetUlBufferSize() const override;
     /**
      * \brief Assign a fixed random variable stream number to the random variables
      * used by this model. Return the number of streams (possibly zero) that
@@ -344,6 +363,58 @@ class NrMacSchedulerNs3 : public NrMacScheduler
      */
     int64_t AssignStreams(int64_t stream) override;
 
+    /**
+     * \brief Get the pool from which the DCIs of this scheduler are created
+     * \return the DCI pool
+     */
+    const NrMacSchedulerDciPool& GetDciPool() const;
+
+    /**
+     * \brief Get the per-phase profile of the scheduling
+     * \return the profiler
+     *
+     * The profiler is filled only if the module is built with the CMake option
+     * NR_SCHEDULER_PROFILING; otherwise, it stays empty.
+     */
+    const NrMacSchedulerProfiler& GetProfiler() const;
+
+    /**
+     * \brief Get the number of UEs with a representation
+     * \return the number of UEs in the UE map; with compact idle UEs (see
+     * SetCompactIdleUes()), the idle UEs are not counted
+     */
+    std::size_t GetNumUeRepresentations() const;
+
+    /**
+     * \brief Add a configured grant (DL SPS or UL configured grant) to a UE
+     * \param rnti RNTI of the UE
+     * \param grant periodicity, symbols and MCS of the grant
+     *
+     * The symbols of every occasion are reserved, so the dynamic scheduling
+     * uses the other symbols of the slot. A DL occasion is used when the LC of
+     * the grant has data and the HARQ process of the grant is free; in UL, the
+     * UE transmits in every occasion. The first occasion used has a DCI, which
+     * activates the grant at the UE; the following ones have no DCI.
+     *
+     * The DL symbols must start after the DL CTRL, and the UL symbols must end
+     * before the SRS symbols, if any: otherwise, the simulation aborts.
+     * Usually called by NrHelper::AddConfiguredGrant, once the UE is connected.
+     */
+    void AddConfiguredGrant(uint16_t rnti, const NrConfiguredGrant& grant);
+
+    /**
+     * \brief Remove the configured grants of a UE in a direction (Type-2 deactivation)
+     * \param rnti RNTI of the UE
+     * \param format DL (SPS) or UL
+     *
+     * A grant that was never activated is removed at once. An active grant is
+     * removed at its next occasion, which carries a release DCI without data
+     * instead of a TB: the UE stops using the grant when it receives it. Then,
+     * the HARQ process of the grant is released, and it becomes available to
+     * the dynamic allocations once its last TB is acknowledged or expires.
+     */
+    void RemoveConfiguredGrant(uint16_t rnti, DciInfoElementTdma::DciFormat format);
+
     // to save some typing
     using HarqVectorIterator = NrMacHarqVector::iterator;
     using HarqVectorIteratorList = std::vector<HarqVectorIterator>;
@@ -361,11 +432,61 @@ class NrMacSchedulerNs3 : public NrMacScheduler
      * \brief Map between a BeamConfId and the symbol assigned to that beam
      */
     typedef std::unordered_map<BeamConfId, uint32_t, BeamConfIdHash> BeamSymbolMap;
+    /**
+     * \brief Groups of beams whose UEs share the same symbols (MU-MIMO), in the
+     * order in which the groups are placed in the slot
+     */
+    typedef std::vector<std::vector<BeamConfId>> BeamGroups;
     /**
      * \brief Map between a BeamConfId and the HARQ of that beam
      */
     typedef std::unordered_map<BeamConfId, HarqVectorIteratorList, BeamConfIdHash> ActiveHarqMap;
 
+    /**
+     * \brief TracedCallback signature for the resources assigned to a UE that did
+     * not get a DCI, because they were not enough for a TB with data
+     * \param [in] sfnSf the slot
+     * \param [in] rnti the RNTI of the UE
+     * \param [in] format DL or UL
+     * \param [in] rbg the RBG assigned to the UE, counted once per symbol
+     */
+    typedef void (*WastedResourcesTracedCallback)(const SfnSf& sfnSf,
+                                                  uint16_t rnti,
+                                                  DciInfoElementTdma::DciFormat format,
+                                                  uint32_t rbg);
+
+    /**
+     * \brief TracedCallback signature for the update of the OLLA of a UE, after
+     * the HARQ feedback of a first transmission
+     * \param [in] sfnSf the slot in which the feedback is processed
+     * \param [in] rnti the RNTI of the UE
+     * \param [in] format DL or UL
+     * \param [in] offset the new offset, in MCS indexes
+     * \param [in] bler the ratio of NACK among the first transmissions so far
+     */
+    typedef void (*OllaTracedCallback)(const SfnSf& sfnSf,
+                                       uint16_t rnti,
+                                       DciInfoElementTdma::DciFormat format,
+                                       double offset,
+                                       double bler);
+
+    /**
+     * \brief TracedCallback signature for the addition of a configured grant
+     * \param [in] rnti the RNTI of the UE
+     * \param [in] grant the grant
+     */
+    typedef void (*ConfiguredGrantAddedTracedCallback)(uint16_t rnti,
+                                                       const NrConfiguredGrant& grant);
+
+    /**
+     * \brief TracedCallback signature for the removal of the configured grants
+     * of a UE in a direction
+     * \param [in] rnti the RNTI of the UE
+     * \param [in] format DL or UL
+     */
+    typedef void (*ConfiguredGrantRemovedTracedCallback)(uint16_t rnti,
+                                                         DciInfoElementTdma::DciFormat format);
+
     /**
      * \brief Set the CqiTimerThreshold
      * \param v the value to set
@@ -606,6 +727,19 @@ class NrMacSchedulerNs3 : public NrMacScheduler
      */
     virtual BeamSymbolMap AssignDLRBG(uint32_t symAvail, const ActiveUeMap& activeDl) const = 0;
 
+    /**
+     * \brief Group the DL beams whose UEs are co-scheduled on the same symbols
+     * \param activeDl Map of Beam and active UE per beam
+     * \return the groups of beams, in the order in which they are placed in the slot
+     *
+     * The beams of a group get the same symbols from AssignDLRBG(), and their
+     * DCIs start from the same point: each beam is a layer of a MU-MIMO
+     * transmission (see DciInfoElementTdma::m_layer). The default is a group
+     * for each beam, in the order of activeDl, i.e., the beams are multiplexed
+     * in time.
+     */
+    virtual BeamGroups GetDlBeamGroups(const ActiveUeMap& activeDl) const;
+
     /**
      * \brief Assign the UL RBG to the active UE, and return the distribution of symbols per beam
      * \param symAvail available symbols for UL
@@ -698,9 +832,34 @@ class NrMacSchedulerNs3 : public NrMacScheduler
     uint64_t GetNumRbPerRbg() const;
 
   protected:
+    /**
+     * \brief Print the summary of the profile, if the profiling is built
+     */
+    void DoDispose() override;
+
+    /**
+     * \brief Keep only a compact record of the idle UEs
+     * \param compact true to remove the representation of the idle UEs
+     *
+     * Only a scheduler whose UE representation has no state other than the one
+     * of NrMacSchedulerUeInfo can use it: the representation is created again
+     * with the values of the record only. It must be set before the UEs are
+     * configured; the UEs are never compacted when the OLLA is enabled, since
+     * its offset is part of the state of the UE.
+     */
+    void SetCompactIdleUes(bool compact);
+
+    /**
+     * \return true if only a compact record of the idle UEs is kept
+     */
+    bool IsCompactIdleUes() const;
+
     Ptr<NrAmc> m_dlAmc; //!< AMC pointer
     Ptr<NrAmc> m_ulAmc; //!< AMC pointer
 
+    // Written by the NR_SCHEDULER_PROFILE_PHASE macro, also in const methods
+    mutable NrMacSchedulerProfiler m_profiler; //!< Per-phase profile of the scheduling
+
   private:
     /**
      * \brief Single UL allocation for calculating CQI and the number of reserved UL symbols in
@@ -774,6 +933,206 @@ class NrMacSchedulerNs3 : public NrMacScheduler
         std::vector<AllocElem> m_ulAllocations; //!< List of UL allocations
     };
 
+    /**
+     * \brief The UL allocations of the slots that are waiting for their UL-CQI
+     *
+     * The UL allocations are registered when the UL is scheduled, K2 slots in
+     * advance, and removed when the UL-CQI of the slot is received, so only a
+     * window of consecutive slots is alive at any time. The ring stores the
+     * SlotElem of each slot in a vector indexed by the slot number modulo the
+     * size of the vector: finding, inserting, and removing a slot does not
+     * need any tree traversal or allocation, and the vector of allocations of
+     * a removed slot keeps its capacity for the slot that reuses the entry.
+     *
+     * If a slot is inserted while its entry is taken by another slot that is
+     * still alive (i.e., the window is larger than the ring) the ring doubles
+     * its size, up to MAX_SLOTS. Beyond that, the oldest slot is considered
+     * stale (e.g., its UE was released before sending the UL) and overwritten.
+     */
+    class SlotElemRing
+    {
+      public:
+        /**
+         * \brief SlotElemRing constructor
+         */
+        SlotElemRing();
+
+        /**
+         * \brief Find the allocations of a slot
+         * \param sfn the slot
+         * \return a pointer to the allocations, or nullptr if the slot is not in the ring
+         */
+        SlotElem* Find(const SfnSf& sfn);
+
+        /**
+         * \brief Get the allocations of a slot, inserting an empty element if
+         * the slot is not in the ring
+         * \param sfn the slot
+         * \return the allocations of the slot
+         *
+         * Inserting a slot may grow the ring, which invalidates the references
+         * and pointers previously returned by Find() and Emplace().
+         */
+        SlotElem& Emplace(const SfnSf& sfn);
+
+        /**
+         * \brief Remove a slot from the ring
+         * \param sfn the slot
+         */
+        void Erase(const SfnSf& sfn);
+
+        /**
+         * \return the number of slots in the ring
+         */
+        std::size_t GetSize() const;
+
+      private:
+        /**
+         * \brief An entry of the ring
+         */
+        struct Entry
+        {
+            /**
+             * \brief Entry constructor
+             */
+            Entry()
+                : m_elem(0)
+            {
+            }
+
+            uint64_t m_slot{0}; //!< Normalized slot number of the element
+            bool m_used{false}; //!< True if the entry holds a slot
+            SlotElem m_elem;    //!< The allocations of the slot
+        };
+
+        /**
+         * \brief Double the size of the ring, moving each slot to its new entry
+         */
+        void Grow();
+
+        static constexpr std::size_t INITIAL_SLOTS = 16; //!< Initial size of the ring
+        static constexpr std::size_t MAX_SLOTS = 4096;   //!< Maximum size of the ring
+
+        std::vector<Entry> m_entries; //!< The entries, indexed by slot number modulo their size
+        std::size_t m_size{0};        //!< Number of used entries
+    };
+
+    /**
+     * \brief Compact record of a UE, when only the record of the idle UEs is kept
+     *
+     * The record of a UE with a representation holds only its LC configuration;
+     * the other values are valid when the UE is idle (flag PARKED), and are the
+     * ones needed to create again its representation: the idle UEs have a
+     * single DL stream, no data, no HARQ process and a neutral OLLA.
+     */
+    struct CompactUe
+    {
+        /**
+         * \brief Flags of the record
+         */
+        enum Flags : uint8_t
+        {
+            PARKED = 1,       //!< The UE has only this record
+            DL_WB_CQI = 2,    //!< A DL WB CQI has been reported
+            DL_CQI_VALID = 4, //!< The DL CQI is not expired
+            UL_CQI_VALID = 8, //!< The UL CQI is not expired
+            UL_CQI_SB = 16    //!< The UL CQI is of type SB
+        };
+
+        uint16_t m_beam{0};           //!< Index of the beam in m_compactBeams
+        uint16_t m_lcConfig{0};       //!< Index of the LC configuration in m_compactLcConfigs
+        uint16_t m_srsPeriodicity{0}; //!< SRS periodicity (0 without SRS)
+        uint16_t m_srsOffset{0};      //!< SRS offset
+        uint8_t m_dlRi{1};            //!< DL rank indicator
+        uint8_t m_dlWbCqi{0};         //!< DL WB CQI
+        uint8_t m_dlCqiMcs{0};        //!< DL MCS of the WB CQI
+        uint8_t m_dlMcs{0};           //!< DL MCS
+        uint8_t m_ulCqi{0};           //!< UL CQI
+        uint8_t m_ulCqiMcs{0};        //!< UL MCS of the CQI
+        uint8_t m_ulMcs{0};           //!< UL MCS
+        uint8_t m_flags{0};           //!< Flags (see Flags)
+    };
+
+    /**
+     * \param rnti the UE
+     * \return true if the UE has only its compact record
+     */
+    bool IsParked(uint16_t rnti) const;
+
+    /**
+     * \param ue the UE
+     * \return true if the representation of the UE can be replaced by its compact record
+     */
+    bool IsIdle(const UePtr& ue) const;
+
+    /**
+     * \brief Replace the representation of the idle UEs with their compact record
+     */
+    void ParkIdleUes();
+
+    /**
+     * \brief Create again the representation of a UE, if it has only its compact record
+     * \param rnti the UE
+     */
+    void UnparkUe(uint16_t rnti);
+
+    /**
+     * \brief Copy the CQI and MCS values of a record into a UE representation
+     * \param record the record
+     * \param ue the UE representation
+     */
+    void LoadCompactUe(const CompactUe& record, const UePtr& ue) const;
+
+    /**
+     * \brief Copy the CQI and MCS values of an idle UE into its record
+     * \param ue the UE representation
+     * \param record the record
+     */
+    static void StoreCompactUe(const UePtr& ue, CompactUe* record);
+
+    /**
+     * \param rnti the UE
+     * \return a representation, shared by all the UEs with only their record,
+     * with the CQI and MCS values of the record of the UE
+     *
+     * It is used to update the record with NrMacSchedulerCQIManagement,
+     * without creating the representation of the UE.
+     */
+    const UePtr& LoadCompactScratch(uint16_t rnti);
+
+    /**
+     * \param beamConfId a beam
+     * \return the index of the beam in m_compactBeams, assigned at its first use
+     */
+    uint16_t GetCompactBeamIndex(const BeamConfId& beamConfId);
+
+    /**
+     * \param configs the configuration of the LCs of a UE
+     * \return the index of the configuration in m_compactLcConfigs, assigned at
+     * its first use
+     */
+    uint16_t GetCompactLcConfigIndex(const std::vector<LogicalChannelConfigListElement_s>& configs);
+
+    /**
+     * \brief Create and initialize the representation of a UE
+     * \param params the configuration of the UE
+     * \return the representation, with the starting MCS and without LC
+     */
+    UePtr NewUeRepresentation(
+        const NrMacCschedSapProvider::CschedUeConfigReqParameters& params) const;
+
+    /**
+     * \brief Create the LCs of a UE
+     * \param ue the UE
+     * \param configs the configuration of the LCs
+     */
+    void AddLcs(const UePtr& ue, const std::vector<LogicalChannelConfigListElement_s>& configs);
+
+    /**
+     * \return the validity of a CQI, in slots
+     */
+    uint32_t GetCqiExpirationTime() const;
+
     void BSRReceivedFromUe(const MacCeElement& bsr);
 
     template <typename T>
@@ -788,6 +1147,12 @@ class NrMacSchedulerNs3 : public NrMacScheduler
                               const NrMacSchedulerUeInfo::GetHarqVectorFn& GetHarqVectorFn,
                               const std::string& direction) const;
 
+    template <typename T>
+    void ProcessOllaFeedbacks(const std::vector<T>& harqInfo,
+                              const NrMacSchedulerUeInfo::GetHarqVectorFn& GetHarqVectorFn,
+                              DciInfoElementTdma::DciFormat format,
+                              const SfnSf& sfnSf);
+
     void ScheduleDl(const NrMacSchedSapProvider::SchedDlTriggerReqParameters& params,
                     const std::vector<DlHarqInfo>& dlHarqInfo);
 
@@ -806,7 +1171,8 @@ class NrMacSchedulerNs3 : public NrMacScheduler
     void ComputeActiveUe(ActiveUeMap* activeDlUe,
                          const NrMacSchedulerUeInfo::GetLCGFn& GetLCGFn,
                          const NrMacSchedulerUeInfo::GetHarqVectorFn& GetHarqVector,
-                         const std::string& mode) const;
+                         const std::string& mode,
+                         std::set<uint16_t>* candidates) const;
     void ComputeActiveHarq(ActiveHarqMap* activeDlHarq,
                            const std::vector<DlHarqInfo>& dlHarqFeedback) const;
     void ComputeActiveHarq(ActiveHarqMap* activeUlHarq,
@@ -832,6 +1198,19 @@ class NrMacSchedulerNs3 : public NrMacScheduler
                          SlotAllocInfo* allocInfo,
                          LteNrTddSlotType type);
     uint8_t DoScheduleSrs(PointInFTPlane* spoint, SlotAllocInfo* allocInfo);
+    uint8_t GetDlConfiguredGrantSym(const SfnSf& sfnSf) const;
+    uint8_t ScheduleDlConfiguredGrants(const SfnSf& dlSfnSf,
+                                       uint8_t dlSymAvail,
+                                       SlotAllocInfo* allocInfo);
+    uint8_t ScheduleUlConfiguredGrants(const SfnSf& ulSfn,
+                                       PointInFTPlane* spoint,
+                                       uint8_t lowestSym,
+                                       std::set<std::pair<uint16_t, uint8_t>>* flushedHarq,
+                                       SlotAllocInfo* allocInfo);
+    std::shared_ptr<DciInfoElementTdma> CreateConfiguredGrantRelease(
+        uint16_t rnti,
+        const NrMacSchedulerUeInfo::ConfiguredGrant& grant) const;
+    void EraseReleasedConfiguredGrants(const std::set<uint16_t>& rntis);
 
     static const unsigned m_macHdrSize = 0; //!< Mac Header size
     static const uint32_t m_subHdrSize = 4; //!< Sub Header size (?)
@@ -860,10 +1239,10 @@ class NrMacSchedulerNs3 : public NrMacScheduler
         m_ueMap; //!< The map of between RNTI and their data
 
     /**
-     * Map of previous allocated UE per RBG
+     * Ring of previous allocated UE per RBG
      * (used to retrieve info from UL-CQI)
      */
-    std::map<uint64_t, SlotElem> m_ulAllocationMap;
+    SlotElemRing m_ulAllocationMap;
 
     bool m_fixedMcsDl{false};  //!< Fixed MCS for *all* UE in DL
     bool m_fixedMcsUl{false};  //!< Fixed MCS for *all* UE in UL
@@ -903,8 +1282,53 @@ class NrMacSchedulerNs3 : public NrMacScheduler
     uint32_t m_srsSlotCounter{0}; //!< Counter for UL slots
 
     friend NrSchedGeneralTestCase;
+    friend TestSchedulerActiveUe;
+    friend TestSchedulerConfiguredGrant;
 
     bool m_enableHarqReTx{true}; //!< Flag to enable or disable HARQ ReTx (attribute)
+
+    NrMacSchedulerDciPool m_dciPool; //!< Pool of the DCIs created by the scheduler
+
+    TracedCallback<const NrMacSchedulerProfiler::SlotProfile&>
+        m_slotProfileTrace; //!< Per-phase profile of each scheduled slot
+
+    TracedCallback<const SfnSf&, uint16_t, DciInfoElementTdma::DciFormat, uint32_t>
+        m_wastedResourcesTrace; //!< Resources assigned to a UE that did not get a DCI
+
+    bool m_ollaEnabled{false};     //!< Enable the OLLA (attribute)
+    double m_ollaTargetBler{0.1};  //!< Target BLER of the OLLA (attribute)
+    double m_ollaStep{0.5};        //!< Offset step of the OLLA after a NACK (attribute)
+    double m_ollaMinOffset{-10.0}; //!< Minimum offset of the OLLA (attribute)
+    double m_ollaMaxOffset{5.0};   //!< Maximum offset of the OLLA (attribute)
+
+    TracedCallback<const SfnSf&, uint16_t, DciInfoElementTdma::DciFormat, double, double>
+        m_ollaTrace; //!< Offset and BLER of the OLLA of a UE, after each feedback
+
+    bool m_incrementalActiveUe{false}; //!< Search the active UEs among the candidates (attribute)
+    std::set<uint16_t> m_dlActiveUeCandidates; //!< RNTIs of the UEs that may have DL data
+    std::set<uint16_t> m_ulActiveUeCandidates; //!< RNTIs of the UEs that may have UL data
+
+    // The HARQ processes are created while scheduling data, in const methods
+    mutable std::set<uint16_t> m_dlHarqActiveUes; //!< RNTIs of the UEs with active DL HARQ
+    mutable std::set<uint16_t> m_ulHarqActiveUes; //!< RNTIs of the UEs with active UL HARQ
+
+    std::set<uint16_t> m_configuredGrantUes; //!< RNTIs of the UEs with a configured grant
+    std::set<uint16_t> m_miniSlotUes;        //!< RNTIs of the UEs with a delay-critical GBR LC
+
+    bool m_compactIdleUes{false};           //!< Keep only the record of the idle UEs
+    std::vector<CompactUe> m_compactUes;    //!< Records of the UEs, by RNTI
+    std::vector<BeamConfId> m_compactBeams; //!< Beams of the records
+    std::unordered_map<BeamConfId, uint16_t, BeamConfIdHash>
+        m_compactBeamIndex; //!< Index of each beam in m_compactBeams
+    std::vector<std::vector<LogicalChannelConfigListElement_s>>
+        m_compactLcConfigs;          //!< LC configurations of the records
+    UePtr m_compactScratch;          //!< Representation to update the records
+    std::vector<uint16_t> m_expired; //!< UEs with only a record whose CQI expires
+
+    TracedCallback<uint16_t, const NrConfiguredGrant&>
+        m_configuredGrantAddedTrace; //!< Configured grants added to the UEs
+    TracedCallback<uint16_t, DciInfoElementTdma::DciFormat>
+        m_configuredGrantRemovedTrace; //!< Configured grants removed from the UEs
 };
 
 } // namespace ns3
@@ -0,0 +1,287 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "nr-mac-scheduler-ofdma-class.h"
+
+#include "nr-amc.h"
+
+#include <ns3/boolean.h>
+#include <ns3/enum.h>
+#include <ns3/log.h>
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("NrMacSchedulerOfdmaClass");
+NS_OBJECT_ENSURE_REGISTERED(NrMacSchedulerOfdmaClass);
+
+TypeId
+NrMacSchedulerOfdmaClass::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::NrMacSchedulerOfdmaClass")
+            .SetParent<NrMacSchedulerOfdmaRR>()
+            .AddConstructor<NrMacSchedulerOfdmaClass>()
+            .AddAttribute("ClassPolicy",
+                          "Order of the UEs inside a class: FIFO keeps a served UE first "
+                          "until it has no more data, RR moves it after the other UEs",
+                          EnumValue(NrMacSchedulerUeClasses::RR),
+                          MakeEnumAccessor(&NrMacSchedulerOfdmaClass::SetClassPolicy,
+                                           &NrMacSchedulerOfdmaClass::GetClassPolicy),
+                          MakeEnumChecker(NrMacSchedulerUeClasses::FIFO,
+                                          "FIFO",
+                                          NrMacSchedulerUeClasses::RR,
+                                          "RR"))
+            .AddAttribute("CompactIdleUes",
+                          "Keep only a compact record of the UEs without data, HARQ "
+                          "processes or configured grants, instead of their full information",
+                          BooleanValue(true),
+                          MakeBooleanAccessor(&NrMacSchedulerOfdmaClass::SetCompactIdleUes,
+                                              &NrMacSchedulerOfdmaClass::IsCompactIdleUes),
+                          MakeBooleanChecker());
+    return tid;
+}
+
+NrMacSchedulerOfdmaClass::NrMacSchedulerOfdmaClass()
+    : NrMacSchedulerOfdmaRR()
+{
+}
+
+void
+NrMacSchedulerOfdmaClass::SetClassPolicy(NrMacSchedulerUeClasses::Policy policy)
+{
+    NS_LOG_FUNCTION(this << static_cast<uint32_t>(policy));
+    m_dlClasses.SetPolicy(policy);
+    m_ulClasses.SetPolicy(policy);
+}
+
+NrMacSchedulerUeClasses::Policy
+NrMacSchedulerOfdmaClass::GetClassPolicy() const
+{
+    return m_dlClasses.GetPolicy();
+}
+
+const NrMacSchedulerUeClasses&
+NrMacSchedulerOfdmaClass::GetDlClasses() const
+{
+    return m_dlClasses;
+}
+
+const NrMacSchedulerUeClasses&
+NrMacSchedulerOfdmaClass::GetUlClasses() const
+{
+    return m_ulClasses;
+}
+
+void
+NrMacSchedulerOfdmaClass::DoCschedUeReleaseReq(
+    const NrMacCschedSapProvider::CschedUeReleaseReqParameters& params)
+{
+    NS_LOG_FUNCTION(this << params.m_rnti);
+    NrMacSchedulerOfdmaRR::DoCschedUeReleaseReq(params);
+
+    m_dlClasses.Remove(params.m_rnti);
+    m_ulClasses.Remove(params.m_rnti);
+}
+
+uint16_t
+NrMacSchedulerOfdmaClass::GetBeamIndex(const BeamConfId& beamConfId) const
+{
+    auto it = m_beamIndex.find(beamConfId);
+    if (it == m_beamIndex.end())
+    {
+        NS_ABORT_MSG_IF(m_beamIndex.size() >= NrMacSchedulerUeClasses::NO_BEAM,
+                        "Too many beams for the classes of the UEs");
+        it = m_beamIndex.emplace(beamConfId, static_cast<uint16_t>(m_beamIndex.size())).first;
+    }
+    return it->second;
+}
+
+/**
+ * \brief Assign the available DL RBG to the classes of the UEs
+ * \param symAvail Available symbols
+ * \param activeDl Map of active UE and their beams
+ * \return a map between beams and the symbol they need
+ *
+ * The symbols of each beam are the ones of the other OFDMA schedulers. The
+ * active UEs of each beam are added to the pending lists of their classes,
+ * and the RBG are assigned by AssignClasses().
+ */
+NrMacSchedulerNs3::BeamSymbolMap
+NrMacSchedulerOfdmaClass::AssignDLRBG(uint32_t symAvail, const ActiveUeMap& activeDl) const
+{
+    NS_LOG_FUNCTION(this);
+    GetFirst GetBeamId;
+    GetSecond GetUeVector;
+    BeamSymbolMap symPerBeam = GetDlSymPerBeam(symAvail, activeDl);
+    m_dlClasses.NewSlot();
+
+    const std::vector<uint8_t> dlNotchedRBGsMask = GetDlNotchedRbgMask();
+    const uint32_t resources = dlNotchedRBGsMask.size() > 0
+                                   ? std::count(dlNotchedRBGsMask.begin(),
+                                                dlNotchedRBGsMask.end(),
+                                                1)
+                                   : GetBandwidthInRbg();
+    NS_ASSERT(resources > 0);
+
+    for (const auto& el : activeDl)
+    {
+        const uint32_t beamSym = symPerBeam.at(GetBeamId(el));
+        const uint16_t beam = GetBeamIndex(GetBeamId(el));
+        const auto& ueVector = GetUeVector(el);
+        for (uint32_t i = 0; i < ueVector.size(); ++i)
+        {
+            const auto& ue = ueVector.at(i).first;
+            m_dlClasses.Activate(ue->m_rnti, beam, ue->m_dlMcs.front(), i);
+        }
+        if (beamSym == 0)
+        {
+            continue;
+        }
+
+        auto tbSize = [&](uint8_t mcs, uint32_t rbg) {
+            return m_dlAmc->CalculateTbSize(mcs, rbg * beamSym * GetNumRbPerRbg());
+        };
+        auto assign = [&](const UePtrAndBufferReq& ue, uint32_t rbg) {
+            ue.first->m_dlRBG = rbg * beamSym;
+            ue.first->m_dlSym = beamSym;
+            ue.first->UpdateDlMetric(m_dlAmc);
+            TrimUnneededDlStreams(ue.first, ue.second);
+            NS_LOG_DEBUG("Assigned " << rbg * beamSym << " DL RBG, spanned over " << beamSym
+                                     << " SYM, to UE " << ue.first->m_rnti);
+        };
+        AssignClasses(&m_dlClasses, beam, ueVector, resources, MIN_DL_TB_SIZE, tbSize, assign);
+    }
+
+    return symPerBeam;
+}
+
+NrMacSchedulerNs3::BeamSymbolMap
+NrMacSchedulerOfdmaClass::AssignULRBG(uint32_t symAvail, const ActiveUeMap& activeUl) const
+{
+    NS_LOG_FUNCTION(this);
+    GetFirst GetBeamId;
+    GetSecond GetUeVector;
+    BeamSymbolMap symPerBeam = GetSymPerBeam(symAvail, activeUl);
+    m_ulClasses.NewSlot();
+
+    const std::vector<uint8_t> ulNotchedRBGsMask = GetUlNotchedRbgMask();
+    const uint32_t resources = ulNotchedRBGsMask.size() > 0
+                                   ? std::count(ulNotchedRBGsMask.begin(),
+                                                ulNotchedRBGsMask.end(),
+                                                1)
+                                   : GetBandwidthInRbg();
+    NS_ASSERT(resources > 0);
+
+    for (const auto& el : activeUl)
+    {
+        const uint32_t beamSym = symPerBeam.at(GetBeamId(el));
+        const uint16_t beam = GetBeamIndex(GetBeamId(el));
+        const auto& ueVector = GetUeVector(el);
+        for (uint32_t i = 0; i < ueVector.size(); ++i)
+        {
+            const auto& ue = ueVector.at(i).first;
+            m_ulClasses.Activate(ue->m_rnti, beam, ue->m_ulMcs, i);
+        }
+        if (beamSym == 0)
+        {
+            continue;
+        }
+
+        auto tbSize = [&](uint8_t mcs, uint32_t rbg) {
+            return m_ulAmc->CalculateTbSize(mcs, rbg * beamSym * GetNumRbPerRbg());
+        };
+        auto assign = [&](const UePtrAndBufferReq& ue, uint32_t rbg) {
+            ue.first->m_ulRBG = rbg * beamSym;
+            ue.first->m_ulSym = beamSym;
+            ue.first->UpdateUlMetric(m_ulAmc);
+            NS_LOG_DEBUG("Assigned " << rbg * beamSym << " UL RBG, spanned over " << beamSym
+                                     << " SYM, to UE " << ue.first->m_rnti);
+        };
+        AssignClasses(&m_ulClasses, beam, ueVector, resources, MIN_UL_TB_SIZE, tbSize, assign);
+    }
+
+    return symPerBeam;
+}
+
+/**
+ * \brief Assign the RBG of a beam to its classes
+ *
+ * The classes are visited from the one after the last class that got RBG in
+ * the previous slot. The UEs of a class are taken from the front of its
+ * pending list: each one gets the RBG for a TB that holds its buffer, or all
+ * the remaining RBG. When the remaining RBG are not enough for a TB with
+ * data with the MCS of the class, no other UE of the class can use them, and
+ * the next class is visited. The TB size of each number of RBG is computed
+ * once per class.
+ */
+void
+NrMacSchedulerOfdmaClass::AssignClasses(NrMacSchedulerUeClasses* classes,
+                                        uint16_t beam,
+                                        const std::vector<UePtrAndBufferReq>& ueVector,
+                                        uint32_t resources,
+                                        uint32_t minTbSize,
+                                        const TbSizeFn& tbSize,
+                                        const AssignFn& assign) const
+{
+    NS_LOG_FUNCTION(this << beam << resources);
+    const uint8_t firstClass = classes->GetFirstClass(beam);
+    std::vector<uint32_t> tbSizes;
+
+    for (uint8_t i = 0; i < NrMacSchedulerUeClasses::NUM_CLASSES && resources > 0; ++i)
+    {
+        const uint8_t mcs = (firstClass + i) % NrMacSchedulerUeClasses::NUM_CLASSES;
+        uint16_t rnti = 0;
+        uint32_t index = 0;
+        if (!classes->Front(beam, mcs, &rnti, &index))
+        {
+            continue;
+        }
+
+        // TB size by number of RBG, filled only as far as needed
+        tbSizes.assign(1, 0);
+        auto getTbSize = [&](uint32_t rbg) {
+            while (tbSizes.size() <= rbg)
+            {
+                tbSizes.push_back(tbSize(mcs, static_cast<uint32_t>(tbSizes.size())));
+            }
+            return tbSizes.at(rbg);
+        };
+
+        bool served = false;
+        do
+        {
+            if (getTbSize(resources) < minTbSize)
+            {
+                NS_LOG_INFO("The " << resources << " RBG left are not enough for MCS "
+                                   << +mcs);
+                break;
+            }
+            const auto& ue = ueVector.at(index);
+            NS_ASSERT(ue.first->m_rnti == rnti);
+            const uint32_t needed = std::max(ue.second, minTbSize);
+            uint32_t rbg = 1;
+            while (rbg < resources && getTbSize(rbg) < needed)
+            {
+                ++rbg;
+            }
+            assign(ue, rbg);
+            resources -= rbg;
+            classes->Serve(beam, mcs);
+            served = true;
+        } while (resources > 0 && classes->Front(beam, mcs, &rnti, &index));
+
+        classes->Requeue();
+        if (served)
+        {
+            classes->SetFirstClass(beam, (mcs + 1) % NrMacSchedulerUeClasses::NUM_CLASSES);
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,144 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include "nr-mac-scheduler-ofdma-rr.h"
+#include "nr-mac-scheduler-ue-classes.h"
+
+#include <functional>
+#include <unordered_map>
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief Assign frequencies to classes of UEs with the same beam and MCS
+ *
+ * The other OFDMA schedulers assign the RBGs of a beam one by one, and
+ * update the metric of every active UE of the beam for each of them, so that
+ * a slot costs O(RBG x UE). With thousands of low-rate UEs, most UEs share a
+ * handful of MCS values and need one or two RBGs: this scheduler groups them
+ * in classes, one per beam and MCS, kept in a NrMacSchedulerUeClasses. The
+ * classes of a beam are visited in round robin, starting after the last class
+ * that got resources in the previous slot; inside a class, the UEs are taken
+ * from a pending list, in FIFO or RR order (attribute "ClassPolicy"), and
+ * each of them gets at once the RBGs it needs to empty its buffer, or the
+ * remaining ones. The TB sizes are computed once per class, since all its UEs
+ * have the same MCS, and the UEs that do not get resources are not visited at
+ * all: a slot costs O(UE) for the activation of the UEs, plus O(1) for each
+ * UE that is served.
+ *
+ * The class of a UE is given by the MCS of its WB CQI (of the first stream,
+ * in DL): the RBGs are not selected with the SB CQI, and the rank of the UE
+ * is considered only when the TB sizes are computed, after the assignment.
+ * The attribute "IncrementalActiveUe" of NrMacSchedulerNs3 avoids visiting
+ * the UEs without data at every slot as well.
+ *
+ * The memory is reduced with the attribute "CompactIdleUes" (enabled by
+ * default): after each slot, the UEs without data, HARQ processes and
+ * configured grants, and with a single stream WB CQI, keep only a compact
+ * record in NrMacSchedulerNs3 (beam, LC configuration, SRS, CQI and MCS, see
+ * NrMacSchedulerNs3::SetCompactIdleUes), and their NrMacSchedulerUeInfo is
+ * released. It is created again, from the record, as soon as the UE receives
+ * data, sends a BSR or a SR, or reports anything but a single stream WB CQI.
+ * With OLLA enabled, the UEs are never compacted, since the OLLA state is not
+ * in the record.
+ */
+ */
+class NrMacSchedulerOfdmaClass : public NrMacSchedulerOfdmaRR
+{
+  public:
+    /**
+     * \brief GetTypeId
+     * \return The TypeId of the class
+     */
+    static TypeId GetTypeId();
+
+    /**
+     * \brief NrMacSchedulerOfdmaClass constructor
+     */
+    NrMacSchedulerOfdmaClass();
+
+    /**
+     * \brief ~NrMacSchedulerOfdmaClass deconstructor
+     */
+    ~NrMacSchedulerOfdmaClass() override
+    {
+    }
+
+    /**
+     * \brief Set the attribute "ClassPolicy"
+     * \param policy the order of the UEs inside a class
+     */
+    void SetClassPolicy(NrMacSchedulerUeClasses::Policy policy);
+
+    /**
+     * \brief Get the attribute "ClassPolicy"
+     * \return the order of the UEs inside a class
+     */
+    NrMacSchedulerUeClasses::Policy GetClassPolicy() const;
+
+    /**
+     * \return the DL classes of the UEs
+     */
+    const NrMacSchedulerUeClasses& GetDlClasses() const;
+
+    /**
+     * \return the UL classes of the UEs
+     */
+    const NrMacSchedulerUeClasses& GetUlClasses() const;
+
+    void DoCschedUeReleaseReq(
+        const NrMacCschedSapProvider::CschedUeReleaseReqParameters& params) override;
+
+  protected:
+    BeamSymbolMap AssignDLRBG(uint32_t symAvail, const ActiveUeMap& activeDl) const override;
+    BeamSymbolMap AssignULRBG(uint32_t symAvail, const ActiveUeMap& activeUl) const override;
+
+  private:
+    /**
+     * \brief TB size of the UEs of a class, given the MCS and the RBGs per symbol
+     */
+    typedef std::function<uint32_t(uint8_t mcs, uint32_t rbg)> TbSizeFn;
+
+    /**
+     * \brief Give the RBGs per symbol to a UE
+     */
+    typedef std::function<void(const UePtrAndBufferReq& ue, uint32_t rbg)> AssignFn;
+
+    /**
+     * \brief Assign the RBGs of a beam to its classes
+     * \param classes the classes of the direction
+     * \param beam the index of the beam
+     * \param ueVector the active UEs of the beam
+     * \param resources the RBGs per symbol of the beam
+     * \param minTbSize the minimum TB size with data
+     * \param tbSize the TB size of a class
+     * \param assign the assignment of the RBGs to a UE
+     */
+    void AssignClasses(NrMacSchedulerUeClasses* classes,
+                       uint16_t beam,
+                       const std::vector<UePtrAndBufferReq>& ueVector,
+                       uint32_t resources,
+                       uint32_t minTbSize,
+                       const TbSizeFn& tbSize,
+                       const AssignFn& assign) const;
+
+    /**
+     * \param beamConfId the beam
+     * \return the index of the beam in the classes, assigned at its first use
+     */
+    uint16_t GetBeamIndex(const BeamConfId& beamConfId) const;
+
+    mutable NrMacSchedulerUeClasses m_dlClasses; //!< DL pending lists
+    mutable NrMacSchedulerUeClasses m_ulClasses; //!< UL pending lists
+    mutable std::unordered_map<BeamConfId, uint16_t, BeamConfIdHash>
+        m_beamIndex; //!< Index of each beam in the classes
+};
+
+} // namespace ns3
@@ -0,0 +1,216 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "nr-mac-scheduler-ofdma-edf.h"
+
+#include "nr-mac-scheduler-ue-info-edf.h"
+
+#include <ns3/boolean.h>
+#include <ns3/eps-bearer.h>
+#include <ns3/log.h>
+#include <ns3/nstime.h>
+#include <ns3/simulator.h>
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("NrMacSchedulerOfdmaEdf");
+NS_OBJECT_ENSURE_REGISTERED(NrMacSchedulerOfdmaEdf);
+
+TypeId
+NrMacSchedulerOfdmaEdf::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::NrMacSchedulerOfdmaEdf")
+            .SetParent<NrMacSchedulerOfdmaQos>()
+            .AddConstructor<NrMacSchedulerOfdmaEdf>()
+            .AddAttribute("DeadlineGranularity",
+                          "Interval in which the deadlines of the UEs are considered equal, "
+                          "and the UEs are ordered by their PF metric",
+                          TimeValue(MilliSeconds(1)),
+                          MakeTimeAccessor(&NrMacSchedulerOfdmaEdf::m_granularity),
+                          MakeTimeChecker(NanoSeconds(1)))
+            .AddAttribute("DeprioritizeMissed",
+                          "Order the UEs by the deadlines that are not missed yet, and the "
+                          "UEs with only missed deadlines after the others",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&NrMacSchedulerOfdmaEdf::SetDeprioritizeMissed,
+                                              &NrMacSchedulerOfdmaEdf::GetDeprioritizeMissed),
+                          MakeBooleanChecker())
+            .AddTraceSource("DeadlineMissRate",
+                            "The deadline of an HOL packet has been resolved (met or missed), "
+                            "with the share of missed deadlines of its 5QI",
+                            MakeTraceSourceAccessor(
+                                &NrMacSchedulerOfdmaEdf::m_deadlineMissRateTrace),
+                            "ns3::NrMacSchedulerOfdmaEdf::DeadlineMissRateTracedCallback");
+    return tid;
+}
+
+NrMacSchedulerOfdmaEdf::NrMacSchedulerOfdmaEdf()
+    : NrMacSchedulerOfdmaQos()
+{
+    m_deadlines.SetResolvedCallback([this](uint16_t rnti, uint8_t lcId, uint8_t qci, bool missed) {
+        DeadlineResolved(rnti, lcId, qci, missed);
+    });
+}
+
+void
+NrMacSchedulerOfdmaEdf::SetDeprioritizeMissed(bool v)
+{
+    NS_LOG_FUNCTION(this << v);
+    m_deprioritizeMissed = v;
+    m_deadlines.SetDeprioritizeMissed(v);
+}
+
+bool
+NrMacSchedulerOfdmaEdf::GetDeprioritizeMissed() const
+{
+    return m_deprioritizeMissed;
+}
+
+const NrMacSchedulerDeadlineQueue&
+NrMacSchedulerOfdmaEdf::GetDeadlines() const
+{
+    return m_deadlines;
+}
+
+void
+NrMacSchedulerOfdmaEdf::DoCschedLcConfigReq(
+    const NrMacCschedSapProvider::CschedLcConfigReqParameters& params)
+{
+    NS_LOG_FUNCTION(this << params.m_rnti);
+    NrMacSchedulerOfdmaQos::DoCschedLcConfigReq(params);
+
+    for (const auto& lcConfig : params.m_logicalChannelConfigList)
+    {
+        if (lcConfig.m_direction == LogicalChannelConfigListElement_s::DIR_UL)
+        {
+            continue;
+        }
+        EpsBearer bearer(static_cast<EpsBearer::Qci>(lcConfig.m_qci));
+        const Time pdb = MilliSeconds(bearer.GetPacketDelayBudgetMs());
+        if (pdb.IsStrictlyPositive())
+        {
+            m_lcQos[{params.m_rnti, lcConfig.m_logicalChannelIdentity}] = {lcConfig.m_qci, pdb};
+        }
+    }
+}
+
+void
+NrMacSchedulerOfdmaEdf::DoCschedUeReleaseReq(
+    const NrMacCschedSapProvider::CschedUeReleaseReqParameters& params)
+{
+    NS_LOG_FUNCTION(this << params.m_rnti);
+    NrMacSchedulerOfdmaQos::DoCschedUeReleaseReq(params);
+
+    m_deadlines.RemoveUe(params.m_rnti);
+    m_lcQos.erase(m_lcQos.lower_bound({params.m_rnti, 0}),
+                  m_lcQos.upper_bound({params.m_rnti, UINT8_MAX}));
+}
+
+void
+NrMacSchedulerOfdmaEdf::DoSchedDlRlcBufferReq(
+    const NrMacSchedSapProvider::SchedDlRlcBufferReqParameters& params)
+{
+    NS_LOG_FUNCTION(this << params.m_rnti << +params.m_logicalChannelIdentity);
+    NrMacSchedulerOfdmaQos::DoSchedDlRlcBufferReq(params);
+
+    auto it = m_lcQos.find({params.m_rnti, params.m_logicalChannelIdentity});
+    if (it == m_lcQos.end())
+    {
+        return;
+    }
+
+    // The HOL packet is the oldest one among the queues with data
+    uint16_t holDelay = 0;
+    bool hasData = false;
+    if (params.m_rlcTransmissionQueueSize > 0)
+    {
+        holDelay = params.m_rlcTransmissionQueueHolDelay;
+        hasData = true;
+    }
+    if (params.m_rlcRetransmissionQueueSize > 0)
+    {
+        holDelay = std::max(holDelay, params.m_rlcRetransmissionHolDelay);
+        hasData = true;
+    }
+
+    const Time now = Simulator::Now();
+    if (!hasData)
+    {
+        m_deadlines.Remove(params.m_rnti, params.m_logicalChannelIdentity, now);
+        return;
+    }
+
+    const Time deadline = now - MilliSeconds(holDelay) + it->second.m_pdb;
+    NS_LOG_DEBUG("UE " << params.m_rnti << " LC " << +params.m_logicalChannelIdentity
+                       << " HOL delay " << holDelay << " ms, deadline " << deadline.As(Time::MS));
+    m_deadlines.Update(params.m_rnti,
+                       params.m_logicalChannelIdentity,
+                       it->second.m_qci,
+                       deadline,
+                       now);
+}
+
+void
+NrMacSchedulerOfdmaEdf::DoSchedDlTriggerReq(
+    const NrMacSchedSapProvider::SchedDlTriggerReqParameters& params)
+{
+    NS_LOG_FUNCTION(this);
+    m_deadlines.Expire(Simulator::Now());
+    NrMacSchedulerOfdmaQos::DoSchedDlTriggerReq(params);
+}
+
+std::shared_ptr<NrMacSchedulerUeInfo>
+NrMacSchedulerOfdmaEdf::CreateUeRepresentation(
+    const NrMacCschedSapProvider::CschedUeConfigReqParameters& params) const
+{
+    NS_LOG_FUNCTION(this);
+    return std::make_shared<NrMacSchedulerUeInfoEdf>(
+        GetFairnessIndex(),
+        params.m_rnti,
+        params.m_beamConfId,
+        std::bind(&NrMacSchedulerOfdmaEdf::GetNumRbPerRbg, this));
+}
+
+std::function<bool(const NrMacSchedulerNs3::UePtrAndBufferReq& lhs,
+                   const NrMacSchedulerNs3::UePtrAndBufferReq& rhs)>
+NrMacSchedulerOfdmaEdf::GetUeCompareDlFn() const
+{
+    return NrMacSchedulerUeInfoEdf::CompareUeDeadlinesDl;
+}
+
+void
+NrMacSchedulerOfdmaEdf::BeforeDlSched(const UePtrAndBufferReq& ue,
+                                      const FTResources& assignableInIteration) const
+{
+    NS_LOG_FUNCTION(this);
+    NrMacSchedulerOfdmaQos::BeforeDlSched(ue, assignableInIteration);
+
+    auto uePtr = std::dynamic_pointer_cast<NrMacSchedulerUeInfoEdf>(ue.first);
+    Time deadline = m_deadlines.GetUeDeadline(uePtr->m_rnti);
+    if (deadline != Time::Max())
+    {
+        deadline = TimeStep(deadline.GetTimeStep() / m_granularity.GetTimeStep() *
+                            m_granularity.GetTimeStep());
+    }
+    uePtr->m_dlDeadline = deadline;
+}
+
+void
+NrMacSchedulerOfdmaEdf::DeadlineResolved(uint16_t rnti, uint8_t lcId, uint8_t qci, bool missed)
+{
+    NS_LOG_FUNCTION(this << rnti << +lcId << +qci << missed);
+    if (missed)
+    {
+        NS_LOG_INFO("UE " << rnti << " LC " << +lcId << " missed the deadline of its HOL packet");
+    }
+    m_deadlineMissRateTrace(rnti, qci, missed, m_deadlines.GetMissRate(qci));
+}
+
+} // namespace ns3
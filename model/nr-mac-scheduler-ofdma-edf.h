@@ -0,0 +1,161 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include "nr-mac-scheduler-deadline-queue.h"
+#include "nr-mac-scheduler-ofdma-qos.h"
+
+#include <ns3/traced-callback.h>
+
+#include <map>
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief Assign DL frequencies in earliest-deadline-first (EDF) fashion
+ *
+ * The scheduler keeps the head-of-line (HOL) deadline of each DL LC with
+ * data, i.e., the arrival time of its HOL packet plus the packet delay budget
+ * (PDB) of the 5QI of the LC, in a NrMacSchedulerDeadlineQueue. The deadline
+ * is computed from the HOL delay of each RLC buffer status report, so that
+ * updating it costs O(log n) in the number of LCs with data, and the order of
+ * the UEs does not require to visit their LCs again. The RBGs are assigned
+ * first to the UE with the earliest deadline; the UEs whose deadlines fall in
+ * the same interval of the attribute "DeadlineGranularity" are ordered by
+ * their PF metric (see NrMacSchedulerUeInfoEdf). The LCs of the 5QIs without
+ * a PDB, and the UEs without data in such LCs, come after the others.
+ *
+ * At every DL slot, the deadlines that are in the past are flagged as missed.
+ * The scheduler does not own the packets, so it does not drop the late ones:
+ * the discard is left to the RLC (see the attributes EnablePdcpDiscarding and
+ * DiscardTimerMs of LteRlcUm). By default, a missed deadline keeps ordering
+ * its UE first, as in a plain EDF; with the attribute "DeprioritizeMissed"
+ * the UE is ordered by the deadlines that can still be met. Every resolved
+ * deadline is reported by the trace source "DeadlineMissRate", together with
+ * the share of missed deadlines of its 5QI.
+ *
+ * The UL has no HOL information in the BSR, so it is scheduled as in
+ * NrMacSchedulerOfdmaQos.
+ */
+class NrMacSchedulerOfdmaEdf : public NrMacSchedulerOfdmaQos
+{
+  public:
+    /**
+     * \brief GetTypeId
+     * \return The TypeId of the class
+     */
+    static TypeId GetTypeId();
+
+    /**
+     * \brief NrMacSchedulerOfdmaEdf constructor
+     */
+    NrMacSchedulerOfdmaEdf();
+
+    /**
+     * \brief ~NrMacSchedulerOfdmaEdf deconstructor
+     */
+    ~NrMacSchedulerOfdmaEdf() override
+    {
+    }
+
+    /**
+     * \brief TracedCallback signature for the resolution of the deadline of an
+     * HOL packet
+     * \param [in] rnti the RNTI of the UE
+     * \param [in] qci the 5QI of the LC
+     * \param [in] missed true if the deadline has been missed
+     * \param [in] missRate the share of missed deadlines of the 5QI so far
+     */
+    typedef void (*DeadlineMissRateTracedCallback)(uint16_t rnti,
+                                                   uint8_t qci,
+                                                   bool missed,
+                                                   double missRate);
+
+    /**
+     * \brief Set the attribute "DeprioritizeMissed"
+     * \param v true to order the UEs by the deadlines that are not missed
+     */
+    void SetDeprioritizeMissed(bool v);
+
+    /**
+     * \brief Get the attribute "DeprioritizeMissed"
+     * \return the value of the attribute
+     */
+    bool GetDeprioritizeMissed() const;
+
+    /**
+     * \return the deadlines of the DL LCs
+     */
+    const NrMacSchedulerDeadlineQueue& GetDeadlines() const;
+
+    void DoCschedLcConfigReq(
+        const NrMacCschedSapProvider::CschedLcConfigReqParameters& params) override;
+    void DoCschedUeReleaseReq(
+        const NrMacCschedSapProvider::CschedUeReleaseReqParameters& params) override;
+    void DoSchedDlRlcBufferReq(
+        const NrMacSchedSapProvider::SchedDlRlcBufferReqParameters& params) override;
+    void DoSchedDlTriggerReq(
+        const NrMacSchedSapProvider::SchedDlTriggerReqParameters& params) override;
+
+  protected:
+    /**
+     * \brief Create an UE representation of the type NrMacSchedulerUeInfoEdf
+     * \param params parameters
+     * \return NrMacSchedulerUeInfo instance
+     */
+    std::shared_ptr<NrMacSchedulerUeInfo> CreateUeRepresentation(
+        const NrMacCschedSapProvider::CschedUeConfigReqParameters& params) const override;
+
+    /**
+     * \brief Return the comparison function to sort DL UE according to the scheduler policy
+     * \return a pointer to NrMacSchedulerUeInfoEdf::CompareUeDeadlinesDl
+     */
+    std::function<bool(const NrMacSchedulerNs3::UePtrAndBufferReq& lhs,
+                       const NrMacSchedulerNs3::UePtrAndBufferReq& rhs)>
+    GetUeCompareDlFn() const override;
+
+    /**
+     * \brief Calculate the potential throughput, and copy the deadline of the UE
+     * \param ue UE to which a rgb has been assigned
+     * \param assignableInIteration the minimum amount of resources to be assigned
+     *
+     * The deadline of the UE is rounded down to the attribute "DeadlineGranularity".
+     */
+    void BeforeDlSched(const UePtrAndBufferReq& ue,
+                       const FTResources& assignableInIteration) const override;
+
+  private:
+    /**
+     * \brief The 5QI of a DL LC, and its PDB
+     */
+    struct LcQos
+    {
+        uint8_t m_qci{0}; //!< 5QI of the LC
+        Time m_pdb;       //!< Packet delay budget of the 5QI
+    };
+
+    /**
+     * \brief Report a resolved deadline through the trace source
+     * \param rnti the UE
+     * \param lcId the LC
+     * \param qci the 5QI of the LC
+     * \param missed true if the deadline has been missed
+     */
+    void DeadlineResolved(uint16_t rnti, uint8_t lcId, uint8_t qci, bool missed);
+
+    NrMacSchedulerDeadlineQueue m_deadlines;                //!< HOL deadlines of the DL LCs
+    std::map<std::pair<uint16_t, uint8_t>, LcQos> m_lcQos; //!< 5QI of the DL LCs with a PDB
+    Time m_granularity{MilliSeconds(1)};                   //!< Deadlines ordered by PF
+    bool m_deprioritizeMissed{false};                      //!< Order by the deadlines not missed
+
+    TracedCallback<uint16_t, uint8_t, bool, double>
+        m_deadlineMissRateTrace; //!< Trace of the resolved deadlines
+};
+
+} // namespace ns3
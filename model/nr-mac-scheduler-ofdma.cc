@@ -12,9 +12,16 @@
 
 #include "nr-mac-scheduler-ofdma.h"
 
+#include "nr-mac-scheduler-policy.h"
+
+#include <ns3/boolean.h>
+#include <ns3/double.h>
 #include <ns3/log.h>
+#include <ns3/uinteger.h>
 
 #include <algorithm>
+#include <cmath>
+#include <unordered_set>
 
 namespace ns3
 {
@@ -31,7 +38,32 @@ NrMacSchedulerOfdma::GetTypeId()
                 "SymPerBeam",
                 "Number of assigned symbol per beam. Gets called every time an assignment is made",
                 MakeTraceSourceAccessor(&NrMacSchedulerOfdma::m_tracedValueSymPerBeam),
-                "ns3::TracedValueCallback::Uint32");
+                "ns3::TracedValueCallback::Uint32")
+            .AddAttribute("EnableMuMimo",
+                          "Co-schedule the UEs of separated beams on the same DL symbols and "
+                          "RBG, each beam being a layer of a MU-MIMO transmission, instead of "
+                          "giving each beam its own symbols",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&NrMacSchedulerOfdma::m_enableMuMimo),
+                          MakeBooleanChecker())
+            .AddAttribute("MuMimoMaxLayers",
+                          "Maximum number of beams co-scheduled on the same symbols",
+                          UintegerValue(2),
+                          MakeUintegerAccessor(&NrMacSchedulerOfdma::m_muMimoMaxLayers),
+                          MakeUintegerChecker<uint8_t>(1, 8))
+            .AddAttribute("MuMimoMinSectorSeparation",
+                          "Minimum distance between the sectors of two beams to co-schedule "
+                          "them (MU-MIMO); beams far enough in elevation are also co-scheduled",
+                          UintegerValue(2),
+                          MakeUintegerAccessor(&NrMacSchedulerOfdma::m_muMimoMinSectorSeparation),
+                          MakeUintegerChecker<uint16_t>(1))
+            .AddAttribute(
+                "MuMimoMinElevationSeparation",
+                "Minimum distance, in degrees, between the elevations of two beams to "
+                "co-schedule them (MU-MIMO); beams far enough in sector are also co-scheduled",
+                DoubleValue(30.0),
+                MakeDoubleAccessor(&NrMacSchedulerOfdma::m_muMimoMinElevationSeparation),
+                MakeDoubleChecker<double>(0.0));
     return tid;
 }
 
@@ -59,6 +91,7 @@ NrMacSchedulerOfdma::GetSymPerBeam(uint32_t symAvail,
                                    const NrMacSchedulerNs3::ActiveUeMap& activeDl) const
 {
     NS_LOG_FUNCTION(this);
+    NR_SCHEDULER_PROFILE_PHASE(BEAM);
 
     GetSecond GetUeVector;
     GetSecond GetUeBufSize;
@@ -122,6 +155,148 @@ NrMacSchedulerOfdma::GetSymPerBeam(uint32_t symAvail,
     return ret;
 }
 
+NrMacSchedulerOfdma::BeamSymbolMap
+NrMacSchedulerOfdma::GetDlSymPerBeam(uint32_t symAvail, const ActiveUeMap& activeDl) const
+{
+    return m_enableMuMimo ? GetSymPerBeamGroup(symAvail, activeDl)
+                          : GetSymPerBeam(symAvail, activeDl);
+}
+
+bool
+NrMacSchedulerOfdma::AreBeamsSeparated(const BeamConfId& lhs, const BeamConfId& rhs) const
+{
+    const BeamId l = lhs.GetFirstBeam();
+    const BeamId r = rhs.GetFirstBeam();
+    return std::abs(static_cast<int>(l.GetSector()) - r.GetSector()) >=
+               m_muMimoMinSectorSeparation ||
+           std::abs(l.GetElevation() - r.GetElevation()) >= m_muMimoMinElevationSeparation;
+}
+
+/**
+ * \brief Group the beams to co-schedule on the same symbols (MU-MIMO)
+ * \param activeDl Map of active DL UE and their beam
+ * \return the groups of beams
+ *
+ * Without the attribute EnableMuMimo, each beam is a group. Otherwise, the
+ * beams are visited from the one with the most bytes to transmit, and each
+ * beam joins the first group that has less than MuMimoMaxLayers beams, all of
+ * them separated from it (see AreBeamsSeparated()); if there is none, it
+ * starts a new group.
+ */
+NrMacSchedulerNs3::BeamGroups
+NrMacSchedulerOfdma::GetDlBeamGroups(const ActiveUeMap& activeDl) const
+{
+    NS_LOG_FUNCTION(this);
+    if (!m_enableMuMimo)
+    {
+        return NrMacSchedulerTdma::GetDlBeamGroups(activeDl);
+    }
+
+    GetSecond GetUeBufSize;
+    std::vector<std::pair<BeamConfId, uint32_t>> beams;
+    beams.reserve(activeDl.size());
+    for (const auto& el : activeDl)
+    {
+        uint32_t bufSizeBeam = 0;
+        for (const auto& ue : el.second)
+        {
+            bufSizeBeam += GetUeBufSize(ue);
+        }
+        beams.emplace_back(el.first, bufSizeBeam);
+    }
+    std::stable_sort(beams.begin(), beams.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.second > rhs.second;
+    });
+
+    BeamGroups groups;
+    for (const auto& beam : beams)
+    {
+        auto group = std::find_if(groups.begin(), groups.end(), [&](const auto& g) {
+            return g.size() < m_muMimoMaxLayers &&
+                   std::all_of(g.begin(), g.end(), [&](const BeamConfId& other) {
+                       return AreBeamsSeparated(beam.first, other);
+                   });
+        });
+        if (group == groups.end())
+        {
+            groups.push_back({beam.first});
+        }
+        else
+        {
+            NS_LOG_DEBUG("Beam " << beam.first << " co-scheduled with beam " << group->front());
+            group->push_back(beam.first);
+        }
+    }
+    return groups;
+}
+
+/**
+ * \brief Calculate the number of symbols to assign to each group of beams
+ * \param symAvail Number of available symbols
+ * \param activeDl Map of active DL UE and their beam
+ * \return the symbols of each beam, which are the ones of its group
+ *
+ * It is the MU-MIMO version of GetSymPerBeam(): the symbols are divided among
+ * the groups of GetDlBeamGroups(), in proportion to the bytes of the beam of
+ * the group with the most bytes to transmit, as the beams of a group transmit
+ * at the same time.
+ */
+NrMacSchedulerOfdma::BeamSymbolMap
+NrMacSchedulerOfdma::GetSymPerBeamGroup(uint32_t symAvail, const ActiveUeMap& activeDl) const
+{
+    NS_LOG_FUNCTION(this);
+    NR_SCHEDULER_PROFILE_PHASE(BEAM);
+
+    GetSecond GetUeBufSize;
+    const BeamGroups groups = GetDlBeamGroups(activeDl);
+    std::vector<uint32_t> bufSizeGroup(groups.size(), 0);
+    double bufTotal = 0.0;
+
+    for (std::size_t i = 0; i < groups.size(); ++i)
+    {
+        for (const auto& beamId : groups.at(i))
+        {
+            uint32_t bufSizeBeam = 0;
+            for (const auto& ue : activeDl.at(beamId))
+            {
+                bufSizeBeam += GetUeBufSize(ue);
+            }
+            bufSizeGroup.at(i) = std::max(bufSizeGroup.at(i), bufSizeBeam);
+        }
+        bufTotal += bufSizeGroup.at(i);
+    }
+
+    std::vector<uint32_t> symGroup(groups.size(), 0);
+    uint32_t symUsed = 0;
+    for (std::size_t i = 0; i < groups.size(); ++i)
+    {
+        symGroup.at(i) = static_cast<uint32_t>(bufSizeGroup.at(i) * (symAvail / bufTotal));
+        symUsed += symGroup.at(i);
+    }
+
+    NS_ASSERT(symAvail >= symUsed);
+    for (uint32_t sym = symUsed; sym < symAvail; ++sym)
+    {
+        auto min = std::min_element(symGroup.begin(), symGroup.end());
+        *min += 1;
+    }
+
+    BeamSymbolMap ret;
+    for (std::size_t i = 0; i < groups.size(); ++i)
+    {
+        for (const auto& beamId : groups.at(i))
+        {
+            ret.emplace(beamId, symGroup.at(i));
+        }
+        NS_LOG_DEBUG("Assigned to the group of beam " << groups.at(i).front() << " ("
+                                                      << groups.at(i).size() << " layers) symbols "
+                                                      << symGroup.at(i));
+        const_cast<NrMacSchedulerOfdma*>(this)->m_tracedValueSymPerBeam = symGroup.at(i);
+    }
+
+    return ret;
+}
+
 /**
  * \brief Assign the available DL RBG to the UEs
  * \param symAvail Available symbols
@@ -141,7 +316,10 @@ NrMacSchedulerOfdma::GetSymPerBeam(uint32_t symAvail,
  *    UpdateUeDlMetric (ueVector.first());
  * </pre>
  *
- * To sort the UEs, the method uses the function returned by GetUeCompareDlFn().
+ * To sort the UEs, the method uses the comparison function of the policy, which
+ * is the one returned by GetUeCompareDlFn() unless the scheduler is a
+ * NrMacSchedulerStatic, which can also sort through a NrMacSchedulerUeMirror.
+ * The same holds for the updates of the UE metrics.
  * Two fairness helper are hard-coded in the method: the first one is avoid
  * to assign resources to UEs that already have their buffer requirement covered,
  * and the other one is avoid to assign symbols when all the UEs have their
@@ -151,12 +329,20 @@ NrMacSchedulerNs3::BeamSymbolMap
 NrMacSchedulerOfdma::AssignDLRBG(uint32_t symAvail, const ActiveUeMap& activeDl) const
 {
     NS_LOG_FUNCTION(this);
+    return AssignDlRbgWith(symAvail, activeDl, VirtualPolicy(this));
+}
 
+template <class Policy>
+NrMacSchedulerNs3::BeamSymbolMap
+NrMacSchedulerOfdma::AssignDlRbgWith(uint32_t symAvail,
+                                     const ActiveUeMap& activeDl,
+                                     const Policy& policy) const
+{
     NS_LOG_DEBUG("# beams active flows: " << activeDl.size() << ", # sym: " << symAvail);
 
     GetFirst GetBeamId;
     GetSecond GetUeVector;
-    BeamSymbolMap symPerBeam = GetSymPerBeam(symAvail, activeDl);
+    BeamSymbolMap symPerBeam = GetDlSymPerBeam(symAvail, activeDl);
 
     // Iterate through the different beams
     for (const auto& el : activeDl)
@@ -177,15 +363,105 @@ NrMacSchedulerOfdma::AssignDLRBG(uint32_t symAvail, const ActiveUeMap& activeDl)
             ueVector.emplace_back(ue);
         }
 
+        // With a SB CQI, the RBG of the UEs of the beam are selected: each UE
+        // takes, among the free RBG, the ones with its best MCS
+        GetFirst GetUeInfo;
+        const bool selectRbg =
+            std::any_of(ueVector.begin(), ueVector.end(), [&](const UePtrAndBufferReq& ue) {
+                return !GetUeInfo(ue)->m_dlRbgMcs.empty();
+            });
+        std::vector<uint32_t> freeRbgs;
+        if (selectRbg)
+        {
+            for (uint32_t rbg = 0; rbg < GetBandwidthInRbg(); ++rbg)
+            {
+                if (dlNotchedRBGsMask.empty() || dlNotchedRBGsMask.at(rbg) == 1)
+                {
+                    freeRbgs.push_back(rbg);
+                }
+            }
+        }
+        auto selectRbgs = [&](const std::shared_ptr<NrMacSchedulerUeInfo>& ue, uint32_t units) {
+            auto quality = [&](uint32_t rbg) {
+                uint32_t mcs = 0;
+                for (uint8_t stream = 0; stream < ue->m_dlMcs.size(); ++stream)
+                {
+                    mcs += ue->GetDlRbgMcs(stream, rbg);
+                }
+                return mcs;
+            };
+            for (uint32_t i = 0; i < units; ++i)
+            {
+                NS_ASSERT(!freeRbgs.empty());
+                auto best = std::max_element(freeRbgs.begin(),
+                                             freeRbgs.end(),
+                                             [&](uint32_t lhs, uint32_t rhs) {
+                                                 return quality(lhs) < quality(rhs);
+                                             });
+                ue->m_dlRbgIndexes.push_back(*best);
+                freeRbgs.erase(best);
+            }
+        };
+
+        NS_ABORT_MSG_IF(m_wasteFreeAssignment && m_incrementalUeOrdering,
+                        "WasteFreeAssignment is not compatible with IncrementalUeOrdering");
+        // UEs for which the remaining RBG are not enough for a TB with data
+        std::unordered_set<uint16_t> skipped;
+
         for (auto& ue : ueVector)
         {
-            BeforeDlSched(ue, FTResources(rbgAssignable * beamSym, beamSym));
+            policy.BeforeDl(ue, FTResources(rbgAssignable * beamSym, beamSym));
+        }
+
+        if (m_incrementalUeOrdering)
+        {
+            GetFirst GetUe;
+            auto isSatisfied = [&](const UePtrAndBufferReq& ue) {
+                uint32_t tbSize = 0;
+                for (const auto& it : GetUe(ue)->m_dlTbSize)
+                {
+                    tbSize += it;
+                }
+                if (tbSize < std::max(ue.second, 10U))
+                {
+                    return false;
+                }
+                TrimUnneededDlStreams(GetUe(ue), ue.second);
+                return true;
+            };
+            auto assign = [&](const UePtrAndBufferReq& ue) {
+                GetUe(ue)->m_dlRBG += rbgAssignable;
+                assigned.m_rbg += rbgAssignable;
+                GetUe(ue)->m_dlSym = beamSym;
+                assigned.m_sym = beamSym;
+                if (selectRbg)
+                {
+                    selectRbgs(GetUe(ue), 1);
+                }
+                NS_LOG_DEBUG("Assigned " << rbgAssignable << " DL RBG, spanned over " << beamSym
+                                         << " SYM, to UE " << GetUe(ue)->m_rnti);
+                policy.AssignedDl(ue, FTResources(rbgAssignable, beamSym), assigned);
+            };
+            auto notAssign = [&](const UePtrAndBufferReq& ue) {
+                policy.NotAssignedDl(ue, FTResources(rbgAssignable, beamSym), assigned);
+            };
+
+            // The symbols of the beam do not change between the assignments, so
+            // only the UE that got the last RBG can change its metric
+            AssignIncrementally(&ueVector,
+                                resources,
+                                policy.GetCompareDl(),
+                                isSatisfied,
+                                assign,
+                                notAssign,
+                                false);
+            continue;
         }
 
         while (resources > 0)
         {
             GetFirst GetUe;
-            std::sort(ueVector.begin(), ueVector.end(), GetUeCompareDlFn());
+            policy.SortDl(&ueVector);
             auto schedInfoIt = ueVector.begin();
 
             // Ensure fairness: pass over UEs which already has enough resources to transmit
@@ -203,49 +479,11 @@ NrMacSchedulerOfdma::AssignDLRBG(uint32_t symAvail, const ActiveUeMap& activeDl)
 
                 if (tbSize >= std::max(bufQueueSize, 10U))
                 {
-                    if (GetUe(*schedInfoIt)->m_dlTbSize.size() > 1)
-                    {
-                        // This "if" is purely for MIMO. In MIMO, for example, if the
-                        // first TB size is big enough to empty the buffer then we
-                        // should not allocate anything to the second stream. In this
-                        // case, if we allocate bytes to the second stream, the UE
-                        // would expect the TB but the gNB would not be able to transmit
-                        // it. This would break HARQ TX state machine at UE PHY.
-
-                        uint8_t streamCounter = 0;
-                        uint32_t copyBufQueueSize = bufQueueSize;
-                        auto dlTbSizeIt = GetUe(*schedInfoIt)->m_dlTbSize.begin();
-                        while (dlTbSizeIt != GetUe(*schedInfoIt)->m_dlTbSize.end())
-                        {
-                            if (copyBufQueueSize != 0)
-                            {
-                                NS_LOG_DEBUG("Stream " << +streamCounter << " with TB size "
-                                                       << *dlTbSizeIt << " needed to TX MIMO TB");
-                                if (*dlTbSizeIt >= copyBufQueueSize)
-                                {
-                                    copyBufQueueSize = 0;
-                                }
-                                else
-                                {
-                                    copyBufQueueSize = copyBufQueueSize - *dlTbSizeIt;
-                                }
-                                streamCounter++;
-                                dlTbSizeIt++;
-                            }
-                            else
-                            {
-                                // if we are here, that means previously iterated
-                                // streams were enough to empty the buffer. We do
-                                // not need this stream. Make its TB size zero.
-                                NS_LOG_DEBUG("Stream " << +streamCounter << " with TB size "
-                                                       << *dlTbSizeIt
-                                                       << " not needed to TX MIMO TB");
-                                *dlTbSizeIt = 0;
-                                streamCounter++;
-                                dlTbSizeIt++;
-                            }
-                        }
-                    }
+                    TrimUnneededDlStreams(GetUe(*schedInfoIt), bufQueueSize);
+                    schedInfoIt++;
+                }
+                else if (!skipped.empty() && skipped.count(GetUe(*schedInfoIt)->m_rnti) > 0)
+                {
                     schedInfoIt++;
                 }
                 else
@@ -261,25 +499,45 @@ NrMacSchedulerOfdma::AssignDLRBG(uint32_t symAvail, const ActiveUeMap& activeDl)
                 break;
             }
 
+            // A UE without RBG gets at once the RBG it needs for a TB with
+            // data, or none if there are not enough of them (WasteFreeAssignment)
+            uint32_t units = 1;
+            if (m_wasteFreeAssignment && GetUe(*schedInfoIt)->m_dlRBG == 0)
+            {
+                units = GetDlUnitsForMinTbSize(GetUe(*schedInfoIt), rbgAssignable, resources);
+                if (units == 0)
+                {
+                    NS_LOG_INFO("UE " << GetUe(*schedInfoIt)->m_rnti << " needs more than "
+                                      << resources << " DL RBG for a TB, skipping it");
+                    skipped.insert(GetUe(*schedInfoIt)->m_rnti);
+                    continue;
+                }
+            }
+
             // Assign 1 RBG for each available symbols for the beam,
             // and then update the count of available resources
-            GetUe(*schedInfoIt)->m_dlRBG += rbgAssignable;
-            assigned.m_rbg += rbgAssignable;
+            GetUe(*schedInfoIt)->m_dlRBG += rbgAssignable * units;
+            assigned.m_rbg += rbgAssignable * units;
 
             GetUe(*schedInfoIt)->m_dlSym = beamSym;
             assigned.m_sym = beamSym;
+            if (selectRbg)
+            {
+                selectRbgs(GetUe(*schedInfoIt), units);
+            }
 
-            resources -= 1; // Resources are RBG, so they do not consider the beamSym
+            resources -= units; // Resources are RBG, so they do not consider the beamSym
 
             // Update metrics
-            NS_LOG_DEBUG("Assigned " << rbgAssignable << " DL RBG, spanned over " << beamSym
-                                     << " SYM, to UE " << GetUe(*schedInfoIt)->m_rnti);
-            // Following call to AssignedDlResources would update the
+            NS_LOG_DEBUG("Assigned " << rbgAssignable * units << " DL RBG, spanned over "
+                                     << beamSym << " SYM, to UE "
+                                     << GetUe(*schedInfoIt)->m_rnti);
+            // Following call to policy.AssignedDl would update the
             // TB size in the NrMacSchedulerUeInfo of this particular UE
             // according the Rank Indicator reported by it. Only one call
             // to this method is enough even if the UE reported rank indicator 2,
             // since the number of RBG assigned to both the streams are the same.
-            AssignedDlResources(*schedInfoIt, FTResources(rbgAssignable, beamSym), assigned);
+            policy.AssignedDl(*schedInfoIt, FTResources(rbgAssignable * units, beamSym), assigned);
 
             // Update metrics for the unsuccessfull UEs (who did not get any resource in this
             // iteration)
@@ -287,7 +545,7 @@ NrMacSchedulerOfdma::AssignDLRBG(uint32_t symAvail, const ActiveUeMap& activeDl)
             {
                 if (GetUe(ue)->m_rnti != GetUe(*schedInfoIt)->m_rnti)
                 {
-                    NotAssignedDlResources(ue, FTResources(rbgAssignable, beamSym), assigned);
+                    policy.NotAssignedDl(ue, FTResources(rbgAssignable * units, beamSym), assigned);
                 }
             }
         }
@@ -300,7 +558,15 @@ NrMacSchedulerNs3::BeamSymbolMap
 NrMacSchedulerOfdma::AssignULRBG(uint32_t symAvail, const ActiveUeMap& activeUl) const
 {
     NS_LOG_FUNCTION(this);
+    return AssignUlRbgWith(symAvail, activeUl, VirtualPolicy(this));
+}
 
+template <class Policy>
+NrMacSchedulerNs3::BeamSymbolMap
+NrMacSchedulerOfdma::AssignUlRbgWith(uint32_t symAvail,
+                                     const ActiveUeMap& activeUl,
+                                     const Policy& policy) const
+{
     NS_LOG_DEBUG("# beams active flows: " << activeUl.size() << ", # sym: " << symAvail);
 
     GetFirst GetBeamId;
@@ -326,15 +592,51 @@ NrMacSchedulerOfdma::AssignULRBG(uint32_t symAvail, const ActiveUeMap& activeUl)
             ueVector.emplace_back(ue);
         }
 
+        NS_ABORT_MSG_IF(m_wasteFreeAssignment && m_incrementalUeOrdering,
+                        "WasteFreeAssignment is not compatible with IncrementalUeOrdering");
+        // UEs for which the remaining RBG are not enough for a TB with data
+        std::unordered_set<uint16_t> skipped;
+
         for (auto& ue : ueVector)
         {
-            BeforeUlSched(ue, FTResources(rbgAssignable * beamSym, beamSym));
+            policy.BeforeUl(ue, FTResources(rbgAssignable * beamSym, beamSym));
+        }
+
+        if (m_incrementalUeOrdering)
+        {
+            GetFirst GetUe;
+            auto isSatisfied = [&](const UePtrAndBufferReq& ue) {
+                return GetUe(ue)->m_ulTbSize >= std::max(ue.second, 12U);
+            };
+            auto assign = [&](const UePtrAndBufferReq& ue) {
+                GetUe(ue)->m_ulRBG += rbgAssignable;
+                assigned.m_rbg += rbgAssignable;
+                GetUe(ue)->m_ulSym = beamSym;
+                assigned.m_sym = beamSym;
+                NS_LOG_DEBUG("Assigned " << rbgAssignable << " UL RBG, spanned over " << beamSym
+                                         << " SYM, to UE " << GetUe(ue)->m_rnti);
+                policy.AssignedUl(ue, FTResources(rbgAssignable, beamSym), assigned);
+            };
+            auto notAssign = [&](const UePtrAndBufferReq& ue) {
+                policy.NotAssignedUl(ue, FTResources(rbgAssignable, beamSym), assigned);
+            };
+
+            // The symbols of the beam do not change between the assignments, so
+            // only the UE that got the last RBG can change its metric
+            AssignIncrementally(&ueVector,
+                                resources,
+                                policy.GetCompareUl(),
+                                isSatisfied,
+                                assign,
+                                notAssign,
+                                false);
+            continue;
         }
 
         while (resources > 0)
         {
             GetFirst GetUe;
-            std::sort(ueVector.begin(), ueVector.end(), GetUeCompareUlFn());
+            policy.SortUl(&ueVector);
             auto schedInfoIt = ueVector.begin();
 
             // Ensure fairness: pass over UEs which already has enough resources to transmit
@@ -345,6 +647,10 @@ NrMacSchedulerOfdma::AssignULRBG(uint32_t symAvail, const ActiveUeMap& activeUl)
                 {
                     schedInfoIt++;
                 }
+                else if (!skipped.empty() && skipped.count(GetUe(*schedInfoIt)->m_rnti) > 0)
+                {
+                    schedInfoIt++;
+                }
                 else
                 {
                     break;
@@ -358,20 +664,36 @@ NrMacSchedulerOfdma::AssignULRBG(uint32_t symAvail, const ActiveUeMap& activeUl)
                 break;
             }
 
+            // A UE without RBG gets at once the RBG it needs for a TB with
+            // data, or none if there are not enough of them (WasteFreeAssignment)
+            uint32_t units = 1;
+            if (m_wasteFreeAssignment && GetUe(*schedInfoIt)->m_ulRBG == 0)
+            {
+                units = GetUlUnitsForMinTbSize(GetUe(*schedInfoIt), rbgAssignable, resources);
+                if (units == 0)
+                {
+                    NS_LOG_INFO("UE " << GetUe(*schedInfoIt)->m_rnti << " needs more than "
+                                      << resources << " UL RBG for a TB, skipping it");
+                    skipped.insert(GetUe(*schedInfoIt)->m_rnti);
+                    continue;
+                }
+            }
+
             // Assign 1 RBG for each available symbols for the beam,
             // and then update the count of available resources
-            GetUe(*schedInfoIt)->m_ulRBG += rbgAssignable;
-            assigned.m_rbg += rbgAssignable;
+            GetUe(*schedInfoIt)->m_ulRBG += rbgAssignable * units;
+            assigned.m_rbg += rbgAssignable * units;
 
             GetUe(*schedInfoIt)->m_ulSym = beamSym;
             assigned.m_sym = beamSym;
 
-            resources -= 1; // Resources are RBG, so they do not consider the beamSym
+            resources -= units; // Resources are RBG, so they do not consider the beamSym
 
             // Update metrics
-            NS_LOG_DEBUG("Assigned " << rbgAssignable << " UL RBG, spanned over " << beamSym
-                                     << " SYM, to UE " << GetUe(*schedInfoIt)->m_rnti);
-            AssignedUlResources(*schedInfoIt, FTResources(rbgAssignable, beamSym), assigned);
+            NS_LOG_DEBUG("Assigned " << rbgAssignable * units << " UL RBG, spanned over "
+                                     << beamSym << " SYM, to UE "
+                                     << GetUe(*schedInfoIt)->m_rnti);
+            policy.AssignedUl(*schedInfoIt, FTResources(rbgAssignable * units, beamSym), assigned);
 
             // Update metrics for the unsuccessfull UEs (who did not get any resource in this
             // iteration)
@@ -379,7 +701,7 @@ NrMacSchedulerOfdma::AssignULRBG(uint32_t symAvail, const ActiveUeMap& activeUl)
             {
                 if (GetUe(ue)->m_rnti != GetUe(*schedInfoIt)->m_rnti)
                 {
-                    NotAssignedUlResources(ue, FTResources(rbgAssignable, beamSym), assigned);
+                    policy.NotAssignedUl(ue, FTResources(rbgAssignable * units, beamSym), assigned);
                 }
             }
         }
@@ -420,7 +742,7 @@ NrMacSchedulerOfdma::CreateDlDci(NrMacSchedulerNs3::PointInFTPlane* spoint,
     for (uint32_t numTb = 0; numTb < ueInfo->m_dlTbSize.size(); numTb++)
     {
         uint32_t tbs = ueInfo->m_dlTbSize.at(numTb);
-        if (tbs < 10)
+        if (tbs < MIN_DL_TB_SIZE)
         {
             countLessThanMinBytes++;
             NS_LOG_DEBUG("While creating DCI for UE "
@@ -452,6 +774,37 @@ NrMacSchedulerOfdma::CreateDlDci(NrMacSchedulerNs3::PointInFTPlane* spoint,
     }
 
     uint32_t RBGNum = ueInfo->m_dlRBG / maxSym;
+
+    if (!ueInfo->m_dlRbgIndexes.empty())
+    {
+        // The RBG have been selected with the SB CQI (see AssignDLRBG): the
+        // starting point does not move, as the RBG of the UEs are interleaved
+        NS_ASSERT_MSG(ueInfo->m_dlRbgIndexes.size() == RBGNum,
+                      "Selected " << ueInfo->m_dlRbgIndexes.size() << " RBG instead of "
+                                  << RBGNum);
+        std::vector<uint8_t> rbgBitmask(GetBandwidthInRbg(), 0);
+        for (const auto rbg : ueInfo->m_dlRbgIndexes)
+        {
+            rbgBitmask.at(rbg) = 1;
+        }
+
+        std::shared_ptr<DciInfoElementTdma> dci = GetDciPool().Create(ueInfo->m_rnti,
+                                                                      DciInfoElementTdma::DL,
+                                                                      spoint->m_sym,
+                                                                      maxSym,
+                                                                      ueInfo->GetDlTxMcs(),
+                                                                      ueInfo->m_dlTbSize,
+                                                                      ndi,
+                                                                      rv,
+                                                                      DciInfoElementTdma::DATA,
+                                                                      GetBwpId(),
+                                                                      GetTpc());
+        dci->m_rbgBitmask = std::move(rbgBitmask);
+        NS_LOG_INFO("UE " << ueInfo->m_rnti << " assigned " << RBGNum
+                          << " RBG selected with the SB CQI for " << maxSym << " SYM.");
+        return dci;
+    }
+
     std::vector<uint8_t> rbgBitmask = GetDlNotchedRbgMask();
 
     if (rbgBitmask.size() == 0)
@@ -496,18 +849,17 @@ NrMacSchedulerOfdma::CreateDlDci(NrMacSchedulerNs3::PointInFTPlane* spoint,
     NS_LOG_INFO("UE " << ueInfo->m_rnti << " assigned RBG from " << spoint->m_rbg << " with mask "
                       << oss.str() << " for " << static_cast<uint32_t>(maxSym) << " SYM.");
 
-    std::shared_ptr<DciInfoElementTdma> dci =
-        std::make_shared<DciInfoElementTdma>(ueInfo->m_rnti,
-                                             DciInfoElementTdma::DL,
-                                             spoint->m_sym,
-                                             maxSym,
-                                             ueInfo->m_dlMcs,
-                                             ueInfo->m_dlTbSize,
-                                             ndi,
-                                             rv,
-                                             DciInfoElementTdma::DATA,
-                                             GetBwpId(),
-                                             GetTpc());
+    std::shared_ptr<DciInfoElementTdma> dci = GetDciPool().Create(ueInfo->m_rnti,
+                                                                  DciInfoElementTdma::DL,
+                                                                  spoint->m_sym,
+                                                                  maxSym,
+                                                                  ueInfo->GetDlTxMcs(),
+                                                                  ueInfo->m_dlTbSize,
+                                                                  ndi,
+                                                                  rv,
+                                                                  DciInfoElementTdma::DATA,
+                                                                  GetBwpId(),
+                                                                  GetTpc());
 
     dci->m_rbgBitmask = std::move(rbgBitmask);
 
@@ -530,7 +882,7 @@ NrMacSchedulerOfdma::CreateUlDci(PointInFTPlane* spoint,
 
     // If is less than 12, i.e., 7 (3 mac header, 2 rlc header, 2 data) + 5 bytes for
     // the SHORT_BSR. then we can't transmit any new data, so don't create dci.
-    if (tbs < 12)
+    if (tbs < MIN_UL_TB_SIZE)
     {
         NS_LOG_DEBUG("While creating UL DCI for UE " << ueInfo->m_rnti << " assigned "
                                                      << ueInfo->m_ulRBG << " UL RBG, but TBS < 12");
@@ -585,18 +937,17 @@ NrMacSchedulerOfdma::CreateUlDci(PointInFTPlane* spoint,
     std::vector<uint8_t> rv = {0};
 
     NS_ASSERT(spoint->m_sym >= maxSym);
-    std::shared_ptr<DciInfoElementTdma> dci =
-        std::make_shared<DciInfoElementTdma>(ueInfo->m_rnti,
-                                             DciInfoElementTdma::UL,
-                                             spoint->m_sym - maxSym,
-                                             maxSym,
-                                             ulMcs,
-                                             ulTbs,
-                                             ndi,
-                                             rv,
-                                             DciInfoElementTdma::DATA,
-                                             GetBwpId(),
-                                             GetTpc());
+    std::shared_ptr<DciInfoElementTdma> dci = GetDciPool().Create(ueInfo->m_rnti,
+                                                                  DciInfoElementTdma::UL,
+                                                                  spoint->m_sym - maxSym,
+                                                                  maxSym,
+                                                                  ulMcs,
+                                                                  ulTbs,
+                                                                  ndi,
+                                                                  rv,
+                                                                  DciInfoElementTdma::DATA,
+                                                                  GetBwpId(),
+                                                                  GetTpc());
 
     dci->m_rbgBitmask = std::move(rbgBitmask);
 
@@ -637,4 +988,24 @@ NrMacSchedulerOfdma::GetTpc() const
               // Table 7.1.1-1
 }
 
+// As in NrMacSchedulerTdma, the loops are instantiated for the virtual policy and
+// for the ones of nr-mac-scheduler-policy.h (see NrMacSchedulerStatic)
+#define NR_MAC_SCHEDULER_OFDMA_INSTANTIATE_LOOPS(Policy)                                         \
+    template NrMacSchedulerNs3::BeamSymbolMap NrMacSchedulerOfdma::AssignDlRbgWith(               \
+        uint32_t,                                                                                  \
+        const ActiveUeMap&,                                                                        \
+        const Policy&) const;                                                                      \
+    template NrMacSchedulerNs3::BeamSymbolMap NrMacSchedulerOfdma::AssignUlRbgWith(               \
+        uint32_t,                                                                                  \
+        const ActiveUeMap&,                                                                        \
+        const Policy&) const
+
+NR_MAC_SCHEDULER_OFDMA_INSTANTIATE_LOOPS(NrMacSchedulerTdma::VirtualPolicy);
+NR_MAC_SCHEDULER_OFDMA_INSTANTIATE_LOOPS(NrMacSchedulerPolicyRR);
+NR_MAC_SCHEDULER_OFDMA_INSTANTIATE_LOOPS(NrMacSchedulerPolicyMR);
+NR_MAC_SCHEDULER_OFDMA_INSTANTIATE_LOOPS(NrMacSchedulerPolicyPF);
+NR_MAC_SCHEDULER_OFDMA_INSTANTIATE_LOOPS(NrMacSchedulerPolicyQos);
+
+#undef NR_MAC_SCHEDULER_OFDMA_INSTANTIATE_LOOPS
+
 } // namespace ns3
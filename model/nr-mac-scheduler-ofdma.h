@@ -38,6 +38,13 @@ namespace ns3
  * The OFDMA scheduling is only done in downlink. In uplink, the division in
  * time is used, and therefore the class is based on top of NrMacSchedulerTdma.
  *
+ * With the attribute EnableMuMimo, the DL beams that are far enough, in sector
+ * or in elevation, are grouped (GetDlBeamGroups()): the beams of a group share
+ * the same symbols, and each one assigns the whole bandwidth to its UEs, as a
+ * layer of a MU-MIMO transmission. The gNB PHY transmits the layers at the
+ * same time, each one with its beam and a share of the power, and the UEs see
+ * the other layers as interference.
+ *
  * The implementation details to construct a slot like the one showed before
  * are in the functions AssignDLRBG() and AssignULRBG().
  * The choice of the UEs to be scheduled is, however, demanded to the subclasses.
@@ -74,6 +81,38 @@ class NrMacSchedulerOfdma : public NrMacSchedulerTdma
     BeamSymbolMap AssignDLRBG(uint32_t symAvail, const ActiveUeMap& activeDl) const override;
     BeamSymbolMap AssignULRBG(uint32_t symAvail, const ActiveUeMap& activeUl) const override;
 
+    /**
+     * \brief Assign the available DL RBG to the UEs, with a policy
+     * \param symAvail Number of available symbols
+     * \param activeDl active DL flows and UE
+     * \param policy the policy (see NrMacSchedulerTdma::VirtualPolicy)
+     * \return a map between the beam and the symbols assigned to each one
+     *
+     * It hides NrMacSchedulerTdma::AssignDlRbgWith(); as that one, it is
+     * instantiated only for VirtualPolicy and for the policies of
+     * nr-mac-scheduler-policy.h.
+     */
+    template <class Policy>
+    BeamSymbolMap AssignDlRbgWith(uint32_t symAvail,
+                                  const ActiveUeMap& activeDl,
+                                  const Policy& policy) const;
+
+    /**
+     * \brief Assign the available UL RBG to the UEs, with a policy
+     * \param symAvail Number of available symbols
+     * \param activeUl active UL flows and UE
+     * \param policy the policy (see NrMacSchedulerTdma::VirtualPolicy)
+     * \return a map between the beam and the symbols assigned to each one
+     *
+     * It hides NrMacSchedulerTdma::AssignUlRbgWith(); as that one, it is
+     * instantiated only for VirtualPolicy and for the policies of
+     * nr-mac-scheduler-policy.h.
+     */
+    template <class Policy>
+    BeamSymbolMap AssignUlRbgWith(uint32_t symAvail,
+                                  const ActiveUeMap& activeUl,
+                                  const Policy& policy) const;
+
     std::shared_ptr<DciInfoElementTdma> CreateDlDci(
         PointInFTPlane* spoint,
         const std::shared_ptr<NrMacSchedulerUeInfo>& ueInfo,
@@ -96,9 +135,35 @@ class NrMacSchedulerOfdma : public NrMacSchedulerTdma
     NrMacSchedulerOfdma::BeamSymbolMap GetSymPerBeam(uint32_t symAvail,
                                                      const ActiveUeMap& activeDl) const;
 
+    /**
+     * \brief Calculate the number of DL symbols of each beam
+     * \param symAvail Number of available symbols
+     * \param activeDl Map of active DL UE and their beam
+     * \return GetSymPerBeamGroup() with the attribute EnableMuMimo, GetSymPerBeam() otherwise
+     */
+    NrMacSchedulerOfdma::BeamSymbolMap GetDlSymPerBeam(uint32_t symAvail,
+                                                       const ActiveUeMap& activeDl) const;
+
+    BeamGroups GetDlBeamGroups(const ActiveUeMap& activeDl) const override;
+
+    NrMacSchedulerOfdma::BeamSymbolMap GetSymPerBeamGroup(uint32_t symAvail,
+                                                          const ActiveUeMap& activeDl) const;
+
     uint8_t GetTpc() const override;
 
   private:
+    /**
+     * \brief Check if two beams are far enough to be co-scheduled (MU-MIMO)
+     * \param lhs the first beam
+     * \param rhs the second beam
+     * \return true if the sectors or the elevations of the beams are far enough
+     */
+    bool AreBeamsSeparated(const BeamConfId& lhs, const BeamConfId& rhs) const;
+
     TracedValue<uint32_t> m_tracedValueSymPerBeam;
+    bool m_enableMuMimo{false};                //!< Co-schedule the separated DL beams
+    uint8_t m_muMimoMaxLayers{2};              //!< Maximum beams co-scheduled on the same symbols
+    uint16_t m_muMimoMinSectorSeparation{2};   //!< Minimum sector distance for MU-MIMO
+    double m_muMimoMinElevationSeparation{30}; //!< Minimum elevation distance (degrees) for MU-MIMO
 };
 } // namespace ns3
@@ -0,0 +1,112 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include <ns3/assert.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief Outer-loop link adaptation (OLLA) of a UE, in one direction
+ *
+ * The MCS obtained from the CQI is corrected by an offset, in MCS indexes,
+ * that follows the HARQ feedback of the first transmissions: each NACK
+ * decreases it by a step, and each ACK increases it by the step multiplied
+ * by BLER / (1 - BLER), where BLER is the target. At the equilibrium, the
+ * ratio of NACK is the target BLER. The offset is bounded, so that a long
+ * series of ACK (or NACK) does not move the MCS too far from the CQI.
+ *
+ * With the default offset (0), Adjust() returns the MCS that it receives.
+ */
+class NrMacSchedulerOlla
+{
+  public:
+    /**
+     * \brief Parameters of the OLLA, shared by the UEs of a scheduler
+     */
+    struct Config
+    {
+        bool m_enabled{false};     //!< If false, the offset is not updated
+        double m_targetBler{0.1};  //!< Target BLER of the first transmissions
+        double m_step{0.5};        //!< Decrease of the offset after a NACK
+        double m_minOffset{-10.0}; //!< Minimum offset
+        double m_maxOffset{5.0};   //!< Maximum offset
+    };
+
+    /**
+     * \brief Update the offset with the feedback of a first transmission
+     * \param ok true for an ACK, false for a NACK
+     * \param config the parameters of the OLLA
+     */
+    void Feedback(bool ok, const Config& config)
+    {
+        NS_ASSERT(config.m_targetBler > 0.0 && config.m_targetBler < 1.0);
+        if (ok)
+        {
+            ++m_acks;
+            m_offset += config.m_step * config.m_targetBler / (1.0 - config.m_targetBler);
+        }
+        else
+        {
+            ++m_nacks;
+            m_offset -= config.m_step;
+        }
+        m_offset = std::clamp(m_offset, config.m_minOffset, config.m_maxOffset);
+    }
+
+    /**
+     * \brief Set the maximum MCS that Adjust() can return
+     * \param maxMcs the maximum MCS
+     */
+    void SetMaxMcs(uint8_t maxMcs)
+    {
+        m_maxMcs = maxMcs;
+    }
+
+    /**
+     * \brief Apply the offset to a MCS
+     * \param mcs the MCS obtained from the CQI
+     * \return the MCS plus the offset, rounded, between 0 and the maximum MCS
+     */
+    uint8_t Adjust(uint8_t mcs) const
+    {
+        const double adjusted = std::round(mcs + m_offset);
+        return static_cast<uint8_t>(std::clamp(adjusted, 0.0, static_cast<double>(m_maxMcs)));
+    }
+
+    /**
+     * \return the current offset, in MCS indexes
+     */
+    double GetOffset() const
+    {
+        return m_offset;
+    }
+
+    /**
+     * \return the ratio of NACK among the feedbacks received so far, or 0
+     * without feedbacks
+     */
+    double GetBler() const
+    {
+        const uint64_t feedbacks = m_acks + m_nacks;
+        return feedbacks > 0 ? static_cast<double>(m_nacks) / feedbacks : 0.0;
+    }
+
+  private:
+    double m_offset{0.0};        //!< Offset applied to the MCS of the CQI
+    uint8_t m_maxMcs{UINT8_MAX}; //!< Maximum MCS returned by Adjust()
+    uint64_t m_acks{0};          //!< ACK received for first transmissions
+    uint64_t m_nacks{0};         //!< NACK received for first transmissions
+};
+
+} // namespace ns3
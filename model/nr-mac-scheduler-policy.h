@@ -0,0 +1,639 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include "nr-amc.h"
+#include "nr-mac-scheduler-ns3.h"
+#include "nr-mac-scheduler-ue-info-mr.h"
+#include "nr-mac-scheduler-ue-info-pf.h"
+#include "nr-mac-scheduler-ue-info-qos.h"
+#include "nr-mac-scheduler-ue-info-rr.h"
+#include "nr-mac-scheduler-ue-mirror.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief Function object that orders the UEs with a comparison function known
+ * at compile time
+ *
+ * Unlike a std::function, a call through this object can be inlined by the
+ * compiler in the sort and heap operations of the assignment loops.
+ */
+template <bool (*Fn)(const NrMacSchedulerNs3::UePtrAndBufferReq&,
+                     const NrMacSchedulerNs3::UePtrAndBufferReq&)>
+struct NrMacSchedulerUeCompare
+{
+    /**
+     * \param lhs left hand side
+     * \param rhs right hand side
+     * \return true if lhs has to be scheduled before rhs
+     */
+    bool operator()(const NrMacSchedulerNs3::UePtrAndBufferReq& lhs,
+                    const NrMacSchedulerNs3::UePtrAndBufferReq& rhs) const
+    {
+        return Fn(lhs, rhs);
+    }
+};
+
+/**
+ * \ingroup scheduler
+ * \brief The part common to the policies: the sort of the UEs
+ *
+ * The UEs are sorted with std::sort and the comparison function of the policy,
+ * or, if the scheduler gives a mirror of the UEs (SetUeMirror()), by loading
+ * their fields in the mirror and sorting the rows: the order is the same.
+ */
+class NrMacSchedulerPolicyBase
+{
+  public:
+    using UePtrAndBufferReq = NrMacSchedulerNs3::UePtrAndBufferReq; //!< UE and its buffer
+    using FTResources = NrMacSchedulerNs3::FTResources;             //!< Resources
+
+    /**
+     * \brief Sort the UEs through a mirror of their fields
+     * \param mirror the mirror, owned by the scheduler, or nullptr to sort the UEs
+     * directly
+     */
+    void SetUeMirror(NrMacSchedulerUeMirror* mirror)
+    {
+        m_ueMirror = mirror;
+    }
+
+  protected:
+    /**
+     * \brief Sort the UEs
+     * \param ues the UEs
+     * \param compare the comparison function of the UEs
+     * \param load the function that loads the fields of a UE in the mirror
+     * \param compareRows the comparison of the rows, equivalent to compare
+     */
+    template <class Compare, class Load, class CompareRows>
+    void Sort(std::vector<UePtrAndBufferReq>* ues,
+              const Compare& compare,
+              const Load& load,
+              const CompareRows& compareRows) const
+    {
+        if (m_ueMirror == nullptr)
+        {
+            std::sort(ues->begin(), ues->end(), compare);
+            return;
+        }
+        m_ueMirror->Sort(ues, load, compareRows);
+    }
+
+  private:
+    NrMacSchedulerUeMirror* m_ueMirror{nullptr}; //!< Mirror of the UEs, if any
+};
+
+/**
+ * \ingroup scheduler
+ * \brief The round robin policy, for the static dispatch in the assignment loops
+ *
+ * A policy is what the assignment loops of NrMacSchedulerTdma and
+ * NrMacSchedulerOfdma need to know about the scheduler: the comparison
+ * function of the UEs, and what to do before the assignment and after each
+ * unit of resources is (or is not) assigned. The policies of this file do
+ * exactly what the virtual methods of the corresponding schedulers do (e.g.,
+ * NrMacSchedulerTdmaRR::AssignedDlResources()), but they are not virtual, and
+ * they are defined in the header, so that the compiler can inline them. They are
+ * used by NrMacSchedulerStatic.
+ *
+ * A policy is created at each slot, from the AMC of the scheduler and the
+ * scheduler itself, from which it takes its parameters.
+ */
+class NrMacSchedulerPolicyRR : public NrMacSchedulerPolicyBase
+{
+  public:
+    using CompareDl = NrMacSchedulerUeCompare<NrMacSchedulerUeInfoRR::CompareUeWeightsDl>; //!< DL
+    using CompareUl = NrMacSchedulerUeCompare<NrMacSchedulerUeInfoRR::CompareUeWeightsUl>; //!< UL
+
+    /**
+     * \brief NrMacSchedulerPolicyRR constructor
+     * \param dlAmc the DL AMC of the scheduler
+     * \param ulAmc the UL AMC of the scheduler
+     */
+    template <class Scheduler>
+    NrMacSchedulerPolicyRR(const Ptr<const NrAmc>& dlAmc,
+                           const Ptr<const NrAmc>& ulAmc,
+                           const Scheduler& /* sched */)
+        : m_dlAmc(dlAmc),
+          m_ulAmc(ulAmc)
+    {
+    }
+
+    /**
+     * \return the DL comparison function
+     */
+    CompareDl GetCompareDl() const
+    {
+        return CompareDl();
+    }
+
+    /**
+     * \return the UL comparison function
+     */
+    CompareUl GetCompareUl() const
+    {
+        return CompareUl();
+    }
+
+    /**
+     * \brief Sort the UEs for the DL assignment
+     * \param ues the UEs
+     */
+    void SortDl(std::vector<UePtrAndBufferReq>* ues) const
+    {
+        Sort(
+            ues,
+            GetCompareDl(),
+            [](NrMacSchedulerUeMirror* mirror, uint32_t row, const UePtrAndBufferReq& ue) {
+                mirror->m_rbg[row] = ue.first->m_dlRBG;
+            },
+            [](const NrMacSchedulerUeMirror& mirror, uint32_t lhs, uint32_t rhs) {
+                return mirror.m_rbg[lhs] < mirror.m_rbg[rhs];
+            });
+    }
+
+    /**
+     * \brief Sort the UEs for the UL assignment
+     * \param ues the UEs
+     */
+    void SortUl(std::vector<UePtrAndBufferReq>* ues) const
+    {
+        Sort(
+            ues,
+            GetCompareUl(),
+            [](NrMacSchedulerUeMirror* mirror, uint32_t row, const UePtrAndBufferReq& ue) {
+                mirror->m_rbg[row] = ue.first->m_ulRBG;
+            },
+            [](const NrMacSchedulerUeMirror& mirror, uint32_t lhs, uint32_t rhs) {
+                return mirror.m_rbg[lhs] < mirror.m_rbg[rhs];
+            });
+    }
+
+    /**
+     * \brief Nothing to do before the DL assignment
+     */
+    void BeforeDl(const UePtrAndBufferReq& /* ue */, const FTResources& /* assignable */) const
+    {
+    }
+
+    /**
+     * \brief Nothing to do before the UL assignment
+     */
+    void BeforeUl(const UePtrAndBufferReq& /* ue */, const FTResources& /* assignable */) const
+    {
+    }
+
+    /**
+     * \brief Update the DL TB size of the UE that got the resources
+     * \param ue the UE
+     */
+    void AssignedDl(const UePtrAndBufferReq& ue,
+                    const FTResources& /* assigned */,
+                    const FTResources& /* totAssigned */) const
+    {
+        ue.first->UpdateDlMetric(m_dlAmc);
+    }
+
+    /**
+     * \brief Update the UL TB size of the UE that got the resources
+     * \param ue the UE
+     */
+    void AssignedUl(const UePtrAndBufferReq& ue,
+                    const FTResources& /* assigned */,
+                    const FTResources& /* totAssigned */) const
+    {
+        ue.first->UpdateUlMetric(m_ulAmc);
+    }
+
+    /**
+     * \brief Nothing to do for the UEs that did not get DL resources
+     */
+    void NotAssignedDl(const UePtrAndBufferReq& /* ue */,
+                       const FTResources& /* notAssigned */,
+                       const FTResources& /* totAssigned */) const
+    {
+    }
+
+    /**
+     * \brief Nothing to do for the UEs that did not get UL resources
+     */
+    void NotAssignedUl(const UePtrAndBufferReq& /* ue */,
+                       const FTResources& /* notAssigned */,
+                       const FTResources& /* totAssigned */) const
+    {
+    }
+
+  protected:
+    Ptr<const NrAmc> m_dlAmc; //!< DL AMC of the scheduler
+    Ptr<const NrAmc> m_ulAmc; //!< UL AMC of the scheduler
+};
+
+/**
+ * \ingroup scheduler
+ * \brief The maximum rate policy: the round robin one, with a different order
+ */
+class NrMacSchedulerPolicyMR : public NrMacSchedulerPolicyRR
+{
+  public:
+    using CompareDl = NrMacSchedulerUeCompare<NrMacSchedulerUeInfoMR::CompareUeWeightsDl>; //!< DL
+    using CompareUl = NrMacSchedulerUeCompare<NrMacSchedulerUeInfoMR::CompareUeWeightsUl>; //!< UL
+
+    using NrMacSchedulerPolicyRR::NrMacSchedulerPolicyRR;
+
+    /**
+     * \return the DL comparison function
+     */
+    CompareDl GetCompareDl() const
+    {
+        return CompareDl();
+    }
+
+    /**
+     * \return the UL comparison function
+     */
+    CompareUl GetCompareUl() const
+    {
+        return CompareUl();
+    }
+
+    /**
+     * \brief Sort the UEs for the DL assignment
+     * \param ues the UEs
+     */
+    void SortDl(std::vector<UePtrAndBufferReq>* ues) const
+    {
+        Sort(
+            ues,
+            GetCompareDl(),
+            [](NrMacSchedulerUeMirror* mirror, uint32_t row, const UePtrAndBufferReq& ue) {
+                mirror->m_mcs[row] = NrMacSchedulerUeMirror::PackMcs(ue.first->m_dlMcs);
+                mirror->m_rbg[row] = ue.first->m_dlRBG;
+            },
+            [](const NrMacSchedulerUeMirror& mirror, uint32_t lhs, uint32_t rhs) {
+                if (mirror.m_mcs[lhs] == mirror.m_mcs[rhs])
+                {
+                    return mirror.m_rbg[lhs] < mirror.m_rbg[rhs];
+                }
+                return mirror.m_mcs[lhs] > mirror.m_mcs[rhs];
+            });
+    }
+
+    /**
+     * \brief Sort the UEs for the UL assignment
+     * \param ues the UEs
+     */
+    void SortUl(std::vector<UePtrAndBufferReq>* ues) const
+    {
+        Sort(
+            ues,
+            GetCompareUl(),
+            [](NrMacSchedulerUeMirror* mirror, uint32_t row, const UePtrAndBufferReq& ue) {
+                mirror->m_mcs[row] = ue.first->m_ulMcs;
+                mirror->m_rbg[row] = ue.first->m_ulRBG;
+            },
+            [](const NrMacSchedulerUeMirror& mirror, uint32_t lhs, uint32_t rhs) {
+                if (mirror.m_mcs[lhs] == mirror.m_mcs[rhs])
+                {
+                    return mirror.m_rbg[lhs] < mirror.m_rbg[rhs];
+                }
+                return mirror.m_mcs[lhs] > mirror.m_mcs[rhs];
+            });
+    }
+};
+
+/**
+ * \ingroup scheduler
+ * \brief The proportional fair policy
+ *
+ * The scheduler has to provide GetTimeWindow(), and to create the UEs as
+ * NrMacSchedulerUeInfoPF.
+ */
+class NrMacSchedulerPolicyPF : public NrMacSchedulerPolicyBase
+{
+  public:
+    using CompareDl = NrMacSchedulerUeCompare<NrMacSchedulerUeInfoPF::CompareUeWeightsDl>; //!< DL
+    using CompareUl = NrMacSchedulerUeCompare<NrMacSchedulerUeInfoPF::CompareUeWeightsUl>; //!< UL
+
+    /**
+     * \brief NrMacSchedulerPolicyPF constructor
+     * \param dlAmc the DL AMC of the scheduler
+     * \param ulAmc the UL AMC of the scheduler
+     * \param sched the scheduler, for the time window
+     */
+    template <class Scheduler>
+    NrMacSchedulerPolicyPF(const Ptr<const NrAmc>& dlAmc,
+                           const Ptr<const NrAmc>& ulAmc,
+                           const Scheduler& sched)
+        : m_dlAmc(dlAmc),
+          m_ulAmc(ulAmc),
+          m_timeWindow(sched.GetTimeWindow())
+    {
+    }
+
+    /**
+     * \return the DL comparison function
+     */
+    CompareDl GetCompareDl() const
+    {
+        return CompareDl();
+    }
+
+    /**
+     * \return the UL comparison function
+     */
+    CompareUl GetCompareUl() const
+    {
+        return CompareUl();
+    }
+
+    /**
+     * \brief Sort the UEs for the DL assignment
+     * \param ues the UEs
+     */
+    void SortDl(std::vector<UePtrAndBufferReq>* ues) const
+    {
+        Sort(
+            ues,
+            GetCompareDl(),
+            [](NrMacSchedulerUeMirror* mirror, uint32_t row, const UePtrAndBufferReq& ue) {
+                mirror->m_metric[row] = NrMacSchedulerUeInfoPF::CalculateDlMetric(ue);
+            },
+            [](const NrMacSchedulerUeMirror& mirror, uint32_t lhs, uint32_t rhs) {
+                return mirror.m_metric[lhs] > mirror.m_metric[rhs];
+            });
+    }
+
+    /**
+     * \brief Sort the UEs for the UL assignment
+     * \param ues the UEs
+     */
+    void SortUl(std::vector<UePtrAndBufferReq>* ues) const
+    {
+        Sort(
+            ues,
+            GetCompareUl(),
+            [](NrMacSchedulerUeMirror* mirror, uint32_t row, const UePtrAndBufferReq& ue) {
+                mirror->m_metric[row] = NrMacSchedulerUeInfoPF::CalculateUlMetric(ue);
+            },
+            [](const NrMacSchedulerUeMirror& mirror, uint32_t lhs, uint32_t rhs) {
+                return mirror.m_metric[lhs] > mirror.m_metric[rhs];
+            });
+    }
+
+    /**
+     * \brief Calculate the DL potential throughput of the UE
+     * \param ue the UE
+     * \param assignable the resources assignable in an iteration
+     */
+    void BeforeDl(const UePtrAndBufferReq& ue, const FTResources& assignable) const
+    {
+        Ue(ue)->CalculatePotentialTPutDl(assignable, m_dlAmc);
+    }
+
+    /**
+     * \brief Calculate the UL potential throughput of the UE
+     * \param ue the UE
+     * \param assignable the resources assignable in an iteration
+     */
+    void BeforeUl(const UePtrAndBufferReq& ue, const FTResources& assignable) const
+    {
+        Ue(ue)->CalculatePotentialTPutUl(assignable, m_ulAmc);
+    }
+
+    /**
+     * \brief Update the DL PF metric of the UE that got the resources
+     * \param ue the UE
+     * \param totAssigned the resources assigned in the slot
+     */
+    void AssignedDl(const UePtrAndBufferReq& ue,
+                    const FTResources& /* assigned */,
+                    const FTResources& totAssigned) const
+    {
+        Ue(ue)->UpdateDlPFMetric(totAssigned, m_timeWindow, m_dlAmc);
+    }
+
+    /**
+     * \brief Update the UL PF metric of the UE that got the resources
+     * \param ue the UE
+     * \param totAssigned the resources assigned in the slot
+     */
+    void AssignedUl(const UePtrAndBufferReq& ue,
+                    const FTResources& /* assigned */,
+                    const FTResources& totAssigned) const
+    {
+        Ue(ue)->UpdateUlPFMetric(totAssigned, m_timeWindow, m_ulAmc);
+    }
+
+    /**
+     * \brief Update the DL PF metric of a UE that did not get the resources
+     * \param ue the UE
+     * \param totAssigned the resources assigned in the slot
+     */
+    void NotAssignedDl(const UePtrAndBufferReq& ue,
+                       const FTResources& /* notAssigned */,
+                       const FTResources& totAssigned) const
+    {
+        Ue(ue)->UpdateDlPFMetric(totAssigned, m_timeWindow, m_dlAmc);
+    }
+
+    /**
+     * \brief Update the UL PF metric of a UE that did not get the resources
+     * \param ue the UE
+     * \param totAssigned the resources assigned in the slot
+     */
+    void NotAssignedUl(const UePtrAndBufferReq& ue,
+                       const FTResources& /* notAssigned */,
+                       const FTResources& totAssigned) const
+    {
+        Ue(ue)->UpdateUlPFMetric(totAssigned, m_timeWindow, m_ulAmc);
+    }
+
+  private:
+    /**
+     * \param ue the UE
+     * \return the PF representation of the UE
+     */
+    static NrMacSchedulerUeInfoPF* Ue(const UePtrAndBufferReq& ue)
+    {
+        return static_cast<NrMacSchedulerUeInfoPF*>(ue.first.get());
+    }
+
+    Ptr<const NrAmc> m_dlAmc; //!< DL AMC of the scheduler
+    Ptr<const NrAmc> m_ulAmc; //!< UL AMC of the scheduler
+    double m_timeWindow;      //!< Time window of the average throughput
+};
+
+/**
+ * \ingroup scheduler
+ * \brief The QoS policy
+ *
+ * The scheduler has to provide GetTimeWindow(), and to create the UEs as
+ * NrMacSchedulerUeInfoQos.
+ */
+class NrMacSchedulerPolicyQos : public NrMacSchedulerPolicyBase
+{
+  public:
+    using CompareDl = NrMacSchedulerUeCompare<NrMacSchedulerUeInfoQos::CompareUeWeightsDl>; //!< DL
+    using CompareUl = NrMacSchedulerUeCompare<NrMacSchedulerUeInfoQos::CompareUeWeightsUl>; //!< UL
+
+    /**
+     * \brief NrMacSchedulerPolicyQos constructor
+     * \param dlAmc the DL AMC of the scheduler
+     * \param ulAmc the UL AMC of the scheduler
+     * \param sched the scheduler, for the time window
+     */
+    template <class Scheduler>
+    NrMacSchedulerPolicyQos(const Ptr<const NrAmc>& dlAmc,
+                            const Ptr<const NrAmc>& ulAmc,
+                            const Scheduler& sched)
+        : m_dlAmc(dlAmc),
+          m_ulAmc(ulAmc),
+          m_timeWindow(sched.GetTimeWindow())
+    {
+    }
+
+    /**
+     * \return the DL comparison function
+     */
+    CompareDl GetCompareDl() const
+    {
+        return CompareDl();
+    }
+
+    /**
+     * \return the UL comparison function
+     */
+    CompareUl GetCompareUl() const
+    {
+        return CompareUl();
+    }
+
+    /**
+     * \brief Sort the UEs for the DL assignment
+     * \param ues the UEs
+     */
+    void SortDl(std::vector<UePtrAndBufferReq>* ues) const
+    {
+        Sort(
+            ues,
+            GetCompareDl(),
+            [](NrMacSchedulerUeMirror* mirror, uint32_t row, const UePtrAndBufferReq& ue) {
+                mirror->m_metric[row] = NrMacSchedulerUeInfoQos::CalculateDlWeight(ue);
+                NS_ASSERT_MSG(mirror->m_metric[row] > 0, "Weight must be greater than zero");
+            },
+            [](const NrMacSchedulerUeMirror& mirror, uint32_t lhs, uint32_t rhs) {
+                return mirror.m_metric[lhs] > mirror.m_metric[rhs];
+            });
+    }
+
+    /**
+     * \brief Sort the UEs for the UL assignment
+     * \param ues the UEs
+     */
+    void SortUl(std::vector<UePtrAndBufferReq>* ues) const
+    {
+        Sort(
+            ues,
+            GetCompareUl(),
+            [](NrMacSchedulerUeMirror* mirror, uint32_t row, const UePtrAndBufferReq& ue) {
+                mirror->m_metric[row] = NrMacSchedulerUeInfoQos::CalculateUlWeight(ue);
+            },
+            [](const NrMacSchedulerUeMirror& mirror, uint32_t lhs, uint32_t rhs) {
+                return mirror.m_metric[lhs] > mirror.m_metric[rhs];
+            });
+    }
+
+    /**
+     * \brief Calculate the DL potential throughput of the UE
+     * \param ue the UE
+     * \param assignable the resources assignable in an iteration
+     */
+    void BeforeDl(const UePtrAndBufferReq& ue, const FTResources& assignable) const
+    {
+        Ue(ue)->CalculatePotentialTPutDl(assignable, m_dlAmc);
+    }
+
+    /**
+     * \brief Calculate the UL potential throughput of the UE
+     * \param ue the UE
+     * \param assignable the resources assignable in an iteration
+     */
+    void BeforeUl(const UePtrAndBufferReq& ue, const FTResources& assignable) const
+    {
+        Ue(ue)->CalculatePotentialTPutUl(assignable, m_ulAmc);
+    }
+
+    /**
+     * \brief Update the DL QoS metric of the UE that got the resources
+     * \param ue the UE
+     * \param totAssigned the resources assigned in the slot
+     */
+    void AssignedDl(const UePtrAndBufferReq& ue,
+                    const FTResources& /* assigned */,
+                    const FTResources& totAssigned) const
+    {
+        Ue(ue)->UpdateDlQosMetric(totAssigned, m_timeWindow, m_dlAmc);
+    }
+
+    /**
+     * \brief Update the UL QoS metric of the UE that got the resources
+     * \param ue the UE
+     * \param totAssigned the resources assigned in the slot
+     */
+    void AssignedUl(const UePtrAndBufferReq& ue,
+                    const FTResources& /* assigned */,
+                    const FTResources& totAssigned) const
+    {
+        Ue(ue)->UpdateUlQosMetric(totAssigned, m_timeWindow, m_ulAmc);
+    }
+
+    /**
+     * \brief Update the DL QoS metric of a UE that did not get the resources
+     * \param ue the UE
+     * \param totAssigned the resources assigned in the slot
+     */
+    void NotAssignedDl(const UePtrAndBufferReq& ue,
+                       const FTResources& /* notAssigned */,
+                       const FTResources& totAssigned) const
+    {
+        Ue(ue)->UpdateDlQosMetric(totAssigned, m_timeWindow, m_dlAmc);
+    }
+
+    /**
+     * \brief Update the UL QoS metric of a UE that did not get the resources
+     * \param ue the UE
+     * \param totAssigned the resources assigned in the slot
+     */
+    void NotAssignedUl(const UePtrAndBufferReq& ue,
+                       const FTResources& /* notAssigned */,
+                       const FTResources& totAssigned) const
+    {
+        Ue(ue)->UpdateUlQosMetric(totAssigned, m_timeWindow, m_ulAmc);
+    }
+
+  private:
+    /**
+     * \param ue the UE
+     * \return the QoS representation of the UE
+     */
+    static NrMacSchedulerUeInfoQos* Ue(const UePtrAndBufferReq& ue)
+    {
+        return static_cast<NrMacSchedulerUeInfoQos*>(ue.first.get());
+    }
+
+    Ptr<const NrAmc> m_dlAmc; //!< DL AMC of the scheduler
+    Ptr<const NrAmc> m_ulAmc; //!< UL AMC of the scheduler
+    double m_timeWindow;      //!< Time window of the average throughput
+};
+
+} // namespace ns3
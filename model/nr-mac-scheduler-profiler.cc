@@ -0,0 +1,195 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "nr-mac-scheduler-profiler.h"
+
+#include <ns3/log.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("NrMacSchedulerProfiler");
+
+void
+NrMacSchedulerProfiler::BeginSlot(Direction direction, const SfnSf& sfnSf)
+{
+    NS_ASSERT_MSG(!m_inSlot, "The scheduling of the previous slot did not end");
+    m_inSlot = true;
+    m_slot = SlotProfile();
+    m_slot.m_direction = direction;
+    m_slot.m_sfnSf = sfnSf;
+    m_running.clear();
+}
+
+void
+NrMacSchedulerProfiler::SetNumUes(uint32_t numUes)
+{
+    m_slot.m_numUes = numUes;
+}
+
+const NrMacSchedulerProfiler::SlotProfile&
+NrMacSchedulerProfiler::EndSlot(uint32_t numRbg)
+{
+    NS_ASSERT_MSG(m_inSlot, "The scheduling of the slot did not begin");
+    NS_ASSERT_MSG(m_running.empty(), "A phase is still running at the end of the slot");
+    m_inSlot = false;
+    m_slot.m_numRbg = numRbg;
+    ++m_numSlots.at(m_slot.m_direction);
+
+    Key key;
+    key.m_direction = m_slot.m_direction;
+    key.m_ueBin = GetBin(m_slot.m_numUes);
+    key.m_rbgBin = GetBin(numRbg);
+    for (uint8_t phase = 0; phase < NUM_PHASES; ++phase)
+    {
+        if (m_slot.m_numCalls[phase] == 0)
+        {
+            continue;
+        }
+        key.m_phase = static_cast<Phase>(phase);
+        PhaseStats& stats = m_stats[key];
+        ++stats.m_numSlots;
+        stats.m_numCalls += m_slot.m_numCalls[phase];
+        stats.m_totalNs += m_slot.m_timeNs[phase];
+        ++stats.m_timeBins.at(std::min<std::size_t>(GetBin(m_slot.m_timeNs[phase]),
+                                                    NUM_TIME_BINS - 1));
+    }
+    return m_slot;
+}
+
+const std::map<NrMacSchedulerProfiler::Key, NrMacSchedulerProfiler::PhaseStats>&
+NrMacSchedulerProfiler::GetStats() const
+{
+    return m_stats;
+}
+
+uint64_t
+NrMacSchedulerProfiler::GetNumSlots(Direction direction) const
+{
+    return m_numSlots.at(direction);
+}
+
+void
+NrMacSchedulerProfiler::Print(std::ostream& os) const
+{
+    auto binRange = [](uint8_t bin) {
+        std::ostringstream range;
+        if (bin <= 1)
+        {
+            range << +bin;
+        }
+        else
+        {
+            range << (1ULL << (bin - 1)) << "-" << (1ULL << bin) - 1;
+        }
+        return range.str();
+    };
+
+    os << "Scheduler profile: " << m_numSlots[DL] << " DL slots, " << m_numSlots[UL]
+       << " UL slots" << std::endl;
+    os << std::left << std::setw(4) << "Dir" << std::setw(10) << "Phase" << std::setw(10) << "UEs"
+       << std::setw(10) << "RBGs" << std::right << std::setw(10) << "Slots" << std::setw(12)
+       << "Calls" << std::setw(12) << "Mean(ns)" << std::setw(12) << "Median(ns)" << std::endl;
+    for (const auto& [key, stats] : m_stats)
+    {
+        // The median is reported as the upper bound of its bin
+        uint64_t cumulated = 0;
+        uint8_t medianBin = 0;
+        for (std::size_t bin = 0; bin < NUM_TIME_BINS; ++bin)
+        {
+            cumulated += stats.m_timeBins[bin];
+            if (2 * cumulated >= stats.m_numSlots)
+            {
+                medianBin = static_cast<uint8_t>(bin);
+                break;
+            }
+        }
+        os << std::left << std::setw(4) << (key.m_direction == DL ? "DL" : "UL") << std::setw(10)
+           << GetPhaseName(key.m_phase) << std::setw(10) << binRange(key.m_ueBin) << std::setw(10)
+           << binRange(key.m_rbgBin) << std::right << std::setw(10) << stats.m_numSlots
+           << std::setw(12) << stats.m_numCalls << std::setw(12)
+           << stats.m_totalNs / stats.m_numSlots << std::setw(12)
+           << (medianBin == 0 ? 0 : (1ULL << medianBin) - 1) << std::endl;
+    }
+}
+
+uint8_t
+NrMacSchedulerProfiler::GetBin(uint64_t value)
+{
+    uint8_t bin = 0;
+    while (value > 0)
+    {
+        ++bin;
+        value >>= 1;
+    }
+    return bin;
+}
+
+const char*
+NrMacSchedulerProfiler::GetPhaseName(Phase phase)
+{
+    switch (phase)
+    {
+    case HARQ:
+        return "HARQ";
+    case ACTIVE_UE:
+        return "ACTIVE_UE";
+    case BEAM:
+        return "BEAM";
+    case RBG:
+        return "RBG";
+    case LC_BYTES:
+        return "LC_BYTES";
+    case DCI:
+        return "DCI";
+    default:
+        NS_FATAL_ERROR("Unknown scheduler phase " << +phase);
+    }
+    return "";
+}
+
+void
+NrMacSchedulerProfiler::StartPhase(Phase phase)
+{
+    if (!m_inSlot)
+    {
+        return;
+    }
+    NS_ASSERT(phase < NUM_PHASES);
+    m_lastResume = Account();
+    m_running.push_back(phase);
+    ++m_slot.m_numCalls[phase];
+}
+
+void
+NrMacSchedulerProfiler::StopPhase()
+{
+    if (!m_inSlot)
+    {
+        return;
+    }
+    NS_ASSERT(!m_running.empty());
+    m_lastResume = Account();
+    m_running.pop_back();
+}
+
+std::chrono::steady_clock::time_point
+NrMacSchedulerProfiler::Account()
+{
+    auto now = std::chrono::steady_clock::now();
+    if (!m_running.empty())
+    {
+        m_slot.m_timeNs[m_running.back()] +=
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_lastResume).count();
+    }
+    return now;
+}
+
+} // namespace ns3
@@ -0,0 +1,241 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include "sfnsf.h"
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <ostream>
+#include <tuple>
+#include <vector>
+
+/**
+ * \ingroup scheduler
+ * \brief Measure the wall time of a scheduler phase, until the end of the scope
+ *
+ * The macro expands to nothing unless the module is built with the CMake
+ * option NR_SCHEDULER_PROFILING, so the instrumented code costs nothing in
+ * a normal build. It must be used inside a member function of
+ * NrMacSchedulerNs3 (or of a subclass), which owns the profiler.
+ */
+#ifdef NR_SCHEDULER_PROFILING
+#define NR_SCHEDULER_PROFILE_PHASE(phase)                                                          \
+    NrMacSchedulerProfiler::ScopedPhase nrSchedulerProfilePhase(&m_profiler,                       \
+                                                                NrMacSchedulerProfiler::phase)
+#else
+#define NR_SCHEDULER_PROFILE_PHASE(phase)
+#endif
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief Per-phase wall time of the scheduling of each slot
+ *
+ * The scheduling of a slot (NrMacSchedulerNs3::ScheduleDl or
+ * NrMacSchedulerNs3::ScheduleUl) is enclosed between BeginSlot() and
+ * EndSlot(), and each phase of the scheduling is measured by a ScopedPhase
+ * object. Phases can be nested (e.g., the beam assignment is done inside the
+ * RBG assignment of the OFDMA schedulers): the time of a phase does not
+ * include the time of the phases nested inside it.
+ *
+ * At the end of each slot, the SlotProfile is added to histograms of the
+ * wall time of each phase, split by direction, by number of active UEs, and
+ * by number of RBGs of the bandwidth (both in power-of-two bins), so that a
+ * scaling regression appears as a shift of the histograms of the biggest
+ * bins. Print() writes a summary of the histograms.
+ */
+class NrMacSchedulerProfiler
+{
+  public:
+    /**
+     * \brief The phases of the scheduling of a slot
+     */
+    enum Phase : uint8_t
+    {
+        HARQ = 0,  //!< HARQ retransmissions scheduling
+        ACTIVE_UE, //!< Computation of the active UEs and HARQ processes
+        BEAM,      //!< Assignment of the symbols to the beams
+        RBG,       //!< Assignment of the RBGs to the UEs
+        LC_BYTES,  //!< Distribution of the TBS among the LCs
+        DCI,       //!< Creation of the DCIs
+        NUM_PHASES //!< Number of phases (not a phase)
+    };
+
+    /**
+     * \brief Direction of the scheduled slot
+     */
+    enum Direction : uint8_t
+    {
+        DL = 0, //!< Downlink
+        UL = 1  //!< Uplink
+    };
+
+    static constexpr std::size_t NUM_TIME_BINS = 32; //!< Power-of-two bins of the wall time, in ns
+
+    /**
+     * \brief Wall time of the phases of one slot
+     */
+    struct SlotProfile
+    {
+        Direction m_direction{DL};                     //!< Direction of the slot
+        SfnSf m_sfnSf;                                 //!< Scheduled slot
+        uint32_t m_numUes{0};                          //!< Number of active UEs
+        uint32_t m_numRbg{0};                          //!< Number of RBGs of the bandwidth
+        std::array<uint64_t, NUM_PHASES> m_timeNs{};   //!< Wall time of each phase, in ns
+        std::array<uint32_t, NUM_PHASES> m_numCalls{}; //!< Number of times each phase ran
+    };
+
+    /**
+     * \brief TracedCallback signature for the profile of a slot
+     * \param [in] profile the profile
+     */
+    typedef void (*SlotProfileTracedCallback)(const SlotProfile& profile);
+
+    /**
+     * \brief Index of a histogram: direction, phase, UE bin and RBG bin
+     */
+    struct Key
+    {
+        Direction m_direction{DL}; //!< Direction
+        Phase m_phase{HARQ};       //!< Phase
+        uint8_t m_ueBin{0};        //!< Bin of the number of UEs (see GetBin())
+        uint8_t m_rbgBin{0};       //!< Bin of the number of RBGs (see GetBin())
+
+        /**
+         * \param o other key
+         * \return true if this key is ordered before the other one
+         */
+        bool operator<(const Key& o) const
+        {
+            return std::tie(m_direction, m_phase, m_ueBin, m_rbgBin) <
+                   std::tie(o.m_direction, o.m_phase, o.m_ueBin, o.m_rbgBin);
+        }
+    };
+
+    /**
+     * \brief Histogram of the wall time of a phase
+     */
+    struct PhaseStats
+    {
+        uint64_t m_numSlots{0};                           //!< Slots in which the phase ran
+        uint64_t m_numCalls{0};                           //!< Times the phase ran
+        uint64_t m_totalNs{0};                            //!< Total wall time, in ns
+        std::array<uint64_t, NUM_TIME_BINS> m_timeBins{}; //!< Slots per bin of wall time
+    };
+
+    /**
+     * \brief Measure a phase, from the construction to the destruction of the object
+     */
+    class ScopedPhase
+    {
+      public:
+        /**
+         * \brief Start measuring a phase
+         * \param profiler the profiler
+         * \param phase the phase
+         */
+        ScopedPhase(NrMacSchedulerProfiler* profiler, Phase phase)
+            : m_profiler(profiler)
+        {
+            m_profiler->StartPhase(phase);
+        }
+
+        ScopedPhase(const ScopedPhase&) = delete;
+        ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+        /**
+         * \brief Stop measuring the phase
+         */
+        ~ScopedPhase()
+        {
+            m_profiler->StopPhase();
+        }
+
+      private:
+        NrMacSchedulerProfiler* m_profiler; //!< The profiler
+    };
+
+    /**
+     * \brief Start the scheduling of a slot
+     * \param direction direction of the slot
+     * \param sfnSf the slot
+     */
+    void BeginSlot(Direction direction, const SfnSf& sfnSf);
+
+    /**
+     * \brief Set the number of active UEs of the current slot
+     * \param numUes number of active UEs
+     */
+    void SetNumUes(uint32_t numUes);
+
+    /**
+     * \brief End the scheduling of a slot, and add its profile to the histograms
+     * \param numRbg number of RBGs of the bandwidth
+     * \return the profile of the slot
+     */
+    const SlotProfile& EndSlot(uint32_t numRbg);
+
+    /**
+     * \return the histograms
+     */
+    const std::map<Key, PhaseStats>& GetStats() const;
+
+    /**
+     * \param direction direction
+     * \return the number of profiled slots in a direction
+     */
+    uint64_t GetNumSlots(Direction direction) const;
+
+    /**
+     * \brief Print a summary of the histograms
+     * \param os the output stream
+     */
+    void Print(std::ostream& os) const;
+
+    /**
+     * \param value a number of UEs, RBGs, or ns
+     * \return the power-of-two bin of the value: 0 for 0, 1 for 1, 2 for 2-3, 3 for 4-7, ...
+     */
+    static uint8_t GetBin(uint64_t value);
+
+    /**
+     * \param phase a phase
+     * \return the name of the phase
+     */
+    static const char* GetPhaseName(Phase phase);
+
+  private:
+    /**
+     * \brief Start a phase, pausing the phase that is running (if any)
+     * \param phase the phase
+     */
+    void StartPhase(Phase phase);
+
+    /**
+     * \brief Stop the running phase, resuming the phase that was paused (if any)
+     */
+    void StopPhase();
+
+    /**
+     * \brief Add the time since the last start or resume to the running phase
+     * \return the current time
+     */
+    std::chrono::steady_clock::time_point Account();
+
+    bool m_inSlot{false};                               //!< True between BeginSlot() and EndSlot()
+    SlotProfile m_slot;                                 //!< Profile of the current slot
+    std::vector<Phase> m_running;                       //!< Running phase, and the paused ones
+    std::chrono::steady_clock::time_point m_lastResume; //!< Last start or resume of a phase
+    std::map<Key, PhaseStats> m_stats;                  //!< The histograms
+    std::array<uint64_t, 2> m_numSlots{};               //!< Profiled slots per direction
+};
+
+} // namespace ns3
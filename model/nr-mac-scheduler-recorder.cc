@@ -0,0 +1,304 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "nr-mac-scheduler-recorder.h"
+
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("NrMacSchedulerRecorder");
+NS_OBJECT_ENSURE_REGISTERED(NrMacSchedulerRecorder);
+
+class NrMacSchedulerRecorderCschedSapProvider : public NrMacCschedSapProvider
+{
+  public:
+    NrMacSchedulerRecorderCschedSapProvider() = delete;
+
+    NrMacSchedulerRecorderCschedSapProvider(NrMacSchedulerRecorder* recorder)
+        : m_recorder(recorder)
+    {
+    }
+
+    ~NrMacSchedulerRecorderCschedSapProvider() override = default;
+
+    // inherited from NrMacCschedSapProvider
+    void CschedCellConfigReq(
+        const NrMacCschedSapProvider::CschedCellConfigReqParameters& params) override
+    {
+        m_recorder->Record(params);
+        m_recorder->m_cschedSapProvider->CschedCellConfigReq(params);
+    }
+
+    void CschedUeConfigReq(
+        const NrMacCschedSapProvider::CschedUeConfigReqParameters& params) override
+    {
+        m_recorder->Record(params);
+        m_recorder->m_cschedSapProvider->CschedUeConfigReq(params);
+    }
+
+    void CschedLcConfigReq(
+        const NrMacCschedSapProvider::CschedLcConfigReqParameters& params) override
+    {
+        m_recorder->Record(params);
+        m_recorder->m_cschedSapProvider->CschedLcConfigReq(params);
+    }
+
+    void CschedLcReleaseReq(
+        const NrMacCschedSapProvider::CschedLcReleaseReqParameters& params) override
+    {
+        m_recorder->Record(params);
+        m_recorder->m_cschedSapProvider->CschedLcReleaseReq(params);
+    }
+
+    void CschedUeReleaseReq(
+        const NrMacCschedSapProvider::CschedUeReleaseReqParameters& params) override
+    {
+        m_recorder->Record(params);
+        m_recorder->m_cschedSapProvider->CschedUeReleaseReq(params);
+    }
+
+  private:
+    NrMacSchedulerRecorder* m_recorder{nullptr};
+};
+
+class NrMacSchedulerRecorderSchedSapProvider : public NrMacSchedSapProvider
+{
+  public:
+    NrMacSchedulerRecorderSchedSapProvider() = delete;
+
+    NrMacSchedulerRecorderSchedSapProvider(NrMacSchedulerRecorder* recorder)
+        : m_recorder(recorder)
+    {
+    }
+
+    void SchedDlRlcBufferReq(
+        const NrMacSchedSapProvider::SchedDlRlcBufferReqParameters& params) override
+    {
+        m_recorder->Record(params);
+        m_recorder->m_schedSapProvider->SchedDlRlcBufferReq(params);
+    }
+
+    void SchedDlTriggerReq(
+        const NrMacSchedSapProvider::SchedDlTriggerReqParameters& params) override
+    {
+        m_recorder->RecordConfig();
+        m_recorder->Record(params);
+        m_recorder->m_schedSapProvider->SchedDlTriggerReq(params);
+    }
+
+    void SchedUlTriggerReq(
+        const NrMacSchedSapProvider::SchedUlTriggerReqParameters& params) override
+    {
+        m_recorder->RecordConfig();
+        m_recorder->Record(params);
+        m_recorder->m_schedSapProvider->SchedUlTriggerReq(params);
+    }
+
+    void SchedDlCqiInfoReq(
+        const NrMacSchedSapProvider::SchedDlCqiInfoReqParameters& params) override
+    {
+        m_recorder->Record(params);
+        m_recorder->m_schedSapProvider->SchedDlCqiInfoReq(params);
+    }
+
+    void SchedUlCqiInfoReq(
+        const NrMacSchedSapProvider::SchedUlCqiInfoReqParameters& params) override
+    {
+        m_recorder->Record(params);
+        m_recorder->m_schedSapProvider->SchedUlCqiInfoReq(params);
+    }
+
+    void SchedUlMacCtrlInfoReq(
+        const NrMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters& params) override
+    {
+        m_recorder->Record(params);
+        m_recorder->m_schedSapProvider->SchedUlMacCtrlInfoReq(params);
+    }
+
+    void SchedUlSrInfoReq(const SchedUlSrInfoReqParameters& params) override
+    {
+        m_recorder->Record(params);
+        m_recorder->m_schedSapProvider->SchedUlSrInfoReq(params);
+    }
+
+    void SchedSetMcs(uint32_t mcs) override
+    {
+        m_recorder->Record(mcs);
+        m_recorder->m_schedSapProvider->SchedSetMcs(mcs);
+    }
+
+    void SchedDlRachInfoReq(const SchedDlRachInfoReqParameters& params) override
+    {
+        m_recorder->Record(params);
+        m_recorder->m_schedSapProvider->SchedDlRachInfoReq(params);
+    }
+
+    void SchedDlMiniSlotReq(const SchedDlMiniSlotReqParameters& params) override
+    {
+        m_recorder->Record(params);
+        m_recorder->m_schedSapProvider->SchedDlMiniSlotReq(params);
+    }
+
+    uint8_t GetDlCtrlSyms() const override
+    {
+        return m_recorder->m_schedSapProvider->GetDlCtrlSyms();
+    }
+
+    uint8_t GetUlCtrlSyms() const override
+    {
+        return m_recorder->m_schedSapProvider->GetUlCtrlSyms();
+    }
+
+    uint64_t GetDlBufferSize() const override
+    {
+        return m_recorder->m_schedSapProvider->GetDlBufferSize();
+    }
+
+    uint64_t GetUlBufferSize() const override
+    {
+        return m_recorder->m_schedSapProvider->GetUlBufferSize();
+    }
+
+  private:
+    NrMacSchedulerRecorder* m_recorder{nullptr};
+};
+
+TypeId
+NrMacSchedulerRecorder::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::NrMacSchedulerRecorder")
+                            .SetParent<Object>()
+                            .AddConstructor<NrMacSchedulerRecorder>()
+                            .SetGroupName("nr");
+    return tid;
+}
+
+NrMacSchedulerRecorder::NrMacSchedulerRecorder()
+    : m_ownSchedSapProvider(std::make_unique<NrMacSchedulerRecorderSchedSapProvider>(this)),
+      m_ownCschedSapProvider(std::make_unique<NrMacSchedulerRecorderCschedSapProvider>(this))
+{
+    NS_LOG_FUNCTION(this);
+}
+
+NrMacSchedulerRecorder::~NrMacSchedulerRecorder()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+NrMacSchedulerRecorder::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    NS_LOG_INFO("Recorded " << m_numRecords << " scheduler calls");
+    m_writer.Close();
+    Object::DoDispose();
+}
+
+void
+NrMacSchedulerRecorder::Open(const std::string& filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+    m_writer.Open(filename);
+}
+
+void
+NrMacSchedulerRecorder::SetMacSchedSapProvider(NrMacSchedSapProvider* s)
+{
+    m_schedSapProvider = s;
+}
+
+void
+NrMacSchedulerRecorder::SetMacCschedSapProvider(NrMacCschedSapProvider* s)
+{
+    m_cschedSapProvider = s;
+}
+
+void
+NrMacSchedulerRecorder::SetMacSchedSapUser(NrMacSchedSapUser* s)
+{
+    m_schedSapUser = s;
+}
+
+NrMacSchedSapProvider*
+NrMacSchedulerRecorder::GetMacSchedSapProvider()
+{
+    return m_ownSchedSapProvider.get();
+}
+
+NrMacCschedSapProvider*
+NrMacSchedulerRecorder::GetMacCschedSapProvider()
+{
+    return m_ownCschedSapProvider.get();
+}
+
+uint64_t
+NrMacSchedulerRecorder::GetNumRecords() const
+{
+    return m_numRecords;
+}
+
+void
+NrMacSchedulerRecorder::RecordConfiguredGrantAdded(uint16_t rnti, const NrConfiguredGrant& grant)
+{
+    NS_LOG_FUNCTION(this << rnti);
+    NrMacSchedulerTrace::ConfiguredGrantAdd params;
+    params.m_rnti = rnti;
+    params.m_grant = grant;
+    Record(std::move(params));
+}
+
+void
+NrMacSchedulerRecorder::RecordConfiguredGrantRemoved(uint16_t rnti,
+                                                     DciInfoElementTdma::DciFormat format)
+{
+    NS_LOG_FUNCTION(this << rnti);
+    NrMacSchedulerTrace::ConfiguredGrantRemove params;
+    params.m_rnti = rnti;
+    params.m_format = format;
+    Record(std::move(params));
+}
+
+void
+NrMacSchedulerRecorder::Record(NrMacSchedulerTrace::Params&& params)
+{
+    if (!m_writer.IsOpen())
+    {
+        return;
+    }
+
+    NrMacSchedulerTrace::Record record;
+    record.m_timeNs = Simulator::Now().GetNanoSeconds();
+    record.m_params = std::move(params);
+    m_writer.Write(record);
+    ++m_numRecords;
+}
+
+void
+NrMacSchedulerRecorder::RecordConfig()
+{
+    if (m_configRecorded || !m_writer.IsOpen())
+    {
+        return;
+    }
+    NS_ABORT_MSG_IF(m_schedSapUser == nullptr, "The SAP user of the MAC is not set");
+    m_configRecorded = true;
+
+    NrMacSchedulerTrace::Config config;
+    config.m_symbolsPerSlot = m_schedSapUser->GetSymbolsPerSlot();
+    config.m_slotPeriodNs = m_schedSapUser->GetSlotPeriod().GetNanoSeconds();
+    config.m_numRbPerRbg = m_schedSapUser->GetNumRbPerRbg();
+    config.m_numHarqProcess = m_schedSapUser->GetNumHarqProcess();
+    config.m_bwpId = m_schedSapUser->GetBwpId();
+    config.m_cellId = m_schedSapUser->GetCellId();
+    const auto& spectrumModel = m_schedSapUser->GetSpectrumModel();
+    config.m_bands.assign(spectrumModel->Begin(), spectrumModel->End());
+    Record(std::move(config));
+}
+
+} // namespace ns3
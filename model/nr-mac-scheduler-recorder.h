@@ -0,0 +1,143 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include "nr-mac-scheduler-trace.h"
+
+#include <ns3/object.h>
+
+#include <memory>
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief Record the calls from the MAC to the scheduler in a trace file
+ *
+ * The recorder sits between the MAC and the scheduler. The MAC calls the
+ * SAP providers of the recorder (GetMacSchedSapProvider() and
+ * GetMacCschedSapProvider()); the recorder appends each call to a
+ * NrMacSchedulerTrace, and then forwards it to the SAP providers of the
+ * scheduler. The calls that return a value (GetDlCtrlSyms(),
+ * GetUlCtrlSyms() and the buffer sizes) are forwarded, but not recorded.
+ *
+ * The configuration that the scheduler reads from the MAC
+ * (NrMacSchedSapUser) is recorded once, just before the first slot
+ * trigger, when the PHY and the MAC are surely configured. The configured
+ * grants, which are given directly to the scheduler, are recorded through
+ * the trace sources ConfiguredGrantAdded and ConfiguredGrantRemoved of
+ * NrMacSchedulerNs3, connected to RecordConfiguredGrantAdded() and
+ * RecordConfiguredGrantRemoved().
+ *
+ * The trace can then be fed to any scheduler by NrMacSchedulerReplay,
+ * without PHY or channel. The recorder is usually installed by
+ * NrHelper::EnableSchedulerRecording().
+ */
+class NrMacSchedulerRecorder : public Object
+{
+  public:
+    /**
+     * \brief GetTypeId
+     * \return The TypeId of the class
+     */
+    static TypeId GetTypeId();
+
+    /**
+     * \brief NrMacSchedulerRecorder constructor
+     */
+    NrMacSchedulerRecorder();
+
+    /**
+     * \brief NrMacSchedulerRecorder destructor
+     */
+    ~NrMacSchedulerRecorder() override;
+
+    /**
+     * \brief Create the trace file; the calls before it are not recorded
+     * \param filename name of the file
+     */
+    void Open(const std::string& filename);
+
+    /**
+     * \brief Set the SAP provider of the scheduler, to which the calls are forwarded
+     * \param s the SAP provider of the scheduler
+     */
+    void SetMacSchedSapProvider(NrMacSchedSapProvider* s);
+
+    /**
+     * \brief Set the CSCHED SAP provider of the scheduler, to which the calls are forwarded
+     * \param s the CSCHED SAP provider of the scheduler
+     */
+    void SetMacCschedSapProvider(NrMacCschedSapProvider* s);
+
+    /**
+     * \brief Set the SAP user of the MAC, from which the configuration is read
+     * \param s the SAP user of the MAC
+     */
+    void SetMacSchedSapUser(NrMacSchedSapUser* s);
+
+    /**
+     * \return the SAP provider that the MAC should call
+     */
+    NrMacSchedSapProvider* GetMacSchedSapProvider();
+
+    /**
+     * \return the CSCHED SAP provider that the MAC should call
+     */
+    NrMacCschedSapProvider* GetMacCschedSapProvider();
+
+    /**
+     * \return the number of records written
+     */
+    uint64_t GetNumRecords() const;
+
+    /**
+     * \brief Record a configured grant added to a UE
+     * \param rnti RNTI of the UE
+     * \param grant the grant
+     */
+    void RecordConfiguredGrantAdded(uint16_t rnti, const NrConfiguredGrant& grant);
+
+    /**
+     * \brief Record the removal of the configured grants of a UE in a direction
+     * \param rnti RNTI of the UE
+     * \param format DL or UL
+     */
+    void RecordConfiguredGrantRemoved(uint16_t rnti, DciInfoElementTdma::DciFormat format);
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    friend class NrMacSchedulerRecorderSchedSapProvider;
+    friend class NrMacSchedulerRecorderCschedSapProvider;
+
+    /**
+     * \brief Append a call to the trace
+     * \param params the parameters of the call
+     */
+    void Record(NrMacSchedulerTrace::Params&& params);
+
+    /**
+     * \brief Record the configuration, if it has not been recorded yet
+     */
+    void RecordConfig();
+
+    NrMacSchedulerTrace::Writer m_writer; //!< The trace file
+    uint64_t m_numRecords{0};             //!< Number of records written
+    bool m_configRecorded{false};         //!< True after the CONFIG record
+
+    NrMacSchedSapProvider* m_schedSapProvider{nullptr};   //!< SAP of the scheduler
+    NrMacCschedSapProvider* m_cschedSapProvider{nullptr}; //!< CSCHED SAP of the scheduler
+    NrMacSchedSapUser* m_schedSapUser{nullptr};           //!< SAP user of the MAC
+
+    std::unique_ptr<NrMacSchedSapProvider> m_ownSchedSapProvider;   //!< SAP for the MAC
+    std::unique_ptr<NrMacCschedSapProvider> m_ownCschedSapProvider; //!< CSCHED SAP for the MAC
+};
+
+} // namespace ns3
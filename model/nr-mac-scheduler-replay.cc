@@ -0,0 +1,527 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "nr-mac-scheduler-replay.h"
+
+#include "nr-amc.h"
+#include "nr-mac-scheduler-ns3.h"
+
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+
+#include <chrono>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("NrMacSchedulerReplay");
+
+/**
+ * \brief The SAP user of the scheduler: it answers with the recorded configuration,
+ * and it adds the decisions of the scheduler to the report and to the DCIs
+ * waiting for feedback
+ */
+class NrMacSchedulerReplay::SchedSapUser : public NrMacSchedSapUser
+{
+  public:
+    SchedSapUser(NrMacSchedulerReplay* replay)
+        : m_replay(replay),
+          m_spectrumModel(Create<SpectrumModel>(replay->m_config.m_bands))
+    {
+    }
+
+    void SchedConfigInd(struct SchedConfigIndParameters params) override
+    {
+        AddSlot(&m_replay->m_report, params.m_slotAllocInfo);
+        m_replay->AddPending(params.m_slotAllocInfo);
+    }
+
+    Ptr<const SpectrumModel> GetSpectrumModel() const override
+    {
+        return m_spectrumModel;
+    }
+
+    uint32_t GetNumRbPerRbg() const override
+    {
+        return m_replay->m_config.m_numRbPerRbg;
+    }
+
+    uint8_t GetNumHarqProcess() const override
+    {
+        return m_replay->m_config.m_numHarqProcess;
+    }
+
+    uint16_t GetBwpId() const override
+    {
+        return m_replay->m_config.m_bwpId;
+    }
+
+    uint16_t GetCellId() const override
+    {
+        return m_replay->m_config.m_cellId;
+    }
+
+    uint32_t GetSymbolsPerSlot() const override
+    {
+        return m_replay->m_config.m_symbolsPerSlot;
+    }
+
+    Time GetSlotPeriod() const override
+    {
+        return NanoSeconds(m_replay->m_config.m_slotPeriodNs);
+    }
+
+  private:
+    NrMacSchedulerReplay* m_replay{nullptr};  //!< The replay
+    Ptr<const SpectrumModel> m_spectrumModel; //!< Spectrum model built from the recorded bands
+};
+
+/**
+ * \brief The CSCHED SAP user of the scheduler: the confirmations are ignored
+ */
+class NrMacSchedulerReplay::CschedSapUser : public NrMacCschedSapUser
+{
+  public:
+    void CschedCellConfigCnf(const CschedCellConfigCnfParameters& /* params */) override
+    {
+    }
+
+    void CschedUeConfigCnf(const CschedUeConfigCnfParameters& /* params */) override
+    {
+    }
+
+    void CschedLcConfigCnf(const CschedLcConfigCnfParameters& /* params */) override
+    {
+    }
+
+    void CschedLcReleaseCnf(const CschedLcReleaseCnfParameters& /* params */) override
+    {
+    }
+
+    void CschedUeReleaseCnf(const CschedUeReleaseCnfParameters& /* params */) override
+    {
+    }
+
+    void CschedUeConfigUpdateInd(const CschedUeConfigUpdateIndParameters& /* params */) override
+    {
+    }
+
+    void CschedCellConfigUpdateInd(
+        const CschedCellConfigUpdateIndParameters& /* params */) override
+    {
+    }
+};
+
+NrMacSchedulerReplay::NrMacSchedulerReplay(const std::string& filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+    m_reader.Open(filename);
+}
+
+NrMacSchedulerReplay::~NrMacSchedulerReplay()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+NrMacSchedulerReplay::Report
+NrMacSchedulerReplay::Run(const Ptr<NrMacSchedulerNs3>& sched)
+{
+    NS_LOG_FUNCTION(this << sched);
+    NS_ABORT_MSG_IF(m_sched != nullptr, "A trace can be replayed only once");
+    m_sched = sched;
+
+    // The scheduler can't be connected before the configuration is known;
+    // the calls that precede it (e.g., CSCHED) are kept aside
+    NrMacSchedulerTrace::Record record;
+    bool configFound = false;
+    while (m_reader.Read(&record))
+    {
+        if (record.GetType() == NrMacSchedulerTrace::CONFIG)
+        {
+            m_config = std::get<NrMacSchedulerTrace::CONFIG>(record.m_params);
+            configFound = true;
+            ++m_report.m_numRecords;
+            break;
+        }
+        m_pending.push_back(record);
+    }
+    NS_ABORT_MSG_IF(!configFound, "The trace has no configuration: no slot was recorded");
+
+    m_schedSapUser = std::make_unique<SchedSapUser>(this);
+    m_cschedSapUser = std::make_unique<CschedSapUser>();
+    m_sched->SetMacSchedSapUser(m_schedSapUser.get());
+    m_sched->SetMacCschedSapUser(m_cschedSapUser.get());
+    if (m_sched->GetDlAmc() == nullptr)
+    {
+        m_sched->InstallDlAmc(CreateObject<NrAmc>());
+    }
+    if (m_sched->GetUlAmc() == nullptr)
+    {
+        m_sched->InstallUlAmc(CreateObject<NrAmc>());
+    }
+
+    ScheduleNext();
+    Simulator::Run();
+
+    if (m_report.m_schedulerNs > 0)
+    {
+        m_report.m_slotsPerSecond = (m_report.m_numDlSlots + m_report.m_numUlSlots) * 1e9 /
+                                    static_cast<double>(m_report.m_schedulerNs);
+    }
+    return m_report;
+}
+
+void
+NrMacSchedulerReplay::ScheduleNext()
+{
+    NrMacSchedulerTrace::Record record;
+    if (!m_pending.empty())
+    {
+        record = std::move(m_pending.front());
+        m_pending.pop_front();
+    }
+    else if (!m_reader.Read(&record))
+    {
+        NS_LOG_INFO("End of the trace after " << m_report.m_numRecords << " records");
+        return;
+    }
+
+    Time delay = NanoSeconds(record.m_timeNs) - Simulator::Now();
+    NS_ABORT_MSG_IF(delay.IsStrictlyNegative(), "The records of the trace are not in time order");
+    Simulator::Schedule(delay, &NrMacSchedulerReplay::Execute, this, record);
+}
+
+void
+NrMacSchedulerReplay::Execute(const NrMacSchedulerTrace::Record& record)
+{
+    NS_LOG_FUNCTION(this << +record.GetType());
+    NrMacSchedSapProvider* sched = m_sched->GetMacSchedSapProvider();
+    NrMacCschedSapProvider* csched = m_sched->GetMacCschedSapProvider();
+    const auto& params = record.m_params;
+
+    // The feedback is matched with the decisions of the replayed scheduler
+    // before starting the clock
+    NrMacSchedSapProvider::SchedDlTriggerReqParameters dlTrigger;
+    NrMacSchedSapProvider::SchedUlTriggerReqParameters ulTrigger;
+    bool ulCqiExpected = false;
+    switch (record.GetType())
+    {
+    case NrMacSchedulerTrace::DL_TRIGGER:
+        ++m_report.m_numDlSlots;
+        dlTrigger = std::get<NrMacSchedulerTrace::DL_TRIGGER>(params);
+        FilterFeedback(&dlTrigger.m_dlHarqInfoList);
+        break;
+    case NrMacSchedulerTrace::UL_TRIGGER:
+        ++m_report.m_numUlSlots;
+        ulTrigger = std::get<NrMacSchedulerTrace::UL_TRIGGER>(params);
+        FilterFeedback(&ulTrigger.m_ulHarqInfoList);
+        break;
+    case NrMacSchedulerTrace::UL_CQI:
+        ulCqiExpected = IsUlCqiExpected(std::get<NrMacSchedulerTrace::UL_CQI>(params));
+        break;
+    default:
+        break;
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    switch (record.GetType())
+    {
+    case NrMacSchedulerTrace::CONFIG:
+        NS_FATAL_ERROR("The configuration of the MAC is recorded only once");
+        break;
+    case NrMacSchedulerTrace::CELL_CONFIG:
+        csched->CschedCellConfigReq(std::get<NrMacSchedulerTrace::CELL_CONFIG>(params));
+        break;
+    case NrMacSchedulerTrace::UE_CONFIG:
+        csched->CschedUeConfigReq(std::get<NrMacSchedulerTrace::UE_CONFIG>(params));
+        break;
+    case NrMacSchedulerTrace::LC_CONFIG:
+        csched->CschedLcConfigReq(std::get<NrMacSchedulerTrace::LC_CONFIG>(params));
+        break;
+    case NrMacSchedulerTrace::LC_RELEASE:
+        csched->CschedLcReleaseReq(std::get<NrMacSchedulerTrace::LC_RELEASE>(params));
+        break;
+    case NrMacSchedulerTrace::UE_RELEASE:
+        csched->CschedUeReleaseReq(std::get<NrMacSchedulerTrace::UE_RELEASE>(params));
+        ReleasePending(std::get<NrMacSchedulerTrace::UE_RELEASE>(params).m_rnti);
+        break;
+    case NrMacSchedulerTrace::DL_RLC_BUFFER:
+        sched->SchedDlRlcBufferReq(std::get<NrMacSchedulerTrace::DL_RLC_BUFFER>(params));
+        break;
+    case NrMacSchedulerTrace::DL_CQI:
+        sched->SchedDlCqiInfoReq(std::get<NrMacSchedulerTrace::DL_CQI>(params));
+        break;
+    case NrMacSchedulerTrace::DL_TRIGGER:
+        sched->SchedDlTriggerReq(dlTrigger);
+        break;
+    case NrMacSchedulerTrace::UL_CQI:
+        if (ulCqiExpected)
+        {
+            sched->SchedUlCqiInfoReq(std::get<NrMacSchedulerTrace::UL_CQI>(params));
+        }
+        break;
+    case NrMacSchedulerTrace::UL_TRIGGER:
+        sched->SchedUlTriggerReq(ulTrigger);
+        break;
+    case NrMacSchedulerTrace::UL_SR:
+        sched->SchedUlSrInfoReq(std::get<NrMacSchedulerTrace::UL_SR>(params));
+        break;
+    case NrMacSchedulerTrace::UL_MAC_CTRL:
+        sched->SchedUlMacCtrlInfoReq(std::get<NrMacSchedulerTrace::UL_MAC_CTRL>(params));
+        break;
+    case NrMacSchedulerTrace::DL_RACH:
+        sched->SchedDlRachInfoReq(std::get<NrMacSchedulerTrace::DL_RACH>(params));
+        break;
+    case NrMacSchedulerTrace::SET_MCS:
+        sched->SchedSetMcs(std::get<NrMacSchedulerTrace::SET_MCS>(params));
+        break;
+    case NrMacSchedulerTrace::CG_ADD: {
+        const auto& cg = std::get<NrMacSchedulerTrace::CG_ADD>(params);
+        m_sched->AddConfiguredGrant(cg.m_rnti, cg.m_grant);
+        break;
+    }
+    case NrMacSchedulerTrace::CG_REMOVE: {
+        const auto& cg = std::get<NrMacSchedulerTrace::CG_REMOVE>(params);
+        m_sched->RemoveConfiguredGrant(cg.m_rnti, cg.m_format);
+        break;
+    }
+    case NrMacSchedulerTrace::MINI_SLOT:
+        // The mini-slot, if used, comes back through SchedConfigInd
+        sched->SchedDlMiniSlotReq(std::get<NrMacSchedulerTrace::MINI_SLOT>(params));
+        break;
+    default:
+        NS_FATAL_ERROR("Unknown record " << +record.GetType());
+    }
+    m_report.m_schedulerNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                  std::chrono::steady_clock::now() - begin)
+                                  .count();
+    ++m_report.m_numRecords;
+
+    ScheduleNext();
+}
+
+void
+NrMacSchedulerReplay::AddPending(const SlotAllocInfo& slot)
+{
+    for (const auto& varTti : slot.m_varTtiAllocInfo)
+    {
+        const auto& dci = varTti.m_dci;
+        // The release of a configured grant has no feedback
+        if (dci == nullptr || dci->m_type != DciInfoElementTdma::DATA || dci->m_cgRelease)
+        {
+            continue;
+        }
+        const auto key = std::make_pair(dci->m_rnti, dci->m_harqProcess);
+        if (dci->m_format == DciInfoElementTdma::DL)
+        {
+            m_dlPendingHarq[key] = PendingHarq{dci, m_report.m_numDlSlots};
+        }
+        else
+        {
+            m_ulPendingHarq[key] = PendingHarq{dci, m_report.m_numUlSlots};
+            auto& ulCqi = m_ulCqiPending[slot.m_sfnSf.GetEncodingWithSymStart(dci->m_symStart)];
+            ulCqi.m_rntis.insert(dci->m_rnti);
+            ulCqi.m_trigger = m_report.m_numUlSlots;
+        }
+    }
+}
+
+void
+NrMacSchedulerReplay::ExpirePending(PendingHarqMap* pending, uint64_t trigger) const
+{
+    // The scheduler erases a process after GetNumHarqProcess() triggers without
+    // feedback (ResetExpiredHARQ): after that, the feedback would be fatal
+    for (auto it = pending->begin(); it != pending->end(); /* no incr */)
+    {
+        if (trigger - it->second.m_trigger >= m_config.m_numHarqProcess)
+        {
+            it = pending->erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void
+NrMacSchedulerReplay::ReleasePending(uint16_t rnti)
+{
+    for (auto* pending : {&m_dlPendingHarq, &m_ulPendingHarq})
+    {
+        for (auto it = pending->begin(); it != pending->end(); /* no incr */)
+        {
+            it = it->first.first == rnti ? pending->erase(it) : std::next(it);
+        }
+    }
+    // The scheduler keeps the UL allocations of a released UE: their CQI can't
+    // be delivered
+    for (auto it = m_ulCqiPending.begin(); it != m_ulCqiPending.end(); /* no incr */)
+    {
+        it = it->second.m_rntis.count(rnti) > 0 ? m_ulCqiPending.erase(it) : std::next(it);
+    }
+}
+
+void
+NrMacSchedulerReplay::FilterFeedback(std::vector<DlHarqInfo>* feedback)
+{
+    ExpirePending(&m_dlPendingHarq, m_report.m_numDlSlots);
+
+    std::vector<DlHarqInfo> delivered;
+    for (auto& harq : *feedback)
+    {
+        auto it = m_dlPendingHarq.find(std::make_pair(harq.m_rnti, harq.m_harqProcessId));
+        if (it == m_dlPendingHarq.end())
+        {
+            NS_LOG_INFO("Dropped the DL feedback of UE " << harq.m_rnti << " process "
+                                                         << +harq.m_harqProcessId);
+            ++m_report.m_numDroppedFeedback;
+            continue;
+        }
+
+        // The streams are those of the replayed DCI, the outcome is the recorded one
+        const auto& dci = it->second.m_dci;
+        std::vector<DlHarqInfo::HarqStatus> status(dci->m_tbSize.size(), DlHarqInfo::NONE);
+        for (std::size_t stream = 0; stream < status.size(); ++stream)
+        {
+            if (dci->m_tbSize.at(stream) > 0)
+            {
+                bool nack = stream < harq.m_harqStatus.size() &&
+                            harq.m_harqStatus.at(stream) == DlHarqInfo::NACK;
+                status.at(stream) = nack ? DlHarqInfo::NACK : DlHarqInfo::ACK;
+            }
+        }
+        harq.m_harqStatus = std::move(status);
+        harq.m_numRetx = dci->m_rv;
+        delivered.push_back(std::move(harq));
+        m_dlPendingHarq.erase(it);
+    }
+    *feedback = std::move(delivered);
+}
+
+void
+NrMacSchedulerReplay::FilterFeedback(std::vector<UlHarqInfo>* feedback)
+{
+    ExpirePending(&m_ulPendingHarq, m_report.m_numUlSlots);
+    for (auto it = m_ulCqiPending.begin(); it != m_ulCqiPending.end(); /* no incr */)
+    {
+        bool expired = m_report.m_numUlSlots - it->second.m_trigger >= m_config.m_numHarqProcess;
+        it = expired ? m_ulCqiPending.erase(it) : std::next(it);
+    }
+
+    std::vector<UlHarqInfo> delivered;
+    for (auto& harq : *feedback)
+    {
+        auto it = m_ulPendingHarq.find(std::make_pair(harq.m_rnti, harq.m_harqProcessId));
+        if (it == m_ulPendingHarq.end())
+        {
+            NS_LOG_INFO("Dropped the UL feedback of UE " << harq.m_rnti << " process "
+                                                         << +harq.m_harqProcessId);
+            ++m_report.m_numDroppedFeedback;
+            continue;
+        }
+
+        harq.m_numRetx = it->second.m_dci->m_rv.at(0);
+        delivered.push_back(std::move(harq));
+        m_ulPendingHarq.erase(it);
+    }
+    *feedback = std::move(delivered);
+}
+
+bool
+NrMacSchedulerReplay::IsUlCqiExpected(
+    const NrMacSchedSapProvider::SchedUlCqiInfoReqParameters& params)
+{
+    auto it = m_ulCqiPending.find(params.m_sfnSf.GetEncodingWithSymStart(params.m_symStart));
+    if (it == m_ulCqiPending.end())
+    {
+        NS_LOG_INFO("Dropped the UL CQI of " << params.m_sfnSf << " symbol "
+                                             << +params.m_symStart);
+        ++m_report.m_numDroppedFeedback;
+        return false;
+    }
+    m_ulCqiPending.erase(it);
+    return true;
+}
+
+void
+NrMacSchedulerReplay::AddSlot(Report* report, const SlotAllocInfo& slot)
+{
+    auto hash = [report](uint64_t value) {
+        // FNV-1a, one byte at a time
+        for (uint32_t i = 0; i < sizeof(value); ++i)
+        {
+            report->m_digest ^= (value >> (8 * i)) & 0xFF;
+            report->m_digest *= 1099511628211ULL;
+        }
+    };
+    auto hashVector = [&hash](const auto& values) {
+        hash(values.size());
+        for (const auto& v : values)
+        {
+            hash(v);
+        }
+    };
+
+    hash(slot.m_sfnSf.GetEncoding());
+    for (const auto& varTti : slot.m_varTtiAllocInfo)
+    {
+        const auto& dci = varTti.m_dci;
+        if (dci == nullptr)
+        {
+            continue;
+        }
+        hash(dci->m_rnti);
+        hash(dci->m_format);
+        hash(dci->m_type);
+        hash(dci->m_symStart);
+        hash(dci->m_numSym);
+        hash(dci->m_harqProcess);
+        hash(dci->m_bwpIndex);
+        hash(dci->m_tpc);
+        hashVector(dci->m_mcs);
+        hashVector(dci->m_tbSize);
+        hashVector(dci->m_ndi);
+        hashVector(dci->m_rv);
+        hashVector(dci->m_rbgBitmask);
+
+        if (dci->m_type != DciInfoElementTdma::DATA)
+        {
+            continue;
+        }
+        uint64_t bytes = 0;
+        for (const auto& tbs : dci->m_tbSize)
+        {
+            bytes += tbs;
+        }
+        if (dci->m_format == DciInfoElementTdma::DL)
+        {
+            ++report->m_numDlDci;
+            report->m_dlBytes += bytes;
+        }
+        else
+        {
+            ++report->m_numUlDci;
+            report->m_ulBytes += bytes;
+        }
+    }
+}
+
+void
+NrMacSchedulerReplay::Print(std::ostream& os, const Report& report)
+{
+    os << "Records replayed:  " << report.m_numRecords << std::endl;
+    os << "Slots (DL/UL):     " << report.m_numDlSlots << "/" << report.m_numUlSlots
+       << std::endl;
+    os << "Data DCIs (DL/UL): " << report.m_numDlDci << "/" << report.m_numUlDci << std::endl;
+    os << "Bytes (DL/UL):     " << report.m_dlBytes << "/" << report.m_ulBytes << std::endl;
+    os << "Dropped feedback:  " << report.m_numDroppedFeedback << std::endl;
+    os << "Scheduler time:    " << report.m_schedulerNs / 1e6 << " ms" << std::endl;
+    os << "Slots per second:  " << report.m_slotsPerSecond << std::endl;
+    os << "Decision digest:   " << std::hex << report.m_digest << std::dec << std::endl;
+}
+
+} // namespace ns3
@@ -0,0 +1,200 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include "nr-mac-scheduler-trace.h"
+
+#include <ns3/ptr.h>
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <set>
+
+namespace ns3
+{
+
+class NrMacSchedulerNs3;
+
+/**
+ * \ingroup scheduler
+ * \brief Feed a scheduler with a trace recorded by NrMacSchedulerRecorder
+ *
+ * The replay takes the place of the MAC: it implements the SAP users of the
+ * scheduler, answering with the configuration stored in the trace, and it
+ * calls the SAP providers of the scheduler with the recorded parameters, at
+ * the recorded simulation time. There is no PHY and no channel: the CQI and
+ * the HARQ feedback are the recorded ones, so the trace is meaningful for any
+ * scheduler, but the feedback does not react to the decisions of the
+ * replayed scheduler.
+ *
+ * Since the replayed scheduler may decide differently from the recorded one,
+ * the HARQ feedback and the UL CQI are matched with the DCIs that the replayed
+ * scheduler created. A recorded HARQ feedback is delivered only if the same
+ * HARQ process of the same UE is waiting for feedback in the replayed
+ * scheduler, and it is rebuilt from the replayed DCI (streams and number of
+ * retransmissions), with the recorded outcome. A recorded UL CQI is delivered
+ * only if the replayed scheduler allocated UL data in the same slot and
+ * symbol. The rest is dropped, and counted in the report; a process that
+ * gets no feedback expires in the scheduler, as with a lost feedback.
+ *
+ * Run() reports the number of scheduled slots, the wall time spent inside
+ * the scheduler, and a summary of the decisions (number of DCIs, bytes, and a
+ * digest of all the DCIs). Two runs of the same trace on two schedulers
+ * take the same decisions if and only if (barring hash collisions) their
+ * digests are equal.
+ */
+class NrMacSchedulerReplay
+{
+  public:
+    /**
+     * \brief Summary of a replay
+     */
+    struct Report
+    {
+        static constexpr uint64_t FNV_OFFSET = 14695981039346656037ULL; //!< FNV-1a offset basis
+
+        uint64_t m_numRecords{0};         //!< Records replayed
+        uint64_t m_numDlSlots{0};         //!< DL slot triggers
+        uint64_t m_numUlSlots{0};         //!< UL slot triggers
+        uint64_t m_numDlDci{0};           //!< DL data DCIs
+        uint64_t m_numUlDci{0};           //!< UL data DCIs
+        uint64_t m_dlBytes{0};            //!< Bytes of the DL data DCIs
+        uint64_t m_ulBytes{0};            //!< Bytes of the UL data DCIs
+        uint64_t m_numDroppedFeedback{0}; //!< HARQ feedback and UL CQI without a replayed DCI
+        uint64_t m_schedulerNs{0};        //!< Wall time spent inside the scheduler, in ns
+        uint64_t m_digest{FNV_OFFSET};    //!< FNV-1a digest of all the DCIs
+        double m_slotsPerSecond{0.0};     //!< Slot triggers per second of scheduler wall time
+    };
+
+    /**
+     * \brief NrMacSchedulerReplay constructor
+     * \param filename name of the trace file
+     */
+    NrMacSchedulerReplay(const std::string& filename);
+
+    /**
+     * \brief NrMacSchedulerReplay destructor
+     */
+    ~NrMacSchedulerReplay();
+
+    /**
+     * \brief Replay the trace on a scheduler
+     * \param sched the scheduler, not yet connected to a MAC; the default
+     * NrAmc is installed if the scheduler has none
+     * \return the summary of the replay
+     *
+     * The records are scheduled as events, and the simulator is run until
+     * the end of the trace; the caller is responsible for destroying the
+     * simulator afterwards.
+     */
+    Report Run(const Ptr<NrMacSchedulerNs3>& sched);
+
+    /**
+     * \brief Add the DCIs of a slot to a report
+     * \param report the report
+     * \param slot the allocation decided by the scheduler
+     */
+    static void AddSlot(Report* report, const SlotAllocInfo& slot);
+
+    /**
+     * \brief Print a report
+     * \param os the output stream
+     * \param report the report
+     */
+    static void Print(std::ostream& os, const Report& report);
+
+  private:
+    class SchedSapUser;
+    class CschedSapUser;
+
+    /**
+     * \brief A data DCI of the replayed scheduler, waiting for its HARQ feedback
+     */
+    struct PendingHarq
+    {
+        std::shared_ptr<DciInfoElementTdma> m_dci; //!< The DCI
+        uint64_t m_trigger{0}; //!< Slot trigger (of its direction) in which it was created
+    };
+
+    /**
+     * \brief Data DCIs waiting for their HARQ feedback, by RNTI and HARQ process
+     */
+    using PendingHarqMap = std::map<std::pair<uint16_t, uint8_t>, PendingHarq>;
+
+    /**
+     * \brief UL data allocations of the replayed scheduler, waiting for their CQI
+     */
+    struct PendingUlCqi
+    {
+        std::set<uint16_t> m_rntis; //!< The UEs of the allocations
+        uint64_t m_trigger{0};      //!< UL slot trigger in which they were created
+    };
+
+    /**
+     * \brief Read the next record, and schedule it at its time
+     */
+    void ScheduleNext();
+
+    /**
+     * \brief Keep track of the data DCIs created by the replayed scheduler
+     * \param slot the allocation decided by the scheduler
+     */
+    void AddPending(const SlotAllocInfo& slot);
+
+    /**
+     * \brief Forget the DCIs whose HARQ process has expired in the scheduler
+     * \param pending the DCIs waiting for feedback
+     * \param trigger the current slot trigger
+     */
+    void ExpirePending(PendingHarqMap* pending, uint64_t trigger) const;
+
+    /**
+     * \brief Forget the DCIs and the UL allocations of a UE
+     * \param rnti the RNTI of the UE
+     */
+    void ReleasePending(uint16_t rnti);
+
+    /**
+     * \brief Match the recorded DL HARQ feedback with the replayed DCIs
+     * \param feedback the recorded feedback, replaced by the feedback to deliver
+     */
+    void FilterFeedback(std::vector<DlHarqInfo>* feedback);
+
+    /**
+     * \brief Match the recorded UL HARQ feedback with the replayed DCIs
+     * \param feedback the recorded feedback, replaced by the feedback to deliver
+     */
+    void FilterFeedback(std::vector<UlHarqInfo>* feedback);
+
+    /**
+     * \brief Check if a recorded UL CQI refers to an allocation of the replayed scheduler
+     * \param params the recorded UL CQI
+     * \return true if the UL CQI can be delivered
+     */
+    bool IsUlCqiExpected(const NrMacSchedSapProvider::SchedUlCqiInfoReqParameters& params);
+
+    /**
+     * \brief Call the scheduler with a record, then schedule the next one
+     * \param record the record
+     */
+    void Execute(const NrMacSchedulerTrace::Record& record);
+
+    NrMacSchedulerTrace::Reader m_reader;              //!< The trace
+    NrMacSchedulerTrace::Config m_config;              //!< The configuration of the MAC
+    std::deque<NrMacSchedulerTrace::Record> m_pending; //!< Records read before the CONFIG
+    Ptr<NrMacSchedulerNs3> m_sched;                    //!< The replayed scheduler
+    std::unique_ptr<SchedSapUser> m_schedSapUser;      //!< SAP user given to the scheduler
+    std::unique_ptr<CschedSapUser> m_cschedSapUser;    //!< CSCHED SAP user given to the scheduler
+    Report m_report;                                   //!< Summary of the replay
+    PendingHarqMap m_dlPendingHarq;                    //!< DL DCIs waiting for feedback
+    PendingHarqMap m_ulPendingHarq;                    //!< UL DCIs waiting for feedback
+    std::map<uint64_t, PendingUlCqi> m_ulCqiPending;   //!< By slot and starting symbol
+};
+
+} // namespace ns3
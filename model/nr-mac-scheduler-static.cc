@@ -0,0 +1,151 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "nr-mac-scheduler-static.h"
+
+#include <ns3/boolean.h>
+
+namespace ns3
+{
+
+NS_OBJECT_ENSURE_REGISTERED(NrMacSchedulerTdmaRRStatic);
+NS_OBJECT_ENSURE_REGISTERED(NrMacSchedulerTdmaMRStatic);
+NS_OBJECT_ENSURE_REGISTERED(NrMacSchedulerTdmaPFStatic);
+NS_OBJECT_ENSURE_REGISTERED(NrMacSchedulerTdmaQosStatic);
+NS_OBJECT_ENSURE_REGISTERED(NrMacSchedulerOfdmaRRStatic);
+NS_OBJECT_ENSURE_REGISTERED(NrMacSchedulerOfdmaMRStatic);
+NS_OBJECT_ENSURE_REGISTERED(NrMacSchedulerOfdmaPFStatic);
+NS_OBJECT_ENSURE_REGISTERED(NrMacSchedulerOfdmaQosStatic);
+
+TypeId
+NrMacSchedulerTdmaRRStatic::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::NrMacSchedulerTdmaRRStatic")
+            .SetParent<NrMacSchedulerTdmaRR>()
+            .AddConstructor<NrMacSchedulerTdmaRRStatic>()
+            .AddAttribute("UeStateMirror",
+                          "Sort the UEs through a contiguous copy of the fields used to "
+                          "compare them, loaded once per sort",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&NrMacSchedulerTdmaRRStatic::m_ueStateMirror),
+                          MakeBooleanChecker());
+    return tid;
+}
+
+TypeId
+NrMacSchedulerTdmaMRStatic::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::NrMacSchedulerTdmaMRStatic")
+            .SetParent<NrMacSchedulerTdmaMR>()
+            .AddConstructor<NrMacSchedulerTdmaMRStatic>()
+            .AddAttribute("UeStateMirror",
+                          "Sort the UEs through a contiguous copy of the fields used to "
+                          "compare them, loaded once per sort",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&NrMacSchedulerTdmaMRStatic::m_ueStateMirror),
+                          MakeBooleanChecker());
+    return tid;
+}
+
+TypeId
+NrMacSchedulerTdmaPFStatic::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::NrMacSchedulerTdmaPFStatic")
+            .SetParent<NrMacSchedulerTdmaPF>()
+            .AddConstructor<NrMacSchedulerTdmaPFStatic>()
+            .AddAttribute("UeStateMirror",
+                          "Sort the UEs through a contiguous copy of the fields used to "
+                          "compare them, loaded once per sort",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&NrMacSchedulerTdmaPFStatic::m_ueStateMirror),
+                          MakeBooleanChecker());
+    return tid;
+}
+
+TypeId
+NrMacSchedulerTdmaQosStatic::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::NrMacSchedulerTdmaQosStatic")
+            .SetParent<NrMacSchedulerTdmaQos>()
+            .AddConstructor<NrMacSchedulerTdmaQosStatic>()
+            .AddAttribute("UeStateMirror",
+                          "Sort the UEs through a contiguous copy of the fields used to "
+                          "compare them, loaded once per sort",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&NrMacSchedulerTdmaQosStatic::m_ueStateMirror),
+                          MakeBooleanChecker());
+    return tid;
+}
+
+TypeId
+NrMacSchedulerOfdmaRRStatic::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::NrMacSchedulerOfdmaRRStatic")
+            .SetParent<NrMacSchedulerOfdmaRR>()
+            .AddConstructor<NrMacSchedulerOfdmaRRStatic>()
+            .AddAttribute("UeStateMirror",
+                          "Sort the UEs through a contiguous copy of the fields used to "
+                          "compare them, loaded once per sort",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&NrMacSchedulerOfdmaRRStatic::m_ueStateMirror),
+                          MakeBooleanChecker());
+    return tid;
+}
+
+TypeId
+NrMacSchedulerOfdmaMRStatic::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::NrMacSchedulerOfdmaMRStatic")
+            .SetParent<NrMacSchedulerOfdmaMR>()
+            .AddConstructor<NrMacSchedulerOfdmaMRStatic>()
+            .AddAttribute("UeStateMirror",
+                          "Sort the UEs through a contiguous copy of the fields used to "
+                          "compare them, loaded once per sort",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&NrMacSchedulerOfdmaMRStatic::m_ueStateMirror),
+                          MakeBooleanChecker());
+    return tid;
+}
+
+TypeId
+NrMacSchedulerOfdmaPFStatic::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::NrMacSchedulerOfdmaPFStatic")
+            .SetParent<NrMacSchedulerOfdmaPF>()
+            .AddConstructor<NrMacSchedulerOfdmaPFStatic>()
+            .AddAttribute("UeStateMirror",
+                          "Sort the UEs through a contiguous copy of the fields used to "
+                          "compare them, loaded once per sort",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&NrMacSchedulerOfdmaPFStatic::m_ueStateMirror),
+                          MakeBooleanChecker());
+    return tid;
+}
+
+TypeId
+NrMacSchedulerOfdmaQosStatic::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::NrMacSchedulerOfdmaQosStatic")
+            .SetParent<NrMacSchedulerOfdmaQos>()
+            .AddConstructor<NrMacSchedulerOfdmaQosStatic>()
+            .AddAttribute("UeStateMirror",
+                          "Sort the UEs through a contiguous copy of the fields used to "
+                          "compare them, loaded once per sort",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&NrMacSchedulerOfdmaQosStatic::m_ueStateMirror),
+                          MakeBooleanChecker());
+    return tid;
+}
+
+} // namespace ns3
@@ -0,0 +1,217 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include "nr-mac-scheduler-ofdma-mr.h"
+#include "nr-mac-scheduler-ofdma-pf.h"
+#include "nr-mac-scheduler-ofdma-qos.h"
+#include "nr-mac-scheduler-ofdma-rr.h"
+#include "nr-mac-scheduler-policy.h"
+#include "nr-mac-scheduler-tdma-mr.h"
+#include "nr-mac-scheduler-tdma-pf.h"
+#include "nr-mac-scheduler-tdma-qos.h"
+#include "nr-mac-scheduler-tdma-rr.h"
+#include "nr-mac-scheduler-ue-mirror.h"
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief A scheduler whose policy is resolved at compile time
+ *
+ * The access (TDMA or OFDMA) and the policy (RR, PF, ...) of a scheduler are
+ * composed through virtual methods: the loops that assign the resources, in
+ * NrMacSchedulerTdma and NrMacSchedulerOfdma, sort the UEs with the
+ * std::function returned by GetUeCompareDlFn(), and call AssignedDlResources()
+ * and NotAssignedDlResources() after each unit of resources is assigned. This
+ * class takes an existing scheduler (e.g., NrMacSchedulerOfdmaPF) and the
+ * corresponding policy of nr-mac-scheduler-policy.h (e.g.,
+ * NrMacSchedulerPolicyPF), and runs the same loops with the policy as a
+ * template parameter, so that the comparison function and the updates are
+ * inlined in the loops.
+ *
+ * Everything else, including the attributes and the UE representation, comes
+ * from the scheduler, and the decisions are the same, bit by bit. The policy
+ * must do what the virtual methods of the scheduler do: the class is meant only
+ * for the standard combinations, for which a TypeId is registered (e.g.,
+ * ns3::NrMacSchedulerOfdmaPFStatic). A scheduler that redefines the virtual
+ * methods has to derive from the dynamic classes.
+ *
+ * With the attribute UeStateMirror, the UEs are sorted through a
+ * NrMacSchedulerUeMirror, owned by the scheduler: the fields read by the
+ * comparison (and the PF or QoS metric) are loaded once per sort in contiguous
+ * arrays, instead of being read through the UE pointers at each comparison. The
+ * decisions do not change. The heap of the attribute IncrementalUeOrdering does
+ * not use the mirror.
+ */
+template <class Scheduler, class Policy>
+class NrMacSchedulerStatic : public Scheduler
+{
+  public:
+    /**
+     * \brief ~NrMacSchedulerStatic deconstructor
+     */
+    ~NrMacSchedulerStatic() override
+    {
+    }
+
+  protected:
+    NrMacSchedulerNs3::BeamSymbolMap AssignDLRBG(
+        uint32_t symAvail,
+        const NrMacSchedulerNs3::ActiveUeMap& activeDl) const override
+    {
+        return this->AssignDlRbgWith(symAvail, activeDl, GetPolicy());
+    }
+
+    NrMacSchedulerNs3::BeamSymbolMap AssignULRBG(
+        uint32_t symAvail,
+        const NrMacSchedulerNs3::ActiveUeMap& activeUl) const override
+    {
+        return this->AssignUlRbgWith(symAvail, activeUl, GetPolicy());
+    }
+
+  private:
+    /**
+     * \return the policy, with the current parameters of the scheduler
+     */
+    Policy GetPolicy() const
+    {
+        Policy policy(this->m_dlAmc, this->m_ulAmc, *this);
+        if (m_ueStateMirror)
+        {
+            policy.SetUeMirror(&m_ueMirror);
+        }
+        return policy;
+    }
+
+  protected:
+    bool m_ueStateMirror{false};               //!< Sort the UEs through m_ueMirror
+    mutable NrMacSchedulerUeMirror m_ueMirror; //!< Mirror of the UEs, reused at each sort
+};
+
+/**
+ * \ingroup scheduler
+ * \brief NrMacSchedulerTdmaRR with static dispatch of the policy
+ */
+class NrMacSchedulerTdmaRRStatic
+    : public NrMacSchedulerStatic<NrMacSchedulerTdmaRR, NrMacSchedulerPolicyRR>
+{
+  public:
+    /**
+     * \brief GetTypeId
+     * \return The TypeId of the class
+     */
+    static TypeId GetTypeId();
+};
+
+/**
+ * \ingroup scheduler
+ * \brief NrMacSchedulerTdmaMR with static dispatch of the policy
+ */
+class NrMacSchedulerTdmaMRStatic
+    : public NrMacSchedulerStatic<NrMacSchedulerTdmaMR, NrMacSchedulerPolicyMR>
+{
+  public:
+    /**
+     * \brief GetTypeId
+     * \return The TypeId of the class
+     */
+    static TypeId GetTypeId();
+};
+
+/**
+ * \ingroup scheduler
+ * \brief NrMacSchedulerTdmaPF with static dispatch of the policy
+ */
+class NrMacSchedulerTdmaPFStatic
+    : public NrMacSchedulerStatic<NrMacSchedulerTdmaPF, NrMacSchedulerPolicyPF>
+{
+  public:
+    /**
+     * \brief GetTypeId
+     * \return The TypeId of the class
+     */
+    static TypeId GetTypeId();
+};
+
+/**
+ * \ingroup scheduler
+ * \brief NrMacSchedulerTdmaQos with static dispatch of the policy
+ */
+class NrMacSchedulerTdmaQosStatic
+    : public NrMacSchedulerStatic<NrMacSchedulerTdmaQos, NrMacSchedulerPolicyQos>
+{
+  public:
+    /**
+     * \brief GetTypeId
+     * \return The TypeId of the class
+     */
+    static TypeId GetTypeId();
+};
+
+/**
+ * \ingroup scheduler
+ * \brief NrMacSchedulerOfdmaRR with static dispatch of the policy
+ */
+class NrMacSchedulerOfdmaRRStatic
+    : public NrMacSchedulerStatic<NrMacSchedulerOfdmaRR, NrMacSchedulerPolicyRR>
+{
+  public:
+    /**
+     * \brief GetTypeId
+     * \return The TypeId of the class
+     */
+    static TypeId GetTypeId();
+};
+
+/**
+ * \ingroup scheduler
+ * \brief NrMacSchedulerOfdmaMR with static dispatch of the policy
+ */
+class NrMacSchedulerOfdmaMRStatic
+    : public NrMacSchedulerStatic<NrMacSchedulerOfdmaMR, NrMacSchedulerPolicyMR>
+{
+  public:
+    /**
+     * \brief GetTypeId
+     * \return The TypeId of the class
+     */
+    static TypeId GetTypeId();
+};
+
+/**
+ * \ingroup scheduler
+ * \brief NrMacSchedulerOfdmaPF with static dispatch of the policy
+ */
+class NrMacSchedulerOfdmaPFStatic
+    : public NrMacSchedulerStatic<NrMacSchedulerOfdmaPF, NrMacSchedulerPolicyPF>
+{
+  public:
+    /**
+     * \brief GetTypeId
+     * \return The TypeId of the class
+     */
+    static TypeId GetTypeId();
+};
+
+/**
+ * \ingroup scheduler
+ * \brief NrMacSchedulerOfdmaQos with static dispatch of the policy
+ */
+class NrMacSchedulerOfdmaQosStatic
+    : public NrMacSchedulerStatic<NrMacSchedulerOfdmaQos, NrMacSchedulerPolicyQos>
+{
+  public:
+    /**
+     * \brief GetTypeId
+     * \return The TypeId of the class
+     */
+    static TypeId GetTypeId();
+};
+
+} // namespace ns3
@@ -12,12 +12,15 @@
 
 #include "nr-mac-scheduler-tdma.h"
 
+#include "nr-mac-scheduler-policy.h"
 #include "nr-mac-scheduler-ue-info-pf.h"
 
+#include <ns3/boolean.h>
 #include <ns3/log.h>
 
 #include <algorithm>
 #include <functional>
+#include <unordered_set>
 
 namespace ns3
 {
@@ -28,7 +31,28 @@ NS_OBJECT_ENSURE_REGISTERED(NrMacSchedulerTdma);
 TypeId
 NrMacSchedulerTdma::GetTypeId()
 {
-    static TypeId tid = TypeId("ns3::NrMacSchedulerTdma").SetParent<NrMacSchedulerNs3>();
+    static TypeId tid =
+        TypeId("ns3::NrMacSchedulerTdma")
+            .SetParent<NrMacSchedulerNs3>()
+            .AddAttribute("IncrementalUeOrdering",
+                          "Keep the UEs in a heap while assigning the resources, re-positioning "
+                          "only the UEs whose metric changed after each assignment, instead of "
+                          "sorting all of them every time. It assumes that notifying a UE that "
+                          "it did not get resources is a no-op when its state did not change. "
+                          "UEs with the same priority are ordered by their position in the list "
+                          "of active UEs",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&NrMacSchedulerTdma::m_incrementalUeOrdering),
+                          MakeBooleanChecker())
+            .AddAttribute("WasteFreeAssignment",
+                          "When a UE gets resources for the first time in a slot, give it at "
+                          "once the resources it needs for a TB that carries data, or skip it "
+                          "if the remaining resources are not enough, instead of assigning it "
+                          "resources for which no DCI can be created. Not compatible with "
+                          "IncrementalUeOrdering",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&NrMacSchedulerTdma::m_wasteFreeAssignment),
+                          MakeBooleanChecker());
     return tid;
 }
 
@@ -57,19 +81,228 @@ NrMacSchedulerTdma::GetUeVectorFromActiveUeMap(const NrMacSchedulerNs3::ActiveUe
     return ueVector;
 }
 
+namespace
+{
+
+/**
+ * \brief The DL side of a policy, with the getters of the DL resources of a UE
+ *
+ * It is the interface that NrMacSchedulerTdma::AssignRBGTDMA expects.
+ */
+template <class Policy>
+class DlHooks
+{
+  public:
+    /**
+     * \brief DlHooks constructor
+     * \param policy the policy
+     */
+    DlHooks(const Policy& policy)
+        : m_policy(policy)
+    {
+    }
+
+    /**
+     * \return the comparison function
+     */
+    auto GetCompare() const
+    {
+        return m_policy.GetCompareDl();
+    }
+
+    /**
+     * \brief Sort the UEs
+     * \param ues the UEs
+     */
+    void Sort(std::vector<NrMacSchedulerNs3::UePtrAndBufferReq>* ues) const
+    {
+        m_policy.SortDl(ues);
+    }
+
+    /**
+     * \brief Prepare a UE for the scheduling
+     * \param ue the UE
+     * \param assignable the resources assignable in an iteration
+     */
+    void Before(const NrMacSchedulerNs3::UePtrAndBufferReq& ue,
+                const NrMacSchedulerNs3::FTResources& assignable) const
+    {
+        m_policy.BeforeDl(ue, assignable);
+    }
+
+    /**
+     * \brief Notify the UE that got the resources
+     * \param ue the UE
+     * \param assigned the resources assigned
+     * \param totAssigned the resources assigned in the slot
+     */
+    void Assigned(const NrMacSchedulerNs3::UePtrAndBufferReq& ue,
+                  const NrMacSchedulerNs3::FTResources& assigned,
+                  const NrMacSchedulerNs3::FTResources& totAssigned) const
+    {
+        m_policy.AssignedDl(ue, assigned, totAssigned);
+    }
+
+    /**
+     * \brief Notify a UE that did not get the resources
+     * \param ue the UE
+     * \param notAssigned the resources not assigned
+     * \param totAssigned the resources assigned in the slot
+     */
+    void NotAssigned(const NrMacSchedulerNs3::UePtrAndBufferReq& ue,
+                     const NrMacSchedulerNs3::FTResources& notAssigned,
+                     const NrMacSchedulerNs3::FTResources& totAssigned) const
+    {
+        m_policy.NotAssignedDl(ue, notAssigned, totAssigned);
+    }
+
+    /**
+     * \param ue the UE
+     * \return the DL TBS of the UE
+     */
+    static uint32_t GetTbs(const UePtr& ue)
+    {
+        return NrMacSchedulerUeInfo::GetDlTBS(ue);
+    }
+
+    /**
+     * \param ue the UE
+     * \return a reference to the DL RBG of the UE
+     */
+    static uint32_t& GetRbg(const UePtr& ue)
+    {
+        return NrMacSchedulerUeInfo::GetDlRBG(ue);
+    }
+
+    /**
+     * \param ue the UE
+     * \return a reference to the DL symbols of the UE
+     */
+    static uint8_t& GetSym(const UePtr& ue)
+    {
+        return NrMacSchedulerUeInfo::GetDlSym(ue);
+    }
+
+  private:
+    const Policy& m_policy; //!< The policy
+};
+
+/**
+ * \brief The UL side of a policy, with the getters of the UL resources of a UE
+ *
+ * It is the interface that NrMacSchedulerTdma::AssignRBGTDMA expects.
+ */
+template <class Policy>
+class UlHooks
+{
+  public:
+    /**
+     * \brief UlHooks constructor
+     * \param policy the policy
+     */
+    UlHooks(const Policy& policy)
+        : m_policy(policy)
+    {
+    }
+
+    /**
+     * \return the comparison function
+     */
+    auto GetCompare() const
+    {
+        return m_policy.GetCompareUl();
+    }
+
+    /**
+     * \brief Sort the UEs
+     * \param ues the UEs
+     */
+    void Sort(std::vector<NrMacSchedulerNs3::UePtrAndBufferReq>* ues) const
+    {
+        m_policy.SortUl(ues);
+    }
+
+    /**
+     * \brief Prepare a UE for the scheduling
+     * \param ue the UE
+     * \param assignable the resources assignable in an iteration
+     */
+    void Before(const NrMacSchedulerNs3::UePtrAndBufferReq& ue,
+                const NrMacSchedulerNs3::FTResources& assignable) const
+    {
+        m_policy.BeforeUl(ue, assignable);
+    }
+
+    /**
+     * \brief Notify the UE that got the resources
+     * \param ue the UE
+     * \param assigned the resources assigned
+     * \param totAssigned the resources assigned in the slot
+     */
+    void Assigned(const NrMacSchedulerNs3::UePtrAndBufferReq& ue,
+                  const NrMacSchedulerNs3::FTResources& assigned,
+                  const NrMacSchedulerNs3::FTResources& totAssigned) const
+    {
+        m_policy.AssignedUl(ue, assigned, totAssigned);
+    }
+
+    /**
+     * \brief Notify a UE that did not get the resources
+     * \param ue the UE
+     * \param notAssigned the resources not assigned
+     * \param totAssigned the resources assigned in the slot
+     */
+    void NotAssigned(const NrMacSchedulerNs3::UePtrAndBufferReq& ue,
+                     const NrMacSchedulerNs3::FTResources& notAssigned,
+                     const NrMacSchedulerNs3::FTResources& totAssigned) const
+    {
+        m_policy.NotAssignedUl(ue, notAssigned, totAssigned);
+    }
+
+    /**
+     * \param ue the UE
+     * \return the UL TBS of the UE
+     */
+    static uint32_t GetTbs(const UePtr& ue)
+    {
+        return NrMacSchedulerUeInfo::GetUlTBS(ue);
+    }
+
+    /**
+     * \param ue the UE
+     * \return a reference to the UL RBG of the UE
+     */
+    static uint32_t& GetRbg(const UePtr& ue)
+    {
+        return NrMacSchedulerUeInfo::GetUlRBG(ue);
+    }
+
+    /**
+     * \param ue the UE
+     * \return a reference to the UL symbols of the UE
+     */
+    static uint8_t& GetSym(const UePtr& ue)
+    {
+        return NrMacSchedulerUeInfo::GetUlSym(ue);
+    }
+
+  private:
+    const Policy& m_policy; //!< The policy
+};
+
+} // namespace
+
 /**
  * \brief Assign the available RBG in a TDMA fashion
  * \param symAvail Number of available symbols
  * \param activeUe active flows and UE
  * \param type String representing the type of allocation currently in act (DL or UL)
- * \param BeforeSchedFn Function to call before any scheduling is started
- * \param GetCompareFn Function to call to compare UEs during assignment
- * \param GetTBSFn Function to call to get a reference of the UL or DL TBS
- * \param GetRBGFn Function to call to get a reference of the UL or DL RBG
- * \param GetSymFn Function to call to get a reference of the UL or DL symbols
- * \param SuccessfullAssignmentFn Function to call one time for the UE that got the resources
- * assigned in one iteration \param UnSuccessfullAssignmentFn Function to call for the UEs that did
- * not get anything in one iteration
+ * \param hooks The policy bound to the direction (DlHooks or UlHooks): hooks.Before() is
+ * called before any scheduling is started, hooks.Sort() sorts the UEs during assignment
+ * (hooks.GetCompare() gives the function to compare them in a heap), hooks.GetTbs(),
+ * hooks.GetRbg(), and hooks.GetSym() give the UL or DL TBS, RBG and symbols of a UE,
+ * hooks.Assigned() is called one time for the UE that got the resources assigned in one
+ * iteration, and hooks.NotAssigned() for the UEs that did not get anything in one iteration
  *
  * \return a map between the beam and the symbols assigned to each one
  *
@@ -77,15 +310,15 @@ NrMacSchedulerTdma::GetUeVectorFromActiveUeMap(const NrMacSchedulerNs3::ActiveUe
  * pseudocode is the following:
  * <pre>
  * for (ue : activeUe):
- *    BeforeSchedFn (ue);
+ *    hooks.Before (ue);
  *
  * while symbols > 0:
  *    sort (ueVector);
- *    GetRBGFn(ueVector.first()) += BandwidthInRBG();
+ *    hooks.GetRbg(ueVector.first()) += BandwidthInRBG();
  *    symbols--;
- *    SuccessfullAssignmentFn (ueVector.first());
+ *    hooks.Assigned (ueVector.first());
  *    for each ue that did not get anything assigned:
- *        UnSuccessfullAssignmentFn (ue);
+ *        hooks.NotAssigned (ue);
  * </pre>
  *
  * To sort the UEs, the method uses the function returned by GetUeCompareDlFn().
@@ -97,24 +330,18 @@ NrMacSchedulerTdma::GetUeVectorFromActiveUeMap(const NrMacSchedulerNs3::ActiveUe
  * The distribution of each symbol is called 'iteration' in other part of the
  * class documentation.
  *
- * The function, thanks to the callback parameters, can be adapted to do
- * a UL or DL allocation. Please make sure the callbacks return references
- * (or no effects will be seen on the caller).
+ * The function, thanks to the hooks, can be adapted to do a UL or DL
+ * allocation, with any policy. Please make sure the getters of RBG and symbols
+ * return references (or no effects will be seen on the caller).
  *
  * \see BeforeDlSched
  */
+template <class Hooks>
 NrMacSchedulerTdma::BeamSymbolMap
-NrMacSchedulerTdma::AssignRBGTDMA(
-    uint32_t symAvail,
-    const ActiveUeMap& activeUe,
-    const std::string& type,
-    const BeforeSchedFn& BeforeSchedFn,
-    const GetCompareUeFn& GetCompareFn,
-    const GetTBSFn& GetTBSFn,
-    const GetRBGFn& GetRBGFn,
-    const GetSymFn& GetSymFn,
-    const AfterSuccessfullAssignmentFn& SuccessfullAssignmentFn,
-    const AfterUnsucessfullAssignmentFn& UnSuccessfullAssignmentFn) const
+NrMacSchedulerTdma::AssignRBGTDMA(uint32_t symAvail,
+                                  const ActiveUeMap& activeUe,
+                                  const std::string& type,
+                                  const Hooks& hooks) const
 {
     NS_LOG_FUNCTION(this);
     NS_LOG_DEBUG("Assigning RBG in " << type << ", # beams active flows: " << activeUe.size()
@@ -133,9 +360,57 @@ NrMacSchedulerTdma::AssignRBGTDMA(
     uint32_t numOfAssignableRbgs = GetBandwidthInRbg() - zeroes;
     NS_ASSERT(numOfAssignableRbgs > 0);
 
+    NS_ABORT_MSG_IF(m_wasteFreeAssignment && m_incrementalUeOrdering,
+                    "WasteFreeAssignment is not compatible with IncrementalUeOrdering");
+    // UEs for which the remaining symbols are not enough for a TB with data
+    std::unordered_set<uint16_t> skipped;
+
     for (auto& ue : ueVector)
     {
-        BeforeSchedFn(ue, FTResources(numOfAssignableRbgs, 1));
+        hooks.Before(ue, FTResources(numOfAssignableRbgs, 1));
+    }
+
+    if (m_incrementalUeOrdering)
+    {
+        GetFirst GetUe;
+        auto isSatisfied = [&](const UePtrAndBufferReq& ue) {
+            if (hooks.GetTbs(GetUe(ue)) < std::max(ue.second, 10U))
+            {
+                return false;
+            }
+            if (type == "DL")
+            {
+                TrimUnneededDlStreams(GetUe(ue), ue.second);
+            }
+            NS_LOG_INFO("UE " << GetUe(ue)->m_rnti << " TBS " << hooks.GetTbs(GetUe(ue))
+                              << " queue " << ue.second << ", passing");
+            return true;
+        };
+        auto assign = [&](const UePtrAndBufferReq& ue) {
+            hooks.GetRbg(GetUe(ue)) += numOfAssignableRbgs;
+            assigned.m_rbg += numOfAssignableRbgs;
+            hooks.GetSym(GetUe(ue)) += 1;
+            assigned.m_sym += 1;
+            NS_LOG_DEBUG("Assigned " << numOfAssignableRbgs << " " << type
+                                     << " RBG (= 1 SYM) to UE " << GetUe(ue)->m_rnti
+                                     << " total assigned up to now: " << hooks.GetRbg(GetUe(ue))
+                                     << " that corresponds to " << assigned.m_rbg);
+            hooks.Assigned(ue, FTResources(numOfAssignableRbgs, 1), assigned);
+        };
+        auto notAssign = [&](const UePtrAndBufferReq& ue) {
+            hooks.NotAssigned(ue, FTResources(numOfAssignableRbgs, 1), assigned);
+        };
+
+        // The total of assigned symbols grows at each assignment, and it is
+        // used by the metrics of the UEs that already got some symbols
+        AssignIncrementally(&ueVector,
+                            resources,
+                            hooks.GetCompare(),
+                            isSatisfied,
+                            assign,
+                            notAssign,
+                            true);
+        resources = 0;
     }
 
     while (resources > 0)
@@ -144,76 +419,31 @@ NrMacSchedulerTdma::AssignRBGTDMA(
 
         auto schedInfoIt = ueVector.begin();
 
-        std::sort(ueVector.begin(), ueVector.end(), GetCompareFn());
+        hooks.Sort(&ueVector);
 
         // Ensure fairness: pass over UEs which already has enough resources to transmit
         while (schedInfoIt != ueVector.end())
         {
             uint32_t bufQueueSize = schedInfoIt->second;
 
-            if (GetTBSFn(GetUe(*schedInfoIt)) >= std::max(bufQueueSize, 10U))
+            if (hooks.GetTbs(GetUe(*schedInfoIt)) >= std::max(bufQueueSize, 10U))
             {
-                if (GetUe(*schedInfoIt)->m_dlTbSize.size() > 1 && type == "DL")
+                if (type == "DL")
                 {
-                    // This "if" is purely for DL MIMO. In MIMO, for example, if the
-                    // first TB size is big enough to empty the buffer then we
-                    // should not allocate anything to the second stream. In this
-                    // case, if we allocate bytes to the second stream, the UE
-                    // would expect the TB but the gNB would not be able to transmit
-                    // it. This would break HARQ TX state machine at UE PHY.
-
                     // I am not generalizing the code here because MIMO is implemented
                     // only for DL; therefore, m_dlTbSize is a vector. On the other
-                    // hand, in uplink m_ulTbSize is an integer. When UL MIMO is implemented
-                    // we can do the following two things to generalize this code.
-                    // 1. GetUe (*schedInfoIt)->m_dlTbSize.size () > 1
-                    // above is used to check if the UE have more than one stream.
-                    // When the UL MIMO is implemented maybe we can implement
-                    // a method in UeInfo for DL and UL to return the number of
-                    // streams. Here we can call those specific methods
-                    // by looking at the type.
-                    // 2. Initialize the m_dlTbSize.begin and m_dlTbSize.end iterators before
-                    // "if (GetTBSFn (GetUe (*schedInfoIt)) >= std::max (bufQueueSize, 7U))"
-                    // by checking the "type".
-
-                    uint8_t streamCounter = 0;
-                    uint32_t copyBufQueueSize = bufQueueSize;
-                    auto dlTbSizeIt = GetUe(*schedInfoIt)->m_dlTbSize.begin();
-                    while (dlTbSizeIt != GetUe(*schedInfoIt)->m_dlTbSize.end())
-                    {
-                        if (copyBufQueueSize != 0)
-                        {
-                            NS_LOG_DEBUG("Stream " << +streamCounter << " with TB size "
-                                                   << *dlTbSizeIt << " needed to TX MIMO TB");
-                            if (*dlTbSizeIt >= copyBufQueueSize)
-                            {
-                                copyBufQueueSize = 0;
-                            }
-                            else
-                            {
-                                copyBufQueueSize = copyBufQueueSize - *dlTbSizeIt;
-                            }
-                            streamCounter++;
-                            dlTbSizeIt++;
-                        }
-                        else
-                        {
-                            // if we are here, that means previously iterated
-                            // streams were enough to empty the buffer. We do
-                            // not need this stream. Make its TB size zero.
-                            NS_LOG_DEBUG("Stream " << +streamCounter << " with TB size "
-                                                   << *dlTbSizeIt << " not needed to TX MIMO TB");
-                            *dlTbSizeIt = 0;
-                            streamCounter++;
-                            dlTbSizeIt++;
-                        }
-                    }
+                    // hand, in uplink m_ulTbSize is an integer.
+                    TrimUnneededDlStreams(GetUe(*schedInfoIt), bufQueueSize);
                 }
                 NS_LOG_INFO("UE " << GetUe(*schedInfoIt)->m_rnti << " TBS "
-                                  << GetTBSFn(GetUe(*schedInfoIt)) << " queue " << bufQueueSize
+                                  << hooks.GetTbs(GetUe(*schedInfoIt)) << " queue " << bufQueueSize
                                   << ", passing");
                 schedInfoIt++;
             }
+            else if (!skipped.empty() && skipped.count(GetUe(*schedInfoIt)->m_rnti) > 0)
+            {
+                schedInfoIt++;
+            }
             else
             {
                 break;
@@ -228,30 +458,51 @@ NrMacSchedulerTdma::AssignRBGTDMA(
             break;
         }
 
+        // A UE without symbols gets at once the symbols it needs for a TB with
+        // data, or none if there are not enough of them (WasteFreeAssignment)
+        uint32_t units = 1;
+        if (m_wasteFreeAssignment && hooks.GetSym(GetUe(*schedInfoIt)) == 0)
+        {
+            units = type == "DL" ? GetDlUnitsForMinTbSize(GetUe(*schedInfoIt),
+                                                          numOfAssignableRbgs,
+                                                          resources)
+                                 : GetUlUnitsForMinTbSize(GetUe(*schedInfoIt),
+                                                          numOfAssignableRbgs,
+                                                          resources);
+            if (units == 0)
+            {
+                NS_LOG_INFO("UE " << GetUe(*schedInfoIt)->m_rnti << " needs more than " << resources
+                                  << " " << type << " SYM for a TB, skipping it");
+                skipped.insert(GetUe(*schedInfoIt)->m_rnti);
+                continue;
+            }
+        }
+
         // Assign 1 entire symbol (full RBG) to the selected UE and to the total
         // resources assigned count
-        GetRBGFn(GetUe(*schedInfoIt)) += numOfAssignableRbgs;
-        assigned.m_rbg += numOfAssignableRbgs;
+        hooks.GetRbg(GetUe(*schedInfoIt)) += numOfAssignableRbgs * units;
+        assigned.m_rbg += numOfAssignableRbgs * units;
 
-        GetSymFn(GetUe(*schedInfoIt)) += 1;
-        assigned.m_sym += 1;
+        hooks.GetSym(GetUe(*schedInfoIt)) += units;
+        assigned.m_sym += units;
 
         // substract 1 SYM from the number of sym available for the while loop
-        resources -= 1;
+        resources -= units;
 
         // Update metrics for the successfull UE
-        NS_LOG_DEBUG("Assigned " << numOfAssignableRbgs << " " << type << " RBG (= 1 SYM) to UE "
-                                 << GetUe(*schedInfoIt)->m_rnti
-                                 << " total assigned up to now: " << GetRBGFn(GetUe(*schedInfoIt))
-                                 << " that corresponds to " << assigned.m_rbg);
-        SuccessfullAssignmentFn(*schedInfoIt, FTResources(numOfAssignableRbgs, 1), assigned);
+        NS_LOG_DEBUG("Assigned " << numOfAssignableRbgs * units << " " << type << " RBG (= "
+                                 << units << " SYM) to UE " << GetUe(*schedInfoIt)->m_rnti
+                                 << " total assigned up to now: "
+                                 << hooks.GetRbg(GetUe(*schedInfoIt)) << " that corresponds to "
+                                 << assigned.m_rbg);
+        hooks.Assigned(*schedInfoIt, FTResources(numOfAssignableRbgs * units, units), assigned);
 
         // Update metrics for the unsuccessfull UEs (who did not get any resource in this iteration)
         for (auto& ue : ueVector)
         {
             if (GetUe(ue)->m_rnti != GetUe(*schedInfoIt)->m_rnti)
             {
-                UnSuccessfullAssignmentFn(ue, FTResources(numOfAssignableRbgs, 1), assigned);
+                hooks.NotAssigned(ue, FTResources(numOfAssignableRbgs * units, units), assigned);
             }
         }
     }
@@ -263,101 +514,251 @@ NrMacSchedulerTdma::AssignRBGTDMA(
         uint32_t symOfBeam = 0;
         for (const auto& ue : el.second)
         {
-            symOfBeam += GetRBGFn(ue.first) / numOfAssignableRbgs;
+            symOfBeam += hooks.GetRbg(ue.first) / numOfAssignableRbgs;
         }
         ret.insert(std::make_pair(el.first, symOfBeam));
     }
     return ret;
 }
 
+void
+NrMacSchedulerTdma::TrimUnneededDlStreams(const UePtr& ue, uint32_t bufQueueSize) const
+{
+    if (ue->m_dlTbSize.size() <= 1)
+    {
+        return;
+    }
+
+    uint8_t streamCounter = 0;
+    uint32_t copyBufQueueSize = bufQueueSize;
+    for (auto& dlTbSize : ue->m_dlTbSize)
+    {
+        if (copyBufQueueSize != 0)
+        {
+            NS_LOG_DEBUG("Stream " << +streamCounter << " with TB size " << dlTbSize
+                                   << " needed to TX MIMO TB");
+            if (dlTbSize >= copyBufQueueSize)
+            {
+                copyBufQueueSize = 0;
+            }
+            else
+            {
+                copyBufQueueSize = copyBufQueueSize - dlTbSize;
+            }
+        }
+        else
+        {
+            // if we are here, that means previously iterated
+            // streams were enough to empty the buffer. We do
+            // not need this stream. Make its TB size zero.
+            NS_LOG_DEBUG("Stream " << +streamCounter << " with TB size " << dlTbSize
+                                   << " not needed to TX MIMO TB");
+            dlTbSize = 0;
+        }
+        streamCounter++;
+    }
+}
+
+uint32_t
+NrMacSchedulerTdma::GetDlUnitsForMinTbSize(const UePtr& ue,
+                                           uint32_t rbgPerUnit,
+                                           uint32_t maxUnits) const
+{
+    NS_LOG_FUNCTION(this << ue->m_rnti << rbgPerUnit << maxUnits);
+    NS_ASSERT(ue->m_dlRBG == 0);
+
+    // The TB of each stream depends on the rank and on the MCS of the UE:
+    // UpdateDlMetric() is tried with more and more RBG, and then restored
+    uint32_t units = 0;
+    for (uint32_t tried = 1; tried <= maxUnits && units == 0; ++tried)
+    {
+        ue->m_dlRBG = tried * rbgPerUnit;
+        ue->UpdateDlMetric(m_dlAmc);
+        for (const auto& tbs : ue->m_dlTbSize)
+        {
+            if (tbs >= MIN_DL_TB_SIZE)
+            {
+                units = tried;
+            }
+        }
+    }
+    ue->m_dlRBG = 0;
+    ue->UpdateDlMetric(m_dlAmc);
+
+    return units;
+}
+
+uint32_t
+NrMacSchedulerTdma::GetUlUnitsForMinTbSize(const UePtr& ue,
+                                           uint32_t rbgPerUnit,
+                                           uint32_t maxUnits) const
+{
+    NS_LOG_FUNCTION(this << ue->m_rnti << rbgPerUnit << maxUnits);
+    NS_ASSERT(ue->m_ulRBG == 0);
+
+    for (uint32_t units = 1; units <= maxUnits; ++units)
+    {
+        if (m_ulAmc->CalculateTbSize(ue->m_ulMcs, units * rbgPerUnit * GetNumRbPerRbg()) >=
+            MIN_UL_TB_SIZE)
+        {
+            return units;
+        }
+    }
+    return 0;
+}
+
+template <class Compare>
+void
+NrMacSchedulerTdma::AssignIncrementally(std::vector<UePtrAndBufferReq>* ueVector,
+                                        uint32_t resources,
+                                        const Compare& compare,
+                                        const IsSatisfiedFn& IsSatisfied,
+                                        const AssignmentFn& Assign,
+                                        const AssignmentFn& NotAssign,
+                                        bool totalChangesMetric) const
+{
+    NS_LOG_FUNCTION(this);
+
+    NrMacSchedulerUeHeapT<Compare> heap(*ueVector, compare);
+    heap.Build();
+
+    std::vector<std::size_t> satisfied; // UEs removed from the heap
+    std::vector<std::size_t> served;    // UEs that got at least one unit
+    std::vector<bool> isServed(ueVector->size(), false);
+    bool firstAssignment = true;
+    std::size_t lastWinner = 0;
+
+    while (resources > 0)
+    {
+        // Ensure fairness: pass over UEs which already has enough resources to transmit.
+        // A UE that has enough resources never asks for more, so it leaves the heap.
+        while (!heap.IsEmpty() && IsSatisfied(ueVector->at(heap.Top())))
+        {
+            satisfied.push_back(heap.Top());
+            heap.Pop();
+        }
+
+        // In the case that all the UE already have their requirements fullfilled,
+        // then stop the assignment
+        if (heap.IsEmpty())
+        {
+            NS_LOG_INFO("All the UE already have their resources allocated");
+            // As when sorting, the last check passes over all the UEs
+            for (const auto& idx : satisfied)
+            {
+                IsSatisfied(ueVector->at(idx));
+            }
+            break;
+        }
+
+        std::size_t winner = heap.Top();
+        Assign(ueVector->at(winner));
+        resources -= 1;
+
+        if (firstAssignment)
+        {
+            // Every UE gets notified once, and then the order is rebuilt in O(n)
+            for (std::size_t i = 0; i < ueVector->size(); ++i)
+            {
+                if (i != winner)
+                {
+                    NotAssign(ueVector->at(i));
+                }
+            }
+            heap.Rebuild();
+            firstAssignment = false;
+        }
+        else
+        {
+            // Notify only the UEs whose state changed since their last notification:
+            // the previous winner or, if the metric depends on the total, all the
+            // UEs that got resources
+            auto notify = [&](std::size_t idx) {
+                if (idx != winner)
+                {
+                    NotAssign(ueVector->at(idx));
+                    heap.Update(idx);
+                }
+            };
+            if (totalChangesMetric)
+            {
+                for (const auto& idx : served)
+                {
+                    notify(idx);
+                }
+            }
+            else
+            {
+                notify(lastWinner);
+            }
+        }
+
+        heap.Update(winner);
+        if (!isServed[winner])
+        {
+            isServed[winner] = true;
+            served.push_back(winner);
+        }
+        lastWinner = winner;
+    }
+}
+
 /**
  * \brief Assign the available DL RBG to the UEs
  * \param symAvail Number of available symbols
  * \param activeDl active DL flows and UE
  * \return a map between the beam and the symbols assigned to each one
  *
- * The function will prepare all the needed callbacks to return UE DL parameters
- * (e.g., the DL TBS, the DL RBG) and then will call NrMacSchedulerTdma::AssignRBGTDMA.
+ * The function calls AssignDlRbgWith() with the virtual methods of the scheduler
+ * as policy.
  */
 NrMacSchedulerTdma::BeamSymbolMap
 NrMacSchedulerTdma::AssignDLRBG(uint32_t symAvail, const ActiveUeMap& activeDl) const
 {
     NS_LOG_FUNCTION(this);
-
-    BeforeSchedFn beforeSched = std::bind(&NrMacSchedulerTdma::BeforeDlSched,
-                                          this,
-                                          std::placeholders::_1,
-                                          std::placeholders::_2);
-    AfterSuccessfullAssignmentFn SuccFn = std::bind(&NrMacSchedulerTdma::AssignedDlResources,
-                                                    this,
-                                                    std::placeholders::_1,
-                                                    std::placeholders::_2,
-                                                    std::placeholders::_3);
-    AfterUnsucessfullAssignmentFn UnSuccFn = std::bind(&NrMacSchedulerTdma::NotAssignedDlResources,
-                                                       this,
-                                                       std::placeholders::_1,
-                                                       std::placeholders::_2,
-                                                       std::placeholders::_3);
-    GetCompareUeFn compareFn = std::bind(&NrMacSchedulerTdma::GetUeCompareDlFn, this);
-
-    GetTBSFn GetTbs = &NrMacSchedulerUeInfo::GetDlTBS;
-    GetRBGFn GetRBG = &NrMacSchedulerUeInfo::GetDlRBG;
-    GetSymFn GetSym = &NrMacSchedulerUeInfo::GetDlSym;
-
-    return AssignRBGTDMA(symAvail,
-                         activeDl,
-                         "DL",
-                         beforeSched,
-                         compareFn,
-                         GetTbs,
-                         GetRBG,
-                         GetSym,
-                         SuccFn,
-                         UnSuccFn);
+    return AssignDlRbgWith(symAvail, activeDl, VirtualPolicy(this));
 }
 
 /**
  * \brief Assign the available UL RBG to the UEs
  * \param symAvail Number of available symbols
- * \param activeUl active DL flows and UE
+ * \param activeUl active UL flows and UE
  * \return a map between the beam and the symbols assigned to each one
  *
- * The function will prepare all the needed callbacks to return UE UL parameters
- * (e.g., the UL TBS, the UL RBG) and then will call NrMacSchedulerTdma::AssignRBGTDMA.
+ * The function calls AssignUlRbgWith() with the virtual methods of the scheduler
+ * as policy.
  */
 NrMacSchedulerTdma::BeamSymbolMap
 NrMacSchedulerTdma::AssignULRBG(uint32_t symAvail, const ActiveUeMap& activeUl) const
 {
     NS_LOG_FUNCTION(this);
-    BeforeSchedFn beforeSched = std::bind(&NrMacSchedulerTdma::BeforeUlSched,
-                                          this,
-                                          std::placeholders::_1,
-                                          std::placeholders::_2);
-    AfterSuccessfullAssignmentFn SuccFn = std::bind(&NrMacSchedulerTdma::AssignedUlResources,
-                                                    this,
-                                                    std::placeholders::_1,
-                                                    std::placeholders::_2,
-                                                    std::placeholders::_3);
-    GetCompareUeFn compareFn = std::bind(&NrMacSchedulerTdma::GetUeCompareUlFn, this);
-    AfterUnsucessfullAssignmentFn UnSuccFn = std::bind(&NrMacSchedulerTdma::NotAssignedUlResources,
-                                                       this,
-                                                       std::placeholders::_1,
-                                                       std::placeholders::_2,
-                                                       std::placeholders::_3);
-    GetTBSFn GetTbs = &NrMacSchedulerUeInfo::GetUlTBS;
-    GetRBGFn GetRBG = &NrMacSchedulerUeInfo::GetUlRBG;
-    GetSymFn GetSym = &NrMacSchedulerUeInfo::GetUlSym;
-
-    return AssignRBGTDMA(symAvail,
-                         activeUl,
-                         "UL",
-                         beforeSched,
-                         compareFn,
-                         GetTbs,
-                         GetRBG,
-                         GetSym,
-                         SuccFn,
-                         UnSuccFn);
+    return AssignUlRbgWith(symAvail, activeUl, VirtualPolicy(this));
+}
+
+/**
+ * The function binds the policy to the DL parameters of the UEs (e.g., the
+ * DL TBS, the DL RBG) and then calls NrMacSchedulerTdma::AssignRBGTDMA.
+ */
+template <class Policy>
+NrMacSchedulerTdma::BeamSymbolMap
+NrMacSchedulerTdma::AssignDlRbgWith(uint32_t symAvail,
+                                    const ActiveUeMap& activeDl,
+                                    const Policy& policy) const
+{
+    return AssignRBGTDMA(symAvail, activeDl, "DL", DlHooks<Policy>(policy));
+}
+
+/**
+ * The function binds the policy to the UL parameters of the UEs (e.g., the
+ * UL TBS, the UL RBG) and then calls NrMacSchedulerTdma::AssignRBGTDMA.
+ */
+template <class Policy>
+NrMacSchedulerTdma::BeamSymbolMap
+NrMacSchedulerTdma::AssignUlRbgWith(uint32_t symAvail,
+                                    const ActiveUeMap& activeUl,
+                                    const Policy& policy) const
+{
+    return AssignRBGTDMA(symAvail, activeUl, "UL", UlHooks<Policy>(policy));
 }
 
 /**
@@ -392,7 +793,7 @@ NrMacSchedulerTdma::CreateDlDci(PointInFTPlane* spoint,
     for (uint32_t numTb = 0; numTb < ueInfo->m_dlTbSize.size(); numTb++)
     {
         tbs = ueInfo->m_dlTbSize.at(numTb);
-        if (tbs < 10)
+        if (tbs < MIN_DL_TB_SIZE)
         {
             countLessThanMinBytes++;
             NS_LOG_DEBUG("While creating DL DCI for UE "
@@ -426,7 +827,7 @@ NrMacSchedulerTdma::CreateDlDci(PointInFTPlane* spoint,
                          ueInfo,
                          ueInfo->m_dlTbSize,
                          DciInfoElementTdma::DL,
-                         ueInfo->m_dlMcs,
+                         ueInfo->GetDlTxMcs(),
                          ndi,
                          rv,
                          std::max(numSym, static_cast<uint8_t>(1)));
@@ -459,7 +860,7 @@ NrMacSchedulerTdma::CreateUlDci(NrMacSchedulerNs3::PointInFTPlane* spoint,
 
     // If is less than 12, 7 (3 mac header, 2 rlc header, 2 data) + SHORT_BSR (5),
     // then we can't transmit any new data, so don't create dci.
-    if (tbs < 12)
+    if (tbs < MIN_UL_TB_SIZE)
     {
         NS_LOG_DEBUG("While creating UL DCI for UE " << ueInfo->m_rnti << " assigned "
                                                      << ueInfo->m_ulRBG << " UL RBG, but TBS "
@@ -533,18 +934,17 @@ NrMacSchedulerTdma::CreateDci(NrMacSchedulerNs3::PointInFTPlane* spoint,
     NS_ASSERT(sumTbSize > 0);
     NS_ASSERT(numSym > 0);
 
-    std::shared_ptr<DciInfoElementTdma> dci =
-        std::make_shared<DciInfoElementTdma>(ueInfo->m_rnti,
-                                             fmt,
-                                             spoint->m_sym,
-                                             numSym,
-                                             mcs,
-                                             tbs,
-                                             ndi,
-                                             rv,
-                                             DciInfoElementTdma::DATA,
-                                             GetBwpId(),
-                                             GetTpc());
+    std::shared_ptr<DciInfoElementTdma> dci = GetDciPool().Create(ueInfo->m_rnti,
+                                                                  fmt,
+                                                                  spoint->m_sym,
+                                                                  numSym,
+                                                                  mcs,
+                                                                  tbs,
+                                                                  ndi,
+                                                                  rv,
+                                                                  DciInfoElementTdma::DATA,
+                                                                  GetBwpId(),
+                                                                  GetTpc());
 
     std::vector<uint8_t> rbgAssigned =
         fmt == DciInfoElementTdma::DL ? GetDlNotchedRbgMask() : GetUlNotchedRbgMask();
@@ -573,4 +973,46 @@ NrMacSchedulerTdma::CreateDci(NrMacSchedulerNs3::PointInFTPlane* spoint,
     return dci;
 }
 
+// The loops are defined in this file, so they are instantiated here for all the
+// policies that can use them: the virtual one, and the ones of
+// nr-mac-scheduler-policy.h (see NrMacSchedulerStatic). AssignIncrementally is
+// instantiated also for NrMacSchedulerOfdma.
+#define NR_MAC_SCHEDULER_TDMA_INSTANTIATE_LOOPS(Policy)                                          \
+    template NrMacSchedulerTdma::BeamSymbolMap NrMacSchedulerTdma::AssignDlRbgWith(               \
+        uint32_t,                                                                                  \
+        const ActiveUeMap&,                                                                        \
+        const Policy&) const;                                                                      \
+    template NrMacSchedulerTdma::BeamSymbolMap NrMacSchedulerTdma::AssignUlRbgWith(               \
+        uint32_t,                                                                                  \
+        const ActiveUeMap&,                                                                        \
+        const Policy&) const
+
+#define NR_MAC_SCHEDULER_TDMA_INSTANTIATE_INCREMENTAL(Compare)                                    \
+    template void NrMacSchedulerTdma::AssignIncrementally(std::vector<UePtrAndBufferReq>*,         \
+                                                          uint32_t,                                \
+                                                          const Compare&,                          \
+                                                          const IsSatisfiedFn&,                    \
+                                                          const AssignmentFn&,                     \
+                                                          const AssignmentFn&,                     \
+                                                          bool) const
+
+NR_MAC_SCHEDULER_TDMA_INSTANTIATE_LOOPS(NrMacSchedulerTdma::VirtualPolicy);
+NR_MAC_SCHEDULER_TDMA_INSTANTIATE_LOOPS(NrMacSchedulerPolicyRR);
+NR_MAC_SCHEDULER_TDMA_INSTANTIATE_LOOPS(NrMacSchedulerPolicyMR);
+NR_MAC_SCHEDULER_TDMA_INSTANTIATE_LOOPS(NrMacSchedulerPolicyPF);
+NR_MAC_SCHEDULER_TDMA_INSTANTIATE_LOOPS(NrMacSchedulerPolicyQos);
+
+NR_MAC_SCHEDULER_TDMA_INSTANTIATE_INCREMENTAL(NrMacSchedulerUeHeap::CompareUeFn);
+NR_MAC_SCHEDULER_TDMA_INSTANTIATE_INCREMENTAL(NrMacSchedulerPolicyRR::CompareDl);
+NR_MAC_SCHEDULER_TDMA_INSTANTIATE_INCREMENTAL(NrMacSchedulerPolicyRR::CompareUl);
+NR_MAC_SCHEDULER_TDMA_INSTANTIATE_INCREMENTAL(NrMacSchedulerPolicyMR::CompareDl);
+NR_MAC_SCHEDULER_TDMA_INSTANTIATE_INCREMENTAL(NrMacSchedulerPolicyMR::CompareUl);
+NR_MAC_SCHEDULER_TDMA_INSTANTIATE_INCREMENTAL(NrMacSchedulerPolicyPF::CompareDl);
+NR_MAC_SCHEDULER_TDMA_INSTANTIATE_INCREMENTAL(NrMacSchedulerPolicyPF::CompareUl);
+NR_MAC_SCHEDULER_TDMA_INSTANTIATE_INCREMENTAL(NrMacSchedulerPolicyQos::CompareDl);
+NR_MAC_SCHEDULER_TDMA_INSTANTIATE_INCREMENTAL(NrMacSchedulerPolicyQos::CompareUl);
+
+#undef NR_MAC_SCHEDULER_TDMA_INSTANTIATE_LOOPS
+#undef NR_MAC_SCHEDULER_TDMA_INSTANTIATE_INCREMENTAL
+
 } // namespace ns3
@@ -7,7 +7,9 @@
 #pragma once
 
 #include "nr-mac-scheduler-ns3.h"
+#include "nr-mac-scheduler-ue-heap.h"
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 
@@ -208,6 +210,250 @@ class NrMacSchedulerTdma : public NrMacSchedulerNs3
     virtual void BeforeUlSched(const UePtrAndBufferReq& ue,
                                const FTResources& assignableInIteration) const = 0;
 
+    /**
+     * \brief The policy of the scheduler, dispatched to its virtual methods
+     *
+     * The assignment loops are templates on the policy, which provides the
+     * comparison function of the UEs (GetCompareDl(), GetCompareUl()), the sort
+     * of the UEs (SortDl(), SortUl()), and what to do before the assignment
+     * (BeforeDl(), BeforeUl()) and after each unit of resources is assigned
+     * (AssignedDl(), AssignedUl()) or not (NotAssignedDl(), NotAssignedUl()).
+     * This policy calls the virtual methods
+     * of the scheduler, i.e., GetUeCompareDlFn(), BeforeDlSched(),
+     * AssignedDlResources(), and so on, so that any subclass can define its
+     * own; the policies in nr-mac-scheduler-policy.h are instead resolved at
+     * compile time, and used by NrMacSchedulerStatic.
+     */
+    class VirtualPolicy
+    {
+      public:
+        /**
+         * \brief VirtualPolicy constructor
+         * \param sched the scheduler
+         */
+        VirtualPolicy(const NrMacSchedulerTdma* sched)
+            : m_sched(sched)
+        {
+        }
+
+        /**
+         * \return the result of GetUeCompareDlFn()
+         */
+        NrMacSchedulerUeHeap::CompareUeFn GetCompareDl() const
+        {
+            return m_sched->GetUeCompareDlFn();
+        }
+
+        /**
+         * \return the result of GetUeCompareUlFn()
+         */
+        NrMacSchedulerUeHeap::CompareUeFn GetCompareUl() const
+        {
+            return m_sched->GetUeCompareUlFn();
+        }
+
+        /**
+         * \brief Sort the UEs with the result of GetUeCompareDlFn()
+         * \param ues the UEs
+         */
+        void SortDl(std::vector<UePtrAndBufferReq>* ues) const
+        {
+            std::sort(ues->begin(), ues->end(), GetCompareDl());
+        }
+
+        /**
+         * \brief Sort the UEs with the result of GetUeCompareUlFn()
+         * \param ues the UEs
+         */
+        void SortUl(std::vector<UePtrAndBufferReq>* ues) const
+        {
+            std::sort(ues->begin(), ues->end(), GetCompareUl());
+        }
+
+        /**
+         * \brief Call BeforeDlSched()
+         */
+        void BeforeDl(const UePtrAndBufferReq& ue, const FTResources& assignable) const
+        {
+            m_sched->BeforeDlSched(ue, assignable);
+        }
+
+        /**
+         * \brief Call BeforeUlSched()
+         */
+        void BeforeUl(const UePtrAndBufferReq& ue, const FTResources& assignable) const
+        {
+            m_sched->BeforeUlSched(ue, assignable);
+        }
+
+        /**
+         * \brief Call AssignedDlResources()
+         */
+        void AssignedDl(const UePtrAndBufferReq& ue,
+                        const FTResources& assigned,
+                        const FTResources& totAssigned) const
+        {
+            m_sched->AssignedDlResources(ue, assigned, totAssigned);
+        }
+
+        /**
+         * \brief Call AssignedUlResources()
+         */
+        void AssignedUl(const UePtrAndBufferReq& ue,
+                        const FTResources& assigned,
+                        const FTResources& totAssigned) const
+        {
+            m_sched->AssignedUlResources(ue, assigned, totAssigned);
+        }
+
+        /**
+         * \brief Call NotAssignedDlResources()
+         */
+        void NotAssignedDl(const UePtrAndBufferReq& ue,
+                           const FTResources& notAssigned,
+                           const FTResources& totAssigned) const
+        {
+            m_sched->NotAssignedDlResources(ue, notAssigned, totAssigned);
+        }
+
+        /**
+         * \brief Call NotAssignedUlResources()
+         */
+        void NotAssignedUl(const UePtrAndBufferReq& ue,
+                           const FTResources& notAssigned,
+                           const FTResources& totAssigned) const
+        {
+            m_sched->NotAssignedUlResources(ue, notAssigned, totAssigned);
+        }
+
+      private:
+        const NrMacSchedulerTdma* m_sched{nullptr}; //!< The scheduler
+    };
+
+    /**
+     * \brief Assign the available DL RBG to the UEs, with a policy
+     * \param symAvail Number of available symbols
+     * \param activeDl active DL flows and UE
+     * \param policy the policy (VirtualPolicy, or one of nr-mac-scheduler-policy.h)
+     * \return a map between the beam and the symbols assigned to each one
+     *
+     * AssignDLRBG() calls it with a VirtualPolicy. Being defined in the .cc file,
+     * it is instantiated only for VirtualPolicy and for the policies of
+     * nr-mac-scheduler-policy.h.
+     */
+    template <class Policy>
+    BeamSymbolMap AssignDlRbgWith(uint32_t symAvail,
+                                  const ActiveUeMap& activeDl,
+                                  const Policy& policy) const;
+
+    /**
+     * \brief Assign the available UL RBG to the UEs, with a policy
+     * \param symAvail Number of available symbols
+     * \param activeUl active UL flows and UE
+     * \param policy the policy (VirtualPolicy, or one of nr-mac-scheduler-policy.h)
+     * \return a map between the beam and the symbols assigned to each one
+     *
+     * AssignULRBG() calls it with a VirtualPolicy. Being defined in the .cc file,
+     * it is instantiated only for VirtualPolicy and for the policies of
+     * nr-mac-scheduler-policy.h.
+     */
+    template <class Policy>
+    BeamSymbolMap AssignUlRbgWith(uint32_t symAvail,
+                                  const ActiveUeMap& activeUl,
+                                  const Policy& policy) const;
+
+    /**
+     * \brief Zero the TB size of the DL streams that are not needed to empty the buffer
+     * \param ue UE that already has enough resources to transmit its buffer
+     * \param bufQueueSize the buffer requirement of the UE (in B)
+     *
+     * This is purely for MIMO: if, for example, the first TB size is big enough
+     * to empty the buffer, nothing should be allocated to the second stream.
+     * Otherwise, the UE would expect the TB but the gNB would not be able to
+     * transmit it, breaking the HARQ TX state machine at the UE PHY.
+     */
+    void TrimUnneededDlStreams(const UePtr& ue, uint32_t bufQueueSize) const;
+
+    /**
+     * \brief Get the units of resources that a UE needs, the first time it gets
+     * DL resources in the slot, to have a TB with data
+     * \param ue the UE, without DL RBG
+     * \param rbgPerUnit the RBG of one unit of resources
+     * \param maxUnits the units still available
+     * \return the minimum number of units, or 0 if maxUnits are not enough
+     *
+     * The TB is the one of UpdateDlMetric(), which is then checked by
+     * CreateDlDci(): at least one stream must have MIN_DL_TB_SIZE bytes.
+     */
+    uint32_t GetDlUnitsForMinTbSize(const UePtr& ue, uint32_t rbgPerUnit, uint32_t maxUnits) const;
+
+    /**
+     * \brief Get the units of resources that a UE needs, the first time it gets
+     * UL resources in the slot, to have a TB with data
+     * \param ue the UE, without UL RBG
+     * \param rbgPerUnit the RBG of one unit of resources
+     * \param maxUnits the units still available
+     * \return the minimum number of units, or 0 if maxUnits are not enough
+     *
+     * The TB is the one calculated by CreateUlDci(), which must have
+     * MIN_UL_TB_SIZE bytes.
+     */
+    uint32_t GetUlUnitsForMinTbSize(const UePtr& ue, uint32_t rbgPerUnit, uint32_t maxUnits) const;
+
+    /**
+     * \brief The smallest DL TB that carries new data: 7 bytes (the minimum TX
+     * opportunity of RLC AM) and 3 bytes of MAC header
+     */
+    static constexpr uint32_t MIN_DL_TB_SIZE = 10;
+    /**
+     * \brief The smallest UL TB that carries new data: 7 bytes (3 MAC header,
+     * 2 RLC header, 2 data) and 5 bytes of SHORT_BSR
+     */
+    static constexpr uint32_t MIN_UL_TB_SIZE = 12;
+
+    /**
+     * \brief Function that checks if a UE has already enough resources to transmit
+     * its buffer; if needed, it also trims the UE streams (see TrimUnneededDlStreams())
+     */
+    typedef std::function<bool(const UePtrAndBufferReq& ue)> IsSatisfiedFn;
+    /**
+     * \brief Function that gives one unit of resource to a UE, or notifies it that
+     * it did not get it
+     */
+    typedef std::function<void(const UePtrAndBufferReq& ue)> AssignmentFn;
+
+    /**
+     * \brief Assign the resources one unit at a time, keeping the UEs in a heap
+     * \param ueVector the UEs to consider
+     * \param resources the number of resources units to assign
+     * \param compare the comparison function of the scheduler (a std::function, or a
+     * NrMacSchedulerUeCompare)
+     * \param IsSatisfied function to know if a UE already has enough resources
+     * \param Assign function to give one unit to a UE
+     * \param NotAssign function to notify a UE that it did not get the unit
+     * \param totalChangesMetric true if the metric of the UEs that got resources
+     * depends on the total resources assigned, and therefore changes every time a
+     * unit is assigned to anyone
+     *
+     * This is the incremental equivalent of sorting ueVector each time a unit
+     * is assigned (see the attribute IncrementalUeOrdering). Calling NotAssign on
+     * a UE whose state did not change since the previous call is assumed to be
+     * a no-op, so it is called on all the UEs only after the first assignment;
+     * afterwards, it is called only on the UEs whose metric could have changed,
+     * and only these UEs are re-positioned in the heap.
+     */
+    template <class Compare>
+    void AssignIncrementally(std::vector<UePtrAndBufferReq>* ueVector,
+                             uint32_t resources,
+                             const Compare& compare,
+                             const IsSatisfiedFn& IsSatisfied,
+                             const AssignmentFn& Assign,
+                             const AssignmentFn& NotAssign,
+                             bool totalChangesMetric) const;
+
+    bool m_incrementalUeOrdering{false}; //!< Keep the UEs in a heap instead of sorting them
+    bool m_wasteFreeAssignment{false};   //!< Assign to a UE at least the resources for a TB
+
   private:
     /**
      * \brief Retrieve the UE vector from an ActiveUeMap
@@ -219,38 +465,19 @@ class NrMacSchedulerTdma : public NrMacSchedulerNs3
     static std::vector<UePtrAndBufferReq> GetUeVectorFromActiveUeMap(const ActiveUeMap& activeUes);
 
   private:
-    typedef std::function<void(const UePtrAndBufferReq&, const FTResources&)>
-        BeforeSchedFn; //!< Before scheduling function
     /**
-     * \brief //!< Function to notify a successfull assignment
+     * \brief Distribute the symbols among the UEs, one symbol at a time
+     * \param symAvail the number of symbols available
+     * \param activeUe the active UEs, per beam
+     * \param type "DL" or "UL", for the logs and the notched RBGs
+     * \param hooks the policy, bound to the direction (see the implementation)
+     * \return a map between the beam and the symbols assigned to each one
      */
-    typedef std::function<void(const UePtrAndBufferReq&, const FTResources&, const FTResources&)>
-        AfterSuccessfullAssignmentFn;
-    /**
-     * \brief Function to notify that the UE did not get any resource in one iteration
-     */
-    typedef std::function<void(const UePtrAndBufferReq&, const FTResources&, const FTResources&)>
-        AfterUnsucessfullAssignmentFn;
-    typedef std::function<uint32_t&(const UePtr& ue)> GetRBGFn; //!< Getter for the RBG of an UE
-    typedef std::function<uint32_t(const UePtr& ue)> GetTBSFn;  //!< Getter for the TBS of an UE
-    typedef std::function<uint8_t&(const UePtr& ue)>
-        GetSymFn; //!< Getter for the number of symbols of an UE
-    typedef std::function<bool(const NrMacSchedulerNs3::UePtrAndBufferReq& lhs,
-                               const NrMacSchedulerNs3::UePtrAndBufferReq& rhs)>
-        CompareUeFn;
-    typedef std::function<CompareUeFn()> GetCompareUeFn;
-
-    BeamSymbolMap AssignRBGTDMA(
-        uint32_t symAvail,
-        const ActiveUeMap& activeUe,
-        const std::string& type,
-        const BeforeSchedFn& BeforeSchedFn,
-        const GetCompareUeFn& GetCompareFn,
-        const GetTBSFn& GetTBSFn,
-        const GetRBGFn& GetRBGFn,
-        const GetSymFn& GetSymFn,
-        const AfterSuccessfullAssignmentFn& SuccessfullAssignmentFn,
-        const AfterUnsucessfullAssignmentFn& UnSuccessfullAssignmentFn) const;
+    template <class Hooks>
+    BeamSymbolMap AssignRBGTDMA(uint32_t symAvail,
+                                const ActiveUeMap& activeUe,
+                                const std::string& type,
+                                const Hooks& hooks) const;
 
     std::shared_ptr<DciInfoElementTdma> CreateDci(
         PointInFTPlane* spoint,
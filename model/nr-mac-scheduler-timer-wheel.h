@@ -0,0 +1,154 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include <ns3/assert.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief Timer wheel of per-UE timers, counted in ticks (usually slots)
+ *
+ * Each UE, identified by its RNTI, has at most one timer. The wheel is a ring
+ * of buckets: a timer that expires at the tick t is stored in the bucket
+ * t modulo the number of buckets. At each tick, Advance() visits only the
+ * bucket of the current tick, and returns the UEs whose timer expires, so
+ * the cost of a tick does not depend on the number of UEs with a running
+ * timer. A timer that expires after more than one revolution of the wheel
+ * stays in its bucket, and it is skipped until its tick comes.
+ *
+ * Starting, restarting, and stopping a timer cost O(1): each UE remembers
+ * its position inside the bucket, and it is removed by swapping it with the
+ * last UE of the bucket.
+ */
+class NrMacSchedulerTimerWheel
+{
+  public:
+    /**
+     * \brief NrMacSchedulerTimerWheel constructor
+     * \param numBuckets number of buckets of the wheel; timers shorter than
+     * this value are visited only when they expire
+     */
+    NrMacSchedulerTimerWheel(uint32_t numBuckets = 1024)
+        : m_buckets(numBuckets)
+    {
+        NS_ASSERT(numBuckets > 0);
+    }
+
+    /**
+     * \brief Start (or restart) the timer of a UE
+     * \param rnti the UE
+     * \param delay number of calls to Advance() after which the timer
+     * expires; must be greater than 0
+     */
+    void Schedule(uint16_t rnti, uint64_t delay)
+    {
+        NS_ASSERT(delay > 0);
+        Cancel(rnti);
+        const uint64_t expiry = m_now + delay;
+        auto& bucket = m_buckets[expiry % m_buckets.size()];
+        m_timers.emplace(rnti, Timer{expiry, expiry % m_buckets.size(), bucket.size()});
+        bucket.push_back(rnti);
+    }
+
+    /**
+     * \brief Stop the timer of a UE, if it is running
+     * \param rnti the UE
+     */
+    void Cancel(uint16_t rnti)
+    {
+        auto it = m_timers.find(rnti);
+        if (it == m_timers.end())
+        {
+            return;
+        }
+        RemoveFromBucket(it->second);
+        m_timers.erase(it);
+    }
+
+    /**
+     * \param rnti the UE
+     * \return true if the timer of the UE is running
+     */
+    bool IsRunning(uint16_t rnti) const
+    {
+        return m_timers.find(rnti) != m_timers.end();
+    }
+
+    /**
+     * \return the number of running timers
+     */
+    std::size_t GetNumRunning() const
+    {
+        return m_timers.size();
+    }
+
+    /**
+     * \brief Move the wheel forward by one tick
+     * \param expired the UEs whose timer expires in this tick (cleared before use)
+     */
+    void Advance(std::vector<uint16_t>* expired)
+    {
+        expired->clear();
+        ++m_now;
+        auto& bucket = m_buckets[m_now % m_buckets.size()];
+        for (std::size_t i = 0; i < bucket.size(); /* NO INC */)
+        {
+            auto it = m_timers.find(bucket[i]);
+            NS_ASSERT(it != m_timers.end());
+            if (it->second.m_expiry == m_now)
+            {
+                // The last UE of the bucket takes the place i: do not increment
+                expired->push_back(it->first);
+                RemoveFromBucket(it->second);
+                m_timers.erase(it);
+            }
+            else
+            {
+                NS_ASSERT(it->second.m_expiry > m_now);
+                ++i;
+            }
+        }
+    }
+
+  private:
+    /**
+     * \brief A running timer
+     */
+    struct Timer
+    {
+        uint64_t m_expiry{0};    //!< Tick at which the timer expires
+        std::size_t m_bucket{0}; //!< Bucket of the timer
+        std::size_t m_index{0};  //!< Position of the UE in the bucket
+    };
+
+    /**
+     * \brief Remove the UE of a timer from its bucket
+     * \param timer the timer
+     */
+    void RemoveFromBucket(const Timer& timer)
+    {
+        auto& bucket = m_buckets[timer.m_bucket];
+        NS_ASSERT(timer.m_index < bucket.size());
+        const uint16_t last = bucket.back();
+        bucket[timer.m_index] = last;
+        m_timers.at(last).m_index = timer.m_index;
+        bucket.pop_back();
+    }
+
+    uint64_t m_now{0};                            //!< Number of calls to Advance()
+    std::vector<std::vector<uint16_t>> m_buckets; //!< UEs, by expiry tick modulo their number
+    std::unordered_map<uint16_t, Timer> m_timers; //!< Running timer of each UE
+};
+
+} // namespace ns3
@@ -0,0 +1,514 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "nr-mac-scheduler-trace.h"
+
+#include <ns3/abort.h>
+#include <ns3/log.h>
+
+#include <type_traits>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("NrMacSchedulerTrace");
+
+namespace
+{
+
+/*
+ * The fields of each structure are listed once, in a Fields() function that is
+ * used both to write and to read the structure: the OutArchive writes the
+ * fields it is given, the InArchive overwrites them with the values read.
+ * The OutArchive never modifies the fields.
+ */
+
+template <class Archive>
+void Fields(Archive& ar, NrMacSchedulerTrace::Config& p);
+template <class Archive>
+void Fields(Archive& ar, BandInfo& p);
+template <class Archive>
+void Fields(Archive& ar, SfnSf& p);
+template <class Archive>
+void Fields(Archive& ar, BeamConfId& p);
+template <class Archive>
+void Fields(Archive& ar, LogicalChannelConfigListElement_s& p);
+template <class Archive>
+void Fields(Archive& ar, RachListElement_s& p);
+template <class Archive>
+void Fields(Archive& ar, DlCqiInfo& p);
+template <class Archive>
+void Fields(Archive& ar, UlCqiInfo& p);
+template <class Archive>
+void Fields(Archive& ar, DlHarqInfo& p);
+template <class Archive>
+void Fields(Archive& ar, UlHarqInfo& p);
+template <class Archive>
+void Fields(Archive& ar, MacCeElement& p);
+template <class Archive>
+void Fields(Archive& ar, NrMacCschedSapProvider::CschedCellConfigReqParameters& p);
+template <class Archive>
+void Fields(Archive& ar, NrMacCschedSapProvider::CschedUeConfigReqParameters& p);
+template <class Archive>
+void Fields(Archive& ar, NrMacCschedSapProvider::CschedLcConfigReqParameters& p);
+template <class Archive>
+void Fields(Archive& ar, NrMacCschedSapProvider::CschedLcReleaseReqParameters& p);
+template <class Archive>
+void Fields(Archive& ar, NrMacCschedSapProvider::CschedUeReleaseReqParameters& p);
+template <class Archive>
+void Fields(Archive& ar, NrMacSchedSapProvider::SchedDlRlcBufferReqParameters& p);
+template <class Archive>
+void Fields(Archive& ar, NrMacSchedSapProvider::SchedDlCqiInfoReqParameters& p);
+template <class Archive>
+void Fields(Archive& ar, NrMacSchedSapProvider::SchedDlTriggerReqParameters& p);
+template <class Archive>
+void Fields(Archive& ar, NrMacSchedSapProvider::SchedUlCqiInfoReqParameters& p);
+template <class Archive>
+void Fields(Archive& ar, NrMacSchedSapProvider::SchedUlTriggerReqParameters& p);
+template <class Archive>
+void Fields(Archive& ar, NrMacSchedSapProvider::SchedUlSrInfoReqParameters& p);
+template <class Archive>
+void Fields(Archive& ar, NrMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters& p);
+template <class Archive>
+void Fields(Archive& ar, NrMacSchedSapProvider::SchedDlRachInfoReqParameters& p);
+template <class Archive>
+void Fields(Archive& ar, NrConfiguredGrant& p);
+template <class Archive>
+void Fields(Archive& ar, NrMacSchedulerTrace::ConfiguredGrantAdd& p);
+template <class Archive>
+void Fields(Archive& ar, NrMacSchedulerTrace::ConfiguredGrantRemove& p);
+template <class Archive>
+void Fields(Archive& ar, NrMacSchedSapProvider::SchedDlMiniSlotReqParameters& p);
+
+/**
+ * \brief Write fields to a stream
+ */
+class OutArchive
+{
+  public:
+    OutArchive(std::ostream& os)
+        : m_os(os)
+    {
+    }
+
+    template <class... T>
+    void operator()(T&... fields)
+    {
+        (Field(fields), ...);
+    }
+
+  private:
+    template <class T>
+    void Field(T& v)
+    {
+        if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T>)
+        {
+            m_os.write(reinterpret_cast<const char*>(&v), sizeof(T));
+        }
+        else
+        {
+            Fields(*this, v);
+        }
+    }
+
+    template <class T>
+    void Field(std::vector<T>& v)
+    {
+        uint32_t size = static_cast<uint32_t>(v.size());
+        Field(size);
+        for (auto& e : v)
+        {
+            Field(e);
+        }
+    }
+
+    std::ostream& m_os; //!< The stream
+};
+
+/**
+ * \brief Read fields from a stream
+ */
+class InArchive
+{
+  public:
+    InArchive(std::istream& is)
+        : m_is(is)
+    {
+    }
+
+    template <class... T>
+    void operator()(T&... fields)
+    {
+        (Field(fields), ...);
+    }
+
+  private:
+    template <class T>
+    void Field(T& v)
+    {
+        if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T>)
+        {
+            m_is.read(reinterpret_cast<char*>(&v), sizeof(T));
+            NS_ABORT_MSG_IF(!m_is, "Truncated scheduler trace");
+        }
+        else
+        {
+            Fields(*this, v);
+        }
+    }
+
+    template <class T>
+    void Field(std::vector<T>& v)
+    {
+        uint32_t size = 0;
+        Field(size);
+        v.resize(size);
+        for (auto& e : v)
+        {
+            Field(e);
+        }
+    }
+
+    std::istream& m_is; //!< The stream
+};
+
+template <class Archive>
+void
+Fields(Archive& ar, NrMacSchedulerTrace::Config& p)
+{
+    ar(p.m_symbolsPerSlot,
+       p.m_slotPeriodNs,
+       p.m_numRbPerRbg,
+       p.m_numHarqProcess,
+       p.m_bwpId,
+       p.m_cellId,
+       p.m_bands);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, BandInfo& p)
+{
+    ar(p.fl, p.fc, p.fh);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, SfnSf& p)
+{
+    uint64_t encoding = p.GetEncoding();
+    ar(encoding);
+    p.FromEncoding(encoding);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, BeamConfId& p)
+{
+    uint16_t firstSector = p.GetFirstBeam().GetSector();
+    double firstElevation = p.GetFirstBeam().GetElevation();
+    uint16_t secondSector = p.GetSecondBeam().GetSector();
+    double secondElevation = p.GetSecondBeam().GetElevation();
+    ar(firstSector, firstElevation, secondSector, secondElevation);
+    p = BeamConfId(BeamId(firstSector, firstElevation), BeamId(secondSector, secondElevation));
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, LogicalChannelConfigListElement_s& p)
+{
+    ar(p.m_logicalChannelIdentity,
+       p.m_logicalChannelGroup,
+       p.m_direction,
+       p.m_qosBearerType,
+       p.m_qci,
+       p.m_eRabMaximulBitrateUl,
+       p.m_eRabMaximulBitrateDl,
+       p.m_eRabGuaranteedBitrateUl,
+       p.m_eRabGuaranteedBitrateDl);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, RachListElement_s& p)
+{
+    ar(p.m_rnti, p.m_estimatedSize);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, DlCqiInfo& p)
+{
+    ar(p.m_rnti, p.m_ri, p.m_cqiType, p.m_wbCqi, p.m_wbPmi, p.m_sbCqi, p.m_sbSize);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, UlCqiInfo& p)
+{
+    ar(p.m_sinr, p.m_type);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, DlHarqInfo& p)
+{
+    ar(p.m_rnti, p.m_harqProcessId, p.m_bwpIndex, p.m_harqStatus, p.m_numRetx);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, UlHarqInfo& p)
+{
+    ar(p.m_rnti,
+       p.m_harqProcessId,
+       p.m_bwpIndex,
+       p.m_ulReception,
+       p.m_receptionStatus,
+       p.m_tpc,
+       p.m_numRetx);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, MacCeElement& p)
+{
+    ar(p.m_rnti,
+       p.m_macCeType,
+       p.m_macCeValue.m_phr,
+       p.m_macCeValue.m_crnti,
+       p.m_macCeValue.m_bufferStatus);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, NrMacCschedSapProvider::CschedCellConfigReqParameters& p)
+{
+    ar(p.m_ulBandwidth, p.m_dlBandwidth);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, NrMacCschedSapProvider::CschedUeConfigReqParameters& p)
+{
+    ar(p.m_rnti, p.m_beamConfId, p.m_transmissionMode);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, NrMacCschedSapProvider::CschedLcConfigReqParameters& p)
+{
+    ar(p.m_rnti, p.m_reconfigureFlag, p.m_logicalChannelConfigList);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, NrMacCschedSapProvider::CschedLcReleaseReqParameters& p)
+{
+    ar(p.m_rnti, p.m_logicalChannelIdentity);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, NrMacCschedSapProvider::CschedUeReleaseReqParameters& p)
+{
+    ar(p.m_rnti);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, NrMacSchedSapProvider::SchedDlRlcBufferReqParameters& p)
+{
+    ar(p.m_rnti,
+       p.m_logicalChannelIdentity,
+       p.m_rlcTransmissionQueueSize,
+       p.m_rlcTransmissionQueueHolDelay,
+       p.m_rlcRetransmissionQueueSize,
+       p.m_rlcRetransmissionHolDelay,
+       p.m_rlcStatusPduSize);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, NrMacSchedSapProvider::SchedDlCqiInfoReqParameters& p)
+{
+    ar(p.m_sfnsf, p.m_cqiList);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, NrMacSchedSapProvider::SchedDlTriggerReqParameters& p)
+{
+    ar(p.m_snfSf, p.m_dlHarqInfoList, p.m_slotType);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, NrMacSchedSapProvider::SchedUlCqiInfoReqParameters& p)
+{
+    ar(p.m_sfnSf, p.m_symStart, p.m_ulCqi);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, NrMacSchedSapProvider::SchedUlTriggerReqParameters& p)
+{
+    ar(p.m_snfSf, p.m_ulHarqInfoList, p.m_slotType);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, NrMacSchedSapProvider::SchedUlSrInfoReqParameters& p)
+{
+    ar(p.m_snfSf, p.m_srList);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, NrMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters& p)
+{
+    ar(p.m_sfnSf, p.m_macCeList);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, NrMacSchedSapProvider::SchedDlRachInfoReqParameters& p)
+{
+    ar(p.m_sfnSf, p.m_rachList);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, NrConfiguredGrant& p)
+{
+    ar(p.m_format, p.m_lcId, p.m_periodicity, p.m_offset, p.m_symStart, p.m_numSym, p.m_mcs);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, NrMacSchedulerTrace::ConfiguredGrantAdd& p)
+{
+    ar(p.m_rnti, p.m_grant);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, NrMacSchedulerTrace::ConfiguredGrantRemove& p)
+{
+    ar(p.m_rnti, p.m_format);
+}
+
+template <class Archive>
+void
+Fields(Archive& ar, NrMacSchedSapProvider::SchedDlMiniSlotReqParameters& p)
+{
+    ar(p.m_snfSf, p.m_symStart, p.m_numSym);
+}
+
+/**
+ * \brief Create the parameters of a record type, with default values
+ * \param type the record type, i.e., the index of the parameters in the variant
+ * \return the parameters
+ */
+template <std::size_t I = 0>
+NrMacSchedulerTrace::Params
+MakeParams(std::size_t type)
+{
+    if constexpr (I < std::variant_size_v<NrMacSchedulerTrace::Params>)
+    {
+        if (type == I)
+        {
+            return NrMacSchedulerTrace::Params(std::in_place_index<I>);
+        }
+        return MakeParams<I + 1>(type);
+    }
+    else
+    {
+        NS_FATAL_ERROR("Unknown record " << type << " in scheduler trace");
+        return {};
+    }
+}
+
+} // namespace
+
+void
+NrMacSchedulerTrace::Writer::Open(const std::string& filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+    m_file.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    NS_ABORT_MSG_IF(!m_file.is_open(), "Can't open the scheduler trace " << filename);
+
+    OutArchive ar(m_file);
+    uint32_t magic = MAGIC;
+    uint16_t version = VERSION;
+    ar(magic, version);
+}
+
+bool
+NrMacSchedulerTrace::Writer::IsOpen() const
+{
+    return m_file.is_open();
+}
+
+void
+NrMacSchedulerTrace::Writer::Write(const Record& record)
+{
+    NS_ASSERT(m_file.is_open());
+    OutArchive ar(m_file);
+    uint8_t type = record.GetType();
+    int64_t timeNs = record.m_timeNs;
+    ar(type, timeNs);
+    // The OutArchive does not modify the parameters
+    std::visit([&ar](auto& params) { ar(params); }, const_cast<Params&>(record.m_params));
+    NS_ABORT_MSG_IF(!m_file, "Error while writing the scheduler trace");
+}
+
+void
+NrMacSchedulerTrace::Writer::Close()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_file.is_open())
+    {
+        m_file.close();
+    }
+}
+
+void
+NrMacSchedulerTrace::Reader::Open(const std::string& filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+    m_file.open(filename, std::ios::in | std::ios::binary);
+    NS_ABORT_MSG_IF(!m_file.is_open(), "Can't open the scheduler trace " << filename);
+
+    InArchive ar(m_file);
+    uint32_t magic = 0;
+    uint16_t version = 0;
+    ar(magic, version);
+    NS_ABORT_MSG_IF(magic != MAGIC, filename << " is not a scheduler trace");
+    NS_ABORT_MSG_IF(version != VERSION,
+                    "Version " << version << " of the scheduler trace is not supported");
+}
+
+bool
+NrMacSchedulerTrace::Reader::Read(Record* record)
+{
+    NS_ASSERT(m_file.is_open());
+    uint8_t type = 0;
+    m_file.read(reinterpret_cast<char*>(&type), sizeof(type));
+    if (m_file.eof())
+    {
+        return false;
+    }
+    NS_ABORT_MSG_IF(type >= NUM_RECORD_TYPES, "Unknown record " << +type << " in scheduler trace");
+
+    InArchive ar(m_file);
+    ar(record->m_timeNs);
+    record->m_params = MakeParams(type);
+    std::visit([&ar](auto& params) { ar(params); }, record->m_params);
+    return true;
+}
+
+} // namespace ns3
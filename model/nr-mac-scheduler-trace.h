@@ -0,0 +1,198 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include "nr-mac-csched-sap.h"
+#include "nr-mac-sched-sap.h"
+
+#include <ns3/spectrum-model.h>
+
+#include <fstream>
+#include <string>
+#include <variant>
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief Binary trace of the calls from the MAC to the scheduler
+ *
+ * The trace is written by NrMacSchedulerRecorder and read by
+ * NrMacSchedulerReplay. It starts with a header (a magic number and the
+ * version of the format), followed by one record per call of the
+ * NrMacCschedSapProvider or NrMacSchedSapProvider interfaces. Each record is
+ * made of its type (one byte), the simulation time of the call (in ns), and
+ * the parameters of the call. Numbers are stored in the byte order of the
+ * host, vectors are stored as their size followed by their elements.
+ *
+ * Of the CSCHED parameters, which come from the LTE FF API, the trace keeps
+ * only the fields that the NR schedulers read. The values that the scheduler
+ * reads from the MAC through NrMacSchedSapUser are stored once, in a CONFIG
+ * record. The configured grants, which do not pass through the SAPs, have
+ * their own records.
+ */
+class NrMacSchedulerTrace
+{
+  public:
+    static constexpr uint32_t MAGIC = 0x5253524e; //!< "NRSR", in little endian
+    static constexpr uint16_t VERSION = 4;        //!< Version of the format
+
+    /**
+     * \brief Type of a record; it is the index of its parameters in Params
+     */
+    enum RecordType : uint8_t
+    {
+        CONFIG = 0,    //!< Configuration read from NrMacSchedSapUser
+        CELL_CONFIG,   //!< CschedCellConfigReq
+        UE_CONFIG,     //!< CschedUeConfigReq
+        LC_CONFIG,     //!< CschedLcConfigReq
+        LC_RELEASE,    //!< CschedLcReleaseReq
+        UE_RELEASE,    //!< CschedUeReleaseReq
+        DL_RLC_BUFFER, //!< SchedDlRlcBufferReq
+        DL_CQI,        //!< SchedDlCqiInfoReq
+        DL_TRIGGER,    //!< SchedDlTriggerReq, with the DL HARQ feedback
+        UL_CQI,        //!< SchedUlCqiInfoReq
+        UL_TRIGGER,    //!< SchedUlTriggerReq, with the UL HARQ feedback
+        UL_SR,         //!< SchedUlSrInfoReq
+        UL_MAC_CTRL,   //!< SchedUlMacCtrlInfoReq (BSR)
+        DL_RACH,       //!< SchedDlRachInfoReq
+        SET_MCS,       //!< SchedSetMcs
+        CG_ADD,        //!< NrMacSchedulerNs3::AddConfiguredGrant
+        CG_REMOVE,     //!< NrMacSchedulerNs3::RemoveConfiguredGrant
+        MINI_SLOT,     //!< SchedDlMiniSlotReq
+        NUM_RECORD_TYPES
+    };
+
+    /**
+     * \brief Values that the scheduler reads from the MAC through NrMacSchedSapUser
+     */
+    struct Config
+    {
+        uint32_t m_symbolsPerSlot{0};  //!< Number of symbols per slot
+        int64_t m_slotPeriodNs{0};     //!< Slot period, in ns
+        uint32_t m_numRbPerRbg{0};     //!< Number of RBs per RBG
+        uint8_t m_numHarqProcess{0};   //!< Number of HARQ processes
+        uint16_t m_bwpId{0};           //!< BWP ID
+        uint16_t m_cellId{0};          //!< Cell ID
+        std::vector<BandInfo> m_bands; //!< Bands of the spectrum model
+    };
+
+    /**
+     * \brief A configured grant added to a UE
+     */
+    struct ConfiguredGrantAdd
+    {
+        uint16_t m_rnti{0};        //!< RNTI of the UE
+        NrConfiguredGrant m_grant; //!< The grant
+    };
+
+    /**
+     * \brief The configured grants of a UE removed in a direction
+     */
+    struct ConfiguredGrantRemove
+    {
+        uint16_t m_rnti{0};                                             //!< RNTI of the UE
+        DciInfoElementTdma::DciFormat m_format{DciInfoElementTdma::UL}; //!< DL or UL
+    };
+
+    /**
+     * \brief Parameters of a record, in the order of RecordType
+     */
+    using Params = std::variant<Config,
+                                NrMacCschedSapProvider::CschedCellConfigReqParameters,
+                                NrMacCschedSapProvider::CschedUeConfigReqParameters,
+                                NrMacCschedSapProvider::CschedLcConfigReqParameters,
+                                NrMacCschedSapProvider::CschedLcReleaseReqParameters,
+                                NrMacCschedSapProvider::CschedUeReleaseReqParameters,
+                                NrMacSchedSapProvider::SchedDlRlcBufferReqParameters,
+                                NrMacSchedSapProvider::SchedDlCqiInfoReqParameters,
+                                NrMacSchedSapProvider::SchedDlTriggerReqParameters,
+                                NrMacSchedSapProvider::SchedUlCqiInfoReqParameters,
+                                NrMacSchedSapProvider::SchedUlTriggerReqParameters,
+                                NrMacSchedSapProvider::SchedUlSrInfoReqParameters,
+                                NrMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters,
+                                NrMacSchedSapProvider::SchedDlRachInfoReqParameters,
+                                uint32_t,
+                                ConfiguredGrantAdd,
+                                ConfiguredGrantRemove,
+                                NrMacSchedSapProvider::SchedDlMiniSlotReqParameters>;
+
+    /**
+     * \brief A record of the trace
+     */
+    struct Record
+    {
+        int64_t m_timeNs{0}; //!< Simulation time of the call, in ns
+        Params m_params;     //!< Parameters of the call
+
+        /**
+         * \return the type of the record
+         */
+        RecordType GetType() const
+        {
+            return static_cast<RecordType>(m_params.index());
+        }
+    };
+
+    /**
+     * \brief Write a trace to a file
+     */
+    class Writer
+    {
+      public:
+        /**
+         * \brief Create the file, and write the header of the trace
+         * \param filename name of the file
+         */
+        void Open(const std::string& filename);
+
+        /**
+         * \return true if the file is open
+         */
+        bool IsOpen() const;
+
+        /**
+         * \brief Append a record to the trace
+         * \param record the record
+         */
+        void Write(const Record& record);
+
+        /**
+         * \brief Flush and close the file
+         */
+        void Close();
+
+      private:
+        std::ofstream m_file; //!< The file
+    };
+
+    /**
+     * \brief Read a trace from a file
+     */
+    class Reader
+    {
+      public:
+        /**
+         * \brief Open the file, and check the header of the trace
+         * \param filename name of the file
+         */
+        void Open(const std::string& filename);
+
+        /**
+         * \brief Read the next record of the trace
+         * \param record the record read
+         * \return false at the end of the trace
+         */
+        bool Read(Record* record);
+
+      private:
+        std::ifstream m_file; //!< The file
+    };
+};
+
+} // namespace ns3
@@ -0,0 +1,364 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include <ns3/assert.h>
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief Pending lists of the UEs, grouped by beam and MCS class
+ *
+ * The UEs that share a beam and an MCS are interchangeable for the
+ * assignment of the resources: a class is a (beam, MCS) pair, and each class
+ * has a pending list of the UEs in it, which is a queue of RNTIs. The state of
+ * a UE is a compact record (see GetRecordSize()), stored in a vector indexed
+ * by RNTI, that tells the slot in which the UE has been active the last time,
+ * its index in the active UEs of its beam in that slot, and its class.
+ *
+ * At every slot, after NewSlot(), the scheduler calls Activate() for each
+ * active UE: a UE that is not in the pending list of its class is appended to
+ * it. Front() gives the first UE of a class that is active in the slot; the
+ * UEs that are not active anymore, and the entries left behind by the UEs
+ * that changed class, are dropped when they reach the front of the list. The
+ * UEs that get resources are removed with Serve(), and put back by Requeue():
+ * at the end of the list with the RR policy, or at its front, in the same
+ * order, with the FIFO policy, so that they are served in the order in which
+ * they entered the list until they have no more data.
+ *
+ * All the operations cost O(1), amortized; the entries left behind are
+ * removed at once when they are as many as the pending UEs.
+ */
+class NrMacSchedulerUeClasses
+{
+  public:
+    static constexpr uint8_t NUM_CLASSES = 32;      //!< One class per MCS index, for each beam
+    static constexpr uint16_t NO_BEAM = UINT16_MAX; //!< Beam of a UE not in a pending list
+
+    /**
+     * \brief Order of the UEs inside a class
+     */
+    enum Policy : uint8_t
+    {
+        FIFO, //!< The served UEs keep their place until they have no more data
+        RR,   //!< The served UEs go after the other UEs of the class
+    };
+
+    /**
+     * \brief Set the order of the UEs inside a class
+     * \param policy the policy
+     */
+    void SetPolicy(Policy policy)
+    {
+        m_policy = policy;
+    }
+
+    /**
+     * \return the order of the UEs inside a class
+     */
+    Policy GetPolicy() const
+    {
+        return m_policy;
+    }
+
+    /**
+     * \brief Start a new slot: the UEs are inactive until Activate() is called
+     */
+    void NewSlot()
+    {
+        ++m_slot;
+    }
+
+    /**
+     * \brief Mark a UE as active in the current slot
+     * \param rnti the UE
+     * \param beam the index of the beam of the UE
+     * \param mcs the MCS of the UE
+     * \param index the index of the UE among the active UEs of the beam
+     *
+     * The UE is appended to the pending list of its class, if it is not
+     * already in it.
+     */
+    void Activate(uint16_t rnti, uint16_t beam, uint8_t mcs, uint32_t index)
+    {
+        NS_ASSERT(beam != NO_BEAM && mcs < NUM_CLASSES);
+        if (rnti >= m_records.size())
+        {
+            m_records.resize(rnti + 1);
+        }
+        Record& record = m_records[rnti];
+        record.m_slot = m_slot;
+        record.m_index = index;
+        if (record.m_beam == beam && record.m_mcs == mcs)
+        {
+            return;
+        }
+        if (record.m_beam == NO_BEAM)
+        {
+            ++m_numPending;
+        }
+        record.m_beam = beam;
+        record.m_mcs = mcs;
+        Enqueue(rnti, false);
+    }
+
+    /**
+     * \brief Get the first UE of a class that is active in the slot
+     * \param beam the index of the beam
+     * \param mcs the MCS of the class
+     * \param rnti the UE
+     * \param index the index of the UE among the active UEs of the beam
+     * \return false if the class has no active UE
+     */
+    bool Front(uint16_t beam, uint8_t mcs, uint16_t* rnti, uint32_t* index)
+    {
+        if (beam >= m_queues.size())
+        {
+            return false;
+        }
+        std::deque<Entry>& queue = m_queues[beam][mcs];
+        while (!queue.empty())
+        {
+            const Entry entry = queue.front();
+            Record& record = m_records[entry.m_rnti];
+            if (entry.m_gen != record.m_gen || record.m_beam != beam || record.m_mcs != mcs)
+            {
+                // Left behind by a UE that changed class, or that has been removed
+                PopFront(&queue);
+                continue;
+            }
+            if (record.m_slot != m_slot)
+            {
+                // Without data, or without HARQ processes: it will be activated again
+                PopFront(&queue);
+                Leave(&record);
+                continue;
+            }
+            *rnti = entry.m_rnti;
+            *index = record.m_index;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * \brief Remove the UE returned by Front() from the list; it will be put
+     * back by Requeue()
+     * \param beam the index of the beam
+     * \param mcs the MCS of the class
+     */
+    void Serve(uint16_t beam, uint8_t mcs)
+    {
+        std::deque<Entry>& queue = m_queues.at(beam)[mcs];
+        NS_ASSERT(!queue.empty());
+        m_served.push_back(queue.front().m_rnti);
+        PopFront(&queue);
+    }
+
+    /**
+     * \brief Put back the UEs served in a class, as required by the policy
+     */
+    void Requeue()
+    {
+        const bool front = m_policy == FIFO;
+        if (front)
+        {
+            for (auto it = m_served.rbegin(); it != m_served.rend(); ++it)
+            {
+                Enqueue(*it, true);
+            }
+        }
+        else
+        {
+            for (const auto rnti : m_served)
+            {
+                Enqueue(rnti, false);
+            }
+        }
+        m_served.clear();
+    }
+
+    /**
+     * \brief Remove a UE
+     * \param rnti the UE
+     */
+    void Remove(uint16_t rnti)
+    {
+        if (rnti < m_records.size())
+        {
+            Leave(&m_records[rnti]);
+        }
+    }
+
+    /**
+     * \param beam the index of the beam
+     * \return the class of the beam from which to start the assignment
+     */
+    uint8_t GetFirstClass(uint16_t beam) const
+    {
+        return beam < m_firstClass.size() ? m_firstClass[beam] : 0;
+    }
+
+    /**
+     * \brief Set the class of the beam from which to start the next assignment
+     * \param beam the index of the beam
+     * \param mcs the MCS of the class
+     */
+    void SetFirstClass(uint16_t beam, uint8_t mcs)
+    {
+        NS_ASSERT(beam < m_firstClass.size() && mcs < NUM_CLASSES);
+        m_firstClass[beam] = mcs;
+    }
+
+    /**
+     * \return the number of UEs in the pending lists
+     */
+    uint32_t GetNumPending() const
+    {
+        return m_numPending;
+    }
+
+    /**
+     * \return the number of entries in the pending lists, including the ones
+     * left behind by the UEs that changed class
+     */
+    uint32_t GetNumEntries() const
+    {
+        return m_numEntries;
+    }
+
+    /**
+     * \return the size of the record of a UE, in bytes
+     */
+    static constexpr std::size_t GetRecordSize()
+    {
+        return sizeof(Record);
+    }
+
+  private:
+    /**
+     * \brief The compact state of a UE
+     */
+    struct Record
+    {
+        uint32_t m_slot{0};       //!< Last slot in which the UE has been active
+        uint32_t m_index{0};      //!< Index of the UE among the active UEs of its beam
+        uint16_t m_beam{NO_BEAM}; //!< Beam of the pending list of the UE
+        uint8_t m_mcs{0};         //!< MCS of the pending list of the UE
+        uint8_t m_gen{0};         //!< Generation of the valid entry of the UE
+    };
+
+    /**
+     * \brief An entry of a pending list; it is valid if it has the generation of the UE
+     */
+    struct Entry
+    {
+        uint16_t m_rnti{0}; //!< The UE
+        uint8_t m_gen{0};   //!< Generation of the entry
+    };
+
+    /**
+     * \brief Insert a UE in the list of its class, invalidating its other entries
+     * \param rnti the UE, in a pending list
+     * \param front true to insert it at the front of the list
+     */
+    void Enqueue(uint16_t rnti, bool front)
+    {
+        Record& record = m_records[rnti];
+        NS_ASSERT(record.m_beam != NO_BEAM);
+        if (record.m_beam >= m_queues.size())
+        {
+            m_queues.resize(record.m_beam + 1);
+            m_firstClass.resize(record.m_beam + 1, 0);
+        }
+        ++record.m_gen;
+        std::deque<Entry>& queue = m_queues[record.m_beam][record.m_mcs];
+        if (front)
+        {
+            queue.push_front({rnti, record.m_gen});
+        }
+        else
+        {
+            queue.push_back({rnti, record.m_gen});
+        }
+        ++m_numEntries;
+        if (m_numEntries > 2 * m_numPending + NUM_CLASSES)
+        {
+            Compact();
+        }
+    }
+
+    /**
+     * \brief Remove the first entry of a list
+     * \param queue the list
+     */
+    void PopFront(std::deque<Entry>* queue)
+    {
+        queue->pop_front();
+        --m_numEntries;
+    }
+
+    /**
+     * \brief Take a UE out of the pending lists; its entries become invalid
+     * \param record the record of the UE
+     */
+    void Leave(Record* record)
+    {
+        if (record->m_beam != NO_BEAM)
+        {
+            record->m_beam = NO_BEAM;
+            ++record->m_gen;
+            --m_numPending;
+        }
+    }
+
+    /**
+     * \brief Remove the invalid entries from all the lists
+     */
+    void Compact()
+    {
+        m_numEntries = 0;
+        for (uint16_t beam = 0; beam < m_queues.size(); ++beam)
+        {
+            for (uint8_t mcs = 0; mcs < NUM_CLASSES; ++mcs)
+            {
+                std::deque<Entry>& queue = m_queues[beam][mcs];
+                std::deque<Entry> valid;
+                for (const auto& entry : queue)
+                {
+                    const Record& record = m_records[entry.m_rnti];
+                    if (entry.m_gen == record.m_gen && record.m_beam == beam &&
+                        record.m_mcs == mcs)
+                    {
+                        valid.push_back(entry);
+                    }
+                }
+                m_numEntries += valid.size();
+                queue.swap(valid);
+            }
+        }
+    }
+
+    Policy m_policy{RR};      //!< Order of the UEs inside a class
+    uint32_t m_slot{0};       //!< Current slot
+    uint32_t m_numPending{0}; //!< UEs in the pending lists
+    uint32_t m_numEntries{0}; //!< Entries in the pending lists, valid or not
+
+    std::vector<Record> m_records;                                     //!< UEs, by RNTI
+    std::vector<std::array<std::deque<Entry>, NUM_CLASSES>> m_queues; //!< Lists, by beam and MCS
+    std::vector<uint8_t> m_firstClass; //!< First class of the next assignment, by beam
+    std::vector<uint16_t> m_served;    //!< UEs served in the current class
+};
+
+} // namespace ns3
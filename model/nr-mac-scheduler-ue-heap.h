@@ -0,0 +1,258 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include "nr-mac-scheduler-ns3.h"
+
+#include <functional>
+#include <limits>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief Indexed binary heap of the UEs that are eligible for a resource
+ *
+ * The heap does not own the UEs: it stores the indexes of the elements of a
+ * vector of NrMacSchedulerNs3::UePtrAndBufferReq, and keeps them ordered with
+ * the comparison function of the scheduler (e.g., the one returned by
+ * NrMacSchedulerTdma::GetUeCompareDlFn()). The element on top is the one that
+ * the comparison function orders first, i.e., the UE with the highest priority.
+ *
+ * Since the position of each UE inside the heap is tracked, when the metric of
+ * a UE changes it is enough to call Update() with its index to restore the
+ * order, in O(log n), instead of sorting again all the UEs. UEs that compare
+ * equal are ordered by their index in the vector, so the order is fully
+ * deterministic.
+ *
+ * The type of the comparison function is a template parameter, so that a
+ * function object known at compile time (see NrMacSchedulerUeCompare) can be
+ * inlined in the heap operations; NrMacSchedulerUeHeap is the heap that
+ * uses a std::function.
+ */
+template <class Compare>
+class NrMacSchedulerUeHeapT
+{
+  public:
+    /**
+     * \brief The comparison function: returns true if the first UE has to be
+     * ordered before the second one
+     */
+    typedef Compare CompareUeFn;
+
+    /**
+     * \brief NrMacSchedulerUeHeapT constructor
+     * \param ues the UEs to order; the vector must outlive the heap, and its
+     * size must not change
+     * \param compare the comparison function
+     *
+     * The heap is created empty: call Build() to insert all the UEs.
+     */
+    NrMacSchedulerUeHeapT(const std::vector<NrMacSchedulerNs3::UePtrAndBufferReq>& ues,
+                          const CompareUeFn& compare)
+        : m_ues(ues),
+          m_compare(compare),
+          m_pos(ues.size(), NOT_IN_HEAP)
+    {
+        m_heap.reserve(ues.size());
+    }
+
+    /**
+     * \brief Insert all the UEs of the vector in the heap
+     */
+    void Build()
+    {
+        m_heap.clear();
+        for (std::size_t i = 0; i < m_ues.size(); ++i)
+        {
+            m_heap.push_back(i);
+        }
+        Rebuild();
+    }
+
+    /**
+     * \brief Restore the order of the UEs that are in the heap
+     *
+     * To be used when the metric of most of the UEs has changed: it costs O(n),
+     * while calling Update() for each UE costs O(n log n).
+     */
+    void Rebuild()
+    {
+        for (std::size_t i = 0; i < m_heap.size(); ++i)
+        {
+            m_pos[m_heap[i]] = i;
+        }
+        for (std::size_t i = m_heap.size() / 2; i > 0; --i)
+        {
+            SiftDown(i - 1);
+        }
+    }
+
+    /**
+     * \return true if there are no UEs in the heap
+     */
+    bool IsEmpty() const
+    {
+        return m_heap.empty();
+    }
+
+    /**
+     * \param idx index of the UE in the vector
+     * \return true if the UE is in the heap
+     */
+    bool Contains(std::size_t idx) const
+    {
+        return m_pos.at(idx) != NOT_IN_HEAP;
+    }
+
+    /**
+     * \return the index, in the vector, of the UE with the highest priority
+     */
+    std::size_t Top() const
+    {
+        NS_ASSERT(!m_heap.empty());
+        return m_heap.front();
+    }
+
+    /**
+     * \brief Remove the UE with the highest priority from the heap
+     */
+    void Pop()
+    {
+        NS_ASSERT(!m_heap.empty());
+        m_pos[m_heap.front()] = NOT_IN_HEAP;
+        m_heap.front() = m_heap.back();
+        m_heap.pop_back();
+        if (!m_heap.empty())
+        {
+            m_pos[m_heap.front()] = 0;
+            SiftDown(0);
+        }
+    }
+
+    /**
+     * \brief Restore the order after the metric of a UE has changed
+     * \param idx index of the UE in the vector
+     *
+     * If the UE is not in the heap, the call does nothing.
+     */
+    void Update(std::size_t idx)
+    {
+        if (!Contains(idx))
+        {
+            return;
+        }
+        std::size_t pos = m_pos[idx];
+        if (pos > 0 && Before(m_heap[pos], m_heap[(pos - 1) / 2]))
+        {
+            SiftUp(pos);
+        }
+        else
+        {
+            SiftDown(pos);
+        }
+    }
+
+  private:
+    /**
+     * \brief Strict ordering between two UEs, with ties broken by the index
+     * \param a index of the first UE
+     * \param b index of the second UE
+     * \return true if the UE a has to be ordered before the UE b
+     */
+    bool Before(std::size_t a, std::size_t b) const
+    {
+        if (m_compare(m_ues[a], m_ues[b]))
+        {
+            return true;
+        }
+        if (m_compare(m_ues[b], m_ues[a]))
+        {
+            return false;
+        }
+        return a < b;
+    }
+
+    /**
+     * \brief Move an element towards the top of the heap
+     * \param pos position of the element in the heap
+     */
+    void SiftUp(std::size_t pos)
+    {
+        while (pos > 0)
+        {
+            std::size_t parent = (pos - 1) / 2;
+            if (!Before(m_heap[pos], m_heap[parent]))
+            {
+                break;
+            }
+            Swap(pos, parent);
+            pos = parent;
+        }
+    }
+
+    /**
+     * \brief Move an element towards the bottom of the heap
+     * \param pos position of the element in the heap
+     */
+    void SiftDown(std::size_t pos)
+    {
+        const std::size_t size = m_heap.size();
+        while (true)
+        {
+            std::size_t best = pos;
+            std::size_t left = 2 * pos + 1;
+            std::size_t right = left + 1;
+            if (left < size && Before(m_heap[left], m_heap[best]))
+            {
+                best = left;
+            }
+            if (right < size && Before(m_heap[right], m_heap[best]))
+            {
+                best = right;
+            }
+            if (best == pos)
+            {
+                break;
+            }
+            Swap(pos, best);
+            pos = best;
+        }
+    }
+
+    /**
+     * \brief Swap two elements of the heap, updating their positions
+     * \param i position of the first element
+     * \param j position of the second element
+     */
+    void Swap(std::size_t i, std::size_t j)
+    {
+        std::swap(m_heap[i], m_heap[j]);
+        m_pos[m_heap[i]] = i;
+        m_pos[m_heap[j]] = j;
+    }
+
+    static constexpr std::size_t NOT_IN_HEAP =
+        std::numeric_limits<std::size_t>::max(); //!< Position of a UE outside the heap
+
+    const std::vector<NrMacSchedulerNs3::UePtrAndBufferReq>& m_ues; //!< The UEs to order
+    CompareUeFn m_compare;                                          //!< Comparison function
+    std::vector<std::size_t> m_heap; //!< The heap, as indexes of m_ues
+    std::vector<std::size_t> m_pos;  //!< Position in m_heap of each UE, or NOT_IN_HEAP
+};
+
+/**
+ * \ingroup scheduler
+ * \brief Heap of the UEs ordered by a std::function, as returned by the schedulers
+ */
+typedef NrMacSchedulerUeHeapT<std::function<bool(const NrMacSchedulerNs3::UePtrAndBufferReq& lhs,
+                                                 const NrMacSchedulerNs3::UePtrAndBufferReq& rhs)>>
+    NrMacSchedulerUeHeap;
+
+} // namespace ns3
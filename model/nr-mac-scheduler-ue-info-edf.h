@@ -0,0 +1,82 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include "nr-mac-scheduler-ue-info-qos.h"
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief UE representation for an earliest-deadline-first scheduler
+ *
+ * On top of the throughput values of NrMacSchedulerUeInfoQos, the
+ * representation stores the DL deadline of the UE, i.e., the earliest
+ * head-of-line deadline among its LCs, which the scheduler copies from its
+ * NrMacSchedulerDeadlineQueue before assigning the resources of a slot. The
+ * comparison is therefore O(1), whatever the number of LCs of the UE.
+ *
+ * \see CompareUeDeadlinesDl
+ */
+class NrMacSchedulerUeInfoEdf : public NrMacSchedulerUeInfoQos
+{
+  public:
+    /**
+     * \brief NrMacSchedulerUeInfoEdf constructor
+     * \param alpha PF fairness index
+     * \param rnti RNTI of the UE
+     * \param beamConfId BeamConfId of the UE
+     * \param fn A function that tells how many RB per RBG
+     */
+    NrMacSchedulerUeInfoEdf(float alpha,
+                            uint16_t rnti,
+                            BeamConfId beamConfId,
+                            const GetRbPerRbgFn& fn)
+        : NrMacSchedulerUeInfoQos(alpha, rnti, beamConfId, fn)
+    {
+    }
+
+    /**
+     * \brief comparison function object (i.e. an object that satisfies the
+     * requirements of Compare) which returns ​true if the first argument is less
+     * than (i.e. is ordered before) the second.
+     * \param lue Left UE
+     * \param rue Right UE
+     * \return true if the deadline of lue is earlier than the deadline of rue or,
+     * with the same deadline, if the PF metric of lue is higher
+     *
+     * The UEs without a deadline (Time::Max()) are ordered after the others,
+     * by their PF metric.
+     */
+    static bool CompareUeDeadlinesDl(const NrMacSchedulerNs3::UePtrAndBufferReq& lue,
+                                     const NrMacSchedulerNs3::UePtrAndBufferReq& rue)
+    {
+        auto luePtr = dynamic_cast<NrMacSchedulerUeInfoEdf*>(lue.first.get());
+        auto ruePtr = dynamic_cast<NrMacSchedulerUeInfoEdf*>(rue.first.get());
+
+        if (luePtr->m_dlDeadline != ruePtr->m_dlDeadline)
+        {
+            return luePtr->m_dlDeadline < ruePtr->m_dlDeadline;
+        }
+        return luePtr->GetDlPfMetric() > ruePtr->GetDlPfMetric();
+    }
+
+    /**
+     * \return the DL PF metric of the UE, used to order the UEs with the same deadline
+     *
+     * \f$ pfMetric = std::pow(potentialTPut, alpha) / std::max (1E-9, m_avgTput) \f$
+     */
+    double GetDlPfMetric() const
+    {
+        return std::pow(m_potentialTputDl, m_alpha) / std::max(1E-9, m_avgTputDl);
+    }
+
+    Time m_dlDeadline{Time::Max()}; //!< Earliest DL deadline of the LCs of the UE
+};
+
+} // namespace ns3
@@ -154,17 +154,28 @@ class NrMacSchedulerUeInfoPF : public NrMacSchedulerUeInfo
     static bool CompareUeWeightsDl(const NrMacSchedulerNs3::UePtrAndBufferReq& lue,
                                    const NrMacSchedulerNs3::UePtrAndBufferReq& rue)
     {
-        auto luePtr = dynamic_cast<NrMacSchedulerUeInfoPF*>(lue.first.get());
-        auto ruePtr = dynamic_cast<NrMacSchedulerUeInfoPF*>(rue.first.get());
-
-        double lPfMetric = std::pow(luePtr->m_potentialTputDl, luePtr->m_alpha) /
-                           std::max(1E-9, luePtr->m_avgTputDl);
-        double rPfMetric = std::pow(ruePtr->m_potentialTputDl, ruePtr->m_alpha) /
-                           std::max(1E-9, ruePtr->m_avgTputDl);
+        double lPfMetric = CalculateDlMetric(lue);
+        double rPfMetric = CalculateDlMetric(rue);
 
         return (lPfMetric > rPfMetric);
     }
 
+    /**
+     * \brief Calculate the DL PF metric of a UE
+     * \param ue the UE
+     * \return the PF metric used by CompareUeWeightsDl()
+     *
+     * The metric depends only on the UE: sorting the UEs by this value gives the
+     * order of CompareUeWeightsDl() (see NrMacSchedulerUeMirror).
+     */
+    static double CalculateDlMetric(const NrMacSchedulerNs3::UePtrAndBufferReq& ue)
+    {
+        auto uePtr = dynamic_cast<NrMacSchedulerUeInfoPF*>(ue.first.get());
+
+        return std::pow(uePtr->m_potentialTputDl, uePtr->m_alpha) /
+               std::max(1E-9, uePtr->m_avgTputDl);
+    }
+
     /**
      * \brief comparison function object (i.e. an object that satisfies the
      * requirements of Compare) which returns ​true if the first argument is less
@@ -183,17 +194,28 @@ class NrMacSchedulerUeInfoPF : public NrMacSchedulerUeInfo
     static bool CompareUeWeightsUl(const NrMacSchedulerNs3::UePtrAndBufferReq& lue,
                                    const NrMacSchedulerNs3::UePtrAndBufferReq& rue)
     {
-        auto luePtr = dynamic_cast<NrMacSchedulerUeInfoPF*>(lue.first.get());
-        auto ruePtr = dynamic_cast<NrMacSchedulerUeInfoPF*>(rue.first.get());
-
-        double lPfMetric = std::pow(luePtr->m_potentialTputUl, luePtr->m_alpha) /
-                           std::max(1E-9, luePtr->m_avgTputUl);
-        double rPfMetric = std::pow(ruePtr->m_potentialTputUl, ruePtr->m_alpha) /
-                           std::max(1E-9, ruePtr->m_avgTputUl);
+        double lPfMetric = CalculateUlMetric(lue);
+        double rPfMetric = CalculateUlMetric(rue);
 
         return (lPfMetric > rPfMetric);
     }
 
+    /**
+     * \brief Calculate the UL PF metric of a UE
+     * \param ue the UE
+     * \return the PF metric used by CompareUeWeightsUl()
+     *
+     * The metric depends only on the UE: sorting the UEs by this value gives the
+     * order of CompareUeWeightsUl() (see NrMacSchedulerUeMirror).
+     */
+    static double CalculateUlMetric(const NrMacSchedulerNs3::UePtrAndBufferReq& ue)
+    {
+        auto uePtr = dynamic_cast<NrMacSchedulerUeInfoPF*>(ue.first.get());
+
+        return std::pow(uePtr->m_potentialTputUl, uePtr->m_alpha) /
+               std::max(1E-9, uePtr->m_avgTputUl);
+    }
+
     double m_currTputDl{0.0};      //!< Current slot throughput in downlink
     double m_avgTputDl{0.0};       //!< Average throughput in downlink during all the slots
     double m_lastAvgTputDl{0.0};   //!< Last average throughput in downlink
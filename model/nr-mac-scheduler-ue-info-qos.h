@@ -237,20 +237,29 @@ class NrMacSchedulerUeInfoQos : public NrMacSchedulerUeInfo
     static bool CompareUeWeightsUl(const NrMacSchedulerNs3::UePtrAndBufferReq& lue,
                                    const NrMacSchedulerNs3::UePtrAndBufferReq& rue)
     {
-        auto luePtr = dynamic_cast<NrMacSchedulerUeInfoQos*>(lue.first.get());
-        auto ruePtr = dynamic_cast<NrMacSchedulerUeInfoQos*>(rue.first.get());
+        double lQoSMetric = CalculateUlWeight(lue);
+        double rQoSMetric = CalculateUlWeight(rue);
 
-        double leftP = CalculateUlMinPriority(lue);
-        double rightP = CalculateUlMinPriority(rue);
-        NS_ABORT_IF(leftP == 0);
-        NS_ABORT_IF(rightP == 0);
+        return (lQoSMetric > rQoSMetric);
+    }
 
-        double lQoSMetric = (100 - leftP) * std::pow(luePtr->m_potentialTputUl, luePtr->m_alpha) /
-                            std::max(1E-9, luePtr->m_avgTputUl);
-        double rQoSMetric = (100 - rightP) * std::pow(ruePtr->m_potentialTputUl, ruePtr->m_alpha) /
-                            std::max(1E-9, ruePtr->m_avgTputUl);
+    /**
+     * \brief Calculate the UL QoS metric of a UE
+     * \param ue the UE
+     * \return the QoS metric used by CompareUeWeightsUl()
+     *
+     * The metric depends only on the UE: sorting the UEs by this value gives the
+     * order of CompareUeWeightsUl() (see NrMacSchedulerUeMirror).
+     */
+    static double CalculateUlWeight(const NrMacSchedulerNs3::UePtrAndBufferReq& ue)
+    {
+        auto uePtr = dynamic_cast<NrMacSchedulerUeInfoQos*>(ue.first.get());
 
-        return (lQoSMetric > rQoSMetric);
+        double p = CalculateUlMinPriority(ue);
+        NS_ABORT_IF(p == 0);
+
+        return (100 - p) * std::pow(uePtr->m_potentialTputUl, uePtr->m_alpha) /
+               std::max(1E-9, uePtr->m_avgTputUl);
     }
 
     /**
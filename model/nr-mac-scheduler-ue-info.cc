@@ -136,6 +136,7 @@ NrMacSchedulerUeInfo::ResetDlSchedInfo()
     {
         it = 0;
     }
+    m_dlRbgIndexes.clear();
 }
 
 void
@@ -147,9 +148,57 @@ NrMacSchedulerUeInfo::ResetUlSchedInfo()
     m_ulTbSize = 0;
 }
 
+uint8_t
+NrMacSchedulerUeInfo::GetDlRbgMcs(uint8_t stream, uint32_t rbg) const
+{
+    if (stream < m_dlRbgMcs.size() && rbg < m_dlRbgMcs.at(stream).size())
+    {
+        return m_dlRbgMcs.at(stream).at(rbg);
+    }
+    return m_dlMcs.at(stream);
+}
+
+const std::vector<uint8_t>&
+NrMacSchedulerUeInfo::GetDlTxMcs() const
+{
+    return m_dlRbgMcs.empty() ? m_dlMcs : m_dlSbMcs;
+}
+
 void
 NrMacSchedulerUeInfo::UpdateDlMetric(const Ptr<const NrAmc>& amc)
 {
+    if (!m_dlRbgMcs.empty())
+    {
+        // A TB has a single MCS: with a SB CQI, it is the mean of the MCS of
+        // the assigned RBG (all of them, if the scheduler does not select the
+        // RBG), rounded down, corrected by the OLLA offset
+        m_dlSbMcs.resize(m_dlMcs.size());
+        for (std::size_t stream = 0; stream < m_dlMcs.size(); ++stream)
+        {
+            uint32_t sum = 0;
+            uint32_t count = 0;
+            if (m_dlRbgIndexes.empty())
+            {
+                count = static_cast<uint32_t>(m_dlRbgMcs.front().size());
+                for (uint32_t rbg = 0; rbg < count; ++rbg)
+                {
+                    sum += GetDlRbgMcs(stream, rbg);
+                }
+            }
+            else
+            {
+                count = static_cast<uint32_t>(m_dlRbgIndexes.size());
+                for (const auto rbg : m_dlRbgIndexes)
+                {
+                    sum += GetDlRbgMcs(stream, rbg);
+                }
+            }
+            m_dlSbMcs.at(stream) = count > 0 ? m_dlOlla.Adjust(static_cast<uint8_t>(sum / count))
+                                             : m_dlMcs.at(stream);
+        }
+    }
+    const std::vector<uint8_t>& dlMcs = GetDlTxMcs();
+
     if (m_dlRBG == 0)
     {
         for (auto& it : m_dlTbSize)
@@ -162,11 +211,11 @@ NrMacSchedulerUeInfo::UpdateDlMetric(const Ptr<const NrAmc>& amc)
         switch (m_dlCqi.m_ri)
         {
         case 1:
-            if (m_dlMcs.size() == 1)
+            if (dlMcs.size() == 1)
             {
                 // the UE supports only one stream, i.e., max 1 stream
-                NS_ABORT_MSG_IF(m_dlMcs.at(0) == 255, "DL MCS " << +m_dlMcs.at(0) << " is invalid");
-                m_dlTbSize.at(0) = amc->CalculateTbSize(m_dlMcs.at(0), m_dlRBG * GetNumRbPerRbg());
+                NS_ABORT_MSG_IF(dlMcs.at(0) == 255, "DL MCS " << +dlMcs.at(0) << " is invalid");
+                m_dlTbSize.at(0) = amc->CalculateTbSize(dlMcs.at(0), m_dlRBG * GetNumRbPerRbg());
             }
             else
             {
@@ -185,7 +234,7 @@ NrMacSchedulerUeInfo::UpdateDlMetric(const Ptr<const NrAmc>& amc)
                 {
                     if (stream == maxCqiIndex)
                     {
-                        uint8_t mcs = m_dlMcs.at(stream);
+                        uint8_t mcs = dlMcs.at(stream);
                         NS_ASSERT_MSG(mcs != UINT8_MAX,
                                       "Invalid MCS " << +mcs << " for CQI "
                                                      << +m_dlCqi.m_wbCqi.at(stream)
@@ -203,18 +252,18 @@ NrMacSchedulerUeInfo::UpdateDlMetric(const Ptr<const NrAmc>& amc)
             }
             break;
         case 2:
-            NS_ASSERT_MSG(m_dlMcs.at(0) != UINT8_MAX,
-                          "Invalid MCS " << +m_dlMcs.at(0) << " for CQI " << +m_dlCqi.m_wbCqi.at(0)
+            NS_ASSERT_MSG(dlMcs.at(0) != UINT8_MAX,
+                          "Invalid MCS " << +dlMcs.at(0) << " for CQI " << +m_dlCqi.m_wbCqi.at(0)
                                          << " for stream 0");
-            NS_ASSERT_MSG(m_dlMcs.at(1) != UINT8_MAX,
-                          "Invalid MCS " << +m_dlMcs.at(1) << " for CQI " << +m_dlCqi.m_wbCqi.at(1)
+            NS_ASSERT_MSG(dlMcs.at(1) != UINT8_MAX,
+                          "Invalid MCS " << +dlMcs.at(1) << " for CQI " << +m_dlCqi.m_wbCqi.at(1)
                                          << " for stream 1");
-            NS_ABORT_MSG_IF(m_dlMcs.size() < 2, "No MCS computed to be used for the second stream");
+            NS_ABORT_MSG_IF(dlMcs.size() < 2, "No MCS computed to be used for the second stream");
 
-            m_dlTbSize.at(0) = amc->CalculateTbSize(m_dlMcs.at(0), m_dlRBG * GetNumRbPerRbg());
+            m_dlTbSize.at(0) = amc->CalculateTbSize(dlMcs.at(0), m_dlRBG * GetNumRbPerRbg());
 
             // we have the MCS to be used for the 2nd stream
-            m_dlTbSize.at(1) = amc->CalculateTbSize(m_dlMcs.at(1), m_dlRBG * GetNumRbPerRbg());
+            m_dlTbSize.at(1) = amc->CalculateTbSize(dlMcs.at(1), m_dlRBG * GetNumRbPerRbg());
             break;
         default:
             NS_FATAL_ERROR("Rank indicator value of " << +m_dlCqi.m_ri << " is not supported");
@@ -11,6 +11,7 @@
 #include "nr-mac-harq-vector.h"
 #include "nr-mac-sched-sap.h"
 #include "nr-mac-scheduler-lcg.h"
+#include "nr-mac-scheduler-olla.h"
 
 #include <algorithm>
 #include <functional>
@@ -218,6 +219,20 @@ class NrMacSchedulerUeInfo
      */
     virtual void ResetUlMetric();
 
+    /**
+     * \brief Get the DL MCS of a stream on a RBG
+     * \param stream the stream
+     * \param rbg the index of the RBG
+     * \return the MCS of the SB CQI, or the WB one if there is no SB CQI
+     */
+    uint8_t GetDlRbgMcs(uint8_t stream, uint32_t rbg) const;
+
+    /**
+     * \brief Get the DL MCS to transmit with, per stream
+     * \return m_dlMcs, or m_dlSbMcs with a SB CQI
+     */
+    const std::vector<uint8_t>& GetDlTxMcs() const;
+
     /**
      * \brief Received CQI information
      */
@@ -235,8 +250,7 @@ class NrMacSchedulerUeInfo
         std::vector<double> m_sinr;   //!< Vector of SINR for the entire band
         std::vector<int16_t> m_rbCqi; //!< CQI for each Rsc Block, set to -1 if SINR < Threshold
         uint8_t m_cqi{0};             //!< CQI reported value
-        uint32_t m_timer{
-            0}; //!< Timer (in slot number). When the timer is 0, the value is discarded
+        uint32_t m_timer{0};          //!< Validity of the value (in slots); 0 once expired
     };
 
     /**
@@ -256,8 +270,7 @@ class NrMacSchedulerUeInfo
         uint8_t m_ri{0}; //!< The rank indicator, by default UE would have only one stream
         std::vector<double> m_sinr;   //!< Vector of SINR for the entire band
         std::vector<uint8_t> m_wbCqi; //!< CQI for each stream
-        uint32_t m_timer{
-            0}; //!< Timer (in slot number). When the timer is 0, the value is discarded
+        uint32_t m_timer{0};          //!< Validity of the value (in slots); 0 once expired
     };
 
     uint16_t m_rnti{0};      //!< RNTI of the UE
@@ -277,7 +290,15 @@ class NrMacSchedulerUeInfo
 
     std::vector<uint8_t> m_dlMcs; //!< DL MCS per stream, it is initialized with a starting MCS upon
                                   //!< UE addition to gNB and the scheduler
+    std::vector<uint8_t> m_dlCqiMcs; //!< DL MCS per stream from the WB CQI, before the OLLA offset
+    std::vector<std::vector<uint8_t>> m_dlRbgMcs; //!< DL MCS per stream and RBG, from the SB CQI;
+                                                  //!< empty without a valid SB CQI
+    std::vector<uint8_t> m_dlSbMcs; //!< DL MCS per stream on the assigned RBG, with a SB CQI,
+                                    //!< updated in UpdateDlMetric()
+    std::vector<uint32_t> m_dlRbgIndexes; //!< DL RBG assigned in this slot, when the scheduler
+                                          //!< selects them (SB CQI); empty otherwise
     uint8_t m_ulMcs{0};           //!< UL MCS
+    uint8_t m_ulCqiMcs{0};        //!< UL MCS from the CQI, before the OLLA offset
 
     std::vector<uint32_t> m_dlTbSize{0}; //!< DL Transport Block Size per stream, depends on MCS and
                                          //!< RBG, updated in UpdateDlMetric()
@@ -290,6 +311,22 @@ class NrMacSchedulerUeInfo
     NrMacHarqVector m_dlHarq; //!< HARQ process vector for DL
     NrMacHarqVector m_ulHarq; //!< HARQ process vector for UL
 
+    NrMacSchedulerOlla m_dlOlla; //!< Outer-loop link adaptation of the DL MCS
+    NrMacSchedulerOlla m_ulOlla; //!< Outer-loop link adaptation of the UL MCS
+
+    /**
+     * \brief A configured grant of the UE, with its activation state
+     */
+    struct ConfiguredGrant
+    {
+        NrConfiguredGrant m_config; //!< Resources and MCS of the grant
+        uint8_t m_harqId{255};      //!< HARQ process reserved for the grant, 255 if none
+        bool m_active{false};       //!< True once the activation DCI has been scheduled
+        bool m_release{false};      //!< True once removed: the next occasion has the release DCI
+    };
+
+    std::vector<ConfiguredGrant> m_configuredGrants; //!< Configured grants of the UE
+
     uint32_t m_srsPeriodicity{0}; //!< SRS periodicity
     uint32_t m_srsOffset{0};      //!< SRS offset
     uint8_t m_startMcsDlUe{0};    //!< Starting DL MCS to be used
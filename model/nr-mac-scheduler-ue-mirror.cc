@@ -0,0 +1,57 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "nr-mac-scheduler-ue-mirror.h"
+
+#include <ns3/assert.h>
+
+#include <algorithm>
+
+namespace ns3
+{
+
+uint64_t
+NrMacSchedulerUeMirror::PackMcs(const std::vector<uint8_t>& mcs)
+{
+    // Each stream takes 9 bits, starting from the most significant ones, and
+    // counts from 1, so that a missing stream is lower than any MCS: the packed
+    // values compare as the vectors, in lexicographical order
+    NS_ASSERT_MSG(mcs.size() <= 7, "Too many streams to pack their MCS: " << mcs.size());
+    uint64_t packed = 0;
+    for (std::size_t i = 0; i < mcs.size(); ++i)
+    {
+        packed |= (static_cast<uint64_t>(mcs[i]) + 1) << (9 * (6 - i));
+    }
+    return packed;
+}
+
+void
+NrMacSchedulerUeMirror::Resize(std::size_t size)
+{
+    // resize() keeps the capacity: the arrays are allocated only when the
+    // number of UEs grows
+    m_mcs.resize(size);
+    m_rbg.resize(size);
+    m_metric.resize(size);
+    m_order.resize(size);
+}
+
+void
+NrMacSchedulerUeMirror::Rearrange(std::vector<UePtrAndBufferReq>* ues)
+{
+    m_scratch.clear();
+    m_scratch.reserve(ues->size());
+    for (const auto row : m_order)
+    {
+        m_scratch.emplace_back(std::move((*ues)[row]));
+    }
+    // The UEs are moved back, instead of swapping the vectors, so that the
+    // iterators of the caller stay valid, as with std::sort
+    std::move(m_scratch.begin(), m_scratch.end(), ues->begin());
+    m_scratch.clear();
+}
+
+} // namespace ns3
@@ -0,0 +1,105 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include "nr-mac-scheduler-ns3.h"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief A structure-of-arrays copy of the fields used to order the UEs
+ *
+ * The UEs of the scheduler are separate objects, reached through a pointer:
+ * sorting them with their comparison function means following two pointers
+ * for each comparison, and, for PF and QoS, calculating the metric of both UEs
+ * again, with a std::pow each. The mirror loads, once per sort, the fields
+ * that the comparison reads in contiguous arrays, one per field, with a row
+ * per UE; the metric is calculated once per UE, when the row is loaded. The
+ * rows are then sorted by index, and the vector of UEs is rearranged in the
+ * resulting order.
+ *
+ * The order is the same as the one of std::sort with the comparison function
+ * of the UEs, provided that the comparison of the rows gives the same result
+ * as the comparison of the UEs: std::sort takes the same steps for any two
+ * sequences that compare in the same way. The loading and the comparison of
+ * the rows are defined by the policies of nr-mac-scheduler-policy.h, which use
+ * the mirror when the scheduler (NrMacSchedulerStatic) has the attribute
+ * UeStateMirror set. A scheduler owns one mirror, reused at each sort, so
+ * that the arrays are allocated only when the number of UEs grows.
+ *
+ * Only the fields read by the comparison functions are mirrored; a policy
+ * loads the ones it needs, and ignores the others.
+ */
+class NrMacSchedulerUeMirror
+{
+  public:
+    using UePtrAndBufferReq = NrMacSchedulerNs3::UePtrAndBufferReq; //!< UE and its buffer
+
+    /**
+     * \brief Sort the UEs, through the mirror
+     * \param ues the UEs to sort
+     * \param load the function that loads a row, as load(mirror, row, ue)
+     * \param compare the comparison of two rows, as compare(mirror, lhs, rhs)
+     */
+    template <class Load, class Compare>
+    void Sort(std::vector<UePtrAndBufferReq>* ues, const Load& load, const Compare& compare)
+    {
+        Resize(ues->size());
+        for (uint32_t row = 0; row < ues->size(); ++row)
+        {
+            load(this, row, (*ues)[row]);
+        }
+        std::iota(m_order.begin(), m_order.end(), 0);
+        std::sort(m_order.begin(), m_order.end(), [this, &compare](uint32_t lhs, uint32_t rhs) {
+            return compare(*this, lhs, rhs);
+        });
+        Rearrange(ues);
+    }
+
+    /**
+     * \return the number of rows loaded by the last sort
+     */
+    std::size_t GetSize() const
+    {
+        return m_order.size();
+    }
+
+    /**
+     * \brief Pack the MCS of the streams of a UE in a single value
+     * \param mcs the MCS of each stream
+     * \return a value that compares with the ones of the other UEs as the vectors do
+     */
+    static uint64_t PackMcs(const std::vector<uint8_t>& mcs);
+
+    std::vector<uint64_t> m_mcs;  //!< MCS of the UE (packed with PackMcs() in DL)
+    std::vector<uint32_t> m_rbg;  //!< RBG assigned to the UE in the slot
+    std::vector<double> m_metric; //!< Metric of the UE (e.g., the PF or the QoS one)
+
+  private:
+    /**
+     * \brief Resize the arrays
+     * \param size the number of rows
+     */
+    void Resize(std::size_t size);
+
+    /**
+     * \brief Put the UEs in the order of the sorted rows
+     * \param ues the UEs
+     */
+    void Rearrange(std::vector<UePtrAndBufferReq>* ues);
+
+    std::vector<uint32_t> m_order;            //!< Rows, in the order of the UEs
+    std::vector<UePtrAndBufferReq> m_scratch; //!< Storage to rearrange the UEs
+};
+
+} // namespace ns3
@@ -124,6 +124,11 @@ class NrMacGeneralSchedSapProvider : public NrMacSchedSapProvider
         m_scheduler->DoSchedDlRachInfoReq(params);
     }
 
+    void SchedDlMiniSlotReq(const SchedDlMiniSlotReqParameters& params) override
+    {
+        m_scheduler->DoSchedDlMiniSlotReq(params);
+    }
+
     uint8_t GetDlCtrlSyms() const override
     {
         return m_scheduler->GetDlCtrlSyms();
@@ -134,6 +139,16 @@ class NrMacGeneralSchedSapProvider : public NrMacSchedSapProvider
         return m_scheduler->GetUlCtrlSyms();
     };
 
+    uint64_t GetDlBufferSize() const override
+    {
+        return m_scheduler->GetDlBufferSize();
+    }
+
+    uint64_t GetUlBufferSize() const override
+    {
+        return m_scheduler->GetUlBufferSize();
+    }
+
   private:
     NrMacScheduler* m_scheduler{nullptr};
 };
@@ -216,6 +216,13 @@ class NrMacScheduler : public Object
     virtual void DoSchedDlRachInfoReq(
         const NrMacSchedSapProvider::SchedDlRachInfoReqParameters& params) = 0;
 
+    /**
+     * \brief A DL mini-slot of the current slot is available
+     * \param params the mini-slot opportunity
+     */
+    virtual void DoSchedDlMiniSlotReq(
+        const NrMacSchedSapProvider::SchedDlMiniSlotReqParameters& params) = 0;
+
     /**
      * \brief Retrieve the number of DL ctrl symbols configured in the scheduler
      * \return the number of DL ctrl symbols
@@ -228,6 +235,18 @@ class NrMacScheduler : public Object
      */
     virtual uint8_t GetUlCtrlSyms() const = 0;
 
+    /**
+     * \brief Retrieve the bytes waiting in the DL RLC buffers of the UEs
+     * \return the bytes of the DL buffers known by the scheduler
+     */
+    virtual uint64_t GetDlBufferSize() const = 0;
+
+    /**
+     * \brief Retrieve the bytes waiting in the UL buffers of the UEs
+     * \return the bytes of the UL buffers reported by the BSR and not yet scheduled
+     */
+    virtual uint64_t GetUlBufferSize() const = 0;
+
     /**
      * Assign a fixed random variable stream number to the random variables
      * used by this model.  Return the number of streams (possibly zero) that
@@ -24,6 +24,7 @@
 #include <map>
 #include <memory>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace ns3
@@ -207,10 +208,10 @@ struct DciInfoElementTdma
           m_format(format),
           m_symStart(symStart),
           m_numSym(numSym),
-          m_mcs(mcs),
-          m_tbSize(tbs),
-          m_ndi(ndi),
-          m_rv(rv),
+          m_mcs(std::move(mcs)),
+          m_tbSize(std::move(tbs)),
+          m_ndi(std::move(ndi)),
+          m_rv(std::move(rv)),
           m_type(type),
           m_bwpIndex(bwpIndex),
           m_tpc(tpc)
@@ -236,8 +237,8 @@ struct DciInfoElementTdma
           m_numSym(numSym),
           m_mcs(o.m_mcs),
           m_tbSize(o.m_tbSize),
-          m_ndi(ndi),
-          m_rv(rv),
+          m_ndi(std::move(ndi)),
+          m_rv(std::move(rv)),
           m_type(o.m_type),
           m_bwpIndex(o.m_bwpIndex),
           m_harqProcess(o.m_harqProcess),
@@ -261,6 +262,51 @@ struct DciInfoElementTdma
     uint8_t m_harqProcess{0};         //!< HARQ process id
     std::vector<uint8_t> m_rbgBitmask{}; //!< RBG mask: 0 if the RBG is not used, 1 otherwise
     const uint8_t m_tpc{0};              //!< Tx power control command
+    uint8_t m_layer{0}; //!< MU-MIMO layer: the DL DCIs with the same symbols and a different
+                        //!< layer are transmitted at the same time, on different beams
+    uint16_t m_cgPeriodicity{0}; //!< Periodicity, in slots, of the configured grant of this
+                                 //!< allocation; 0 for a dynamic allocation
+    bool m_cgOccasion{false}; //!< True for the occasions of an active configured grant, which
+                              //!< are not signalled by a DCI
+    bool m_cgRelease{false};  //!< True for the DCI that releases (deactivates) the configured
+                              //!< grant of its HARQ process; it carries no data
+    bool m_miniSlot{false}; //!< True for a DL allocation in a mini-slot of the current slot,
+                            //!< which is signalled by the PDCCH of the mini-slot
+};
+
+/**
+ * \ingroup utils
+ * \brief A configured grant: periodic resources of a UE, in DL (semi-persistent
+ * scheduling) or UL, that are signalled by a single activation DCI
+ *
+ * The occasions are the slots whose absolute number, modulo the periodicity,
+ * is equal to the offset. In each occasion, the grant occupies the symbols
+ * from m_symStart to m_symStart + m_numSym - 1 over the entire bandwidth,
+ * with the MCS m_mcs. The first occasion that the scheduler uses is signalled
+ * by a DCI with a non-zero DciInfoElementTdma::m_cgPeriodicity, which activates
+ * the grant at the UE; the following occasions have no DCI. The grant is
+ * deactivated by a DCI with DciInfoElementTdma::m_cgRelease, in the symbols
+ * of the next occasion after its removal.
+ */
+struct NrConfiguredGrant
+{
+    DciInfoElementTdma::DciFormat m_format{DciInfoElementTdma::UL}; //!< DL (SPS) or UL
+    uint8_t m_lcId{3};          //!< LC served by the grant in DL (in UL, the UE chooses)
+    uint16_t m_periodicity{10}; //!< Periodicity of the occasions, in slots
+    uint16_t m_offset{0};       //!< Slot of the occasions in the period
+    uint8_t m_symStart{0};      //!< First symbol of the grant in the slot
+    uint8_t m_numSym{1};        //!< Number of symbols of the grant
+    uint8_t m_mcs{0};           //!< MCS of the grant
+
+    /**
+     * \brief Check if a slot is an occasion of the grant
+     * \param sfnSf the slot
+     * \return true if the grant has an occasion in the slot
+     */
+    bool IsOccasion(const SfnSf& sfnSf) const
+    {
+        return sfnSf.Normalize() % m_periodicity == m_offset;
+    }
 };
 
 /**
@@ -399,6 +445,9 @@ struct DlCqiInfo
 
     std::vector<uint8_t> m_wbCqi; //!< WB CQI for each MIMO stream
     uint8_t m_wbPmi{0};           //!< The reported wideband pre-coding matrix index
+
+    std::vector<std::vector<uint8_t>> m_sbCqi; //!< SB CQI for each MIMO stream and subband
+    uint16_t m_sbSize{0};                      //!< Number of RB of a subband (SB CQI only)
 };
 
 /**
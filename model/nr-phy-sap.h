@@ -196,6 +196,18 @@ class NrGnbPhySapUser
      */
     virtual void SlotUlIndication(const SfnSf& sfn, LteNrTddSlotType slotType) = 0;
 
+    /**
+     * \brief Offer a DL mini-slot of the current slot to the MAC
+     *
+     * If the MAC uses it, the allocation arrives immediately, for the current
+     * slot, through NrPhySapProvider::SetSlotAllocInfo.
+     *
+     * \param sfn The current slot
+     * \param symStart First symbol of the mini-slot
+     * \param numSym Number of symbols of the mini-slot
+     */
+    virtual void MiniSlotDlIndication(const SfnSf& sfn, uint8_t symStart, uint8_t numSym) = 0;
+
     // We do a DL and then manually add an UL CTRL if it's an S slot.
     // virtual void SlotSIndication (const SfnSf &sfn) = 0;
     // We do UL and then DL to model an F slot.
@@ -253,6 +265,18 @@ class NrGnbPhySapUser
      * \return the DL CTRL symbols
      */
     virtual uint8_t GetDlCtrlSymbols() const = 0;
+
+    /**
+     * \brief Retrieve the bytes waiting in the DL buffers known by the scheduler
+     * \return the bytes of the DL buffers
+     */
+    virtual uint64_t GetDlBufferSize() const = 0;
+
+    /**
+     * \brief Retrieve the bytes waiting in the UL buffers known by the scheduler
+     * \return the bytes of the UL buffers
+     */
+    virtual uint64_t GetUlBufferSize() const = 0;
 };
 
 /**
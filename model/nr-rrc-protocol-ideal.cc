@@ -7,13 +7,12 @@
 #include "nr-rrc-protocol-ideal.h"
 
 #include "nr-gnb-net-device.h"
-#include "nr-ue-net-device.h"
 
 #include "ns3/lte-enb-rrc.h"
 #include "ns3/lte-ue-rrc.h"
+#include <ns3/abort.h>
 #include <ns3/fatal-error.h>
 #include <ns3/log.h>
-#include <ns3/node-list.h>
 #include <ns3/node.h>
 #include <ns3/nstime.h>
 #include <ns3/simulator.h>
@@ -25,6 +24,38 @@ namespace ns3
 
 static const Time RRC_IDEAL_MSG_DELAY = MilliSeconds(0);
 
+/**
+ * Node ID and device index of a device: the order of the devices in the
+ * NodeList, in which the gNBs and the UEs were found by walking it
+ */
+typedef std::pair<uint32_t, uint32_t> NrRrcIdealDeviceKey;
+
+/// The ideal RRC protocols of the gNBs, by the cell ID of each of their BWPs
+static std::map<uint16_t, std::map<NrRrcIdealDeviceKey, NrGnbRrcProtocolIdeal*>> g_gnbByCellId;
+
+/// The ideal RRC protocols of the UEs, by the cell ID on which their RRC is camped
+static std::map<uint16_t, std::map<NrRrcIdealDeviceKey, nrUeRrcProtocolIdeal*>> g_ueByCellId;
+
+/// The ideal RRC protocols of the UEs whose device was not set: they are not in the registry
+static uint32_t g_numUesWithoutDevice = 0;
+
+/**
+ * \brief Remove a UE from the registry of a cell
+ * \param cellId the cell ID
+ * \param deviceKey the key of the UE
+ */
+static void
+EraseUeFromCell(uint16_t cellId, const NrRrcIdealDeviceKey& deviceKey)
+{
+    auto it = g_ueByCellId.find(cellId);
+    NS_ASSERT(it != g_ueByCellId.end());
+    it->second.erase(deviceKey);
+    if (it->second.empty())
+    {
+        g_ueByCellId.erase(it);
+    }
+}
+
 NS_OBJECT_ENSURE_REGISTERED(nrUeRrcProtocolIdeal);
 
 nrUeRrcProtocolIdeal::nrUeRrcProtocolIdeal()
@@ -32,16 +63,19 @@ nrUeRrcProtocolIdeal::nrUeRrcProtocolIdeal()
       m_enbRrcSapProvider(nullptr)
 {
     m_ueRrcSapUser = new MemberLteUeRrcSapUser<nrUeRrcProtocolIdeal>(this);
+    ++g_numUesWithoutDevice;
 }
 
 nrUeRrcProtocolIdeal::~nrUeRrcProtocolIdeal()
 {
+    Release();
 }
 
 void
 nrUeRrcProtocolIdeal::DoDispose()
 {
     NS_LOG_FUNCTION(this);
+    Release();
     delete m_ueRrcSapUser;
     m_rrc = nullptr;
 }
@@ -73,6 +107,114 @@ nrUeRrcProtocolIdeal::SetUeRrc(Ptr<LteUeRrc> rrc)
     m_rrc = rrc;
 }
 
+Ptr<LteUeRrc>
+nrUeRrcProtocolIdeal::GetUeRrc() const
+{
+    return m_rrc;
+}
+
+void
+nrUeRrcProtocolIdeal::SetUeNetDevice(const Ptr<NetDevice>& dev)
+{
+    NS_LOG_FUNCTION(this << dev);
+    NS_ABORT_MSG_IF(m_rrc == nullptr, "The UE RRC must be set before the device");
+    NS_ABORT_MSG_IF(m_hasDevice, "The UE device can be set only once");
+    m_hasDevice = true;
+    --g_numUesWithoutDevice;
+    m_deviceKey = std::make_pair(dev->GetNode()->GetId(), dev->GetIfIndex());
+    m_registered = true;
+    m_campedCellId = m_rrc->GetCellId();
+    g_ueByCellId[m_campedCellId].emplace(m_deviceKey, this);
+
+    m_rrc->TraceConnectWithoutContext(
+        "StateTransition",
+        MakeCallback(&nrUeRrcProtocolIdeal::RrcStateTransition, this));
+    m_rrc->TraceConnectWithoutContext("HandoverStart",
+                                      MakeCallback(&nrUeRrcProtocolIdeal::RrcHandoverStart, this));
+}
+
+void
+nrUeRrcProtocolIdeal::RrcStateTransition(uint64_t imsi,
+                                         uint16_t cellId,
+                                         uint16_t rnti,
+                                         LteUeRrc::State oldState,
+                                         LteUeRrc::State newState)
+{
+    NS_LOG_FUNCTION(this << imsi << cellId << rnti);
+    // The RRC enters CONNECTED_HANDOVER before taking the target cell, which
+    // is already known from the HandoverStart trace
+    if (newState != LteUeRrc::CONNECTED_HANDOVER)
+    {
+        if (m_handover)
+        {
+            EraseUeFromCell(m_handoverCellId, m_deviceKey);
+            m_handover = false;
+        }
+        SetCampedCellId(m_rrc->GetCellId());
+    }
+}
+
+void
+nrUeRrcProtocolIdeal::RrcHandoverStart(uint64_t imsi,
+                                       uint16_t cellId,
+                                       uint16_t rnti,
+                                       uint16_t targetCellId)
+{
+    NS_LOG_FUNCTION(this << imsi << cellId << rnti << targetCellId);
+    if (!m_registered || m_handover || targetCellId == m_campedCellId)
+    {
+        return;
+    }
+    // Until the handover ends, the UE is also under the target cell: the
+    // delivery of the system information checks the cell of the RRC, which
+    // can take the target cell at any time during the handover
+    m_handoverCellId = targetCellId;
+    m_handover = true;
+    g_ueByCellId[m_handoverCellId].emplace(m_deviceKey, this);
+}
+
+void
+nrUeRrcProtocolIdeal::SetCampedCellId(uint16_t cellId)
+{
+    if (!m_registered || cellId == m_campedCellId)
+    {
+        return;
+    }
+    NS_LOG_LOGIC("UE IMSI " << m_rrc->GetImsi() << " moves from cellId " << m_campedCellId
+                            << " to cellId " << cellId);
+    Unregister();
+    m_registered = true;
+    m_campedCellId = cellId;
+    g_ueByCellId[m_campedCellId].emplace(m_deviceKey, this);
+}
+
+void
+nrUeRrcProtocolIdeal::Unregister()
+{
+    if (!m_registered)
+    {
+        return;
+    }
+    EraseUeFromCell(m_campedCellId, m_deviceKey);
+    if (m_handover)
+    {
+        EraseUeFromCell(m_handoverCellId, m_deviceKey);
+        m_handover = false;
+    }
+    m_registered = false;
+}
+
+void
+nrUeRrcProtocolIdeal::Release()
+{
+    if (!m_hasDevice)
+    {
+        m_hasDevice = true;
+        --g_numUesWithoutDevice;
+    }
+    Unregister();
+}
+
 void
 nrUeRrcProtocolIdeal::DoSetup(LteUeRrcSapUser::SetupParameters params)
 {
@@ -162,36 +304,17 @@ nrUeRrcProtocolIdeal::DoSendIdealUeContextRemoveRequest(uint16_t rnti)
 void
 nrUeRrcProtocolIdeal::SetEnbRrcSapProvider()
 {
+    NS_ABORT_MSG_IF(!m_registered,
+                    "The UE is not in the registry of the ideal RRC protocols: "
+                    "SetUeNetDevice() was not called");
     uint16_t bwpId = m_rrc->GetCellId();
+    SetCampedCellId(bwpId);
 
-    // walk list of all nodes to get the peer gNB
-    Ptr<NrGnbNetDevice> gnbDev;
-    NodeList::Iterator listEnd = NodeList::End();
-    bool found = false;
-    for (NodeList::Iterator i = NodeList::Begin(); (i != listEnd) && (!found); ++i)
-    {
-        Ptr<Node> node = *i;
-        int nDevs = node->GetNDevices();
-        for (int j = 0; (j < nDevs) && (!found); j++)
-        {
-            gnbDev = node->GetDevice(j)->GetObject<NrGnbNetDevice>();
-            if (gnbDev != nullptr)
-            {
-                for (uint32_t h = 0; h < gnbDev->GetCcMapSize(); ++h)
-                {
-                    if (gnbDev->GetBwpId(h) == bwpId)
-                    {
-                        found = true;
-                        break;
-                    }
-                }
-            }
-        }
-    }
-    NS_ASSERT_MSG(found, " Unable to find gNB with BwpID =" << bwpId);
-    m_enbRrcSapProvider = gnbDev->GetRrc()->GetLteEnbRrcSapProvider();
-    Ptr<NrGnbRrcProtocolIdeal> enbRrcProtocolIdeal =
-        gnbDev->GetRrc()->GetObject<NrGnbRrcProtocolIdeal>();
+    // the first gNB with this BwpID, in the order of the NodeList
+    auto it = g_gnbByCellId.find(bwpId);
+    NS_ABORT_MSG_IF(it == g_gnbByCellId.end(), "Unable to find gNB with BwpID = " << bwpId);
+    NrGnbRrcProtocolIdeal* enbRrcProtocolIdeal = it->second.begin()->second;
+    m_enbRrcSapProvider = enbRrcProtocolIdeal->GetLteEnbRrcSapProvider();
     enbRrcProtocolIdeal->SetUeRrcSapProvider(m_rnti, m_ueRrcSapProvider);
 }
 
@@ -207,12 +330,14 @@ NrGnbRrcProtocolIdeal::NrGnbRrcProtocolIdeal()
 NrGnbRrcProtocolIdeal::~NrGnbRrcProtocolIdeal()
 {
     NS_LOG_FUNCTION(this);
+    Unregister();
 }
 
 void
 NrGnbRrcProtocolIdeal::DoDispose()
 {
     NS_LOG_FUNCTION(this);
+    Unregister();
     delete m_enbRrcSapUser;
 }
 
@@ -237,6 +362,41 @@ NrGnbRrcProtocolIdeal::GetLteEnbRrcSapUser()
     return m_enbRrcSapUser;
 }
 
+LteEnbRrcSapProvider*
+NrGnbRrcProtocolIdeal::GetLteEnbRrcSapProvider() const
+{
+    return m_enbRrcSapProvider;
+}
+
+void
+NrGnbRrcProtocolIdeal::SetGnbNetDevice(const Ptr<NrGnbNetDevice>& dev)
+{
+    NS_LOG_FUNCTION(this << dev);
+    NS_ABORT_MSG_IF(!m_cellIds.empty(), "The gNB device can be set only once");
+    m_deviceKey = std::make_pair(dev->GetNode()->GetId(), dev->GetIfIndex());
+    for (uint32_t h = 0; h < dev->GetCcMapSize(); ++h)
+    {
+        m_cellIds.push_back(dev->GetBwpId(h));
+        g_gnbByCellId[m_cellIds.back()].emplace(m_deviceKey, this);
+    }
+}
+
+void
+NrGnbRrcProtocolIdeal::Unregister()
+{
+    for (const auto cellId : m_cellIds)
+    {
+        auto it = g_gnbByCellId.find(cellId);
+        NS_ASSERT(it != g_gnbByCellId.end());
+        it->second.erase(m_deviceKey);
+        if (it->second.empty())
+        {
+            g_gnbByCellId.erase(it);
+        }
+    }
+    m_cellIds.clear();
+}
+
 LteUeRrcSapProvider*
 NrGnbRrcProtocolIdeal::GetUeRrcSapProvider(uint16_t rnti)
 {
@@ -273,30 +433,35 @@ void
 NrGnbRrcProtocolIdeal::DoSendSystemInformation(uint16_t cellId, LteRrcSap::SystemInformation msg)
 {
     NS_LOG_FUNCTION(this << cellId);
-    // walk list of all nodes to get UEs with this cellId
-    Ptr<LteUeRrc> ueRrc;
-    for (NodeList::Iterator i = NodeList::Begin(); i != NodeList::End(); ++i)
+    NS_ABORT_MSG_IF(g_numUesWithoutDevice > 0,
+                    g_numUesWithoutDevice << " UE(s) are not in the registry of the ideal RRC "
+                                             "protocols: SetUeNetDevice() was not called");
+    auto it = g_ueByCellId.find(cellId);
+    if (it == g_ueByCellId.end())
+    {
+        return;
+    }
+
+    // the UEs camped on this cellId, in the order of the NodeList; copied, as
+    // the reception of the SI can move a UE to another cell
+    std::vector<Ptr<LteUeRrc>> ueRrcs;
+    ueRrcs.reserve(it->second.size());
+    for (const auto& ue : it->second)
+    {
+        ueRrcs.push_back(ue.second->GetUeRrc());
+    }
+    for (const auto& ueRrc : ueRrcs)
     {
-        Ptr<Node> node = *i;
-        int nDevs = node->GetNDevices();
-        for (int j = 0; j < nDevs; ++j)
+        NS_LOG_LOGIC("considering UE IMSI " << ueRrc->GetImsi() << " that has cellId "
+                                            << ueRrc->GetCellId());
+        if (ueRrc->GetCellId() == cellId)
         {
-            Ptr<NrUeNetDevice> nrUeDev = node->GetDevice(j)->GetObject<NrUeNetDevice>();
-            if (nrUeDev)
-            {
-                Ptr<LteUeRrc> ueRrc = nrUeDev->GetRrc();
-                NS_LOG_LOGIC("considering UE IMSI " << nrUeDev->GetImsi() << " that has cellId "
-                                                    << ueRrc->GetCellId());
-                if (ueRrc->GetCellId() == cellId)
-                {
-                    NS_LOG_LOGIC("sending SI to IMSI " << nrUeDev->GetImsi());
-                    ueRrc->GetLteUeRrcSapProvider()->RecvSystemInformation(msg);
-                    Simulator::Schedule(RRC_IDEAL_MSG_DELAY,
-                                        &LteUeRrcSapProvider::RecvSystemInformation,
-                                        ueRrc->GetLteUeRrcSapProvider(),
-                                        msg);
-                }
-            }
+            NS_LOG_LOGIC("sending SI to IMSI " << ueRrc->GetImsi());
+            ueRrc->GetLteUeRrcSapProvider()->RecvSystemInformation(msg);
+            Simulator::Schedule(RRC_IDEAL_MSG_DELAY,
+                                &LteUeRrcSapProvider::RecvSystemInformation,
+                                ueRrc->GetLteUeRrcSapProvider(),
+                                msg);
         }
     }
 }
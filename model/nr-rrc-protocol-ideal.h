@@ -8,11 +8,14 @@
 #define NR_RRC_PROTOCOL_IDEAL_H
 
 #include <ns3/lte-rrc-sap.h>
+#include <ns3/lte-ue-rrc.h>
 #include <ns3/object.h>
 #include <ns3/ptr.h>
 
 #include <map>
 #include <stdint.h>
+#include <utility>
+#include <vector>
 
 namespace ns3
 {
@@ -21,6 +24,8 @@ class LteUeRrcSapProvider;
 class LteUeRrcSapUser;
 class LteEnbRrcSapProvider;
 class LteUeRrc;
+class NetDevice;
+class NrGnbNetDevice;
 
 /**
  * \ingroup ue
@@ -32,6 +37,13 @@ class LteUeRrc;
  * an ideal fashion, without errors and without consuming any radio
  * resources.
  *
+ * The UE finds the gNB of its cell, and the gNBs find the UEs camped on
+ * their cells, through a registry of the ideal RRC protocols indexed by cell
+ * ID, instead of walking the NodeList. The UE is kept in the registry under
+ * the cell on which its RRC is camped, which is updated at every state
+ * transition and handover of the RRC. During a handover, the UE is under both
+ * the source and the target cell, and receives the system information of the
+ * one its RRC is on.
  */
 class nrUeRrcProtocolIdeal : public Object
 {
@@ -72,6 +84,20 @@ class nrUeRrcProtocolIdeal : public Object
      */
     void SetUeRrc(Ptr<LteUeRrc> rrc);
 
+    /**
+     * \return the UE RRC
+     */
+    Ptr<LteUeRrc> GetUeRrc() const;
+
+    /**
+     * \brief Insert the UE in the registry of the ideal RRC protocols
+     * \param dev the UE device, already added to its node
+     *
+     * The UE is ordered by the ID of its node and the index of the device, as
+     * in the NodeList. To be called after SetUeRrc().
+     */
+    void SetUeNetDevice(const Ptr<NetDevice>& dev);
+
   private:
     // methods forwarded from LteUeRrcSapUser
     void DoSetup(LteUeRrcSapUser::SetupParameters params);
@@ -97,11 +123,56 @@ class nrUeRrcProtocolIdeal : public Object
 
     void SetEnbRrcSapProvider();
 
+    /**
+     * \brief Follow the state transitions of the RRC, which can change its cell
+     * \param imsi the IMSI of the UE
+     * \param cellId the cell ID
+     * \param rnti the RNTI of the UE
+     * \param oldState the previous state
+     * \param newState the new state
+     */
+    void RrcStateTransition(uint64_t imsi,
+                            uint16_t cellId,
+                            uint16_t rnti,
+                            LteUeRrc::State oldState,
+                            LteUeRrc::State newState);
+
+    /**
+     * \brief Follow the start of a handover, which changes the cell of the RRC
+     * \param imsi the IMSI of the UE
+     * \param cellId the source cell ID
+     * \param rnti the RNTI of the UE
+     * \param targetCellId the target cell ID
+     */
+    void RrcHandoverStart(uint64_t imsi, uint16_t cellId, uint16_t rnti, uint16_t targetCellId);
+
+    /**
+     * \brief Move the UE, in the registry, to the cell on which it is camped
+     * \param cellId the cell ID
+     */
+    void SetCampedCellId(uint16_t cellId);
+
+    /**
+     * \brief Remove the UE from the registry
+     */
+    void Unregister();
+
+    /**
+     * \brief Remove the UE from the registry, or from the UEs without device
+     */
+    void Release();
+
     Ptr<LteUeRrc> m_rrc;
     uint16_t m_rnti;
     LteUeRrcSapProvider* m_ueRrcSapProvider;
     LteUeRrcSapUser* m_ueRrcSapUser;
     LteEnbRrcSapProvider* m_enbRrcSapProvider;
+    std::pair<uint32_t, uint32_t> m_deviceKey; //!< Node ID and device index of the UE
+    uint16_t m_campedCellId{0};                //!< Cell of the UE in the registry
+    bool m_registered{false};                  //!< True if the UE is in the registry
+    bool m_hasDevice{false};                   //!< True if the UE device was set
+    uint16_t m_handoverCellId{0};              //!< Target cell of the ongoing handover
+    bool m_handover{false}; //!< True if the UE is also in the registry of the target cell
 };
 
 /**
@@ -125,6 +196,21 @@ class NrGnbRrcProtocolIdeal : public Object
     void SetLteEnbRrcSapProvider(LteEnbRrcSapProvider* p);
     LteEnbRrcSapUser* GetLteEnbRrcSapUser();
 
+    /**
+     * \return the SAP provider of the gNB RRC, to which the UEs send their messages
+     */
+    LteEnbRrcSapProvider* GetLteEnbRrcSapProvider() const;
+
+    /**
+     * \brief Insert the cells of the gNB in the registry of the ideal RRC protocols
+     * \param dev the gNB device, already added to its node
+     *
+     * A cell is registered for the BWP ID of each BWP of the device; the gNBs
+     * are ordered by the ID of their node and the index of the device, as in
+     * the NodeList.
+     */
+    void SetGnbNetDevice(const Ptr<NrGnbNetDevice>& dev);
+
     LteUeRrcSapProvider* GetUeRrcSapProvider(uint16_t rnti);
     void SetUeRrcSapProvider(uint16_t rnti, LteUeRrcSapProvider* p);
 
@@ -149,10 +235,17 @@ class NrGnbRrcProtocolIdeal : public Object
     Ptr<Packet> DoEncodeHandoverCommand(LteRrcSap::RrcConnectionReconfiguration msg);
     LteRrcSap::RrcConnectionReconfiguration DoDecodeHandoverCommand(Ptr<Packet> p);
 
+    /**
+     * \brief Remove the cells of the gNB from the registry
+     */
+    void Unregister();
+
     uint16_t m_rnti;
     LteEnbRrcSapProvider* m_enbRrcSapProvider;
     LteEnbRrcSapUser* m_enbRrcSapUser;
     std::map<uint16_t, LteUeRrcSapProvider*> m_enbRrcSapProviderMap;
+    std::pair<uint32_t, uint32_t> m_deviceKey; //!< Node ID and device index of the gNB
+    std::vector<uint16_t> m_cellIds;           //!< Cells of the gNB in the registry
 };
 
 } // namespace ns3
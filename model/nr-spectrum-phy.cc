@@ -450,6 +450,15 @@ NrSpectrumPhy::StartRx(Ptr<SpectrumSignalParameters> params)
         if (nrDataRxParams->cellId == GetCellId() &&
             nrDataRxParams->txPhy->GetObject<NrSpectrumPhy>()->GetStreamId() == m_streamId)
         {
+            if (!m_isEnb && nrDataRxParams->muMimoLayer &&
+                !HasPacketsFor(nrDataRxParams->packetBurst,
+                               DynamicCast<NrUePhy>(m_phy)->GetRnti()))
+            {
+                // The layer is for the other UEs of a MU-MIMO transmission: it
+                // has been added to the interference, and nothing else
+                NS_LOG_INFO("MU-MIMO layer for other UEs, considered as interference");
+                return;
+            }
             StartRxData(nrDataRxParams);
             if (!m_isEnb and m_enableDlDataPathlossTrace)
             {
@@ -572,7 +581,8 @@ NrSpectrumPhy::StartRx(Ptr<SpectrumSignalParameters> params)
 void
 NrSpectrumPhy::StartTxDataFrames(const Ptr<PacketBurst>& pb,
                                  const std::list<Ptr<NrControlMessage>>& ctrlMsgList,
-                                 Time duration)
+                                 Time duration,
+                                 bool muMimoLayer)
 {
     NS_LOG_FUNCTION(this);
     switch (m_state)
@@ -587,48 +597,22 @@ NrSpectrumPhy::StartTxDataFrames(const Ptr<PacketBurst>& pb,
         NS_FATAL_ERROR("Cannot TX while RX.");
         break;
     case TX:
-        NS_FATAL_ERROR("Cannot TX while already TX.");
+        // The layers of a MU-MIMO transmission start together, and last the same
+        NS_ABORT_MSG_UNLESS(muMimoLayer && m_txLayersStart == Simulator::Now() &&
+                                m_txLayersDuration == duration,
+                            "Cannot TX while already TX.");
+        NS_LOG_INFO("Transmitting another layer of a MU-MIMO transmission");
+        SendDataFrames(pb, ctrlMsgList, duration, muMimoLayer);
         break;
     case CCA_BUSY:
         NS_LOG_WARN("Start transmitting DATA while in CCA_BUSY state.");
         /* no break */
     case IDLE: {
-        NS_ASSERT(m_txPsd);
-
         ChangeState(TX, duration);
-
-        Ptr<NrSpectrumSignalParametersDataFrame> txParams =
-            Create<NrSpectrumSignalParametersDataFrame>();
-        txParams->duration = duration;
-        txParams->txPhy = this->GetObject<SpectrumPhy>();
-        txParams->psd = m_txPsd;
-        txParams->packetBurst = pb;
-        txParams->cellId = GetCellId();
-        txParams->ctrlMsgList = ctrlMsgList;
-
-        /* This section is used for trace */
-        if (m_isEnb)
-        {
-            GnbPhyPacketCountParameter traceParam;
-            traceParam.m_noBytes = (txParams->packetBurst) ? txParams->packetBurst->GetSize() : 0;
-            traceParam.m_cellId = txParams->cellId;
-            traceParam.m_isTx = true;
-            traceParam.m_subframeno = 0; // TODO extend this
-
-            m_txPacketTraceEnb(traceParam);
-        }
-
+        m_txLayersStart = Simulator::Now();
+        m_txLayersDuration = duration;
         m_txDataTrace(duration);
-
-        if (m_channel)
-        {
-            m_channel->StartTx(txParams);
-        }
-        else
-        {
-            NS_LOG_WARN("Working without channel (i.e., under test)");
-        }
-
+        SendDataFrames(pb, ctrlMsgList, duration, muMimoLayer);
         Simulator::Schedule(duration, &NrSpectrumPhy::EndTx, this);
     }
     break;
@@ -637,6 +621,47 @@ NrSpectrumPhy::StartTxDataFrames(const Ptr<PacketBurst>& pb,
     }
 }
 
+void
+NrSpectrumPhy::SendDataFrames(const Ptr<PacketBurst>& pb,
+                              const std::list<Ptr<NrControlMessage>>& ctrlMsgList,
+                              Time duration,
+                              bool muMimoLayer)
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(m_txPsd);
+
+    Ptr<NrSpectrumSignalParametersDataFrame> txParams =
+        Create<NrSpectrumSignalParametersDataFrame>();
+    txParams->duration = duration;
+    txParams->txPhy = this->GetObject<SpectrumPhy>();
+    txParams->psd = m_txPsd;
+    txParams->packetBurst = pb;
+    txParams->cellId = GetCellId();
+    txParams->ctrlMsgList = ctrlMsgList;
+    txParams->muMimoLayer = muMimoLayer;
+
+    /* This section is used for trace */
+    if (m_isEnb)
+    {
+        GnbPhyPacketCountParameter traceParam;
+        traceParam.m_noBytes = (txParams->packetBurst) ? txParams->packetBurst->GetSize() : 0;
+        traceParam.m_cellId = txParams->cellId;
+        traceParam.m_isTx = true;
+        traceParam.m_subframeno = 0; // TODO extend this
+
+        m_txPacketTraceEnb(traceParam);
+    }
+
+    if (m_channel)
+    {
+        m_channel->StartTx(txParams);
+    }
+    else
+    {
+        NS_LOG_WARN("Working without channel (i.e., under test)");
+    }
+}
+
 void
 NrSpectrumPhy::StartTxDlControlFrames(const std::list<Ptr<NrControlMessage>>& ctrlMsgList,
                                       const Time& duration)
@@ -919,6 +944,43 @@ NrSpectrumPhy::AddExpectedTb(uint16_t rnti,
                 << static_cast<uint32_t>(symStart) << " numSym=" << static_cast<uint32_t>(numSym));
 }
 
+bool
+NrSpectrumPhy::PreemptExpectedTb(uint16_t rnti, const SfnSf& sfn, uint8_t symStart, uint8_t numSym)
+{
+    NS_LOG_FUNCTION(this << rnti << +symStart << +numSym);
+    NS_ASSERT(!m_isEnb);
+
+    auto it = m_transportBlocks.find(rnti);
+    if (it == m_transportBlocks.end())
+    {
+        return false;
+    }
+
+    const auto& expected = it->second.m_expected;
+    if (!expected.m_isDownlink || it->second.m_harqFeedbackSent || !(expected.m_sfn == sfn) ||
+        expected.m_symStart >= symStart + numSym ||
+        expected.m_symStart + expected.m_numSym <= symStart)
+    {
+        return false;
+    }
+
+    NS_LOG_INFO("TB of rnti " << rnti << " at symbols " << +expected.m_symStart << "-"
+                              << expected.m_symStart + expected.m_numSym - 1
+                              << " preempted, harqId " << +expected.m_harqProcessId);
+
+    DynamicCast<NrUePhy>(m_phy)->NotifyDlHarqFeedback(m_streamId,
+                                                     DlHarqInfo::NACK,
+                                                     expected.m_harqProcessId,
+                                                     expected.m_rv);
+    if (expected.m_rv == 3)
+    {
+        m_harqPhyModule->ResetDlHarqProcessStatus(rnti, expected.m_harqProcessId);
+    }
+
+    m_transportBlocks.erase(it);
+    return true;
+}
+
 void
 NrSpectrumPhy::AddExpectedSrsRnti(uint16_t rnti)
 {
@@ -1039,6 +1101,24 @@ NrSpectrumPhy::StartRxData(const Ptr<NrSpectrumSignalParametersDataFrame>& param
     }
 }
 
+bool
+NrSpectrumPhy::HasPacketsFor(const Ptr<PacketBurst>& pb, uint16_t rnti)
+{
+    if (pb == nullptr)
+    {
+        return false;
+    }
+    for (const auto& packet : pb->GetPackets())
+    {
+        LteRadioBearerTag bearerTag;
+        if (packet->PeekPacketTag(bearerTag) && bearerTag.GetRnti() == rnti)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 void
 NrSpectrumPhy::StartRxDlCtrl(const Ptr<NrSpectrumSignalParametersDlCtrlFrame>& params)
 {
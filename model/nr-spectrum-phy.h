@@ -252,10 +252,13 @@ class NrSpectrumPhy : public SpectrumPhy
      * \param pb packet burst to be transmitted
      * \param ctrlMsgList control message list
      * \param duration the duration of transmission
+     * \param muMimoLayer whether the transmission is a layer of a DL MU-MIMO
+     * transmission: the other layers start at the same time, with the same duration
      */
     void StartTxDataFrames(const Ptr<PacketBurst>& pb,
                            const std::list<Ptr<NrControlMessage>>& ctrlMsgList,
-                           Time duration);
+                           Time duration,
+                           bool muMimoLayer = false);
     /**
      * \brief Starts transmission of DL CTRL
      * \param duration the duration of this transmission
@@ -402,6 +405,20 @@ class NrSpectrumPhy : public SpectrumPhy
                        uint8_t numSym,
                        const SfnSf& sfn);
 
+    /**
+     * \brief Discard the expected DL TB of a UE, if a mini-slot preempted its symbols
+     * \param rnti RNTI
+     * \param sfn the slot of the preemption
+     * \param symStart first preempted symbol
+     * \param numSym number of preempted symbols
+     * \return true if a TB was discarded
+     *
+     * A TB that overlaps the preempted symbols is reported as NACK, without
+     * waiting for the end of its reception. Its soft bits are flushed, so the
+     * HARQ history of the process is not updated with this transmission.
+     */
+    bool PreemptExpectedTb(uint16_t rnti, const SfnSf& sfn, uint8_t symStart, uint8_t numSym);
+
     /**
      * Assign a fixed random variable stream number to the random variables
      * used by this model.  Return the number of streams (possibly zero) that
@@ -555,6 +572,24 @@ class NrSpectrumPhy : public SpectrumPhy
      * used to update spectrum phy state.
      */
     void EndTx();
+    /**
+     * \brief Send a data frame on the channel, with the current TX PSD
+     * \param pb packet burst to be transmitted
+     * \param ctrlMsgList control message list
+     * \param duration the duration of transmission
+     * \param muMimoLayer whether the transmission is a layer of a DL MU-MIMO transmission
+     */
+    void SendDataFrames(const Ptr<PacketBurst>& pb,
+                        const std::list<Ptr<NrControlMessage>>& ctrlMsgList,
+                        Time duration,
+                        bool muMimoLayer);
+    /**
+     * \brief Check if a packet burst carries packets for a UE
+     * \param pb the packet burst
+     * \param rnti the RNTI of the UE
+     * \return true if at least a packet of the burst is for the UE
+     */
+    static bool HasPacketsFor(const Ptr<PacketBurst>& pb, uint16_t rnti);
     /**
      * \brief Function that is called when the spectrum phy finishes the reception of DATA. This
      * function processed the data being received and generated HARQ feedback.
@@ -705,8 +740,10 @@ class NrSpectrumPhy : public SpectrumPhy
 
     Time m_firstRxStart{
         Seconds(0)}; //!< this is needed to save the time at which we lock down onto signal
-    Time m_firstRxDuration{Seconds(0)}; //!< the duration of the current reception
-    State m_state{IDLE};                //!< spectrum phy state
+    Time m_firstRxDuration{Seconds(0)};  //!< the duration of the current reception
+    Time m_txLayersStart{Seconds(-1)};   //!< the start of the current transmission
+    Time m_txLayersDuration{Seconds(0)}; //!< the duration of the current transmission
+    State m_state{IDLE};                 //!< spectrum phy state
     SpectrumValue m_sinrPerceived; //!< SINR that is being update at the end of the DATA reception
                                    //!< and is used for TB decoding
     std::list<SrsSinrReportCallback> m_srsSinrReportCallback; //!< list of SRS SINR callbacks
@@ -33,6 +33,7 @@ NrSpectrumSignalParametersDataFrame::NrSpectrumSignalParametersDataFrame(
         packetBurst = p.packetBurst->Copy();
     }
     ctrlMsgList = p.ctrlMsgList;
+    muMimoLayer = p.muMimoLayer;
 }
 
 Ptr<SpectrumSignalParameters>
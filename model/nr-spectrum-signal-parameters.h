@@ -44,6 +44,8 @@ struct NrSpectrumSignalParametersDataFrame : public SpectrumSignalParameters
     Ptr<PacketBurst> packetBurst;                 //!< Packet burst
     std::list<Ptr<NrControlMessage>> ctrlMsgList; //!< List of contrl messages
     uint16_t cellId;                              //!< CellId
+    bool muMimoLayer{false}; //!< A layer of a DL MU-MIMO transmission, with other layers at the
+                             //!< same time: it is interference for the UEs of the other layers
 };
 
 /**
@@ -0,0 +1,178 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "nr-tdd-adaptation.h"
+
+#include <ns3/abort.h>
+#include <ns3/double.h>
+#include <ns3/log.h>
+
+#include <cmath>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("NrTddAdaptation");
+NS_OBJECT_ENSURE_REGISTERED(NrTddAdaptation);
+
+TypeId
+NrTddAdaptation::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::NrTddAdaptation")
+            .SetParent<Object>()
+            .SetGroupName("nr")
+            .AddConstructor<NrTddAdaptation>()
+            .AddAttribute("Hysteresis",
+                          "Minimum reduction of the distance between the UL share of the "
+                          "pattern and the UL share of the load to switch pattern",
+                          DoubleValue(0.1),
+                          MakeDoubleAccessor(&NrTddAdaptation::m_hysteresis),
+                          MakeDoubleChecker<double>(0.0, 1.0))
+            .AddAttribute("Smoothing",
+                          "Weight of a new load report in the smoothed load of a cell",
+                          DoubleValue(0.3),
+                          MakeDoubleAccessor(&NrTddAdaptation::m_smoothing),
+                          MakeDoubleChecker<double>(0.0, 1.0));
+    return tid;
+}
+
+NrTddAdaptation::NrTddAdaptation()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+NrTddAdaptation::~NrTddAdaptation()
+{
+}
+
+void
+NrTddAdaptation::AddPattern(const std::vector<LteNrTddSlotType>& pattern)
+{
+    NS_LOG_FUNCTION(this);
+    NS_ABORT_MSG_IF(pattern.empty(), "Empty TDD pattern");
+    NS_ABORT_MSG_IF(pattern.front() == LteNrTddSlotType::UL,
+                    "The first slot of a pattern cannot be a UL slot");
+    m_patterns.push_back(pattern);
+}
+
+const std::vector<std::vector<LteNrTddSlotType>>&
+NrTddAdaptation::GetPatterns() const
+{
+    return m_patterns;
+}
+
+void
+NrTddAdaptation::ReportLoad(uint16_t cellId, uint64_t dlBytes, uint64_t ulBytes)
+{
+    NS_LOG_FUNCTION(this << cellId << dlBytes << ulBytes);
+
+    auto it = m_loads.find(cellId);
+    if (it == m_loads.end())
+    {
+        m_loads[cellId] = {static_cast<double>(dlBytes), static_cast<double>(ulBytes)};
+        return;
+    }
+    it->second.m_dlBytes = m_smoothing * dlBytes + (1 - m_smoothing) * it->second.m_dlBytes;
+    it->second.m_ulBytes = m_smoothing * ulBytes + (1 - m_smoothing) * it->second.m_ulBytes;
+}
+
+const std::vector<LteNrTddSlotType>&
+NrTddAdaptation::SelectPattern(uint32_t frame)
+{
+    NS_LOG_FUNCTION(this << frame);
+    NS_ABORT_MSG_IF(m_patterns.empty(), "No TDD pattern to select");
+
+    if (m_selectedOnce && frame == m_lastFrame)
+    {
+        return m_patterns.at(m_selected);
+    }
+    m_selectedOnce = true;
+    m_lastFrame = frame;
+
+    double dlBytes = 0.0;
+    double ulBytes = 0.0;
+    for (const auto& load : m_loads)
+    {
+        dlBytes += load.second.m_dlBytes;
+        ulBytes += load.second.m_ulBytes;
+    }
+    if (dlBytes + ulBytes <= 0.0)
+    {
+        return m_patterns.at(m_selected);
+    }
+
+    const double ulLoadShare = ulBytes / (dlBytes + ulBytes);
+    std::size_t best = m_selected;
+    double bestDistance = std::abs(GetUlShare(m_patterns.at(m_selected)) - ulLoadShare);
+    const double currentDistance = bestDistance;
+    for (std::size_t i = 0; i < m_patterns.size(); ++i)
+    {
+        const double distance = std::abs(GetUlShare(m_patterns.at(i)) - ulLoadShare);
+        if (distance < bestDistance)
+        {
+            best = i;
+            bestDistance = distance;
+        }
+    }
+
+    if (best != m_selected && currentDistance - bestDistance > m_hysteresis)
+    {
+        NS_LOG_INFO("Frame " << frame << " UL share of the load " << ulLoadShare
+                             << ", switch from pattern " << m_selected << " to pattern " << best);
+        m_selected = best;
+    }
+
+    return m_patterns.at(m_selected);
+}
+
+std::vector<LteNrTddSlotType>
+NrTddAdaptation::GetTransitionPattern(const std::vector<LteNrTddSlotType>& current,
+                                      const std::vector<LteNrTddSlotType>& next,
+                                      uint32_t slotsPerFrame,
+                                      uint32_t switchFrame)
+{
+    NS_ABORT_MSG_IF(current.empty() || slotsPerFrame % current.size() != 0,
+                    "The size of the current pattern must divide the slots of a frame");
+    NS_ABORT_MSG_IF(next.empty() || slotsPerFrame % next.size() != 0,
+                    "The size of the next pattern must divide the slots of a frame");
+
+    // The normalized number of the first slot of a frame is frame * slotsPerFrame,
+    // so a frame takes the quarter (frame % 4) of the transition pattern
+    const uint32_t numFrames = 2 * SWITCH_DELAY;
+    std::vector<LteNrTddSlotType> transition(numFrames * slotsPerFrame);
+    for (uint32_t i = 0; i < numFrames; ++i)
+    {
+        // Frame switchFrame - SWITCH_DELAY + i, without wrapping below 0
+        const uint32_t offset = ((switchFrame + SWITCH_DELAY + i) % numFrames) * slotsPerFrame;
+        const auto& pattern = i < SWITCH_DELAY ? current : next;
+        for (uint32_t slot = 0; slot < slotsPerFrame; ++slot)
+        {
+            transition[offset + slot] = pattern[slot % pattern.size()];
+        }
+    }
+    return transition;
+}
+
+double
+NrTddAdaptation::GetUlShare(const std::vector<LteNrTddSlotType>& pattern)
+{
+    double ulSlots = 0.0;
+    for (const auto& slotType : pattern)
+    {
+        if (slotType == LteNrTddSlotType::UL)
+        {
+            ulSlots += 1.0;
+        }
+        else if (slotType == LteNrTddSlotType::F)
+        {
+            ulSlots += 0.5;
+        }
+    }
+    return pattern.empty() ? 0.0 : ulSlots / pattern.size();
+}
+
+} // namespace ns3
@@ -0,0 +1,145 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include "nr-control-messages.h"
+
+#include <ns3/object.h>
+
+#include <map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup gnb-phy
+ * \brief Selection of the TDD pattern of the gNBs from their buffer load
+ *
+ * The entity holds a set of TDD patterns, and at every frame boundary the gNB
+ * PHY reports the bytes waiting in the DL and UL buffers known by its
+ * scheduler (ReportLoad()), and asks which pattern to use (SelectPattern()).
+ * The selected pattern is the one whose share of UL slots (an F slot counts
+ * as half UL) is the closest to the share of UL bytes in the smoothed load.
+ * To avoid oscillations, the current pattern is kept unless the distance of
+ * the best one is smaller by more than the "Hysteresis" attribute.
+ *
+ * The selection is done once per frame, and it is shared by all the gNBs
+ * that use the same entity: installing an entity in a group of neighbouring
+ * gNBs makes them switch together, to the pattern that matches the load of the
+ * whole group, so that a gNB never transmits in DL while a neighbour receives
+ * in UL (cross-link interference). An entity per gNB adapts each cell to its
+ * own load.
+ *
+ * The first slot of each pattern must not be a UL slot, since the gNB
+ * announces the switch to the UEs in the DL CTRL of the first slot of a frame.
+ *
+ * \see NrGnbPhy::SetTddAdaptation
+ */
+class NrTddAdaptation : public Object
+{
+  public:
+    /**
+     * \brief GetTypeId
+     * \return the TypeId of the Object
+     */
+    static TypeId GetTypeId();
+
+    /**
+     * \brief NrTddAdaptation constructor
+     */
+    NrTddAdaptation();
+
+    /**
+     * \brief ~NrTddAdaptation deconstructor
+     */
+    ~NrTddAdaptation() override;
+
+    /**
+     * \brief Add a pattern to the set of patterns that can be selected
+     * \param pattern the TDD pattern
+     *
+     * The first pattern added is the one selected without load.
+     */
+    void AddPattern(const std::vector<LteNrTddSlotType>& pattern);
+
+    /**
+     * \return the patterns that can be selected
+     */
+    const std::vector<std::vector<LteNrTddSlotType>>& GetPatterns() const;
+
+    /**
+     * \brief Report the load of a cell
+     * \param cellId the cell ID
+     * \param dlBytes the bytes waiting in the DL buffers
+     * \param ulBytes the bytes waiting in the UL buffers
+     */
+    void ReportLoad(uint16_t cellId, uint64_t dlBytes, uint64_t ulBytes);
+
+    /**
+     * \brief Select the pattern for the frames to come
+     * \param frame the current frame number
+     * \return the selected pattern
+     *
+     * The first call in a frame does the selection with the load reported so
+     * far; the following calls in the same frame return the same pattern.
+     */
+    const std::vector<LteNrTddSlotType>& SelectPattern(uint32_t frame);
+
+    /**
+     * \brief Build the pattern used around a switch of pattern
+     * \param current the pattern of the frames before the switch
+     * \param next the pattern of the frames from the switch
+     * \param slotsPerFrame the number of slots in a frame
+     * \param switchFrame the first frame with the next pattern
+     * \return a pattern of four frames, to be indexed by the normalized slot
+     * number modulo its size, that has the types of the current pattern in
+     * the two frames before the switch, and the types of the next pattern in
+     * the two frames from the switch
+     *
+     * The sizes of both patterns must divide the number of slots in a frame.
+     * The DCI and the HARQ feedback structures generated from this pattern
+     * are used in the two frames before the switch: a slot schedules the
+     * slots up to two frames ahead (DCI, data, HARQ feedback) with their
+     * right type, even when they are after the switch. From the frame of the
+     * switch, the structures of the next pattern are used.
+     */
+    static std::vector<LteNrTddSlotType> GetTransitionPattern(
+        const std::vector<LteNrTddSlotType>& current,
+        const std::vector<LteNrTddSlotType>& next,
+        uint32_t slotsPerFrame,
+        uint32_t switchFrame);
+
+    static constexpr uint32_t SWITCH_DELAY = 2; //!< Frames between the selection and the switch
+
+    /**
+     * \param pattern a TDD pattern
+     * \return the share of UL slots in the pattern, counting the F slots as half
+     */
+    static double GetUlShare(const std::vector<LteNrTddSlotType>& pattern);
+
+  private:
+    /**
+     * \brief Smoothed load of a cell
+     */
+    struct Load
+    {
+        double m_dlBytes{0.0}; //!< Smoothed bytes in the DL buffers
+        double m_ulBytes{0.0}; //!< Smoothed bytes in the UL buffers
+    };
+
+    std::vector<std::vector<LteNrTddSlotType>> m_patterns; //!< Patterns that can be selected
+    std::map<uint16_t, Load> m_loads;                      //!< Load of each cell
+
+    std::size_t m_selected{0};  //!< Index of the selected pattern
+    bool m_selectedOnce{false}; //!< True after the first selection
+    uint32_t m_lastFrame{0};    //!< Frame of the last selection
+    double m_hysteresis{0.1};   //!< Minimum improvement of the UL share to switch
+    double m_smoothing{0.3};    //!< Weight of a new load report in the smoothed load
+};
+
+} // namespace ns3
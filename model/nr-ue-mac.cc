@@ -22,6 +22,7 @@
 #include <ns3/log.h>
 #include <ns3/lte-radio-bearer-tag.h>
 #include <ns3/random-variable-stream.h>
+#include <ns3/simulator.h>
 #include <ns3/uinteger.h>
 
 namespace ns3
@@ -390,7 +391,7 @@ NrUeMac::DoReportBufferStatus(LteMacSapProvider::ReportBufferStatusParameters pa
         it = m_ulBsrReceived.insert(std::make_pair(params.lcid, params)).first;
     }
 
-    if (m_srState == INACTIVE)
+    if (m_srState == INACTIVE && !m_ulConfiguredGrant)
     {
         NS_LOG_INFO("INACTIVE -> TO_SEND, bufSize " << GetTotalBufSize());
         m_srState = TO_SEND;
@@ -620,12 +621,31 @@ NrUeMac::ProcessUlDci(const Ptr<NrUlDciMessage>& dciMsg)
     SfnSf dataSfn = m_currentSlot;
     dataSfn.Add(dciMsg->GetKDelay());
 
+    if (dciMsg->GetDciInfoElement()->m_cgRelease)
+    {
+        // The new data waits again for a SR
+        NS_LOG_INFO("UL configured grant released from slot " << dataSfn);
+        m_ulConfiguredGrant = false;
+        m_macRxedCtrlMsgsTrace(m_currentSlot, GetCellId(), m_rnti, GetBwpId(), dciMsg);
+        return;
+    }
+
     // Saving the data we need in DoTransmitPdu
     m_ulDciSfnsf = dataSfn;
     m_ulDciTotalUsed = 0;
     m_ulDci = dciMsg->GetDciInfoElement();
 
-    m_macRxedCtrlMsgsTrace(m_currentSlot, GetCellId(), m_rnti, GetBwpId(), dciMsg);
+    // Only the activation DCI: the occasions may follow a release
+    if (m_ulDci->m_cgPeriodicity > 0 && !m_ulDci->m_cgOccasion)
+    {
+        m_ulConfiguredGrant = true;
+    }
+
+    // The occasions of a configured grant were not received from the gNB
+    if (!m_ulDci->m_cgOccasion)
+    {
+        m_macRxedCtrlMsgsTrace(m_currentSlot, GetCellId(), m_rnti, GetBwpId(), dciMsg);
+    }
 
     NS_LOG_INFO("UL DCI received, transmit data in slot "
                 << dataSfn << " Harq Process " << +m_ulDci->m_harqProcess << " TBS "
@@ -1035,10 +1055,28 @@ NrUeMac::DoConfigureRach([[maybe_unused]] LteUeCmacSapProvider::RachConfig rc)
     NS_LOG_FUNCTION(this);
 }
 
+void
+NrUeMac::SetFastAttachCallback(const FastAttachCallback& cb)
+{
+    NS_LOG_FUNCTION(this);
+    m_fastAttachCallback = cb;
+}
+
 void
 NrUeMac::DoStartContentionBasedRandomAccessProcedure()
 {
     NS_LOG_FUNCTION(this);
+    if (!m_fastAttachCallback.IsNull())
+    {
+        // The RNTI comes from the gNB; the RRC gets it after the end of
+        // this call, as it would get a RAR
+        BuildRarListElement_s raResponse;
+        raResponse.m_rnti = m_fastAttachCallback();
+        m_fastAttachCallback = FastAttachCallback();
+        NS_LOG_DEBUG(m_currentSlot << " Fast attach with RNTI " << raResponse.m_rnti);
+        Simulator::ScheduleNow(&NrUeMac::RecvRaResponse, this, raResponse);
+        return;
+    }
     RandomlySelectAndSendRaPreamble();
 }
 
@@ -1109,6 +1147,7 @@ void
 NrUeMac::DoReset()
 {
     NS_LOG_FUNCTION(this);
+    m_ulConfiguredGrant = false;
 }
 
 //////////////////////////////////////////////
@@ -10,6 +10,7 @@
 #include "nr-mac-pdu-info.h"
 #include "nr-phy-mac-common.h"
 
+#include <ns3/callback.h>
 #include <ns3/lte-ccm-mac-sap.h>
 #include <ns3/lte-ue-cmac-sap.h>
 #include <ns3/traced-callback.h>
@@ -155,6 +156,21 @@ class NrUeMac : public Object
      */
     void SetPhySapProvider(NrPhySapProvider* ptr);
 
+    /**
+     * \brief Allocation of a RNTI by the gNB, without random access
+     */
+    typedef Callback<uint16_t> FastAttachCallback;
+
+    /**
+     * \brief Skip the preamble and the RAR of the next contention-based random access
+     * \param cb the allocation of the RNTI by the gNB
+     *
+     * Used by the fast attach of NrHelper: when the RRC starts the random
+     * access, the RNTI is allocated at once by the gNB, and given to the RRC as
+     * for a received RAR. The callback is used only once.
+     */
+    void SetFastAttachCallback(const FastAttachCallback& cb);
+
     /**
      *  TracedCallback signature for Ue Mac Received Control Messages.
      * \param [in] sfnSf Frame number, subframe number, slot number, VarTti
@@ -421,6 +437,8 @@ class NrUeMac : public Object
     };
 
     SrBsrMachine m_srState{INACTIVE}; //!< Current state for the SR/BSR machine.
+    bool m_ulConfiguredGrant{false};  //!< An UL configured grant is active: the new data waits
+                                      //!< for its occasions, without a SR
 
     Ptr<UniformRandomVariable> m_raPreambleUniformVariable;
     uint8_t m_raPreambleId{0}; //!< The RA Preamble ID
@@ -453,6 +471,8 @@ class NrUeMac : public Object
     bool m_waitingForRaResponse{true}; //!< Indicates if we are waiting for a RA response
     static uint8_t g_raPreambleId;     //!< Preamble ID, fixed, the UEs will not have any collision
 
+    FastAttachCallback m_fastAttachCallback; //!< RNTI allocation of the fast attach, if any
+
     /**
      * Trace information regarding Ue MAC Received Control Messages
      * Frame number, Subframe number, slot, VarTtti, nodeId, rnti, bwpId,
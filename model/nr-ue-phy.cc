@@ -168,6 +168,19 @@ NrUePhy::GetTypeId()
                           TimeValue(MilliSeconds(200)),
                           MakeTimeAccessor(&NrUePhy::m_ueMeasurementsFilterPeriod),
                           MakeTimeChecker())
+            .AddAttribute("DlCqiSubbandSize",
+                          "Number of RB of a subband of the DL CQI report. If 0, the UE "
+                          "reports only the wideband CQI.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&NrUePhy::m_dlCqiSubbandSize),
+                          MakeUintegerChecker<uint16_t>())
+            .AddAttribute("DlCqiSubbandPeriod",
+                          "Minimum time between two DL CQI reports with the subband CQI; "
+                          "the reports in between carry only the wideband CQI. If 0, "
+                          "every report carries the subband CQI.",
+                          TimeValue(MilliSeconds(0)),
+                          MakeTimeAccessor(&NrUePhy::m_dlCqiSubbandPeriod),
+                          MakeTimeChecker())
             .AddAttribute("NrSpectrumPhyList",
                           "List of all SpectrumPhy instances of this NrUePhy.",
                           ObjectVectorValue(),
@@ -470,6 +483,128 @@ NrUePhy::InsertFutureAllocation(const SfnSf& sfnSf, const std::shared_ptr<DciInf
     }
 }
 
+void
+NrUePhy::ActivateConfiguredGrant(const SfnSf& sfnSf,
+                                 const std::shared_ptr<DciInfoElementTdma>& dci,
+                                 uint32_t k1Delay)
+{
+    NS_LOG_FUNCTION(this);
+
+    ConfiguredGrant grant;
+    grant.m_dci = std::make_shared<DciInfoElementTdma>(*dci);
+    grant.m_dci->m_cgOccasion = true;
+    grant.m_activation = sfnSf;
+    grant.m_k1Delay = k1Delay;
+
+    NS_LOG_INFO("UE " << m_rnti << " activated a configured grant from slot " << sfnSf
+                      << " every " << dci->m_cgPeriodicity << " slots, harqId "
+                      << +dci->m_harqProcess);
+
+    // A new activation with the same HARQ process replaces the previous grant
+    for (auto& existing : m_configuredGrants)
+    {
+        if (existing.m_dci->m_format == dci->m_format &&
+            existing.m_dci->m_harqProcess == dci->m_harqProcess)
+        {
+            existing = grant;
+            return;
+        }
+    }
+    m_configuredGrants.push_back(grant);
+}
+
+void
+NrUePhy::DeactivateConfiguredGrant(const SfnSf& sfnSf,
+                                   const std::shared_ptr<DciInfoElementTdma>& dci)
+{
+    NS_LOG_FUNCTION(this);
+
+    for (auto it = m_configuredGrants.begin(); it != m_configuredGrants.end(); ++it)
+    {
+        if (it->m_dci->m_format != dci->m_format ||
+            it->m_dci->m_harqProcess != dci->m_harqProcess)
+        {
+            continue;
+        }
+
+        NS_LOG_INFO("UE " << m_rnti << " released the configured grant with harqId "
+                          << +dci->m_harqProcess << " from slot " << sfnSf);
+        if (sfnSf.Normalize() <= m_currentSlot.Normalize())
+        {
+            const auto& grantDci = it->m_dci;
+            auto& allocations = m_currSlotAllocInfo.m_varTtiAllocInfo;
+            allocations.erase(std::remove_if(allocations.begin(),
+                                             allocations.end(),
+                                             [&grantDci](const VarTtiAllocInfo& allocation) {
+                                                 return allocation.m_dci == grantDci;
+                                             }),
+                              allocations.end());
+            m_configuredGrants.erase(it);
+        }
+        else
+        {
+            // The occasions before the release are still used
+            it->m_released = true;
+            it->m_release = sfnSf;
+        }
+        return;
+    }
+    NS_LOG_INFO("UE " << m_rnti << " has no configured grant with harqId "
+                      << +dci->m_harqProcess << " to release");
+}
+
+void
+NrUePhy::PushConfiguredGrantAllocations()
+{
+    NS_LOG_FUNCTION(this);
+
+    uint64_t currentSlotN = m_currentSlot.Normalize();
+    m_configuredGrants.erase(std::remove_if(m_configuredGrants.begin(),
+                                            m_configuredGrants.end(),
+                                            [currentSlotN](const ConfiguredGrant& grant) {
+                                                return grant.m_released &&
+                                                       currentSlotN >= grant.m_release.Normalize();
+                                            }),
+                             m_configuredGrants.end());
+    for (const auto& grant : m_configuredGrants)
+    {
+        uint64_t activationN = grant.m_activation.Normalize();
+        if (currentSlotN <= activationN ||
+            (currentSlotN - activationN) % grant.m_dci->m_cgPeriodicity != 0)
+        {
+            continue;
+        }
+
+        LteNrTddSlotType slotType = m_tddPattern[currentSlotN % m_tddPattern.size()];
+        if (grant.m_dci->m_format == DciInfoElementTdma::DL)
+        {
+            if (slotType == LteNrTddSlotType::UL)
+            {
+                continue;
+            }
+            m_harqIdToK1Map[grant.m_dci->m_harqProcess] = grant.m_k1Delay;
+            InsertAllocation(grant.m_dci);
+        }
+        else
+        {
+            if (slotType != LteNrTddSlotType::UL && slotType != LteNrTddSlotType::F)
+            {
+                continue;
+            }
+            InsertAllocation(grant.m_dci);
+
+            Ptr<NrUlDciMessage> dciMsg = Create<NrUlDciMessage>(grant.m_dci);
+            dciMsg->SetSourceBwp(GetBwpId());
+            dciMsg->SetKDelay(0);
+            m_phySapUser->ReceiveControlMessage(dciMsg);
+        }
+
+        NS_LOG_INFO("UE " << m_rnti << " occasion of a configured grant, from sym "
+                          << +grant.m_dci->m_symStart << " to "
+                          << grant.m_dci->m_symStart + grant.m_dci->m_numSym);
+    }
+}
+
 void
 NrUePhy::PhyCtrlMessagesReceived(const Ptr<NrControlMessage>& msg)
 {
@@ -503,6 +638,13 @@ NrUePhy::PhyCtrlMessagesReceived(const Ptr<NrControlMessage>& msg)
 
         /* BIG ASSUMPTION: We assume that K0 is always 0 */
 
+        if (dciInfoElem->m_cgRelease)
+        {
+            // No data, and no HARQ feedback
+            DeactivateConfiguredGrant(dciSfn, dciInfoElem);
+            return;
+        }
+
         auto it = m_harqIdToK1Map.find(dciInfoElem->m_harqProcess);
         if (it != m_harqIdToK1Map.end())
         {
@@ -511,6 +653,11 @@ NrUePhy::PhyCtrlMessagesReceived(const Ptr<NrControlMessage>& msg)
 
         m_harqIdToK1Map.insert(std::make_pair(dciInfoElem->m_harqProcess, dciMsg->GetK1Delay()));
 
+        if (dciInfoElem->m_cgPeriodicity > 0)
+        {
+            ActivateConfiguredGrant(dciSfn, dciInfoElem, dciMsg->GetK1Delay());
+        }
+
         m_phyUeRxedDlDciTrace(m_currentSlot,
                               GetCellId(),
                               m_rnti,
@@ -518,7 +665,18 @@ NrUePhy::PhyCtrlMessagesReceived(const Ptr<NrControlMessage>& msg)
                               dciInfoElem->m_harqProcess,
                               dciMsg->GetK1Delay());
 
-        InsertAllocation(dciInfoElem);
+        if (dciInfoElem->m_miniSlot)
+        {
+            Simulator::Schedule(m_lastSlotStart + GetSymbolPeriod() * dciInfoElem->m_symStart -
+                                    Simulator::Now(),
+                                &NrUePhy::StartMiniSlot,
+                                this,
+                                dciInfoElem);
+        }
+        else
+        {
+            InsertAllocation(dciInfoElem);
+        }
 
         m_phySapUser->ReceiveControlMessage(msg);
 
@@ -544,8 +702,18 @@ NrUePhy::PhyCtrlMessagesReceived(const Ptr<NrControlMessage>& msg)
         uint32_t k2Delay = dciMsg->GetKDelay();
         ulSfnSf.Add(k2Delay);
 
-        if (dciInfoElem->m_type == DciInfoElementTdma::DATA)
+        if (dciInfoElem->m_type == DciInfoElementTdma::DATA && dciInfoElem->m_cgRelease)
         {
+            // Nothing to transmit; the MAC resumes the scheduling requests
+            DeactivateConfiguredGrant(ulSfnSf, dciInfoElem);
+            m_phySapUser->ReceiveControlMessage(msg);
+        }
+        else if (dciInfoElem->m_type == DciInfoElementTdma::DATA)
+        {
+            if (dciInfoElem->m_cgPeriodicity > 0)
+            {
+                ActivateConfiguredGrant(ulSfnSf, dciInfoElem, 0);
+            }
             ProcessDataDci(ulSfnSf, dciInfoElem);
             m_phySapUser->ReceiveControlMessage(msg);
         }
@@ -555,6 +723,21 @@ NrUePhy::PhyCtrlMessagesReceived(const Ptr<NrControlMessage>& msg)
             // Do not pass the DCI to MAC
         }
     }
+    else if (msg->GetMessageType() == NrControlMessage::TDD_PATTERN)
+    {
+        auto tddMsg = DynamicCast<NrTddPatternMessage>(msg);
+        m_phyRxedCtrlMsgsTrace(m_currentSlot, GetCellId(), m_rnti, GetBwpId(), msg);
+        m_nextTddPattern = tddMsg->GetPattern();
+        m_nextTddPatternFrame = tddMsg->GetFrame();
+        // Do not pass the message to MAC
+    }
+    else if (msg->GetMessageType() == NrControlMessage::DL_PREEMPTION)
+    {
+        auto preemptionMsg = DynamicCast<NrDlPreemptionMessage>(msg);
+        m_phyRxedCtrlMsgsTrace(m_currentSlot, GetCellId(), m_rnti, GetBwpId(), msg);
+        ProcessDlPreemption(preemptionMsg->GetSymStart(), preemptionMsg->GetNumSym());
+        // Do not pass the message to MAC
+    }
     else if (msg->GetMessageType() == NrControlMessage::MIB)
     {
         NS_LOG_INFO("received MIB");
@@ -746,6 +929,15 @@ NrUePhy::StartSlot(const SfnSf& s)
     NS_LOG_FUNCTION(this);
     m_currentSlot = s;
     m_lastSlotStart = Simulator::Now();
+    m_dlPreemptions.clear();
+
+    if (!m_nextTddPattern.empty() && m_currentSlot.GetFrame() >= m_nextTddPatternFrame)
+    {
+        NS_LOG_INFO("UE " << m_rnti << " switch to the TDD pattern "
+                          << NrPhy::GetPattern(m_nextTddPattern));
+        m_tddPattern = m_nextTddPattern;
+        m_nextTddPattern.clear();
+    }
 
     // Call MAC before doing anything in PHY
     m_phySapUser->SlotIndication(m_currentSlot); // trigger mac
@@ -762,6 +954,10 @@ NrUePhy::StartSlot(const SfnSf& s)
     }
 
     PushCtrlAllocations(m_currentSlot);
+    if (!m_configuredGrants.empty())
+    {
+        PushConfiguredGrantAllocations();
+    }
 
     NS_ASSERT(m_currSlotAllocInfo.m_sfnSf == m_currentSlot);
 
@@ -1008,9 +1204,50 @@ NrUePhy::DlData(const std::shared_ptr<DciInfoElementTdma>& dci)
         }
     }
 
+    // A mini-slot preempts the allocations in its symbols, but not itself
+    if (!dci->m_miniSlot)
+    {
+        for (const auto& preemption : m_dlPreemptions)
+        {
+            for (const auto& spectrumPhy : m_spectrumPhys)
+            {
+                spectrumPhy->PreemptExpectedTb(m_rnti,
+                                               m_currentSlot,
+                                               preemption.first,
+                                               preemption.second);
+            }
+        }
+    }
+
     return varTtiDuration;
 }
 
+void
+NrUePhy::StartMiniSlot(const std::shared_ptr<DciInfoElementTdma>& dci)
+{
+    NS_LOG_FUNCTION(this);
+    Time varTtiDuration = DlData(dci);
+    NS_LOG_INFO("UE " << m_rnti << " mini-slot from sym " << +dci->m_symStart << " to "
+                      << dci->m_symStart + dci->m_numSym << ", end "
+                      << Simulator::Now() + varTtiDuration);
+}
+
+void
+NrUePhy::ProcessDlPreemption(uint8_t symStart, uint8_t numSym)
+{
+    NS_LOG_FUNCTION(this << +symStart << +numSym);
+    m_dlPreemptions.emplace_back(symStart, numSym);
+
+    for (const auto& spectrumPhy : m_spectrumPhys)
+    {
+        if (spectrumPhy->PreemptExpectedTb(m_rnti, m_currentSlot, symStart, numSym))
+        {
+            NS_LOG_INFO("UE " << m_rnti << " TB in reception preempted by the mini-slot at sym "
+                              << +symStart);
+        }
+    }
+}
+
 Time
 NrUePhy::UlData(const std::shared_ptr<DciInfoElementTdma>& dci)
 {
@@ -1221,6 +1458,10 @@ NrUePhy::GenerateDlCqiReport(const SpectrumValue& sinr, uint8_t streamId)
         avrgSinr[streamId] = avrgSinrdB;
         NS_LOG_DEBUG("Stream " << +streamId << " WB CQI " << +wbCqi << " avrg MCS " << +mcs
                                << " avrg SINR (dB) " << avrgSinrdB);
+        if (m_dlCqiSubbandSize > 0)
+        {
+            UpdateDlSbCqi(sinr, streamId, wbCqi);
+        }
         m_dlCqiFeedbackCounter++;
 
         // if we received SINR from all the active streams,
@@ -1251,6 +1492,16 @@ NrUePhy::GenerateDlCqiReport(const SpectrumValue& sinr, uint8_t streamId)
             // use MCS 0 to compute its TB size.
             dlcqi.m_wbCqi = m_prevDlWbCqi; // set DL CQI feedbacks
 
+            // As for the WB CQI, the subbands that could not be measured are
+            // reported with the previous value
+            if (m_dlCqiSubbandSize > 0 && Simulator::Now() >= m_nextDlSbCqi)
+            {
+                dlcqi.m_cqiType = DlCqiInfo::SB;
+                dlcqi.m_sbCqi = m_prevDlSbCqi;
+                dlcqi.m_sbSize = m_dlCqiSubbandSize;
+                m_nextDlSbCqi = Simulator::Now() + m_dlCqiSubbandPeriod;
+            }
+
             NS_ASSERT_MSG(dlcqi.m_ri <= dlcqi.m_wbCqi.size(),
                           "Mismatch between the RI and the number of CQIs in a CQI report");
 
@@ -1265,6 +1516,44 @@ NrUePhy::GenerateDlCqiReport(const SpectrumValue& sinr, uint8_t streamId)
     }
 }
 
+void
+NrUePhy::UpdateDlSbCqi(const SpectrumValue& sinr, uint8_t streamId, uint8_t wbCqi)
+{
+    NS_LOG_FUNCTION(this);
+
+    const uint32_t numRb = sinr.GetSpectrumModel()->GetNumBands();
+    const uint32_t numSb = (numRb + m_dlCqiSubbandSize - 1) / m_dlCqiSubbandSize;
+    m_prevDlSbCqi.resize(m_spectrumPhys.size());
+    for (std::size_t stream = 0; stream < m_prevDlSbCqi.size(); ++stream)
+    {
+        // Until measured, a subband has the WB CQI of the stream
+        m_prevDlSbCqi.at(stream).resize(numSb, m_prevDlWbCqi.at(stream));
+    }
+
+    std::vector<uint8_t>& sbCqi = m_prevDlSbCqi.at(streamId);
+    for (uint32_t sb = 0; sb < numSb; ++sb)
+    {
+        // The SINR of the other subbands is 0, which the AMC ignores
+        SpectrumValue sbSinr(sinr.GetSpectrumModel());
+        Values::iterator sbIt = sbSinr.ValuesBegin() + sb * m_dlCqiSubbandSize;
+        bool measured = false;
+        const uint32_t lastRb = std::min(numRb, (sb + 1) * m_dlCqiSubbandSize);
+        for (uint32_t rb = sb * m_dlCqiSubbandSize; rb < lastRb; ++rb, ++sbIt)
+        {
+            *sbIt = sinr.ValuesAt(rb);
+            measured |= (*sbIt != 0.0);
+        }
+        if (!measured)
+        {
+            continue;
+        }
+        uint8_t mcs;
+        sbCqi.at(sb) = m_amc->CreateCqiFeedbackWbTdma(sbSinr, mcs);
+        NS_LOG_DEBUG("Stream " << +streamId << " subband " << sb << " CQI " << +sbCqi.at(sb)
+                               << " (WB CQI " << +wbCqi << ")");
+    }
+}
+
 void
 NrUePhy::EnqueueDlHarqFeedback(const DlHarqInfo& m)
 {
@@ -1377,6 +1666,7 @@ void
 NrUePhy::DoReset()
 {
     NS_LOG_FUNCTION(this);
+    m_configuredGrants.clear();
 }
 
 void
@@ -233,6 +233,18 @@ class NrUePhy : public NrPhy
      */
     void GenerateDlCqiReport(const SpectrumValue& sinr, uint8_t streamIndex);
 
+    /**
+     * \brief Update the subband CQI of a stream from its SINR
+     *
+     * Called by GenerateDlCqiReport() when the attribute DlCqiSubbandSize is
+     * not 0. The subbands without SINR (not received) keep their previous CQI.
+     *
+     * \param sinr the SINR
+     * \param streamId the index of the stream
+     * \param wbCqi the wideband CQI of the stream, for the logs
+     */
+    void UpdateDlSbCqi(const SpectrumValue& sinr, uint8_t streamId, uint8_t wbCqi);
+
     /**
      * \brief Get the current RNTI of the user
      *
@@ -800,6 +812,55 @@ class NrUePhy : public NrPhy
      */
     void InsertFutureAllocation(const SfnSf& sfnSf, const std::shared_ptr<DciInfoElementTdma>& dci);
 
+    /**
+     * \brief Store a configured grant, activated by a DCI
+     * \param sfnSf the slot of the allocation of the DCI, which is the first occasion
+     * \param dci the activation DCI
+     * \param k1Delay the K1 delay of the activation DCI (DL only)
+     */
+    void ActivateConfiguredGrant(const SfnSf& sfnSf,
+                                 const std::shared_ptr<DciInfoElementTdma>& dci,
+                                 uint32_t k1Delay);
+
+    /**
+     * \brief Stop a configured grant, released by a DCI
+     * \param sfnSf the slot of the release DCI, from which the grant has no occasions
+     * \param dci the release DCI, with the format and the HARQ process of the grant
+     *
+     * If the release is for the current slot (DL), the occasion already queued
+     * in the slot is removed.
+     */
+    void DeactivateConfiguredGrant(const SfnSf& sfnSf,
+                                   const std::shared_ptr<DciInfoElementTdma>& dci);
+
+    /**
+     * \brief Insert the allocations of the configured grants with an occasion
+     * in the current slot
+     *
+     * The occasions have no DCI: the UE listens in DL, and in UL it asks the MAC
+     * for a PDU, through an UL DCI message built here, for the current slot.
+     */
+    void PushConfiguredGrantAllocations();
+
+    /**
+     * \brief Start the reception of the DL data of a mini-slot
+     * \param dci the DCI of the mini-slot
+     *
+     * The DCI arrives in the PDCCH of the mini-slot, after the allocations of
+     * the slot have been queued, so the reception is scheduled apart.
+     */
+    void StartMiniSlot(const std::shared_ptr<DciInfoElementTdma>& dci);
+
+    /**
+     * \brief Discard the DL TBs of the current slot in the preempted symbols
+     * \param symStart first preempted symbol
+     * \param numSym number of preempted symbols
+     *
+     * The TB being received is discarded now; the following ones are
+     * discarded by DlData.
+     */
+    void ProcessDlPreemption(uint8_t symStart, uint8_t numSym);
+
     /**
      * \brief Select the rank indicator to be reported to gNB
      *
@@ -833,6 +894,26 @@ class NrUePhy : public NrPhy
     std::unordered_map<uint8_t, uint32_t>
         m_harqIdToK1Map; //!< Map that holds the K1 delay for each Harq process id
 
+    /**
+     * \brief A configured grant activated by the gNB
+     */
+    struct ConfiguredGrant
+    {
+        std::shared_ptr<DciInfoElementTdma> m_dci; //!< Allocation of the occasions
+        SfnSf m_activation;                        //!< Slot of the first occasion
+        uint32_t m_k1Delay{0};                     //!< K1 delay of the occasions (DL only)
+        bool m_released{false};                    //!< True once a release DCI is received
+        SfnSf m_release;                           //!< Slot of the release, without occasion
+    };
+
+    std::vector<ConfiguredGrant> m_configuredGrants; //!< Active configured grants
+
+    std::vector<std::pair<uint8_t, uint8_t>>
+        m_dlPreemptions; //!< Symbols (first, number) of the current slot preempted by a mini-slot
+
+    std::vector<LteNrTddSlotType> m_nextTddPattern; //!< Pattern announced by the gNB, if any
+    uint32_t m_nextTddPatternFrame{0};              //!< Frame of the switch to m_nextTddPattern
+
     int64_t m_numRbPerRbg{
         -1}; //!< number of resource blocks within the channel bandwidth, this parameter is
              //!< configured by MAC through phy SAP provider interface
@@ -954,6 +1035,10 @@ class NrUePhy : public NrPhy
         m_activeDlDataStreamsPerHarqId; // active streams per HARQ process ID
 
     std::vector<uint8_t> m_prevDlWbCqi; //!< Vector to cache the CQI values reported by this UE PHY
+    std::vector<std::vector<uint8_t>> m_prevDlSbCqi; //!< Subband CQI per stream, as m_prevDlWbCqi
+    uint16_t m_dlCqiSubbandSize{0};                  //!< RB per subband; 0 for WB CQI only
+    Time m_dlCqiSubbandPeriod;                       //!< Minimum time between two SB CQI reports
+    Time m_nextDlSbCqi{0};                           //!< Time of the next SB CQI report
     uint8_t m_dlCqiFeedbackCounter{0};  /**< Counter to count the number of DL CQI
                                              report(s) this UE PHY prepares upon
                                              receiving SINR from underlying one or
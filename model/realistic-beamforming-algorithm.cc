@@ -14,6 +14,7 @@
 
 #include <ns3/angles.h>
 #include <ns3/double.h>
+#include <ns3/enum.h>
 #include <ns3/lte-ue-rrc.h>
 #include <ns3/mobility-model.h>
 #include <ns3/node.h>
@@ -82,7 +83,21 @@ RealisticBeamformingAlgorithm::GetTypeId()
                           BooleanValue(true),
                           MakeBooleanAccessor(&RealisticBeamformingAlgorithm::SetUseSnrSrs,
                                               &RealisticBeamformingAlgorithm::UseSnrSrs),
-                          MakeBooleanChecker());
+                          MakeBooleanChecker())
+            .AddAttribute(
+                "ChannelSnapshot",
+                "What is stored for each SRS report when the trigger event is the delayed "
+                "update: a reference to the immutable channel matrix (SharedChannel), or only "
+                "the noiseless projection of the channel on the candidate beam pairs "
+                "(LongTermProjection). The latter needs less memory for large arrays, but "
+                "it is computed at the SRS reception even if the update is not used.",
+                EnumValue(RealisticBeamformingAlgorithm::SHARED_CHANNEL),
+                MakeEnumAccessor(&RealisticBeamformingAlgorithm::SetChannelSnapshotType,
+                                 &RealisticBeamformingAlgorithm::GetChannelSnapshotType),
+                MakeEnumChecker(RealisticBeamformingAlgorithm::SHARED_CHANNEL,
+                                "SharedChannel",
+                                RealisticBeamformingAlgorithm::LONG_TERM_PROJECTION,
+                                "LongTermProjection"));
     return tid;
 }
 
@@ -137,6 +152,18 @@ RealisticBeamformingAlgorithm::UseSnrSrs() const
     return m_useSnrSrs;
 }
 
+void
+RealisticBeamformingAlgorithm::SetChannelSnapshotType(ChannelSnapshotType type)
+{
+    m_channelSnapshotType = type;
+}
+
+RealisticBeamformingAlgorithm::ChannelSnapshotType
+RealisticBeamformingAlgorithm::GetChannelSnapshotType() const
+{
+    return m_channelSnapshotType;
+}
+
 void
 RealisticBeamformingAlgorithm::NotifySrsSinrReport(uint16_t cellId, uint16_t rnti, double srsSinr)
 {
@@ -210,8 +237,18 @@ RealisticBeamformingAlgorithm::NotifySrsReport(uint16_t cellId, uint16_t rnti, d
             DelayedUpdateInfo dui;
             dui.updateTime = Simulator::Now() + conf.updateDelay;
             dui.srsSinr = m_maxSrsSinrPerSlot; // SNR or SINR
-            dui.channelMatrix = GetChannelMatrix();
-            m_delayedUpdateInfo.push(dui);
+            Ptr<const MatrixBasedChannelModel::ChannelMatrix> channelMatrix = GetChannelMatrix();
+            dui.channelGeneration = channelMatrix->m_generatedTime;
+            if (m_channelSnapshotType == LONG_TERM_PROJECTION)
+            {
+                ComputeLongTermProjection(channelMatrix, dui);
+            }
+            else
+            {
+                dui.channelMatrix = channelMatrix;
+            }
+            NS_LOG_DEBUG("Saved channel snapshot generated at " << dui.channelGeneration);
+            m_delayedUpdateInfo.push(std::move(dui));
             // schedule delayed update
             Simulator::Schedule(conf.updateDelay,
                                 &RealisticBeamformingAlgorithm::NotifyHelper,
@@ -276,9 +313,116 @@ RealisticBeamformingAlgorithm::GetChannelMatrix() const
                                  m_gnbSpectrumPhy->GetAntenna()->GetObject<PhasedArrayModel>(),
                                  m_ueSpectrumPhy->GetAntenna()->GetObject<PhasedArrayModel>());
 
-    Ptr<const MatrixBasedChannelModel::ChannelMatrix> channelMatrixCopy =
-        Copy<const MatrixBasedChannelModel::ChannelMatrix>(originalChannelMatrix);
-    return channelMatrixCopy;
+    return originalChannelMatrix;
+}
+
+void
+RealisticBeamformingAlgorithm::ComputeLongTermProjection(
+    const Ptr<const MatrixBasedChannelModel::ChannelMatrix>& channelMatrix,
+    DelayedUpdateInfo& dui) const
+{
+    NS_LOG_FUNCTION(this);
+
+    Ptr<const UniformPlanarArray> gnbAntenna = m_gnbSpectrumPhy->GetBeamManager()->GetAntenna();
+    Ptr<const UniformPlanarArray> ueAntenna = m_ueSpectrumPhy->GetBeamManager()->GetAntenna();
+
+    UintegerValue uintValue;
+    gnbAntenna->GetAttribute("NumRows", uintValue);
+    uint16_t gnbNumRows = static_cast<uint16_t>(uintValue.Get());
+    ueAntenna->GetAttribute("NumRows", uintValue);
+    uint16_t ueNumRows = static_cast<uint16_t>(uintValue.Get());
+
+    // The candidate beams are generated without touching the antennas, but in
+    // the same order and with the same values used by GetBeamformingVectors
+    std::vector<PhasedArrayModel::ComplexVector> gnbCandidates;
+    for (double gnbTheta = 60; gnbTheta < 121; gnbTheta = gnbTheta + m_beamSearchAngleStep)
+    {
+        for (uint16_t gnbSector = 0; gnbSector <= gnbNumRows; gnbSector++)
+        {
+            gnbCandidates.emplace_back(CreateDirectionalBfv(gnbAntenna, gnbSector, gnbTheta));
+        }
+    }
+    std::vector<PhasedArrayModel::ComplexVector> ueCandidates;
+    for (double ueTheta = 60; ueTheta < 121;
+         ueTheta = static_cast<uint16_t>(ueTheta + m_beamSearchAngleStep))
+    {
+        for (uint16_t ueSector = 0; ueSector <= ueNumRows; ueSector++)
+        {
+            ueCandidates.emplace_back(CreateDirectionalBfv(ueAntenna, ueSector, ueTheta));
+        }
+    }
+
+    dui.isReverse = channelMatrix->IsReverse(
+        m_gnbSpectrumPhy->GetAntenna()->GetObject<PhasedArrayModel>()->GetId(),
+        m_ueSpectrumPhy->GetAntenna()->GetObject<PhasedArrayModel>()->GetId());
+    dui.numClusters = static_cast<uint8_t>(channelMatrix->m_channel.GetNumPages());
+    dui.longTermProjection.clear();
+    dui.longTermProjection.reserve(gnbCandidates.size() * ueCandidates.size() *
+                                   dui.numClusters);
+
+    for (const auto& gnbW : gnbCandidates)
+    {
+        for (const auto& ueW : ueCandidates)
+        {
+            const PhasedArrayModel::ComplexVector& sW = dui.isReverse ? ueW : gnbW;
+            const PhasedArrayModel::ComplexVector& uW = dui.isReverse ? gnbW : ueW;
+            for (uint8_t cIndex = 0; cIndex < dui.numClusters; cIndex++)
+            {
+                std::complex<double> txSum(0, 0);
+                for (std::size_t sIndex = 0; sIndex < sW.GetSize(); sIndex++)
+                {
+                    std::complex<double> rxSum(0, 0);
+                    for (std::size_t uIndex = 0; uIndex < uW.GetSize(); uIndex++)
+                    {
+                        rxSum += uW[uIndex] * channelMatrix->m_channel(uIndex, sIndex, cIndex);
+                    }
+                    txSum = txSum + sW[sIndex] * rxSum;
+                }
+                dui.longTermProjection.push_back(txSum);
+            }
+        }
+    }
+}
+
+UniformPlanarArray::ComplexVector
+RealisticBeamformingAlgorithm::GetEstimatedLongTermComponentFromProjection(
+    const DelayedUpdateInfo& dui,
+    std::size_t pairIndex,
+    const UniformPlanarArray::ComplexVector& gnbW,
+    const UniformPlanarArray::ComplexVector& ueW) const
+{
+    NS_LOG_FUNCTION(this);
+    NS_ABORT_IF(dui.srsSinr == 0);
+    NS_ASSERT((pairIndex + 1) * dui.numClusters <= dui.longTermProjection.size());
+
+    const UniformPlanarArray::ComplexVector& sW = dui.isReverse ? ueW : gnbW;
+    const UniformPlanarArray::ComplexVector& uW = dui.isReverse ? gnbW : ueW;
+
+    double varError = 1 / (dui.srsSinr);
+
+    // The estimation error is linear in H, so it can be added to the noiseless
+    // projection. The random values are drawn in the same order as in
+    // GetEstimatedLongTermComponent.
+    UniformPlanarArray::ComplexVector estimatedlongTerm(dui.numClusters);
+    for (uint8_t cIndex = 0; cIndex < dui.numClusters; cIndex++)
+    {
+        std::complex<double> txSum(0, 0);
+        for (std::size_t sIndex = 0; sIndex < sW.GetSize(); sIndex++)
+        {
+            std::complex<double> rxSum(0, 0);
+            for (std::size_t uIndex = 0; uIndex < uW.GetSize(); uIndex++)
+            {
+                std::complex<double> error =
+                    std::complex<double>(m_normalRandomVariable->GetValue(0, sqrt(0.5) * varError),
+                                         m_normalRandomVariable->GetValue(0, sqrt(0.5) * varError));
+                rxSum += uW[uIndex] * error;
+            }
+            txSum = txSum + sW[sIndex] * rxSum;
+        }
+        estimatedlongTerm[cIndex] =
+            dui.longTermProjection[pairIndex * dui.numClusters + cIndex] + txSum;
+    }
+    return estimatedlongTerm;
 }
 
 BeamformingVectorPair
@@ -309,17 +453,22 @@ RealisticBeamformingAlgorithm::GetBeamformingVectors()
     TriggerEventConf conf = GetTriggerEventConf();
     double srsSinr = 0;
     Ptr<const MatrixBasedChannelModel::ChannelMatrix> channelMatrix = nullptr;
+    const DelayedUpdateInfo* projectionDui = nullptr;
 
     if (conf.event == RealisticBfManager::DELAYED_UPDATE)
     {
         NS_ASSERT(m_delayedUpdateInfo.size());
-        DelayedUpdateInfo dui = m_delayedUpdateInfo.front();
+        const DelayedUpdateInfo& dui = m_delayedUpdateInfo.front();
         NS_ABORT_MSG_UNLESS(dui.updateTime == Simulator::Now(),
                             "Current time should be equal to the updateTime from the "
                             "DelayedUpdateInfo structure."); // sanity check that we are using
                                                              // correct dui
         srsSinr = dui.srsSinr;
         channelMatrix = dui.channelMatrix;
+        if (channelMatrix == nullptr)
+        {
+            projectionDui = &dui;
+        }
     }
     else
     {
@@ -327,6 +476,7 @@ RealisticBeamformingAlgorithm::GetBeamformingVectors()
         channelMatrix = GetChannelMatrix();
     }
 
+    std::size_t pairIndex = 0;
     for (double gnbTheta = 60; gnbTheta < 121; gnbTheta = gnbTheta + m_beamSearchAngleStep)
     {
         for (uint16_t gnbSector = 0; gnbSector <= gnbNumRows; gnbSector++)
@@ -351,15 +501,21 @@ RealisticBeamformingAlgorithm::GetBeamformingVectors()
                                     "the long term matrix.");
 
                     const UniformPlanarArray::ComplexVector estimatedLongTermComponent =
-                        GetEstimatedLongTermComponent(
-                            channelMatrix,
-                            gnbW,
-                            ueW,
-                            m_gnbSpectrumPhy->GetObject<MobilityModel>(),
-                            m_ueSpectrumPhy->GetObject<MobilityModel>(),
-                            srsSinr,
-                            m_gnbSpectrumPhy->GetAntenna()->GetObject<PhasedArrayModel>(),
-                            m_ueSpectrumPhy->GetAntenna()->GetObject<PhasedArrayModel>());
+                        projectionDui != nullptr
+                            ? GetEstimatedLongTermComponentFromProjection(*projectionDui,
+                                                                          pairIndex,
+                                                                          gnbW,
+                                                                          ueW)
+                            : GetEstimatedLongTermComponent(
+                                  channelMatrix,
+                                  gnbW,
+                                  ueW,
+                                  m_gnbSpectrumPhy->GetObject<MobilityModel>(),
+                                  m_ueSpectrumPhy->GetObject<MobilityModel>(),
+                                  srsSinr,
+                                  m_gnbSpectrumPhy->GetAntenna()->GetObject<PhasedArrayModel>(),
+                                  m_ueSpectrumPhy->GetAntenna()->GetObject<PhasedArrayModel>());
+                    pairIndex++;
 
                     double estimatedLongTermMetric =
                         CalculateTheEstimatedLongTermMetric(estimatedLongTermComponent);
@@ -25,6 +25,7 @@ class SpectrumModel;
 class SpectrumValue;
 class RealisticBeamformingHelper;
 class NrRealisticBeamformingTestCase;
+class NrRealisticBeamformingProjectionTestCase;
 
 /**
  * \ingroup gnb-phy
@@ -51,6 +52,7 @@ class RealisticBeamformingAlgorithm : public Object
 {
     friend RealisticBeamformingHelper;
     friend NrRealisticBeamformingTestCase;
+    friend NrRealisticBeamformingProjectionTestCase;
 
   public:
     /*
@@ -63,8 +65,24 @@ class RealisticBeamformingAlgorithm : public Object
                          //!< measurement and channel
         double srsSinr;  //!< SRS SINR/SNR value
         Ptr<const MatrixBasedChannelModel::ChannelMatrix>
-            channelMatrix; //!< saved deep copy of the channel matrix at the time instant when the
-                           //!< SRS is received
+            channelMatrix; //!< snapshot of the channel matrix at the time instant when the SRS is
+                           //!< received, nullptr when only the projection is stored
+        Time channelGeneration; //!< generation time of the channel snapshot, identifies the
+                                //!< channel realization used for the update
+        bool isReverse{false};  //!< whether the gNB is the u-node of the channel snapshot
+        uint8_t numClusters{0}; //!< number of clusters of the channel snapshot
+        std::vector<std::complex<double>>
+            longTermProjection; //!< noiseless long term component per candidate beam pair and
+                                //!< cluster, filled only in LONG_TERM_PROJECTION mode
+    };
+
+    /**
+     * \brief What is stored for a delayed beamforming update
+     */
+    enum ChannelSnapshotType
+    {
+        SHARED_CHANNEL,      //!< A reference to the immutable channel matrix
+        LONG_TERM_PROJECTION //!< Only the projection of the channel on the candidate beams
     };
 
     /*
@@ -173,6 +191,15 @@ class RealisticBeamformingAlgorithm : public Object
      * \return the boolean indicator indicating whether SRS SNR is used
      */
     bool UseSnrSrs() const;
+    /**
+     * \brief Set what is stored for the delayed beamforming updates
+     * \param type the channel snapshot type
+     */
+    void SetChannelSnapshotType(ChannelSnapshotType type);
+    /**
+     * \return the channel snapshot type
+     */
+    ChannelSnapshotType GetChannelSnapshotType() const;
 
   private:
     /**
@@ -216,9 +243,39 @@ class RealisticBeamformingAlgorithm : public Object
      * so there can be various SRS reports and corresponding channel matrices for which
      * will be nececessary to perform bemaforming update using channel matrix corresponding to
      * the time of the reception of SRS.
-     * \return returns a deep copy of the current channel matrix
+     * The 3GPP channel model never modifies a channel matrix once it has been
+     * returned: when the channel is updated, a new matrix is created and the
+     * previous one stays valid for whoever holds a reference to it. Hence, the
+     * returned pointer is an immutable snapshot of the channel and it does not
+     * need to be copied.
+     * \return returns the current channel matrix
      */
     Ptr<const MatrixBasedChannelModel::ChannelMatrix> GetChannelMatrix() const;
+    /**
+     * \brief Calculates the noiseless long term component between gNB and UE for
+     * every candidate beam pair of the beam search, in the same order in which
+     * the pairs are visited by GetBeamformingVectors
+     * \param channelMatrix the channel matrix H
+     * \param [out] dui the delayed update info in which the projection is stored
+     */
+    void ComputeLongTermProjection(
+        const Ptr<const MatrixBasedChannelModel::ChannelMatrix>& channelMatrix,
+        DelayedUpdateInfo& dui) const;
+    /**
+     * \brief Calculates an estimation of the long term component from a stored
+     * noiseless projection. The estimation error is generated in the same way as
+     * in GetEstimatedLongTermComponent.
+     * \param dui the delayed update info holding the projection
+     * \param pairIndex the index of the candidate beam pair
+     * \param gnbW the beamforming vector of the gNB
+     * \param ueW the beamforming vector of the UE
+     * \return the estimated long term component
+     */
+    UniformPlanarArray::ComplexVector GetEstimatedLongTermComponentFromProjection(
+        const DelayedUpdateInfo& dui,
+        std::size_t pairIndex,
+        const UniformPlanarArray::ComplexVector& gnbW,
+        const UniformPlanarArray::ComplexVector& ueW) const;
     /**
      * \brief Calculates an estimation of the long term component based on the channel measurements
      * \param channelMatrix the channel matrix H
@@ -258,6 +315,8 @@ class RealisticBeamformingAlgorithm : public Object
     double m_beamSearchAngleStep{30}; //!< The beam angle step that will be used to define the set
                                       //!< of beams for which will be estimated the channel
     bool m_useSnrSrs{true};           //!< SRS SNR used as measurement (attribute)
+    ChannelSnapshotType m_channelSnapshotType{
+        SHARED_CHANNEL}; //!< What is stored for the delayed updates (attribute)
     // variable members, counters, and saving values
     double m_maxSrsSinrPerSlot{
         0}; //!< the maximum SRS SINR/SNR per slot in Watts, e.g. if there are 4 SRS symbols per UE,
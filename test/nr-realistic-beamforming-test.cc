@@ -39,6 +39,14 @@ NS_LOG_COMPONENT_DEFINE("NrRealisticBeamformingTest");
  * the Doppler, and frequency-selectivity) while realistic beamforming
  * algorithm only estimates the long-term component of the fading.
  * Hence, then slight variations on the best beam selection may appear.
+ *
+ * A second test checks that the delayed update computed from the stored
+ * projection of the channel on the candidate beams (LongTermProjection) selects
+ * the same beamforming vectors as the one computed from the stored channel
+ * matrix (SharedChannel), when the channel does not change. A third test
+ * checks that, with the BatchPerSlot attribute of the helper, the updates
+ * triggered in a slot for the same pair of devices are merged and executed at
+ * the end of the slot, with the same result as the immediate update.
  */
 
 class NrRealisticBeamformingTestSuite : public TestSuite
@@ -62,6 +70,424 @@ class NrRealisticBeamformingTestCase : public TestCase
     }; //!< the test execution mode type
 };
 
+/**
+ * \brief Compares the delayed beamforming updates computed from the channel
+ * matrix and from the long term projection, for a static channel and the same
+ * estimation error
+ */
+class NrRealisticBeamformingProjectionTestCase : public TestCase
+{
+  public:
+    NrRealisticBeamformingProjectionTestCase()
+        : TestCase("RealisticBeamforming long term projection vs channel matrix")
+    {
+    }
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief What the algorithm stored and selected at a delayed update
+     */
+    struct DelayedUpdate
+    {
+        BeamformingVectorPair bfPair;       //!< the selected beamforming vectors
+        bool hasChannelMatrix{false};       //!< whether the channel matrix was stored
+        std::size_t projectionSize{0};      //!< the size of the stored projection
+        Time channelGeneration{Seconds(0)}; //!< generation time of the stored channel
+    };
+
+    /**
+     * \brief The delayed update of an algorithm is due: run the beam search
+     * \param test the test
+     * \param algorithm the algorithm
+     * \param gnbDev the gNB device
+     * \param ueDev the UE device
+     * \param gnbSpectrumPhy the spectrum phy of the gNB
+     * \param ueSpectrumPhy the spectrum phy of the UE
+     */
+    static void Update(NrRealisticBeamformingProjectionTestCase* test,
+                       Ptr<RealisticBeamformingAlgorithm> algorithm,
+                       const Ptr<NrGnbNetDevice>& gnbDev,
+                       const Ptr<NrUeNetDevice>& ueDev,
+                       const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
+                       const Ptr<NrSpectrumPhy>& ueSpectrumPhy);
+
+    std::map<RealisticBeamformingAlgorithm::ChannelSnapshotType, DelayedUpdate>
+        m_updates; //!< the delayed update of each algorithm
+};
+
+/**
+ * \brief Create a gNB with the realistic beam manager and a UE with 2x2
+ * isotropic antennas, in a channel that is not updated
+ * \param nrHelper the NR helper, with the beam manager attributes already set
+ * \param gnbDevs the gNB device
+ * \param ueDevs the UE device
+ */
+static void
+CreateRealisticBfPair(const Ptr<NrHelper>& nrHelper,
+                      NetDeviceContainer& gnbDevs,
+                      NetDeviceContainer& ueDevs)
+{
+    Config::SetDefault("ns3::ThreeGppChannelModel::UpdatePeriod", TimeValue(MilliSeconds(0)));
+
+    NodeContainer gnbNodes;
+    NodeContainer ueNodes;
+    gnbNodes.Create(1);
+    ueNodes.Create(1);
+
+    Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator>();
+    positionAlloc->Add(Vector(0, 0.0, 10));  // gNB
+    positionAlloc->Add(Vector(10, 10, 1.5)); // UE
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.SetPositionAllocator(positionAlloc);
+    mobility.Install(NodeContainer(gnbNodes, ueNodes));
+
+    nrHelper->SetPathlossAttribute("ShadowingEnabled", BooleanValue(false));
+    CcBwpCreator::SimpleOperationBandConf bandConf(29e9, 100e6, 1, BandwidthPartInfo::UMa_LoS);
+    CcBwpCreator ccBwpCreator;
+    OperationBandInfo band = ccBwpCreator.CreateOperationBandContiguousCc(bandConf);
+    nrHelper->InitializeOperationBand(&band);
+    BandwidthPartInfoPtrVector allBwps = CcBwpCreator::GetAllBwps({band});
+
+    nrHelper->SetGnbAntennaAttribute("NumRows", UintegerValue(2));
+    nrHelper->SetGnbAntennaAttribute("NumColumns", UintegerValue(2));
+    nrHelper->SetUeAntennaAttribute("NumRows", UintegerValue(2));
+    nrHelper->SetUeAntennaAttribute("NumColumns", UintegerValue(2));
+    nrHelper->SetGnbAntennaAttribute("AntennaElement",
+                                     PointerValue(CreateObject<IsotropicAntennaModel>()));
+    nrHelper->SetUeAntennaAttribute("AntennaElement",
+                                    PointerValue(CreateObject<IsotropicAntennaModel>()));
+    nrHelper->SetGnbBeamManagerTypeId(RealisticBfManager::GetTypeId());
+
+    gnbDevs = nrHelper->InstallGnbDevice(gnbNodes, allBwps);
+    ueDevs = nrHelper->InstallUeDevice(ueNodes, allBwps);
+    nrHelper->AssignStreams(gnbDevs, 1);
+    nrHelper->AssignStreams(ueDevs, 1);
+
+    for (auto it = gnbDevs.Begin(); it != gnbDevs.End(); ++it)
+    {
+        DynamicCast<NrGnbNetDevice>(*it)->UpdateConfig();
+    }
+    for (auto it = ueDevs.Begin(); it != ueDevs.End(); ++it)
+    {
+        DynamicCast<NrUeNetDevice>(*it)->UpdateConfig();
+    }
+}
+
+void
+NrRealisticBeamformingProjectionTestCase::Update(NrRealisticBeamformingProjectionTestCase* test,
+                                                 Ptr<RealisticBeamformingAlgorithm> algorithm,
+                                                 const Ptr<NrGnbNetDevice>& gnbDev,
+                                                 const Ptr<NrUeNetDevice>& ueDev,
+                                                 const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
+                                                 const Ptr<NrSpectrumPhy>& ueSpectrumPhy)
+{
+    const RealisticBeamformingAlgorithm::DelayedUpdateInfo& dui =
+        algorithm->m_delayedUpdateInfo.front();
+    DelayedUpdate& update = test->m_updates[algorithm->GetChannelSnapshotType()];
+    update.hasChannelMatrix = dui.channelMatrix != nullptr;
+    update.projectionSize = dui.longTermProjection.size();
+    update.channelGeneration = dui.channelGeneration;
+    update.bfPair = algorithm->GetBeamformingVectors();
+}
+
+void
+NrRealisticBeamformingProjectionTestCase::DoRun()
+{
+    RngSeedManager::SetSeed(1);
+    RngSeedManager::SetRun(1);
+
+    Ptr<NrHelper> nrHelper = CreateObject<NrHelper>();
+    nrHelper->SetGnbBeamManagerAttribute("TriggerEvent",
+                                         EnumValue(RealisticBfManager::DELAYED_UPDATE));
+    nrHelper->SetGnbBeamManagerAttribute("UpdateDelay", TimeValue(MilliSeconds(1)));
+    NetDeviceContainer gnbDevs;
+    NetDeviceContainer ueDevs;
+    CreateRealisticBfPair(nrHelper, gnbDevs, ueDevs);
+
+    Ptr<NrGnbNetDevice> gnbDev = DynamicCast<NrGnbNetDevice>(gnbDevs.Get(0));
+    Ptr<NrUeNetDevice> ueDev = DynamicCast<NrUeNetDevice>(ueDevs.Get(0));
+    Ptr<NrSpectrumPhy> gnbSpectrumPhy = nrHelper->GetGnbPhy(gnbDev, 0)->GetSpectrumPhy(0);
+    Ptr<NrSpectrumPhy> ueSpectrumPhy = nrHelper->GetUePhy(ueDev, 0)->GetSpectrumPhy(0);
+
+    // The channel matrix is stored by default, the projection is selected
+    // through the attribute
+    Ptr<RealisticBeamformingAlgorithm> shared = CreateObject<RealisticBeamformingAlgorithm>();
+    Ptr<RealisticBeamformingAlgorithm> projection = CreateObject<RealisticBeamformingAlgorithm>();
+    projection->SetAttribute("ChannelSnapshot", StringValue("LongTermProjection"));
+    NS_TEST_ASSERT_MSG_EQ(shared->GetChannelSnapshotType(),
+                          RealisticBeamformingAlgorithm::SHARED_CHANNEL,
+                          "The channel matrix should be stored by default");
+    NS_TEST_ASSERT_MSG_EQ(projection->GetChannelSnapshotType(),
+                          RealisticBeamformingAlgorithm::LONG_TERM_PROJECTION,
+                          "The projection was not selected through the attribute");
+
+    // A high SRS SNR, and the same stream for the estimation error of both
+    const double srsSnr = std::pow(10.0, 0.1 * 40);
+    for (const auto& algorithm : {shared, projection})
+    {
+        algorithm->Install(gnbDev, ueDev, gnbSpectrumPhy, ueSpectrumPhy, gnbDev->GetScheduler(0));
+        algorithm->AssignStreams(1);
+        algorithm->SetTriggerCallback(
+            MakeBoundCallback(&NrRealisticBeamformingProjectionTestCase::Update, this, algorithm));
+        for (uint8_t sym = 0; sym < algorithm->GetSrsSymbolsPerSlot(); ++sym)
+        {
+            algorithm->NotifySrsReport(gnbSpectrumPhy->GetCellId(),
+                                       ueDev->GetRrc()->GetRnti(),
+                                       srsSnr);
+        }
+    }
+
+    Simulator::Stop(MilliSeconds(2));
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(m_updates.size(), 2, "The delayed updates were not executed");
+    const DelayedUpdate& sharedUpdate = m_updates[RealisticBeamformingAlgorithm::SHARED_CHANNEL];
+    const DelayedUpdate& projectionUpdate =
+        m_updates[RealisticBeamformingAlgorithm::LONG_TERM_PROJECTION];
+
+    NS_TEST_ASSERT_MSG_EQ(sharedUpdate.hasChannelMatrix, true, "Channel matrix not stored");
+    NS_TEST_ASSERT_MSG_EQ(sharedUpdate.projectionSize, 0, "Projection stored with the matrix");
+    NS_TEST_ASSERT_MSG_EQ(projectionUpdate.hasChannelMatrix,
+                          false,
+                          "Channel matrix stored with the projection");
+    NS_TEST_ASSERT_MSG_GT(projectionUpdate.projectionSize, 0, "Projection not stored");
+    NS_TEST_ASSERT_MSG_EQ(sharedUpdate.channelGeneration,
+                          projectionUpdate.channelGeneration,
+                          "The channel changed during the test");
+
+    NS_TEST_ASSERT_MSG_EQ(sharedUpdate.bfPair.first.second,
+                          projectionUpdate.bfPair.first.second,
+                          "Different gNB beam selected from the projection");
+    NS_TEST_ASSERT_MSG_EQ(sharedUpdate.bfPair.second.second,
+                          projectionUpdate.bfPair.second.second,
+                          "Different UE beam selected from the projection");
+    NS_TEST_ASSERT_MSG_EQ((sharedUpdate.bfPair.first.first == projectionUpdate.bfPair.first.first),
+                          true,
+                          "Different gNB beamforming vector from the projection");
+    NS_TEST_ASSERT_MSG_EQ(
+        (sharedUpdate.bfPair.second.first == projectionUpdate.bfPair.second.first),
+        true,
+        "Different UE beamforming vector from the projection");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \brief Triggers the SRS count updates of a pair of devices through a helper
+ * that runs them immediately and through a helper that batches them per slot
+ */
+class NrRealisticBeamformingBatchTestCase : public TestCase
+{
+  public:
+    NrRealisticBeamformingBatchTestCase()
+        : TestCase("RealisticBeamforming batch of the updates per slot")
+    {
+    }
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Notify the SRS reports that trigger the updates of a helper
+     * \param helper the helper
+     * \param triggers the number of updates to trigger
+     */
+    void Trigger(const Ptr<RealisticBeamformingHelper>& helper, uint32_t triggers);
+
+    /**
+     * \brief Trigger an update through the helper without batch
+     */
+    void TriggerUnbatched();
+
+    /**
+     * \brief Save the vectors of the update without batch, and replace them
+     * with the quasi-omni ones
+     */
+    void SaveUnbatched();
+
+    /**
+     * \brief Trigger several updates in the same slot through the helper with batch
+     */
+    void TriggerBatched();
+
+    /**
+     * \brief Check that the triggers are merged in a batch at the end of the slot
+     */
+    void CheckBatch();
+
+    /**
+     * \brief Check that the batch has not run yet
+     */
+    void CheckBeforeBatch();
+
+    /**
+     * \brief Check that the batch has run, with the vectors of the update without batch
+     */
+    void CheckAfterBatch();
+
+    Ptr<NrGnbNetDevice> m_gnbDev;                //!< the gNB device
+    Ptr<NrUeNetDevice> m_ueDev;                  //!< the UE device
+    Ptr<NrSpectrumPhy> m_gnbSpectrumPhy;         //!< the spectrum phy of the gNB
+    Ptr<NrSpectrumPhy> m_ueSpectrumPhy;          //!< the spectrum phy of the UE
+    Ptr<RealisticBeamformingHelper> m_unbatched; //!< the helper without batch
+    Ptr<RealisticBeamformingHelper> m_batched;   //!< the helper with batch
+    BeamformingVectorPair m_unbatchedBfPair;     //!< the vectors of the update without batch
+    Time m_batchTime;                            //!< the end of the slot of the triggers
+    bool m_batchRun{false};                      //!< whether the batch has run
+};
+
+void
+NrRealisticBeamformingBatchTestCase::Trigger(const Ptr<RealisticBeamformingHelper>& helper,
+                                             uint32_t triggers)
+{
+    Ptr<RealisticBeamformingAlgorithm> algorithm =
+        helper->m_antennaPairToAlgorithm.at(std::make_pair(m_gnbSpectrumPhy, m_ueSpectrumPhy));
+    uint8_t srsSymbols =
+        DynamicCast<NrMacSchedulerNs3>(m_gnbDev->GetScheduler(0))->GetSrsCtrlSyms();
+    const double srsSnr = std::pow(10.0, 0.1 * 40);
+
+    // With the default update periodicity, each slot of SRS reports triggers an update
+    for (uint32_t i = 0; i < triggers; ++i)
+    {
+        for (uint8_t sym = 0; sym < srsSymbols; ++sym)
+        {
+            algorithm->NotifySrsReport(m_gnbSpectrumPhy->GetCellId(),
+                                       m_ueDev->GetRrc()->GetRnti(),
+                                       srsSnr);
+        }
+    }
+}
+
+void
+NrRealisticBeamformingBatchTestCase::TriggerUnbatched()
+{
+    Trigger(m_unbatched, 1);
+    Simulator::Schedule(NanoSeconds(1), &NrRealisticBeamformingBatchTestCase::SaveUnbatched, this);
+}
+
+void
+NrRealisticBeamformingBatchTestCase::SaveUnbatched()
+{
+    Ptr<BeamManager> gnbBm = m_gnbSpectrumPhy->GetBeamManager();
+    Ptr<BeamManager> ueBm = m_ueSpectrumPhy->GetBeamManager();
+    m_unbatchedBfPair = std::make_pair(
+        BeamformingVector(gnbBm->GetBeamformingVector(m_ueDev), gnbBm->GetBeamId(m_ueDev)),
+        BeamformingVector(ueBm->GetBeamformingVector(m_gnbDev), ueBm->GetBeamId(m_gnbDev)));
+    NS_TEST_ASSERT_MSG_NE(m_unbatchedBfPair.first.second,
+                          OMNI_BEAM_ID,
+                          "The update without batch was not executed immediately");
+
+    gnbBm->SaveBeamformingVector(std::make_pair(CreateQuasiOmniBfv(2, 2), OMNI_BEAM_ID), m_ueDev);
+    ueBm->SaveBeamformingVector(std::make_pair(CreateQuasiOmniBfv(2, 2), OMNI_BEAM_ID), m_gnbDev);
+}
+
+void
+NrRealisticBeamformingBatchTestCase::TriggerBatched()
+{
+    m_batchTime = Simulator::Now() + NrHelper::GetGnbPhy(m_gnbDev, 0)->GetTimeToNextSlot();
+    Trigger(m_batched, 3);
+    Simulator::Schedule(NanoSeconds(1), &NrRealisticBeamformingBatchTestCase::CheckBatch, this);
+    Simulator::Schedule(m_batchTime - Simulator::Now() - NanoSeconds(1),
+                        &NrRealisticBeamformingBatchTestCase::CheckBeforeBatch,
+                        this);
+    Simulator::Schedule(m_batchTime - Simulator::Now() + NanoSeconds(1),
+                        &NrRealisticBeamformingBatchTestCase::CheckAfterBatch,
+                        this);
+}
+
+void
+NrRealisticBeamformingBatchTestCase::CheckBatch()
+{
+    NS_TEST_ASSERT_MSG_EQ(m_batched->m_slotBatches.size(), 1, "The triggers are not in one batch");
+    NS_TEST_ASSERT_MSG_EQ(m_batched->m_slotBatches.begin()->first,
+                          m_batchTime,
+                          "The batch does not run at the end of the slot");
+    NS_TEST_ASSERT_MSG_EQ(m_batched->m_slotBatches.begin()->second.tasks.size(),
+                          1,
+                          "The triggers of the same pair of devices were not merged");
+    CheckBeforeBatch();
+}
+
+void
+NrRealisticBeamformingBatchTestCase::CheckBeforeBatch()
+{
+    NS_TEST_ASSERT_MSG_EQ(m_gnbSpectrumPhy->GetBeamManager()->GetBeamId(m_ueDev),
+                          OMNI_BEAM_ID,
+                          "The batched update ran before the end of the slot");
+    NS_TEST_ASSERT_MSG_EQ(m_ueSpectrumPhy->GetBeamManager()->GetBeamId(m_gnbDev),
+                          OMNI_BEAM_ID,
+                          "The batched update ran before the end of the slot");
+}
+
+void
+NrRealisticBeamformingBatchTestCase::CheckAfterBatch()
+{
+    m_batchRun = true;
+    NS_TEST_ASSERT_MSG_EQ(m_batched->m_slotBatches.empty(), true, "The batch did not run");
+
+    Ptr<BeamManager> gnbBm = m_gnbSpectrumPhy->GetBeamManager();
+    Ptr<BeamManager> ueBm = m_ueSpectrumPhy->GetBeamManager();
+    NS_TEST_ASSERT_MSG_EQ(gnbBm->GetBeamId(m_ueDev),
+                          m_unbatchedBfPair.first.second,
+                          "Different gNB beam with the batch");
+    NS_TEST_ASSERT_MSG_EQ(ueBm->GetBeamId(m_gnbDev),
+                          m_unbatchedBfPair.second.second,
+                          "Different UE beam with the batch");
+    NS_TEST_ASSERT_MSG_EQ((gnbBm->GetBeamformingVector(m_ueDev) == m_unbatchedBfPair.first.first),
+                          true,
+                          "Different gNB beamforming vector with the batch");
+    NS_TEST_ASSERT_MSG_EQ((ueBm->GetBeamformingVector(m_gnbDev) == m_unbatchedBfPair.second.first),
+                          true,
+                          "Different UE beamforming vector with the batch");
+}
+
+void
+NrRealisticBeamformingBatchTestCase::DoRun()
+{
+    RngSeedManager::SetSeed(1);
+    RngSeedManager::SetRun(1);
+
+    Ptr<NrHelper> nrHelper = CreateObject<NrHelper>();
+    NetDeviceContainer gnbDevs;
+    NetDeviceContainer ueDevs;
+    CreateRealisticBfPair(nrHelper, gnbDevs, ueDevs);
+
+    m_gnbDev = DynamicCast<NrGnbNetDevice>(gnbDevs.Get(0));
+    m_ueDev = DynamicCast<NrUeNetDevice>(ueDevs.Get(0));
+    m_gnbSpectrumPhy = nrHelper->GetGnbPhy(m_gnbDev, 0)->GetSpectrumPhy(0);
+    m_ueSpectrumPhy = nrHelper->GetUePhy(m_ueDev, 0)->GetSpectrumPhy(0);
+
+    // The algorithms of the two helpers use the same stream for the estimation error
+    m_unbatched = CreateObject<RealisticBeamformingHelper>();
+    m_batched = CreateObject<RealisticBeamformingHelper>();
+    m_batched->SetAttribute("BatchPerSlot", BooleanValue(true));
+    for (const auto& helper : {m_unbatched, m_batched})
+    {
+        helper->SetBeamformingMethod(RealisticBeamformingAlgorithm::GetTypeId());
+        helper->AddBeamformingTask(m_gnbDev, m_ueDev);
+        helper->m_antennaPairToAlgorithm.at(std::make_pair(m_gnbSpectrumPhy, m_ueSpectrumPhy))
+            ->AssignStreams(1);
+    }
+
+    // The triggers are in the middle of a slot
+    Simulator::Schedule(MilliSeconds(10) + MicroSeconds(100),
+                        &NrRealisticBeamformingBatchTestCase::TriggerUnbatched,
+                        this);
+    Simulator::Schedule(MilliSeconds(20) + MicroSeconds(100),
+                        &NrRealisticBeamformingBatchTestCase::TriggerBatched,
+                        this);
+    Simulator::Stop(MilliSeconds(30));
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(m_batchRun, true, "The batch was not checked");
+    m_unbatched = nullptr;
+    m_batched = nullptr;
+    Simulator::Destroy();
+}
+
 /**
  * TestSuite
  */
@@ -79,6 +505,8 @@ NrRealisticBeamformingTestSuite::NrRealisticBeamformingTestSuite()
     AddTestCase(new NrRealisticBeamformingTestCase("RealisticBeamforming basic test case",
                                                    durationExtensive),
                 durationExtensive);
+    AddTestCase(new NrRealisticBeamformingProjectionTestCase(), durationQuick);
+    AddTestCase(new NrRealisticBeamformingBatchTestCase(), durationQuick);
 }
 
 /**
@@ -0,0 +1,224 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include <ns3/beam-manager.h>
+#include <ns3/boolean.h>
+#include <ns3/simple-net-device.h>
+#include <ns3/test.h>
+#include <ns3/uinteger.h>
+#include <ns3/uniform-planar-array.h>
+
+#include <functional>
+
+/**
+ * \file nr-test-beam-manager.cc
+ * \ingroup test
+ *
+ * \brief Unit-testing for the dense beam storage of the BeamManager. The test
+ * saves a different beamforming vector for each device, and checks that
+ * switching the beam through the dense index sets in the antenna the same
+ * weights as switching the beam through the device, also after the vectors
+ * are updated and when the beam is changed by other methods in between. A
+ * second test follows the beam switches of the gNB PHY over the var-TTIs of a
+ * slot, and counts the writes of the antenna weights.
+ */
+namespace ns3
+{
+
+class TestBeamManagerDenseStorage : public TestCase
+{
+  public:
+    TestBeamManagerDenseStorage(bool saveBeforeIndex, const std::string& name)
+        : TestCase(name),
+          m_saveBeforeIndex(saveBeforeIndex)
+    {
+    }
+
+  private:
+    void DoRun() override;
+    bool m_saveBeforeIndex{false}; //!< Save the vectors before assigning the dense index
+};
+
+void
+TestBeamManagerDenseStorage::DoRun()
+{
+    const uint32_t numDevices = 4;
+
+    // Each BeamManager drives its own antenna, as it happens in the PHY
+    Ptr<UniformPlanarArray> mapAntenna = CreateObject<UniformPlanarArray>();
+    Ptr<UniformPlanarArray> antenna = CreateObject<UniformPlanarArray>();
+    for (const auto& a : {mapAntenna, antenna})
+    {
+        a->SetAttribute("NumRows", UintegerValue(4));
+        a->SetAttribute("NumColumns", UintegerValue(4));
+    }
+
+    Ptr<BeamManager> mapBm = CreateObject<BeamManager>();
+    Ptr<BeamManager> denseBm = CreateObject<BeamManager>();
+    denseBm->SetAttribute("DenseStorage", BooleanValue(true));
+    mapBm->Configure(mapAntenna);
+    denseBm->Configure(antenna);
+
+    std::vector<Ptr<NetDevice>> devices;
+    std::vector<BeamformingVector> bfvs;
+    for (uint32_t i = 0; i < numDevices; ++i)
+    {
+        devices.push_back(CreateObject<SimpleNetDevice>());
+        bfvs.emplace_back(CreateDirectionalBfv(antenna, i, 90.0), BeamId(i, 90.0));
+    }
+
+    for (uint32_t i = 0; i < numDevices; ++i)
+    {
+        if (m_saveBeforeIndex)
+        {
+            denseBm->SaveBeamformingVector(bfvs[i], devices[i]);
+            denseBm->SetDeviceIndex(devices[i], i);
+        }
+        else
+        {
+            denseBm->SetDeviceIndex(devices[i], i);
+            denseBm->SaveBeamformingVector(bfvs[i], devices[i]);
+        }
+        mapBm->SaveBeamformingVector(bfvs[i], devices[i]);
+    }
+
+    auto check = [&](uint32_t i, const std::string& msg) {
+        mapBm->ChangeBeamformingVector(devices[i]);
+        PhasedArrayModel::ComplexVector expected = mapAntenna->GetBeamformingVector();
+        denseBm->ChangeBeamformingVector(i);
+        NS_TEST_ASSERT_MSG_EQ((antenna->GetBeamformingVector() == expected), true, msg);
+        NS_TEST_ASSERT_MSG_EQ(denseBm->GetBeamId(devices[i]), bfvs[i].second, msg);
+    };
+
+    for (uint32_t i = 0; i < numDevices; ++i)
+    {
+        check(i, "Dense beam switch differs from the device-based switch");
+    }
+
+    // The active beam is changed by another method: the dense switch must restore it
+    denseBm->ChangeBeamformingVector(1);
+    denseBm->ChangeToQuasiOmniBeamformingVector();
+    check(1, "Dense beam switch after quasi-omni did not restore the beam");
+
+    // The vector of the active slot is updated
+    denseBm->ChangeBeamformingVector(2);
+    BeamformingVector updated = std::make_pair(CreateDirectionalBfv(antenna, 7, 60.0),
+                                               BeamId(7, 60.0));
+    bfvs[2] = updated;
+    denseBm->SaveBeamformingVector(updated, devices[2]);
+    mapBm->SaveBeamformingVector(updated, devices[2]);
+    check(2, "Dense beam switch did not use the updated vector");
+}
+
+/**
+ * \brief The beam switches of the var-TTIs of a slot: the control var-TTIs use
+ * the quasi-omni vector, the data var-TTIs the vector of their UE. The antenna
+ * weights must be written only when the beam changes.
+ */
+class TestBeamManagerVarTtiWrites : public TestCase
+{
+  public:
+    TestBeamManagerVarTtiWrites()
+        : TestCase("Dense storage, antenna writes over the var-TTIs")
+    {
+    }
+
+  private:
+    void DoRun() override;
+};
+
+void
+TestBeamManagerVarTtiWrites::DoRun()
+{
+    Ptr<UniformPlanarArray> antenna = CreateObject<UniformPlanarArray>();
+    antenna->SetAttribute("NumRows", UintegerValue(4));
+    antenna->SetAttribute("NumColumns", UintegerValue(4));
+
+    Ptr<BeamManager> bm = CreateObject<BeamManager>();
+    bm->SetAttribute("DenseStorage", BooleanValue(true));
+    bm->Configure(antenna);
+
+    std::vector<Ptr<NetDevice>> devices;
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        devices.push_back(CreateObject<SimpleNetDevice>());
+        bm->SetDeviceIndex(devices[i], i);
+        bm->SaveBeamformingVector(
+            std::make_pair(CreateDirectionalBfv(antenna, i, 90.0), BeamId(i, 90.0)),
+            devices[i]);
+    }
+
+    // A write is detected by placing a marker in the antenna before the switch:
+    // if the marker is still there, the switch kept the weights, which are restored
+    const PhasedArrayModel::ComplexVector marker(antenna->GetNumElems());
+    uint32_t writes = 0;
+    auto countWrite = [&](const std::function<void()>& beamSwitch) {
+        PhasedArrayModel::ComplexVector previous = antenna->GetBeamformingVector();
+        antenna->SetBeamformingVector(marker);
+        beamSwitch();
+        if (antenna->GetBeamformingVector() == marker)
+        {
+            antenna->SetBeamformingVector(previous);
+        }
+        else
+        {
+            ++writes;
+        }
+    };
+    auto ctrl = [&]() { countWrite([&]() { bm->ChangeToQuasiOmniBeamformingVector(); }); };
+    auto data = [&](uint32_t i) { countWrite([&]() { bm->ChangeBeamformingVector(i); }); };
+
+    // DL control: Configure already set the quasi-omni vector
+    ctrl();
+    NS_TEST_ASSERT_MSG_EQ(writes, 0, "Quasi-omni vector written again");
+
+    // Four data var-TTIs of the same UE
+    data(0);
+    data(0);
+    data(0);
+    data(0);
+    NS_TEST_ASSERT_MSG_EQ(writes, 1, "Weights rewritten in the var-TTIs of the same UE");
+
+    // UL control, then the data var-TTIs of two UEs
+    ctrl();
+    ctrl();
+    NS_TEST_ASSERT_MSG_EQ(writes, 2, "Quasi-omni vector written in consecutive control var-TTIs");
+    data(0);
+    data(1);
+    data(1);
+    NS_TEST_ASSERT_MSG_EQ(writes, 4, "Weights not written at the change of UE");
+    NS_TEST_ASSERT_MSG_EQ((antenna->GetBeamformingVector() ==
+                           CreateDirectionalBfv(antenna, 1, 90.0)),
+                          true,
+                          "Wrong weights in the antenna");
+
+    // A new vector for the active UE must be written at its next var-TTI
+    bm->SaveBeamformingVector(std::make_pair(CreateDirectionalBfv(antenna, 5, 60.0),
+                                             BeamId(5, 60.0)),
+                              devices[1]);
+    data(1);
+    NS_TEST_ASSERT_MSG_EQ(writes, 5, "Updated vector of the active UE not written");
+    ctrl();
+    NS_TEST_ASSERT_MSG_EQ(writes, 6, "Quasi-omni vector not written after a UE beam");
+}
+
+class TestBeamManager : public TestSuite
+{
+  public:
+    TestBeamManager()
+        : TestSuite("nr-test-beam-manager", UNIT)
+    {
+        AddTestCase(new TestBeamManagerDenseStorage(false, "Dense storage, index then save"),
+                    QUICK);
+        AddTestCase(new TestBeamManagerDenseStorage(true, "Dense storage, save then index"),
+                    QUICK);
+        AddTestCase(new TestBeamManagerVarTtiWrites(), QUICK);
+    }
+};
+
+static TestBeamManager testBeamManager; //!< BeamManager test
+
+} // namespace ns3
@@ -0,0 +1,405 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include <ns3/antenna-module.h>
+#include <ns3/applications-module.h>
+#include <ns3/boolean.h>
+#include <ns3/bwp-manager-algorithm.h>
+#include <ns3/core-module.h>
+#include <ns3/double.h>
+#include <ns3/internet-module.h>
+#include <ns3/mobility-module.h>
+#include <ns3/nr-module.h>
+#include <ns3/point-to-point-module.h>
+#include <ns3/test.h>
+#include <ns3/uinteger.h>
+
+#include <set>
+
+/**
+ * \file nr-test-bwp-load-aware.cc
+ * \ingroup test
+ *
+ * \brief Unit-testing for the load-aware BWP manager algorithm. The test
+ * checks the shares of a data flow among two BWPs of the same bandwidth when
+ * the CQI of the UE and the PRB occupancy of the BWPs change, with and
+ * without the splitting of the flows, and the effect of the hysteresis. A
+ * simulation with DL mini-slots checks that the gNB MAC reports the PRB
+ * occupancy of the slots only, and not of the mini-slots.
+ */
+namespace ns3
+{
+
+class TestBwpLoadAwareShares : public TestCase
+{
+  public:
+    TestBwpLoadAwareShares()
+        : TestCase("Shares of a flow among the BWPs")
+    {
+    }
+
+  private:
+    void DoRun() override;
+};
+
+void
+TestBwpLoadAwareShares::DoRun()
+{
+    const uint16_t rnti = 1;
+    const uint8_t lcid = 3;
+    const auto qci = EpsBearer::NGBR_VIDEO_TCP_DEFAULT;
+
+    Ptr<BwpManagerAlgorithmLoadAware> algo = CreateObject<BwpManagerAlgorithmLoadAware>();
+    algo->SetAttribute("NGBR_VIDEO_TCP_DEFAULT", UintegerValue(1));
+    algo->SetAttribute("Smoothing", DoubleValue(1.0));
+
+    auto shares = algo->GetBwpSharesForFlow(rnti, lcid, qci);
+    NS_TEST_ASSERT_MSG_EQ(shares.size(), 1, "Without BWPs, the flow must use the QCI BWP");
+    NS_TEST_ASSERT_MSG_EQ_TOL(shares.at(1), 1.0, 1e-9, "Wrong share of the QCI BWP");
+
+    algo->NotifyBwpBandwidth(0, 100);
+    algo->NotifyBwpBandwidth(1, 100);
+    algo->NotifyBwpBandwidth(2, 0);
+    shares = algo->GetBwpSharesForFlow(rnti, lcid, qci);
+    NS_TEST_ASSERT_MSG_EQ_TOL(shares.at(0), 0.5, 1e-9, "Without CQI, equal shares expected");
+    NS_TEST_ASSERT_MSG_EQ_TOL(shares.at(1), 0.5, 1e-9, "Without CQI, equal shares expected");
+    NS_TEST_ASSERT_MSG_EQ(shares.count(2), 0, "A BWP without DL must not serve the flow");
+
+    algo->NotifyDlCqi(rnti, 0, {12});
+    algo->NotifyDlCqi(rnti, 1, {4});
+    shares = algo->GetBwpSharesForFlow(rnti, lcid, qci);
+    NS_TEST_ASSERT_MSG_EQ_TOL(shares.at(0), 0.75, 1e-9, "Shares must follow the CQI");
+    NS_TEST_ASSERT_MSG_EQ_TOL(shares.at(1), 0.25, 1e-9, "Shares must follow the CQI");
+
+    algo->NotifyDlCqi(rnti, 0, {11});
+    shares = algo->GetBwpSharesForFlow(rnti, lcid, qci);
+    NS_TEST_ASSERT_MSG_EQ_TOL(shares.at(0),
+                              0.75,
+                              1e-9,
+                              "A change below the hysteresis must keep the shares");
+
+    algo->NotifyBwpLoad(0, 0.95);
+    shares = algo->GetBwpSharesForFlow(rnti, lcid, qci);
+    NS_TEST_ASSERT_MSG_EQ_TOL(shares.at(0),
+                              110.0 / 510.0,
+                              1e-9,
+                              "A loaded BWP must keep its minimum free share");
+    NS_TEST_ASSERT_MSG_EQ_TOL(shares.at(1), 400.0 / 510.0, 1e-9, "Shares must follow the load");
+    NS_TEST_ASSERT_MSG_EQ_TOL(algo->GetBwpLoad(0), 0.95, 1e-9, "Wrong load of the BWP");
+
+    algo->NotifyDlCqi(rnti + 1, 1, {4, 4});
+    shares = algo->GetBwpSharesForFlow(rnti + 1, lcid, qci);
+    NS_TEST_ASSERT_MSG_EQ_TOL(shares.at(1),
+                              800.0 / 870.0,
+                              1e-9,
+                              "The CQI of all the streams must count, for each UE");
+}
+
+class TestBwpLoadAwareNoSplit : public TestCase
+{
+  public:
+    TestBwpLoadAwareNoSplit()
+        : TestCase("Steering of a whole flow among the BWPs")
+    {
+    }
+
+  private:
+    void DoRun() override;
+};
+
+void
+TestBwpLoadAwareNoSplit::DoRun()
+{
+    const uint16_t rnti = 1;
+    const uint8_t lcid = 3;
+    const auto qci = EpsBearer::NGBR_VIDEO_TCP_DEFAULT;
+
+    Ptr<BwpManagerAlgorithmLoadAware> algo = CreateObject<BwpManagerAlgorithmLoadAware>();
+    algo->SetAttribute("SplitBearers", BooleanValue(false));
+    algo->SetAttribute("Hysteresis", DoubleValue(0.2));
+    algo->NotifyBwpBandwidth(0, 100);
+    algo->NotifyBwpBandwidth(1, 100);
+
+    auto shares = algo->GetBwpSharesForFlow(rnti, lcid, qci);
+    NS_TEST_ASSERT_MSG_EQ_TOL(shares.at(0), 1.0, 1e-9, "The whole flow must go to one BWP");
+
+    algo->NotifyDlCqi(rnti, 0, {7});
+    algo->NotifyDlCqi(rnti, 1, {8});
+    shares = algo->GetBwpSharesForFlow(rnti, lcid, qci);
+    NS_TEST_ASSERT_MSG_EQ_TOL(shares.at(0),
+                              1.0,
+                              1e-9,
+                              "A gain below the hysteresis must not move the flow");
+
+    algo->NotifyDlCqi(rnti, 1, {9});
+    shares = algo->GetBwpSharesForFlow(rnti, lcid, qci);
+    NS_TEST_ASSERT_MSG_EQ_TOL(shares.at(0), 0.0, 1e-9, "The old BWP must be emptied");
+    NS_TEST_ASSERT_MSG_EQ_TOL(shares.at(1), 1.0, 1e-9, "The flow must move to the best BWP");
+}
+
+/**
+ * \brief A gNB with 2-symbol mini-slots serves a saturating DL flow and a
+ * delay-critical one, which the scheduler serves in the mini-slots. The PRB
+ * occupancy must not be reported when a mini-slot is scheduled, and must
+ * reflect the load of the saturating flow.
+ */
+class TestBwpLoadAwareMiniSlot : public TestCase
+{
+  public:
+    TestBwpLoadAwareMiniSlot()
+        : TestCase("PRB occupancy of the slots with DL mini-slots")
+    {
+    }
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief The gNB MAC reported the PRB occupancy of a BWP
+     * \param test the test
+     * \param bwpId the BWP
+     * \param prbOccupancy the occupancy
+     */
+    static void PrbOccupancy(TestBwpLoadAwareMiniSlot* test, uint8_t bwpId, double prbOccupancy);
+
+    /**
+     * \brief The gNB PHY sent a DL mini-slot
+     * \param test the test
+     * \param sfnSf the slot
+     * \param rnti the RNTI of the allocation
+     * \param symStart the first symbol of the allocation
+     * \param numSym the symbols of the allocation
+     * \param tbSize the size of the TBs of the allocation
+     * \param bwpId the BWP ID
+     * \param cellId the cell ID
+     */
+    static void DlMiniSlot(TestBwpLoadAwareMiniSlot* test,
+                           const SfnSf& sfnSf,
+                           uint16_t rnti,
+                           uint8_t symStart,
+                           uint8_t numSym,
+                           uint32_t tbSize,
+                           uint16_t bwpId,
+                           uint16_t cellId);
+
+    std::set<Time> m_miniSlotTimes; //!< Times of the mini-slots
+    std::set<Time> m_sampleTimes;   //!< Times of the PRB occupancy reports
+    uint32_t m_numSamples{0};       //!< PRB occupancy reports with traffic
+    double m_sumOccupancy{0.0};     //!< Sum of the PRB occupancy with traffic
+    Time m_appStartTime{MilliSeconds(300)}; //!< Start of the traffic
+};
+
+void
+TestBwpLoadAwareMiniSlot::PrbOccupancy(TestBwpLoadAwareMiniSlot* test,
+                                       uint8_t bwpId,
+                                       double prbOccupancy)
+{
+    test->m_sampleTimes.insert(Simulator::Now());
+    if (Simulator::Now() > test->m_appStartTime + MilliSeconds(50))
+    {
+        ++test->m_numSamples;
+        test->m_sumOccupancy += prbOccupancy;
+    }
+}
+
+void
+TestBwpLoadAwareMiniSlot::DlMiniSlot(TestBwpLoadAwareMiniSlot* test,
+                                     const SfnSf& sfnSf,
+                                     uint16_t rnti,
+                                     uint8_t symStart,
+                                     uint8_t numSym,
+                                     uint32_t tbSize,
+                                     uint16_t bwpId,
+                                     uint16_t cellId)
+{
+    test->m_miniSlotTimes.insert(Simulator::Now());
+}
+
+void
+TestBwpLoadAwareMiniSlot::DoRun()
+{
+    RngSeedManager::SetSeed(1);
+    RngSeedManager::SetRun(1);
+    Config::SetDefault("ns3::LteRlcUm::MaxTxBufferSize", UintegerValue(999999999));
+
+    const Time simTime = MilliSeconds(500);
+
+    NodeContainer gnbNodes;
+    gnbNodes.Create(1);
+    NodeContainer ueNodes;
+    ueNodes.Create(2); // The saturating flow, then the delay-critical one
+
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.Install(gnbNodes);
+    mobility.Install(ueNodes);
+    gnbNodes.Get(0)->GetObject<MobilityModel>()->SetPosition(Vector(0.0, 0.0, 10.0));
+    ueNodes.Get(0)->GetObject<MobilityModel>()->SetPosition(Vector(50.0, 0.0, 1.5));
+    ueNodes.Get(1)->GetObject<MobilityModel>()->SetPosition(Vector(0.0, 50.0, 1.5));
+
+    Ptr<NrPointToPointEpcHelper> epcHelper = CreateObject<NrPointToPointEpcHelper>();
+    Ptr<IdealBeamformingHelper> beamformingHelper = CreateObject<IdealBeamformingHelper>();
+    Ptr<NrHelper> nrHelper = CreateObject<NrHelper>();
+    nrHelper->SetBeamformingHelper(beamformingHelper);
+    nrHelper->SetEpcHelper(epcHelper);
+    beamformingHelper->SetAttribute("BeamformingMethod",
+                                    TypeIdValue(DirectPathBeamforming::GetTypeId()));
+
+    nrHelper->SetSchedulerTypeId(NrMacSchedulerTdmaRR::GetTypeId());
+    nrHelper->SetGnbBwpManagerAlgorithmTypeId(BwpManagerAlgorithmLoadAware::GetTypeId());
+
+    CcBwpCreator ccBwpCreator;
+    CcBwpCreator::SimpleOperationBandConf bandConf(3.5e9,
+                                                   20e6,
+                                                   1,
+                                                   BandwidthPartInfo::UMi_StreetCanyon_LoS);
+    OperationBandInfo band = ccBwpCreator.CreateOperationBandContiguousCc(bandConf);
+    Config::SetDefault("ns3::ThreeGppChannelModel::UpdatePeriod", TimeValue(MilliSeconds(0)));
+    nrHelper->SetChannelConditionModelAttribute("UpdatePeriod", TimeValue(MilliSeconds(0)));
+    nrHelper->SetPathlossAttribute("ShadowingEnabled", BooleanValue(false));
+    nrHelper->InitializeOperationBand(&band);
+    BandwidthPartInfoPtrVector allBwps = CcBwpCreator::GetAllBwps({band});
+
+    epcHelper->SetAttribute("S1uLinkDelay", TimeValue(MilliSeconds(0)));
+
+    nrHelper->SetUeAntennaAttribute("NumRows", UintegerValue(1));
+    nrHelper->SetUeAntennaAttribute("NumColumns", UintegerValue(1));
+    nrHelper->SetUeAntennaAttribute("AntennaElement",
+                                    PointerValue(CreateObject<IsotropicAntennaModel>()));
+    nrHelper->SetGnbAntennaAttribute("NumRows", UintegerValue(4));
+    nrHelper->SetGnbAntennaAttribute("NumColumns", UintegerValue(4));
+    nrHelper->SetGnbAntennaAttribute("AntennaElement",
+                                     PointerValue(CreateObject<IsotropicAntennaModel>()));
+    nrHelper->SetGnbPhyAttribute("Numerology", UintegerValue(1));
+    nrHelper->SetGnbPhyAttribute("TxPower", DoubleValue(30));
+    nrHelper->SetGnbPhyAttribute("MiniSlotSymbols", UintegerValue(2));
+
+    NetDeviceContainer gnbNetDev = nrHelper->InstallGnbDevice(gnbNodes, allBwps);
+    NetDeviceContainer ueNetDev = nrHelper->InstallUeDevice(ueNodes, allBwps);
+
+    int64_t randomStream = 1;
+    randomStream += nrHelper->AssignStreams(gnbNetDev, randomStream);
+    randomStream += nrHelper->AssignStreams(ueNetDev, randomStream);
+
+    for (auto it = gnbNetDev.Begin(); it != gnbNetDev.End(); ++it)
+    {
+        DynamicCast<NrGnbNetDevice>(*it)->UpdateConfig();
+    }
+    for (auto it = ueNetDev.Begin(); it != ueNetDev.End(); ++it)
+    {
+        DynamicCast<NrUeNetDevice>(*it)->UpdateConfig();
+    }
+
+    Ptr<Node> pgw = epcHelper->GetPgwNode();
+    NodeContainer remoteHostContainer;
+    remoteHostContainer.Create(1);
+    Ptr<Node> remoteHost = remoteHostContainer.Get(0);
+    InternetStackHelper internet;
+    internet.Install(remoteHostContainer);
+
+    PointToPointHelper p2ph;
+    p2ph.SetDeviceAttribute("DataRate", DataRateValue(DataRate("100Gb/s")));
+    p2ph.SetDeviceAttribute("Mtu", UintegerValue(2500));
+    p2ph.SetChannelAttribute("Delay", TimeValue(Seconds(0.000)));
+    NetDeviceContainer internetDevices = p2ph.Install(pgw, remoteHost);
+    Ipv4AddressHelper ipv4h;
+    Ipv4StaticRoutingHelper ipv4RoutingHelper;
+    ipv4h.SetBase("1.0.0.0", "255.0.0.0");
+    ipv4h.Assign(internetDevices);
+    Ptr<Ipv4StaticRouting> remoteHostStaticRouting =
+        ipv4RoutingHelper.GetStaticRouting(remoteHost->GetObject<Ipv4>());
+    remoteHostStaticRouting->AddNetworkRouteTo(Ipv4Address("7.0.0.0"), Ipv4Mask("255.0.0.0"), 1);
+    internet.Install(ueNodes);
+
+    Ipv4InterfaceContainer ueIpIface = epcHelper->AssignUeIpv4Address(ueNetDev);
+    for (uint32_t j = 0; j < ueNodes.GetN(); ++j)
+    {
+        Ptr<Ipv4StaticRouting> ueStaticRouting =
+            ipv4RoutingHelper.GetStaticRouting(ueNodes.Get(j)->GetObject<Ipv4>());
+        ueStaticRouting->SetDefaultRoute(epcHelper->GetUeDefaultGatewayAddress(), 1);
+    }
+
+    nrHelper->AttachToClosestEnb(ueNetDev, gnbNetDev);
+
+    const uint16_t saturatingPort = 1234;
+    const uint16_t urllcPort = 1235;
+    ApplicationContainer serverApps;
+    ApplicationContainer clientApps;
+    UdpServerHelper saturatingPacketSink(saturatingPort);
+    serverApps.Add(saturatingPacketSink.Install(ueNodes.Get(0)));
+    UdpServerHelper urllcPacketSink(urllcPort);
+    serverApps.Add(urllcPacketSink.Install(ueNodes.Get(1)));
+
+    UdpClientHelper saturatingClient;
+    saturatingClient.SetAttribute("MaxPackets", UintegerValue(0xFFFFFFFF));
+    saturatingClient.SetAttribute("PacketSize", UintegerValue(1400));
+    saturatingClient.SetAttribute("Interval", TimeValue(MicroSeconds(100)));
+    saturatingClient.SetAttribute("RemotePort", UintegerValue(saturatingPort));
+    saturatingClient.SetAttribute("RemoteAddress", AddressValue(ueIpIface.GetAddress(0)));
+    clientApps.Add(saturatingClient.Install(remoteHost));
+
+    UdpClientHelper urllcClient;
+    urllcClient.SetAttribute("MaxPackets", UintegerValue(0xFFFFFFFF));
+    urllcClient.SetAttribute("PacketSize", UintegerValue(32));
+    urllcClient.SetAttribute("Interval", TimeValue(MicroSeconds(1100)));
+    urllcClient.SetAttribute("RemotePort", UintegerValue(urllcPort));
+    urllcClient.SetAttribute("RemoteAddress", AddressValue(ueIpIface.GetAddress(1)));
+    clientApps.Add(urllcClient.Install(remoteHost));
+
+    EpsBearer urllcBearer(EpsBearer::DGBR_DISCRETE_AUT_SMALL);
+    Ptr<EpcTft> urllcTft = Create<EpcTft>();
+    EpcTft::PacketFilter urllcPf;
+    urllcPf.localPortStart = urllcPort;
+    urllcPf.localPortEnd = urllcPort;
+    urllcTft->Add(urllcPf);
+    nrHelper->ActivateDedicatedEpsBearer(ueNetDev.Get(1), urllcBearer, urllcTft);
+
+    serverApps.Start(m_appStartTime);
+    clientApps.Start(m_appStartTime);
+    serverApps.Stop(simTime);
+    clientApps.Stop(simTime);
+
+    Ptr<BwpManagerGnb> bwpManager = NrHelper::GetBwpManagerGnb(gnbNetDev.Get(0));
+    bwpManager->TraceConnectWithoutContext(
+        "PrbOccupancy",
+        MakeBoundCallback(&TestBwpLoadAwareMiniSlot::PrbOccupancy, this));
+    Ptr<NrGnbPhy> gnbPhy = NrHelper::GetGnbPhy(gnbNetDev.Get(0), 0);
+    gnbPhy->TraceConnectWithoutContext(
+        "DlMiniSlot",
+        MakeBoundCallback(&TestBwpLoadAwareMiniSlot::DlMiniSlot, this));
+
+    Simulator::Stop(simTime);
+    Simulator::Run();
+    Simulator::Destroy();
+
+    NS_TEST_ASSERT_MSG_GT(m_miniSlotTimes.size(), 0, "No mini-slot was scheduled");
+    NS_TEST_ASSERT_MSG_GT(m_numSamples, 0, "No PRB occupancy was reported");
+    for (const auto& time : m_miniSlotTimes)
+    {
+        NS_TEST_ASSERT_MSG_EQ(m_sampleTimes.count(time),
+                              0,
+                              "PRB occupancy reported for the mini-slot at " << time.As(Time::US));
+    }
+    NS_TEST_ASSERT_MSG_GT(m_sumOccupancy / m_numSamples,
+                          0.5,
+                          "The PRB occupancy does not reflect the saturating flow");
+}
+
+class TestBwpLoadAwareSuite : public TestSuite
+{
+  public:
+    TestBwpLoadAwareSuite()
+        : TestSuite("nr-test-bwp-load-aware", UNIT)
+    {
+        AddTestCase(new TestBwpLoadAwareShares(), QUICK);
+        AddTestCase(new TestBwpLoadAwareNoSplit(), QUICK);
+        AddTestCase(new TestBwpLoadAwareMiniSlot(), QUICK);
+    }
+};
+
+static TestBwpLoadAwareSuite testBwpLoadAwareSuite; //!< Load-aware BWP manager test suite
+
+} // namespace ns3
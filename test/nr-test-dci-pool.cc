@@ -0,0 +1,105 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include <ns3/nr-mac-scheduler-dci-pool.h>
+#include <ns3/test.h>
+
+/**
+ * \file nr-test-dci-pool.cc
+ * \ingroup test
+ *
+ * \brief Unit-testing for the pool of DCIs of the scheduler. The test creates
+ * the DCIs of many slots, releasing each slot before creating the next one, and
+ * checks that the pool asks memory to the system only for the first slot, that
+ * the DCIs keep their values, and that a DCI can outlive its pool.
+ */
+namespace ns3
+{
+
+class TestDciPool : public TestCase
+{
+  public:
+    TestDciPool(uint32_t dciPerSlot, const std::string& name)
+        : TestCase(name),
+          m_dciPerSlot(dciPerSlot)
+    {
+    }
+
+  private:
+    void DoRun() override;
+    uint32_t m_dciPerSlot{0}; //!< Number of DCI alive at the same time
+};
+
+void
+TestDciPool::DoRun()
+{
+    std::vector<uint8_t> rbgBitmask(10, 1);
+    std::shared_ptr<DciInfoElementTdma> survivor;
+    uint64_t systemAllocations = 0;
+
+    {
+        NrMacSchedulerDciPool pool;
+        for (uint32_t slot = 0; slot < 20; ++slot)
+        {
+            std::vector<std::shared_ptr<DciInfoElementTdma>> dcis;
+            for (uint32_t i = 0; i < m_dciPerSlot; ++i)
+            {
+                dcis.push_back(pool.Create(i + 1,
+                                           DciInfoElementTdma::DL,
+                                           static_cast<uint8_t>(i % 14),
+                                           1,
+                                           std::vector<uint8_t>{static_cast<uint8_t>(slot)},
+                                           std::vector<uint32_t>{100 * i},
+                                           std::vector<uint8_t>{1},
+                                           std::vector<uint8_t>{0},
+                                           DciInfoElementTdma::DATA,
+                                           0,
+                                           1));
+            }
+            for (uint32_t i = 0; i < m_dciPerSlot; ++i)
+            {
+                NS_TEST_ASSERT_MSG_EQ(static_cast<uint32_t>(dcis[i]->m_rnti), i + 1, "Wrong RNTI");
+                NS_TEST_ASSERT_MSG_EQ(static_cast<uint32_t>(dcis[i]->m_mcs.at(0)),
+                                      slot,
+                                      "Wrong MCS");
+                NS_TEST_ASSERT_MSG_EQ(dcis[i]->m_tbSize.at(0), 100 * i, "Wrong TBS");
+            }
+            if (slot == 0)
+            {
+                systemAllocations = pool.GetNumSystemAllocations();
+                NS_TEST_ASSERT_MSG_GT(systemAllocations, 0, "The pool did not allocate memory");
+            }
+            else
+            {
+                NS_TEST_ASSERT_MSG_EQ(pool.GetNumSystemAllocations(),
+                                      systemAllocations,
+                                      "Released DCIs were not reused");
+            }
+        }
+        NS_TEST_ASSERT_MSG_EQ(pool.GetNumCreated(), 20 * m_dciPerSlot, "Wrong number of DCIs");
+
+        survivor = pool.Create(0, 1, DciInfoElementTdma::UL, DciInfoElementTdma::CTRL, rbgBitmask);
+    }
+
+    // The pool is gone, but the DCI is still valid
+    NS_TEST_ASSERT_MSG_EQ(survivor->m_format, DciInfoElementTdma::UL, "Wrong DCI format");
+    NS_TEST_ASSERT_MSG_EQ((survivor->m_rbgBitmask == rbgBitmask), true, "Wrong RBG bitmask");
+}
+
+class TestDciPoolSuite : public TestSuite
+{
+  public:
+    TestDciPoolSuite()
+        : TestSuite("nr-test-dci-pool", UNIT)
+    {
+        AddTestCase(new TestDciPool(1, "DCI pool, 1 DCI per slot"), QUICK);
+        AddTestCase(new TestDciPool(100, "DCI pool, 100 DCI per slot"), QUICK);
+    }
+};
+
+static TestDciPoolSuite testDciPoolSuite; //!< DCI pool test suite
+
+} // namespace ns3
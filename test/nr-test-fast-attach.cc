@@ -0,0 +1,216 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "ns3/antenna-module.h"
+#include "ns3/core-module.h"
+#include "ns3/lte-ue-rrc.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include "ns3/nr-module.h"
+
+#include <cmath>
+#include <set>
+
+/**
+ * \file nr-test-fast-attach.cc
+ * \ingroup test
+ *
+ * \brief System test of the fast attach of NrHelper. The UEs of a cell are
+ * attached, and a DRB is activated for each of them, with and without the
+ * random access. At the end, every UE must be connected with a different
+ * RNTI, and have its DRB at the UE and at the gNB. With the fast attach, the
+ * UEs must not send any RACH preamble, and must be connected all in the same
+ * instant, also when they are more than the preamble IDs.
+ */
+namespace ns3
+{
+
+class TestFastAttach : public TestCase
+{
+  public:
+    TestFastAttach(uint32_t ueNum, bool fastAttach, const std::string& name)
+        : TestCase(name),
+          m_ueNum(ueNum),
+          m_fastAttach(fastAttach)
+    {
+    }
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief A UE RRC is connected
+     * \param imsi the IMSI of the UE
+     * \param cellId the cell ID
+     * \param rnti the RNTI of the UE
+     */
+    void ConnectionEstablished(uint64_t imsi, uint16_t cellId, uint16_t rnti);
+
+    /**
+     * \brief A UE MAC sent a control message
+     * \param sfn the slot
+     * \param cellId the cell ID
+     * \param rnti the RNTI of the UE
+     * \param bwpId the BWP ID
+     * \param msg the message
+     */
+    void UeMacTxedCtrlMsg(SfnSf sfn,
+                          uint16_t cellId,
+                          uint16_t rnti,
+                          uint8_t bwpId,
+                          Ptr<const NrControlMessage> msg);
+
+    uint32_t m_ueNum{0};             //!< Number of UEs
+    bool m_fastAttach{false};        //!< Attach without random access
+    std::vector<Time> m_established; //!< Times of the connections of the UEs
+    uint32_t m_preambles{0};         //!< RACH preambles sent by the UEs
+};
+
+void
+TestFastAttach::ConnectionEstablished(uint64_t imsi, uint16_t cellId, uint16_t rnti)
+{
+    m_established.push_back(Simulator::Now());
+}
+
+void
+TestFastAttach::UeMacTxedCtrlMsg(SfnSf sfn,
+                                 uint16_t cellId,
+                                 uint16_t rnti,
+                                 uint8_t bwpId,
+                                 Ptr<const NrControlMessage> msg)
+{
+    if (msg->GetMessageType() == NrControlMessage::RACH_PREAMBLE)
+    {
+        ++m_preambles;
+    }
+}
+
+void
+TestFastAttach::DoRun()
+{
+    RngSeedManager::SetSeed(1);
+    RngSeedManager::SetRun(1);
+
+    NodeContainer gnbNodes;
+    NodeContainer ueNodes;
+    gnbNodes.Create(1);
+    ueNodes.Create(m_ueNum);
+
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.Install(gnbNodes);
+    mobility.Install(ueNodes);
+    gnbNodes.Get(0)->GetObject<MobilityModel>()->SetPosition(Vector(0.0, 0.0, 10.0));
+    for (uint32_t i = 0; i < m_ueNum; ++i)
+    {
+        const double angle = 2 * M_PI * i / m_ueNum;
+        ueNodes.Get(i)->GetObject<MobilityModel>()->SetPosition(
+            Vector(20.0 * std::cos(angle), 20.0 * std::sin(angle), 1.5));
+    }
+
+    Ptr<IdealBeamformingHelper> idealBeamformingHelper = CreateObject<IdealBeamformingHelper>();
+    Ptr<NrHelper> nrHelper = CreateObject<NrHelper>();
+    nrHelper->SetBeamformingHelper(idealBeamformingHelper);
+    nrHelper->SetAttribute("FastAttach", BooleanValue(m_fastAttach));
+    nrHelper->SetPathlossAttribute("ShadowingEnabled", BooleanValue(false));
+
+    CcBwpCreator ccBwpCreator;
+    CcBwpCreator::SimpleOperationBandConf bandConf(3.5e9,
+                                                   20e6,
+                                                   1,
+                                                   BandwidthPartInfo::UMa_LoS);
+    OperationBandInfo band = ccBwpCreator.CreateOperationBandContiguousCc(bandConf);
+    nrHelper->InitializeOperationBand(&band);
+    BandwidthPartInfoPtrVector allBwps = CcBwpCreator::GetAllBwps({band});
+
+    NetDeviceContainer gnbDevs = nrHelper->InstallGnbDevice(gnbNodes, allBwps);
+    NetDeviceContainer ueDevs = nrHelper->InstallUeDevice(ueNodes, allBwps);
+    for (auto it = gnbDevs.Begin(); it != gnbDevs.End(); ++it)
+    {
+        DynamicCast<NrGnbNetDevice>(*it)->UpdateConfig();
+    }
+    for (auto it = ueDevs.Begin(); it != ueDevs.End(); ++it)
+    {
+        DynamicCast<NrUeNetDevice>(*it)->UpdateConfig();
+    }
+
+    nrHelper->AttachToClosestEnb(ueDevs, gnbDevs);
+    nrHelper->ActivateDataRadioBearer(ueDevs, EpsBearer(EpsBearer::NGBR_VIDEO_TCP_DEFAULT));
+
+    for (uint32_t i = 0; i < m_ueNum; ++i)
+    {
+        Ptr<NrUeNetDevice> ueDev = DynamicCast<NrUeNetDevice>(ueDevs.Get(i));
+        ueDev->GetRrc()->TraceConnectWithoutContext(
+            "ConnectionEstablished",
+            MakeCallback(&TestFastAttach::ConnectionEstablished, this));
+        ueDev->GetMac(0)->TraceConnectWithoutContext(
+            "UeMacTxedCtrlMsgsTrace",
+            MakeCallback(&TestFastAttach::UeMacTxedCtrlMsg, this));
+    }
+
+    Simulator::Stop(MilliSeconds(150));
+    Simulator::Run();
+
+    std::set<uint16_t> rntis;
+    for (uint32_t i = 0; i < m_ueNum; ++i)
+    {
+        Ptr<LteUeRrc> ueRrc = DynamicCast<NrUeNetDevice>(ueDevs.Get(i))->GetRrc();
+        NS_TEST_ASSERT_MSG_EQ(ueRrc->GetState(),
+                              LteUeRrc::CONNECTED_NORMALLY,
+                              "UE " << i << " is not connected");
+        rntis.insert(ueRrc->GetRnti());
+
+        ObjectMapValue drbs;
+        ueRrc->GetAttribute("DataRadioBearerMap", drbs);
+        NS_TEST_ASSERT_MSG_EQ(drbs.GetN(), 1, "UE " << i << " must have its DRB");
+    }
+    NS_TEST_ASSERT_MSG_EQ(rntis.size(), m_ueNum, "The UEs must have different RNTIs");
+
+    ObjectMapValue ueManagers;
+    DynamicCast<NrGnbNetDevice>(gnbDevs.Get(0))->GetRrc()->GetAttribute("UeMap", ueManagers);
+    NS_TEST_ASSERT_MSG_EQ(ueManagers.GetN(), m_ueNum, "Wrong number of UEs at the gNB");
+    for (auto it = ueManagers.Begin(); it != ueManagers.End(); ++it)
+    {
+        ObjectMapValue drbs;
+        it->second->GetAttribute("DataRadioBearerMap", drbs);
+        NS_TEST_ASSERT_MSG_EQ(drbs.GetN(), 1, "The gNB must have the DRB of each UE");
+    }
+
+    NS_TEST_ASSERT_MSG_EQ(m_established.size(), m_ueNum, "Every UE must connect once");
+    if (m_fastAttach)
+    {
+        NS_TEST_ASSERT_MSG_EQ(m_preambles, 0, "No preamble must be sent with the fast attach");
+        for (const auto& t : m_established)
+        {
+            NS_TEST_ASSERT_MSG_EQ(t,
+                                  m_established.front(),
+                                  "The UEs must connect in the same instant");
+        }
+    }
+    else
+    {
+        NS_TEST_ASSERT_MSG_EQ(m_preambles, m_ueNum, "Each UE must send one preamble");
+    }
+
+    Simulator::Destroy();
+}
+
+class TestFastAttachSuite : public TestSuite
+{
+  public:
+    TestFastAttachSuite()
+        : TestSuite("nr-test-fast-attach", SYSTEM)
+    {
+        AddTestCase(new TestFastAttach(10, false, "Attach with random access"), QUICK);
+        AddTestCase(new TestFastAttach(10, true, "Fast attach"), QUICK);
+        AddTestCase(new TestFastAttach(300, true, "Fast attach, more UEs than preamble IDs"),
+                    EXTENSIVE);
+    }
+};
+
+static TestFastAttachSuite testFastAttachSuite; //!< Fast attach test suite
+
+} // namespace ns3
@@ -0,0 +1,147 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include <ns3/nr-mac-harq-vector.h>
+#include <ns3/test.h>
+#include <ns3/uniform-random-variable.h>
+
+/**
+ * \file nr-test-mac-harq-vector.cc
+ * \ingroup test
+ *
+ * \brief Unit-testing for the free-ID search of the NrMacHarqVector. The test
+ * inserts and erases processes in a random order, and checks that the ID
+ * returned by the bitmap is the first inactive ID found when traversing the
+ * processes, that the number of active processes is correct, and that no
+ * ID is available when the vector is full. A second test checks that a
+ * process reserved for a configured grant is not returned by the free-ID
+ * search, even when it is inactive, until it is released.
+ */
+namespace ns3
+{
+
+class TestMacHarqVector : public TestCase
+{
+  public:
+    TestMacHarqVector(uint8_t size, const std::string& name)
+        : TestCase(name),
+          m_size(size)
+    {
+    }
+
+  private:
+    void DoRun() override;
+    uint8_t m_size{0}; //!< Number of HARQ processes
+};
+
+void
+TestMacHarqVector::DoRun()
+{
+    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+    rng->SetStream(1);
+
+    NrMacHarqVector harq;
+    harq.SetMaxSize(m_size);
+
+    auto firstInactive = [&harq]() {
+        for (auto it = harq.CBegin(); it != harq.CEnd(); ++it)
+        {
+            if (!it->second.m_active)
+            {
+                return it->first;
+            }
+        }
+        return static_cast<uint8_t>(255);
+    };
+
+    std::vector<uint8_t> active;
+    for (uint32_t i = 0; i < 20 * static_cast<uint32_t>(m_size); ++i)
+    {
+        NS_TEST_ASSERT_MSG_EQ(+harq.FirstAvailableId(),
+                              +firstInactive(),
+                              "The bitmap does not return the first inactive process");
+
+        // Insert more often than erasing, to reach the full vector
+        bool insert = active.empty() || (harq.CanInsert() && rng->GetValue() < 0.6);
+        if (insert)
+        {
+            uint8_t id = 0;
+            HarqProcess process(true, HarqProcess::WAITING_FEEDBACK, 0, nullptr);
+            NS_TEST_ASSERT_MSG_EQ(harq.Insert(&id, process), true, "Insert failed");
+            active.push_back(id);
+        }
+        else
+        {
+            uint32_t idx = rng->GetInteger(0, active.size() - 1);
+            harq.Erase(active.at(idx));
+            active.erase(active.begin() + idx);
+        }
+        NS_TEST_ASSERT_MSG_EQ(harq.Size(), active.size(), "Wrong number of active processes");
+
+        if (!harq.CanInsert())
+        {
+            NS_TEST_ASSERT_MSG_EQ(+harq.FirstAvailableId(), 255, "Full vector has free IDs");
+        }
+    }
+}
+
+class TestMacHarqVectorReserve : public TestCase
+{
+  public:
+    TestMacHarqVectorReserve()
+        : TestCase("HARQ vector, reserved process")
+    {
+    }
+
+  private:
+    void DoRun() override;
+};
+
+void
+TestMacHarqVectorReserve::DoRun()
+{
+    NrMacHarqVector harq;
+    harq.SetMaxSize(2);
+
+    const uint8_t reserved = harq.Reserve();
+    NS_TEST_ASSERT_MSG_EQ(harq.IsReserved(reserved), true, "The process is not reserved");
+    NS_TEST_ASSERT_MSG_NE(+harq.FirstAvailableId(), +reserved, "Reserved process is available");
+
+    uint8_t id = 0;
+    HarqProcess process(true, HarqProcess::WAITING_FEEDBACK, 0, nullptr);
+    NS_TEST_ASSERT_MSG_EQ(harq.Insert(&id, process), true, "Insert failed");
+    NS_TEST_ASSERT_MSG_EQ(harq.CanInsert(), false, "The reserved process is not counted");
+    NS_TEST_ASSERT_MSG_EQ(+harq.FirstAvailableId(), 255, "Full vector has free IDs");
+
+    harq.InsertReserved(reserved, process);
+    harq.InsertReserved(reserved, process);
+    NS_TEST_ASSERT_MSG_EQ(harq.Size(), 2, "An occasion must overwrite the reserved process");
+
+    harq.Erase(reserved);
+    NS_TEST_ASSERT_MSG_EQ(harq.Size(), 1, "Wrong number of active processes");
+    NS_TEST_ASSERT_MSG_EQ(+harq.FirstAvailableId(), 255, "Erased reserved process is available");
+
+    harq.Release(reserved);
+    NS_TEST_ASSERT_MSG_EQ(+harq.FirstAvailableId(), +reserved, "Released process not available");
+    NS_TEST_ASSERT_MSG_EQ(harq.CanInsert(), true, "Released process cannot be inserted");
+}
+
+class TestMacHarqVectorSuite : public TestSuite
+{
+  public:
+    TestMacHarqVectorSuite()
+        : TestSuite("nr-test-mac-harq-vector", UNIT)
+    {
+        AddTestCase(new TestMacHarqVector(1, "HARQ vector, 1 process"), QUICK);
+        AddTestCase(new TestMacHarqVector(16, "HARQ vector, 16 processes"), QUICK);
+        AddTestCase(new TestMacHarqVector(100, "HARQ vector, 100 processes"), QUICK);
+        AddTestCase(new TestMacHarqVectorReserve(), QUICK);
+    }
+};
+
+static TestMacHarqVectorSuite testMacHarqVectorSuite; //!< HARQ vector test suite
+
+} // namespace ns3
@@ -0,0 +1,459 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "ns3/antenna-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include "ns3/nr-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+/**
+ * \file nr-test-mini-slot-preemption.cc
+ * \ingroup test
+ *
+ * \brief System test of the preemption of the DL eMBB allocations by the
+ * mini-slots. A gNB with 2-symbol mini-slots serves an eMBB UE, with a
+ * saturating DL flow on the default bearer, and a URLLC UE, with small DL
+ * packets on a delay-critical GBR bearer. The test checks that:
+ *
+ * - the gNB preempts some eMBB allocations, and sends the preemption
+ *   indication, which the eMBB UE receives;
+ * - the eMBB UE does not decode the preempted TBs, as they are not sent, and
+ *   NACKs them (NrSpectrumPhy::PreemptExpectedTb): the first HARQ feedback of
+ *   the process of each preempted TB is a NACK;
+ * - the URLLC UE receives its packets.
+ */
+namespace ns3
+{
+
+class TestMiniSlotPreemption : public TestCase
+{
+  public:
+    TestMiniSlotPreemption()
+        : TestCase("Preemption of the eMBB allocations by the DL mini-slots")
+    {
+    }
+
+    /**
+     * \brief The gNB preempted a DL allocation
+     * \param test the test
+     * \param sfnSf the slot
+     * \param rnti the RNTI of the allocation
+     * \param symStart the first symbol of the allocation
+     * \param numSym the symbols of the allocation
+     * \param tbSize the size of the TBs of the allocation
+     * \param bwpId the BWP ID
+     * \param cellId the cell ID
+     */
+    static void DlPreemption(TestMiniSlotPreemption* test,
+                             const SfnSf& sfnSf,
+                             uint16_t rnti,
+                             uint8_t symStart,
+                             uint8_t numSym,
+                             uint32_t tbSize,
+                             uint16_t bwpId,
+                             uint16_t cellId);
+
+    /**
+     * \brief The gNB sent a control message
+     * \param test the test
+     * \param sfnSf the slot
+     * \param nodeId the node ID
+     * \param rnti the RNTI
+     * \param bwpId the BWP ID
+     * \param msg the message
+     */
+    static void GnbTxedCtrlMsg(TestMiniSlotPreemption* test,
+                               SfnSf sfnSf,
+                               uint16_t nodeId,
+                               uint16_t rnti,
+                               uint8_t bwpId,
+                               Ptr<const NrControlMessage> msg);
+
+    /**
+     * \brief The eMBB UE received a control message
+     * \param test the test
+     * \param sfnSf the slot
+     * \param nodeId the node ID
+     * \param rnti the RNTI
+     * \param bwpId the BWP ID
+     * \param msg the message
+     */
+    static void UeRxedCtrlMsg(TestMiniSlotPreemption* test,
+                              SfnSf sfnSf,
+                              uint16_t nodeId,
+                              uint16_t rnti,
+                              uint8_t bwpId,
+                              Ptr<const NrControlMessage> msg);
+
+    /**
+     * \brief The eMBB UE sent a control message
+     * \param test the test
+     * \param sfnSf the slot
+     * \param nodeId the node ID
+     * \param rnti the RNTI
+     * \param bwpId the BWP ID
+     * \param msg the message
+     */
+    static void UeTxedCtrlMsg(TestMiniSlotPreemption* test,
+                              SfnSf sfnSf,
+                              uint16_t nodeId,
+                              uint16_t rnti,
+                              uint8_t bwpId,
+                              Ptr<const NrControlMessage> msg);
+
+    /**
+     * \brief The eMBB UE received a DL TB
+     * \param test the test
+     * \param params the reception
+     */
+    static void RxPacketTraceUe(TestMiniSlotPreemption* test, RxPacketTraceParams params);
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Slot (normalized) and first symbol of an allocation
+     */
+    using AllocationTime = std::pair<uint64_t, uint8_t>;
+
+    /**
+     * \brief A DL HARQ feedback of the eMBB UE
+     */
+    struct Feedback
+    {
+        Time m_time;        //!< Time of the feedback
+        uint8_t m_harqId;   //!< HARQ process
+        bool m_nack;        //!< True for a NACK
+    };
+
+    static constexpr uint16_t NUMEROLOGY = 1; //!< Numerology of the BWP
+
+    std::map<AllocationTime, Time> m_preempted;   //!< Preempted eMBB allocations, by time
+    std::map<AllocationTime, uint8_t> m_dlDcis;   //!< HARQ process of the eMBB DL DCIs
+    std::set<AllocationTime> m_receivedTbs;       //!< TBs received by the eMBB UE
+    std::vector<Feedback> m_feedback;             //!< DL HARQ feedback of the eMBB UE
+    uint16_t m_embbRnti{0};                       //!< RNTI of the eMBB UE
+    uint32_t m_numIndicationsSent{0};             //!< Preemption indications sent
+    uint32_t m_numIndicationsReceived{0};         //!< Preemption indications received
+};
+
+void
+TestMiniSlotPreemption::DlPreemption(TestMiniSlotPreemption* test,
+                                     const SfnSf& sfnSf,
+                                     uint16_t rnti,
+                                     uint8_t symStart,
+                                     uint8_t numSym,
+                                     uint32_t tbSize,
+                                     uint16_t bwpId,
+                                     uint16_t cellId)
+{
+    if (rnti == test->m_embbRnti)
+    {
+        test->m_preempted.emplace(std::make_pair(sfnSf.Normalize(), symStart), Simulator::Now());
+    }
+}
+
+void
+TestMiniSlotPreemption::GnbTxedCtrlMsg(TestMiniSlotPreemption* test,
+                                       SfnSf sfnSf,
+                                       uint16_t nodeId,
+                                       uint16_t rnti,
+                                       uint8_t bwpId,
+                                       Ptr<const NrControlMessage> msg)
+{
+    if (msg->GetMessageType() == NrControlMessage::DL_PREEMPTION)
+    {
+        ++test->m_numIndicationsSent;
+    }
+}
+
+void
+TestMiniSlotPreemption::UeRxedCtrlMsg(TestMiniSlotPreemption* test,
+                                      SfnSf sfnSf,
+                                      uint16_t nodeId,
+                                      uint16_t rnti,
+                                      uint8_t bwpId,
+                                      Ptr<const NrControlMessage> msg)
+{
+    if (msg->GetMessageType() == NrControlMessage::DL_PREEMPTION)
+    {
+        ++test->m_numIndicationsReceived;
+    }
+    else if (msg->GetMessageType() == NrControlMessage::DL_DCI)
+    {
+        auto dciMsg = DynamicCast<NrDlDciMessage>(ConstCast<NrControlMessage>(msg));
+        const auto dci = dciMsg->GetDciInfoElement();
+        if (dci->m_rnti == test->m_embbRnti && dci->m_type == DciInfoElementTdma::DATA)
+        {
+            test->m_dlDcis[std::make_pair(sfnSf.Normalize(), dci->m_symStart)] =
+                dci->m_harqProcess;
+        }
+    }
+}
+
+void
+TestMiniSlotPreemption::UeTxedCtrlMsg(TestMiniSlotPreemption* test,
+                                      SfnSf sfnSf,
+                                      uint16_t nodeId,
+                                      uint16_t rnti,
+                                      uint8_t bwpId,
+                                      Ptr<const NrControlMessage> msg)
+{
+    if (msg->GetMessageType() != NrControlMessage::DL_HARQ)
+    {
+        return;
+    }
+    auto harqMsg = DynamicCast<NrDlHarqFeedbackMessage>(ConstCast<NrControlMessage>(msg));
+    const DlHarqInfo harq = harqMsg->GetDlHarqFeedback();
+    Feedback feedback;
+    feedback.m_time = Simulator::Now();
+    feedback.m_harqId = harq.m_harqProcessId;
+    feedback.m_nack = !harq.IsReceivedOk();
+    test->m_feedback.push_back(feedback);
+}
+
+void
+TestMiniSlotPreemption::RxPacketTraceUe(TestMiniSlotPreemption* test, RxPacketTraceParams params)
+{
+    const SfnSf sfnSf(params.m_frameNum, params.m_subframeNum, params.m_slotNum, NUMEROLOGY);
+    test->m_receivedTbs.emplace(sfnSf.Normalize(), params.m_symStart);
+}
+
+void
+TestMiniSlotPreemption::DoRun()
+{
+    RngSeedManager::SetSeed(1);
+    RngSeedManager::SetRun(1);
+    Config::SetDefault("ns3::LteRlcUm::MaxTxBufferSize", UintegerValue(999999999));
+
+    const Time simTime = MilliSeconds(500);
+    const Time appStartTime = MilliSeconds(300);
+
+    NodeContainer gnbNodes;
+    gnbNodes.Create(1);
+    NodeContainer ueNodes;
+    ueNodes.Create(2); // The eMBB UE, then the URLLC UE
+
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.Install(gnbNodes);
+    mobility.Install(ueNodes);
+    gnbNodes.Get(0)->GetObject<MobilityModel>()->SetPosition(Vector(0.0, 0.0, 10.0));
+    ueNodes.Get(0)->GetObject<MobilityModel>()->SetPosition(Vector(50.0, 0.0, 1.5));
+    ueNodes.Get(1)->GetObject<MobilityModel>()->SetPosition(Vector(0.0, 50.0, 1.5));
+
+    Ptr<NrPointToPointEpcHelper> epcHelper = CreateObject<NrPointToPointEpcHelper>();
+    Ptr<IdealBeamformingHelper> beamformingHelper = CreateObject<IdealBeamformingHelper>();
+    Ptr<NrHelper> nrHelper = CreateObject<NrHelper>();
+    nrHelper->SetBeamformingHelper(beamformingHelper);
+    nrHelper->SetEpcHelper(epcHelper);
+    beamformingHelper->SetAttribute("BeamformingMethod",
+                                    TypeIdValue(DirectPathBeamforming::GetTypeId()));
+
+    nrHelper->SetSchedulerTypeId(NrMacSchedulerTdmaRR::GetTypeId());
+
+    CcBwpCreator ccBwpCreator;
+    CcBwpCreator::SimpleOperationBandConf bandConf(3.5e9,
+                                                   20e6,
+                                                   1,
+                                                   BandwidthPartInfo::UMi_StreetCanyon_LoS);
+    OperationBandInfo band = ccBwpCreator.CreateOperationBandContiguousCc(bandConf);
+    Config::SetDefault("ns3::ThreeGppChannelModel::UpdatePeriod", TimeValue(MilliSeconds(0)));
+    nrHelper->SetChannelConditionModelAttribute("UpdatePeriod", TimeValue(MilliSeconds(0)));
+    nrHelper->SetPathlossAttribute("ShadowingEnabled", BooleanValue(false));
+    nrHelper->InitializeOperationBand(&band);
+    BandwidthPartInfoPtrVector allBwps = CcBwpCreator::GetAllBwps({band});
+
+    epcHelper->SetAttribute("S1uLinkDelay", TimeValue(MilliSeconds(0)));
+
+    nrHelper->SetUeAntennaAttribute("NumRows", UintegerValue(1));
+    nrHelper->SetUeAntennaAttribute("NumColumns", UintegerValue(1));
+    nrHelper->SetUeAntennaAttribute("AntennaElement",
+                                    PointerValue(CreateObject<IsotropicAntennaModel>()));
+    nrHelper->SetGnbAntennaAttribute("NumRows", UintegerValue(4));
+    nrHelper->SetGnbAntennaAttribute("NumColumns", UintegerValue(4));
+    nrHelper->SetGnbAntennaAttribute("AntennaElement",
+                                     PointerValue(CreateObject<IsotropicAntennaModel>()));
+    nrHelper->SetGnbPhyAttribute("Numerology", UintegerValue(NUMEROLOGY));
+    nrHelper->SetGnbPhyAttribute("TxPower", DoubleValue(30));
+    nrHelper->SetGnbPhyAttribute("MiniSlotSymbols", UintegerValue(2));
+
+    NetDeviceContainer gnbNetDev = nrHelper->InstallGnbDevice(gnbNodes, allBwps);
+    NetDeviceContainer ueNetDev = nrHelper->InstallUeDevice(ueNodes, allBwps);
+
+    int64_t randomStream = 1;
+    randomStream += nrHelper->AssignStreams(gnbNetDev, randomStream);
+    randomStream += nrHelper->AssignStreams(ueNetDev, randomStream);
+
+    for (auto it = gnbNetDev.Begin(); it != gnbNetDev.End(); ++it)
+    {
+        DynamicCast<NrGnbNetDevice>(*it)->UpdateConfig();
+    }
+    for (auto it = ueNetDev.Begin(); it != ueNetDev.End(); ++it)
+    {
+        DynamicCast<NrUeNetDevice>(*it)->UpdateConfig();
+    }
+
+    Ptr<Node> pgw = epcHelper->GetPgwNode();
+    NodeContainer remoteHostContainer;
+    remoteHostContainer.Create(1);
+    Ptr<Node> remoteHost = remoteHostContainer.Get(0);
+    InternetStackHelper internet;
+    internet.Install(remoteHostContainer);
+
+    PointToPointHelper p2ph;
+    p2ph.SetDeviceAttribute("DataRate", DataRateValue(DataRate("100Gb/s")));
+    p2ph.SetDeviceAttribute("Mtu", UintegerValue(2500));
+    p2ph.SetChannelAttribute("Delay", TimeValue(Seconds(0.000)));
+    NetDeviceContainer internetDevices = p2ph.Install(pgw, remoteHost);
+    Ipv4AddressHelper ipv4h;
+    Ipv4StaticRoutingHelper ipv4RoutingHelper;
+    ipv4h.SetBase("1.0.0.0", "255.0.0.0");
+    ipv4h.Assign(internetDevices);
+    Ptr<Ipv4StaticRouting> remoteHostStaticRouting =
+        ipv4RoutingHelper.GetStaticRouting(remoteHost->GetObject<Ipv4>());
+    remoteHostStaticRouting->AddNetworkRouteTo(Ipv4Address("7.0.0.0"), Ipv4Mask("255.0.0.0"), 1);
+    internet.Install(ueNodes);
+
+    Ipv4InterfaceContainer ueIpIface = epcHelper->AssignUeIpv4Address(ueNetDev);
+    for (uint32_t j = 0; j < ueNodes.GetN(); ++j)
+    {
+        Ptr<Ipv4StaticRouting> ueStaticRouting =
+            ipv4RoutingHelper.GetStaticRouting(ueNodes.Get(j)->GetObject<Ipv4>());
+        ueStaticRouting->SetDefaultRoute(epcHelper->GetUeDefaultGatewayAddress(), 1);
+    }
+
+    nrHelper->AttachToClosestEnb(ueNetDev, gnbNetDev);
+
+    // A saturating eMBB flow on the default bearer, and a URLLC flow on a
+    // delay-critical GBR bearer, which the scheduler serves in the mini-slots
+    const uint16_t embbPort = 1234;
+    const uint16_t urllcPort = 1235;
+    ApplicationContainer serverApps;
+    ApplicationContainer clientApps;
+    UdpServerHelper embbPacketSink(embbPort);
+    serverApps.Add(embbPacketSink.Install(ueNodes.Get(0)));
+    UdpServerHelper urllcPacketSink(urllcPort);
+    serverApps.Add(urllcPacketSink.Install(ueNodes.Get(1)));
+
+    UdpClientHelper embbClient;
+    embbClient.SetAttribute("MaxPackets", UintegerValue(0xFFFFFFFF));
+    embbClient.SetAttribute("PacketSize", UintegerValue(1400));
+    embbClient.SetAttribute("Interval", TimeValue(MicroSeconds(100)));
+    embbClient.SetAttribute("RemotePort", UintegerValue(embbPort));
+    embbClient.SetAttribute("RemoteAddress", AddressValue(ueIpIface.GetAddress(0)));
+    clientApps.Add(embbClient.Install(remoteHost));
+
+    UdpClientHelper urllcClient;
+    urllcClient.SetAttribute("MaxPackets", UintegerValue(0xFFFFFFFF));
+    urllcClient.SetAttribute("PacketSize", UintegerValue(32));
+    urllcClient.SetAttribute("Interval", TimeValue(MicroSeconds(1100)));
+    urllcClient.SetAttribute("RemotePort", UintegerValue(urllcPort));
+    urllcClient.SetAttribute("RemoteAddress", AddressValue(ueIpIface.GetAddress(1)));
+    clientApps.Add(urllcClient.Install(remoteHost));
+
+    EpsBearer urllcBearer(EpsBearer::DGBR_DISCRETE_AUT_SMALL);
+    Ptr<EpcTft> urllcTft = Create<EpcTft>();
+    EpcTft::PacketFilter urllcPf;
+    urllcPf.localPortStart = urllcPort;
+    urllcPf.localPortEnd = urllcPort;
+    urllcTft->Add(urllcPf);
+    nrHelper->ActivateDedicatedEpsBearer(ueNetDev.Get(1), urllcBearer, urllcTft);
+
+    serverApps.Start(appStartTime);
+    clientApps.Start(appStartTime);
+    serverApps.Stop(simTime);
+    clientApps.Stop(simTime);
+
+    Ptr<NrGnbPhy> gnbPhy = NrHelper::GetGnbPhy(gnbNetDev.Get(0), 0);
+    gnbPhy->TraceConnectWithoutContext(
+        "DlPreemption",
+        MakeBoundCallback(&TestMiniSlotPreemption::DlPreemption, this));
+    gnbPhy->TraceConnectWithoutContext(
+        "GnbPhyTxedCtrlMsgsTrace",
+        MakeBoundCallback(&TestMiniSlotPreemption::GnbTxedCtrlMsg, this));
+    Ptr<NrUePhy> embbPhy = nrHelper->GetUePhy(ueNetDev.Get(0), 0);
+    embbPhy->TraceConnectWithoutContext(
+        "UePhyRxedCtrlMsgsTrace",
+        MakeBoundCallback(&TestMiniSlotPreemption::UeRxedCtrlMsg, this));
+    embbPhy->TraceConnectWithoutContext(
+        "UePhyTxedCtrlMsgsTrace",
+        MakeBoundCallback(&TestMiniSlotPreemption::UeTxedCtrlMsg, this));
+    embbPhy->GetSpectrumPhy()->TraceConnectWithoutContext(
+        "RxPacketTraceUe",
+        MakeBoundCallback(&TestMiniSlotPreemption::RxPacketTraceUe, this));
+
+    // The RNTI is known once the UE is connected
+    Simulator::Schedule(appStartTime, [this, &ueNetDev]() {
+        m_embbRnti = ueNetDev.Get(0)->GetObject<NrUeNetDevice>()->GetRrc()->GetRnti();
+    });
+
+    Simulator::Stop(simTime);
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_GT(m_preempted.size(), 0, "No eMBB allocation was preempted");
+    NS_TEST_ASSERT_MSG_GT(m_numIndicationsSent, 0, "No preemption indication was sent");
+    NS_TEST_ASSERT_MSG_GT(m_numIndicationsReceived,
+                          0,
+                          "The eMBB UE received no preemption indication");
+
+    for (const auto& [allocation, time] : m_preempted)
+    {
+        NS_TEST_ASSERT_MSG_EQ(m_receivedTbs.count(allocation),
+                              0,
+                              "The eMBB UE received a preempted TB");
+
+        auto dci = m_dlDcis.find(allocation);
+        NS_TEST_ASSERT_MSG_EQ((dci != m_dlDcis.end()),
+                              true,
+                              "The eMBB UE did not receive the DCI of a preempted TB");
+        const Time preemptionTime = time;
+        const uint8_t harqId = dci->second;
+        auto feedback =
+            std::find_if(m_feedback.begin(), m_feedback.end(), [&](const Feedback& f) {
+                return f.m_time >= preemptionTime && f.m_harqId == harqId;
+            });
+        if (feedback == m_feedback.end())
+        {
+            // Preempted at the end of the simulation
+            continue;
+        }
+        NS_TEST_ASSERT_MSG_EQ(feedback->m_nack,
+                              true,
+                              "The eMBB UE did not NACK the preempted TB of process "
+                                  << +harqId);
+    }
+
+    NS_TEST_ASSERT_MSG_GT(serverApps.Get(1)->GetObject<UdpServer>()->GetReceived(),
+                          0,
+                          "The URLLC UE received no packet");
+
+    Simulator::Destroy();
+}
+
+class TestMiniSlotPreemptionSuite : public TestSuite
+{
+  public:
+    TestMiniSlotPreemptionSuite()
+        : TestSuite("nr-test-mini-slot-preemption", SYSTEM)
+    {
+        AddTestCase(new TestMiniSlotPreemption(), QUICK);
+    }
+};
+
+static TestMiniSlotPreemptionSuite testMiniSlotPreemptionSuite; //!< Mini-slot preemption test suite
+
+} // namespace ns3
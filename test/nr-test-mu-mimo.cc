@@ -0,0 +1,348 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "ns3/antenna-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include "ns3/nr-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include <cmath>
+#include <map>
+#include <tuple>
+
+/**
+ * \file nr-test-mu-mimo.cc
+ * \ingroup test
+ *
+ * \brief System test of the MU-MIMO transmissions of the gNB PHY. A gNB serves
+ * two UEs, in two separated beams, with a saturating DL flow each. With
+ * EnableMuMimo, the scheduler co-schedules the two beams on the same symbols,
+ * as two layers, and the test checks that:
+ *
+ * - the TBs of the two UEs are sent at the same time, and both UEs decode
+ *   them, and receive their packets;
+ * - each layer is interference for the UE of the other layer: the SINR of
+ *   each co-scheduled TB is lower than its SNR.
+ *
+ * Without MU-MIMO, the two UEs never share the symbols, and the SINR of each
+ * TB is equal to its SNR, as there is no other cell: this validates the
+ * comparison of the two.
+ */
+namespace ns3
+{
+
+class TestMuMimo : public TestCase
+{
+  public:
+    TestMuMimo(bool enableMuMimo, const std::string& name)
+        : TestCase(name),
+          m_enableMuMimo(enableMuMimo)
+    {
+    }
+
+    /**
+     * \brief A UE computed the SNR of a DL data reception
+     * \param test the test
+     * \param ue the index of the UE
+     * \param sfnSf the slot
+     * \param cellId the cell ID
+     * \param bwpId the BWP ID
+     * \param streamId the stream ID
+     * \param imsi the IMSI of the UE
+     * \param snr the SNR, averaged over the bandwidth
+     */
+    static void DlDataSnr(TestMuMimo* test,
+                          uint32_t ue,
+                          const SfnSf& sfnSf,
+                          uint16_t cellId,
+                          uint8_t bwpId,
+                          uint8_t streamId,
+                          uint64_t imsi,
+                          double snr);
+
+    /**
+     * \brief A UE received a DL TB
+     * \param test the test
+     * \param ue the index of the UE
+     * \param params the reception
+     */
+    static void RxPacketTraceUe(TestMuMimo* test, uint32_t ue, RxPacketTraceParams params);
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief A TB received by a UE
+     */
+    struct Tb
+    {
+        double m_sinr{0.0};    //!< SINR of the TB, averaged over its RBs
+        double m_snr{0.0};     //!< SNR of the reception, averaged over the bandwidth
+        bool m_corrupt{false}; //!< The TB was not decoded
+    };
+
+    /**
+     * \brief Frame, subframe, slot and starting symbol of a TB
+     */
+    using TbTime = std::tuple<uint32_t, uint8_t, uint16_t, uint8_t>;
+
+    static constexpr uint32_t UE_NUM = 2; //!< UEs of the cell
+
+    bool m_enableMuMimo{false};         //!< Co-schedule the beams
+    uint32_t m_numRb{0};                //!< RBs of the bandwidth
+    std::map<TbTime, Tb> m_tbs[UE_NUM]; //!< Full-band TBs of each UE
+    double m_lastSnr[UE_NUM]{0.0, 0.0}; //!< SNR of the last reception of each UE
+};
+
+void
+TestMuMimo::DlDataSnr(TestMuMimo* test,
+                      uint32_t ue,
+                      const SfnSf& sfnSf,
+                      uint16_t cellId,
+                      uint8_t bwpId,
+                      uint8_t streamId,
+                      uint64_t imsi,
+                      double snr)
+{
+    test->m_lastSnr[ue] = snr;
+}
+
+void
+TestMuMimo::RxPacketTraceUe(TestMuMimo* test, uint32_t ue, RxPacketTraceParams params)
+{
+    // The SNR is averaged over the bandwidth, the SINR over the RBs of the TB
+    if (params.m_rbAssignedNum != test->m_numRb)
+    {
+        return;
+    }
+    Tb tb;
+    tb.m_sinr = params.m_sinr;
+    tb.m_snr = test->m_lastSnr[ue];
+    tb.m_corrupt = params.m_corrupt;
+    test->m_tbs[ue][std::make_tuple(params.m_frameNum,
+                                    params.m_subframeNum,
+                                    params.m_slotNum,
+                                    params.m_symStart)] = tb;
+}
+
+void
+TestMuMimo::DoRun()
+{
+    RngSeedManager::SetSeed(1);
+    RngSeedManager::SetRun(1);
+    Config::SetDefault("ns3::LteRlcUm::MaxTxBufferSize", UintegerValue(999999999));
+
+    const Time simTime = MilliSeconds(400);
+    const Time appStartTime = MilliSeconds(200);
+
+    NodeContainer gnbNodes;
+    gnbNodes.Create(1);
+    NodeContainer ueNodes;
+    ueNodes.Create(UE_NUM);
+
+    // The gNB antenna points to the positive x axis: the UEs are 120 degrees
+    // apart, in two separated beams
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.Install(gnbNodes);
+    mobility.Install(ueNodes);
+    gnbNodes.Get(0)->GetObject<MobilityModel>()->SetPosition(Vector(0.0, 0.0, 10.0));
+    for (uint32_t i = 0; i < UE_NUM; ++i)
+    {
+        const double angle = (i == 0 ? -60.0 : 60.0) * M_PI / 180;
+        ueNodes.Get(i)->GetObject<MobilityModel>()->SetPosition(
+            Vector(50.0 * std::cos(angle), 50.0 * std::sin(angle), 1.5));
+    }
+
+    Ptr<NrPointToPointEpcHelper> epcHelper = CreateObject<NrPointToPointEpcHelper>();
+    Ptr<IdealBeamformingHelper> beamformingHelper = CreateObject<IdealBeamformingHelper>();
+    Ptr<NrHelper> nrHelper = CreateObject<NrHelper>();
+    nrHelper->SetBeamformingHelper(beamformingHelper);
+    nrHelper->SetEpcHelper(epcHelper);
+    beamformingHelper->SetAttribute("BeamformingMethod",
+                                    TypeIdValue(CellScanBeamforming::GetTypeId()));
+
+    nrHelper->SetSchedulerTypeId(NrMacSchedulerOfdmaRR::GetTypeId());
+    nrHelper->SetSchedulerAttribute("EnableMuMimo", BooleanValue(m_enableMuMimo));
+
+    CcBwpCreator ccBwpCreator;
+    CcBwpCreator::SimpleOperationBandConf bandConf(28e9, 50e6, 1, BandwidthPartInfo::UMa_LoS);
+    OperationBandInfo band = ccBwpCreator.CreateOperationBandContiguousCc(bandConf);
+    Config::SetDefault("ns3::ThreeGppChannelModel::UpdatePeriod", TimeValue(MilliSeconds(0)));
+    nrHelper->SetChannelConditionModelAttribute("UpdatePeriod", TimeValue(MilliSeconds(0)));
+    nrHelper->SetPathlossAttribute("ShadowingEnabled", BooleanValue(false));
+    nrHelper->InitializeOperationBand(&band);
+    BandwidthPartInfoPtrVector allBwps = CcBwpCreator::GetAllBwps({band});
+
+    epcHelper->SetAttribute("S1uLinkDelay", TimeValue(MilliSeconds(0)));
+
+    nrHelper->SetUeAntennaAttribute("NumRows", UintegerValue(2));
+    nrHelper->SetUeAntennaAttribute("NumColumns", UintegerValue(2));
+    nrHelper->SetUeAntennaAttribute("AntennaElement",
+                                    PointerValue(CreateObject<IsotropicAntennaModel>()));
+    nrHelper->SetGnbAntennaAttribute("NumRows", UintegerValue(8));
+    nrHelper->SetGnbAntennaAttribute("NumColumns", UintegerValue(8));
+    nrHelper->SetGnbAntennaAttribute("AntennaElement",
+                                     PointerValue(CreateObject<ThreeGppAntennaModel>()));
+    nrHelper->SetGnbPhyAttribute("Numerology", UintegerValue(1));
+    nrHelper->SetGnbPhyAttribute("TxPower", DoubleValue(30));
+
+    NetDeviceContainer gnbNetDev = nrHelper->InstallGnbDevice(gnbNodes, allBwps);
+    NetDeviceContainer ueNetDev = nrHelper->InstallUeDevice(ueNodes, allBwps);
+
+    int64_t randomStream = 1;
+    randomStream += nrHelper->AssignStreams(gnbNetDev, randomStream);
+    randomStream += nrHelper->AssignStreams(ueNetDev, randomStream);
+
+    for (auto it = gnbNetDev.Begin(); it != gnbNetDev.End(); ++it)
+    {
+        DynamicCast<NrGnbNetDevice>(*it)->UpdateConfig();
+    }
+    for (auto it = ueNetDev.Begin(); it != ueNetDev.End(); ++it)
+    {
+        DynamicCast<NrUeNetDevice>(*it)->UpdateConfig();
+    }
+
+    Ptr<Node> pgw = epcHelper->GetPgwNode();
+    NodeContainer remoteHostContainer;
+    remoteHostContainer.Create(1);
+    Ptr<Node> remoteHost = remoteHostContainer.Get(0);
+    InternetStackHelper internet;
+    internet.Install(remoteHostContainer);
+
+    PointToPointHelper p2ph;
+    p2ph.SetDeviceAttribute("DataRate", DataRateValue(DataRate("100Gb/s")));
+    p2ph.SetDeviceAttribute("Mtu", UintegerValue(2500));
+    p2ph.SetChannelAttribute("Delay", TimeValue(Seconds(0.000)));
+    NetDeviceContainer internetDevices = p2ph.Install(pgw, remoteHost);
+    Ipv4AddressHelper ipv4h;
+    Ipv4StaticRoutingHelper ipv4RoutingHelper;
+    ipv4h.SetBase("1.0.0.0", "255.0.0.0");
+    ipv4h.Assign(internetDevices);
+    Ptr<Ipv4StaticRouting> remoteHostStaticRouting =
+        ipv4RoutingHelper.GetStaticRouting(remoteHost->GetObject<Ipv4>());
+    remoteHostStaticRouting->AddNetworkRouteTo(Ipv4Address("7.0.0.0"), Ipv4Mask("255.0.0.0"), 1);
+    internet.Install(ueNodes);
+
+    Ipv4InterfaceContainer ueIpIface = epcHelper->AssignUeIpv4Address(ueNetDev);
+    for (uint32_t j = 0; j < ueNodes.GetN(); ++j)
+    {
+        Ptr<Ipv4StaticRouting> ueStaticRouting =
+            ipv4RoutingHelper.GetStaticRouting(ueNodes.Get(j)->GetObject<Ipv4>());
+        ueStaticRouting->SetDefaultRoute(epcHelper->GetUeDefaultGatewayAddress(), 1);
+    }
+
+    nrHelper->AttachToClosestEnb(ueNetDev, gnbNetDev);
+
+    // A saturating DL flow per UE, on the default bearer
+    const uint16_t dlPort = 1234;
+    const uint32_t packetSize = 1000;
+    ApplicationContainer serverApps;
+    ApplicationContainer clientApps;
+    UdpServerHelper dlPacketSink(dlPort);
+    serverApps.Add(dlPacketSink.Install(ueNodes));
+
+    UdpClientHelper dlClient;
+    dlClient.SetAttribute("RemotePort", UintegerValue(dlPort));
+    dlClient.SetAttribute("MaxPackets", UintegerValue(0xFFFFFFFF));
+    dlClient.SetAttribute("PacketSize", UintegerValue(packetSize));
+    dlClient.SetAttribute("Interval", TimeValue(MicroSeconds(40)));
+    for (uint32_t j = 0; j < ueNodes.GetN(); ++j)
+    {
+        dlClient.SetAttribute("RemoteAddress", AddressValue(ueIpIface.GetAddress(j)));
+        clientApps.Add(dlClient.Install(remoteHost));
+    }
+    serverApps.Start(appStartTime);
+    clientApps.Start(appStartTime);
+    serverApps.Stop(simTime);
+    clientApps.Stop(simTime);
+
+    for (uint32_t i = 0; i < UE_NUM; ++i)
+    {
+        Ptr<NrSpectrumPhy> spectrumPhy = nrHelper->GetUePhy(ueNetDev.Get(i), 0)->GetSpectrumPhy();
+        m_numRb = spectrumPhy->GetRxSpectrumModel()->GetNumBands();
+        spectrumPhy->TraceConnectWithoutContext("DlDataSnrTrace",
+                                                MakeBoundCallback(&TestMuMimo::DlDataSnr, this, i));
+        spectrumPhy->TraceConnectWithoutContext(
+            "RxPacketTraceUe",
+            MakeBoundCallback(&TestMuMimo::RxPacketTraceUe, this, i));
+    }
+
+    Simulator::Stop(simTime);
+    Simulator::Run();
+
+    uint32_t coScheduled = 0;
+    uint32_t decoded[UE_NUM]{0, 0};
+    for (const auto& [time, tb] : m_tbs[0])
+    {
+        auto other = m_tbs[1].find(time);
+        if (other == m_tbs[1].end())
+        {
+            continue;
+        }
+        ++coScheduled;
+        for (uint32_t i = 0; i < UE_NUM; ++i)
+        {
+            const Tb& ueTb = i == 0 ? tb : other->second;
+            NS_TEST_ASSERT_MSG_LT(ueTb.m_sinr,
+                                  ueTb.m_snr * (1 - 1e-6),
+                                  "The other layer is not interference for UE " << i);
+            decoded[i] += ueTb.m_corrupt ? 0 : 1;
+        }
+    }
+
+    for (uint32_t i = 0; i < UE_NUM; ++i)
+    {
+        NS_TEST_ASSERT_MSG_GT(m_tbs[i].size(), 0, "UE " << i << " received no full-band TB");
+        NS_TEST_ASSERT_MSG_GT(serverApps.Get(i)->GetObject<UdpServer>()->GetReceived(),
+                              0,
+                              "UE " << i << " received no packet");
+    }
+
+    if (m_enableMuMimo)
+    {
+        NS_TEST_ASSERT_MSG_GT(coScheduled, 0, "The UEs were never co-scheduled");
+        for (uint32_t i = 0; i < UE_NUM; ++i)
+        {
+            NS_TEST_ASSERT_MSG_GT(decoded[i], 0, "UE " << i << " decoded no co-scheduled TB");
+        }
+    }
+    else
+    {
+        NS_TEST_ASSERT_MSG_EQ(coScheduled, 0, "The UEs were co-scheduled without MU-MIMO");
+        for (uint32_t i = 0; i < UE_NUM; ++i)
+        {
+            for (const auto& [time, tb] : m_tbs[i])
+            {
+                NS_TEST_ASSERT_MSG_EQ_TOL(tb.m_sinr,
+                                          tb.m_snr,
+                                          tb.m_snr * 1e-6,
+                                          "Interference without MU-MIMO for UE " << i);
+            }
+        }
+    }
+
+    Simulator::Destroy();
+}
+
+class TestMuMimoSuite : public TestSuite
+{
+  public:
+    TestMuMimoSuite()
+        : TestSuite("nr-test-mu-mimo", SYSTEM)
+    {
+        AddTestCase(new TestMuMimo(false, "Two beams, without MU-MIMO"), QUICK);
+        AddTestCase(new TestMuMimo(true, "Two beams, MU-MIMO"), QUICK);
+    }
+};
+
+static TestMuMimoSuite testMuMimoSuite; //!< MU-MIMO test suite
+
+} // namespace ns3
@@ -0,0 +1,320 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include "ns3/antenna-module.h"
+#include "ns3/core-module.h"
+#include "ns3/lte-ue-rrc.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include "ns3/nr-module.h"
+
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+/**
+ * \file nr-test-rrc-protocol-ideal.cc
+ * \ingroup test
+ *
+ * \brief System test of the delivery of the system information by the ideal
+ * RRC protocol, before and after a handover. Two gNBs serve three UEs: UE 0
+ * and UE 1 are attached to the first gNB, UE 2 to the second one. Then UE 0
+ * receives the handover command to the second gNB. At every broadcast of the
+ * system information of a cell, the UEs that receive it must be the UEs
+ * whose RRC is on that cell, as found by walking the NodeList, and UE 0 must
+ * receive the system information at the same times as the UE that stays on
+ * its cell, before and after the handover.
+ *
+ * The X2 handover cannot complete in NR yet (the gNB MAC allocates no
+ * preamble for the non-contention based random access), so the handover
+ * command is delivered directly to the RRC of UE 0, as the source gNB would
+ * do. The UEs have no DRB and no traffic.
+ */
+namespace ns3
+{
+
+class TestRrcProtocolIdealHandover : public TestCase
+{
+  public:
+    TestRrcProtocolIdealHandover()
+        : TestCase("System information of the ideal RRC before and after a handover")
+    {
+    }
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief A UE received the SIB2 of its cell
+     * \param imsi the IMSI of the UE
+     * \param cellId the cell ID
+     * \param rnti the RNTI of the UE
+     */
+    void Sib2Received(uint64_t imsi, uint16_t cellId, uint16_t rnti);
+
+    /**
+     * \brief UE 0 starts the handover
+     * \param imsi the IMSI of the UE
+     * \param cellId the source cell ID
+     * \param rnti the RNTI of the UE
+     * \param targetCellId the target cell ID
+     */
+    void HandoverStart(uint64_t imsi, uint16_t cellId, uint16_t rnti, uint16_t targetCellId);
+
+    /**
+     * \brief Deliver the handover command to a UE
+     * \param ueRrc the RRC of the UE
+     * \param targetCellId the target cell ID
+     * \param bandwidth the bandwidth of the target cell, in multiples of 100 kHz
+     */
+    void SendHandoverCommand(Ptr<LteUeRrc> ueRrc, uint16_t targetCellId, uint16_t bandwidth);
+
+    /**
+     * \brief Get the times at which a UE received the system information
+     * \param imsi the IMSI of the UE
+     * \param from the first time
+     * \param to the last time
+     * \return the times, in ns
+     */
+    std::set<int64_t> GetTimes(uint64_t imsi, Time from, Time to) const;
+
+    /**
+     * \brief A broadcast of the system information: time, in ns, and cell ID
+     */
+    using Broadcast = std::pair<int64_t, uint16_t>;
+
+    std::vector<Ptr<LteUeRrc>> m_ueRrcs;                //!< RRCs of the UEs, in NodeList order
+    std::map<Broadcast, std::set<uint64_t>> m_expected; //!< UEs on the cell of each broadcast
+    std::map<Broadcast, std::map<uint64_t, uint32_t>>
+        m_received; //!< Receptions of each broadcast, by IMSI
+    bool m_connectedAtHandover{false}; //!< UE 0 was connected at the handover
+    bool m_handoverStarted{false};     //!< UE 0 started the handover
+};
+
+void
+TestRrcProtocolIdealHandover::Sib2Received(uint64_t imsi, uint16_t cellId, uint16_t rnti)
+{
+    const Broadcast broadcast = std::make_pair(Simulator::Now().GetNanoSeconds(), cellId);
+    if (m_expected.find(broadcast) == m_expected.end())
+    {
+        // The UEs that the NodeList walk would have found on the cell
+        auto& expected = m_expected[broadcast];
+        for (const auto& ueRrc : m_ueRrcs)
+        {
+            if (ueRrc->GetCellId() == cellId)
+            {
+                expected.insert(ueRrc->GetImsi());
+            }
+        }
+    }
+    ++m_received[broadcast][imsi];
+}
+
+void
+TestRrcProtocolIdealHandover::HandoverStart(uint64_t imsi,
+                                            uint16_t cellId,
+                                            uint16_t rnti,
+                                            uint16_t targetCellId)
+{
+    m_handoverStarted = true;
+}
+
+void
+TestRrcProtocolIdealHandover::SendHandoverCommand(Ptr<LteUeRrc> ueRrc,
+                                                  uint16_t targetCellId,
+                                                  uint16_t bandwidth)
+{
+    m_connectedAtHandover = ueRrc->GetState() == LteUeRrc::CONNECTED_NORMALLY;
+    if (!m_connectedAtHandover)
+    {
+        return;
+    }
+
+    LteRrcSap::RrcConnectionReconfiguration msg;
+    msg.rrcTransactionIdentifier = 0;
+    msg.haveMeasConfig = false;
+    msg.haveMobilityControlInfo = true;
+    msg.mobilityControlInfo.targetPhysCellId = targetCellId;
+    msg.mobilityControlInfo.haveCarrierFreq = true;
+    msg.mobilityControlInfo.carrierFreq.dlCarrierFreq = 0; // the gNBs have no EARFCN
+    msg.mobilityControlInfo.carrierFreq.ulCarrierFreq = 0;
+    msg.mobilityControlInfo.haveCarrierBandwidth = true;
+    msg.mobilityControlInfo.carrierBandwidth.dlBandwidth = bandwidth;
+    msg.mobilityControlInfo.carrierBandwidth.ulBandwidth = bandwidth;
+    msg.mobilityControlInfo.newUeIdentity = ueRrc->GetRnti();
+    // The dummy values of NrGnbMac::DoGetRachConfig()
+    msg.mobilityControlInfo.radioResourceConfigCommon.rachConfigCommon.preambleInfo
+        .numberOfRaPreambles = 52;
+    msg.mobilityControlInfo.radioResourceConfigCommon.rachConfigCommon.raSupervisionInfo
+        .preambleTransMax = 50;
+    msg.mobilityControlInfo.radioResourceConfigCommon.rachConfigCommon.raSupervisionInfo
+        .raResponseWindowSize = 3;
+    msg.mobilityControlInfo.radioResourceConfigCommon.rachConfigCommon.txFailParam
+        .connEstFailCount = 1;
+    msg.mobilityControlInfo.haveRachConfigDedicated = true;
+    msg.mobilityControlInfo.rachConfigDedicated.raPreambleIndex = 0;
+    msg.mobilityControlInfo.rachConfigDedicated.raPrachMaskIndex = 0;
+    msg.haveRadioResourceConfigDedicated = true;
+    msg.radioResourceConfigDedicated.havePhysicalConfigDedicated = false;
+    msg.haveNonCriticalExtension = false;
+
+    ueRrc->GetLteUeRrcSapProvider()->RecvRrcConnectionReconfiguration(msg);
+}
+
+std::set<int64_t>
+TestRrcProtocolIdealHandover::GetTimes(uint64_t imsi, Time from, Time to) const
+{
+    std::set<int64_t> times;
+    for (const auto& [broadcast, ues] : m_received)
+    {
+        if (broadcast.first >= from.GetNanoSeconds() && broadcast.first <= to.GetNanoSeconds() &&
+            ues.find(imsi) != ues.end())
+        {
+            times.insert(broadcast.first);
+        }
+    }
+    return times;
+}
+
+void
+TestRrcProtocolIdealHandover::DoRun()
+{
+    RngSeedManager::SetSeed(1);
+    RngSeedManager::SetRun(1);
+
+    const Time handoverTime = MilliSeconds(305);
+    const Time simTime = MilliSeconds(700);
+    const double bandwidth = 20e6;
+
+    NodeContainer gnbNodes;
+    NodeContainer ueNodes;
+    gnbNodes.Create(2);
+    ueNodes.Create(3);
+
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.Install(gnbNodes);
+    mobility.Install(ueNodes);
+    gnbNodes.Get(0)->GetObject<MobilityModel>()->SetPosition(Vector(0.0, 0.0, 10.0));
+    gnbNodes.Get(1)->GetObject<MobilityModel>()->SetPosition(Vector(100.0, 0.0, 10.0));
+    ueNodes.Get(0)->GetObject<MobilityModel>()->SetPosition(Vector(50.0, 10.0, 1.5));
+    ueNodes.Get(1)->GetObject<MobilityModel>()->SetPosition(Vector(0.0, 20.0, 1.5));
+    ueNodes.Get(2)->GetObject<MobilityModel>()->SetPosition(Vector(100.0, 20.0, 1.5));
+
+    Ptr<IdealBeamformingHelper> idealBeamformingHelper = CreateObject<IdealBeamformingHelper>();
+    Ptr<NrHelper> nrHelper = CreateObject<NrHelper>();
+    nrHelper->SetBeamformingHelper(idealBeamformingHelper);
+    nrHelper->SetPathlossAttribute("ShadowingEnabled", BooleanValue(false));
+
+    CcBwpCreator ccBwpCreator;
+    CcBwpCreator::SimpleOperationBandConf bandConf(3.5e9,
+                                                   bandwidth,
+                                                   1,
+                                                   BandwidthPartInfo::UMa_LoS);
+    OperationBandInfo band = ccBwpCreator.CreateOperationBandContiguousCc(bandConf);
+    nrHelper->InitializeOperationBand(&band);
+    BandwidthPartInfoPtrVector allBwps = CcBwpCreator::GetAllBwps({band});
+
+    NetDeviceContainer gnbDevs = nrHelper->InstallGnbDevice(gnbNodes, allBwps);
+    NetDeviceContainer ueDevs = nrHelper->InstallUeDevice(ueNodes, allBwps);
+    for (auto it = gnbDevs.Begin(); it != gnbDevs.End(); ++it)
+    {
+        DynamicCast<NrGnbNetDevice>(*it)->UpdateConfig();
+    }
+    for (auto it = ueDevs.Begin(); it != ueDevs.End(); ++it)
+    {
+        DynamicCast<NrUeNetDevice>(*it)->UpdateConfig();
+    }
+
+    nrHelper->AttachToEnb(ueDevs.Get(0), gnbDevs.Get(0));
+    nrHelper->AttachToEnb(ueDevs.Get(1), gnbDevs.Get(0));
+    nrHelper->AttachToEnb(ueDevs.Get(2), gnbDevs.Get(1));
+
+    for (uint32_t i = 0; i < ueDevs.GetN(); ++i)
+    {
+        Ptr<LteUeRrc> ueRrc = DynamicCast<NrUeNetDevice>(ueDevs.Get(i))->GetRrc();
+        ueRrc->TraceConnectWithoutContext(
+            "Sib2Received",
+            MakeCallback(&TestRrcProtocolIdealHandover::Sib2Received, this));
+        m_ueRrcs.push_back(ueRrc);
+    }
+    m_ueRrcs.at(0)->TraceConnectWithoutContext(
+        "HandoverStart",
+        MakeCallback(&TestRrcProtocolIdealHandover::HandoverStart, this));
+
+    const uint16_t targetCellId = DynamicCast<NrGnbNetDevice>(gnbDevs.Get(1))->GetBwpId(0);
+    Simulator::Schedule(handoverTime,
+                        &TestRrcProtocolIdealHandover::SendHandoverCommand,
+                        this,
+                        m_ueRrcs.at(0),
+                        targetCellId,
+                        static_cast<uint16_t>(bandwidth / 100e3));
+
+    Simulator::Stop(simTime);
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(m_connectedAtHandover, true, "UE 0 was not connected at the handover");
+    NS_TEST_ASSERT_MSG_EQ(m_handoverStarted, true, "UE 0 did not start the handover");
+
+    // Every broadcast reaches the UEs on its cell, and only them, as many
+    // times each
+    for (const auto& [broadcast, expected] : m_expected)
+    {
+        const auto& received = m_received.at(broadcast);
+        NS_TEST_ASSERT_MSG_EQ(received.size(),
+                              expected.size(),
+                              "Wrong UEs for the SI of cell " << broadcast.second << " at "
+                                                              << broadcast.first << " ns");
+        for (const auto& [imsi, count] : received)
+        {
+            NS_TEST_ASSERT_MSG_EQ(expected.count(imsi),
+                                  1,
+                                  "IMSI " << imsi << " received the SI of cell "
+                                          << broadcast.second << " at " << broadcast.first
+                                          << " ns");
+            NS_TEST_ASSERT_MSG_EQ(count,
+                                  received.begin()->second,
+                                  "IMSI " << imsi << " received the SI a different number "
+                                          << "of times");
+        }
+    }
+
+    // UE 0 receives the SI at the same times as the UE that stays on its cell:
+    // UE 1 before the handover, and the UE of the cell of its RRC after it
+    const uint64_t imsi0 = m_ueRrcs.at(0)->GetImsi();
+    const uint64_t imsiAfter = m_ueRrcs.at(0)->GetCellId() == targetCellId
+                                   ? m_ueRrcs.at(2)->GetImsi()
+                                   : m_ueRrcs.at(1)->GetImsi();
+    const Time lastBefore = handoverTime - NanoSeconds(1);
+    const Time firstAfter = handoverTime + NanoSeconds(1);
+    const auto before = GetTimes(imsi0, Seconds(0), lastBefore);
+    const auto after = GetTimes(imsi0, firstAfter, simTime);
+    NS_TEST_ASSERT_MSG_GT(before.size(), 0, "UE 0 received no SI before the handover");
+    NS_TEST_ASSERT_MSG_GT(after.size(), 0, "UE 0 received no SI after the handover");
+    NS_TEST_ASSERT_MSG_EQ((before == GetTimes(m_ueRrcs.at(1)->GetImsi(), Seconds(0), lastBefore)),
+                          true,
+                          "UE 0 and UE 1 received the SI at different times before the handover");
+    NS_TEST_ASSERT_MSG_EQ((after == GetTimes(imsiAfter, firstAfter, simTime)),
+                          true,
+                          "UE 0 received the SI at different times after the handover");
+
+    Simulator::Destroy();
+}
+
+class TestRrcProtocolIdealSuite : public TestSuite
+{
+  public:
+    TestRrcProtocolIdealSuite()
+        : TestSuite("nr-test-rrc-protocol-ideal", SYSTEM)
+    {
+        AddTestCase(new TestRrcProtocolIdealHandover(), QUICK);
+    }
+};
+
+static TestRrcProtocolIdealSuite testRrcProtocolIdealSuite; //!< Ideal RRC protocol test suite
+
+} // namespace ns3
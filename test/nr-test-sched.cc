@@ -132,7 +132,7 @@ class TestSchedSapUser : public NrMacSchedSapUser
     {
     }
 
-    void SchedConfigInd(const struct SchedConfigIndParameters& params) override
+    void SchedConfigInd(struct SchedConfigIndParameters params) override
     {
         m_testCase->SchedConfigInd(params);
     }
@@ -0,0 +1,582 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include <ns3/boolean.h>
+#include <ns3/nr-amc.h>
+#include <ns3/nr-mac-scheduler-ns3.h>
+#include <ns3/object-factory.h>
+#include <ns3/simulator.h>
+#include <ns3/test.h>
+
+#include <map>
+#include <set>
+
+/**
+ * \file nr-test-scheduler-active-ue.cc
+ * \ingroup test
+ *
+ * \brief Unit-testing for the attribute IncrementalActiveUe of
+ * NrMacSchedulerNs3. A fake MAC drives the scheduler with RLC buffer reports,
+ * BSRs, SRs and HARQ feedback, and then lets the buffers drain. Before and
+ * after the triggers of each slot, the test computes the active UEs twice,
+ * from the candidate UEs and from all the UEs, and checks that they are the
+ * same UEs, with the same beam and buffer. At the end, the candidates must be
+ * empty, after the drain or after the release of the UEs.
+ */
+namespace ns3
+{
+
+/**
+ * \brief Compare, slot by slot, the active UEs computed from the candidates
+ * with those computed from all the UEs
+ */
+class TestSchedulerActiveUe : public TestCase
+{
+  public:
+    TestSchedulerActiveUe(const std::string& type, bool release)
+        : TestCase("Scheduler " + type + " with incremental active UEs" +
+                   (release ? ", UEs released" : ", buffers drained")),
+          m_type(type),
+          m_release(release)
+    {
+    }
+
+    /**
+     * \brief Check that the active UEs of DL and UL are the same with and
+     * without candidates
+     */
+    void CheckActiveUe();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Active UEs by RNTI, with beam and buffer
+     */
+    using ActiveUes = std::map<uint16_t, std::pair<BeamConfId, uint32_t>>;
+
+    void CheckActiveUe(const NrMacSchedulerUeInfo::GetLCGFn& getLcg,
+                       const NrMacSchedulerUeInfo::GetHarqVectorFn& getHarq,
+                       const std::set<uint16_t>& candidates,
+                       const std::string& mode);
+    static ActiveUes GetActiveUes(const NrMacSchedulerNs3::ActiveUeMap& activeUe);
+
+    std::string m_type;
+    bool m_release;
+    Ptr<NrMacSchedulerNs3> m_sched;
+    uint32_t m_numActiveUes{0}; //!< Active UEs found in all the checks
+};
+
+/**
+ * \brief A fake MAC, which stops the traffic after some slots, acknowledges
+ * every DCI, and checks the active UEs of each slot
+ */
+class TestActiveUeMac : public NrMacSchedSapUser, public NrMacCschedSapUser
+{
+  public:
+    TestActiveUeMac(const Ptr<NrMacSchedulerNs3>& sched,
+                    TestSchedulerActiveUe* test,
+                    uint32_t trafficSlots);
+
+    void Start(uint16_t numUes, uint32_t numSlots);
+    uint32_t GetNumDlDci() const;
+    uint32_t GetNumUlDci() const;
+
+    /**
+     * \brief Report a DL buffer and a BSR for every UE
+     */
+    void ReportBuffers();
+
+    // inherited from NrMacSchedSapUser
+    void SchedConfigInd(SchedConfigIndParameters params) override;
+    Ptr<const SpectrumModel> GetSpectrumModel() const override;
+    uint32_t GetNumRbPerRbg() const override;
+    uint8_t GetNumHarqProcess() const override;
+    uint16_t GetBwpId() const override;
+    uint16_t GetCellId() const override;
+    uint32_t GetSymbolsPerSlot() const override;
+    Time GetSlotPeriod() const override;
+
+    // inherited from NrMacCschedSapUser
+    void CschedCellConfigCnf(const CschedCellConfigCnfParameters& params) override;
+    void CschedUeConfigCnf(const CschedUeConfigCnfParameters& params) override;
+    void CschedLcConfigCnf(const CschedLcConfigCnfParameters& params) override;
+    void CschedLcReleaseCnf(const CschedLcReleaseCnfParameters& params) override;
+    void CschedUeReleaseCnf(const CschedUeReleaseCnfParameters& params) override;
+    void CschedUeConfigUpdateInd(const CschedUeConfigUpdateIndParameters& params) override;
+    void CschedCellConfigUpdateInd(const CschedCellConfigUpdateIndParameters& params) override;
+
+  private:
+    void Configure();
+    void Slot(uint32_t slot);
+    void Traffic(uint32_t slot);
+    static SfnSf GetSfnSf(uint32_t slot);
+
+    static constexpr uint32_t NUM_RB = 52; //!< RBs of the bandwidth, one per RBG
+
+    Ptr<NrMacSchedulerNs3> m_sched;
+    TestSchedulerActiveUe* m_test;
+    uint32_t m_trafficSlots; //!< Slots with traffic, then the buffers drain
+    Ptr<const SpectrumModel> m_spectrumModel;
+    uint16_t m_numUes{0};
+    uint32_t m_slot{0};
+    uint32_t m_numDlDci{0};
+    uint32_t m_numUlDci{0};
+    std::vector<DlHarqInfo> m_dlFeedback;                     //!< For the next DL trigger
+    std::map<uint32_t, std::vector<UlHarqInfo>> m_ulFeedback; //!< By slot of delivery
+    std::map<uint32_t, std::vector<NrMacSchedSapProvider::SchedUlCqiInfoReqParameters>>
+        m_ulCqi; //!< By slot of delivery
+};
+
+TestActiveUeMac::TestActiveUeMac(const Ptr<NrMacSchedulerNs3>& sched,
+                                 TestSchedulerActiveUe* test,
+                                 uint32_t trafficSlots)
+    : m_sched(sched),
+      m_test(test),
+      m_trafficSlots(trafficSlots)
+{
+    std::vector<double> centerFrequencies;
+    for (uint32_t rb = 0; rb < NUM_RB; ++rb)
+    {
+        centerFrequencies.push_back(28e9 + rb * 180e3);
+    }
+    m_spectrumModel = Create<SpectrumModel>(centerFrequencies);
+    m_sched->SetMacSchedSapUser(this);
+    m_sched->SetMacCschedSapUser(this);
+}
+
+void
+TestActiveUeMac::Start(uint16_t numUes, uint32_t numSlots)
+{
+    m_numUes = numUes;
+    Simulator::Schedule(Seconds(0), &TestActiveUeMac::Configure, this);
+    for (uint32_t slot = 1; slot <= numSlots; ++slot)
+    {
+        Simulator::Schedule(MilliSeconds(slot), &TestActiveUeMac::Slot, this, slot);
+    }
+}
+
+uint32_t
+TestActiveUeMac::GetNumDlDci() const
+{
+    return m_numDlDci;
+}
+
+uint32_t
+TestActiveUeMac::GetNumUlDci() const
+{
+    return m_numUlDci;
+}
+
+SfnSf
+TestActiveUeMac::GetSfnSf(uint32_t slot)
+{
+    // Numerology 0: one slot per subframe
+    return SfnSf(slot / 10, slot % 10, 0, 0);
+}
+
+void
+TestActiveUeMac::Configure()
+{
+    NrMacCschedSapProvider* csched = m_sched->GetMacCschedSapProvider();
+
+    NrMacCschedSapProvider::CschedCellConfigReqParameters cellConfig;
+    cellConfig.m_ulBandwidth = NUM_RB;
+    cellConfig.m_dlBandwidth = NUM_RB;
+    csched->CschedCellConfigReq(cellConfig);
+
+    for (uint16_t rnti = 1; rnti <= m_numUes; ++rnti)
+    {
+        NrMacCschedSapProvider::CschedUeConfigReqParameters ueConfig;
+        ueConfig.m_rnti = rnti;
+        ueConfig.m_beamConfId = BeamConfId(BeamId(rnti % 2, 90.0), BeamId::GetEmptyBeamId());
+        ueConfig.m_transmissionMode = 0;
+        csched->CschedUeConfigReq(ueConfig);
+
+        NrMacCschedSapProvider::CschedLcConfigReqParameters lcConfig;
+        lcConfig.m_rnti = rnti;
+        lcConfig.m_reconfigureFlag = false;
+        LogicalChannelConfigListElement_s lc;
+        lc.m_logicalChannelIdentity = 1;
+        lc.m_logicalChannelGroup = 1;
+        lc.m_direction = LogicalChannelConfigListElement_s::DIR_BOTH;
+        lc.m_qosBearerType = LogicalChannelConfigListElement_s::QBT_NON_GBR;
+        lc.m_qci = 9;
+        lc.m_eRabMaximulBitrateUl = 0;
+        lc.m_eRabMaximulBitrateDl = 0;
+        lc.m_eRabGuaranteedBitrateUl = 0;
+        lc.m_eRabGuaranteedBitrateDl = 0;
+        lcConfig.m_logicalChannelConfigList.emplace_back(lc);
+        csched->CschedLcConfigReq(lcConfig);
+    }
+}
+
+void
+TestActiveUeMac::ReportBuffers()
+{
+    NrMacSchedSapProvider* sched = m_sched->GetMacSchedSapProvider();
+    NrMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters bsr;
+    for (uint16_t rnti = 1; rnti <= m_numUes; ++rnti)
+    {
+        NrMacSchedSapProvider::SchedDlRlcBufferReqParameters rlc;
+        rlc.m_rnti = rnti;
+        rlc.m_logicalChannelIdentity = 1;
+        rlc.m_rlcTransmissionQueueSize = 1000;
+        rlc.m_rlcTransmissionQueueHolDelay = 0;
+        rlc.m_rlcRetransmissionQueueSize = 0;
+        rlc.m_rlcRetransmissionHolDelay = 0;
+        rlc.m_rlcStatusPduSize = 0;
+        sched->SchedDlRlcBufferReq(rlc);
+
+        MacCeElement ce;
+        ce.m_rnti = rnti;
+        ce.m_macCeType = MacCeElement::BSR;
+        ce.m_macCeValue.m_bufferStatus = {0, 20, 0, 0};
+        bsr.m_macCeList.push_back(ce);
+    }
+    sched->SchedUlMacCtrlInfoReq(bsr);
+}
+
+void
+TestActiveUeMac::Traffic(uint32_t slot)
+{
+    NrMacSchedSapProvider* sched = m_sched->GetMacSchedSapProvider();
+
+    for (uint16_t rnti = 1; rnti <= m_numUes; ++rnti)
+    {
+        if ((slot + rnti) % 5 == 0)
+        {
+            NrMacSchedSapProvider::SchedDlRlcBufferReqParameters rlc;
+            rlc.m_rnti = rnti;
+            rlc.m_logicalChannelIdentity = 1;
+            rlc.m_rlcTransmissionQueueSize = 500 * rnti;
+            rlc.m_rlcTransmissionQueueHolDelay = 0;
+            rlc.m_rlcRetransmissionQueueSize = 0;
+            rlc.m_rlcRetransmissionHolDelay = 0;
+            rlc.m_rlcStatusPduSize = 0;
+            sched->SchedDlRlcBufferReq(rlc);
+        }
+    }
+
+    if (slot % 10 == 1)
+    {
+        NrMacSchedSapProvider::SchedDlCqiInfoReqParameters dlCqi;
+        dlCqi.m_sfnsf = GetSfnSf(slot);
+        NrMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters bsr;
+        bsr.m_sfnSf = GetSfnSf(slot);
+        for (uint16_t rnti = 1; rnti <= m_numUes; ++rnti)
+        {
+            DlCqiInfo cqi;
+            cqi.m_rnti = rnti;
+            cqi.m_ri = 1;
+            cqi.m_cqiType = DlCqiInfo::WB;
+            cqi.m_wbCqi = {static_cast<uint8_t>(3 + (rnti + slot / 10) % 12)};
+            dlCqi.m_cqiList.push_back(cqi);
+
+            MacCeElement ce;
+            ce.m_rnti = rnti;
+            ce.m_macCeType = MacCeElement::BSR;
+            ce.m_macCeValue.m_bufferStatus = {0, static_cast<uint8_t>(10 + rnti % 10), 0, 0};
+            bsr.m_macCeList.push_back(ce);
+        }
+        sched->SchedDlCqiInfoReq(dlCqi);
+        sched->SchedUlMacCtrlInfoReq(bsr);
+    }
+
+    if (slot == 3)
+    {
+        NrMacSchedSapProvider::SchedUlSrInfoReqParameters sr;
+        sr.m_snfSf = GetSfnSf(slot);
+        for (uint16_t rnti = 1; rnti <= m_numUes; rnti += 2)
+        {
+            sr.m_srList.push_back(rnti);
+        }
+        sched->SchedUlSrInfoReq(sr);
+    }
+}
+
+void
+TestActiveUeMac::Slot(uint32_t slot)
+{
+    NrMacSchedSapProvider* sched = m_sched->GetMacSchedSapProvider();
+    m_slot = slot;
+
+    if (slot <= m_trafficSlots)
+    {
+        Traffic(slot);
+    }
+    m_test->CheckActiveUe();
+
+    for (const auto& ulCqi : m_ulCqi[slot])
+    {
+        sched->SchedUlCqiInfoReq(ulCqi);
+    }
+    m_ulCqi.erase(slot);
+
+    // UL is scheduled two slots in advance, as the MAC does with K2
+    NrMacSchedSapProvider::SchedUlTriggerReqParameters ulTrigger;
+    ulTrigger.m_snfSf = GetSfnSf(slot + 2);
+    ulTrigger.m_ulHarqInfoList = std::move(m_ulFeedback[slot]);
+    ulTrigger.m_slotType = LteNrTddSlotType::F;
+    m_ulFeedback.erase(slot);
+    sched->SchedUlTriggerReq(ulTrigger);
+
+    NrMacSchedSapProvider::SchedDlTriggerReqParameters dlTrigger;
+    dlTrigger.m_snfSf = GetSfnSf(slot);
+    dlTrigger.m_dlHarqInfoList = std::move(m_dlFeedback);
+    dlTrigger.m_slotType = LteNrTddSlotType::F;
+    m_dlFeedback.clear();
+    sched->SchedDlTriggerReq(dlTrigger);
+}
+
+void
+TestActiveUeMac::SchedConfigInd(SchedConfigIndParameters params)
+{
+    m_test->CheckActiveUe();
+
+    std::set<uint8_t> ulCqiSymStart;
+    for (const auto& varTti : params.m_slotAllocInfo.m_varTtiAllocInfo)
+    {
+        const auto& dci = varTti.m_dci;
+        if (dci->m_type != DciInfoElementTdma::DATA)
+        {
+            continue;
+        }
+        if (dci->m_format == DciInfoElementTdma::DL)
+        {
+            ++m_numDlDci;
+            DlHarqInfo harq;
+            harq.m_rnti = dci->m_rnti;
+            harq.m_harqProcessId = dci->m_harqProcess;
+            harq.m_bwpIndex = 0;
+            for (const auto& tbs : dci->m_tbSize)
+            {
+                harq.m_harqStatus.push_back(tbs > 0 ? DlHarqInfo::ACK : DlHarqInfo::NONE);
+            }
+            harq.m_numRetx = dci->m_rv;
+            m_dlFeedback.push_back(harq);
+        }
+        else
+        {
+            // The UL slot is two slots in the future: the feedback comes after it
+            ++m_numUlDci;
+            UlHarqInfo harq;
+            harq.m_rnti = dci->m_rnti;
+            harq.m_harqProcessId = dci->m_harqProcess;
+            harq.m_bwpIndex = 0;
+            harq.m_receptionStatus = UlHarqInfo::Ok;
+            harq.m_tpc = 1;
+            harq.m_numRetx = 0;
+            m_ulFeedback[m_slot + 3].push_back(harq);
+
+            if (ulCqiSymStart.insert(dci->m_symStart).second)
+            {
+                NrMacSchedSapProvider::SchedUlCqiInfoReqParameters ulCqi;
+                ulCqi.m_sfnSf = params.m_sfnSf;
+                ulCqi.m_symStart = dci->m_symStart;
+                ulCqi.m_ulCqi.m_type = UlCqiInfo::PUSCH;
+                ulCqi.m_ulCqi.m_sinr = std::vector<double>(NUM_RB, 5.0 + dci->m_rnti);
+                m_ulCqi[m_slot + 3].push_back(ulCqi);
+            }
+        }
+    }
+}
+
+Ptr<const SpectrumModel>
+TestActiveUeMac::GetSpectrumModel() const
+{
+    return m_spectrumModel;
+}
+
+uint32_t
+TestActiveUeMac::GetNumRbPerRbg() const
+{
+    return 1;
+}
+
+uint8_t
+TestActiveUeMac::GetNumHarqProcess() const
+{
+    return 16;
+}
+
+uint16_t
+TestActiveUeMac::GetBwpId() const
+{
+    return 0;
+}
+
+uint16_t
+TestActiveUeMac::GetCellId() const
+{
+    return 1;
+}
+
+uint32_t
+TestActiveUeMac::GetSymbolsPerSlot() const
+{
+    return 14;
+}
+
+Time
+TestActiveUeMac::GetSlotPeriod() const
+{
+    return MilliSeconds(1);
+}
+
+void
+TestActiveUeMac::CschedCellConfigCnf(const CschedCellConfigCnfParameters& params)
+{
+}
+
+void
+TestActiveUeMac::CschedUeConfigCnf(const CschedUeConfigCnfParameters& params)
+{
+}
+
+void
+TestActiveUeMac::CschedLcConfigCnf(const CschedLcConfigCnfParameters& params)
+{
+}
+
+void
+TestActiveUeMac::CschedLcReleaseCnf(const CschedLcReleaseCnfParameters& params)
+{
+}
+
+void
+TestActiveUeMac::CschedUeReleaseCnf(const CschedUeReleaseCnfParameters& params)
+{
+}
+
+void
+TestActiveUeMac::CschedUeConfigUpdateInd(const CschedUeConfigUpdateIndParameters& params)
+{
+}
+
+void
+TestActiveUeMac::CschedCellConfigUpdateInd(const CschedCellConfigUpdateIndParameters& params)
+{
+}
+
+TestSchedulerActiveUe::ActiveUes
+TestSchedulerActiveUe::GetActiveUes(const NrMacSchedulerNs3::ActiveUeMap& activeUe)
+{
+    ActiveUes ues;
+    for (const auto& beam : activeUe)
+    {
+        for (const auto& ue : beam.second)
+        {
+            ues.emplace(ue.first->m_rnti, std::make_pair(beam.first, ue.second));
+        }
+    }
+    return ues;
+}
+
+void
+TestSchedulerActiveUe::CheckActiveUe(const NrMacSchedulerUeInfo::GetLCGFn& getLcg,
+                                     const NrMacSchedulerUeInfo::GetHarqVectorFn& getHarq,
+                                     const std::set<uint16_t>& candidates,
+                                     const std::string& mode)
+{
+    // The copy of the candidates is pruned, the ones of the scheduler are not
+    std::set<uint16_t> prunedCandidates = candidates;
+    NrMacSchedulerNs3::ActiveUeMap full;
+    NrMacSchedulerNs3::ActiveUeMap incremental;
+    m_sched->ComputeActiveUe(&full, getLcg, getHarq, mode, nullptr);
+    m_sched->ComputeActiveUe(&incremental, getLcg, getHarq, mode, &prunedCandidates);
+
+    const ActiveUes fullUes = GetActiveUes(full);
+    NS_TEST_ASSERT_MSG_EQ((GetActiveUes(incremental) == fullUes),
+                          true,
+                          mode << " active UEs differ at " << Simulator::Now().As(Time::MS));
+    m_numActiveUes += fullUes.size();
+}
+
+void
+TestSchedulerActiveUe::CheckActiveUe()
+{
+    CheckActiveUe(&NrMacSchedulerUeInfo::GetDlLCG,
+                  &NrMacSchedulerUeInfo::GetDlHarqVector,
+                  m_sched->m_dlActiveUeCandidates,
+                  "DL");
+    CheckActiveUe(&NrMacSchedulerUeInfo::GetUlLCG,
+                  &NrMacSchedulerUeInfo::GetUlHarqVector,
+                  m_sched->m_ulActiveUeCandidates,
+                  "UL");
+}
+
+void
+TestSchedulerActiveUe::DoRun()
+{
+    const uint16_t numUes = 10;
+    const uint32_t numSlots = 200;
+
+    ObjectFactory factory;
+    factory.SetTypeId(m_type);
+    factory.Set("EnableSrsInFSlots", BooleanValue(false));
+    factory.Set("IncrementalActiveUe", BooleanValue(true));
+    m_sched = factory.Create<NrMacSchedulerNs3>();
+    m_sched->InstallDlAmc(CreateObject<NrAmc>());
+    m_sched->InstallUlAmc(CreateObject<NrAmc>());
+
+    // Without release, the traffic stops halfway, and the buffers drain
+    TestActiveUeMac mac(m_sched, this, m_release ? numSlots : numSlots / 2);
+    mac.Start(numUes, numSlots);
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_GT(mac.GetNumDlDci(), 0, "The scheduler did not schedule DL data");
+    NS_TEST_ASSERT_MSG_GT(mac.GetNumUlDci(), 0, "The scheduler did not schedule UL data");
+    NS_TEST_ASSERT_MSG_GT(m_numActiveUes, 0, "No active UE was checked");
+
+    if (m_release)
+    {
+        mac.ReportBuffers();
+        CheckActiveUe();
+        NS_TEST_ASSERT_MSG_EQ(m_sched->m_dlActiveUeCandidates.size(),
+                              numUes,
+                              "Every UE with DL data must be a candidate");
+        NS_TEST_ASSERT_MSG_EQ(m_sched->m_ulActiveUeCandidates.size(),
+                              numUes,
+                              "Every UE with UL data must be a candidate");
+
+        for (uint16_t rnti = 1; rnti <= numUes; ++rnti)
+        {
+            NrMacCschedSapProvider::CschedUeReleaseReqParameters params;
+            params.m_rnti = rnti;
+            m_sched->GetMacCschedSapProvider()->CschedUeReleaseReq(params);
+        }
+    }
+    else
+    {
+        CheckActiveUe();
+    }
+
+    NS_TEST_ASSERT_MSG_EQ(m_sched->m_dlActiveUeCandidates.size(), 0, "DL candidates left");
+    NS_TEST_ASSERT_MSG_EQ(m_sched->m_ulActiveUeCandidates.size(), 0, "UL candidates left");
+
+    Simulator::Destroy();
+    m_sched->Dispose();
+    m_sched = nullptr;
+}
+
+class TestSchedulerActiveUeSuite : public TestSuite
+{
+  public:
+    TestSchedulerActiveUeSuite()
+        : TestSuite("nr-test-scheduler-active-ue", UNIT)
+    {
+        for (const std::string type : {"ns3::NrMacSchedulerTdmaRR", "ns3::NrMacSchedulerOfdmaPF"})
+        {
+            AddTestCase(new TestSchedulerActiveUe(type, false), QUICK);
+            AddTestCase(new TestSchedulerActiveUe(type, true), QUICK);
+        }
+    }
+};
+
+static TestSchedulerActiveUeSuite testSchedulerActiveUeSuite; //!< Active UE test suite
+
+} // namespace ns3
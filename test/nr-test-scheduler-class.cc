@@ -0,0 +1,370 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include <ns3/boolean.h>
+#include <ns3/nr-mac-scheduler-ns3.h>
+#include <ns3/nr-mac-scheduler-replay.h>
+#include <ns3/nr-mac-scheduler-trace.h>
+#include <ns3/nr-mac-scheduler-ue-classes.h>
+#include <ns3/object-factory.h>
+#include <ns3/simulator.h>
+#include <ns3/test.h>
+
+/**
+ * \file nr-test-scheduler-class.cc
+ * \ingroup test
+ *
+ * \brief Unit-testing for the pending lists of the classes of UEs, used by
+ * NrMacSchedulerOfdmaClass. The first test checks the order of the UEs of a
+ * class with the RR and FIFO policies, the second one that the UEs that
+ * change class or are not active anymore leave the pending lists, and that
+ * the entries they leave behind do not grow with the changes of class. The
+ * third one replays a synthetic trace, with UEs that are idle most of the
+ * time, on NrMacSchedulerOfdmaClass with and without "CompactIdleUes": the
+ * decisions must be the same, with fewer UEs fully represented at the end.
+ */
+namespace ns3
+{
+
+class TestSchedulerClassOrder : public TestCase
+{
+  public:
+    TestSchedulerClassOrder()
+        : TestCase("Order of the UEs of a class, RR and FIFO")
+    {
+    }
+
+  private:
+    void DoRun() override;
+};
+
+void
+TestSchedulerClassOrder::DoRun()
+{
+    uint16_t rnti = 0;
+    uint32_t index = 0;
+
+    for (const auto policy : {NrMacSchedulerUeClasses::RR, NrMacSchedulerUeClasses::FIFO})
+    {
+        const bool rr = policy == NrMacSchedulerUeClasses::RR;
+        NrMacSchedulerUeClasses classes;
+        classes.SetPolicy(policy);
+
+        classes.NewSlot();
+        classes.Activate(3, 0, 5, 0);
+        classes.Activate(1, 0, 5, 1);
+        classes.Activate(2, 0, 5, 2);
+        classes.Activate(4, 0, 9, 3);
+        NS_TEST_ASSERT_MSG_EQ(classes.GetNumPending(), 4, "Wrong number of pending UEs");
+        NS_TEST_ASSERT_MSG_EQ(classes.Front(0, 7, &rnti, &index), false, "The class is empty");
+        NS_TEST_ASSERT_MSG_EQ(classes.Front(1, 5, &rnti, &index), false, "The beam is unknown");
+
+        NS_TEST_ASSERT_MSG_EQ(classes.Front(0, 5, &rnti, &index), true, "The class has UEs");
+        NS_TEST_ASSERT_MSG_EQ(rnti, 3, "The UEs must be in the order of activation");
+        NS_TEST_ASSERT_MSG_EQ(index, 0, "Wrong index of the UE in its beam");
+        classes.Serve(0, 5);
+        classes.Front(0, 5, &rnti, &index);
+        NS_TEST_ASSERT_MSG_EQ(rnti, 1, "The UEs must be in the order of activation");
+        classes.Serve(0, 5);
+        classes.Requeue();
+
+        // The three UEs are still active in the next slot
+        classes.NewSlot();
+        classes.Activate(1, 0, 5, 0);
+        classes.Activate(2, 0, 5, 1);
+        classes.Activate(3, 0, 5, 2);
+        std::vector<uint16_t> order;
+        while (classes.Front(0, 5, &rnti, &index))
+        {
+            order.push_back(rnti);
+            classes.Serve(0, 5);
+        }
+        classes.Requeue();
+        const std::vector<uint16_t> expected = rr ? std::vector<uint16_t>{2, 3, 1}
+                                                  : std::vector<uint16_t>{3, 1, 2};
+        NS_TEST_ASSERT_MSG_EQ((order == expected), true, "Wrong order of the served UEs");
+
+        // The served UEs keep the same order among them
+        classes.NewSlot();
+        classes.Activate(1, 0, 5, 0);
+        classes.Activate(2, 0, 5, 1);
+        classes.Activate(3, 0, 5, 2);
+        classes.Front(0, 5, &rnti, &index);
+        NS_TEST_ASSERT_MSG_EQ(rnti, expected.front(), "Wrong order after a full round");
+        NS_TEST_ASSERT_MSG_EQ(classes.GetFirstClass(0), 0, "The first class is set by the user");
+        classes.SetFirstClass(0, 6);
+        NS_TEST_ASSERT_MSG_EQ(classes.GetFirstClass(0), 6, "Wrong first class of the beam");
+    }
+}
+
+class TestSchedulerClassChanges : public TestCase
+{
+  public:
+    TestSchedulerClassChanges()
+        : TestCase("UEs that change class, become inactive, or are removed")
+    {
+    }
+
+  private:
+    void DoRun() override;
+};
+
+void
+TestSchedulerClassChanges::DoRun()
+{
+    uint16_t rnti = 0;
+    uint32_t index = 0;
+    NrMacSchedulerUeClasses classes;
+
+    classes.NewSlot();
+    classes.Activate(1, 0, 5, 0);
+    classes.Activate(2, 0, 5, 1);
+    classes.Activate(3, 1, 5, 0);
+
+    // UE 1 changes MCS, UE 2 has no more data, UE 3 is removed
+    classes.NewSlot();
+    classes.Activate(1, 0, 8, 0);
+    classes.Remove(3);
+    NS_TEST_ASSERT_MSG_EQ(classes.GetNumPending(), 2, "UE 3 must leave the pending lists");
+    NS_TEST_ASSERT_MSG_EQ(classes.Front(0, 5, &rnti, &index),
+                          false,
+                          "UE 1 changed class and UE 2 is not active");
+    NS_TEST_ASSERT_MSG_EQ(classes.GetNumPending(), 1, "UE 2 must leave the pending lists");
+    NS_TEST_ASSERT_MSG_EQ(classes.Front(1, 5, &rnti, &index), false, "UE 3 has been removed");
+    NS_TEST_ASSERT_MSG_EQ(classes.Front(0, 8, &rnti, &index), true, "UE 1 is in its new class");
+    NS_TEST_ASSERT_MSG_EQ(rnti, 1, "UE 1 is in its new class");
+
+    // UE 2 comes back in the same class, after UE 4
+    classes.NewSlot();
+    classes.Activate(4, 0, 5, 0);
+    classes.Activate(2, 0, 5, 1);
+    classes.Front(0, 5, &rnti, &index);
+    NS_TEST_ASSERT_MSG_EQ(rnti, 4, "UE 2 must be appended again to the list");
+    NS_TEST_ASSERT_MSG_EQ(classes.GetNumPending(), 3, "Wrong number of pending UEs");
+
+    // The MCS of the UEs changes at every slot: the entries left behind are removed
+    for (uint32_t slot = 0; slot < 1000; ++slot)
+    {
+        classes.NewSlot();
+        for (uint16_t ue = 100; ue < 200; ++ue)
+        {
+            classes.Activate(ue, 0, (ue + slot) % NrMacSchedulerUeClasses::NUM_CLASSES, ue);
+        }
+    }
+    NS_TEST_ASSERT_MSG_EQ(classes.GetNumPending(), 103, "Wrong number of pending UEs");
+    NS_TEST_ASSERT_MSG_LT_OR_EQ(classes.GetNumEntries(),
+                                2 * classes.GetNumPending() + NrMacSchedulerUeClasses::NUM_CLASSES,
+                                "The entries left behind must be removed");
+    NS_TEST_ASSERT_MSG_EQ(NrMacSchedulerUeClasses::GetRecordSize(),
+                          12,
+                          "The record of a UE must stay compact");
+}
+
+class TestSchedulerClassCompact : public TestCase
+{
+  public:
+    TestSchedulerClassCompact()
+        : TestCase("Same decisions with a compact record of the idle UEs")
+    {
+    }
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Write the synthetic trace
+     * \param filename the file of the trace
+     */
+    static void WriteTrace(const std::string& filename);
+
+    /**
+     * \param slot the slot
+     * \return the SfnSf of the slot, with numerology 0
+     */
+    static SfnSf GetSfnSf(uint32_t slot);
+
+    static constexpr uint16_t NUM_UES = 20;    //!< UEs of the trace
+    static constexpr uint32_t NUM_SLOTS = 300; //!< Slots of the trace
+    static constexpr uint32_t LAST_DATA = 240; //!< Last slot with new data
+};
+
+SfnSf
+TestSchedulerClassCompact::GetSfnSf(uint32_t slot)
+{
+    return SfnSf(slot / 10, slot % 10, 0, 0);
+}
+
+void
+TestSchedulerClassCompact::WriteTrace(const std::string& filename)
+{
+    NrMacSchedulerTrace::Writer writer;
+    writer.Open(filename);
+
+    NrMacSchedulerTrace::Config config;
+    config.m_symbolsPerSlot = 14;
+    config.m_slotPeriodNs = MilliSeconds(1).GetNanoSeconds();
+    config.m_numRbPerRbg = 1;
+    config.m_numHarqProcess = 16;
+    config.m_bwpId = 0;
+    config.m_cellId = 1;
+    for (uint32_t rb = 0; rb < 25; ++rb)
+    {
+        BandInfo band;
+        band.fc = 3.5e9 + rb * 180e3;
+        band.fl = band.fc - 90e3;
+        band.fh = band.fc + 90e3;
+        config.m_bands.push_back(band);
+    }
+    writer.Write({0, config});
+
+    NrMacCschedSapProvider::CschedCellConfigReqParameters cellConfig;
+    cellConfig.m_ulBandwidth = 25;
+    cellConfig.m_dlBandwidth = 25;
+    writer.Write({0, cellConfig});
+
+    for (uint16_t rnti = 1; rnti <= NUM_UES; ++rnti)
+    {
+        NrMacCschedSapProvider::CschedUeConfigReqParameters ueConfig;
+        ueConfig.m_rnti = rnti;
+        ueConfig.m_beamConfId = BeamConfId(BeamId(rnti % 2, 90.0), BeamId::GetEmptyBeamId());
+        ueConfig.m_transmissionMode = 0;
+        writer.Write({0, ueConfig});
+
+        NrMacCschedSapProvider::CschedLcConfigReqParameters lcConfig;
+        lcConfig.m_rnti = rnti;
+        lcConfig.m_reconfigureFlag = false;
+        LogicalChannelConfigListElement_s lc;
+        lc.m_logicalChannelIdentity = 1;
+        lc.m_logicalChannelGroup = 1;
+        lc.m_direction = LogicalChannelConfigListElement_s::DIR_BOTH;
+        lc.m_qosBearerType = LogicalChannelConfigListElement_s::QBT_NON_GBR;
+        lc.m_qci = 9;
+        lc.m_eRabMaximulBitrateUl = 0;
+        lc.m_eRabMaximulBitrateDl = 0;
+        lc.m_eRabGuaranteedBitrateUl = 0;
+        lc.m_eRabGuaranteedBitrateDl = 0;
+        lcConfig.m_logicalChannelConfigList.emplace_back(lc);
+        writer.Write({0, lcConfig});
+    }
+
+    for (uint32_t slot = 1; slot <= NUM_SLOTS; ++slot)
+    {
+        const int64_t timeNs = MilliSeconds(slot).GetNanoSeconds();
+
+        // WB CQIs, also of the idle UEs, which must be kept in their record
+        if (slot % 10 == 1)
+        {
+            NrMacSchedSapProvider::SchedDlCqiInfoReqParameters dlCqi;
+            dlCqi.m_sfnsf = GetSfnSf(slot);
+            for (uint16_t rnti = 1; rnti <= NUM_UES; ++rnti)
+            {
+                DlCqiInfo cqi;
+                cqi.m_rnti = rnti;
+                cqi.m_ri = 1;
+                cqi.m_cqiType = DlCqiInfo::WB;
+                cqi.m_wbCqi = {static_cast<uint8_t>(3 + (rnti + slot / 10) % 12)};
+                dlCqi.m_cqiList.push_back(cqi);
+            }
+            writer.Write({timeNs, dlCqi});
+        }
+
+        // Each UE receives data every 40 slots, and is idle in between
+        for (uint16_t rnti = 1; rnti <= NUM_UES && slot <= LAST_DATA; ++rnti)
+        {
+            if ((slot + 7 * rnti) % 40 == 0)
+            {
+                NrMacSchedSapProvider::SchedDlRlcBufferReqParameters rlc;
+                rlc.m_rnti = rnti;
+                rlc.m_logicalChannelIdentity = 1;
+                rlc.m_rlcTransmissionQueueSize = 200 * rnti;
+                rlc.m_rlcTransmissionQueueHolDelay = 0;
+                rlc.m_rlcRetransmissionQueueSize = 0;
+                rlc.m_rlcRetransmissionHolDelay = 0;
+                rlc.m_rlcStatusPduSize = 0;
+                writer.Write({timeNs, rlc});
+            }
+        }
+
+        // UL data for the odd UEs, and an empty BSR for the even ones
+        if (slot % 50 == 5 && slot <= LAST_DATA)
+        {
+            NrMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters bsr;
+            bsr.m_sfnSf = GetSfnSf(slot);
+            for (uint16_t rnti = 1; rnti <= NUM_UES; ++rnti)
+            {
+                MacCeElement ce;
+                ce.m_rnti = rnti;
+                ce.m_macCeType = MacCeElement::BSR;
+                const uint8_t level = rnti % 2 == 1 ? 10 + rnti % 10 : 0;
+                ce.m_macCeValue.m_bufferStatus = {0, level, 0, 0};
+                bsr.m_macCeList.push_back(ce);
+            }
+            writer.Write({timeNs, bsr});
+        }
+
+        NrMacSchedSapProvider::SchedUlTriggerReqParameters ulTrigger;
+        ulTrigger.m_snfSf = GetSfnSf(slot + 2);
+        ulTrigger.m_slotType = LteNrTddSlotType::F;
+        writer.Write({timeNs, ulTrigger});
+
+        NrMacSchedSapProvider::SchedDlTriggerReqParameters dlTrigger;
+        dlTrigger.m_snfSf = GetSfnSf(slot);
+        dlTrigger.m_slotType = LteNrTddSlotType::F;
+        writer.Write({timeNs, dlTrigger});
+    }
+    writer.Close();
+}
+
+void
+TestSchedulerClassCompact::DoRun()
+{
+    const std::string filename = CreateTempDirFilename("nr-test-scheduler-class.bin");
+    WriteTrace(filename);
+
+    NrMacSchedulerReplay::Report reports[2];
+    std::size_t numUeRepresentations[2];
+    for (const bool compact : {false, true})
+    {
+        ObjectFactory factory;
+        factory.SetTypeId("ns3::NrMacSchedulerOfdmaClass");
+        factory.Set("IncrementalActiveUe", BooleanValue(true));
+        factory.Set("CompactIdleUes", BooleanValue(compact));
+        auto sched = factory.Create<NrMacSchedulerNs3>();
+
+        NrMacSchedulerReplay replay(filename);
+        reports[compact] = replay.Run(sched);
+        Simulator::Destroy();
+        numUeRepresentations[compact] = sched->GetNumUeRepresentations();
+    }
+
+    NS_TEST_ASSERT_MSG_GT(reports[false].m_numDlDci, 0, "The scheduler did not schedule DL data");
+    NS_TEST_ASSERT_MSG_GT(reports[false].m_numUlDci, 0, "The scheduler did not schedule UL data");
+    NS_TEST_ASSERT_MSG_EQ(reports[true].m_numDlDci, reports[false].m_numDlDci, "Different DL DCIs");
+    NS_TEST_ASSERT_MSG_EQ(reports[true].m_numUlDci, reports[false].m_numUlDci, "Different UL DCIs");
+    NS_TEST_ASSERT_MSG_EQ(reports[true].m_digest, reports[false].m_digest, "Different decisions");
+    NS_TEST_ASSERT_MSG_EQ(numUeRepresentations[false],
+                          NUM_UES,
+                          "Without compaction, every UE keeps its representation");
+    NS_TEST_ASSERT_MSG_LT(numUeRepresentations[true],
+                          NUM_UES,
+                          "The idle UEs must keep only their compact record");
+}
+
+class TestSchedulerClassSuite : public TestSuite
+{
+  public:
+    TestSchedulerClassSuite()
+        : TestSuite("nr-test-scheduler-class", UNIT)
+    {
+        AddTestCase(new TestSchedulerClassOrder(), QUICK);
+        AddTestCase(new TestSchedulerClassChanges(), QUICK);
+        AddTestCase(new TestSchedulerClassCompact(), QUICK);
+    }
+};
+
+static TestSchedulerClassSuite testSchedulerClassSuite; //!< Class scheduler test suite
+
+} // namespace ns3
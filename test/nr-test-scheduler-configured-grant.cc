@@ -0,0 +1,664 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include <ns3/boolean.h>
+#include <ns3/nr-amc.h>
+#include <ns3/nr-mac-scheduler-ns3.h>
+#include <ns3/object-factory.h>
+#include <ns3/simulator.h>
+#include <ns3/test.h>
+
+#include <map>
+#include <set>
+#include <vector>
+
+/**
+ * \file nr-test-scheduler-configured-grant.cc
+ * \ingroup test
+ *
+ * \brief Unit-testing for the configured grants of NrMacSchedulerNs3. A fake
+ * MAC drives the scheduler, with a DL grant (SPS) for UE 1, which always has
+ * DL data, and a UL grant for UE 2, whose occasions are always NACKed. Both
+ * grants are removed halfway. The test checks that:
+ *
+ * - no other allocation, DL or UL, uses the symbols of the occasions;
+ * - only the first occasion has a DCI that activates the grant, the next
+ *   ones are marked as occasions;
+ * - the occasion after the removal has the release DCI, and no occasion
+ *   follows it;
+ * - a UL occasion flushes the retransmission pending in its HARQ process,
+ *   while the release does not;
+ * - at the end, the grants and their HARQ processes are released.
+ */
+namespace ns3
+{
+
+/**
+ * \brief A data DCI, as it was scheduled
+ */
+struct TestCgDci
+{
+    uint16_t m_rnti{0};                                              //!< RNTI
+    DciInfoElementTdma::DciFormat m_format{DciInfoElementTdma::DL}; //!< DL or UL
+    uint8_t m_symStart{0};                                           //!< First symbol
+    uint8_t m_numSym{0};                                             //!< Number of symbols
+    uint8_t m_ndi{0};                                                //!< NDI of the first TB
+    uint32_t m_tbSize{0};                                            //!< Size of the first TB
+    uint8_t m_harqProcess{0};                                        //!< HARQ process
+    uint16_t m_cgPeriodicity{0}; //!< Periodicity, for the configured grants
+    bool m_cgOccasion{false};    //!< Occasion of an active grant
+    bool m_cgRelease{false};     //!< Release of the grant
+};
+
+/**
+ * \brief The data DCIs, DL and UL, by slot
+ */
+using TestCgDciMap = std::map<uint32_t, std::vector<TestCgDci>>;
+
+/**
+ * \brief Test the occasions, the activation and the release of the DL and UL
+ * configured grants
+ */
+class TestSchedulerConfiguredGrant : public TestCase
+{
+  public:
+    TestSchedulerConfiguredGrant(const std::string& type)
+        : TestCase("Configured grants of scheduler " + type),
+          m_type(type)
+    {
+    }
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Check the occasions, the activation and the release of a grant
+     * \param dcis the data DCIs of the run
+     * \param config the configuration of the grant
+     * \param rnti the RNTI of the UE
+     * \param removalSlot the first slot scheduled after the removal
+     * \param harqProcess the HARQ process of the grant, filled by the check
+     */
+    void CheckGrant(const TestCgDciMap& dcis,
+                    const NrConfiguredGrant& config,
+                    uint16_t rnti,
+                    uint32_t removalSlot,
+                    uint8_t* harqProcess);
+
+    std::string m_type;
+};
+
+/**
+ * \brief A fake MAC, which gives DL data to UE 1 in every slot, NACKs the
+ * occasions of the UL grants, acknowledges the other DCIs, and collects the
+ * data DCIs of each slot
+ */
+class TestCgMac : public NrMacSchedSapUser, public NrMacCschedSapUser
+{
+  public:
+    TestCgMac(const Ptr<NrMacSchedulerNs3>& sched);
+
+    void Start(uint16_t numUes, uint32_t numSlots);
+    static SfnSf GetSfnSf(uint32_t slot);
+
+    // inherited from NrMacSchedSapUser
+    void SchedConfigInd(SchedConfigIndParameters params) override;
+    Ptr<const SpectrumModel> GetSpectrumModel() const override;
+    uint32_t GetNumRbPerRbg() const override;
+    uint8_t GetNumHarqProcess() const override;
+    uint16_t GetBwpId() const override;
+    uint16_t GetCellId() const override;
+    uint32_t GetSymbolsPerSlot() const override;
+    Time GetSlotPeriod() const override;
+
+    // inherited from NrMacCschedSapUser
+    void CschedCellConfigCnf(const CschedCellConfigCnfParameters& params) override;
+    void CschedUeConfigCnf(const CschedUeConfigCnfParameters& params) override;
+    void CschedLcConfigCnf(const CschedLcConfigCnfParameters& params) override;
+    void CschedLcReleaseCnf(const CschedLcReleaseCnfParameters& params) override;
+    void CschedUeReleaseCnf(const CschedUeReleaseCnfParameters& params) override;
+    void CschedUeConfigUpdateInd(const CschedUeConfigUpdateIndParameters& params) override;
+    void CschedCellConfigUpdateInd(const CschedCellConfigUpdateIndParameters& params) override;
+
+    TestCgDciMap m_dcis; //!< The data DCIs scheduled so far
+
+  private:
+    void Configure();
+    void Slot(uint32_t slot);
+
+    static constexpr uint32_t NUM_RB = 52; //!< RBs of the bandwidth, one per RBG
+
+    Ptr<NrMacSchedulerNs3> m_sched;
+    Ptr<const SpectrumModel> m_spectrumModel;
+    uint16_t m_numUes{0};
+    uint32_t m_slot{0};
+    std::vector<DlHarqInfo> m_dlFeedback;                     //!< For the next DL trigger
+    std::map<uint32_t, std::vector<UlHarqInfo>> m_ulFeedback; //!< By slot of delivery
+    std::map<uint32_t, std::vector<NrMacSchedSapProvider::SchedUlCqiInfoReqParameters>>
+        m_ulCqi; //!< By slot of delivery
+};
+
+TestCgMac::TestCgMac(const Ptr<NrMacSchedulerNs3>& sched)
+    : m_sched(sched)
+{
+    std::vector<double> centerFrequencies;
+    for (uint32_t rb = 0; rb < NUM_RB; ++rb)
+    {
+        centerFrequencies.push_back(28e9 + rb * 180e3);
+    }
+    m_spectrumModel = Create<SpectrumModel>(centerFrequencies);
+    m_sched->SetMacSchedSapUser(this);
+    m_sched->SetMacCschedSapUser(this);
+}
+
+void
+TestCgMac::Start(uint16_t numUes, uint32_t numSlots)
+{
+    m_numUes = numUes;
+    Simulator::Schedule(Seconds(0), &TestCgMac::Configure, this);
+    for (uint32_t slot = 1; slot <= numSlots; ++slot)
+    {
+        Simulator::Schedule(MilliSeconds(slot), &TestCgMac::Slot, this, slot);
+    }
+}
+
+SfnSf
+TestCgMac::GetSfnSf(uint32_t slot)
+{
+    // Numerology 0: one slot per subframe
+    return SfnSf(slot / 10, slot % 10, 0, 0);
+}
+
+void
+TestCgMac::Configure()
+{
+    NrMacCschedSapProvider* csched = m_sched->GetMacCschedSapProvider();
+
+    NrMacCschedSapProvider::CschedCellConfigReqParameters cellConfig;
+    cellConfig.m_ulBandwidth = NUM_RB;
+    cellConfig.m_dlBandwidth = NUM_RB;
+    csched->CschedCellConfigReq(cellConfig);
+
+    for (uint16_t rnti = 1; rnti <= m_numUes; ++rnti)
+    {
+        NrMacCschedSapProvider::CschedUeConfigReqParameters ueConfig;
+        ueConfig.m_rnti = rnti;
+        ueConfig.m_beamConfId = BeamConfId(BeamId(rnti % 2, 90.0), BeamId::GetEmptyBeamId());
+        ueConfig.m_transmissionMode = 0;
+        csched->CschedUeConfigReq(ueConfig);
+
+        NrMacCschedSapProvider::CschedLcConfigReqParameters lcConfig;
+        lcConfig.m_rnti = rnti;
+        lcConfig.m_reconfigureFlag = false;
+        LogicalChannelConfigListElement_s lc;
+        lc.m_logicalChannelIdentity = 1;
+        lc.m_logicalChannelGroup = 1;
+        lc.m_direction = LogicalChannelConfigListElement_s::DIR_BOTH;
+        lc.m_qosBearerType = LogicalChannelConfigListElement_s::QBT_NON_GBR;
+        lc.m_qci = 9;
+        lc.m_eRabMaximulBitrateUl = 0;
+        lc.m_eRabMaximulBitrateDl = 0;
+        lc.m_eRabGuaranteedBitrateUl = 0;
+        lc.m_eRabGuaranteedBitrateDl = 0;
+        lcConfig.m_logicalChannelConfigList.emplace_back(lc);
+        csched->CschedLcConfigReq(lcConfig);
+    }
+}
+
+void
+TestCgMac::Slot(uint32_t slot)
+{
+    NrMacSchedSapProvider* sched = m_sched->GetMacSchedSapProvider();
+    m_slot = slot;
+
+    for (uint16_t rnti = 1; rnti <= m_numUes; ++rnti)
+    {
+        if ((slot + rnti) % 5 == 0)
+        {
+            NrMacSchedSapProvider::SchedDlRlcBufferReqParameters rlc;
+            rlc.m_rnti = rnti;
+            rlc.m_logicalChannelIdentity = 1;
+            rlc.m_rlcTransmissionQueueSize = 500 * rnti;
+            rlc.m_rlcTransmissionQueueHolDelay = 0;
+            rlc.m_rlcRetransmissionQueueSize = 0;
+            rlc.m_rlcRetransmissionHolDelay = 0;
+            rlc.m_rlcStatusPduSize = 0;
+            sched->SchedDlRlcBufferReq(rlc);
+        }
+    }
+
+    if (slot % 10 == 1)
+    {
+        NrMacSchedSapProvider::SchedDlCqiInfoReqParameters dlCqi;
+        dlCqi.m_sfnsf = GetSfnSf(slot);
+        NrMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters bsr;
+        bsr.m_sfnSf = GetSfnSf(slot);
+        for (uint16_t rnti = 1; rnti <= m_numUes; ++rnti)
+        {
+            DlCqiInfo cqi;
+            cqi.m_rnti = rnti;
+            cqi.m_ri = 1;
+            cqi.m_cqiType = DlCqiInfo::WB;
+            cqi.m_wbCqi = {static_cast<uint8_t>(3 + (rnti + slot / 10) % 12)};
+            dlCqi.m_cqiList.push_back(cqi);
+
+            MacCeElement ce;
+            ce.m_rnti = rnti;
+            ce.m_macCeType = MacCeElement::BSR;
+            ce.m_macCeValue.m_bufferStatus = {0, static_cast<uint8_t>(10 + rnti % 10), 0, 0};
+            bsr.m_macCeList.push_back(ce);
+        }
+        sched->SchedDlCqiInfoReq(dlCqi);
+        sched->SchedUlMacCtrlInfoReq(bsr);
+    }
+
+    if (slot == 3)
+    {
+        NrMacSchedSapProvider::SchedUlSrInfoReqParameters sr;
+        sr.m_snfSf = GetSfnSf(slot);
+        for (uint16_t rnti = 1; rnti <= m_numUes; rnti += 2)
+        {
+            sr.m_srList.push_back(rnti);
+        }
+        sched->SchedUlSrInfoReq(sr);
+    }
+
+    // UE 1 always has DL data, for the DL grant
+    NrMacSchedSapProvider::SchedDlRlcBufferReqParameters rlc;
+    rlc.m_rnti = 1;
+    rlc.m_logicalChannelIdentity = 1;
+    rlc.m_rlcTransmissionQueueSize = 100000;
+    rlc.m_rlcTransmissionQueueHolDelay = 0;
+    rlc.m_rlcRetransmissionQueueSize = 0;
+    rlc.m_rlcRetransmissionHolDelay = 0;
+    rlc.m_rlcStatusPduSize = 0;
+    sched->SchedDlRlcBufferReq(rlc);
+
+    for (const auto& ulCqi : m_ulCqi[slot])
+    {
+        sched->SchedUlCqiInfoReq(ulCqi);
+    }
+    m_ulCqi.erase(slot);
+
+    // UL is scheduled two slots in advance, as the MAC does with K2
+    NrMacSchedSapProvider::SchedUlTriggerReqParameters ulTrigger;
+    ulTrigger.m_snfSf = GetSfnSf(slot + 2);
+    ulTrigger.m_ulHarqInfoList = std::move(m_ulFeedback[slot]);
+    ulTrigger.m_slotType = LteNrTddSlotType::F;
+    m_ulFeedback.erase(slot);
+    sched->SchedUlTriggerReq(ulTrigger);
+
+    NrMacSchedSapProvider::SchedDlTriggerReqParameters dlTrigger;
+    dlTrigger.m_snfSf = GetSfnSf(slot);
+    dlTrigger.m_dlHarqInfoList = std::move(m_dlFeedback);
+    dlTrigger.m_slotType = LteNrTddSlotType::F;
+    m_dlFeedback.clear();
+    sched->SchedDlTriggerReq(dlTrigger);
+}
+
+void
+TestCgMac::SchedConfigInd(SchedConfigIndParameters params)
+{
+    auto& dcis = m_dcis[params.m_sfnSf.Normalize()];
+    std::set<uint8_t> ulCqiSymStart;
+    for (const auto& varTti : params.m_slotAllocInfo.m_varTtiAllocInfo)
+    {
+        const auto& dci = varTti.m_dci;
+        if (dci->m_type != DciInfoElementTdma::DATA)
+        {
+            continue;
+        }
+        TestCgDci record;
+        record.m_rnti = dci->m_rnti;
+        record.m_format = dci->m_format;
+        record.m_symStart = dci->m_symStart;
+        record.m_numSym = dci->m_numSym;
+        record.m_ndi = dci->m_ndi.at(0);
+        record.m_tbSize = dci->m_tbSize.at(0);
+        record.m_harqProcess = dci->m_harqProcess;
+        record.m_cgPeriodicity = dci->m_cgPeriodicity;
+        record.m_cgOccasion = dci->m_cgOccasion;
+        record.m_cgRelease = dci->m_cgRelease;
+        dcis.push_back(record);
+
+        // The release DCIs have no feedback
+        if (dci->m_cgRelease)
+        {
+            continue;
+        }
+        if (dci->m_format == DciInfoElementTdma::DL)
+        {
+            DlHarqInfo harq;
+            harq.m_rnti = dci->m_rnti;
+            harq.m_harqProcessId = dci->m_harqProcess;
+            harq.m_bwpIndex = 0;
+            for (const auto& tbs : dci->m_tbSize)
+            {
+                harq.m_harqStatus.push_back(tbs > 0 ? DlHarqInfo::ACK : DlHarqInfo::NONE);
+            }
+            harq.m_numRetx = dci->m_rv;
+            m_dlFeedback.push_back(harq);
+        }
+        else
+        {
+            // The UL slot is two slots in the future: the feedback comes after it.
+            // The occasions of the UL grants are NACKed
+            UlHarqInfo harq;
+            harq.m_rnti = dci->m_rnti;
+            harq.m_harqProcessId = dci->m_harqProcess;
+            harq.m_bwpIndex = 0;
+            harq.m_receptionStatus =
+                dci->m_cgPeriodicity == 0 ? UlHarqInfo::Ok : UlHarqInfo::NotOk;
+            harq.m_tpc = 1;
+            harq.m_numRetx = 0;
+            m_ulFeedback[m_slot + 3].push_back(harq);
+
+            if (ulCqiSymStart.insert(dci->m_symStart).second)
+            {
+                NrMacSchedSapProvider::SchedUlCqiInfoReqParameters ulCqi;
+                ulCqi.m_sfnSf = params.m_sfnSf;
+                ulCqi.m_symStart = dci->m_symStart;
+                ulCqi.m_ulCqi.m_type = UlCqiInfo::PUSCH;
+                ulCqi.m_ulCqi.m_sinr = std::vector<double>(NUM_RB, 5.0 + dci->m_rnti);
+                m_ulCqi[m_slot + 3].push_back(ulCqi);
+            }
+        }
+    }
+}
+
+Ptr<const SpectrumModel>
+TestCgMac::GetSpectrumModel() const
+{
+    return m_spectrumModel;
+}
+
+uint32_t
+TestCgMac::GetNumRbPerRbg() const
+{
+    return 1;
+}
+
+uint8_t
+TestCgMac::GetNumHarqProcess() const
+{
+    return 16;
+}
+
+uint16_t
+TestCgMac::GetBwpId() const
+{
+    return 0;
+}
+
+uint16_t
+TestCgMac::GetCellId() const
+{
+    return 1;
+}
+
+uint32_t
+TestCgMac::GetSymbolsPerSlot() const
+{
+    return 14;
+}
+
+Time
+TestCgMac::GetSlotPeriod() const
+{
+    return MilliSeconds(1);
+}
+
+void
+TestCgMac::CschedCellConfigCnf(const CschedCellConfigCnfParameters& params)
+{
+}
+
+void
+TestCgMac::CschedUeConfigCnf(const CschedUeConfigCnfParameters& params)
+{
+}
+
+void
+TestCgMac::CschedLcConfigCnf(const CschedLcConfigCnfParameters& params)
+{
+}
+
+void
+TestCgMac::CschedLcReleaseCnf(const CschedLcReleaseCnfParameters& params)
+{
+}
+
+void
+TestCgMac::CschedUeReleaseCnf(const CschedUeReleaseCnfParameters& params)
+{
+}
+
+void
+TestCgMac::CschedUeConfigUpdateInd(const CschedUeConfigUpdateIndParameters& params)
+{
+}
+
+void
+TestCgMac::CschedCellConfigUpdateInd(const CschedCellConfigUpdateIndParameters& params)
+{
+}
+
+void
+TestSchedulerConfiguredGrant::CheckGrant(const TestCgDciMap& dcis,
+                                         const NrConfiguredGrant& config,
+                                         uint16_t rnti,
+                                         uint32_t removalSlot,
+                                         uint8_t* harqProcess)
+{
+    const std::string name = config.m_format == DciInfoElementTdma::DL ? "DL" : "UL";
+
+    // The DCIs of the grant: occasions, then the release
+    std::vector<uint32_t> occasionSlots;
+    uint32_t releaseSlot = 0;
+    *harqProcess = 255;
+    for (const auto& slot : dcis)
+    {
+        for (const auto& dci : slot.second)
+        {
+            if (dci.m_rnti != rnti || dci.m_format != config.m_format ||
+                dci.m_cgPeriodicity == 0)
+            {
+                continue;
+            }
+
+            NS_TEST_ASSERT_MSG_EQ(config.IsOccasion(TestCgMac::GetSfnSf(slot.first)),
+                                  true,
+                                  "The " << name << " grant is used out of its occasions");
+            NS_TEST_ASSERT_MSG_EQ(releaseSlot, 0, "The " << name << " grant is used after release");
+            NS_TEST_EXPECT_MSG_EQ(+dci.m_symStart, +config.m_symStart, "Wrong symbols");
+            NS_TEST_EXPECT_MSG_EQ(+dci.m_numSym, +config.m_numSym, "Wrong symbols");
+            if (*harqProcess == 255)
+            {
+                *harqProcess = dci.m_harqProcess;
+            }
+            NS_TEST_EXPECT_MSG_EQ(+dci.m_harqProcess, +*harqProcess, "The HARQ process changed");
+
+            if (dci.m_cgRelease)
+            {
+                NS_TEST_EXPECT_MSG_GT_OR_EQ(slot.first,
+                                            removalSlot,
+                                            "The " << name << " grant is released too early");
+                NS_TEST_EXPECT_MSG_EQ(dci.m_tbSize, 0, "The release DCI carries data");
+                releaseSlot = slot.first;
+            }
+            else
+            {
+                NS_TEST_EXPECT_MSG_LT(slot.first, removalSlot, "Occasion after the removal");
+                NS_TEST_EXPECT_MSG_EQ(dci.m_cgOccasion,
+                                      !occasionSlots.empty(),
+                                      "Only the first occasion activates the " << name
+                                                                               << " grant");
+                occasionSlots.push_back(slot.first);
+            }
+        }
+    }
+
+    NS_TEST_ASSERT_MSG_GT(occasionSlots.size(), 1, "The " << name << " grant was not used");
+    NS_TEST_ASSERT_MSG_GT(releaseSlot, 0, "The " << name << " grant was not released");
+    NS_TEST_EXPECT_MSG_EQ(releaseSlot - occasionSlots.back(),
+                          static_cast<uint32_t>(config.m_periodicity),
+                          "The " << name << " grant is not released in the next occasion");
+
+    // No other allocation, DL or UL, in the symbols of the occasions
+    const uint32_t reservedMask = ((1U << config.m_numSym) - 1) << config.m_symStart;
+    for (const auto& slot : dcis)
+    {
+        if (slot.first < occasionSlots.front() || slot.first > releaseSlot ||
+            !config.IsOccasion(TestCgMac::GetSfnSf(slot.first)))
+        {
+            continue;
+        }
+        for (const auto& dci : slot.second)
+        {
+            if (dci.m_rnti == rnti && dci.m_format == config.m_format && dci.m_cgPeriodicity > 0)
+            {
+                continue;
+            }
+            const uint32_t mask = ((1U << dci.m_numSym) - 1) << dci.m_symStart;
+            NS_TEST_EXPECT_MSG_EQ((mask & reservedMask),
+                                  0,
+                                  "An allocation of UE " << dci.m_rnti << " in slot " << slot.first
+                                                         << " overlaps the " << name
+                                                         << " configured grant");
+        }
+    }
+}
+
+void
+TestSchedulerConfiguredGrant::DoRun()
+{
+    const uint16_t numUes = 4;
+    const uint32_t numSlots = 100;
+    const uint32_t removalSlot = 61;
+
+    ObjectFactory factory;
+    factory.SetTypeId(m_type);
+    factory.Set("EnableSrsInFSlots", BooleanValue(false));
+    Ptr<NrMacSchedulerNs3> sched = factory.Create<NrMacSchedulerNs3>();
+    sched->InstallDlAmc(CreateObject<NrAmc>());
+    sched->InstallUlAmc(CreateObject<NrAmc>());
+
+    NrConfiguredGrant dlGrant;
+    dlGrant.m_format = DciInfoElementTdma::DL;
+    dlGrant.m_lcId = 1;
+    dlGrant.m_periodicity = 5;
+    dlGrant.m_offset = 2;
+    dlGrant.m_symStart = 1;
+    dlGrant.m_numSym = 2;
+    dlGrant.m_mcs = 5;
+
+    NrConfiguredGrant ulGrant;
+    ulGrant.m_format = DciInfoElementTdma::UL;
+    ulGrant.m_periodicity = 3;
+    ulGrant.m_offset = 1;
+    ulGrant.m_symStart = 11;
+    ulGrant.m_numSym = 2;
+    ulGrant.m_mcs = 5;
+
+    TestCgMac mac(sched);
+    mac.Start(numUes, numSlots);
+    Simulator::Schedule(MicroSeconds(500),
+                        &NrMacSchedulerNs3::AddConfiguredGrant,
+                        sched,
+                        1,
+                        dlGrant);
+    Simulator::Schedule(MicroSeconds(500),
+                        &NrMacSchedulerNs3::AddConfiguredGrant,
+                        sched,
+                        2,
+                        ulGrant);
+    Simulator::Schedule(MicroSeconds(removalSlot * 1000 - 500),
+                        &NrMacSchedulerNs3::RemoveConfiguredGrant,
+                        sched,
+                        1,
+                        DciInfoElementTdma::DL);
+    Simulator::Schedule(MicroSeconds(removalSlot * 1000 - 500),
+                        &NrMacSchedulerNs3::RemoveConfiguredGrant,
+                        sched,
+                        2,
+                        DciInfoElementTdma::UL);
+    Simulator::Run();
+
+    // The DL of a slot is scheduled in the slot, the UL two slots before
+    uint8_t dlHarq = 255;
+    uint8_t ulHarq = 255;
+    CheckGrant(mac.m_dcis, dlGrant, 1, removalSlot, &dlHarq);
+    CheckGrant(mac.m_dcis, ulGrant, 2, removalSlot + 2, &ulHarq);
+    NS_TEST_ASSERT_MSG_NE(+dlHarq, 255, "No DL HARQ process for the configured grant");
+    NS_TEST_ASSERT_MSG_NE(+ulHarq, 255, "No UL HARQ process for the configured grant");
+
+    // The NACKed occasions are retransmitted only from the slot of the release
+    uint32_t releaseSlot = 0;
+    for (const auto& slot : mac.m_dcis)
+    {
+        for (const auto& dci : slot.second)
+        {
+            if (dci.m_rnti == 2 && dci.m_format == DciInfoElementTdma::UL && dci.m_cgRelease)
+            {
+                releaseSlot = slot.first;
+            }
+        }
+    }
+    uint32_t retxBeforeRelease = 0;
+    uint32_t retxAfterRelease = 0;
+    for (const auto& slot : mac.m_dcis)
+    {
+        for (const auto& dci : slot.second)
+        {
+            if (dci.m_rnti != 2 || dci.m_format != DciInfoElementTdma::UL ||
+                dci.m_cgPeriodicity > 0 || dci.m_harqProcess != ulHarq || dci.m_ndi != 0)
+            {
+                continue;
+            }
+            if (slot.first < releaseSlot)
+            {
+                ++retxBeforeRelease;
+            }
+            else
+            {
+                ++retxAfterRelease;
+            }
+        }
+    }
+    NS_TEST_EXPECT_MSG_EQ(retxBeforeRelease, 0, "An occasion did not flush its retransmission");
+    NS_TEST_EXPECT_MSG_GT(retxAfterRelease, 0, "The release flushed the last retransmission");
+
+    NS_TEST_EXPECT_MSG_EQ(sched->m_configuredGrantUes.empty(), true, "Configured grants left");
+    NS_TEST_EXPECT_MSG_EQ(sched->m_ueMap.at(1)->m_configuredGrants.empty(), true, "DL grant left");
+    NS_TEST_EXPECT_MSG_EQ(sched->m_ueMap.at(2)->m_configuredGrants.empty(), true, "UL grant left");
+    NS_TEST_EXPECT_MSG_EQ(sched->m_ueMap.at(1)->m_dlHarq.IsReserved(dlHarq),
+                          false,
+                          "The DL HARQ process is still reserved");
+    NS_TEST_EXPECT_MSG_EQ(sched->m_ueMap.at(2)->m_ulHarq.IsReserved(ulHarq),
+                          false,
+                          "The UL HARQ process is still reserved");
+
+    Simulator::Destroy();
+    sched->Dispose();
+}
+
+class TestSchedulerConfiguredGrantSuite : public TestSuite
+{
+  public:
+    TestSchedulerConfiguredGrantSuite()
+        : TestSuite("nr-test-scheduler-configured-grant", UNIT)
+    {
+        for (const std::string type : {"ns3::NrMacSchedulerTdmaRR", "ns3::NrMacSchedulerOfdmaRR"})
+        {
+            AddTestCase(new TestSchedulerConfiguredGrant(type), QUICK);
+        }
+    }
+};
+
+static TestSchedulerConfiguredGrantSuite
+    testSchedulerConfiguredGrantSuite; //!< Configured grant test suite
+
+} // namespace ns3
@@ -0,0 +1,186 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include <ns3/nr-mac-scheduler-deadline-queue.h>
+#include <ns3/nr-mac-scheduler-ue-info-edf.h>
+#include <ns3/test.h>
+
+/**
+ * \file nr-test-scheduler-edf.cc
+ * \ingroup test
+ *
+ * \brief Unit-testing for the earliest-deadline-first scheduler. The first
+ * test checks the deadlines kept by NrMacSchedulerDeadlineQueue: the deadline
+ * of each UE, the resolution of each deadline exactly once (met, missed when
+ * it expires, or missed when the packet is served late), and the miss rate of
+ * each 5QI. The second test checks the order of the UEs when the missed
+ * deadlines are deprioritized, and the third one the comparison of the UEs,
+ * by deadline and then by PF metric.
+ */
+namespace ns3
+{
+
+class TestSchedulerEdfDeadlines : public TestCase
+{
+  public:
+    TestSchedulerEdfDeadlines()
+        : TestCase("Resolution of the HOL deadlines")
+    {
+    }
+
+  private:
+    void DoRun() override;
+};
+
+void
+TestSchedulerEdfDeadlines::DoRun()
+{
+    uint32_t resolved = 0;
+    uint32_t missed = 0;
+    NrMacSchedulerDeadlineQueue q;
+    q.SetResolvedCallback([&](uint16_t, uint8_t, uint8_t, bool m) {
+        ++resolved;
+        missed += m ? 1 : 0;
+    });
+
+    q.Update(1, 3, 1, MilliSeconds(50), MilliSeconds(0));
+    q.Update(2, 3, 1, MilliSeconds(30), MilliSeconds(0));
+    q.Update(1, 4, 1, MilliSeconds(20), MilliSeconds(0));
+    NS_TEST_ASSERT_MSG_EQ(q.GetNumLcs(), 3, "Wrong number of LCs with a deadline");
+    NS_TEST_ASSERT_MSG_EQ(q.GetUeDeadline(1), MilliSeconds(20), "Earliest deadline of UE 1");
+    NS_TEST_ASSERT_MSG_EQ(q.GetUeDeadline(2), MilliSeconds(30), "Earliest deadline of UE 2");
+    NS_TEST_ASSERT_MSG_EQ(q.GetUeDeadline(3), Time::Max(), "UE 3 has no deadline");
+
+    q.Update(1, 4, 1, MicroSeconds(20500), MilliSeconds(1));
+    NS_TEST_ASSERT_MSG_EQ(resolved, 0, "A deadline within the resolution is the same packet");
+    NS_TEST_ASSERT_MSG_EQ(q.GetUeDeadline(1), MilliSeconds(20), "The deadline must not move");
+
+    q.Update(1, 4, 1, MilliSeconds(40), MilliSeconds(5));
+    NS_TEST_ASSERT_MSG_EQ(resolved, 1, "The next packet must resolve the deadline");
+    NS_TEST_ASSERT_MSG_EQ(missed, 0, "The packet has been served in time");
+    NS_TEST_ASSERT_MSG_EQ(q.GetUeDeadline(1), MilliSeconds(40), "Deadline of the next packet");
+
+    q.Expire(MilliSeconds(35));
+    NS_TEST_ASSERT_MSG_EQ(missed, 1, "The deadline of UE 2 has expired");
+    NS_TEST_ASSERT_MSG_EQ(q.IsMissed(2, 3), true, "The LC of UE 2 must be flagged");
+    NS_TEST_ASSERT_MSG_EQ(q.IsMissed(1, 4), false, "The LC of UE 1 is in time");
+    NS_TEST_ASSERT_MSG_EQ(q.GetUeDeadline(2),
+                          MilliSeconds(30),
+                          "A missed deadline keeps ordering the UE");
+
+    q.Remove(2, 3, MilliSeconds(36));
+    NS_TEST_ASSERT_MSG_EQ(resolved, 2, "A flagged deadline must not be resolved again");
+    q.Remove(1, 4, MilliSeconds(45));
+    NS_TEST_ASSERT_MSG_EQ(missed, 2, "A packet served after its deadline missed it");
+    NS_TEST_ASSERT_MSG_EQ(resolved, 3, "Wrong number of resolved deadlines");
+    NS_TEST_ASSERT_MSG_EQ(q.GetNumResolved(1), 3, "Wrong number of resolved deadlines");
+    NS_TEST_ASSERT_MSG_EQ_TOL(q.GetMissRate(1), 2.0 / 3.0, 1e-9, "Wrong miss rate of the 5QI");
+
+    q.Update(3, 3, 2, MilliSeconds(10), MilliSeconds(20));
+    NS_TEST_ASSERT_MSG_EQ(q.IsMissed(3, 3), true, "A deadline in the past is missed");
+    NS_TEST_ASSERT_MSG_EQ(q.GetNumMissed(2), 1, "The miss rate is per 5QI");
+    NS_TEST_ASSERT_MSG_EQ_TOL(q.GetMissRate(1), 2.0 / 3.0, 1e-9, "The miss rate is per 5QI");
+
+    q.RemoveUe(1);
+    q.RemoveUe(3);
+    NS_TEST_ASSERT_MSG_EQ(q.GetNumLcs(), 0, "All the deadlines must be removed");
+    NS_TEST_ASSERT_MSG_EQ(resolved, 4, "Releasing a UE must not resolve its deadlines");
+    q.Expire(Seconds(1));
+    NS_TEST_ASSERT_MSG_EQ(resolved, 4, "A removed deadline must not expire");
+}
+
+class TestSchedulerEdfDeprioritize : public TestCase
+{
+  public:
+    TestSchedulerEdfDeprioritize()
+        : TestCase("Order of the UEs with missed deadlines deprioritized")
+    {
+    }
+
+  private:
+    void DoRun() override;
+};
+
+void
+TestSchedulerEdfDeprioritize::DoRun()
+{
+    NrMacSchedulerDeadlineQueue q;
+    q.SetDeprioritizeMissed(true);
+
+    q.Update(1, 3, 1, MilliSeconds(10), MilliSeconds(0));
+    q.Update(1, 4, 1, MilliSeconds(50), MilliSeconds(0));
+    q.Update(2, 3, 1, MilliSeconds(30), MilliSeconds(0));
+    NS_TEST_ASSERT_MSG_EQ(q.GetUeDeadline(1), MilliSeconds(10), "Earliest deadline of UE 1");
+
+    q.Expire(MilliSeconds(20));
+    NS_TEST_ASSERT_MSG_EQ(q.GetUeDeadline(1),
+                          MilliSeconds(50),
+                          "UE 1 must be ordered by the deadline that can still be met");
+
+    q.Expire(MilliSeconds(40));
+    NS_TEST_ASSERT_MSG_EQ(q.GetUeDeadline(2),
+                          Time::Max(),
+                          "A UE with only missed deadlines must be ordered last");
+    NS_TEST_ASSERT_MSG_EQ(q.GetUeDeadline(1), MilliSeconds(50), "UE 1 is still in time");
+
+    q.Remove(1, 4, MilliSeconds(45));
+    NS_TEST_ASSERT_MSG_EQ(q.GetUeDeadline(1), Time::Max(), "UE 1 has only missed deadlines");
+    NS_TEST_ASSERT_MSG_EQ(q.GetNumMissed(1), 2, "Wrong number of missed deadlines");
+}
+
+class TestSchedulerEdfCompare : public TestCase
+{
+  public:
+    TestSchedulerEdfCompare()
+        : TestCase("Comparison of the UEs by deadline and PF metric")
+    {
+    }
+
+  private:
+    void DoRun() override;
+};
+
+void
+TestSchedulerEdfCompare::DoRun()
+{
+    auto createUe = [](uint16_t rnti, const Time& deadline, double potential, double avg) {
+        auto ue = std::make_shared<NrMacSchedulerUeInfoEdf>(1.0, rnti, BeamConfId(), []() {
+            return 1;
+        });
+        ue->m_dlDeadline = deadline;
+        ue->m_potentialTputDl = potential;
+        ue->m_avgTputDl = avg;
+        return NrMacSchedulerNs3::UePtrAndBufferReq(ue, 100);
+    };
+    auto compare = NrMacSchedulerUeInfoEdf::CompareUeDeadlinesDl;
+
+    auto early = createUe(1, MilliSeconds(10), 1.0, 10.0);
+    auto late = createUe(2, MilliSeconds(20), 10.0, 1.0);
+    auto lateStarved = createUe(3, MilliSeconds(20), 10.0, 0.5);
+    auto none = createUe(4, Time::Max(), 100.0, 0.1);
+
+    NS_TEST_ASSERT_MSG_EQ(compare(early, late), true, "The earliest deadline goes first");
+    NS_TEST_ASSERT_MSG_EQ(compare(late, early), false, "The earliest deadline goes first");
+    NS_TEST_ASSERT_MSG_EQ(compare(lateStarved, late), true, "Same deadline: the PF metric wins");
+    NS_TEST_ASSERT_MSG_EQ(compare(late, lateStarved), false, "Same deadline: the PF metric wins");
+    NS_TEST_ASSERT_MSG_EQ(compare(late, none), true, "A UE without deadline goes last");
+}
+
+class TestSchedulerEdfSuite : public TestSuite
+{
+  public:
+    TestSchedulerEdfSuite()
+        : TestSuite("nr-test-scheduler-edf", UNIT)
+    {
+        AddTestCase(new TestSchedulerEdfDeadlines(), QUICK);
+        AddTestCase(new TestSchedulerEdfDeprioritize(), QUICK);
+        AddTestCase(new TestSchedulerEdfCompare(), QUICK);
+    }
+};
+
+static TestSchedulerEdfSuite testSchedulerEdfSuite; //!< EDF scheduler test suite
+
+} // namespace ns3
@@ -0,0 +1,603 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include <ns3/boolean.h>
+#include <ns3/eps-bearer.h>
+#include <ns3/nr-amc.h>
+#include <ns3/nr-mac-scheduler-ns3.h>
+#include <ns3/nr-mac-scheduler-recorder.h>
+#include <ns3/nr-mac-scheduler-replay.h>
+#include <ns3/object-factory.h>
+#include <ns3/simulator.h>
+#include <ns3/test.h>
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
+
+/**
+ * \file nr-test-scheduler-mini-slot.cc
+ * \ingroup test
+ *
+ * \brief Unit-testing for the DL mini-slots of NrMacSchedulerNs3. A fake MAC
+ * gives a delay-critical GBR LC to three UEs, and a non-GBR LC to a fourth
+ * one. Halfway through each slot, after the slot is scheduled, it reports the
+ * DL buffers with a different head of line delay for each GBR UE, and offers
+ * a mini-slot to the scheduler. The test checks that the mini-slot goes to
+ * the delay-critical LC with the highest head of line delay, over the entire
+ * band, from the symbol after the one of the DCI to the end of the mini-slot;
+ * without delay-critical data, the mini-slot is not used. The test is also
+ * run through a NrMacSchedulerRecorder: the replayed trace, with its mini-slot
+ * requests, must give the same decisions.
+ */
+namespace ns3
+{
+
+/**
+ * \brief Check the mini-slots given by the scheduler, and optionally the
+ * record and replay of the mini-slot requests
+ */
+class TestSchedulerMiniSlot : public TestCase
+{
+  public:
+    TestSchedulerMiniSlot(const std::string& type, bool record)
+        : TestCase("Mini-slots of scheduler " + type + (record ? ", recorded and replayed" : "")),
+          m_type(type),
+          m_record(record)
+    {
+    }
+
+    /**
+     * \brief Check the answer of the scheduler to a mini-slot request
+     * \param params the mini-slot request
+     * \param expectedRnti the UE that should get the mini-slot, or 0 if none
+     * \param dcis the DCIs of the answer
+     */
+    void CheckMiniSlot(const NrMacSchedSapProvider::SchedDlMiniSlotReqParameters& params,
+                       uint16_t expectedRnti,
+                       const std::vector<std::shared_ptr<DciInfoElementTdma>>& dcis);
+
+  private:
+    void DoRun() override;
+    static Ptr<NrMacSchedulerNs3> CreateScheduler(const std::string& type);
+
+    std::string m_type;         //!< Type of the scheduler
+    bool m_record;              //!< Record the run, and replay it
+    uint32_t m_numMiniSlots{0}; //!< Mini-slots used
+    uint32_t m_numUnused{0};    //!< Mini-slots offered without delay-critical data
+    uint32_t m_numRb{52};       //!< RBs of the bandwidth, one per RBG
+};
+
+/**
+ * \brief A fake MAC, which acknowledges every DCI, and offers a mini-slot in
+ * the middle of each slot
+ *
+ * It calls the given SAP providers, those of the scheduler or of a
+ * NrMacSchedulerRecorder: the caller connects the SAP users.
+ */
+class TestMiniSlotMac : public NrMacSchedSapUser, public NrMacCschedSapUser
+{
+  public:
+    TestMiniSlotMac(NrMacSchedSapProvider* sched,
+                    NrMacCschedSapProvider* csched,
+                    TestSchedulerMiniSlot* test);
+
+    void Start(uint16_t numUes, uint32_t numSlots);
+    const NrMacSchedulerReplay::Report& GetReport() const;
+
+    // inherited from NrMacSchedSapUser
+    void SchedConfigInd(SchedConfigIndParameters params) override;
+    Ptr<const SpectrumModel> GetSpectrumModel() const override;
+    uint32_t GetNumRbPerRbg() const override;
+    uint8_t GetNumHarqProcess() const override;
+    uint16_t GetBwpId() const override;
+    uint16_t GetCellId() const override;
+    uint32_t GetSymbolsPerSlot() const override;
+    Time GetSlotPeriod() const override;
+
+    // inherited from NrMacCschedSapUser
+    void CschedCellConfigCnf(const CschedCellConfigCnfParameters& params) override;
+    void CschedUeConfigCnf(const CschedUeConfigCnfParameters& params) override;
+    void CschedLcConfigCnf(const CschedLcConfigCnfParameters& params) override;
+    void CschedLcReleaseCnf(const CschedLcReleaseCnfParameters& params) override;
+    void CschedUeReleaseCnf(const CschedUeReleaseCnfParameters& params) override;
+    void CschedUeConfigUpdateInd(const CschedUeConfigUpdateIndParameters& params) override;
+    void CschedCellConfigUpdateInd(const CschedCellConfigUpdateIndParameters& params) override;
+
+    static constexpr uint16_t NUM_GBR_UES = 3;        //!< UEs with a delay-critical GBR LC
+    static constexpr uint8_t MINI_SLOT_SYM_START = 5; //!< First symbol of the mini-slots
+    static constexpr uint8_t MINI_SLOT_NUM_SYM = 4;   //!< Symbols of the mini-slots
+
+  private:
+    void Configure();
+    void Slot(uint32_t slot);
+    static SfnSf GetSfnSf(uint32_t slot);
+
+    /**
+     * \brief Report the DL buffers, and offer a mini-slot
+     * \param slot the slot
+     */
+    void MiniSlot(uint32_t slot);
+
+    static constexpr uint32_t NUM_RB = 52; //!< RBs of the bandwidth, one per RBG
+
+    NrMacSchedSapProvider* m_schedSap;
+    NrMacCschedSapProvider* m_cschedSap;
+    TestSchedulerMiniSlot* m_test;
+    Ptr<const SpectrumModel> m_spectrumModel;
+    uint16_t m_numUes{0};
+    uint32_t m_slot{0};
+    std::vector<DlHarqInfo> m_dlFeedback;                     //!< For the next DL trigger
+    std::map<uint32_t, std::vector<UlHarqInfo>> m_ulFeedback; //!< By slot of delivery
+    std::map<uint32_t, std::vector<NrMacSchedSapProvider::SchedUlCqiInfoReqParameters>>
+        m_ulCqi; //!< By slot of delivery
+    NrMacSchedulerReplay::Report m_report;
+    std::vector<std::shared_ptr<DciInfoElementTdma>> m_miniSlotDcis; //!< Answer of the scheduler
+};
+
+TestMiniSlotMac::TestMiniSlotMac(NrMacSchedSapProvider* sched,
+                                 NrMacCschedSapProvider* csched,
+                                 TestSchedulerMiniSlot* test)
+    : m_schedSap(sched),
+      m_cschedSap(csched),
+      m_test(test)
+{
+    std::vector<double> centerFrequencies;
+    for (uint32_t rb = 0; rb < NUM_RB; ++rb)
+    {
+        centerFrequencies.push_back(28e9 + rb * 180e3);
+    }
+    m_spectrumModel = Create<SpectrumModel>(centerFrequencies);
+}
+
+void
+TestMiniSlotMac::Start(uint16_t numUes, uint32_t numSlots)
+{
+    m_numUes = numUes;
+    Simulator::Schedule(Seconds(0), &TestMiniSlotMac::Configure, this);
+    for (uint32_t slot = 1; slot <= numSlots; ++slot)
+    {
+        Simulator::Schedule(MilliSeconds(slot), &TestMiniSlotMac::Slot, this, slot);
+    }
+}
+
+SfnSf
+TestMiniSlotMac::GetSfnSf(uint32_t slot)
+{
+    // Numerology 0: one slot per subframe
+    return SfnSf(slot / 10, slot % 10, 0, 0);
+}
+
+void
+TestMiniSlotMac::Configure()
+{
+    NrMacCschedSapProvider::CschedCellConfigReqParameters cellConfig;
+    cellConfig.m_ulBandwidth = NUM_RB;
+    cellConfig.m_dlBandwidth = NUM_RB;
+    m_cschedSap->CschedCellConfigReq(cellConfig);
+
+    for (uint16_t rnti = 1; rnti <= m_numUes; ++rnti)
+    {
+        NrMacCschedSapProvider::CschedUeConfigReqParameters ueConfig;
+        ueConfig.m_rnti = rnti;
+        ueConfig.m_beamConfId = BeamConfId(BeamId(rnti % 2, 90.0), BeamId::GetEmptyBeamId());
+        ueConfig.m_transmissionMode = 0;
+        m_cschedSap->CschedUeConfigReq(ueConfig);
+
+        NrMacCschedSapProvider::CschedLcConfigReqParameters lcConfig;
+        lcConfig.m_rnti = rnti;
+        lcConfig.m_reconfigureFlag = false;
+        LogicalChannelConfigListElement_s lc;
+        lc.m_logicalChannelIdentity = 1;
+        lc.m_logicalChannelGroup = 1;
+        lc.m_direction = LogicalChannelConfigListElement_s::DIR_BOTH;
+        lc.m_qosBearerType = LogicalChannelConfigListElement_s::QBT_NON_GBR;
+        lc.m_qci = 9;
+        lc.m_eRabMaximulBitrateUl = 0;
+        lc.m_eRabMaximulBitrateDl = 0;
+        lc.m_eRabGuaranteedBitrateUl = 0;
+        lc.m_eRabGuaranteedBitrateDl = 0;
+        if (rnti <= NUM_GBR_UES)
+        {
+            lc.m_qosBearerType = LogicalChannelConfigListElement_s::QBT_DGBR;
+            lc.m_qci = EpsBearer::DGBR_DISCRETE_AUT_SMALL;
+            lc.m_eRabGuaranteedBitrateDl = 100000;
+        }
+        lcConfig.m_logicalChannelConfigList.emplace_back(lc);
+        m_cschedSap->CschedLcConfigReq(lcConfig);
+    }
+}
+
+const NrMacSchedulerReplay::Report&
+TestMiniSlotMac::GetReport() const
+{
+    return m_report;
+}
+
+void
+TestMiniSlotMac::Slot(uint32_t slot)
+{
+    m_slot = slot;
+
+    for (uint16_t rnti = 1; rnti <= m_numUes; ++rnti)
+    {
+        if ((slot + rnti) % 5 == 0)
+        {
+            NrMacSchedSapProvider::SchedDlRlcBufferReqParameters rlc;
+            rlc.m_rnti = rnti;
+            rlc.m_logicalChannelIdentity = 1;
+            rlc.m_rlcTransmissionQueueSize = 500 * rnti;
+            rlc.m_rlcTransmissionQueueHolDelay = 0;
+            rlc.m_rlcRetransmissionQueueSize = 0;
+            rlc.m_rlcRetransmissionHolDelay = 0;
+            rlc.m_rlcStatusPduSize = 0;
+            m_schedSap->SchedDlRlcBufferReq(rlc);
+        }
+    }
+
+    if (slot % 10 == 1)
+    {
+        NrMacSchedSapProvider::SchedDlCqiInfoReqParameters dlCqi;
+        dlCqi.m_sfnsf = GetSfnSf(slot);
+        NrMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters bsr;
+        bsr.m_sfnSf = GetSfnSf(slot);
+        for (uint16_t rnti = 1; rnti <= m_numUes; ++rnti)
+        {
+            DlCqiInfo cqi;
+            cqi.m_rnti = rnti;
+            cqi.m_ri = 1;
+            cqi.m_cqiType = DlCqiInfo::WB;
+            cqi.m_wbCqi = {static_cast<uint8_t>(3 + (rnti + slot / 10) % 12)};
+            dlCqi.m_cqiList.push_back(cqi);
+
+            MacCeElement ce;
+            ce.m_rnti = rnti;
+            ce.m_macCeType = MacCeElement::BSR;
+            ce.m_macCeValue.m_bufferStatus = {0, static_cast<uint8_t>(10 + rnti % 10), 0, 0};
+            bsr.m_macCeList.push_back(ce);
+        }
+        m_schedSap->SchedDlCqiInfoReq(dlCqi);
+        m_schedSap->SchedUlMacCtrlInfoReq(bsr);
+    }
+
+    if (slot == 3)
+    {
+        NrMacSchedSapProvider::SchedUlSrInfoReqParameters sr;
+        sr.m_snfSf = GetSfnSf(slot);
+        for (uint16_t rnti = 1; rnti <= m_numUes; rnti += 2)
+        {
+            sr.m_srList.push_back(rnti);
+        }
+        m_schedSap->SchedUlSrInfoReq(sr);
+    }
+
+    for (const auto& ulCqi : m_ulCqi[slot])
+    {
+        m_schedSap->SchedUlCqiInfoReq(ulCqi);
+    }
+    m_ulCqi.erase(slot);
+
+    // UL is scheduled two slots in advance, as the MAC does with K2
+    NrMacSchedSapProvider::SchedUlTriggerReqParameters ulTrigger;
+    ulTrigger.m_snfSf = GetSfnSf(slot + 2);
+    ulTrigger.m_ulHarqInfoList = std::move(m_ulFeedback[slot]);
+    ulTrigger.m_slotType = LteNrTddSlotType::F;
+    m_ulFeedback.erase(slot);
+    m_schedSap->SchedUlTriggerReq(ulTrigger);
+
+    NrMacSchedSapProvider::SchedDlTriggerReqParameters dlTrigger;
+    dlTrigger.m_snfSf = GetSfnSf(slot);
+    dlTrigger.m_dlHarqInfoList = std::move(m_dlFeedback);
+    dlTrigger.m_slotType = LteNrTddSlotType::F;
+    m_dlFeedback.clear();
+    m_schedSap->SchedDlTriggerReq(dlTrigger);
+
+    // After the triggers of the slot
+    Simulator::Schedule(MicroSeconds(500), &TestMiniSlotMac::MiniSlot, this, slot);
+}
+
+void
+TestMiniSlotMac::MiniSlot(uint32_t slot)
+{
+    // Every fourth slot, the delay-critical queues are empty; otherwise, the
+    // UE with the highest head of line delay changes every slot
+    const bool gbrData = slot % 4 != 0;
+    uint16_t expectedRnti = 0;
+    uint16_t maxHolDelay = 0;
+    for (uint16_t rnti = 1; rnti <= m_numUes; ++rnti)
+    {
+        NrMacSchedSapProvider::SchedDlRlcBufferReqParameters rlc;
+        rlc.m_rnti = rnti;
+        rlc.m_logicalChannelIdentity = 1;
+        rlc.m_rlcRetransmissionQueueSize = 0;
+        rlc.m_rlcRetransmissionHolDelay = 0;
+        rlc.m_rlcStatusPduSize = 0;
+        if (rnti <= NUM_GBR_UES)
+        {
+            rlc.m_rlcTransmissionQueueSize = gbrData ? 100 : 0;
+            rlc.m_rlcTransmissionQueueHolDelay = gbrData ? 10 + ((rnti + slot) % 3) * 5 : 0;
+            if (gbrData && rlc.m_rlcTransmissionQueueHolDelay > maxHolDelay)
+            {
+                expectedRnti = rnti;
+                maxHolDelay = rlc.m_rlcTransmissionQueueHolDelay;
+            }
+        }
+        else
+        {
+            // Older, but not delay-critical
+            rlc.m_rlcTransmissionQueueSize = 5000;
+            rlc.m_rlcTransmissionQueueHolDelay = 100;
+        }
+        m_schedSap->SchedDlRlcBufferReq(rlc);
+    }
+
+    NrMacSchedSapProvider::SchedDlMiniSlotReqParameters params;
+    params.m_snfSf = GetSfnSf(slot);
+    params.m_symStart = MINI_SLOT_SYM_START;
+    params.m_numSym = MINI_SLOT_NUM_SYM;
+    m_miniSlotDcis.clear();
+    m_schedSap->SchedDlMiniSlotReq(params);
+    m_test->CheckMiniSlot(params, expectedRnti, m_miniSlotDcis);
+}
+
+void
+TestMiniSlotMac::SchedConfigInd(SchedConfigIndParameters params)
+{
+    NrMacSchedulerReplay::AddSlot(&m_report, params.m_slotAllocInfo);
+
+    std::set<uint8_t> ulCqiSymStart;
+    for (const auto& varTti : params.m_slotAllocInfo.m_varTtiAllocInfo)
+    {
+        const auto& dci = varTti.m_dci;
+        if (dci->m_miniSlot)
+        {
+            m_miniSlotDcis.push_back(dci);
+        }
+        if (dci->m_type != DciInfoElementTdma::DATA)
+        {
+            continue;
+        }
+        if (dci->m_format == DciInfoElementTdma::DL)
+        {
+            DlHarqInfo harq;
+            harq.m_rnti = dci->m_rnti;
+            harq.m_harqProcessId = dci->m_harqProcess;
+            harq.m_bwpIndex = 0;
+            for (const auto& tbs : dci->m_tbSize)
+            {
+                harq.m_harqStatus.push_back(tbs > 0 ? DlHarqInfo::ACK : DlHarqInfo::NONE);
+            }
+            harq.m_numRetx = dci->m_rv;
+            m_dlFeedback.push_back(harq);
+        }
+        else
+        {
+            // The UL slot is two slots in the future: the feedback comes after it
+            UlHarqInfo harq;
+            harq.m_rnti = dci->m_rnti;
+            harq.m_harqProcessId = dci->m_harqProcess;
+            harq.m_bwpIndex = 0;
+            harq.m_receptionStatus = UlHarqInfo::Ok;
+            harq.m_tpc = 1;
+            harq.m_numRetx = 0;
+            m_ulFeedback[m_slot + 3].push_back(harq);
+
+            if (ulCqiSymStart.insert(dci->m_symStart).second)
+            {
+                NrMacSchedSapProvider::SchedUlCqiInfoReqParameters ulCqi;
+                ulCqi.m_sfnSf = params.m_sfnSf;
+                ulCqi.m_symStart = dci->m_symStart;
+                ulCqi.m_ulCqi.m_type = UlCqiInfo::PUSCH;
+                ulCqi.m_ulCqi.m_sinr = std::vector<double>(NUM_RB, 5.0 + dci->m_rnti);
+                m_ulCqi[m_slot + 3].push_back(ulCqi);
+            }
+        }
+    }
+}
+
+Ptr<const SpectrumModel>
+TestMiniSlotMac::GetSpectrumModel() const
+{
+    return m_spectrumModel;
+}
+
+uint32_t
+TestMiniSlotMac::GetNumRbPerRbg() const
+{
+    return 1;
+}
+
+uint8_t
+TestMiniSlotMac::GetNumHarqProcess() const
+{
+    return 16;
+}
+
+uint16_t
+TestMiniSlotMac::GetBwpId() const
+{
+    return 0;
+}
+
+uint16_t
+TestMiniSlotMac::GetCellId() const
+{
+    return 1;
+}
+
+uint32_t
+TestMiniSlotMac::GetSymbolsPerSlot() const
+{
+    return 14;
+}
+
+Time
+TestMiniSlotMac::GetSlotPeriod() const
+{
+    return MilliSeconds(1);
+}
+
+void
+TestMiniSlotMac::CschedCellConfigCnf(const CschedCellConfigCnfParameters& params)
+{
+}
+
+void
+TestMiniSlotMac::CschedUeConfigCnf(const CschedUeConfigCnfParameters& params)
+{
+}
+
+void
+TestMiniSlotMac::CschedLcConfigCnf(const CschedLcConfigCnfParameters& params)
+{
+}
+
+void
+TestMiniSlotMac::CschedLcReleaseCnf(const CschedLcReleaseCnfParameters& params)
+{
+}
+
+void
+TestMiniSlotMac::CschedUeReleaseCnf(const CschedUeReleaseCnfParameters& params)
+{
+}
+
+void
+TestMiniSlotMac::CschedUeConfigUpdateInd(const CschedUeConfigUpdateIndParameters& params)
+{
+}
+
+void
+TestMiniSlotMac::CschedCellConfigUpdateInd(const CschedCellConfigUpdateIndParameters& params)
+{
+}
+
+void
+TestSchedulerMiniSlot::CheckMiniSlot(
+    const NrMacSchedSapProvider::SchedDlMiniSlotReqParameters& params,
+    uint16_t expectedRnti,
+    const std::vector<std::shared_ptr<DciInfoElementTdma>>& dcis)
+{
+    if (expectedRnti == 0)
+    {
+        NS_TEST_ASSERT_MSG_EQ(dcis.size(), 0, "Mini-slot used without delay-critical data");
+        ++m_numUnused;
+        return;
+    }
+
+    NS_TEST_ASSERT_MSG_EQ(dcis.size(), 1, "The mini-slot has not one DCI at " << params.m_snfSf);
+    const auto& dci = dcis.front();
+    NS_TEST_ASSERT_MSG_EQ(dci->m_rnti,
+                          expectedRnti,
+                          "The mini-slot is not for the highest head of line delay");
+    NS_TEST_ASSERT_MSG_EQ(dci->m_format, DciInfoElementTdma::DL, "Not a DL DCI");
+    NS_TEST_ASSERT_MSG_EQ(dci->m_type, DciInfoElementTdma::DATA, "Not a DATA DCI");
+    NS_TEST_ASSERT_MSG_EQ(+dci->m_symStart,
+                          params.m_symStart + 1,
+                          "The data must follow the symbol of the DCI");
+    NS_TEST_ASSERT_MSG_EQ(+dci->m_numSym,
+                          params.m_numSym - 1,
+                          "The data must fill the mini-slot");
+    NS_TEST_ASSERT_MSG_EQ(dci->m_rbgBitmask.size(), m_numRb, "Wrong bitmask size");
+    NS_TEST_ASSERT_MSG_EQ(static_cast<uint32_t>(std::count(dci->m_rbgBitmask.begin(),
+                                                           dci->m_rbgBitmask.end(),
+                                                           1)),
+                          m_numRb,
+                          "The mini-slot must use the entire band");
+    NS_TEST_ASSERT_MSG_GT(dci->m_tbSize.at(0), 0, "Empty TB");
+    NS_TEST_ASSERT_MSG_EQ(+dci->m_ndi.at(0), 1, "The mini-slot carries new data");
+    ++m_numMiniSlots;
+}
+
+Ptr<NrMacSchedulerNs3>
+TestSchedulerMiniSlot::CreateScheduler(const std::string& type)
+{
+    ObjectFactory factory;
+    factory.SetTypeId(type);
+    factory.Set("EnableSrsInFSlots", BooleanValue(false));
+    auto sched = factory.Create<NrMacSchedulerNs3>();
+    sched->InstallDlAmc(CreateObject<NrAmc>());
+    sched->InstallUlAmc(CreateObject<NrAmc>());
+    return sched;
+}
+
+void
+TestSchedulerMiniSlot::DoRun()
+{
+    const std::string filename = CreateTempDirFilename("nr-test-scheduler-mini-slot.bin");
+    const uint16_t numUes = TestMiniSlotMac::NUM_GBR_UES + 1;
+    const uint32_t numSlots = 100;
+
+    auto sched = CreateScheduler(m_type);
+    Ptr<NrMacSchedulerRecorder> recorder;
+    std::unique_ptr<TestMiniSlotMac> mac;
+    if (m_record)
+    {
+        recorder = CreateObject<NrMacSchedulerRecorder>();
+        mac = std::make_unique<TestMiniSlotMac>(recorder->GetMacSchedSapProvider(),
+                                                recorder->GetMacCschedSapProvider(),
+                                                this);
+        recorder->Open(filename);
+        recorder->SetMacSchedSapProvider(sched->GetMacSchedSapProvider());
+        recorder->SetMacCschedSapProvider(sched->GetMacCschedSapProvider());
+        recorder->SetMacSchedSapUser(mac.get());
+    }
+    else
+    {
+        mac = std::make_unique<TestMiniSlotMac>(sched->GetMacSchedSapProvider(),
+                                                sched->GetMacCschedSapProvider(),
+                                                this);
+    }
+    sched->SetMacSchedSapUser(mac.get());
+    sched->SetMacCschedSapUser(mac.get());
+
+    mac->Start(numUes, numSlots);
+    Simulator::Run();
+    Simulator::Destroy();
+
+    NS_TEST_ASSERT_MSG_GT(m_numMiniSlots, 0, "No mini-slot was used");
+    NS_TEST_ASSERT_MSG_GT(m_numUnused, 0, "No mini-slot was offered without data");
+
+    if (!m_record)
+    {
+        sched->Dispose();
+        return;
+    }
+
+    const uint64_t numRecords = recorder->GetNumRecords();
+    recorder->Dispose();
+    const NrMacSchedulerReplay::Report& recorded = mac->GetReport();
+
+    NrMacSchedulerReplay replay(filename);
+    NrMacSchedulerReplay::Report replayed = replay.Run(CreateScheduler(m_type));
+    Simulator::Destroy();
+
+    NS_TEST_ASSERT_MSG_EQ(replayed.m_numRecords, numRecords, "Wrong number of records");
+    NS_TEST_ASSERT_MSG_EQ(replayed.m_numDroppedFeedback, 0, "Feedback dropped");
+    NS_TEST_ASSERT_MSG_EQ(replayed.m_numDlDci, recorded.m_numDlDci, "Different DL DCIs");
+    NS_TEST_ASSERT_MSG_EQ(replayed.m_dlBytes, recorded.m_dlBytes, "Different DL bytes");
+    NS_TEST_ASSERT_MSG_EQ(replayed.m_digest, recorded.m_digest, "Different decisions");
+    sched->Dispose();
+}
+
+class TestSchedulerMiniSlotSuite : public TestSuite
+{
+  public:
+    TestSchedulerMiniSlotSuite()
+        : TestSuite("nr-test-scheduler-mini-slot", UNIT)
+    {
+        for (const std::string type : {"ns3::NrMacSchedulerTdmaRR", "ns3::NrMacSchedulerOfdmaPF"})
+        {
+            AddTestCase(new TestSchedulerMiniSlot(type, false), QUICK);
+        }
+        AddTestCase(new TestSchedulerMiniSlot("ns3::NrMacSchedulerTdmaRR", true), QUICK);
+    }
+};
+
+static TestSchedulerMiniSlotSuite testSchedulerMiniSlotSuite; //!< Mini-slot test suite
+
+} // namespace ns3
@@ -0,0 +1,456 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include <ns3/boolean.h>
+#include <ns3/double.h>
+#include <ns3/nr-amc.h>
+#include <ns3/nr-mac-scheduler-ns3.h>
+#include <ns3/object-factory.h>
+#include <ns3/simulator.h>
+#include <ns3/test.h>
+#include <ns3/uinteger.h>
+
+#include <map>
+#include <set>
+
+/**
+ * \file nr-test-scheduler-mu-mimo.cc
+ * \ingroup test
+ *
+ * \brief Unit-testing for the MU-MIMO co-scheduling of the OFDMA schedulers
+ * (attribute EnableMuMimo). The UEs are spread on beams of different sectors;
+ * a fake MAC keeps their DL buffers full, and checks the DCIs of each slot:
+ * without MU-MIMO, each beam has its own symbols; with MU-MIMO, the beams that
+ * are far enough share the symbols and the RBG, each one as a layer, and the
+ * close beams do not.
+ */
+namespace ns3
+{
+
+/**
+ * \brief A fake MAC, which keeps the DL buffers of the UEs full, acknowledges
+ * every DCI, and checks how the beams share the symbols
+ */
+class TestMuMimoMac : public NrMacSchedSapUser, public NrMacCschedSapUser
+{
+  public:
+    TestMuMimoMac(const Ptr<NrMacSchedulerNs3>& sched, const std::vector<uint16_t>& sectors);
+
+    void Start(uint16_t numUes, uint32_t numSlots);
+    uint64_t GetDlBytes() const;
+    uint32_t GetMaxLayers() const;
+    uint32_t GetMaxBeamsPerSymbol() const;
+    uint32_t GetMinSectorDistance() const;
+    uint32_t GetOverlappingLayers() const;
+
+    // inherited from NrMacSchedSapUser
+    void SchedConfigInd(SchedConfigIndParameters params) override;
+    Ptr<const SpectrumModel> GetSpectrumModel() const override;
+    uint32_t GetNumRbPerRbg() const override;
+    uint8_t GetNumHarqProcess() const override;
+    uint16_t GetBwpId() const override;
+    uint16_t GetCellId() const override;
+    uint32_t GetSymbolsPerSlot() const override;
+    Time GetSlotPeriod() const override;
+
+    // inherited from NrMacCschedSapUser
+    void CschedCellConfigCnf(const CschedCellConfigCnfParameters& params) override;
+    void CschedUeConfigCnf(const CschedUeConfigCnfParameters& params) override;
+    void CschedLcConfigCnf(const CschedLcConfigCnfParameters& params) override;
+    void CschedLcReleaseCnf(const CschedLcReleaseCnfParameters& params) override;
+    void CschedUeReleaseCnf(const CschedUeReleaseCnfParameters& params) override;
+    void CschedUeConfigUpdateInd(const CschedUeConfigUpdateIndParameters& params) override;
+    void CschedCellConfigUpdateInd(const CschedCellConfigUpdateIndParameters& params) override;
+
+  private:
+    void Configure();
+    void Slot(uint32_t slot);
+    static SfnSf GetSfnSf(uint32_t slot);
+    uint16_t GetSector(uint16_t rnti) const;
+
+    static constexpr uint32_t NUM_RB = 52; //!< RBs of the bandwidth, one per RBG
+
+    Ptr<NrMacSchedulerNs3> m_sched;
+    Ptr<const SpectrumModel> m_spectrumModel;
+    std::vector<uint16_t> m_sectors; //!< Sectors of the beams, assigned in turn to the UEs
+    uint16_t m_numUes{0};
+    uint64_t m_dlBytes{0};
+    uint32_t m_maxLayers{0};              //!< Maximum number of layers of a symbol
+    uint32_t m_maxBeamsPerSymbol{0};      //!< Maximum number of beams of a symbol
+    uint32_t m_minSectorDistance{65535};  //!< Minimum distance between beams of a symbol
+    uint32_t m_overlappingLayers{0};      //!< Symbols in which layers share RBG
+    std::vector<DlHarqInfo> m_dlFeedback; //!< For the next DL trigger
+};
+
+TestMuMimoMac::TestMuMimoMac(const Ptr<NrMacSchedulerNs3>& sched,
+                             const std::vector<uint16_t>& sectors)
+    : m_sched(sched),
+      m_sectors(sectors)
+{
+    std::vector<double> centerFrequencies;
+    for (uint32_t rb = 0; rb < NUM_RB; ++rb)
+    {
+        centerFrequencies.push_back(28e9 + rb * 180e3);
+    }
+    m_spectrumModel = Create<SpectrumModel>(centerFrequencies);
+    m_sched->SetMacSchedSapUser(this);
+    m_sched->SetMacCschedSapUser(this);
+}
+
+void
+TestMuMimoMac::Start(uint16_t numUes, uint32_t numSlots)
+{
+    m_numUes = numUes;
+    Simulator::Schedule(Seconds(0), &TestMuMimoMac::Configure, this);
+    for (uint32_t slot = 1; slot <= numSlots; ++slot)
+    {
+        Simulator::Schedule(MilliSeconds(slot), &TestMuMimoMac::Slot, this, slot);
+    }
+}
+
+uint64_t
+TestMuMimoMac::GetDlBytes() const
+{
+    return m_dlBytes;
+}
+
+uint32_t
+TestMuMimoMac::GetMaxLayers() const
+{
+    return m_maxLayers;
+}
+
+uint32_t
+TestMuMimoMac::GetMaxBeamsPerSymbol() const
+{
+    return m_maxBeamsPerSymbol;
+}
+
+uint32_t
+TestMuMimoMac::GetMinSectorDistance() const
+{
+    return m_minSectorDistance;
+}
+
+uint32_t
+TestMuMimoMac::GetOverlappingLayers() const
+{
+    return m_overlappingLayers;
+}
+
+SfnSf
+TestMuMimoMac::GetSfnSf(uint32_t slot)
+{
+    // Numerology 0: one slot per subframe
+    return SfnSf(slot / 10, slot % 10, 0, 0);
+}
+
+uint16_t
+TestMuMimoMac::GetSector(uint16_t rnti) const
+{
+    return m_sectors.at((rnti - 1) % m_sectors.size());
+}
+
+void
+TestMuMimoMac::Configure()
+{
+    NrMacCschedSapProvider* csched = m_sched->GetMacCschedSapProvider();
+
+    NrMacCschedSapProvider::CschedCellConfigReqParameters cellConfig;
+    cellConfig.m_ulBandwidth = NUM_RB;
+    cellConfig.m_dlBandwidth = NUM_RB;
+    csched->CschedCellConfigReq(cellConfig);
+
+    for (uint16_t rnti = 1; rnti <= m_numUes; ++rnti)
+    {
+        NrMacCschedSapProvider::CschedUeConfigReqParameters ueConfig;
+        ueConfig.m_rnti = rnti;
+        ueConfig.m_beamConfId =
+            BeamConfId(BeamId(GetSector(rnti), 90.0), BeamId::GetEmptyBeamId());
+        ueConfig.m_transmissionMode = 0;
+        csched->CschedUeConfigReq(ueConfig);
+
+        NrMacCschedSapProvider::CschedLcConfigReqParameters lcConfig;
+        lcConfig.m_rnti = rnti;
+        lcConfig.m_reconfigureFlag = false;
+        LogicalChannelConfigListElement_s lc;
+        lc.m_logicalChannelIdentity = 1;
+        lc.m_logicalChannelGroup = 1;
+        lc.m_direction = LogicalChannelConfigListElement_s::DIR_BOTH;
+        lc.m_qosBearerType = LogicalChannelConfigListElement_s::QBT_NON_GBR;
+        lc.m_qci = 9;
+        lc.m_eRabMaximulBitrateUl = 0;
+        lc.m_eRabMaximulBitrateDl = 0;
+        lc.m_eRabGuaranteedBitrateUl = 0;
+        lc.m_eRabGuaranteedBitrateDl = 0;
+        lcConfig.m_logicalChannelConfigList.emplace_back(lc);
+        csched->CschedLcConfigReq(lcConfig);
+    }
+}
+
+void
+TestMuMimoMac::Slot(uint32_t slot)
+{
+    NrMacSchedSapProvider* sched = m_sched->GetMacSchedSapProvider();
+
+    if (slot % 10 == 1)
+    {
+        for (uint16_t rnti = 1; rnti <= m_numUes; ++rnti)
+        {
+            NrMacSchedSapProvider::SchedDlRlcBufferReqParameters rlc;
+            rlc.m_rnti = rnti;
+            rlc.m_logicalChannelIdentity = 1;
+            rlc.m_rlcTransmissionQueueSize = 1000000;
+            rlc.m_rlcTransmissionQueueHolDelay = 0;
+            rlc.m_rlcRetransmissionQueueSize = 0;
+            rlc.m_rlcRetransmissionHolDelay = 0;
+            rlc.m_rlcStatusPduSize = 0;
+            sched->SchedDlRlcBufferReq(rlc);
+        }
+    }
+
+    NrMacSchedSapProvider::SchedUlTriggerReqParameters ulTrigger;
+    ulTrigger.m_snfSf = GetSfnSf(slot + 2);
+    ulTrigger.m_slotType = LteNrTddSlotType::F;
+    sched->SchedUlTriggerReq(ulTrigger);
+
+    NrMacSchedSapProvider::SchedDlTriggerReqParameters dlTrigger;
+    dlTrigger.m_snfSf = GetSfnSf(slot);
+    dlTrigger.m_dlHarqInfoList = std::move(m_dlFeedback);
+    dlTrigger.m_slotType = LteNrTddSlotType::F;
+    m_dlFeedback.clear();
+    sched->SchedDlTriggerReq(dlTrigger);
+}
+
+void
+TestMuMimoMac::SchedConfigInd(SchedConfigIndParameters params)
+{
+    // DL DCIs of each symbol, by layer
+    std::map<uint8_t, std::map<uint8_t, std::vector<std::shared_ptr<DciInfoElementTdma>>>>
+        dcis;
+    for (const auto& varTti : params.m_slotAllocInfo.m_varTtiAllocInfo)
+    {
+        const auto& dci = varTti.m_dci;
+        if (dci->m_type != DciInfoElementTdma::DATA || dci->m_format != DciInfoElementTdma::DL)
+        {
+            continue;
+        }
+        dcis[dci->m_symStart][dci->m_layer].push_back(dci);
+
+        DlHarqInfo harq;
+        harq.m_rnti = dci->m_rnti;
+        harq.m_harqProcessId = dci->m_harqProcess;
+        harq.m_bwpIndex = 0;
+        for (const auto& tbs : dci->m_tbSize)
+        {
+            m_dlBytes += tbs;
+            harq.m_harqStatus.push_back(tbs > 0 ? DlHarqInfo::ACK : DlHarqInfo::NONE);
+        }
+        harq.m_numRetx = dci->m_rv;
+        m_dlFeedback.push_back(harq);
+    }
+
+    for (const auto& symbol : dcis)
+    {
+        std::set<uint16_t> sectors;
+        std::vector<uint8_t> usedRbg(NUM_RB, 0);
+        bool overlapping = false;
+        for (const auto& layer : symbol.second)
+        {
+            std::vector<uint8_t> layerRbg(NUM_RB, 0);
+            for (const auto& dci : layer.second)
+            {
+                sectors.insert(GetSector(dci->m_rnti));
+                for (std::size_t rbg = 0; rbg < dci->m_rbgBitmask.size(); ++rbg)
+                {
+                    layerRbg.at(rbg) |= dci->m_rbgBitmask.at(rbg);
+                }
+            }
+            for (std::size_t rbg = 0; rbg < NUM_RB; ++rbg)
+            {
+                overlapping |= layerRbg.at(rbg) && usedRbg.at(rbg);
+                usedRbg.at(rbg) |= layerRbg.at(rbg);
+            }
+        }
+        m_maxLayers = std::max(m_maxLayers, static_cast<uint32_t>(symbol.second.size()));
+        m_maxBeamsPerSymbol = std::max(m_maxBeamsPerSymbol, static_cast<uint32_t>(sectors.size()));
+        if (sectors.size() > 1)
+        {
+            for (auto it = std::next(sectors.begin()); it != sectors.end(); ++it)
+            {
+                m_minSectorDistance =
+                    std::min(m_minSectorDistance, static_cast<uint32_t>(*it - *std::prev(it)));
+            }
+        }
+        m_overlappingLayers += overlapping ? 1 : 0;
+    }
+}
+
+Ptr<const SpectrumModel>
+TestMuMimoMac::GetSpectrumModel() const
+{
+    return m_spectrumModel;
+}
+
+uint32_t
+TestMuMimoMac::GetNumRbPerRbg() const
+{
+    return 1;
+}
+
+uint8_t
+TestMuMimoMac::GetNumHarqProcess() const
+{
+    return 16;
+}
+
+uint16_t
+TestMuMimoMac::GetBwpId() const
+{
+    return 0;
+}
+
+uint16_t
+TestMuMimoMac::GetCellId() const
+{
+    return 1;
+}
+
+uint32_t
+TestMuMimoMac::GetSymbolsPerSlot() const
+{
+    return 14;
+}
+
+Time
+TestMuMimoMac::GetSlotPeriod() const
+{
+    return MilliSeconds(1);
+}
+
+void
+TestMuMimoMac::CschedCellConfigCnf(const CschedCellConfigCnfParameters& params)
+{
+}
+
+void
+TestMuMimoMac::CschedUeConfigCnf(const CschedUeConfigCnfParameters& params)
+{
+}
+
+void
+TestMuMimoMac::CschedLcConfigCnf(const CschedLcConfigCnfParameters& params)
+{
+}
+
+void
+TestMuMimoMac::CschedLcReleaseCnf(const CschedLcReleaseCnfParameters& params)
+{
+}
+
+void
+TestMuMimoMac::CschedUeReleaseCnf(const CschedUeReleaseCnfParameters& params)
+{
+}
+
+void
+TestMuMimoMac::CschedUeConfigUpdateInd(const CschedUeConfigUpdateIndParameters& params)
+{
+}
+
+void
+TestMuMimoMac::CschedCellConfigUpdateInd(const CschedCellConfigUpdateIndParameters& params)
+{
+}
+
+class TestSchedulerMuMimo : public TestCase
+{
+  public:
+    TestSchedulerMuMimo(const std::string& type,
+                        const std::vector<uint16_t>& sectors,
+                        bool muMimo,
+                        uint32_t expectedLayers)
+        : TestCase("Scheduler " + type + " with " + std::to_string(sectors.size()) +
+                   " beams and" + (muMimo ? "" : " without") + " MU-MIMO schedules " +
+                   std::to_string(expectedLayers) + " layers"),
+          m_type(type),
+          m_sectors(sectors),
+          m_muMimo(muMimo),
+          m_expectedLayers(expectedLayers)
+    {
+    }
+
+  private:
+    void DoRun() override;
+
+    std::string m_type;
+    std::vector<uint16_t> m_sectors;
+    bool m_muMimo;
+    uint32_t m_expectedLayers;
+};
+
+void
+TestSchedulerMuMimo::DoRun()
+{
+    ObjectFactory factory;
+    factory.SetTypeId(m_type);
+    factory.Set("EnableSrsInFSlots", BooleanValue(false));
+    factory.Set("FixedMcsDl", BooleanValue(true));
+    factory.Set("StartingMcsDl", UintegerValue(10));
+    factory.Set("EnableMuMimo", BooleanValue(m_muMimo));
+    factory.Set("MuMimoMaxLayers", UintegerValue(2));
+    factory.Set("MuMimoMinSectorSeparation", UintegerValue(4));
+    factory.Set("MuMimoMinElevationSeparation", DoubleValue(180.0));
+    auto sched = factory.Create<NrMacSchedulerNs3>();
+    sched->InstallDlAmc(CreateObject<NrAmc>());
+    sched->InstallUlAmc(CreateObject<NrAmc>());
+
+    TestMuMimoMac mac(sched, m_sectors);
+    mac.Start(4 * m_sectors.size(), 20);
+    Simulator::Run();
+    Simulator::Destroy();
+
+    NS_TEST_ASSERT_MSG_GT(mac.GetDlBytes(), 0, "The scheduler did not schedule DL data");
+    NS_TEST_ASSERT_MSG_EQ(mac.GetMaxLayers(), m_expectedLayers, "Unexpected number of layers");
+    NS_TEST_ASSERT_MSG_EQ(mac.GetMaxBeamsPerSymbol(),
+                          m_expectedLayers,
+                          "Each layer should have exactly one beam");
+    if (m_expectedLayers > 1)
+    {
+        NS_TEST_ASSERT_MSG_GT(mac.GetOverlappingLayers(), 0, "The layers should share RBG");
+        NS_TEST_ASSERT_MSG_GT_OR_EQ(mac.GetMinSectorDistance(),
+                                    4,
+                                    "Co-scheduled beams should be separated");
+    }
+    else
+    {
+        NS_TEST_ASSERT_MSG_EQ(mac.GetOverlappingLayers(), 0, "RBG used twice in a symbol");
+    }
+
+    sched->Dispose();
+}
+
+class TestSchedulerMuMimoSuite : public TestSuite
+{
+  public:
+    TestSchedulerMuMimoSuite()
+        : TestSuite("nr-test-scheduler-mu-mimo", UNIT)
+    {
+        const std::vector<uint16_t> farBeams = {0, 4, 8, 12};
+        const std::vector<uint16_t> closeBeams = {0, 1, 2, 3};
+        for (const std::string policy : {"RR", "PF"})
+        {
+            const std::string type = "ns3::NrMacSchedulerOfdma" + policy;
+            AddTestCase(new TestSchedulerMuMimo(type, farBeams, false, 1), QUICK);
+            AddTestCase(new TestSchedulerMuMimo(type, farBeams, true, 2), QUICK);
+            AddTestCase(new TestSchedulerMuMimo(type, closeBeams, true, 1), QUICK);
+        }
+    }
+};
+
+static TestSchedulerMuMimoSuite testSchedulerMuMimoSuite; //!< MU-MIMO scheduler test suite
+
+} // namespace ns3
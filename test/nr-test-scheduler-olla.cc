@@ -0,0 +1,146 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include <ns3/nr-mac-scheduler-olla.h>
+#include <ns3/test.h>
+#include <ns3/uniform-random-variable.h>
+
+#include <cmath>
+
+/**
+ * \file nr-test-scheduler-olla.cc
+ * \ingroup test
+ *
+ * \brief Unit-testing for the outer-loop link adaptation (OLLA) of the
+ * scheduler. The first test checks the steps and the bounds of the offset,
+ * and the MCS returned by NrMacSchedulerOlla::Adjust. The second test feeds
+ * the OLLA with the outcome of transmissions over a link that is worse than
+ * what the CQI reports: the error probability grows with the MCS, and it is
+ * 50% at an MCS lower than the one of the CQI. After the convergence, the
+ * ratio of NACK must be close to the target BLER.
+ */
+namespace ns3
+{
+
+class TestSchedulerOllaSteps : public TestCase
+{
+  public:
+    TestSchedulerOllaSteps()
+        : TestCase("OLLA steps and bounds")
+    {
+    }
+
+  private:
+    void DoRun() override;
+};
+
+void
+TestSchedulerOllaSteps::DoRun()
+{
+    NrMacSchedulerOlla::Config config;
+    config.m_enabled = true;
+    config.m_targetBler = 0.2;
+    config.m_step = 1.0;
+    config.m_minOffset = -3.0;
+    config.m_maxOffset = 1.0;
+
+    NrMacSchedulerOlla olla;
+    olla.SetMaxMcs(28);
+    NS_TEST_ASSERT_MSG_EQ(+olla.Adjust(28), 28, "Without feedback, the MCS must not change");
+    NS_TEST_ASSERT_MSG_EQ(olla.GetBler(), 0.0, "Without feedback, the BLER must be 0");
+
+    olla.Feedback(false, config);
+    NS_TEST_ASSERT_MSG_EQ_TOL(olla.GetOffset(), -1.0, 1e-9, "A NACK must decrease by a step");
+    olla.Feedback(true, config);
+    NS_TEST_ASSERT_MSG_EQ_TOL(olla.GetOffset(),
+                              -0.75,
+                              1e-9,
+                              "An ACK must increase by step * BLER / (1 - BLER)");
+    NS_TEST_ASSERT_MSG_EQ(+olla.Adjust(10), 9, "Wrong rounding of the offset");
+    NS_TEST_ASSERT_MSG_EQ_TOL(olla.GetBler(), 0.5, 1e-9, "Wrong BLER");
+
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        olla.Feedback(false, config);
+    }
+    NS_TEST_ASSERT_MSG_EQ_TOL(olla.GetOffset(), -3.0, 1e-9, "The offset must not go below min");
+    NS_TEST_ASSERT_MSG_EQ(+olla.Adjust(2), 0, "The MCS must not go below 0");
+
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        olla.Feedback(true, config);
+    }
+    NS_TEST_ASSERT_MSG_EQ_TOL(olla.GetOffset(), 1.0, 1e-9, "The offset must not go above max");
+    NS_TEST_ASSERT_MSG_EQ(+olla.Adjust(28), 28, "The MCS must not go above the maximum MCS");
+    NS_TEST_ASSERT_MSG_EQ(+olla.Adjust(20), 21, "Wrong positive offset");
+}
+
+class TestSchedulerOllaConvergence : public TestCase
+{
+  public:
+    TestSchedulerOllaConvergence(double targetBler, const std::string& name)
+        : TestCase(name),
+          m_targetBler(targetBler)
+    {
+    }
+
+  private:
+    void DoRun() override;
+    double m_targetBler{0.0}; //!< Target BLER of the OLLA
+};
+
+void
+TestSchedulerOllaConvergence::DoRun()
+{
+    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+    rng->SetStream(1);
+
+    const uint8_t cqiMcs = 18;     // MCS of the CQI, too optimistic
+    const double linkMcs = 14.0;   // MCS with an error probability of 50%
+    const double slope = 1.5;      // Steepness of the error probability
+    const uint32_t numTx = 40000;  // Number of first transmissions
+    const uint32_t warmUp = 10000; // Transmissions needed for the convergence
+
+    NrMacSchedulerOlla::Config config;
+    config.m_enabled = true;
+    config.m_targetBler = m_targetBler;
+
+    NrMacSchedulerOlla olla;
+    olla.SetMaxMcs(28);
+
+    uint32_t nacks = 0;
+    for (uint32_t tx = 0; tx < numTx; ++tx)
+    {
+        const uint8_t mcs = olla.Adjust(cqiMcs);
+        const double errorProbability = 1.0 / (1.0 + std::exp(-slope * (mcs - linkMcs)));
+        const bool ok = rng->GetValue() >= errorProbability;
+        olla.Feedback(ok, config);
+        if (tx >= warmUp && !ok)
+        {
+            ++nacks;
+        }
+    }
+
+    const double bler = static_cast<double>(nacks) / (numTx - warmUp);
+    NS_TEST_ASSERT_MSG_EQ_TOL(bler, m_targetBler, m_targetBler * 0.25, "BLER far from target");
+    NS_TEST_ASSERT_MSG_LT(olla.GetOffset(), 0.0, "The offset must compensate the CQI");
+}
+
+class TestSchedulerOllaSuite : public TestSuite
+{
+  public:
+    TestSchedulerOllaSuite()
+        : TestSuite("nr-test-scheduler-olla", UNIT)
+    {
+        AddTestCase(new TestSchedulerOllaSteps(), QUICK);
+        AddTestCase(new TestSchedulerOllaConvergence(0.1, "OLLA convergence, BLER 10%"), QUICK);
+        AddTestCase(new TestSchedulerOllaConvergence(0.01, "OLLA convergence, BLER 1%"), QUICK);
+    }
+};
+
+static TestSchedulerOllaSuite testSchedulerOllaSuite; //!< OLLA test suite
+
+} // namespace ns3
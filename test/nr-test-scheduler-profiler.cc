@@ -0,0 +1,146 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include <ns3/nr-mac-scheduler-profiler.h>
+#include <ns3/test.h>
+
+#include <sstream>
+
+/**
+ * \file nr-test-scheduler-profiler.cc
+ * \ingroup test
+ *
+ * \brief Unit-testing for the per-phase profiler of the schedulers. The test
+ * profiles slots with nested phases and a varying number of UEs, and checks
+ * the number of calls of each phase, that the time of the nested phases is not
+ * counted twice, and that the slots end up in the histogram of the right
+ * direction, UE bin and RBG bin.
+ */
+namespace ns3
+{
+
+class TestSchedulerProfiler : public TestCase
+{
+  public:
+    TestSchedulerProfiler()
+        : TestCase("Scheduler profiler, nested phases and histograms")
+    {
+    }
+
+  private:
+    void DoRun() override;
+};
+
+void
+TestSchedulerProfiler::DoRun()
+{
+    NS_TEST_ASSERT_MSG_EQ(+NrMacSchedulerProfiler::GetBin(0), 0, "Wrong bin of 0");
+    NS_TEST_ASSERT_MSG_EQ(+NrMacSchedulerProfiler::GetBin(1), 1, "Wrong bin of 1");
+    NS_TEST_ASSERT_MSG_EQ(+NrMacSchedulerProfiler::GetBin(3), 2, "Wrong bin of 3");
+    NS_TEST_ASSERT_MSG_EQ(+NrMacSchedulerProfiler::GetBin(4), 3, "Wrong bin of 4");
+
+    NrMacSchedulerProfiler profiler;
+    const uint32_t numSlots = 40;
+    const uint32_t numRbg = 51;
+    volatile uint64_t sink = 0;
+
+    for (uint32_t slot = 0; slot < numSlots; ++slot)
+    {
+        auto direction = slot % 2 == 0 ? NrMacSchedulerProfiler::DL : NrMacSchedulerProfiler::UL;
+        auto begin = std::chrono::steady_clock::now();
+        profiler.BeginSlot(direction, SfnSf(slot, 0, 0, 0));
+        {
+            NrMacSchedulerProfiler::ScopedPhase rbg(&profiler, NrMacSchedulerProfiler::RBG);
+            for (uint32_t i = 0; i < 1000; ++i)
+            {
+                sink = sink + i;
+            }
+            {
+                NrMacSchedulerProfiler::ScopedPhase beam(&profiler, NrMacSchedulerProfiler::BEAM);
+                for (uint32_t i = 0; i < 1000; ++i)
+                {
+                    sink = sink + i;
+                }
+            }
+        }
+        for (uint32_t ue = 0; ue < slot; ++ue)
+        {
+            NrMacSchedulerProfiler::ScopedPhase dci(&profiler, NrMacSchedulerProfiler::DCI);
+        }
+        profiler.SetNumUes(slot);
+        const auto& profile = profiler.EndSlot(numRbg);
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now() - begin)
+                           .count();
+
+        NS_TEST_ASSERT_MSG_EQ(profile.m_direction, direction, "Wrong direction");
+        NS_TEST_ASSERT_MSG_EQ(profile.m_numUes, slot, "Wrong number of UEs");
+        NS_TEST_ASSERT_MSG_EQ(profile.m_numRbg, numRbg, "Wrong number of RBGs");
+        NS_TEST_ASSERT_MSG_EQ(profile.m_numCalls[NrMacSchedulerProfiler::RBG], 1U, "Wrong calls");
+        NS_TEST_ASSERT_MSG_EQ(profile.m_numCalls[NrMacSchedulerProfiler::BEAM], 1U, "Wrong calls");
+        NS_TEST_ASSERT_MSG_EQ(profile.m_numCalls[NrMacSchedulerProfiler::DCI], slot, "Wrong calls");
+        NS_TEST_ASSERT_MSG_EQ(profile.m_numCalls[NrMacSchedulerProfiler::HARQ], 0U, "Wrong calls");
+
+        uint64_t total = 0;
+        for (const auto& t : profile.m_timeNs)
+        {
+            total += t;
+        }
+        NS_TEST_ASSERT_MSG_LT_OR_EQ(total,
+                                    static_cast<uint64_t>(elapsed),
+                                    "The time of the nested phases is counted twice");
+    }
+
+    NS_TEST_ASSERT_MSG_EQ(profiler.GetNumSlots(NrMacSchedulerProfiler::DL),
+                          numSlots / 2,
+                          "Wrong number of DL slots");
+    NS_TEST_ASSERT_MSG_EQ(profiler.GetNumSlots(NrMacSchedulerProfiler::UL),
+                          numSlots / 2,
+                          "Wrong number of UL slots");
+
+    uint64_t rbgSlots = 0;
+    uint64_t dciCalls = 0;
+    for (const auto& [key, stats] : profiler.GetStats())
+    {
+        NS_TEST_ASSERT_MSG_EQ(+key.m_rbgBin,
+                              +NrMacSchedulerProfiler::GetBin(numRbg),
+                              "Wrong RBG bin");
+        uint64_t binnedSlots = 0;
+        for (const auto& count : stats.m_timeBins)
+        {
+            binnedSlots += count;
+        }
+        NS_TEST_ASSERT_MSG_EQ(binnedSlots, stats.m_numSlots, "Slots missing from the histogram");
+        if (key.m_phase == NrMacSchedulerProfiler::RBG)
+        {
+            rbgSlots += stats.m_numSlots;
+        }
+        if (key.m_phase == NrMacSchedulerProfiler::DCI)
+        {
+            dciCalls += stats.m_numCalls;
+        }
+    }
+    NS_TEST_ASSERT_MSG_EQ(rbgSlots, numSlots, "Wrong number of slots with RBG assignment");
+    NS_TEST_ASSERT_MSG_EQ(dciCalls, numSlots * (numSlots - 1) / 2, "Wrong number of DCIs");
+
+    std::ostringstream summary;
+    profiler.Print(summary);
+    NS_TEST_ASSERT_MSG_NE(summary.str().find("BEAM"), std::string::npos, "Incomplete summary");
+}
+
+class TestSchedulerProfilerSuite : public TestSuite
+{
+  public:
+    TestSchedulerProfilerSuite()
+        : TestSuite("nr-test-scheduler-profiler", UNIT)
+    {
+        AddTestCase(new TestSchedulerProfiler(), QUICK);
+    }
+};
+
+static TestSchedulerProfilerSuite testSchedulerProfilerSuite; //!< Scheduler profiler test suite
+
+} // namespace ns3
@@ -0,0 +1,469 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include <ns3/boolean.h>
+#include <ns3/nr-amc.h>
+#include <ns3/nr-mac-scheduler-recorder.h>
+#include <ns3/nr-mac-scheduler-replay.h>
+#include <ns3/object-factory.h>
+#include <ns3/simulator.h>
+#include <ns3/test.h>
+
+#include <map>
+#include <set>
+
+/**
+ * \file nr-test-scheduler-replay.cc
+ * \ingroup test
+ *
+ * \brief Unit-testing for the record and replay of the scheduler calls. A
+ * fake MAC drives a scheduler through a NrMacSchedulerRecorder: it configures
+ * the UEs, sends RLC buffer reports, CQIs, SRs, BSRs, and acknowledges every
+ * DCI with a HARQ ACK (and an UL CQI for the UL DCIs). The recorded trace is
+ * then replayed on a new scheduler of the same type, and the test checks that
+ * the replayed scheduler takes exactly the same decisions. The trace is also
+ * replayed on a scheduler of another type, which decides differently: the
+ * recorded feedback of the processes and of the UL allocations that the
+ * replayed scheduler did not create must be dropped, and the replay must reach
+ * the end of the trace.
+ */
+namespace ns3
+{
+
+/**
+ * \brief A fake MAC, which reacts to the decisions of the scheduler with
+ * HARQ feedback and UL CQIs
+ */
+class TestReplayMac : public NrMacSchedSapUser, public NrMacCschedSapUser
+{
+  public:
+    TestReplayMac(const Ptr<NrMacSchedulerRecorder>& recorder);
+
+    void Start(uint16_t numUes, uint32_t numSlots);
+    const NrMacSchedulerReplay::Report& GetReport() const;
+
+    // inherited from NrMacSchedSapUser
+    void SchedConfigInd(SchedConfigIndParameters params) override;
+    Ptr<const SpectrumModel> GetSpectrumModel() const override;
+    uint32_t GetNumRbPerRbg() const override;
+    uint8_t GetNumHarqProcess() const override;
+    uint16_t GetBwpId() const override;
+    uint16_t GetCellId() const override;
+    uint32_t GetSymbolsPerSlot() const override;
+    Time GetSlotPeriod() const override;
+
+    // inherited from NrMacCschedSapUser
+    void CschedCellConfigCnf(const CschedCellConfigCnfParameters& params) override;
+    void CschedUeConfigCnf(const CschedUeConfigCnfParameters& params) override;
+    void CschedLcConfigCnf(const CschedLcConfigCnfParameters& params) override;
+    void CschedLcReleaseCnf(const CschedLcReleaseCnfParameters& params) override;
+    void CschedUeReleaseCnf(const CschedUeReleaseCnfParameters& params) override;
+    void CschedUeConfigUpdateInd(const CschedUeConfigUpdateIndParameters& params) override;
+    void CschedCellConfigUpdateInd(const CschedCellConfigUpdateIndParameters& params) override;
+
+  private:
+    void Configure();
+    void Slot(uint32_t slot);
+    static SfnSf GetSfnSf(uint32_t slot);
+
+    static constexpr uint32_t NUM_RB = 52; //!< RBs of the bandwidth, one per RBG
+
+    Ptr<NrMacSchedulerRecorder> m_recorder;
+    Ptr<const SpectrumModel> m_spectrumModel;
+    uint16_t m_numUes{0};
+    uint32_t m_slot{0};
+    std::vector<DlHarqInfo> m_dlFeedback;                     //!< For the next DL trigger
+    std::map<uint32_t, std::vector<UlHarqInfo>> m_ulFeedback; //!< By slot of delivery
+    std::map<uint32_t, std::vector<NrMacSchedSapProvider::SchedUlCqiInfoReqParameters>>
+        m_ulCqi; //!< By slot of delivery
+    NrMacSchedulerReplay::Report m_report;
+};
+
+TestReplayMac::TestReplayMac(const Ptr<NrMacSchedulerRecorder>& recorder)
+    : m_recorder(recorder)
+{
+    std::vector<double> centerFrequencies;
+    for (uint32_t rb = 0; rb < NUM_RB; ++rb)
+    {
+        centerFrequencies.push_back(28e9 + rb * 180e3);
+    }
+    m_spectrumModel = Create<SpectrumModel>(centerFrequencies);
+}
+
+void
+TestReplayMac::Start(uint16_t numUes, uint32_t numSlots)
+{
+    m_numUes = numUes;
+    Simulator::Schedule(Seconds(0), &TestReplayMac::Configure, this);
+    for (uint32_t slot = 1; slot <= numSlots; ++slot)
+    {
+        Simulator::Schedule(MilliSeconds(slot), &TestReplayMac::Slot, this, slot);
+    }
+}
+
+const NrMacSchedulerReplay::Report&
+TestReplayMac::GetReport() const
+{
+    return m_report;
+}
+
+SfnSf
+TestReplayMac::GetSfnSf(uint32_t slot)
+{
+    // Numerology 0: one slot per subframe
+    return SfnSf(slot / 10, slot % 10, 0, 0);
+}
+
+void
+TestReplayMac::Configure()
+{
+    NrMacCschedSapProvider* csched = m_recorder->GetMacCschedSapProvider();
+
+    NrMacCschedSapProvider::CschedCellConfigReqParameters cellConfig;
+    cellConfig.m_ulBandwidth = NUM_RB;
+    cellConfig.m_dlBandwidth = NUM_RB;
+    csched->CschedCellConfigReq(cellConfig);
+
+    for (uint16_t rnti = 1; rnti <= m_numUes; ++rnti)
+    {
+        NrMacCschedSapProvider::CschedUeConfigReqParameters ueConfig;
+        ueConfig.m_rnti = rnti;
+        ueConfig.m_beamConfId = BeamConfId(BeamId(rnti % 2, 90.0), BeamId::GetEmptyBeamId());
+        ueConfig.m_transmissionMode = 0;
+        csched->CschedUeConfigReq(ueConfig);
+
+        NrMacCschedSapProvider::CschedLcConfigReqParameters lcConfig;
+        lcConfig.m_rnti = rnti;
+        lcConfig.m_reconfigureFlag = false;
+        LogicalChannelConfigListElement_s lc;
+        lc.m_logicalChannelIdentity = 1;
+        lc.m_logicalChannelGroup = 1;
+        lc.m_direction = LogicalChannelConfigListElement_s::DIR_BOTH;
+        lc.m_qosBearerType = LogicalChannelConfigListElement_s::QBT_NON_GBR;
+        lc.m_qci = 9;
+        lc.m_eRabMaximulBitrateUl = 0;
+        lc.m_eRabMaximulBitrateDl = 0;
+        lc.m_eRabGuaranteedBitrateUl = 0;
+        lc.m_eRabGuaranteedBitrateDl = 0;
+        lcConfig.m_logicalChannelConfigList.emplace_back(lc);
+        csched->CschedLcConfigReq(lcConfig);
+    }
+}
+
+void
+TestReplayMac::Slot(uint32_t slot)
+{
+    NrMacSchedSapProvider* sched = m_recorder->GetMacSchedSapProvider();
+    m_slot = slot;
+
+    for (uint16_t rnti = 1; rnti <= m_numUes; ++rnti)
+    {
+        if ((slot + rnti) % 5 == 0)
+        {
+            NrMacSchedSapProvider::SchedDlRlcBufferReqParameters rlc;
+            rlc.m_rnti = rnti;
+            rlc.m_logicalChannelIdentity = 1;
+            rlc.m_rlcTransmissionQueueSize = 500 * rnti;
+            rlc.m_rlcTransmissionQueueHolDelay = 0;
+            rlc.m_rlcRetransmissionQueueSize = 0;
+            rlc.m_rlcRetransmissionHolDelay = 0;
+            rlc.m_rlcStatusPduSize = 0;
+            sched->SchedDlRlcBufferReq(rlc);
+        }
+    }
+
+    if (slot % 10 == 1)
+    {
+        NrMacSchedSapProvider::SchedDlCqiInfoReqParameters dlCqi;
+        dlCqi.m_sfnsf = GetSfnSf(slot);
+        NrMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters bsr;
+        bsr.m_sfnSf = GetSfnSf(slot);
+        for (uint16_t rnti = 1; rnti <= m_numUes; ++rnti)
+        {
+            DlCqiInfo cqi;
+            cqi.m_rnti = rnti;
+            cqi.m_ri = 1;
+            cqi.m_cqiType = DlCqiInfo::WB;
+            cqi.m_wbCqi = {static_cast<uint8_t>(3 + (rnti + slot / 10) % 12)};
+            dlCqi.m_cqiList.push_back(cqi);
+
+            MacCeElement ce;
+            ce.m_rnti = rnti;
+            ce.m_macCeType = MacCeElement::BSR;
+            ce.m_macCeValue.m_bufferStatus = {0, static_cast<uint8_t>(10 + rnti % 10), 0, 0};
+            bsr.m_macCeList.push_back(ce);
+        }
+        sched->SchedDlCqiInfoReq(dlCqi);
+        sched->SchedUlMacCtrlInfoReq(bsr);
+    }
+
+    if (slot == 3)
+    {
+        NrMacSchedSapProvider::SchedUlSrInfoReqParameters sr;
+        sr.m_snfSf = GetSfnSf(slot);
+        for (uint16_t rnti = 1; rnti <= m_numUes; rnti += 2)
+        {
+            sr.m_srList.push_back(rnti);
+        }
+        sched->SchedUlSrInfoReq(sr);
+    }
+
+    for (const auto& ulCqi : m_ulCqi[slot])
+    {
+        sched->SchedUlCqiInfoReq(ulCqi);
+    }
+    m_ulCqi.erase(slot);
+
+    // UL is scheduled two slots in advance, as the MAC does with K2
+    NrMacSchedSapProvider::SchedUlTriggerReqParameters ulTrigger;
+    ulTrigger.m_snfSf = GetSfnSf(slot + 2);
+    ulTrigger.m_ulHarqInfoList = std::move(m_ulFeedback[slot]);
+    ulTrigger.m_slotType = LteNrTddSlotType::F;
+    m_ulFeedback.erase(slot);
+    sched->SchedUlTriggerReq(ulTrigger);
+
+    NrMacSchedSapProvider::SchedDlTriggerReqParameters dlTrigger;
+    dlTrigger.m_snfSf = GetSfnSf(slot);
+    dlTrigger.m_dlHarqInfoList = std::move(m_dlFeedback);
+    dlTrigger.m_slotType = LteNrTddSlotType::F;
+    m_dlFeedback.clear();
+    sched->SchedDlTriggerReq(dlTrigger);
+}
+
+void
+TestReplayMac::SchedConfigInd(SchedConfigIndParameters params)
+{
+    NrMacSchedulerReplay::AddSlot(&m_report, params.m_slotAllocInfo);
+
+    std::set<uint8_t> ulCqiSymStart;
+    for (const auto& varTti : params.m_slotAllocInfo.m_varTtiAllocInfo)
+    {
+        const auto& dci = varTti.m_dci;
+        if (dci->m_type != DciInfoElementTdma::DATA)
+        {
+            continue;
+        }
+        if (dci->m_format == DciInfoElementTdma::DL)
+        {
+            DlHarqInfo harq;
+            harq.m_rnti = dci->m_rnti;
+            harq.m_harqProcessId = dci->m_harqProcess;
+            harq.m_bwpIndex = 0;
+            for (const auto& tbs : dci->m_tbSize)
+            {
+                harq.m_harqStatus.push_back(tbs > 0 ? DlHarqInfo::ACK : DlHarqInfo::NONE);
+            }
+            harq.m_numRetx = dci->m_rv;
+            m_dlFeedback.push_back(harq);
+        }
+        else
+        {
+            // The UL slot is two slots in the future: the feedback comes after it
+            UlHarqInfo harq;
+            harq.m_rnti = dci->m_rnti;
+            harq.m_harqProcessId = dci->m_harqProcess;
+            harq.m_bwpIndex = 0;
+            harq.m_receptionStatus = UlHarqInfo::Ok;
+            harq.m_tpc = 1;
+            harq.m_numRetx = 0;
+            m_ulFeedback[m_slot + 3].push_back(harq);
+
+            if (ulCqiSymStart.insert(dci->m_symStart).second)
+            {
+                NrMacSchedSapProvider::SchedUlCqiInfoReqParameters ulCqi;
+                ulCqi.m_sfnSf = params.m_sfnSf;
+                ulCqi.m_symStart = dci->m_symStart;
+                ulCqi.m_ulCqi.m_type = UlCqiInfo::PUSCH;
+                ulCqi.m_ulCqi.m_sinr = std::vector<double>(NUM_RB, 5.0 + dci->m_rnti);
+                m_ulCqi[m_slot + 3].push_back(ulCqi);
+            }
+        }
+    }
+}
+
+Ptr<const SpectrumModel>
+TestReplayMac::GetSpectrumModel() const
+{
+    return m_spectrumModel;
+}
+
+uint32_t
+TestReplayMac::GetNumRbPerRbg() const
+{
+    return 1;
+}
+
+uint8_t
+TestReplayMac::GetNumHarqProcess() const
+{
+    return 16;
+}
+
+uint16_t
+TestReplayMac::GetBwpId() const
+{
+    return 0;
+}
+
+uint16_t
+TestReplayMac::GetCellId() const
+{
+    return 1;
+}
+
+uint32_t
+TestReplayMac::GetSymbolsPerSlot() const
+{
+    return 14;
+}
+
+Time
+TestReplayMac::GetSlotPeriod() const
+{
+    return MilliSeconds(1);
+}
+
+void
+TestReplayMac::CschedCellConfigCnf(const CschedCellConfigCnfParameters& params)
+{
+}
+
+void
+TestReplayMac::CschedUeConfigCnf(const CschedUeConfigCnfParameters& params)
+{
+}
+
+void
+TestReplayMac::CschedLcConfigCnf(const CschedLcConfigCnfParameters& params)
+{
+}
+
+void
+TestReplayMac::CschedLcReleaseCnf(const CschedLcReleaseCnfParameters& params)
+{
+}
+
+void
+TestReplayMac::CschedUeReleaseCnf(const CschedUeReleaseCnfParameters& params)
+{
+}
+
+void
+TestReplayMac::CschedUeConfigUpdateInd(const CschedUeConfigUpdateIndParameters& params)
+{
+}
+
+void
+TestReplayMac::CschedCellConfigUpdateInd(const CschedCellConfigUpdateIndParameters& params)
+{
+}
+
+class TestSchedulerReplay : public TestCase
+{
+  public:
+    TestSchedulerReplay(const std::string& recordType, const std::string& replayType)
+        : TestCase("Scheduler record with " + recordType + " and replay with " + replayType),
+          m_recordType(recordType),
+          m_replayType(replayType)
+    {
+    }
+
+  private:
+    void DoRun() override;
+    static Ptr<NrMacSchedulerNs3> CreateScheduler(const std::string& type);
+
+    std::string m_recordType; //!< Type of the recorded scheduler
+    std::string m_replayType; //!< Type of the replayed scheduler
+};
+
+Ptr<NrMacSchedulerNs3>
+TestSchedulerReplay::CreateScheduler(const std::string& type)
+{
+    ObjectFactory factory;
+    factory.SetTypeId(type);
+    factory.Set("EnableSrsInFSlots", BooleanValue(false));
+    auto sched = factory.Create<NrMacSchedulerNs3>();
+    sched->InstallDlAmc(CreateObject<NrAmc>());
+    sched->InstallUlAmc(CreateObject<NrAmc>());
+    return sched;
+}
+
+void
+TestSchedulerReplay::DoRun()
+{
+    const std::string filename = CreateTempDirFilename("nr-test-scheduler-replay.bin");
+    const uint32_t numSlots = 200;
+
+    // Record
+    auto sched = CreateScheduler(m_recordType);
+    auto recorder = CreateObject<NrMacSchedulerRecorder>();
+    TestReplayMac mac(recorder);
+    recorder->Open(filename);
+    recorder->SetMacSchedSapProvider(sched->GetMacSchedSapProvider());
+    recorder->SetMacCschedSapProvider(sched->GetMacCschedSapProvider());
+    recorder->SetMacSchedSapUser(&mac);
+    sched->SetMacSchedSapUser(&mac);
+    sched->SetMacCschedSapUser(&mac);
+
+    mac.Start(10, numSlots);
+    Simulator::Run();
+    Simulator::Destroy();
+    const uint64_t numRecords = recorder->GetNumRecords();
+    recorder->Dispose();
+    const NrMacSchedulerReplay::Report& recorded = mac.GetReport();
+
+    NS_TEST_ASSERT_MSG_GT(recorded.m_numDlDci, 0, "The scheduler did not schedule DL data");
+    NS_TEST_ASSERT_MSG_GT(recorded.m_numUlDci, 0, "The scheduler did not schedule UL data");
+
+    // Replay
+    NrMacSchedulerReplay replay(filename);
+    NrMacSchedulerReplay::Report replayed = replay.Run(CreateScheduler(m_replayType));
+    Simulator::Destroy();
+
+    NS_TEST_ASSERT_MSG_EQ(replayed.m_numRecords, numRecords, "Wrong number of records");
+    NS_TEST_ASSERT_MSG_EQ(replayed.m_numDlSlots, numSlots, "Wrong number of DL slots");
+    NS_TEST_ASSERT_MSG_EQ(replayed.m_numUlSlots, numSlots, "Wrong number of UL slots");
+    NS_TEST_ASSERT_MSG_GT(replayed.m_slotsPerSecond, 0.0, "Slots per second not computed");
+
+    if (m_recordType != m_replayType)
+    {
+        NS_TEST_ASSERT_MSG_GT(replayed.m_numDlDci, 0, "The replay did not schedule DL data");
+        NS_TEST_ASSERT_MSG_GT(replayed.m_numUlDci, 0, "The replay did not schedule UL data");
+        NS_TEST_ASSERT_MSG_GT(replayed.m_numDroppedFeedback,
+                              0,
+                              "The feedback of the recorded decisions was not filtered");
+        return;
+    }
+
+    NS_TEST_ASSERT_MSG_EQ(replayed.m_numDroppedFeedback, 0, "Feedback dropped");
+    NS_TEST_ASSERT_MSG_EQ(replayed.m_numDlDci, recorded.m_numDlDci, "Different DL DCIs");
+    NS_TEST_ASSERT_MSG_EQ(replayed.m_numUlDci, recorded.m_numUlDci, "Different UL DCIs");
+    NS_TEST_ASSERT_MSG_EQ(replayed.m_dlBytes, recorded.m_dlBytes, "Different DL bytes");
+    NS_TEST_ASSERT_MSG_EQ(replayed.m_ulBytes, recorded.m_ulBytes, "Different UL bytes");
+    NS_TEST_ASSERT_MSG_EQ(replayed.m_digest, recorded.m_digest, "Different decisions");
+}
+
+class TestSchedulerReplaySuite : public TestSuite
+{
+  public:
+    TestSchedulerReplaySuite()
+        : TestSuite("nr-test-scheduler-replay", UNIT)
+    {
+        // The same type takes the same decisions, another type does not
+        const std::vector<std::pair<std::string, std::string>> types{
+            {"ns3::NrMacSchedulerTdmaRR", "ns3::NrMacSchedulerTdmaRR"},
+            {"ns3::NrMacSchedulerTdmaPF", "ns3::NrMacSchedulerTdmaRR"},
+            {"ns3::NrMacSchedulerOfdmaPF", "ns3::NrMacSchedulerOfdmaRR"}};
+        for (const auto& [recordType, replayType] : types)
+        {
+            AddTestCase(new TestSchedulerReplay(recordType, replayType), QUICK);
+        }
+    }
+};
+
+static TestSchedulerReplaySuite testSchedulerReplaySuite; //!< Scheduler replay test suite
+
+} // namespace ns3
@@ -0,0 +1,508 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include <ns3/boolean.h>
+#include <ns3/nr-amc.h>
+#include <ns3/nr-mac-scheduler-replay.h>
+#include <ns3/nr-mac-scheduler-static.h>
+#include <ns3/nr-mac-scheduler-ue-mirror.h>
+#include <ns3/object-factory.h>
+#include <ns3/simulator.h>
+#include <ns3/test.h>
+
+#include <map>
+#include <set>
+
+/**
+ * \file nr-test-scheduler-static.cc
+ * \ingroup test
+ *
+ * \brief Unit-testing for the schedulers with static dispatch of the policy
+ * (NrMacSchedulerStatic). Each of them runs side by side with the scheduler
+ * with the same access and policy, composed through virtual methods: both are
+ * driven by a fake MAC, which configures the UEs, sends RLC buffer reports,
+ * CQIs, SRs, BSRs, and acknowledges every DCI. The test checks that the two
+ * schedulers take exactly the same decisions, slot by slot, with and without
+ * the incremental ordering of the UEs, and with and without the sort through
+ * the mirror of the UEs (NrMacSchedulerUeMirror).
+ */
+namespace ns3
+{
+
+/**
+ * \brief A fake MAC, which reacts to the decisions of the scheduler with
+ * HARQ feedback and UL CQIs
+ */
+class TestStaticMac : public NrMacSchedSapUser, public NrMacCschedSapUser
+{
+  public:
+    TestStaticMac(const Ptr<NrMacSchedulerNs3>& sched);
+
+    void Start(uint16_t numUes, uint32_t numSlots);
+    const NrMacSchedulerReplay::Report& GetReport() const;
+
+    // inherited from NrMacSchedSapUser
+    void SchedConfigInd(SchedConfigIndParameters params) override;
+    Ptr<const SpectrumModel> GetSpectrumModel() const override;
+    uint32_t GetNumRbPerRbg() const override;
+    uint8_t GetNumHarqProcess() const override;
+    uint16_t GetBwpId() const override;
+    uint16_t GetCellId() const override;
+    uint32_t GetSymbolsPerSlot() const override;
+    Time GetSlotPeriod() const override;
+
+    // inherited from NrMacCschedSapUser
+    void CschedCellConfigCnf(const CschedCellConfigCnfParameters& params) override;
+    void CschedUeConfigCnf(const CschedUeConfigCnfParameters& params) override;
+    void CschedLcConfigCnf(const CschedLcConfigCnfParameters& params) override;
+    void CschedLcReleaseCnf(const CschedLcReleaseCnfParameters& params) override;
+    void CschedUeReleaseCnf(const CschedUeReleaseCnfParameters& params) override;
+    void CschedUeConfigUpdateInd(const CschedUeConfigUpdateIndParameters& params) override;
+    void CschedCellConfigUpdateInd(const CschedCellConfigUpdateIndParameters& params) override;
+
+  private:
+    void Configure();
+    void Slot(uint32_t slot);
+    static SfnSf GetSfnSf(uint32_t slot);
+
+    static constexpr uint32_t NUM_RB = 52; //!< RBs of the bandwidth, one per RBG
+
+    Ptr<NrMacSchedulerNs3> m_sched;
+    Ptr<const SpectrumModel> m_spectrumModel;
+    uint16_t m_numUes{0};
+    uint32_t m_slot{0};
+    std::vector<DlHarqInfo> m_dlFeedback;                     //!< For the next DL trigger
+    std::map<uint32_t, std::vector<UlHarqInfo>> m_ulFeedback; //!< By slot of delivery
+    std::map<uint32_t, std::vector<NrMacSchedSapProvider::SchedUlCqiInfoReqParameters>>
+        m_ulCqi; //!< By slot of delivery
+    NrMacSchedulerReplay::Report m_report;
+};
+
+TestStaticMac::TestStaticMac(const Ptr<NrMacSchedulerNs3>& sched)
+    : m_sched(sched)
+{
+    std::vector<double> centerFrequencies;
+    for (uint32_t rb = 0; rb < NUM_RB; ++rb)
+    {
+        centerFrequencies.push_back(28e9 + rb * 180e3);
+    }
+    m_spectrumModel = Create<SpectrumModel>(centerFrequencies);
+    m_sched->SetMacSchedSapUser(this);
+    m_sched->SetMacCschedSapUser(this);
+}
+
+void
+TestStaticMac::Start(uint16_t numUes, uint32_t numSlots)
+{
+    m_numUes = numUes;
+    Simulator::Schedule(Seconds(0), &TestStaticMac::Configure, this);
+    for (uint32_t slot = 1; slot <= numSlots; ++slot)
+    {
+        Simulator::Schedule(MilliSeconds(slot), &TestStaticMac::Slot, this, slot);
+    }
+}
+
+const NrMacSchedulerReplay::Report&
+TestStaticMac::GetReport() const
+{
+    return m_report;
+}
+
+SfnSf
+TestStaticMac::GetSfnSf(uint32_t slot)
+{
+    // Numerology 0: one slot per subframe
+    return SfnSf(slot / 10, slot % 10, 0, 0);
+}
+
+void
+TestStaticMac::Configure()
+{
+    NrMacCschedSapProvider* csched = m_sched->GetMacCschedSapProvider();
+
+    NrMacCschedSapProvider::CschedCellConfigReqParameters cellConfig;
+    cellConfig.m_ulBandwidth = NUM_RB;
+    cellConfig.m_dlBandwidth = NUM_RB;
+    csched->CschedCellConfigReq(cellConfig);
+
+    for (uint16_t rnti = 1; rnti <= m_numUes; ++rnti)
+    {
+        NrMacCschedSapProvider::CschedUeConfigReqParameters ueConfig;
+        ueConfig.m_rnti = rnti;
+        ueConfig.m_beamConfId = BeamConfId(BeamId(rnti % 2, 90.0), BeamId::GetEmptyBeamId());
+        ueConfig.m_transmissionMode = 0;
+        csched->CschedUeConfigReq(ueConfig);
+
+        NrMacCschedSapProvider::CschedLcConfigReqParameters lcConfig;
+        lcConfig.m_rnti = rnti;
+        lcConfig.m_reconfigureFlag = false;
+        LogicalChannelConfigListElement_s lc;
+        lc.m_logicalChannelIdentity = 1;
+        lc.m_logicalChannelGroup = 1;
+        lc.m_direction = LogicalChannelConfigListElement_s::DIR_BOTH;
+        lc.m_qosBearerType = LogicalChannelConfigListElement_s::QBT_NON_GBR;
+        lc.m_qci = rnti % 3 == 0 ? 7 : 9;
+        lc.m_eRabMaximulBitrateUl = 0;
+        lc.m_eRabMaximulBitrateDl = 0;
+        lc.m_eRabGuaranteedBitrateUl = 0;
+        lc.m_eRabGuaranteedBitrateDl = 0;
+        lcConfig.m_logicalChannelConfigList.emplace_back(lc);
+        csched->CschedLcConfigReq(lcConfig);
+    }
+}
+
+void
+TestStaticMac::Slot(uint32_t slot)
+{
+    NrMacSchedSapProvider* sched = m_sched->GetMacSchedSapProvider();
+    m_slot = slot;
+
+    for (uint16_t rnti = 1; rnti <= m_numUes; ++rnti)
+    {
+        if ((slot + rnti) % 5 == 0)
+        {
+            NrMacSchedSapProvider::SchedDlRlcBufferReqParameters rlc;
+            rlc.m_rnti = rnti;
+            rlc.m_logicalChannelIdentity = 1;
+            rlc.m_rlcTransmissionQueueSize = 500 * rnti;
+            rlc.m_rlcTransmissionQueueHolDelay = 0;
+            rlc.m_rlcRetransmissionQueueSize = 0;
+            rlc.m_rlcRetransmissionHolDelay = 0;
+            rlc.m_rlcStatusPduSize = 0;
+            sched->SchedDlRlcBufferReq(rlc);
+        }
+    }
+
+    if (slot % 10 == 1)
+    {
+        NrMacSchedSapProvider::SchedDlCqiInfoReqParameters dlCqi;
+        dlCqi.m_sfnsf = GetSfnSf(slot);
+        NrMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters bsr;
+        bsr.m_sfnSf = GetSfnSf(slot);
+        for (uint16_t rnti = 1; rnti <= m_numUes; ++rnti)
+        {
+            DlCqiInfo cqi;
+            cqi.m_rnti = rnti;
+            cqi.m_ri = 1;
+            cqi.m_cqiType = DlCqiInfo::WB;
+            cqi.m_wbCqi = {static_cast<uint8_t>(3 + (rnti + slot / 10) % 12)};
+            dlCqi.m_cqiList.push_back(cqi);
+
+            MacCeElement ce;
+            ce.m_rnti = rnti;
+            ce.m_macCeType = MacCeElement::BSR;
+            ce.m_macCeValue.m_bufferStatus = {0, static_cast<uint8_t>(10 + rnti % 10), 0, 0};
+            bsr.m_macCeList.push_back(ce);
+        }
+        sched->SchedDlCqiInfoReq(dlCqi);
+        sched->SchedUlMacCtrlInfoReq(bsr);
+    }
+
+    if (slot == 3)
+    {
+        NrMacSchedSapProvider::SchedUlSrInfoReqParameters sr;
+        sr.m_snfSf = GetSfnSf(slot);
+        for (uint16_t rnti = 1; rnti <= m_numUes; rnti += 2)
+        {
+            sr.m_srList.push_back(rnti);
+        }
+        sched->SchedUlSrInfoReq(sr);
+    }
+
+    for (const auto& ulCqi : m_ulCqi[slot])
+    {
+        sched->SchedUlCqiInfoReq(ulCqi);
+    }
+    m_ulCqi.erase(slot);
+
+    // UL is scheduled two slots in advance, as the MAC does with K2
+    NrMacSchedSapProvider::SchedUlTriggerReqParameters ulTrigger;
+    ulTrigger.m_snfSf = GetSfnSf(slot + 2);
+    ulTrigger.m_ulHarqInfoList = std::move(m_ulFeedback[slot]);
+    ulTrigger.m_slotType = LteNrTddSlotType::F;
+    m_ulFeedback.erase(slot);
+    sched->SchedUlTriggerReq(ulTrigger);
+
+    NrMacSchedSapProvider::SchedDlTriggerReqParameters dlTrigger;
+    dlTrigger.m_snfSf = GetSfnSf(slot);
+    dlTrigger.m_dlHarqInfoList = std::move(m_dlFeedback);
+    dlTrigger.m_slotType = LteNrTddSlotType::F;
+    m_dlFeedback.clear();
+    sched->SchedDlTriggerReq(dlTrigger);
+}
+
+void
+TestStaticMac::SchedConfigInd(SchedConfigIndParameters params)
+{
+    NrMacSchedulerReplay::AddSlot(&m_report, params.m_slotAllocInfo);
+
+    std::set<uint8_t> ulCqiSymStart;
+    for (const auto& varTti : params.m_slotAllocInfo.m_varTtiAllocInfo)
+    {
+        const auto& dci = varTti.m_dci;
+        if (dci->m_type != DciInfoElementTdma::DATA)
+        {
+            continue;
+        }
+        if (dci->m_format == DciInfoElementTdma::DL)
+        {
+            DlHarqInfo harq;
+            harq.m_rnti = dci->m_rnti;
+            harq.m_harqProcessId = dci->m_harqProcess;
+            harq.m_bwpIndex = 0;
+            for (const auto& tbs : dci->m_tbSize)
+            {
+                harq.m_harqStatus.push_back(tbs > 0 ? DlHarqInfo::ACK : DlHarqInfo::NONE);
+            }
+            harq.m_numRetx = dci->m_rv;
+            m_dlFeedback.push_back(harq);
+        }
+        else
+        {
+            // The UL slot is two slots in the future: the feedback comes after it
+            UlHarqInfo harq;
+            harq.m_rnti = dci->m_rnti;
+            harq.m_harqProcessId = dci->m_harqProcess;
+            harq.m_bwpIndex = 0;
+            harq.m_receptionStatus = UlHarqInfo::Ok;
+            harq.m_tpc = 1;
+            harq.m_numRetx = 0;
+            m_ulFeedback[m_slot + 3].push_back(harq);
+
+            if (ulCqiSymStart.insert(dci->m_symStart).second)
+            {
+                NrMacSchedSapProvider::SchedUlCqiInfoReqParameters ulCqi;
+                ulCqi.m_sfnSf = params.m_sfnSf;
+                ulCqi.m_symStart = dci->m_symStart;
+                ulCqi.m_ulCqi.m_type = UlCqiInfo::PUSCH;
+                ulCqi.m_ulCqi.m_sinr = std::vector<double>(NUM_RB, 5.0 + dci->m_rnti);
+                m_ulCqi[m_slot + 3].push_back(ulCqi);
+            }
+        }
+    }
+}
+
+Ptr<const SpectrumModel>
+TestStaticMac::GetSpectrumModel() const
+{
+    return m_spectrumModel;
+}
+
+uint32_t
+TestStaticMac::GetNumRbPerRbg() const
+{
+    return 1;
+}
+
+uint8_t
+TestStaticMac::GetNumHarqProcess() const
+{
+    return 16;
+}
+
+uint16_t
+TestStaticMac::GetBwpId() const
+{
+    return 0;
+}
+
+uint16_t
+TestStaticMac::GetCellId() const
+{
+    return 1;
+}
+
+uint32_t
+TestStaticMac::GetSymbolsPerSlot() const
+{
+    return 14;
+}
+
+Time
+TestStaticMac::GetSlotPeriod() const
+{
+    return MilliSeconds(1);
+}
+
+void
+TestStaticMac::CschedCellConfigCnf(const CschedCellConfigCnfParameters& params)
+{
+}
+
+void
+TestStaticMac::CschedUeConfigCnf(const CschedUeConfigCnfParameters& params)
+{
+}
+
+void
+TestStaticMac::CschedLcConfigCnf(const CschedLcConfigCnfParameters& params)
+{
+}
+
+void
+TestStaticMac::CschedLcReleaseCnf(const CschedLcReleaseCnfParameters& params)
+{
+}
+
+void
+TestStaticMac::CschedUeReleaseCnf(const CschedUeReleaseCnfParameters& params)
+{
+}
+
+void
+TestStaticMac::CschedUeConfigUpdateInd(const CschedUeConfigUpdateIndParameters& params)
+{
+}
+
+void
+TestStaticMac::CschedCellConfigUpdateInd(const CschedCellConfigUpdateIndParameters& params)
+{
+}
+
+class TestSchedulerStatic : public TestCase
+{
+  public:
+    TestSchedulerStatic(const std::string& dynamicType,
+                        const std::string& staticType,
+                        bool incremental,
+                        bool mirror)
+        : TestCase("Scheduler " + staticType + " takes the decisions of " + dynamicType +
+                   (incremental ? " (incremental UE ordering)" : "") +
+                   (mirror ? " (UE state mirror)" : "")),
+          m_dynamicType(dynamicType),
+          m_staticType(staticType),
+          m_incremental(incremental),
+          m_mirror(mirror)
+    {
+    }
+
+  private:
+    void DoRun() override;
+    Ptr<NrMacSchedulerNs3> CreateScheduler(const std::string& type, bool mirror) const;
+
+    std::string m_dynamicType;
+    std::string m_staticType;
+    bool m_incremental;
+    bool m_mirror;
+};
+
+Ptr<NrMacSchedulerNs3>
+TestSchedulerStatic::CreateScheduler(const std::string& type, bool mirror) const
+{
+    ObjectFactory factory;
+    factory.SetTypeId(type);
+    factory.Set("EnableSrsInFSlots", BooleanValue(false));
+    factory.Set("IncrementalUeOrdering", BooleanValue(m_incremental));
+    if (mirror)
+    {
+        factory.Set("UeStateMirror", BooleanValue(true));
+    }
+    auto sched = factory.Create<NrMacSchedulerNs3>();
+    sched->InstallDlAmc(CreateObject<NrAmc>());
+    sched->InstallUlAmc(CreateObject<NrAmc>());
+    return sched;
+}
+
+void
+TestSchedulerStatic::DoRun()
+{
+    const uint32_t numSlots = 100;
+
+    auto dynamicSched = CreateScheduler(m_dynamicType, false);
+    auto staticSched = CreateScheduler(m_staticType, m_mirror);
+    NS_TEST_ASSERT_MSG_EQ(staticSched->GetInstanceTypeId().IsChildOf(
+                              dynamicSched->GetInstanceTypeId()),
+                          true,
+                          "The static scheduler should derive from the dynamic one");
+
+    TestStaticMac dynamicMac(dynamicSched);
+    TestStaticMac staticMac(staticSched);
+    dynamicMac.Start(10, numSlots);
+    staticMac.Start(10, numSlots);
+    Simulator::Run();
+    Simulator::Destroy();
+
+    const NrMacSchedulerReplay::Report& expected = dynamicMac.GetReport();
+    const NrMacSchedulerReplay::Report& actual = staticMac.GetReport();
+
+    NS_TEST_ASSERT_MSG_GT(expected.m_numDlDci, 0, "The scheduler did not schedule DL data");
+    NS_TEST_ASSERT_MSG_GT(expected.m_numUlDci, 0, "The scheduler did not schedule UL data");
+    NS_TEST_ASSERT_MSG_EQ(actual.m_numDlDci, expected.m_numDlDci, "Different DL DCIs");
+    NS_TEST_ASSERT_MSG_EQ(actual.m_numUlDci, expected.m_numUlDci, "Different UL DCIs");
+    NS_TEST_ASSERT_MSG_EQ(actual.m_dlBytes, expected.m_dlBytes, "Different DL bytes");
+    NS_TEST_ASSERT_MSG_EQ(actual.m_ulBytes, expected.m_ulBytes, "Different UL bytes");
+    NS_TEST_ASSERT_MSG_EQ(actual.m_digest, expected.m_digest, "Different decisions");
+
+    dynamicSched->Dispose();
+    staticSched->Dispose();
+}
+
+/**
+ * \brief Check that the packed MCS of NrMacSchedulerUeMirror compare as the
+ * vectors of MCS of the streams
+ */
+class TestUeMirrorPackMcs : public TestCase
+{
+  public:
+    TestUeMirrorPackMcs()
+        : TestCase("The packed MCS of the mirror of the UEs keep the order of the streams")
+    {
+    }
+
+  private:
+    void DoRun() override;
+};
+
+void
+TestUeMirrorPackMcs::DoRun()
+{
+    const std::vector<std::vector<uint8_t>> values = {{},
+                                                      {0},
+                                                      {0, 0},
+                                                      {0, 28},
+                                                      {1},
+                                                      {1, 0},
+                                                      {27, 28},
+                                                      {28},
+                                                      {28, 0},
+                                                      {28, 28},
+                                                      {255},
+                                                      {255, 255, 255, 255, 255, 255, 255}};
+    for (const auto& lhs : values)
+    {
+        for (const auto& rhs : values)
+        {
+            const uint64_t lPacked = NrMacSchedulerUeMirror::PackMcs(lhs);
+            const uint64_t rPacked = NrMacSchedulerUeMirror::PackMcs(rhs);
+            NS_TEST_ASSERT_MSG_EQ(lPacked < rPacked, lhs < rhs, "Wrong order");
+            NS_TEST_ASSERT_MSG_EQ(lPacked == rPacked, lhs == rhs, "Wrong equality");
+        }
+    }
+}
+
+class TestSchedulerStaticSuite : public TestSuite
+{
+  public:
+    TestSchedulerStaticSuite()
+        : TestSuite("nr-test-scheduler-static", UNIT)
+    {
+        for (const std::string access : {"Tdma", "Ofdma"})
+        {
+            for (const std::string policy : {"RR", "MR", "PF", "Qos"})
+            {
+                const std::string type = "ns3::NrMacScheduler" + access + policy;
+                AddTestCase(new TestSchedulerStatic(type, type + "Static", false, false), QUICK);
+                AddTestCase(new TestSchedulerStatic(type, type + "Static", true, false), QUICK);
+                AddTestCase(new TestSchedulerStatic(type, type + "Static", false, true), QUICK);
+            }
+        }
+        AddTestCase(new TestUeMirrorPackMcs, QUICK);
+    }
+};
+
+static TestSchedulerStaticSuite testSchedulerStaticSuite; //!< Static scheduler test suite
+
+} // namespace ns3
@@ -0,0 +1,459 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include <ns3/boolean.h>
+#include <ns3/nr-amc.h>
+#include <ns3/nr-mac-scheduler-ns3.h>
+#include <ns3/object-factory.h>
+#include <ns3/simulator.h>
+#include <ns3/test.h>
+
+#include <set>
+
+/**
+ * \file nr-test-scheduler-subband-cqi.cc
+ * \ingroup test
+ *
+ * \brief Unit-testing for the DL subband CQI in the OFDMA schedulers. Two UEs
+ * of the same beam report a subband CQI: the first one has a good channel in
+ * the lower half of the band, and a bad one in the upper half; the second one
+ * the opposite. The scheduler must give each UE only RBG of its good half, with
+ * the MCS of the good subbands. With the same channel reported as wideband
+ * CQI, the scheduler uses the wideband MCS. When the UEs report a subband CQI,
+ * and then a wideband-only one, the scheduler must switch to the wideband MCS.
+ */
+namespace ns3
+{
+
+/**
+ * \brief The CQI reported by the UEs of the test
+ */
+enum class TestCqiMode
+{
+    WIDEBAND,              //!< Wideband CQI
+    SUBBAND,               //!< Subband CQI
+    SUBBAND_THEN_WIDEBAND, //!< Subband CQI, then wideband-only CQI from the second report
+};
+
+/**
+ * \brief A fake MAC, which reports the CQI and the DL buffers of two UEs, and
+ * checks the DL DCIs
+ */
+class TestSubbandCqiMac : public NrMacSchedSapUser, public NrMacCschedSapUser
+{
+  public:
+    TestSubbandCqiMac(const Ptr<NrMacSchedulerNs3>& sched, TestCqiMode mode);
+
+    void Start(uint32_t numSlots);
+    uint32_t GetNumDci() const;
+    uint32_t GetRbgInBadHalf() const;
+    std::set<uint8_t> GetMcs() const;
+
+    // inherited from NrMacSchedSapUser
+    void SchedConfigInd(SchedConfigIndParameters params) override;
+    Ptr<const SpectrumModel> GetSpectrumModel() const override;
+    uint32_t GetNumRbPerRbg() const override;
+    uint8_t GetNumHarqProcess() const override;
+    uint16_t GetBwpId() const override;
+    uint16_t GetCellId() const override;
+    uint32_t GetSymbolsPerSlot() const override;
+    Time GetSlotPeriod() const override;
+
+    // inherited from NrMacCschedSapUser
+    void CschedCellConfigCnf(const CschedCellConfigCnfParameters& params) override;
+    void CschedUeConfigCnf(const CschedUeConfigCnfParameters& params) override;
+    void CschedLcConfigCnf(const CschedLcConfigCnfParameters& params) override;
+    void CschedLcReleaseCnf(const CschedLcReleaseCnfParameters& params) override;
+    void CschedUeReleaseCnf(const CschedUeReleaseCnfParameters& params) override;
+    void CschedUeConfigUpdateInd(const CschedUeConfigUpdateIndParameters& params) override;
+    void CschedCellConfigUpdateInd(const CschedCellConfigUpdateIndParameters& params) override;
+
+    static constexpr uint32_t NUM_RB = 52;  //!< RBs of the bandwidth, one per RBG
+    static constexpr uint16_t SB_SIZE = 2;  //!< RBs of a subband
+    static constexpr uint8_t GOOD_CQI = 15; //!< CQI of the good half of the band
+    static constexpr uint8_t BAD_CQI = 2;   //!< CQI of the bad half of the band
+    static constexpr uint8_t WB_CQI = 8;    //!< Wideband CQI
+
+  private:
+    void Configure();
+    void ReportCqi(uint32_t slot);
+    void Slot(uint32_t slot);
+    static SfnSf GetSfnSf(uint32_t slot);
+
+    Ptr<NrMacSchedulerNs3> m_sched;
+    Ptr<const SpectrumModel> m_spectrumModel;
+    TestCqiMode m_mode;
+    uint32_t m_numDci{0};
+    uint32_t m_rbgInBadHalf{0};           //!< RBG assigned to a UE in the half of its bad channel
+    std::set<uint8_t> m_mcs;              //!< MCS of the DCIs since the last CQI type
+    std::vector<DlHarqInfo> m_dlFeedback; //!< For the next DL trigger
+};
+
+TestSubbandCqiMac::TestSubbandCqiMac(const Ptr<NrMacSchedulerNs3>& sched, TestCqiMode mode)
+    : m_sched(sched),
+      m_mode(mode)
+{
+    std::vector<double> centerFrequencies;
+    for (uint32_t rb = 0; rb < NUM_RB; ++rb)
+    {
+        centerFrequencies.push_back(28e9 + rb * 180e3);
+    }
+    m_spectrumModel = Create<SpectrumModel>(centerFrequencies);
+    m_sched->SetMacSchedSapUser(this);
+    m_sched->SetMacCschedSapUser(this);
+}
+
+void
+TestSubbandCqiMac::Start(uint32_t numSlots)
+{
+    Simulator::Schedule(Seconds(0), &TestSubbandCqiMac::Configure, this);
+    for (uint32_t slot = 1; slot <= numSlots; ++slot)
+    {
+        Simulator::Schedule(MilliSeconds(slot), &TestSubbandCqiMac::Slot, this, slot);
+    }
+}
+
+uint32_t
+TestSubbandCqiMac::GetNumDci() const
+{
+    return m_numDci;
+}
+
+uint32_t
+TestSubbandCqiMac::GetRbgInBadHalf() const
+{
+    return m_rbgInBadHalf;
+}
+
+std::set<uint8_t>
+TestSubbandCqiMac::GetMcs() const
+{
+    return m_mcs;
+}
+
+SfnSf
+TestSubbandCqiMac::GetSfnSf(uint32_t slot)
+{
+    // Numerology 0: one slot per subframe
+    return SfnSf(slot / 10, slot % 10, 0, 0);
+}
+
+void
+TestSubbandCqiMac::Configure()
+{
+    NrMacCschedSapProvider* csched = m_sched->GetMacCschedSapProvider();
+
+    NrMacCschedSapProvider::CschedCellConfigReqParameters cellConfig;
+    cellConfig.m_ulBandwidth = NUM_RB;
+    cellConfig.m_dlBandwidth = NUM_RB;
+    csched->CschedCellConfigReq(cellConfig);
+
+    for (uint16_t rnti = 1; rnti <= 2; ++rnti)
+    {
+        NrMacCschedSapProvider::CschedUeConfigReqParameters ueConfig;
+        ueConfig.m_rnti = rnti;
+        ueConfig.m_beamConfId = BeamConfId(BeamId(0, 90.0), BeamId::GetEmptyBeamId());
+        ueConfig.m_transmissionMode = 0;
+        csched->CschedUeConfigReq(ueConfig);
+
+        NrMacCschedSapProvider::CschedLcConfigReqParameters lcConfig;
+        lcConfig.m_rnti = rnti;
+        lcConfig.m_reconfigureFlag = false;
+        LogicalChannelConfigListElement_s lc;
+        lc.m_logicalChannelIdentity = 1;
+        lc.m_logicalChannelGroup = 1;
+        lc.m_direction = LogicalChannelConfigListElement_s::DIR_BOTH;
+        lc.m_qosBearerType = LogicalChannelConfigListElement_s::QBT_NON_GBR;
+        lc.m_qci = 9;
+        lc.m_eRabMaximulBitrateUl = 0;
+        lc.m_eRabMaximulBitrateDl = 0;
+        lc.m_eRabGuaranteedBitrateUl = 0;
+        lc.m_eRabGuaranteedBitrateDl = 0;
+        lcConfig.m_logicalChannelConfigList.emplace_back(lc);
+        csched->CschedLcConfigReq(lcConfig);
+    }
+}
+
+void
+TestSubbandCqiMac::ReportCqi(uint32_t slot)
+{
+    const bool subband = m_mode == TestCqiMode::SUBBAND ||
+                         (m_mode == TestCqiMode::SUBBAND_THEN_WIDEBAND && slot < 10);
+    if (m_mode == TestCqiMode::SUBBAND_THEN_WIDEBAND && !subband)
+    {
+        // Check only the DCIs scheduled after the wideband-only CQI
+        m_mcs.clear();
+        m_rbgInBadHalf = 0;
+    }
+
+    NrMacSchedSapProvider::SchedDlCqiInfoReqParameters params;
+    for (uint16_t rnti = 1; rnti <= 2; ++rnti)
+    {
+        DlCqiInfo cqi;
+        cqi.m_rnti = rnti;
+        cqi.m_ri = 1;
+        cqi.m_wbCqi = {WB_CQI};
+        if (subband)
+        {
+            // UE 1 has a good channel in the lower half, UE 2 in the upper half
+            const uint32_t numSb = NUM_RB / SB_SIZE;
+            std::vector<uint8_t> sbCqi(numSb, BAD_CQI);
+            for (uint32_t sb = 0; sb < numSb; ++sb)
+            {
+                if ((sb < numSb / 2) == (rnti == 1))
+                {
+                    sbCqi.at(sb) = GOOD_CQI;
+                }
+            }
+            cqi.m_cqiType = DlCqiInfo::SB;
+            cqi.m_sbCqi = {sbCqi};
+            cqi.m_sbSize = SB_SIZE;
+        }
+        params.m_cqiList.push_back(cqi);
+    }
+    m_sched->GetMacSchedSapProvider()->SchedDlCqiInfoReq(params);
+}
+
+void
+TestSubbandCqiMac::Slot(uint32_t slot)
+{
+    NrMacSchedSapProvider* sched = m_sched->GetMacSchedSapProvider();
+
+    if (slot % 10 == 1)
+    {
+        ReportCqi(slot);
+    }
+
+    // Each UE needs less than half of the band, so that it never has to take
+    // the RBG of its bad channel, whatever the order of the assignment
+    for (uint16_t rnti = 1; rnti <= 2; ++rnti)
+    {
+        NrMacSchedSapProvider::SchedDlRlcBufferReqParameters rlc;
+        rlc.m_rnti = rnti;
+        rlc.m_logicalChannelIdentity = 1;
+        rlc.m_rlcTransmissionQueueSize = 1000;
+        rlc.m_rlcTransmissionQueueHolDelay = 0;
+        rlc.m_rlcRetransmissionQueueSize = 0;
+        rlc.m_rlcRetransmissionHolDelay = 0;
+        rlc.m_rlcStatusPduSize = 0;
+        sched->SchedDlRlcBufferReq(rlc);
+    }
+
+    NrMacSchedSapProvider::SchedUlTriggerReqParameters ulTrigger;
+    ulTrigger.m_snfSf = GetSfnSf(slot + 2);
+    ulTrigger.m_slotType = LteNrTddSlotType::F;
+    sched->SchedUlTriggerReq(ulTrigger);
+
+    NrMacSchedSapProvider::SchedDlTriggerReqParameters dlTrigger;
+    dlTrigger.m_snfSf = GetSfnSf(slot);
+    dlTrigger.m_dlHarqInfoList = std::move(m_dlFeedback);
+    dlTrigger.m_slotType = LteNrTddSlotType::F;
+    m_dlFeedback.clear();
+    sched->SchedDlTriggerReq(dlTrigger);
+}
+
+void
+TestSubbandCqiMac::SchedConfigInd(SchedConfigIndParameters params)
+{
+    for (const auto& varTti : params.m_slotAllocInfo.m_varTtiAllocInfo)
+    {
+        const auto& dci = varTti.m_dci;
+        if (dci->m_type != DciInfoElementTdma::DATA || dci->m_format != DciInfoElementTdma::DL)
+        {
+            continue;
+        }
+        ++m_numDci;
+        m_mcs.insert(dci->m_mcs.at(0));
+        for (std::size_t rbg = 0; rbg < dci->m_rbgBitmask.size(); ++rbg)
+        {
+            if (dci->m_rbgBitmask.at(rbg) == 1 && (rbg < NUM_RB / 2) != (dci->m_rnti == 1))
+            {
+                ++m_rbgInBadHalf;
+            }
+        }
+
+        DlHarqInfo harq;
+        harq.m_rnti = dci->m_rnti;
+        harq.m_harqProcessId = dci->m_harqProcess;
+        harq.m_bwpIndex = 0;
+        for (const auto& tbs : dci->m_tbSize)
+        {
+            harq.m_harqStatus.push_back(tbs > 0 ? DlHarqInfo::ACK : DlHarqInfo::NONE);
+        }
+        harq.m_numRetx = dci->m_rv;
+        m_dlFeedback.push_back(harq);
+    }
+}
+
+Ptr<const SpectrumModel>
+TestSubbandCqiMac::GetSpectrumModel() const
+{
+    return m_spectrumModel;
+}
+
+uint32_t
+TestSubbandCqiMac::GetNumRbPerRbg() const
+{
+    return 1;
+}
+
+uint8_t
+TestSubbandCqiMac::GetNumHarqProcess() const
+{
+    return 16;
+}
+
+uint16_t
+TestSubbandCqiMac::GetBwpId() const
+{
+    return 0;
+}
+
+uint16_t
+TestSubbandCqiMac::GetCellId() const
+{
+    return 1;
+}
+
+uint32_t
+TestSubbandCqiMac::GetSymbolsPerSlot() const
+{
+    return 14;
+}
+
+Time
+TestSubbandCqiMac::GetSlotPeriod() const
+{
+    return MilliSeconds(1);
+}
+
+void
+TestSubbandCqiMac::CschedCellConfigCnf(const CschedCellConfigCnfParameters& params)
+{
+}
+
+void
+TestSubbandCqiMac::CschedUeConfigCnf(const CschedUeConfigCnfParameters& params)
+{
+}
+
+void
+TestSubbandCqiMac::CschedLcConfigCnf(const CschedLcConfigCnfParameters& params)
+{
+}
+
+void
+TestSubbandCqiMac::CschedLcReleaseCnf(const CschedLcReleaseCnfParameters& params)
+{
+}
+
+void
+TestSubbandCqiMac::CschedUeReleaseCnf(const CschedUeReleaseCnfParameters& params)
+{
+}
+
+void
+TestSubbandCqiMac::CschedUeConfigUpdateInd(const CschedUeConfigUpdateIndParameters& params)
+{
+}
+
+void
+TestSubbandCqiMac::CschedCellConfigUpdateInd(const CschedCellConfigUpdateIndParameters& params)
+{
+}
+
+class TestSchedulerSubbandCqi : public TestCase
+{
+  public:
+    TestSchedulerSubbandCqi(const std::string& type, TestCqiMode mode)
+        : TestCase("Scheduler " + type + " with " + GetModeName(mode)),
+          m_type(type),
+          m_mode(mode)
+    {
+    }
+
+  private:
+    void DoRun() override;
+    static std::string GetModeName(TestCqiMode mode);
+
+    std::string m_type;
+    TestCqiMode m_mode;
+};
+
+std::string
+TestSchedulerSubbandCqi::GetModeName(TestCqiMode mode)
+{
+    switch (mode)
+    {
+    case TestCqiMode::WIDEBAND:
+        return "wideband CQI";
+    case TestCqiMode::SUBBAND:
+        return "subband CQI";
+    case TestCqiMode::SUBBAND_THEN_WIDEBAND:
+        return "subband CQI, then wideband-only CQI";
+    }
+    return "";
+}
+
+void
+TestSchedulerSubbandCqi::DoRun()
+{
+    ObjectFactory factory;
+    factory.SetTypeId(m_type);
+    factory.Set("EnableSrsInFSlots", BooleanValue(false));
+    auto sched = factory.Create<NrMacSchedulerNs3>();
+    auto amc = CreateObject<NrAmc>();
+    sched->InstallDlAmc(amc);
+    sched->InstallUlAmc(CreateObject<NrAmc>());
+
+    TestSubbandCqiMac mac(sched, m_mode);
+    mac.Start(20);
+    Simulator::Run();
+    Simulator::Destroy();
+
+    NS_TEST_ASSERT_MSG_GT(mac.GetNumDci(), 0, "The scheduler did not schedule DL data");
+    const std::set<uint8_t> mcs = mac.GetMcs();
+    if (m_mode == TestCqiMode::SUBBAND)
+    {
+        NS_TEST_ASSERT_MSG_EQ(mac.GetRbgInBadHalf(),
+                              0,
+                              "UEs got RBG in the subbands of their bad channel");
+        NS_TEST_ASSERT_MSG_EQ(mcs.size(), 1, "UEs used different MCS");
+        NS_TEST_ASSERT_MSG_EQ(+*mcs.begin(),
+                              +amc->GetMcsFromCqi(TestSubbandCqiMac::GOOD_CQI),
+                              "UEs did not use the MCS of their good subbands");
+    }
+    else
+    {
+        NS_TEST_ASSERT_MSG_EQ(mcs.size(), 1, "UEs used different MCS");
+        NS_TEST_ASSERT_MSG_EQ(+*mcs.begin(),
+                              +amc->GetMcsFromCqi(TestSubbandCqiMac::WB_CQI),
+                              "UEs did not use the wideband MCS");
+    }
+
+    sched->Dispose();
+}
+
+class TestSchedulerSubbandCqiSuite : public TestSuite
+{
+  public:
+    TestSchedulerSubbandCqiSuite()
+        : TestSuite("nr-test-scheduler-subband-cqi", UNIT)
+    {
+        for (const std::string policy : {"RR", "PF", "Qos"})
+        {
+            const std::string type = "ns3::NrMacSchedulerOfdma" + policy;
+            AddTestCase(new TestSchedulerSubbandCqi(type, TestCqiMode::WIDEBAND), QUICK);
+            AddTestCase(new TestSchedulerSubbandCqi(type, TestCqiMode::SUBBAND), QUICK);
+            AddTestCase(new TestSchedulerSubbandCqi(type, TestCqiMode::SUBBAND_THEN_WIDEBAND),
+                        QUICK);
+        }
+    }
+};
+
+static TestSchedulerSubbandCqiSuite testSchedulerSubbandCqiSuite; //!< Subband CQI test suite
+
+} // namespace ns3
@@ -0,0 +1,114 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include <ns3/nr-mac-scheduler-timer-wheel.h>
+#include <ns3/test.h>
+#include <ns3/uniform-random-variable.h>
+
+#include <algorithm>
+#include <map>
+
+/**
+ * \file nr-test-scheduler-timer-wheel.cc
+ * \ingroup test
+ *
+ * \brief Unit-testing for the timer wheel used to expire the CQI of the UEs.
+ * The test restarts and stops the timers of random UEs, with durations both
+ * shorter and longer than a revolution of the wheel, and checks that at each
+ * tick the wheel expires exactly the UEs that a per-UE countdown (the way
+ * the CQI validity was computed before the wheel) would expire.
+ */
+namespace ns3
+{
+
+class TestSchedulerTimerWheel : public TestCase
+{
+  public:
+    TestSchedulerTimerWheel(uint32_t numBuckets, uint32_t maxDelay, const std::string& name)
+        : TestCase(name),
+          m_numBuckets(numBuckets),
+          m_maxDelay(maxDelay)
+    {
+    }
+
+  private:
+    void DoRun() override;
+    uint32_t m_numBuckets{0}; //!< Number of buckets of the wheel
+    uint32_t m_maxDelay{0};   //!< Maximum duration of a timer
+};
+
+void
+TestSchedulerTimerWheel::DoRun()
+{
+    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+    rng->SetStream(1);
+
+    const uint16_t numUes = 30;
+    NrMacSchedulerTimerWheel wheel(m_numBuckets);
+    std::map<uint16_t, uint64_t> countdown; // Remaining ticks of the running timers
+    std::vector<uint16_t> expired;
+
+    for (uint32_t tick = 0; tick < 20 * m_maxDelay; ++tick)
+    {
+        // Some UEs report a new value, some UEs leave
+        for (uint16_t rnti = 1; rnti <= numUes; ++rnti)
+        {
+            double p = rng->GetValue();
+            if (p < 0.05)
+            {
+                uint64_t delay = rng->GetInteger(1, m_maxDelay);
+                wheel.Schedule(rnti, delay);
+                countdown[rnti] = delay;
+            }
+            else if (p < 0.06)
+            {
+                wheel.Cancel(rnti);
+                countdown.erase(rnti);
+            }
+        }
+
+        std::vector<uint16_t> expected;
+        for (auto it = countdown.begin(); it != countdown.end(); /* NO INC */)
+        {
+            if (--it->second == 0)
+            {
+                expected.push_back(it->first);
+                it = countdown.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        wheel.Advance(&expired);
+        std::sort(expired.begin(), expired.end());
+        NS_TEST_ASSERT_MSG_EQ((expired == expected), true, "Wrong UEs expired at tick " << tick);
+        NS_TEST_ASSERT_MSG_EQ(wheel.GetNumRunning(), countdown.size(), "Wrong running timers");
+        for (uint16_t rnti = 1; rnti <= numUes; ++rnti)
+        {
+            NS_TEST_ASSERT_MSG_EQ(wheel.IsRunning(rnti),
+                                  (countdown.find(rnti) != countdown.end()),
+                                  "Wrong state of the timer of UE " << rnti);
+        }
+    }
+}
+
+class TestSchedulerTimerWheelSuite : public TestSuite
+{
+  public:
+    TestSchedulerTimerWheelSuite()
+        : TestSuite("nr-test-scheduler-timer-wheel", UNIT)
+    {
+        AddTestCase(new TestSchedulerTimerWheel(64, 40, "Timer wheel, short timers"), QUICK);
+        AddTestCase(new TestSchedulerTimerWheel(16, 100, "Timer wheel, long timers"), QUICK);
+        AddTestCase(new TestSchedulerTimerWheel(1, 10, "Timer wheel, single bucket"), QUICK);
+    }
+};
+
+static TestSchedulerTimerWheelSuite testSchedulerTimerWheelSuite; //!< Timer wheel test suite
+
+} // namespace ns3
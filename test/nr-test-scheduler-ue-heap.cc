@@ -0,0 +1,125 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include <ns3/nr-mac-scheduler-ue-heap.h>
+#include <ns3/nr-mac-scheduler-ue-info-rr.h>
+#include <ns3/test.h>
+#include <ns3/uniform-random-variable.h>
+
+#include <algorithm>
+
+/**
+ * \file nr-test-scheduler-ue-heap.cc
+ * \ingroup test
+ *
+ * \brief Unit-testing for the heap used by the schedulers to order the UEs.
+ * The UEs are ordered by the round-robin comparison function; the test checks
+ * that the UE on top of the heap is always the first UE that a sort would
+ * return (with ties broken by the position in the vector), also after the
+ * metric of random UEs is updated and after UEs are removed from the heap.
+ */
+namespace ns3
+{
+
+class TestSchedulerUeHeap : public TestCase
+{
+  public:
+    TestSchedulerUeHeap(uint32_t numUes, uint32_t maxRbg, const std::string& name)
+        : TestCase(name),
+          m_numUes(numUes),
+          m_maxRbg(maxRbg)
+    {
+    }
+
+  private:
+    void DoRun() override;
+    uint32_t m_numUes{0}; //!< Number of UEs in the heap
+    uint32_t m_maxRbg{0}; //!< Maximum RBG of a UE; a low value creates many ties
+};
+
+void
+TestSchedulerUeHeap::DoRun()
+{
+    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+    rng->SetStream(1);
+
+    std::vector<NrMacSchedulerNs3::UePtrAndBufferReq> ues;
+    for (uint32_t i = 0; i < m_numUes; ++i)
+    {
+        auto ue = std::make_shared<NrMacSchedulerUeInfoRR>(i + 1, BeamConfId(), []() {
+            return 1;
+        });
+        ue->m_dlRBG = rng->GetInteger(0, m_maxRbg);
+        ues.emplace_back(ue, 100);
+    }
+
+    auto compare = NrMacSchedulerUeInfoRR::CompareUeWeightsDl;
+    NrMacSchedulerUeHeap heap(ues, compare);
+    heap.Build();
+
+    // The UE that a sort would put first, among the ones still in the heap
+    auto expectedTop = [&]() {
+        std::size_t best = ues.size();
+        for (std::size_t i = 0; i < ues.size(); ++i)
+        {
+            if (heap.Contains(i) && (best == ues.size() || compare(ues[i], ues[best])))
+            {
+                best = i;
+            }
+        }
+        return best;
+    };
+
+    // Give resources to the UE on top, as a scheduler would do
+    for (uint32_t round = 0; round < 4 * m_numUes; ++round)
+    {
+        NS_TEST_ASSERT_MSG_EQ(heap.Top(), expectedTop(), "Wrong UE on top after an update");
+        std::size_t top = heap.Top();
+        ues[top].first->m_dlRBG += rng->GetInteger(1, 3);
+        heap.Update(top);
+
+        // Change also the metric of a random UE, in both directions
+        std::size_t other = rng->GetInteger(0, m_numUes - 1);
+        uint32_t rbg = ues[other].first->m_dlRBG;
+        ues[other].first->m_dlRBG = rng->GetInteger(rbg > 2 ? rbg - 2 : 0, rbg + 2);
+        heap.Update(other);
+    }
+
+    // Remove all the UEs: they must come out in the sorted order
+    std::vector<std::size_t> sorted(ues.size());
+    for (std::size_t i = 0; i < sorted.size(); ++i)
+    {
+        sorted[i] = i;
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [&](std::size_t a, std::size_t b) {
+        return compare(ues[a], ues[b]);
+    });
+    for (const auto& idx : sorted)
+    {
+        NS_TEST_ASSERT_MSG_EQ(heap.IsEmpty(), false, "Heap emptied too early");
+        NS_TEST_ASSERT_MSG_EQ(heap.Top(), idx, "UEs removed in the wrong order");
+        heap.Pop();
+        NS_TEST_ASSERT_MSG_EQ(heap.Contains(idx), false, "A removed UE is still in the heap");
+        heap.Update(idx); // Must be a no-op
+    }
+    NS_TEST_ASSERT_MSG_EQ(heap.IsEmpty(), true, "Heap not empty after removing all the UEs");
+}
+
+class TestSchedulerUeHeapSuite : public TestSuite
+{
+  public:
+    TestSchedulerUeHeapSuite()
+        : TestSuite("nr-test-scheduler-ue-heap", UNIT)
+    {
+        AddTestCase(new TestSchedulerUeHeap(1, 10, "UE heap, 1 UE"), QUICK);
+        AddTestCase(new TestSchedulerUeHeap(7, 2, "UE heap, 7 UEs, many ties"), QUICK);
+        AddTestCase(new TestSchedulerUeHeap(50, 1000, "UE heap, 50 UEs"), QUICK);
+    }
+};
+
+static TestSchedulerUeHeapSuite testSchedulerUeHeapSuite; //!< Scheduler UE heap test suite
+
+} // namespace ns3
@@ -0,0 +1,424 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include <ns3/boolean.h>
+#include <ns3/nr-amc.h>
+#include <ns3/nr-mac-scheduler-ns3.h>
+#include <ns3/object-factory.h>
+#include <ns3/simulator.h>
+#include <ns3/test.h>
+#include <ns3/uinteger.h>
+
+#include <map>
+
+/**
+ * \file nr-test-scheduler-waste-free.cc
+ * \ingroup test
+ *
+ * \brief Unit-testing for the attribute WasteFreeAssignment of the TDMA and
+ * OFDMA schedulers. Many UEs, with a fixed MCS 0, share a narrow bandwidth: a
+ * single RBG (OFDMA) or a single symbol (TDMA) is not enough for a TB with
+ * data, so that the default assignment leaves resources unused, which is
+ * reported by the trace WastedResources. With WasteFreeAssignment, the trace
+ * must never fire, and the scheduler must still serve the UEs.
+ */
+namespace ns3
+{
+
+/**
+ * \brief A fake MAC, which keeps the buffers of the UEs full and acknowledges
+ * every DCI
+ */
+class TestWasteFreeMac : public NrMacSchedSapUser, public NrMacCschedSapUser
+{
+  public:
+    TestWasteFreeMac(const Ptr<NrMacSchedulerNs3>& sched);
+
+    void Start(uint16_t numUes, uint32_t numSlots);
+    uint32_t GetNumDlDci() const;
+    uint32_t GetNumUlDci() const;
+
+    // inherited from NrMacSchedSapUser
+    void SchedConfigInd(SchedConfigIndParameters params) override;
+    Ptr<const SpectrumModel> GetSpectrumModel() const override;
+    uint32_t GetNumRbPerRbg() const override;
+    uint8_t GetNumHarqProcess() const override;
+    uint16_t GetBwpId() const override;
+    uint16_t GetCellId() const override;
+    uint32_t GetSymbolsPerSlot() const override;
+    Time GetSlotPeriod() const override;
+
+    // inherited from NrMacCschedSapUser
+    void CschedCellConfigCnf(const CschedCellConfigCnfParameters& params) override;
+    void CschedUeConfigCnf(const CschedUeConfigCnfParameters& params) override;
+    void CschedLcConfigCnf(const CschedLcConfigCnfParameters& params) override;
+    void CschedLcReleaseCnf(const CschedLcReleaseCnfParameters& params) override;
+    void CschedUeReleaseCnf(const CschedUeReleaseCnfParameters& params) override;
+    void CschedUeConfigUpdateInd(const CschedUeConfigUpdateIndParameters& params) override;
+    void CschedCellConfigUpdateInd(const CschedCellConfigUpdateIndParameters& params) override;
+
+  private:
+    void Configure();
+    void Slot(uint32_t slot);
+    static SfnSf GetSfnSf(uint32_t slot);
+
+    static constexpr uint32_t NUM_RB = 25; //!< RBs of the bandwidth, one per RBG
+
+    Ptr<NrMacSchedulerNs3> m_sched;
+    Ptr<const SpectrumModel> m_spectrumModel;
+    uint16_t m_numUes{0};
+    uint32_t m_slot{0};
+    uint32_t m_numDlDci{0};
+    uint32_t m_numUlDci{0};
+    std::vector<DlHarqInfo> m_dlFeedback;                     //!< For the next DL trigger
+    std::map<uint32_t, std::vector<UlHarqInfo>> m_ulFeedback; //!< By slot of delivery
+};
+
+TestWasteFreeMac::TestWasteFreeMac(const Ptr<NrMacSchedulerNs3>& sched)
+    : m_sched(sched)
+{
+    std::vector<double> centerFrequencies;
+    for (uint32_t rb = 0; rb < NUM_RB; ++rb)
+    {
+        centerFrequencies.push_back(28e9 + rb * 180e3);
+    }
+    m_spectrumModel = Create<SpectrumModel>(centerFrequencies);
+    m_sched->SetMacSchedSapUser(this);
+    m_sched->SetMacCschedSapUser(this);
+}
+
+void
+TestWasteFreeMac::Start(uint16_t numUes, uint32_t numSlots)
+{
+    m_numUes = numUes;
+    Simulator::Schedule(Seconds(0), &TestWasteFreeMac::Configure, this);
+    for (uint32_t slot = 1; slot <= numSlots; ++slot)
+    {
+        Simulator::Schedule(MilliSeconds(slot), &TestWasteFreeMac::Slot, this, slot);
+    }
+}
+
+uint32_t
+TestWasteFreeMac::GetNumDlDci() const
+{
+    return m_numDlDci;
+}
+
+uint32_t
+TestWasteFreeMac::GetNumUlDci() const
+{
+    return m_numUlDci;
+}
+
+SfnSf
+TestWasteFreeMac::GetSfnSf(uint32_t slot)
+{
+    // Numerology 0: one slot per subframe
+    return SfnSf(slot / 10, slot % 10, 0, 0);
+}
+
+void
+TestWasteFreeMac::Configure()
+{
+    NrMacCschedSapProvider* csched = m_sched->GetMacCschedSapProvider();
+
+    NrMacCschedSapProvider::CschedCellConfigReqParameters cellConfig;
+    cellConfig.m_ulBandwidth = NUM_RB;
+    cellConfig.m_dlBandwidth = NUM_RB;
+    csched->CschedCellConfigReq(cellConfig);
+
+    for (uint16_t rnti = 1; rnti <= m_numUes; ++rnti)
+    {
+        NrMacCschedSapProvider::CschedUeConfigReqParameters ueConfig;
+        ueConfig.m_rnti = rnti;
+        ueConfig.m_beamConfId = BeamConfId(BeamId(rnti % 2, 90.0), BeamId::GetEmptyBeamId());
+        ueConfig.m_transmissionMode = 0;
+        csched->CschedUeConfigReq(ueConfig);
+
+        NrMacCschedSapProvider::CschedLcConfigReqParameters lcConfig;
+        lcConfig.m_rnti = rnti;
+        lcConfig.m_reconfigureFlag = false;
+        LogicalChannelConfigListElement_s lc;
+        lc.m_logicalChannelIdentity = 1;
+        lc.m_logicalChannelGroup = 1;
+        lc.m_direction = LogicalChannelConfigListElement_s::DIR_BOTH;
+        lc.m_qosBearerType = LogicalChannelConfigListElement_s::QBT_NON_GBR;
+        lc.m_qci = 9;
+        lc.m_eRabMaximulBitrateUl = 0;
+        lc.m_eRabMaximulBitrateDl = 0;
+        lc.m_eRabGuaranteedBitrateUl = 0;
+        lc.m_eRabGuaranteedBitrateDl = 0;
+        lcConfig.m_logicalChannelConfigList.emplace_back(lc);
+        csched->CschedLcConfigReq(lcConfig);
+    }
+}
+
+void
+TestWasteFreeMac::Slot(uint32_t slot)
+{
+    NrMacSchedSapProvider* sched = m_sched->GetMacSchedSapProvider();
+    m_slot = slot;
+
+    if (slot % 10 == 1)
+    {
+        NrMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters bsr;
+        bsr.m_sfnSf = GetSfnSf(slot);
+        for (uint16_t rnti = 1; rnti <= m_numUes; ++rnti)
+        {
+            NrMacSchedSapProvider::SchedDlRlcBufferReqParameters rlc;
+            rlc.m_rnti = rnti;
+            rlc.m_logicalChannelIdentity = 1;
+            rlc.m_rlcTransmissionQueueSize = 100000;
+            rlc.m_rlcTransmissionQueueHolDelay = 0;
+            rlc.m_rlcRetransmissionQueueSize = 0;
+            rlc.m_rlcRetransmissionHolDelay = 0;
+            rlc.m_rlcStatusPduSize = 0;
+            sched->SchedDlRlcBufferReq(rlc);
+
+            MacCeElement ce;
+            ce.m_rnti = rnti;
+            ce.m_macCeType = MacCeElement::BSR;
+            ce.m_macCeValue.m_bufferStatus = {0, 40, 0, 0};
+            bsr.m_macCeList.push_back(ce);
+        }
+        sched->SchedUlMacCtrlInfoReq(bsr);
+    }
+
+    // UL is scheduled two slots in advance, as the MAC does with K2
+    NrMacSchedSapProvider::SchedUlTriggerReqParameters ulTrigger;
+    ulTrigger.m_snfSf = GetSfnSf(slot + 2);
+    ulTrigger.m_ulHarqInfoList = std::move(m_ulFeedback[slot]);
+    ulTrigger.m_slotType = LteNrTddSlotType::F;
+    m_ulFeedback.erase(slot);
+    sched->SchedUlTriggerReq(ulTrigger);
+
+    NrMacSchedSapProvider::SchedDlTriggerReqParameters dlTrigger;
+    dlTrigger.m_snfSf = GetSfnSf(slot);
+    dlTrigger.m_dlHarqInfoList = std::move(m_dlFeedback);
+    dlTrigger.m_slotType = LteNrTddSlotType::F;
+    m_dlFeedback.clear();
+    sched->SchedDlTriggerReq(dlTrigger);
+}
+
+void
+TestWasteFreeMac::SchedConfigInd(SchedConfigIndParameters params)
+{
+    for (const auto& varTti : params.m_slotAllocInfo.m_varTtiAllocInfo)
+    {
+        const auto& dci = varTti.m_dci;
+        if (dci->m_type != DciInfoElementTdma::DATA)
+        {
+            continue;
+        }
+        if (dci->m_format == DciInfoElementTdma::DL)
+        {
+            ++m_numDlDci;
+            DlHarqInfo harq;
+            harq.m_rnti = dci->m_rnti;
+            harq.m_harqProcessId = dci->m_harqProcess;
+            harq.m_bwpIndex = 0;
+            for (const auto& tbs : dci->m_tbSize)
+            {
+                harq.m_harqStatus.push_back(tbs > 0 ? DlHarqInfo::ACK : DlHarqInfo::NONE);
+            }
+            harq.m_numRetx = dci->m_rv;
+            m_dlFeedback.push_back(harq);
+        }
+        else
+        {
+            // The UL slot is two slots in the future: the feedback comes after it
+            ++m_numUlDci;
+            UlHarqInfo harq;
+            harq.m_rnti = dci->m_rnti;
+            harq.m_harqProcessId = dci->m_harqProcess;
+            harq.m_bwpIndex = 0;
+            harq.m_receptionStatus = UlHarqInfo::Ok;
+            harq.m_tpc = 1;
+            harq.m_numRetx = 0;
+            m_ulFeedback[m_slot + 3].push_back(harq);
+        }
+    }
+}
+
+Ptr<const SpectrumModel>
+TestWasteFreeMac::GetSpectrumModel() const
+{
+    return m_spectrumModel;
+}
+
+uint32_t
+TestWasteFreeMac::GetNumRbPerRbg() const
+{
+    return 1;
+}
+
+uint8_t
+TestWasteFreeMac::GetNumHarqProcess() const
+{
+    return 16;
+}
+
+uint16_t
+TestWasteFreeMac::GetBwpId() const
+{
+    return 0;
+}
+
+uint16_t
+TestWasteFreeMac::GetCellId() const
+{
+    return 1;
+}
+
+uint32_t
+TestWasteFreeMac::GetSymbolsPerSlot() const
+{
+    return 14;
+}
+
+Time
+TestWasteFreeMac::GetSlotPeriod() const
+{
+    return MilliSeconds(1);
+}
+
+void
+TestWasteFreeMac::CschedCellConfigCnf(const CschedCellConfigCnfParameters& params)
+{
+}
+
+void
+TestWasteFreeMac::CschedUeConfigCnf(const CschedUeConfigCnfParameters& params)
+{
+}
+
+void
+TestWasteFreeMac::CschedLcConfigCnf(const CschedLcConfigCnfParameters& params)
+{
+}
+
+void
+TestWasteFreeMac::CschedLcReleaseCnf(const CschedLcReleaseCnfParameters& params)
+{
+}
+
+void
+TestWasteFreeMac::CschedUeReleaseCnf(const CschedUeReleaseCnfParameters& params)
+{
+}
+
+void
+TestWasteFreeMac::CschedUeConfigUpdateInd(const CschedUeConfigUpdateIndParameters& params)
+{
+}
+
+void
+TestWasteFreeMac::CschedCellConfigUpdateInd(const CschedCellConfigUpdateIndParameters& params)
+{
+}
+
+class TestSchedulerWasteFree : public TestCase
+{
+  public:
+    TestSchedulerWasteFree(const std::string& type, bool wasteFree)
+        : TestCase("Scheduler " + type + (wasteFree ? " does not waste" : " wastes") +
+                   " resources"),
+          m_type(type),
+          m_wasteFree(wasteFree)
+    {
+    }
+
+  private:
+    void DoRun() override;
+    void WastedResources(const SfnSf& sfnSf,
+                         uint16_t rnti,
+                         DciInfoElementTdma::DciFormat format,
+                         uint32_t rbg);
+
+    std::string m_type;
+    bool m_wasteFree;
+    uint32_t m_wastedDl{0};
+    uint32_t m_wastedUl{0};
+};
+
+void
+TestSchedulerWasteFree::WastedResources(const SfnSf& sfnSf,
+                                        uint16_t rnti,
+                                        DciInfoElementTdma::DciFormat format,
+                                        uint32_t rbg)
+{
+    NS_TEST_ASSERT_MSG_GT(rbg, 0, "Wasted resources reported without resources");
+    if (format == DciInfoElementTdma::DL)
+    {
+        m_wastedDl += rbg;
+    }
+    else
+    {
+        m_wastedUl += rbg;
+    }
+}
+
+void
+TestSchedulerWasteFree::DoRun()
+{
+    ObjectFactory factory;
+    factory.SetTypeId(m_type);
+    factory.Set("EnableSrsInFSlots", BooleanValue(false));
+    factory.Set("FixedMcsDl", BooleanValue(true));
+    factory.Set("FixedMcsUl", BooleanValue(true));
+    factory.Set("StartingMcsDl", UintegerValue(0));
+    factory.Set("StartingMcsUl", UintegerValue(0));
+    factory.Set("WasteFreeAssignment", BooleanValue(m_wasteFree));
+    auto sched = factory.Create<NrMacSchedulerNs3>();
+    sched->InstallDlAmc(CreateObject<NrAmc>());
+    sched->InstallUlAmc(CreateObject<NrAmc>());
+    sched->TraceConnectWithoutContext(
+        "WastedResources",
+        MakeCallback(&TestSchedulerWasteFree::WastedResources, this));
+
+    TestWasteFreeMac mac(sched);
+    mac.Start(40, 40);
+    Simulator::Run();
+    Simulator::Destroy();
+
+    NS_TEST_ASSERT_MSG_GT(mac.GetNumDlDci(), 0, "The scheduler did not schedule DL data");
+    NS_TEST_ASSERT_MSG_GT(mac.GetNumUlDci(), 0, "The scheduler did not schedule UL data");
+    if (m_wasteFree)
+    {
+        NS_TEST_ASSERT_MSG_EQ(m_wastedDl, 0, "DL resources wasted");
+        NS_TEST_ASSERT_MSG_EQ(m_wastedUl, 0, "UL resources wasted");
+    }
+    else
+    {
+        // Check that the scenario is the one in which resources are wasted
+        NS_TEST_ASSERT_MSG_GT(m_wastedDl, 0, "No DL resources wasted");
+        NS_TEST_ASSERT_MSG_GT(m_wastedUl, 0, "No UL resources wasted");
+    }
+
+    sched->Dispose();
+}
+
+class TestSchedulerWasteFreeSuite : public TestSuite
+{
+  public:
+    TestSchedulerWasteFreeSuite()
+        : TestSuite("nr-test-scheduler-waste-free", UNIT)
+    {
+        for (const std::string access : {"Tdma", "Ofdma"})
+        {
+            for (const std::string policy : {"RR", "PF"})
+            {
+                const std::string type = "ns3::NrMacScheduler" + access + policy;
+                AddTestCase(new TestSchedulerWasteFree(type, false), QUICK);
+                AddTestCase(new TestSchedulerWasteFree(type, true), QUICK);
+            }
+        }
+    }
+};
+
+static TestSchedulerWasteFreeSuite testSchedulerWasteFreeSuite; //!< Waste-free test suite
+
+} // namespace ns3
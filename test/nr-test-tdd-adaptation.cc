@@ -0,0 +1,281 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+// Copyright (c) 2024 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+//
+// SPDX-License-Identifier: GPL-2.0-only
+
+#include <ns3/double.h>
+#include <ns3/nr-gnb-phy.h>
+#include <ns3/nr-tdd-adaptation.h>
+#include <ns3/test.h>
+
+/**
+ * \file nr-test-tdd-adaptation.cc
+ * \ingroup test
+ *
+ * \brief Unit-testing for the dynamic TDD. The first test checks the pattern
+ * selected by NrTddAdaptation from the load of one or more cells, with the
+ * hysteresis. The second test follows the slots around a switch of pattern,
+ * using the structures that the gNB PHY generates from the current, the
+ * transition and the next pattern: every slot must be indicated to the MAC
+ * exactly once, in each of its directions, with its right type, its DCI must
+ * be sent in a slot with a DL CTRL, and the HARQ feedback of its DL data must
+ * be placed in a slot with a UL CTRL.
+ */
+namespace ns3
+{
+
+class TestTddAdaptationSelection : public TestCase
+{
+  public:
+    TestTddAdaptationSelection()
+        : TestCase("TDD pattern selection from the load")
+    {
+    }
+
+  private:
+    void DoRun() override;
+};
+
+void
+TestTddAdaptationSelection::DoRun()
+{
+    const std::vector<LteNrTddSlotType> dlHeavy = {DL, DL, DL, DL, DL, DL, DL, DL, S, UL};
+    const std::vector<LteNrTddSlotType> balanced = {DL, DL, S, UL, UL};
+    const std::vector<LteNrTddSlotType> ulHeavy = {DL, S, UL, UL, UL};
+
+    NS_TEST_ASSERT_MSG_EQ_TOL(NrTddAdaptation::GetUlShare(dlHeavy), 0.1, 1e-9, "Wrong UL share");
+    NS_TEST_ASSERT_MSG_EQ_TOL(NrTddAdaptation::GetUlShare({DL, F, F, UL}),
+                              0.5,
+                              1e-9,
+                              "An F slot must count as half UL");
+
+    Ptr<NrTddAdaptation> adaptation = CreateObject<NrTddAdaptation>();
+    adaptation->SetAttribute("Smoothing", DoubleValue(1.0));
+    adaptation->AddPattern(dlHeavy);
+    adaptation->AddPattern(balanced);
+    adaptation->AddPattern(ulHeavy);
+
+    NS_TEST_ASSERT_MSG_EQ((adaptation->SelectPattern(0) == dlHeavy),
+                          true,
+                          "Without load, the first pattern must be selected");
+    adaptation->ReportLoad(1, 600, 400);
+    NS_TEST_ASSERT_MSG_EQ((adaptation->SelectPattern(0) == dlHeavy),
+                          true,
+                          "The selection must not change inside a frame");
+    NS_TEST_ASSERT_MSG_EQ((adaptation->SelectPattern(1) == balanced),
+                          true,
+                          "A UL share of 40% must select the balanced pattern");
+
+    adaptation->ReportLoad(1, 500, 500);
+    NS_TEST_ASSERT_MSG_EQ((adaptation->SelectPattern(2) == balanced),
+                          true,
+                          "A pattern that is not better must not replace the current one");
+
+    adaptation->ReportLoad(1, 350, 650);
+    NS_TEST_ASSERT_MSG_EQ((adaptation->SelectPattern(3) == ulHeavy),
+                          true,
+                          "A UL share of 65% must select the UL-heavy pattern");
+
+    adaptation->ReportLoad(2, 9000, 0);
+    NS_TEST_ASSERT_MSG_EQ((adaptation->SelectPattern(4) == dlHeavy),
+                          true,
+                          "The selection must follow the load of all the cells");
+
+    Ptr<NrTddAdaptation> sticky = CreateObject<NrTddAdaptation>();
+    sticky->SetAttribute("Hysteresis", DoubleValue(0.5));
+    sticky->AddPattern(dlHeavy);
+    sticky->AddPattern(balanced);
+    sticky->ReportLoad(1, 600, 400);
+    NS_TEST_ASSERT_MSG_EQ((sticky->SelectPattern(0) == dlHeavy),
+                          true,
+                          "An improvement below the hysteresis must not switch pattern");
+}
+
+class TestTddAdaptationTransition : public TestCase
+{
+  public:
+    TestTddAdaptationTransition(const std::vector<LteNrTddSlotType>& current,
+                                const std::vector<LteNrTddSlotType>& next,
+                                uint32_t switchFrame,
+                                const std::string& name)
+        : TestCase(name),
+          m_current(current),
+          m_next(next),
+          m_switchFrame(switchFrame)
+    {
+    }
+
+  private:
+    /**
+     * \brief The structures that the gNB PHY generates from a pattern
+     */
+    struct Structures
+    {
+        std::vector<LteNrTddSlotType> m_pattern;
+        std::map<uint32_t, std::vector<uint32_t>> m_toSendDl;
+        std::map<uint32_t, std::vector<uint32_t>> m_toSendUl;
+        std::map<uint32_t, std::vector<uint32_t>> m_generateDl;
+        std::map<uint32_t, std::vector<uint32_t>> m_generateUl;
+        std::map<uint32_t, uint32_t> m_dlHarqFb;
+    };
+
+    void DoRun() override;
+    static Structures Generate(const std::vector<LteNrTddSlotType>& pattern);
+
+    std::vector<LteNrTddSlotType> m_current; //!< Pattern before the switch
+    std::vector<LteNrTddSlotType> m_next;    //!< Pattern after the switch
+    uint32_t m_switchFrame{0};               //!< First frame with the next pattern
+};
+
+TestTddAdaptationTransition::Structures
+TestTddAdaptationTransition::Generate(const std::vector<LteNrTddSlotType>& pattern)
+{
+    Structures s;
+    s.m_pattern = pattern;
+    NrGnbPhy::GenerateStructuresFromPattern(pattern,
+                                            &s.m_toSendDl,
+                                            &s.m_toSendUl,
+                                            &s.m_generateDl,
+                                            &s.m_generateUl,
+                                            &s.m_dlHarqFb,
+                                            0,
+                                            2,
+                                            4,
+                                            2);
+    return s;
+}
+
+void
+TestTddAdaptationTransition::DoRun()
+{
+    const uint32_t slotsPerFrame = 10;
+    const Structures current = Generate(m_current);
+    const Structures transition = Generate(
+        NrTddAdaptation::GetTransitionPattern(m_current, m_next, slotsPerFrame, m_switchFrame));
+    const Structures next = Generate(m_next);
+
+    // The type of a slot, and the structures used by the gNB in a slot
+    auto expectedType = [&](uint64_t slot) {
+        const auto& pattern = slot / slotsPerFrame < m_switchFrame ? m_current : m_next;
+        return pattern[slot % pattern.size()];
+    };
+    auto activeStructures = [&](uint64_t slot) -> const Structures& {
+        const uint64_t frame = slot / slotsPerFrame;
+        if (frame + NrTddAdaptation::SWITCH_DELAY < m_switchFrame)
+        {
+            return current;
+        }
+        return frame < m_switchFrame ? transition : next;
+    };
+
+    const uint64_t numSlots = (m_switchFrame + 3) * slotsPerFrame;
+    std::vector<uint32_t> dlGenerated(numSlots + 3 * slotsPerFrame, 0);
+    std::vector<uint32_t> ulGenerated(numSlots + 3 * slotsPerFrame, 0);
+    std::vector<uint32_t> dlDci(numSlots + 3 * slotsPerFrame, 0);
+    std::vector<uint32_t> ulDci(numSlots + 3 * slotsPerFrame, 0);
+
+    // Count the indications to the MAC, and the DCIs, of each slot
+    auto count = [](const std::map<uint32_t, std::vector<uint32_t>>& map,
+                    uint32_t pos,
+                    uint64_t slot,
+                    std::vector<uint32_t>* counter) {
+        auto it = map.find(pos);
+        if (it == map.end())
+        {
+            return false;
+        }
+        for (const auto& delay : it->second)
+        {
+            ++counter->at(slot + delay);
+        }
+        return !it->second.empty();
+    };
+
+    for (uint64_t slot = 0; slot < numSlots; ++slot)
+    {
+        const Structures& s = activeStructures(slot);
+        const uint32_t pos = slot % s.m_pattern.size();
+
+        for (const auto* generate : {&s.m_generateDl, &s.m_generateUl})
+        {
+            auto it = generate->find(pos);
+            if (it == generate->end())
+            {
+                continue;
+            }
+            for (const auto& delay : it->second)
+            {
+                const uint64_t target = slot + delay;
+                NS_TEST_ASSERT_MSG_EQ(s.m_pattern[target % s.m_pattern.size()],
+                                      expectedType(target),
+                                      "Slot " << target << " indicated with a wrong type");
+            }
+        }
+        count(s.m_generateDl, pos, slot, &dlGenerated);
+        count(s.m_generateUl, pos, slot, &ulGenerated);
+
+        bool dci = count(s.m_toSendDl, pos, slot, &dlDci);
+        dci = count(s.m_toSendUl, pos, slot, &ulDci) || dci;
+        if (dci)
+        {
+            NS_TEST_ASSERT_MSG_NE(expectedType(slot),
+                                  UL,
+                                  "DCI sent in slot " << slot << ", which has no DL CTRL");
+        }
+
+        if (expectedType(slot) != UL)
+        {
+            const auto harq = s.m_dlHarqFb.find(pos);
+            NS_TEST_ASSERT_MSG_EQ((harq != s.m_dlHarqFb.end()),
+                                  true,
+                                  "No HARQ feedback position for slot " << slot);
+            NS_TEST_ASSERT_MSG_NE(expectedType(slot + harq->second),
+                                  DL,
+                                  "HARQ feedback of slot " << slot << " in a slot without UL CTRL");
+        }
+    }
+
+    // The first frames lack the slots that schedule them, the last ones the
+    // slots that they schedule
+    for (uint64_t slot = 2 * slotsPerFrame; slot < (m_switchFrame + 2) * slotsPerFrame; ++slot)
+    {
+        const auto type = expectedType(slot);
+        const uint32_t dl = type == DL || type == S || type == F ? 1 : 0;
+        const uint32_t ul = type == UL || type == F ? 1 : 0;
+        NS_TEST_ASSERT_MSG_EQ(dlGenerated[slot], dl, "Slot " << slot << " DL indications");
+        NS_TEST_ASSERT_MSG_EQ(ulGenerated[slot], ul, "Slot " << slot << " UL indications");
+        NS_TEST_ASSERT_MSG_EQ(dlDci[slot], dl, "Slot " << slot << " DL DCI");
+        NS_TEST_ASSERT_MSG_EQ(ulDci[slot], ul, "Slot " << slot << " UL DCI");
+    }
+}
+
+class TestTddAdaptationSuite : public TestSuite
+{
+  public:
+    TestTddAdaptationSuite()
+        : TestSuite("nr-test-tdd-adaptation", UNIT)
+    {
+        const std::vector<LteNrTddSlotType> dlHeavy = {DL, DL, DL, S, UL};
+        const std::vector<LteNrTddSlotType> ulHeavy = {DL, S, UL, UL, UL};
+        const std::vector<LteNrTddSlotType> flexible = {DL, F, F, F, UL, DL, DL, DL, S, UL};
+        const std::vector<LteNrTddSlotType> longK1 = {DL, DL, DL, DL, DL, DL, DL, DL, S, UL};
+
+        AddTestCase(new TestTddAdaptationSelection(), QUICK);
+        AddTestCase(new TestTddAdaptationTransition(dlHeavy, ulHeavy, 4, "DL to UL, even frame"),
+                    QUICK);
+        AddTestCase(new TestTddAdaptationTransition(ulHeavy, dlHeavy, 3, "UL to DL, odd frame"),
+                    QUICK);
+        AddTestCase(new TestTddAdaptationTransition(dlHeavy, flexible, 5, "DL to F"), QUICK);
+        AddTestCase(new TestTddAdaptationTransition(flexible, ulHeavy, 6, "F to UL"), QUICK);
+        AddTestCase(new TestTddAdaptationTransition(longK1,
+                                                    ulHeavy,
+                                                    3,
+                                                    "HARQ feedback beyond the next frame"),
+                    QUICK);
+    }
+};
+
+static TestTddAdaptationSuite testTddAdaptationSuite; //!< Dynamic TDD test suite
+
+} // namespace ns3